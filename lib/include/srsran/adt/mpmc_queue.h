@@ -0,0 +1,140 @@
+/**
+ * Copyright 2013-2021 Software Radio Systems Limited
+ *
+ * This file is part of srsRAN.
+ *
+ * srsRAN is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsRAN is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+#ifndef SRSRAN_MPMC_QUEUE_H
+#define SRSRAN_MPMC_QUEUE_H
+
+#include "srsran/adt/detail/type_storage.h"
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace srsran {
+
+/**
+ * Bounded multi-producer multi-consumer queue with fixed capacity N, that does not use locks or allocate memory.
+ * - each cell of the queue holds a sequence number that tells producers and consumers whether the cell is free for the
+ *   current lap of the buffer or holds an element to be popped. Producers and consumers only contend on the CAS of the
+ *   write and read indexes, respectively
+ * - try_push/try_pop fail instead of blocking when the queue is full/empty
+ * - size() is only an estimate when there are concurrent pushes/pops
+ * @tparam T type of the elements
+ * @tparam N capacity of the queue. Must be a power of 2
+ */
+template <typename T, size_t N>
+class static_mpmc_queue
+{
+  static_assert(N > 1 and (N & (N - 1)) == 0, "The capacity of static_mpmc_queue must be a power of 2");
+
+  struct cell_t {
+    std::atomic<size_t>     seq;
+    detail::type_storage<T> obj;
+  };
+
+public:
+  static_mpmc_queue()
+  {
+    for (size_t i = 0; i < N; ++i) {
+      cells[i].seq.store(i, std::memory_order_relaxed);
+    }
+  }
+  static_mpmc_queue(const static_mpmc_queue&) = delete;
+  static_mpmc_queue& operator=(const static_mpmc_queue&) = delete;
+  ~static_mpmc_queue()
+  {
+    for (size_t pos = rpos.load(std::memory_order_relaxed); pos != wpos.load(std::memory_order_relaxed); ++pos) {
+      cells[pos & (N - 1)].obj.destroy();
+    }
+  }
+
+  bool try_push(const T& t) { return try_emplace(t); }
+  bool try_push(T&& t) { return try_emplace(std::move(t)); }
+
+  template <typename... Args>
+  bool try_emplace(Args&&... args)
+  {
+    cell_t* cell;
+    size_t  pos = wpos.load(std::memory_order_relaxed);
+    while (true) {
+      cell        = &cells[pos & (N - 1)];
+      size_t seq  = cell->seq.load(std::memory_order_acquire);
+      intptr_t df = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+      if (df == 0) {
+        if (wpos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+          break;
+        }
+      } else if (df < 0) {
+        // cell still holds the element of the previous lap
+        return false;
+      } else {
+        pos = wpos.load(std::memory_order_relaxed);
+      }
+    }
+    cell->obj.emplace(std::forward<Args>(args)...);
+    cell->seq.store(pos + 1, std::memory_order_release);
+    return true;
+  }
+
+  bool try_pop(T& t)
+  {
+    cell_t* cell;
+    size_t  pos = rpos.load(std::memory_order_relaxed);
+    while (true) {
+      cell        = &cells[pos & (N - 1)];
+      size_t seq  = cell->seq.load(std::memory_order_acquire);
+      intptr_t df = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos + 1);
+      if (df == 0) {
+        if (rpos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+          break;
+        }
+      } else if (df < 0) {
+        // no element pushed yet for this cell
+        return false;
+      } else {
+        pos = rpos.load(std::memory_order_relaxed);
+      }
+    }
+    t = std::move(cell->obj.get());
+    cell->obj.destroy();
+    cell->seq.store(pos + N, std::memory_order_release);
+    return true;
+  }
+
+  size_t size() const
+  {
+    size_t w = wpos.load(std::memory_order_relaxed), r = rpos.load(std::memory_order_relaxed);
+    return w > r ? w - r : 0;
+  }
+  bool   empty() const { return size() == 0; }
+  size_t max_size() const { return N; }
+
+private:
+  std::array<cell_t, N> cells;
+  std::atomic<size_t>   wpos{0};
+  // Keep the producer and consumer indexes in different cache lines
+  char                  pad[64 - sizeof(std::atomic<size_t>)];
+  std::atomic<size_t>   rpos{0};
+};
+
+} // namespace srsran
+
+#endif // SRSRAN_MPMC_QUEUE_H
@@ -25,6 +25,9 @@
 #include "byte_buffer.h"
 #include "srsran/adt/bounded_vector.h"
 #include <algorithm>
+#include <array>
+#include <atomic>
+#include <limits>
 #include <map>
 #include <pthread.h>
 #include <stack>
@@ -37,6 +40,33 @@
 
 namespace srsran {
 
+/// Synchronization strategy used by a buffer_pool
+enum class buffer_pool_mode {
+  locked,   ///< single free list guarded by a mutex
+  lock_free ///< per-thread magazines backed by a lock-free global free list
+};
+
+/// Snapshot of the runtime metrics of a buffer_pool
+struct buffer_pool_metrics_t {
+  uint32_t capacity;
+  uint32_t nof_available;
+  uint32_t high_water_mark;    ///< Max number of buffers that were simultaneously allocated
+  uint64_t nof_alloc_failures; ///< Allocations that returned nullptr
+  uint64_t nof_contentions;    ///< Mutex collisions (locked mode) or CAS retries/magazine collisions (lock-free mode)
+};
+
+namespace detail {
+
+/// Returns an index that is unique to the calling thread. Used to select per-thread magazines.
+inline uint32_t buffer_pool_thread_index()
+{
+  static std::atomic<uint32_t> thread_counter{0};
+  thread_local uint32_t        idx = thread_counter.fetch_add(1, std::memory_order_relaxed);
+  return idx;
+}
+
+} // namespace detail
+
 /******************************************************************************
  * Buffer pool
  *
@@ -44,6 +74,12 @@ namespace srsran {
  * deallocate functions. Provides quick object creation and deletion as well
  * as object reuse.
  * Singleton class of byte_buffer_t (but other pools of different type can be created)
+ *
+ * Buffers are stored in a single contiguous array, so that the check of whether a
+ * buffer belongs to the pool is an O(1) address range check.
+ * In lock_free mode, each thread allocates from and deallocates to its own magazine
+ * (a small cache of buffer indexes). Magazines are refilled from/flushed to a global
+ * lock-free free list (Treiber stack with ABA tag) in batches.
  *****************************************************************************/
 
 template <class buffer_t>
@@ -51,45 +87,58 @@ class buffer_pool
 {
 public:
   // non-static methods
-  buffer_pool(int capacity_ = -1)
+  buffer_pool(int capacity_ = -1, buffer_pool_mode mode_ = buffer_pool_mode::locked) : mode(mode_)
   {
     uint32_t nof_buffers = POOL_SIZE;
     if (capacity_ > 0) {
       nof_buffers = (uint32_t)capacity_;
     }
-    pool.reserve(nof_buffers);
-    free_list.reserve(nof_buffers);
+    storage.reset(new (std::nothrow) buffer_t[nof_buffers]);
+    if (storage == nullptr) {
+      perror("Error allocating memory. Exiting...\n");
+      exit(-1);
+    }
+    capacity = nof_buffers;
     pthread_mutex_init(&mutex, nullptr);
     pthread_cond_init(&cv_not_empty, nullptr);
-    for (uint32_t i = 0; i < nof_buffers; i++) {
-      buffer_t* b = new (std::nothrow) buffer_t;
-      if (!b) {
-        perror("Error allocating memory. Exiting...\n");
-        exit(-1);
+
+    if (mode == buffer_pool_mode::locked) {
+      free_list.reserve(nof_buffers);
+      for (uint32_t i = 0; i < nof_buffers; i++) {
+        free_list.push_back(&storage[i]);
       }
-      pool.push_back(b);
-      free_list.push_back(b);
+      return;
     }
-    capacity = nof_buffers;
+
+    // Magazines are kept small relative to the pool, so that idle threads cannot hoard most of the buffers
+    magazine_size = std::min(capacity / (2 * NOF_MAGAZINES), (uint32_t)MAX_MAGAZINE_SIZE);
+    if (magazine_size < 2) {
+      magazine_size = 0;
+    }
+    next_free.reset(new std::atomic<uint32_t>[nof_buffers]);
+    for (uint32_t i = 0; i < nof_buffers; i++) {
+      next_free[i].store(i + 1 < nof_buffers ? i + 1 : INVALID_IDX, std::memory_order_relaxed);
+    }
+    free_head.store(make_head(0, 0), std::memory_order_release);
   }
 
   ~buffer_pool()
   {
-    for (auto* p : pool) {
-      delete p;
-    }
     pthread_cond_destroy(&cv_not_empty);
     pthread_mutex_destroy(&mutex);
   }
 
   void print_all_buffers()
   {
-    printf("%d buffers in queue\n", static_cast<int>(pool.size() - free_list.size()));
+    printf("%d buffers in queue\n", static_cast<int>(capacity - nof_available_pdus()));
 #ifdef SRSRAN_BUFFER_POOL_LOG_ENABLED
+    if (mode == buffer_pool_mode::lock_free) {
+      return;
+    }
     std::map<std::string, uint32_t> buffer_cnt;
-    for (uint32_t i = 0; i < pool.size(); i++) {
-      if (std::find(free_list.cbegin(), free_list.cend(), pool[i]) == free_list.cend()) {
-        buffer_cnt[strlen(pool[i]->debug_name) ? pool[i]->debug_name : "Undefined"]++;
+    for (uint32_t i = 0; i < capacity; i++) {
+      if (std::find(free_list.cbegin(), free_list.cend(), &storage[i]) == free_list.cend()) {
+        buffer_cnt[strlen(storage[i].debug_name) ? storage[i].debug_name : "Undefined"]++;
       }
     }
     std::map<std::string, uint32_t>::iterator it;
@@ -99,13 +148,92 @@ public:
 #endif
   }
 
-  uint32_t nof_available_pdus() { return free_list.size(); }
+  uint32_t nof_available_pdus()
+  {
+    if (mode == buffer_pool_mode::locked) {
+      return free_list.size();
+    }
+    return capacity - nof_in_use.load(std::memory_order_relaxed);
+  }
 
-  bool is_almost_empty() { return free_list.size() < capacity / 20; }
+  bool is_almost_empty() { return nof_available_pdus() < capacity / 20; }
+
+  buffer_pool_mode get_mode() const { return mode; }
+
+  buffer_pool_metrics_t get_metrics()
+  {
+    buffer_pool_metrics_t m = {};
+    m.capacity              = capacity;
+    m.nof_available         = nof_available_pdus();
+    m.high_water_mark       = high_water_mark.load(std::memory_order_relaxed);
+    m.nof_alloc_failures    = nof_alloc_failures.load(std::memory_order_relaxed);
+    m.nof_contentions       = nof_contentions.load(std::memory_order_relaxed);
+    return m;
+  }
+
+  /// Checks in O(1) whether the given buffer address belongs to this pool
+  bool owns(const buffer_t* b) const
+  {
+    uintptr_t addr  = reinterpret_cast<uintptr_t>(b);
+    uintptr_t first = reinterpret_cast<uintptr_t>(&storage[0]);
+    uintptr_t last  = first + capacity * sizeof(buffer_t);
+    return addr >= first and addr < last and (addr - first) % sizeof(buffer_t) == 0;
+  }
 
   buffer_t* allocate(const char* debug_name = nullptr, bool blocking = false)
   {
-    pthread_mutex_lock(&mutex);
+    buffer_t* b = (mode == buffer_pool_mode::locked) ? allocate_locked(blocking) : allocate_lock_free(blocking);
+    if (b == nullptr) {
+      nof_alloc_failures.fetch_add(1, std::memory_order_relaxed);
+      return nullptr;
+    }
+#ifdef SRSRAN_BUFFER_POOL_LOG_ENABLED
+    if (debug_name) {
+      strncpy(b->debug_name, debug_name, SRSRAN_BUFFER_POOL_LOG_NAME_LEN);
+      b->debug_name[SRSRAN_BUFFER_POOL_LOG_NAME_LEN - 1] = 0;
+    }
+#endif
+    return b;
+  }
+
+  bool deallocate(buffer_t* b)
+  {
+    if (mode == buffer_pool_mode::locked) {
+      return deallocate_locked(b);
+    }
+    return deallocate_lock_free(b);
+  }
+
+private:
+  static const int      POOL_SIZE         = 4096;
+  static const uint32_t NOF_MAGAZINES     = 16;
+  static const uint32_t MAX_MAGAZINE_SIZE = 32;
+  static const uint32_t INVALID_IDX       = std::numeric_limits<uint32_t>::max();
+
+  /// Per-thread cache of free buffer indexes. Padded to avoid false sharing between magazines.
+  struct magazine_t {
+    std::atomic<bool>                       busy{false};
+    uint32_t                                count = 0;
+    std::array<uint32_t, MAX_MAGAZINE_SIZE> idxs;
+    char                                    padding[64];
+
+    bool try_lock() { return not busy.exchange(true, std::memory_order_acquire); }
+    void unlock() { busy.store(false, std::memory_order_release); }
+  };
+
+  /****************** locked mode ******************/
+
+  void lock_mutex()
+  {
+    if (pthread_mutex_trylock(&mutex) != 0) {
+      nof_contentions.fetch_add(1, std::memory_order_relaxed);
+      pthread_mutex_lock(&mutex);
+    }
+  }
+
+  buffer_t* allocate_locked(bool blocking)
+  {
+    lock_mutex();
     buffer_t* b = nullptr;
 
     if (!free_list.empty()) {
@@ -115,12 +243,6 @@ public:
       if (is_almost_empty()) {
         printf("Warning buffer pool capacity is %f %%\n", (float)100 * free_list.size() / capacity);
       }
-#ifdef SRSRAN_BUFFER_POOL_LOG_ENABLED
-      if (debug_name) {
-        strncpy(b->debug_name, debug_name, SRSRAN_BUFFER_POOL_LOG_NAME_LEN);
-        b->debug_name[SRSRAN_BUFFER_POOL_LOG_NAME_LEN - 1] = 0;
-      }
-#endif
     } else if (blocking) {
       // blocking allocation
       while (free_list.empty()) {
@@ -140,15 +262,18 @@ public:
 #endif
     }
 
+    if (b != nullptr) {
+      update_high_water_mark(capacity - free_list.size());
+    }
     pthread_mutex_unlock(&mutex);
     return b;
   }
 
-  bool deallocate(buffer_t* b)
+  bool deallocate_locked(buffer_t* b)
   {
     bool ret = false;
-    pthread_mutex_lock(&mutex);
-    if (std::find(pool.cbegin(), pool.cend(), b) != pool.cend()) {
+    lock_mutex();
+    if (owns(b)) {
       free_list.push_back(b);
       ret = true;
     }
@@ -157,15 +282,213 @@ public:
     return ret;
   }
 
-private:
-  static const int       POOL_SIZE = 4096;
-  std::vector<buffer_t*> pool;
+  /****************** lock-free mode ******************/
+
+  static uint64_t make_head(uint32_t tag, uint32_t idx) { return (static_cast<uint64_t>(tag) << 32U) | idx; }
+  static uint32_t head_idx(uint64_t head) { return static_cast<uint32_t>(head); }
+  static uint32_t head_tag(uint64_t head) { return static_cast<uint32_t>(head >> 32U); }
+
+  /// Pushes a chain of buffers, already linked through next_free from first to last, to the global free list
+  void push_global(uint32_t first, uint32_t last)
+  {
+    uint64_t old_head = free_head.load(std::memory_order_relaxed);
+    do {
+      next_free[last].store(head_idx(old_head), std::memory_order_relaxed);
+    } while (not free_head.compare_exchange_weak(old_head,
+                                                 make_head(head_tag(old_head) + 1, first),
+                                                 std::memory_order_seq_cst,
+                                                 std::memory_order_relaxed) and
+             count_contention());
+  }
+
+  uint32_t pop_global()
+  {
+    uint64_t old_head = free_head.load(std::memory_order_acquire);
+    while (head_idx(old_head) != INVALID_IDX) {
+      uint32_t next = next_free[head_idx(old_head)].load(std::memory_order_relaxed);
+      if (free_head.compare_exchange_weak(
+              old_head, make_head(head_tag(old_head) + 1, next), std::memory_order_acquire, std::memory_order_acquire)) {
+        return head_idx(old_head);
+      }
+      count_contention();
+    }
+    return INVALID_IDX;
+  }
+
+  /// Takes a buffer from any magazine. Used when the global free list is depleted.
+  uint32_t steal_from_magazines()
+  {
+    for (magazine_t& mag : magazines) {
+      if (mag.try_lock()) {
+        uint32_t idx = mag.count > 0 ? mag.idxs[--mag.count] : INVALID_IDX;
+        mag.unlock();
+        if (idx != INVALID_IDX) {
+          return idx;
+        }
+      }
+    }
+    return INVALID_IDX;
+  }
+
+  uint32_t try_pop_lock_free()
+  {
+    uint32_t idx = INVALID_IDX;
+    if (magazine_size > 0) {
+      magazine_t& mag = magazines[detail::buffer_pool_thread_index() % NOF_MAGAZINES];
+      if (mag.try_lock()) {
+        if (mag.count == 0) {
+          // refill half of the magazine, so that the next allocations do not touch the global list
+          for (uint32_t i = 0; i < magazine_size / 2; ++i) {
+            uint32_t popped = pop_global();
+            if (popped == INVALID_IDX) {
+              break;
+            }
+            mag.idxs[mag.count++] = popped;
+          }
+        }
+        if (mag.count > 0) {
+          idx = mag.idxs[--mag.count];
+        }
+        mag.unlock();
+      } else {
+        count_contention();
+      }
+    }
+    if (idx == INVALID_IDX) {
+      idx = pop_global();
+    }
+    if (idx == INVALID_IDX and magazine_size > 0) {
+      idx = steal_from_magazines();
+    }
+    return idx;
+  }
+
+  buffer_t* allocate_lock_free(bool blocking)
+  {
+    uint32_t idx = try_pop_lock_free();
+
+    if (idx == INVALID_IDX and blocking) {
+      nof_waiters.fetch_add(1, std::memory_order_seq_cst);
+      pthread_mutex_lock(&mutex);
+      while ((idx = try_pop_lock_free()) == INVALID_IDX) {
+        // timed wait guards against the deallocator missing the waiter registration
+        timespec ts = {};
+        clock_gettime(CLOCK_REALTIME, &ts);
+        ts.tv_nsec += 1000000;
+        if (ts.tv_nsec >= 1000000000) {
+          ts.tv_sec++;
+          ts.tv_nsec -= 1000000000;
+        }
+        pthread_cond_timedwait(&cv_not_empty, &mutex, &ts);
+      }
+      pthread_mutex_unlock(&mutex);
+      nof_waiters.fetch_sub(1, std::memory_order_seq_cst);
+    }
+
+    if (idx == INVALID_IDX) {
+      printf("Error - buffer pool is empty\n");
+      return nullptr;
+    }
+
+    // a buffer is only counted once it has been taken from the free lists, so in_use never exceeds capacity
+    uint32_t in_use = nof_in_use.fetch_add(1, std::memory_order_relaxed) + 1;
+    update_high_water_mark(in_use);
+    if (not blocking and capacity - in_use < capacity / 20) {
+      printf("Warning buffer pool capacity is %f %%\n", (float)100 * (capacity - in_use) / capacity);
+    }
+    return &storage[idx];
+  }
+
+  bool deallocate_lock_free(buffer_t* b)
+  {
+    if (not owns(b)) {
+      return false;
+    }
+    uint32_t idx = static_cast<uint32_t>(b - &storage[0]);
+
+    // uncount the buffer before it becomes visible to allocators, see allocate_lock_free()
+    nof_in_use.fetch_sub(1, std::memory_order_relaxed);
+
+    bool cached = false;
+    if (magazine_size > 0 and nof_waiters.load(std::memory_order_relaxed) == 0) {
+      magazine_t& mag = magazines[detail::buffer_pool_thread_index() % NOF_MAGAZINES];
+      if (mag.try_lock()) {
+        if (mag.count >= magazine_size) {
+          // flush half of the magazine to the global list with a single CAS
+          uint32_t nof_flushed = magazine_size / 2;
+          uint32_t first       = mag.count - nof_flushed;
+          for (uint32_t i = first; i + 1 < mag.count; ++i) {
+            next_free[mag.idxs[i]].store(mag.idxs[i + 1], std::memory_order_relaxed);
+          }
+          push_global(mag.idxs[first], mag.idxs[mag.count - 1]);
+          mag.count = first;
+        }
+        mag.idxs[mag.count++] = idx;
+        mag.unlock();
+        cached = true;
+      } else {
+        count_contention();
+      }
+    }
+    if (not cached) {
+      push_global(idx, idx);
+    }
+
+    if (nof_waiters.load(std::memory_order_seq_cst) > 0) {
+      pthread_mutex_lock(&mutex);
+      pthread_cond_signal(&cv_not_empty);
+      pthread_mutex_unlock(&mutex);
+    }
+    return true;
+  }
+
+  /****************** metrics ******************/
+
+  bool count_contention()
+  {
+    nof_contentions.fetch_add(1, std::memory_order_relaxed);
+    return true;
+  }
+
+  void update_high_water_mark(uint32_t in_use)
+  {
+    uint32_t hwm = high_water_mark.load(std::memory_order_relaxed);
+    while (in_use > hwm and not high_water_mark.compare_exchange_weak(hwm, in_use, std::memory_order_relaxed)) {
+    }
+  }
+
+  const buffer_pool_mode      mode;
+  std::unique_ptr<buffer_t[]> storage;
+  uint32_t                    capacity;
+  pthread_mutex_t             mutex;
+  pthread_cond_t              cv_not_empty;
+
+  // locked mode
   std::vector<buffer_t*> free_list;
-  pthread_mutex_t        mutex;
-  pthread_cond_t         cv_not_empty;
-  uint32_t               capacity;
+
+  // lock-free mode
+  uint32_t                                 magazine_size = 0;
+  std::unique_ptr<std::atomic<uint32_t>[]> next_free;
+  std::atomic<uint64_t>                    free_head{make_head(0, INVALID_IDX)};
+  std::array<magazine_t, NOF_MAGAZINES>    magazines;
+  std::atomic<uint32_t>                    nof_in_use{0};
+  std::atomic<uint32_t>                    nof_waiters{0};
+
+  // metrics
+  std::atomic<uint32_t> high_water_mark{0};
+  std::atomic<uint64_t> nof_alloc_failures{0};
+  std::atomic<uint64_t> nof_contentions{0};
 };
 
+template <class buffer_t>
+const int buffer_pool<buffer_t>::POOL_SIZE;
+template <class buffer_t>
+const uint32_t buffer_pool<buffer_t>::NOF_MAGAZINES;
+template <class buffer_t>
+const uint32_t buffer_pool<buffer_t>::MAX_MAGAZINE_SIZE;
+template <class buffer_t>
+const uint32_t buffer_pool<buffer_t>::INVALID_IDX;
+
 using byte_buffer_pool = concurrent_fixed_memory_pool<sizeof(byte_buffer_t)>;
 
 inline unique_byte_buffer_t make_byte_buffer() noexcept
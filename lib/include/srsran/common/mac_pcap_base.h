@@ -108,6 +108,10 @@ protected:
   virtual void write_pdu(pcap_pdu_t& pdu) = 0;
   void         run_thread() final;
 
+  /// Hands the PDU over to the writer. By default the payload is copied into the PDU, which is queued for the PCAP
+  /// thread
+  virtual void queue_pdu(pcap_pdu_t& pdu, const uint8_t* payload, uint32_t payload_len);
+
   std::mutex                              mutex;
   srslog::basic_logger&                   logger;
   std::atomic<bool>                       running = {false};
@@ -35,6 +35,7 @@
 #include <netinet/udp.h>
 #include <sys/socket.h>
 #include <sys/types.h>
+#include <vector>
 
 namespace srsran {
 
@@ -98,6 +99,83 @@ namespace net_utils {
 
 bool sctp_init_socket(unique_socket* socket, net_utils::socket_type socktype, const char* bind_addr_str, int bind_port);
 
+/**
+ * Description: Accumulates datagrams and transmits them with a single sendmmsg(...) call. The datagrams are sent
+ *              straight from the byte buffers, so headers prepended in their headroom need no extra copy.
+ *              Not thread-safe, it shall be used from a single thread.
+ */
+class udp_tx_batch
+{
+public:
+  explicit udp_tx_batch(srslog::basic_logger& logger_) : logger(logger_) {}
+  udp_tx_batch(const udp_tx_batch&) = delete;
+  udp_tx_batch& operator=(const udp_tx_batch&) = delete;
+
+  /// Sets the socket used for transmission and the maximum number of datagrams per sendmmsg(...) call
+  void init(int fd_, uint32_t max_batch_size);
+
+  /// Enqueues pdu for transmission to addr. The batch is transmitted once it is full.
+  /// Returns false if any datagram could not be transmitted.
+  bool push(srsran::unique_byte_buffer_t pdu, const sockaddr_in& addr);
+
+  /// Transmits all enqueued datagrams. Returns false if any of them could not be transmitted.
+  bool flush();
+
+  /// Discards all enqueued datagrams
+  void clear() { pdus.clear(); }
+
+  size_t   size() const { return pdus.size(); }
+  uint32_t max_size() const { return max_batch; }
+
+  /// Number of datagrams that could not be transmitted since init(...)
+  uint64_t get_nof_failures() const { return nof_failures; }
+
+private:
+  srslog::basic_logger&                     logger;
+  int                                       fd           = -1;
+  uint32_t                                  max_batch    = 0;
+  uint64_t                                  nof_failures = 0;
+  std::vector<srsran::unique_byte_buffer_t> pdus;
+  std::vector<sockaddr_in>                  addrs;
+  std::vector<iovec>                        iovs;
+  std::vector<mmsghdr>                      msgs;
+};
+
+/**
+ * Description: Reads several datagrams with a single recvmmsg(...) call, straight into byte buffers. The buffers are
+ *              kept between receptions, and only the ones taken over by the caller are allocated again. It is used
+ *              by the SP-GW user plane workers and by make_batch_sdu_handler.
+ *              Not thread-safe, it shall be used from a single thread.
+ */
+class udp_rx_batch
+{
+public:
+  explicit udp_rx_batch(srslog::basic_logger& logger_) : logger(logger_) {}
+  udp_rx_batch(const udp_rx_batch&) = delete;
+  udp_rx_batch(udp_rx_batch&&)      = default;
+  udp_rx_batch& operator=(const udp_rx_batch&) = delete;
+
+  /// Sets the maximum number of datagrams per recvmmsg(...) call
+  void init(uint32_t max_batch_size);
+
+  /// Reads the datagrams already queued in the socket, without blocking. Returns the number of datagrams read, or -1
+  /// in case of failure
+  int recv(int fd);
+
+  /// Datagram i of the last reception. The caller may take ownership of the byte buffer
+  srsran::unique_byte_buffer_t& pdu(uint32_t i) { return pdus[i]; }
+  const sockaddr_in&            from(uint32_t i) const { return addrs[i]; }
+  uint32_t                      max_size() const { return pdus.size(); }
+
+private:
+  srslog::basic_logger&                     logger;
+  std::vector<srsran::unique_byte_buffer_t> pdus;
+  std::vector<sockaddr_in>                  addrs;
+  std::vector<iovec>                        iovs;
+  std::vector<mmsghdr>                      msgs;
+};
+
+
 } // namespace net_utils
 
 /****************************
@@ -196,6 +274,16 @@ make_sctp_sdu_handler(srslog::basic_logger& logger, srsran::task_queue_handle& q
 socket_manager_itf::recv_callback_t
 make_sdu_handler(srslog::basic_logger& logger, srsran::task_queue_handle& queue, recvfrom_callback_t rx_callback);
 
+/**
+ * Similar to make_sdu_handler, but it reads up to max_batch_size datagrams per socket wake-up with a single
+ * recvmmsg(...) call, and dispatches all of them into the "queue" as a single task. The rx_callback is called once per
+ * SDU, in reception order
+ */
+socket_manager_itf::recv_callback_t make_batch_sdu_handler(srslog::basic_logger&      logger,
+                                                           srsran::task_queue_handle& queue,
+                                                           recvfrom_callback_t        rx_callback,
+                                                           uint32_t                   max_batch_size);
+
 } // namespace srsran
 
 #endif // SRSRAN_RX_SOCKET_HANDLER_H
@@ -203,6 +203,10 @@ void DLT_PCAP_Close(FILE* fd);
 int LTE_PCAP_MAC_WritePDU(FILE* fd, MAC_Context_Info_t* context, const unsigned char* PDU, unsigned int length);
 int LTE_PCAP_MAC_UDP_WritePDU(FILE* fd, MAC_Context_Info_t* context, const unsigned char* PDU, unsigned int length);
 int LTE_PCAP_PACK_MAC_CONTEXT_TO_BUFFER(MAC_Context_Info_t* context, uint8_t* PDU, unsigned int length);
+int LTE_PCAP_PACK_MAC_UDP_HEADER_TO_BUFFER(MAC_Context_Info_t* context,
+                                           unsigned int        pdu_length,
+                                           uint8_t*            buffer,
+                                           unsigned int        length);
 
 /* Write an individual NAS PDU (PCAP packet header + nas-context + nas-pdu) */
 int LTE_PCAP_NAS_WritePDU(FILE* fd, NAS_Context_Info_t* context, const unsigned char* PDU, unsigned int length);
@@ -216,6 +220,10 @@ int LTE_PCAP_S1AP_WritePDU(FILE* fd, S1AP_Context_Info_t* context, const unsigne
 /* Write an individual NR MAC PDU (PCAP packet header + UDP header + nr-mac-context + mac-pdu) */
 int NR_PCAP_MAC_UDP_WritePDU(FILE* fd, mac_nr_context_info_t* context, const unsigned char* PDU, unsigned int length);
 int NR_PCAP_PACK_MAC_CONTEXT_TO_BUFFER(mac_nr_context_info_t* context, uint8_t* buffer, unsigned int length);
+int NR_PCAP_PACK_MAC_UDP_HEADER_TO_BUFFER(mac_nr_context_info_t* context,
+                                          unsigned int           pdu_length,
+                                          uint8_t*               buffer,
+                                          unsigned int           length);
 
 #ifdef __cplusplus
 }
@@ -0,0 +1,133 @@
+/**
+ * Copyright 2013-2021 Software Radio Systems Limited
+ *
+ * This file is part of srsRAN.
+ *
+ * srsRAN is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsRAN is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+#ifndef SRSRAN_PCAP_WRITER_H
+#define SRSRAN_PCAP_WRITER_H
+
+/******************************************************************************
+ * Capture file writer for high packet rates.
+ *
+ * Each thread that writes packets gets its own single producer ring, so
+ * producers never contend with each other nor wait for the file. A writer
+ * thread drains the rings into a large page aligned buffer and writes it to
+ * the file in big chunks, with O_DIRECT when the file system supports it.
+ * Packets that do not fit in the ring of their thread are dropped and
+ * counted.
+ *****************************************************************************/
+
+#include "srsran/common/threads.h"
+#include "srsran/srslog/srslog.h"
+#include <atomic>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <stdint.h>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace srsran {
+
+enum class pcap_file_format { pcap, pcapng };
+
+/// Link type and name of one of the interfaces of a capture file
+struct pcap_interface_t {
+  uint32_t    dlt;
+  std::string name;
+};
+
+struct pcap_writer_metrics_t {
+  uint64_t nof_pdus    = 0; ///< Packets written to the file
+  uint64_t nof_bytes   = 0; ///< Bytes of the packets written to the file, without the capture file headers
+  uint64_t nof_dropped = 0; ///< Packets dropped because the ring of the producer thread was full
+};
+
+class pcap_writer : protected srsran::thread
+{
+public:
+  /// Size in bytes of the ring of each producer thread, must be a power of two
+  static const uint32_t default_ring_size = 2 * 1024 * 1024;
+  /// Size in bytes of the buffer written to the file in one go
+  static const uint32_t write_buffer_size = 1024 * 1024;
+  /// Packets bigger than this are dropped
+  static const uint32_t max_packet_size = 64 * 1024;
+
+  explicit pcap_writer(const std::string& thread_name, uint32_t ring_size = default_ring_size);
+  ~pcap_writer();
+
+  pcap_writer(const pcap_writer& other) = delete;
+  pcap_writer& operator=(const pcap_writer& other) = delete;
+
+  /// Creates the file and starts the writer thread. Classic pcap files hold a single interface
+  bool open(const std::string& filename, const std::vector<pcap_interface_t>& interfaces, pcap_file_format format);
+
+  /// Writes the packets still in the rings and closes the file
+  void close();
+
+  bool is_open() const { return running.load(std::memory_order_relaxed); }
+
+  /**
+   * Queues a packet for the interface with index if_idx, made of a header, e.g. the dissector context, followed by the
+   * payload. Thread-safe, returns false if the packet is dropped
+   */
+  bool write(uint32_t if_idx, const uint8_t* header, uint32_t header_len, const uint8_t* payload, uint32_t payload_len);
+
+  pcap_writer_metrics_t get_metrics();
+
+private:
+  class ring;
+
+  ring* get_thread_ring();
+  void  run_thread() override;
+  bool  drain_rings();
+  void  append_record(uint32_t if_idx, uint64_t timestamp_ns, const uint8_t* data, uint32_t len);
+  void  append(const void* data, uint32_t len);
+  bool  write_buffer(bool flush_all);
+
+  struct free_deleter {
+    void operator()(uint8_t* p) const { ::free(p); }
+  };
+
+  srslog::basic_logger&               logger;
+  const uint32_t                      ring_size;
+  std::atomic<bool>                   running = {false};
+  std::atomic<uint64_t>               session_id{0};
+  std::mutex                          rings_mutex;
+  std::vector<std::unique_ptr<ring> > rings;
+  std::map<std::thread::id, ring*>    thread_rings;
+  std::atomic<uint64_t>               nof_pdus{0};
+  std::atomic<uint64_t>               nof_bytes{0};
+  std::atomic<uint64_t>               nof_oversized{0};
+
+  // Writer thread state
+  std::vector<ring*>                     drain_list;
+  int                                    fd             = -1;
+  bool                                   direct_io      = false;
+  pcap_file_format                       format         = pcap_file_format::pcap;
+  uint32_t                               nof_interfaces = 0;
+  std::unique_ptr<uint8_t, free_deleter> buffer;
+  uint32_t                               buffer_len = 0;
+  uint64_t                               file_size  = 0;
+};
+
+} // namespace srsran
+
+#endif // SRSRAN_PCAP_WRITER_H
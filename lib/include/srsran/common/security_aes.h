@@ -0,0 +1,65 @@
+/**
+ * Copyright 2013-2021 Software Radio Systems Limited
+ *
+ * This file is part of srsRAN.
+ *
+ * srsRAN is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsRAN is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+#ifndef SRSRAN_SECURITY_AES_H
+#define SRSRAN_SECURITY_AES_H
+
+/******************************************************************************
+ * AES-128 backend of EEA2 (CTR) and EIA2 (CMAC), for byte-aligned messages.
+ *
+ * The implementation is selected at runtime: AES-NI, and VAES for the CTR
+ * keystream, when both the build target and the CPU support them, otherwise
+ * the mbedtls/polarssl based code in liblte_security.
+ *****************************************************************************/
+
+#include "srsran/common/security.h"
+
+namespace srsran {
+
+enum class security_aes_impl_t { generic, aes_ni, vaes };
+
+const char* to_string(security_aes_impl_t impl);
+
+/// Fastest implementation supported by the running CPU
+security_aes_impl_t security_aes_detect_impl();
+
+security_aes_impl_t security_aes_get_impl();
+
+/// Selects the implementation used from now on. Returns false if impl is not supported by the CPU
+bool security_aes_set_impl(security_aes_impl_t impl);
+
+struct security_pdu_t {
+  const uint8_t* key; ///< 128-bit key
+  uint32_t       count;
+  uint8_t        bearer;
+  uint8_t        direction;
+  uint8_t*       msg;
+  uint32_t       msg_len; ///< Length of msg in bytes
+  uint8_t*       out;     ///< msg_len bytes of ciphered msg (may be msg itself), or the 4-byte MAC
+};
+
+int security_aes_eea2(const security_pdu_t& pdu);
+
+int security_aes_eia2(const security_pdu_t& pdu);
+
+} // namespace srsran
+
+#endif // SRSRAN_SECURITY_AES_H
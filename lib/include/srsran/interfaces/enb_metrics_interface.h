@@ -30,6 +30,7 @@
 #include "srsenb/hdr/stack/rrc/rrc_metrics.h"
 #include "srsenb/hdr/stack/s1ap/s1ap_metrics.h"
 #include "srsran/common/metrics_hub.h"
+#include "srsran/common/pcap_writer.h"
 #include "srsran/radio/radio_metrics.h"
 #include "srsran/rlc/rlc_metrics.h"
 #include "srsran/system/sys_metrics.h"
@@ -47,11 +48,12 @@ struct pdcp_metrics_t {
 };
 
 struct stack_metrics_t {
-  mac_metrics_t  mac;
-  rrc_metrics_t  rrc;
-  rlc_metrics_t  rlc;
-  pdcp_metrics_t pdcp;
-  s1ap_metrics_t s1ap;
+  mac_metrics_t                 mac;
+  rrc_metrics_t                 rrc;
+  rlc_metrics_t                 rlc;
+  pdcp_metrics_t                pdcp;
+  s1ap_metrics_t                s1ap;
+  srsran::pcap_writer_metrics_t mac_pcap;
 };
 
 struct enb_metrics_t {
@@ -90,6 +90,7 @@ struct phy_args_t {
   float       rx_gain_offset               = 62;
   bool        pdsch_csi_enabled            = true;
   bool        pdsch_8bit_decoder           = false;
+  uint32_t    pdsch_tdec_threads           = 0;
   uint32_t    intra_freq_meas_len_ms       = 20;
   uint32_t    intra_freq_meas_period_ms    = 200;
   float       force_ul_amplitude           = 0.0f;
@@ -97,6 +98,8 @@ struct phy_args_t {
 
   bool nr_store_pdsch_ko = false;
 
+  uint32_t nr_pdsch_ldpc_threads = 0;
+
   float    in_sync_rsrp_dbm_th    = -130.0f;
   float    in_sync_snr_db_th      = 1.0f;
   uint32_t nof_in_sync_events     = 10;
@@ -147,7 +150,8 @@ public:
   virtual void sr_send()        = 0;
   virtual int  sr_last_tx_tti() = 0;
 
-  virtual void set_mch_period_stop(uint32_t stop) = 0;
+  /* Sets the MCH period stop of the PMCH that carries the MTCH lcid, as signalled by its MSI */
+  virtual void set_mch_period_stop(uint32_t lcid, uint32_t stop) = 0;
 };
 
 class phy_interface_rrc_lte
@@ -31,6 +31,7 @@
 #include "srsran/srslog/srslog.h"
 #include <memory>
 #include <string>
+#include <vector>
 
 namespace srsran {
 
@@ -39,7 +40,8 @@ class channel
 public:
   struct args_t {
     // General
-    bool enable = false;
+    bool     enable      = false;
+    uint32_t nof_threads = 0; ///< Worker threads of the parallel mode, 0 runs all models in the calling thread
 
     // AWGN options
     bool  awgn_enable            = false;
@@ -76,11 +78,24 @@ public:
   void run(cf_t* in[SRSRAN_MAX_CHANNELS], cf_t* out[SRSRAN_MAX_CHANNELS], uint32_t len, const srsran_timestamp_t& t);
 
 private:
+  class worker_pool;
+
+  void init_fading_blocks();
+  void free_fading_blocks();
+  void run_serial(cf_t*                     in[SRSRAN_MAX_CHANNELS],
+                  cf_t*                     out[SRSRAN_MAX_CHANNELS],
+                  uint32_t                  len,
+                  const srsran_timestamp_t& t);
+  void run_parallel(cf_t*                     in[SRSRAN_MAX_CHANNELS],
+                    cf_t*                     out[SRSRAN_MAX_CHANNELS],
+                    uint32_t                  len,
+                    const srsran_timestamp_t& t);
+
   srslog::basic_logger&    logger;
   float                    hst_init_phase              = 0.0f;
   srsran_channel_fading_t* fading[SRSRAN_MAX_CHANNELS] = {};
   srsran_channel_delay_t*  delay[SRSRAN_MAX_CHANNELS]  = {};
-  srsran_channel_awgn_t*   awgn                        = nullptr;
+  srsran_channel_awgn_t*   awgn[SRSRAN_MAX_CHANNELS]   = {}; ///< Only awgn[0] in serial mode
   srsran_channel_hst_t*    hst                         = nullptr;
   srsran_channel_rlf_t*    rlf                         = nullptr;
   cf_t*                    buffer_in                   = nullptr;
@@ -88,6 +103,12 @@ private:
   uint32_t                 nof_channels                = 0;
   uint32_t                 current_srate               = 0;
   args_t                   args                        = {};
+
+  // Parallel mode
+  std::unique_ptr<worker_pool>               workers;
+  cf_t*                                      channel_buffer_in[SRSRAN_MAX_CHANNELS]  = {};
+  cf_t*                                      channel_buffer_out[SRSRAN_MAX_CHANNELS] = {};
+  std::vector<srsran_channel_fading_block_t> fading_blocks[SRSRAN_MAX_CHANNELS];
 };
 
 typedef std::unique_ptr<channel> channel_ptr;
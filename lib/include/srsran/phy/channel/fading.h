@@ -50,9 +50,10 @@ typedef struct {
   uint32_t state_len;  // Length of the impulse response saved in the state
 
   float coeff_alpha[SRSRAN_CHANNEL_FADING_MAXTAPS][SRSRAN_CHANNEL_FADING_NTERMS]; // Angle of arrival
+  float coeff_w[SRSRAN_CHANNEL_FADING_MAXTAPS][SRSRAN_CHANNEL_FADING_NTERMS];     // pi * F_d * cos(alpha)
   float coeff_a[SRSRAN_CHANNEL_FADING_MAXTAPS][SRSRAN_CHANNEL_FADING_NTERMS];     // Random phase
   float coeff_b[SRSRAN_CHANNEL_FADING_MAXTAPS][SRSRAN_CHANNEL_FADING_NTERMS];     // Random phase
-  cf_t* h_tap[SRSRAN_CHANNEL_FADING_MAXTAPS]; // Static tap signal in frequency domain
+  cf_t* h_tap[SRSRAN_CHANNEL_FADING_MAXTAPS]; // Static tap signal in frequency domain, FFT shifted
 
   // Utils
   srsran_dft_plan_t fft;             // DFT to frequency domain
@@ -66,6 +67,19 @@ typedef struct {
   cf_t* state; // To save impulse response of the filter
 } srsran_channel_fading_t;
 
+/*
+ * Working buffers for filtering a block of samples independently of the rest of the signal. Blocks of the same call
+ * can be filtered concurrently, as long as they start at a multiple of N/2 samples, and are then merged in order.
+ */
+typedef struct {
+  uint32_t N;         // FFT size of the fading channel the block was initialised for
+  uint32_t state_len; // Length of the impulse response tail of the block
+  cf_t*    temp;      // Temporal buffer, length fft_size
+  cf_t*    h_freq;    // Channel frequency response, length fft_size
+  cf_t*    y_freq;    // Intermediate frequency domain buffer
+  cf_t*    state;     // Impulse response tail of the block, to be added to the following samples
+} srsran_channel_fading_block_t;
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -80,6 +94,30 @@ SRSRAN_API double srsran_channel_fading_execute(srsran_channel_fading_t* q,
                                                 uint32_t                 nof_samples,
                                                 double                   init_time);
 
+SRSRAN_API int srsran_channel_fading_block_init(srsran_channel_fading_block_t* b, const srsran_channel_fading_t* q);
+
+SRSRAN_API void srsran_channel_fading_block_free(srsran_channel_fading_block_t* b);
+
+/**
+ * Filters nof_samples starting at init_time as if the channel had no state, leaving the impulse response tail in the
+ * block. It only reads the fading object, so several blocks can be executed concurrently.
+ */
+SRSRAN_API void srsran_channel_fading_execute_block(srsran_channel_fading_t*       q,
+                                                    srsran_channel_fading_block_t* b,
+                                                    const cf_t*                    in,
+                                                    cf_t*                          out,
+                                                    uint32_t                       nof_samples,
+                                                    double                         init_time);
+
+/**
+ * Adds the channel state to the nof_samples output samples of an executed block and takes over the block tail as the
+ * new state. Blocks must be merged in the same order as their samples.
+ */
+SRSRAN_API void srsran_channel_fading_merge_block(srsran_channel_fading_t*       q,
+                                                  srsran_channel_fading_block_t* b,
+                                                  cf_t*                          out,
+                                                  uint32_t                       nof_samples);
+
 #ifdef __cplusplus
 }
 #endif
@@ -49,6 +49,12 @@ SRSRAN_API int srsran_channel_hst_init(srsran_channel_hst_t* q, float fd_hz, flo
 
 SRSRAN_API void srsran_channel_hst_update_srate(srsran_channel_hst_t* q, uint32_t srate);
 
+/// Computes the doppler shift at ts into fs_hz
+SRSRAN_API void srsran_channel_hst_update(srsran_channel_hst_t* q, const srsran_timestamp_t* ts);
+
+/// Applies the last computed doppler shift. It does not modify the object, so it can run concurrently
+SRSRAN_API void srsran_channel_hst_apply(const srsran_channel_hst_t* q, const cf_t* in, cf_t* out, uint32_t len);
+
 SRSRAN_API void
 srsran_channel_hst_execute(srsran_channel_hst_t* q, cf_t* in, cf_t* out, uint32_t len, const srsran_timestamp_t* ts);
 
@@ -0,0 +1,105 @@
+/**
+ * Copyright 2013-2021 Software Radio Systems Limited
+ *
+ * This file is part of srsRAN.
+ *
+ * srsRAN is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsRAN is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+/**********************************************************************************************
+ *  File:         turbodecoder_batch.h
+ *
+ *  Description:  Batched turbo decoder.
+ *                Decodes up to one code block per SIMD lane, all of them with the same length.
+ *                Every lane runs the whole trellis of its own code block, so no window
+ *                overlap is needed and short code blocks (SIB, low MCS PUSCH, small TBs from
+ *                several UEs) fill the SIMD registers. Lanes can be stopped individually
+ *                (e.g. once their CRC is OK), the batch finishes when all lanes stopped.
+ *                The results are bit-exact with the generic MAX-LOG-MAP implementation.
+ *
+ *  Reference:    3GPP TS 36.212 version 10.0.0 Release 10 Sec. 5.1.3.2
+ *********************************************************************************************/
+
+#ifndef SRSRAN_TURBODECODER_BATCH_H
+#define SRSRAN_TURBODECODER_BATCH_H
+
+#include "srsran/config.h"
+#include "srsran/phy/fec/turbo/tc_interl.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+#define SRSRAN_TDEC_BATCH_MAX_LANES 16
+
+/* Early stop criteria, called after every half iteration for every lane still running with its decided bytes.
+ * Returns true if the lane shall stop. */
+typedef bool (*srsran_tdec_batch_stop_t)(void* arg, uint32_t cb_idx, const uint8_t* output, uint32_t nof_iterations);
+
+typedef struct SRSRAN_API {
+  uint32_t max_long_cb;
+  uint32_t nof_lanes;
+
+  // Lane-interleaved buffers, element k of lane i is at k * nof_lanes + i
+  int16_t* syst;
+  int16_t* parity0;
+  int16_t* parity1;
+  int16_t* app1;
+  int16_t* app2;
+  int16_t* ext1;
+  int16_t* ext2;
+  int16_t* beta;
+
+  srsran_tc_interl_t interleaver;
+  uint32_t           interleaver_long_cb;
+
+  uint32_t current_long_cb;
+  uint32_t nof_cb;
+  uint32_t active_mask; // Bit i is set while lane i runs
+  uint32_t n_iter;
+  uint32_t nof_iterations[SRSRAN_TDEC_BATCH_MAX_LANES];
+} srsran_tdec_batch_t;
+
+SRSRAN_API int srsran_tdec_batch_init(srsran_tdec_batch_t* h, uint32_t max_long_cb);
+
+SRSRAN_API void srsran_tdec_batch_free(srsran_tdec_batch_t* h);
+
+SRSRAN_API uint32_t srsran_tdec_batch_get_nof_lanes(srsran_tdec_batch_t* h);
+
+/* Loads nof_cb code blocks of length long_cb. The inputs use the natural (not sub-block) order, as produced by
+ * srsran_rm_turbo_rx_lut() when srsran_tdec_autoimp_get_subblocks() returns 0 */
+SRSRAN_API int srsran_tdec_batch_new_cb(srsran_tdec_batch_t* h, int16_t** input, uint32_t nof_cb, uint32_t long_cb);
+
+/* Runs 1 half iteration for all lanes and decides the output bytes of the lanes still running */
+SRSRAN_API void srsran_tdec_batch_iteration(srsran_tdec_batch_t* h, uint8_t** output);
+
+/* Stops code block cb_idx, its output is not updated anymore */
+SRSRAN_API void srsran_tdec_batch_stop_cb(srsran_tdec_batch_t* h, uint32_t cb_idx);
+
+SRSRAN_API uint32_t srsran_tdec_batch_get_active_mask(srsran_tdec_batch_t* h);
+
+SRSRAN_API uint32_t srsran_tdec_batch_get_nof_iterations(srsran_tdec_batch_t* h, uint32_t cb_idx);
+
+/* Runs up to nof_iterations half iterations. If stop is not NULL, it is evaluated for every running lane after each
+ * half iteration. Returns the number of half iterations run */
+SRSRAN_API int srsran_tdec_batch_run_all(srsran_tdec_batch_t*     h,
+                                         int16_t**                input,
+                                         uint8_t**                output,
+                                         uint32_t                 nof_cb,
+                                         uint32_t                 nof_iterations,
+                                         uint32_t                 long_cb,
+                                         srsran_tdec_batch_stop_t stop,
+                                         void*                    arg);
+
+#endif // SRSRAN_TURBODECODER_BATCH_H
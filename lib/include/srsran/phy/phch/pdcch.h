@@ -47,6 +47,9 @@
 
 typedef enum SRSRAN_API { SEARCH_UE, SEARCH_COMMON } srsran_pdcch_search_mode_t;
 
+/* Candidates with a lower mean absolute LLR are considered empty and are not decoded */
+#define SRSRAN_PDCCH_MIN_LLR_MEAN 0.3f
+
 /* PDCCH object */
 typedef struct SRSRAN_API {
   srsran_cell_t cell;
@@ -66,6 +69,7 @@ typedef struct SRSRAN_API {
   uint8_t* e;
   float    rm_f[3 * (SRSRAN_DCI_MAX_BITS + 16)];
   float*   llr;
+  float*   cce_llr_mean; // Mean absolute LLR of each CCE, computed with the LLRs
 
   /* tx & rx objects */
   srsran_modem_table_t mod;
@@ -112,6 +116,17 @@ srsran_pdcch_decode_msg(srsran_pdcch_t* q, srsran_dl_sf_cfg_t* sf, srsran_dci_cf
  */
 SRSRAN_API float srsran_pdcch_msg_corr(srsran_pdcch_t* q, srsran_dci_msg_t* msg);
 
+/**
+ * @brief Computes the mean absolute LLR of a PDCCH candidate from the LLRs extracted by srsran_pdcch_extract_llr(),
+ * without decoding it. Candidates below SRSRAN_PDCCH_MIN_LLR_MEAN do not carry a DCI
+ * @param q PDCCH object
+ * @param sf Subframe configuration
+ * @param location Candidate location
+ * @return The mean absolute LLR of the candidate, or a negative value if the location is not valid for the CFI
+ */
+SRSRAN_API float
+srsran_pdcch_candidate_llr_mean(srsran_pdcch_t* q, srsran_dl_sf_cfg_t* sf, const srsran_dci_location_t* location);
+
 SRSRAN_API int
 srsran_pdcch_dci_decode(srsran_pdcch_t* q, float* e, uint8_t* data, uint32_t E, uint32_t nof_bits, uint16_t* crc);
 
@@ -47,6 +47,9 @@
 // Short PRACH ZC sequence sequence length
 #define SRSRAN_PRACH_N_ZC_SHORT 139
 
+// Number of root sequences correlated together by the detector
+#define SRSRAN_PRACH_ROOT_BATCH 8
+
 /** Generation and detection of RACH signals for uplink.
  *  Currently only supports preamble formats 0-3.
  *  Does not currently support high speed flag.
@@ -102,6 +105,11 @@ typedef struct SRSRAN_API {
   srsran_dft_plan_t zc_fft;
   srsran_dft_plan_t zc_ifft;
 
+  // Root correlations, one row per root sequence of a batch, and the IFFT transforming a full batch at once
+  cf_t*             corr_freq_batch;
+  cf_t*             corr_spec_batch;
+  srsran_dft_plan_t zc_ifft_batch;
+
   cf_t* signal_fft;
   float detect_factor;
 
@@ -114,7 +122,6 @@ typedef struct SRSRAN_API {
   srsran_tdd_config_t         tdd_config;
   uint32_t                    current_prach_idx;
   cf_t*                       cross;
-  cf_t*                       corr_freq;
   srsran_prach_cancellation_t prach_cancel;
   cf_t                        sub[839 * 2];
   float                       phase[839];
@@ -234,6 +241,30 @@ SRSRAN_API int srsran_prach_detect_offset(srsran_prach_t* p,
                                           float*          peak_to_avg,
                                           uint32_t*       ind_len);
 
+/**
+ * Transforms a received PRACH occasion to the frequency domain and keeps the bins carrying the preamble in
+ * p->prach_bins, as the first step of srsran_prach_detect_offset()
+ */
+SRSRAN_API int srsran_prach_extract_bins(srsran_prach_t* p, uint32_t freq_offset, const cf_t* signal, uint32_t sig_len);
+
+/// Number of root sequences searched by the detector, which srsran_prach_detect_roots() ranges refer to
+SRSRAN_API uint32_t srsran_prach_nof_roots(const srsran_prach_t* p);
+
+/**
+ * Searches the preambles of the root sequences in [root_begin, root_end) on the given bins, as extracted by
+ * srsran_prach_extract_bins(), possibly by another object with the same configuration. Detections are appended to
+ * indices, t_offsets and peak_to_avg. Successive cancellation is not applied, so root ranges may be searched
+ * concurrently by different objects and their results concatenated in root order.
+ */
+SRSRAN_API int srsran_prach_detect_roots(srsran_prach_t* p,
+                                         const cf_t*     bins,
+                                         uint32_t        root_begin,
+                                         uint32_t        root_end,
+                                         uint32_t*       indices,
+                                         float*          t_offsets,
+                                         float*          peak_to_avg,
+                                         uint32_t*       n_indices);
+
 SRSRAN_API void srsran_prach_set_detect_factor(srsran_prach_t* p, float factor);
 
 SRSRAN_API int srsran_prach_free(srsran_prach_t* p);
@@ -38,6 +38,7 @@
 #include "srsran/phy/fec/turbo/turbodecoder.h"
 #include "srsran/phy/phch/pdsch_cfg.h"
 #include "srsran/phy/phch/pusch_cfg.h"
+#include "srsran/phy/phch/sch_cb_pool.h"
 #include "srsran/phy/phch/uci.h"
 
 #ifndef SRSRAN_RX_NULL
@@ -71,6 +72,8 @@ typedef struct SRSRAN_API {
 
   srsran_uci_cqi_pusch_t uci_cqi;
 
+  srsran_sch_cb_pool_t* cb_pool; // Optional, shared pool for parallel code block decoding
+
 } srsran_sch_t;
 
 SRSRAN_API int srsran_sch_init(srsran_sch_t* q);
@@ -79,6 +82,9 @@ SRSRAN_API void srsran_sch_free(srsran_sch_t* q);
 
 SRSRAN_API void srsran_sch_set_max_noi(srsran_sch_t* q, uint32_t max_iterations);
 
+/* Decodes the code blocks of a transport block in parallel in the given pool. Set to NULL to decode serially */
+SRSRAN_API void srsran_sch_set_cb_pool(srsran_sch_t* q, srsran_sch_cb_pool_t* pool);
+
 SRSRAN_API float srsran_sch_last_noi(srsran_sch_t* q);
 
 SRSRAN_API int srsran_dlsch_encode(srsran_sch_t* q, srsran_pdsch_cfg_t* cfg, uint8_t* data, uint8_t* e_bits);
@@ -0,0 +1,112 @@
+/**
+ * Copyright 2013-2021 Software Radio Systems Limited
+ *
+ * This file is part of srsRAN.
+ *
+ * srsRAN is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsRAN is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+/******************************************************************************
+ *  File:         sch_cb_pool.h
+ *
+ *  Description:  Pool of decoder threads used to decode the code blocks
+ *                of a transport block in parallel. Each worker owns its own
+ *                decoding context (turbo decoder and CRC instances for LTE,
+ *                LDPC decoders for NR). The pool can be shared by several
+ *                srsran_sch_t/srsran_sch_nr_t objects (e.g. one per PHY worker).
+ *****************************************************************************/
+
+#ifndef SRSRAN_SCH_CB_POOL_H
+#define SRSRAN_SCH_CB_POOL_H
+
+#include "srsran/config.h"
+#include "srsran/phy/fec/crc.h"
+#include "srsran/phy/fec/turbo/turbodecoder.h"
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+/* Decoding context given to every code block task */
+typedef struct SRSRAN_API {
+  srsran_tdec_t decoder;
+  srsran_crc_t  crc_cb;
+  srsran_crc_t  crc_tb;
+  uint8_t*      cb_out; // Decoded code block, including its CRC
+} srsran_sch_cb_decoder_t;
+
+/* Decodes the code block cb_idx of the transport block described by arg. ctx is the decoding context of the worker
+ * thread, or NULL when the task runs in the calling thread, which shall then use its own decoder instances. */
+typedef void (*srsran_sch_cb_task_t)(void* arg, uint32_t cb_idx, void* ctx);
+
+/* Creates and destroys the decoding context of a worker thread */
+typedef void* (*srsran_sch_cb_ctx_new_t)(void* arg);
+typedef void (*srsran_sch_cb_ctx_free_t)(void* ctx);
+
+typedef struct srsran_sch_cb_job_s {
+  srsran_sch_cb_task_t        task;
+  void*                       arg;
+  uint32_t                    nof_cb;
+  uint32_t                    next_cb;  // Next code block to be claimed
+  uint32_t                    nof_done; // Number of finished code blocks
+  struct srsran_sch_cb_job_s* next;
+} srsran_sch_cb_job_t;
+
+typedef struct srsran_sch_cb_pool_s srsran_sch_cb_pool_t;
+
+typedef struct SRSRAN_API {
+  srsran_sch_cb_pool_t* pool;
+  pthread_t             thread;
+  void*                 ctx;
+} srsran_sch_cb_worker_t;
+
+struct srsran_sch_cb_pool_s {
+  uint32_t                 nof_workers;
+  srsran_sch_cb_worker_t*  workers;
+  srsran_sch_cb_ctx_free_t ctx_free;
+
+  pthread_mutex_t      mutex;
+  pthread_cond_t       cvar_job;  // Signals workers that a job was posted
+  pthread_cond_t       cvar_done; // Signals callers that a code block finished
+  srsran_sch_cb_job_t* job_head;  // FIFO of jobs with unclaimed code blocks
+  srsran_sch_cb_job_t* job_tail;
+  bool                 quit;
+};
+
+SRSRAN_API int srsran_sch_cb_decoder_init(srsran_sch_cb_decoder_t* dec);
+
+SRSRAN_API void srsran_sch_cb_decoder_free(srsran_sch_cb_decoder_t* dec);
+
+/* Creates a pool of nof_workers LTE turbo decoding threads, each one with a srsran_sch_cb_decoder_t context */
+SRSRAN_API int srsran_sch_cb_pool_init(srsran_sch_cb_pool_t* q, uint32_t nof_workers);
+
+/* Creates a pool of nof_workers threads. The context of every worker is created with ctx_new(arg) */
+SRSRAN_API int srsran_sch_cb_pool_init_ctx(srsran_sch_cb_pool_t*    q,
+                                           uint32_t                 nof_workers,
+                                           srsran_sch_cb_ctx_new_t  ctx_new,
+                                           srsran_sch_cb_ctx_free_t ctx_free,
+                                           void*                    arg);
+
+SRSRAN_API void srsran_sch_cb_pool_free(srsran_sch_cb_pool_t* q);
+
+/**
+ * Runs task for every code block 0...nof_cb-1. The calling thread also decodes code blocks, so the call never waits
+ * for an idle worker. Returns once all code blocks are decoded, so that the TB CRC can be checked.
+ * If q is NULL or has no workers, the code blocks are decoded serially in the calling thread.
+ */
+SRSRAN_API void
+srsran_sch_cb_pool_run(srsran_sch_cb_pool_t* q, srsran_sch_cb_task_t task, void* arg, uint32_t nof_cb);
+
+#endif // SRSRAN_SCH_CB_POOL_H
@@ -37,6 +37,7 @@
 #include "srsran/phy/fec/ldpc/ldpc_encoder.h"
 #include "srsran/phy/fec/ldpc/ldpc_rm.h"
 #include "srsran/phy/phch/phch_cfg_nr.h"
+#include "srsran/phy/phch/sch_cb_pool.h"
 
 /**
  * @brief Maximum number of codeblocks for a NR shared channel transmission. It assumes a rate of 1.0 for the maximum
@@ -45,13 +46,27 @@
 #define SRSRAN_SCH_NR_MAX_NOF_CB_LDPC                                                                                  \
   ((SRSRAN_SLOT_MAX_NOF_BITS_NR + (SRSRAN_LDPC_MAX_LEN_CB - 1)) / SRSRAN_LDPC_MAX_LEN_CB)
 
+/**
+ * @brief Decoding statistics of a single code block
+ */
+typedef struct {
+  bool     decoded;  ///< Set if the code block was decoded in this transmission, otherwise it was skipped
+  bool     crc;      ///< Code block CRC match, it includes the ones matched in previous transmissions
+  uint32_t nof_iter; ///< Number of LDPC iterations
+  uint32_t time_us;  ///< Rate dematching and decoding time in microseconds
+} srsran_sch_cb_res_nr_t;
+
 /**
  * @brief Groups NR-PUSCH data for reception
  */
 typedef struct {
-  uint8_t* payload;  ///< SCH payload
-  bool     crc;      ///< CRC match
-  float    avg_iter; ///< Average iterations
+  uint8_t*               payload;                           ///< SCH payload
+  bool                   crc;                               ///< CRC match
+  float                  avg_iter;                          ///< Average iterations
+  uint32_t               max_iter;                          ///< Maximum iterations of a code block
+  uint32_t               nof_cb;                            ///< Number of code blocks
+  uint32_t               time_us;                           ///< Code block decoding time in microseconds
+  srsran_sch_cb_res_nr_t cb[SRSRAN_SCH_NR_MAX_NOF_CB_LDPC]; ///< Per code block decoding statistics
 } srsran_sch_tb_res_nr_t;
 
 typedef struct SRSRAN_API {
@@ -76,6 +91,9 @@ typedef struct SRSRAN_API {
   /// LDPC Rate matcher
   srsran_ldpc_rm_t tx_rm;
   srsran_ldpc_rm_t rx_rm;
+
+  /// Optional pool of decoder threads, code blocks are decoded serially if NULL
+  srsran_sch_cb_pool_t* cb_pool;
 } srsran_sch_nr_t;
 
 /**
@@ -159,6 +177,24 @@ SRSRAN_API int srsran_sch_nr_init_rx(srsran_sch_nr_t* q, const srsran_sch_nr_arg
  */
 SRSRAN_API int srsran_sch_nr_set_carrier(srsran_sch_nr_t* q, const srsran_carrier_nr_t* carrier);
 
+/**
+ * @brief Creates a pool of code block decoding threads, every thread owns a receiver SCH object initialised with args
+ * @param pool Points at the pool object
+ * @param nof_workers Number of decoding threads, 0 decodes all code blocks in the calling thread
+ * @param args Provides static configuration arguments of the receiver SCH objects
+ * @return SRSRAN_SUCCESS if the initialization is successful, SRSRAN_ERROR otherwise
+ */
+SRSRAN_API int
+srsran_sch_nr_cb_pool_init(srsran_sch_cb_pool_t* pool, uint32_t nof_workers, const srsran_sch_nr_args_t* args);
+
+/**
+ * @brief Sets the pool of threads that decode the code blocks of a transport block in parallel. The pool can be shared
+ * among several SCH objects
+ * @param q Points ats the SCH object
+ * @param pool Points at the pool object, NULL decodes the code blocks serially
+ */
+SRSRAN_API void srsran_sch_nr_set_cb_pool(srsran_sch_nr_t* q, srsran_sch_cb_pool_t* pool);
+
 /**
  * @brief Free allocated resources used by an SCH intance
  * @param q Points ats the SCH object
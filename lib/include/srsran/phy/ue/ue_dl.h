@@ -74,6 +74,22 @@ typedef struct SRSRAN_API {
   uint32_t              nof_formats;
 } dci_blind_search_t;
 
+// UE-specific search space locations of a C-RNTI, for each CFI and subframe index
+typedef struct SRSRAN_API {
+  uint16_t              rnti;
+  uint32_t              nof_cce[SRSRAN_NOF_CFI][SRSRAN_NOF_SF_X_FRAME]; // Number of CCEs of the entry, 0 if not computed
+  uint32_t              nof_locations[SRSRAN_NOF_CFI][SRSRAN_NOF_SF_X_FRAME];
+  srsran_dci_location_t loc[SRSRAN_NOF_CFI][SRSRAN_NOF_SF_X_FRAME][SRSRAN_MAX_CANDIDATES_UE];
+} srsran_ue_dl_ss_cache_t;
+
+// PDCCH blind search statistics, accumulated since the last srsran_ue_dl_reset_pdcch_stats()
+typedef struct SRSRAN_API {
+  uint64_t nof_decoded;   // Candidate/format pairs decoded with the Viterbi decoder
+  uint64_t nof_skipped;   // Candidate/format pairs discarded by the LLR pre-screen
+  uint64_t nof_ss_hits;   // UE-specific search spaces taken from the cache
+  uint64_t nof_ss_misses; // UE-specific search spaces computed and stored in the cache
+} srsran_ue_dl_pdcch_stats_t;
+
 typedef struct SRSRAN_API {
   // Cell configuration
   srsran_cell_t cell;
@@ -102,6 +118,11 @@ typedef struct SRSRAN_API {
   cf_t*              sf_symbols[SRSRAN_MAX_PORTS];
   dci_blind_search_t current_ss_common;
 
+  // UE-specific search space cache and blind search statistics
+  srsran_ue_dl_ss_cache_t    ue_ss_cache;
+  srsran_ue_dl_pdcch_stats_t pdcch_stats;
+  bool                       dci_search_exhaustive; // Bypass the cache and the pre-screen, for testing
+
   srsran_dci_msg_t pending_ul_dci_msg[SRSRAN_MAX_DCI_MSG];
   uint32_t         pending_ul_dci_count;
 
@@ -197,6 +218,12 @@ SRSRAN_API int srsran_ue_dl_find_dl_dci(srsran_ue_dl_t*     q,
                                         uint16_t            rnti,
                                         srsran_dci_dl_t     dci_msg[SRSRAN_MAX_DCI_MSG]);
 
+SRSRAN_API void srsran_ue_dl_get_pdcch_stats(srsran_ue_dl_t* q, srsran_ue_dl_pdcch_stats_t* stats);
+
+SRSRAN_API void srsran_ue_dl_reset_pdcch_stats(srsran_ue_dl_t* q);
+
+SRSRAN_API void srsran_ue_dl_set_dci_search_exhaustive(srsran_ue_dl_t* q, bool exhaustive);
+
 SRSRAN_API int srsran_ue_dl_dci_to_pdsch_grant(srsran_ue_dl_t*       q,
                                                srsran_dl_sf_cfg_t*   sf,
                                                srsran_ue_dl_cfg_t*   cfg,
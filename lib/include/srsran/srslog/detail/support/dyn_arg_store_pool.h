@@ -24,6 +24,10 @@
 
 #include "srsran/srslog/bundled/fmt/printf.h"
 #include "srsran/srslog/detail/support/backend_capacity.h"
+#include "srsran/srslog/detail/support/thread_utils.h"
+#include <algorithm>
+#include <atomic>
+#include <memory>
 
 namespace srslog {
 
@@ -32,52 +36,139 @@ namespace detail {
 /// Keeps a pool of dynamic_format_arg_store objects. The main reason for this class is that the arg store objects are
 /// implemented with std::vectors, so we want to avoid allocating memory each time we create a new object. Instead,
 /// reserve memory for each vector during initialization and recycle the objects.
+/// Every thread keeps a small cache of free objects in front of the shared free list, which is only locked to move a
+/// batch of objects in or out of a cache. Producers allocate from their own cache and the backend worker deallocates
+/// into its own, so logging threads do not contend with each other or with the backend on every log entry.
 class dyn_arg_store_pool
 {
+  using store_type = fmt::dynamic_format_arg_store<fmt::printf_context>;
+
+  /// Number of objects moved at once between a thread cache and the shared free list.
+  static constexpr size_t batch_size = 16;
+
+  /// Objects and free list shared by all threads. Thread caches hold a weak reference to it, as they may outlive the
+  /// pool.
+  struct shared_state {
+    explicit shared_state(uint64_t id) : id(id) {}
+
+    const uint64_t           id;
+    std::vector<store_type>  pool;
+    std::vector<store_type*> free_list;
+    mutex                    m;
+    std::atomic<uint64_t>    nof_alloc_failures{0};
+  };
+
+  /// Free objects cached by a thread for the pool it used last.
+  struct thread_cache {
+    ~thread_cache() { detach(); }
+
+    /// Returns the cached objects to their pool, if it still exists, and empties the cache.
+    void detach()
+    {
+      if (auto state = owner.lock()) {
+        scoped_lock lock(state->m);
+        state->free_list.insert(state->free_list.end(), objs, objs + count);
+      }
+      owner.reset();
+      owner_id = 0;
+      count    = 0;
+    }
+
+    std::weak_ptr<shared_state> owner;
+    uint64_t                    owner_id = 0;
+    store_type*                 objs[2 * batch_size];
+    size_t                      count = 0;
+  };
+
 public:
-  dyn_arg_store_pool()
+  dyn_arg_store_pool() : state(std::make_shared<shared_state>(next_pool_id()))
   {
-    pool.resize(SRSLOG_QUEUE_CAPACITY);
-    for (auto& elem : pool) {
+    state->pool.resize(SRSLOG_QUEUE_CAPACITY);
+    for (auto& elem : state->pool) {
       // Reserve for 10 normal and 2 named arguments.
       elem.reserve(10, 2);
     }
-    free_list.reserve(SRSLOG_QUEUE_CAPACITY);
-    for (auto& elem : pool) {
-      free_list.push_back(&elem);
+    state->free_list.reserve(SRSLOG_QUEUE_CAPACITY);
+    for (auto& elem : state->pool) {
+      state->free_list.push_back(&elem);
     }
   }
 
+  dyn_arg_store_pool(const dyn_arg_store_pool&) = delete;
+  dyn_arg_store_pool& operator=(const dyn_arg_store_pool&) = delete;
+
   /// Returns a pointer to a free dyn arg store object, otherwise returns nullptr.
-  fmt::dynamic_format_arg_store<fmt::printf_context>* alloc()
+  store_type* alloc()
   {
-    scoped_lock lock(m);
-    if (free_list.empty()) {
+    thread_cache& cache = get_thread_cache();
+    if (cache.count == 0 && !refill(cache)) {
+      state->nof_alloc_failures.fetch_add(1, std::memory_order_relaxed);
       return nullptr;
     }
 
-    auto* p = free_list.back();
-    free_list.pop_back();
-
-    return p;
+    return cache.objs[--cache.count];
   }
 
   /// Deallocate the given dyn arg store object returning it to the pool.
-  void dealloc(fmt::dynamic_format_arg_store<fmt::printf_context>* p)
+  void dealloc(store_type* p)
   {
     if (!p) {
       return;
     }
 
     p->clear();
-    scoped_lock lock(m);
-    free_list.push_back(p);
+    thread_cache& cache = get_thread_cache();
+    if (cache.count == 2 * batch_size) {
+      spill(cache);
+    }
+    cache.objs[cache.count++] = p;
+  }
+
+  /// Number of allocations that failed because no object was free.
+  uint64_t get_nof_alloc_failures() const { return state->nof_alloc_failures.load(std::memory_order_relaxed); }
+
+private:
+  /// Unique identifier of each pool, so that a thread cache never mistakes a new pool for a destroyed one that lived
+  /// at the same address.
+  static uint64_t next_pool_id()
+  {
+    static std::atomic<uint64_t> counter{0};
+    return ++counter;
+  }
+
+  /// Returns the cache of the calling thread, moving it over to this pool if it was caching objects of another one.
+  thread_cache& get_thread_cache()
+  {
+    static thread_local thread_cache cache;
+    if (cache.owner_id != state->id) {
+      cache.detach();
+      cache.owner    = state;
+      cache.owner_id = state->id;
+    }
+    return cache;
+  }
+
+  /// Moves up to a batch of free objects from the shared free list into the cache. Returns false when none is free.
+  bool refill(thread_cache& cache)
+  {
+    scoped_lock lock(state->m);
+    size_t      n = (state->free_list.size() < batch_size) ? state->free_list.size() : size_t(batch_size);
+    std::copy(state->free_list.end() - n, state->free_list.end(), cache.objs);
+    state->free_list.resize(state->free_list.size() - n);
+    cache.count = n;
+    return n != 0;
+  }
+
+  /// Moves a batch of objects from the cache back to the shared free list.
+  void spill(thread_cache& cache)
+  {
+    cache.count -= batch_size;
+    scoped_lock lock(state->m);
+    state->free_list.insert(state->free_list.end(), cache.objs + cache.count, cache.objs + cache.count + batch_size);
   }
 
 private:
-  std::vector<fmt::dynamic_format_arg_store<fmt::printf_context> > pool;
-  std::vector<fmt::dynamic_format_arg_store<fmt::printf_context>*> free_list;
-  mutable mutex                                                    m;
+  std::shared_ptr<shared_state> state;
 };
 
 } // namespace detail
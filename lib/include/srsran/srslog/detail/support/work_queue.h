@@ -22,26 +22,51 @@
 #ifndef SRSLOG_DETAIL_SUPPORT_WORK_QUEUE_H
 #define SRSLOG_DETAIL_SUPPORT_WORK_QUEUE_H
 
-#include "srsran/adt/circular_buffer.h"
 #include "srsran/srslog/detail/support/backend_capacity.h"
-#include "srsran/srslog/detail/support/thread_utils.h"
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <utility>
 
 namespace srslog {
 
 namespace detail {
 
-//: TODO: this is a temp work queue.
-
 /// Thread safe generic data type work queue.
+/// It is a bounded lock-free queue for multiple producers and a single consumer. Each slot carries a sequence number
+/// that tells producers when the slot is free and the consumer when it holds a committed element, so producers only
+/// contend on the CAS that reserves a slot and never wait on each other or on the consumer.
+/// NOTE: try_pop and try_pop_batch must only be called from one thread at a time.
 template <typename T, size_t capacity = SRSLOG_QUEUE_CAPACITY>
 class work_queue
 {
-  srsran::dyn_circular_buffer<T> queue;
-  mutable mutex                  m;
-  static constexpr size_t        threshold = capacity * 0.98;
+  static_assert(capacity > 1 && (capacity & (capacity - 1)) == 0, "Queue capacity should be a power of two");
+
+  struct slot {
+    std::atomic<size_t> seq;
+    T                   value;
+  };
+
+  /// Index padded to a whole cache line, so that producers and the consumer do not invalidate each other's index.
+  struct padded_index {
+    std::atomic<size_t> value{0};
+    char                pad[64 - sizeof(std::atomic<size_t>)];
+  };
+
+  static constexpr size_t mask      = capacity - 1;
+  static constexpr size_t threshold = capacity * 0.98;
+  std::unique_ptr<slot[]> slots;
+  padded_index            tail;
+  padded_index            head;
+  std::atomic<uint64_t>   nof_dropped{0};
 
 public:
-  work_queue() : queue(capacity) {}
+  work_queue() : slots(new slot[capacity])
+  {
+    for (size_t i = 0; i != capacity; ++i) {
+      slots[i].seq.store(i, std::memory_order_relaxed);
+    }
+  }
 
   work_queue(const work_queue&) = delete;
   work_queue& operator=(const work_queue&) = delete;
@@ -50,14 +75,12 @@ public:
   /// queue is full, otherwise true.
   bool push(const T& value)
   {
-    m.lock();
-    // Discard the new element if we reach the maximum capacity.
-    if (queue.full()) {
-      m.unlock();
+    slot* s = reserve();
+    if (!s) {
       return false;
     }
-    queue.push(value);
-    m.unlock();
+    s->value = value;
+    commit(s);
 
     return true;
   }
@@ -66,14 +89,12 @@ public:
   /// queue is full, otherwise true.
   bool push(T&& value)
   {
-    m.lock();
-    // Discard the new element if we reach the maximum capacity.
-    if (queue.full()) {
-      m.unlock();
+    slot* s = reserve();
+    if (!s) {
       return false;
     }
-    queue.push(std::move(value));
-    m.unlock();
+    s->value = std::move(value);
+    commit(s);
 
     return true;
   }
@@ -82,31 +103,89 @@ public:
   /// Returns a pair with a bool indicating if the pop has been successful.
   std::pair<bool, T> try_pop()
   {
-    m.lock();
-
-    if (queue.empty()) {
-      m.unlock();
+    size_t pos = head.value.load(std::memory_order_relaxed);
+    slot&  s   = slots[pos & mask];
+    if (s.seq.load(std::memory_order_acquire) != pos + 1) {
       return {false, T()};
     }
 
-    // Here we have been woken up normally.
-    T Item = std::move(queue.top());
-    queue.pop();
+    T item = std::move(s.value);
+    release(s, pos);
 
-    m.unlock();
+    return {true, std::move(item)};
+  }
+
+  /// Extracts up to max_items elements from the front of the queue, passing each of them to func in order, and
+  /// returns the number of extracted elements. Slots are handed back to the producers one by one, so a slow func does
+  /// not hold back the rest of the queue.
+  template <typename Func>
+  size_t try_pop_batch(Func&& func, size_t max_items)
+  {
+    size_t pos = head.value.load(std::memory_order_relaxed);
+    size_t n   = 0;
+    for (; n != max_items; ++n, ++pos) {
+      slot& s = slots[pos & mask];
+      if (s.seq.load(std::memory_order_acquire) != pos + 1) {
+        break;
+      }
+
+      T item = std::move(s.value);
+      release(s, pos);
+      func(std::move(item));
+    }
 
-    return {true, std::move(Item)};
+    return n;
   }
 
   /// Capacity of the queue.
   size_t get_capacity() const { return capacity; }
 
+  /// Returns an estimate of the number of elements in the queue, including the ones being written by producers.
+  size_t size() const
+  {
+    // Read the consumer index first, so that it never goes past the producer one.
+    size_t h = head.value.load(std::memory_order_relaxed);
+    size_t t = tail.value.load(std::memory_order_relaxed);
+    return (t > h) ? t - h : 0;
+  }
+
+  /// Number of elements that have been discarded because the queue was full.
+  uint64_t get_nof_dropped() const { return nof_dropped.load(std::memory_order_relaxed); }
+
   /// Returns true when the queue is almost full, otherwise returns false.
-  bool is_almost_full() const
+  bool is_almost_full() const { return size() > threshold; }
+
+private:
+  /// Claims the slot at the back of the queue for the caller, returns nullptr when the queue is full.
+  slot* reserve()
   {
-    scoped_lock lock(m);
+    size_t pos = tail.value.load(std::memory_order_relaxed);
+    while (true) {
+      slot&     s    = slots[pos & mask];
+      size_t    seq  = s.seq.load(std::memory_order_acquire);
+      ptrdiff_t diff = static_cast<ptrdiff_t>(seq) - static_cast<ptrdiff_t>(pos);
+      if (diff == 0) {
+        if (tail.value.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+          return &s;
+        }
+      } else if (diff < 0) {
+        // Discard the new element if we reach the maximum capacity.
+        nof_dropped.fetch_add(1, std::memory_order_relaxed);
+        return nullptr;
+      } else {
+        pos = tail.value.load(std::memory_order_relaxed);
+      }
+    }
+  }
 
-    return queue.size() > threshold;
+  /// Publishes the value written into a reserved slot to the consumer.
+  static void commit(slot* s) { s->seq.store(s->seq.load(std::memory_order_relaxed) + 1, std::memory_order_release); }
+
+  /// Hands the slot at position pos back to the producers.
+  void release(slot& s, size_t pos)
+  {
+    s.seq.store(pos + capacity, std::memory_order_release);
+    head.value.store(pos + 1, std::memory_order_relaxed);
   }
 };
 
@@ -31,6 +31,8 @@ namespace detail {
 struct log_entry_metadata;
 }
 
+class binary_log_decoder;
+
 /// The generic metric value formatter.
 template <typename T>
 struct metric_value_formatter {
@@ -120,6 +122,9 @@ private:
   }
 
 private:
+  /// Replays the contexts recorded in binary logs through the callbacks below.
+  friend class binary_log_decoder;
+
   /// Derived classes should implement the following callbacks to format metric
   /// objects. Each callback is invoked at a different place of the formatting
   /// algorithm.
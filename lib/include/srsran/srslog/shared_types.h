@@ -22,6 +22,8 @@
 #ifndef SRSLOG_SHARED_TYPES_H
 #define SRSLOG_SHARED_TYPES_H
 
+#include <cstddef>
+#include <cstdint>
 #include <functional>
 #include <string>
 
@@ -40,6 +42,16 @@ enum class backend_priority {
   very_high
 };
 
+/// Counters of the log backend.
+struct backend_metrics {
+  /// Log entries discarded because the queue was full or no argument store was free.
+  uint64_t nof_dropped_entries;
+  /// Log entries waiting in the queue to be processed by the backend.
+  size_t queue_depth;
+  /// Maximum number of log entries the queue can hold.
+  size_t queue_capacity;
+};
+
 /// syslog log local types
 enum class syslog_local_type {
   local0,
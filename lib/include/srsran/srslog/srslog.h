@@ -195,6 +195,17 @@ sink& fetch_file_sink(const std::string&             path,
                       bool                           force_flush = false,
                       std::unique_ptr<log_formatter> f           = get_default_log_formatter());
 
+/// Returns an instance of a sink that writes log entries into a file in the
+/// specified path using a compact binary format. Entries are not rendered into
+/// text, which makes this sink much cheaper than a file sink for high log rates.
+/// Use the srslog_decoder tool to turn the file into text or JSON.
+/// Specifying a max_size value different to zero will make the sink create a
+/// new file each time the current file exceeds this value. The units of
+/// max_size are bytes. Each file can be decoded on its own.
+/// NOTE: Contents are buffered in memory until srslog::flush() is called or the
+/// buffer gets full.
+sink& fetch_binary_file_sink(const std::string& path, size_t max_size = 0);
+
 /// Returns an instance of a sink that writes into syslog
 /// preamble: The string  prepended to every message, If ident is "", the program name is used.
 /// log_local: custom unused facilities that syslog provides which can be used by the user
@@ -254,6 +265,10 @@ void flush();
 /// NOTE: This function should be called before init() and is NOT thread safe.
 void set_error_handler(error_handler handler);
 
+/// Returns the drop and queue depth counters of the log backend.
+/// NOTE: This function is thread safe.
+backend_metrics get_backend_metrics();
+
 } // namespace srslog
 
 #endif // SRSLOG_SRSLOG_H
@@ -73,6 +73,7 @@ extern "C" {
 #include "srsran/phy/fec/turbo/tc_interl.h"
 #include "srsran/phy/fec/turbo/turbocoder.h"
 #include "srsran/phy/fec/turbo/turbodecoder.h"
+#include "srsran/phy/fec/turbo/turbodecoder_batch.h"
 
 #include "srsran/phy/io/binsource.h"
 #include "srsran/phy/io/filesink.h"
@@ -114,6 +115,7 @@ extern "C" {
 #include "srsran/phy/phch/ra_ul_nr.h"
 #include "srsran/phy/phch/regs.h"
 #include "srsran/phy/phch/sch.h"
+#include "srsran/phy/phch/sch_cb_pool.h"
 #include "srsran/phy/phch/uci.h"
 #include "srsran/phy/phch/uci_nr.h"
 
@@ -24,25 +24,24 @@
 #include "srsran/common/threads.h"
 
 namespace srsran {
-mac_pcap::mac_pcap() : mac_pcap_base() {}
+mac_pcap::mac_pcap() : mac_pcap_base(), writer("PCAP_WRITER_MAC") {}
 
 mac_pcap::~mac_pcap()
 {
   close();
 }
 
-uint32_t mac_pcap::open(std::string filename_, uint32_t ue_id_)
+uint32_t mac_pcap::open(std::string filename_, uint32_t ue_id_, pcap_file_format format)
 {
   std::lock_guard<std::mutex> lock(mutex);
-  if (pcap_file != nullptr) {
+  if (writer.is_open()) {
     logger.error("PCAP writer for %s already running. Close first.", filename_.c_str());
     return SRSRAN_ERROR;
   }
 
   // set UDP DLT
-  dlt       = UDP_DLT;
-  pcap_file = DLT_PCAP_Open(dlt, filename_.c_str());
-  if (pcap_file == nullptr) {
+  dlt = UDP_DLT;
+  if (not writer.open(filename_, {{dlt, "mac"}}, format)) {
     logger.error("Couldn't open %s to write PCAP", filename_.c_str());
     return SRSRAN_ERROR;
   }
@@ -51,53 +50,58 @@ uint32_t mac_pcap::open(std::string filename_, uint32_t ue_id_)
   ue_id    = ue_id_;
   running  = true;
 
-  // start writer thread
-  start();
-
   return SRSRAN_SUCCESS;
 }
 
 uint32_t mac_pcap::close()
 {
-  {
-    std::lock_guard<std::mutex> lock(mutex);
-    if (running == false || pcap_file == nullptr) {
-      return SRSRAN_ERROR;
-    }
-
-    // tell writer thread to stop
-    running        = false;
-    pcap_pdu_t pdu = {};
-    queue.push_blocking(std::move(pdu));
+  std::lock_guard<std::mutex> lock(mutex);
+  if (not writer.is_open()) {
+    return SRSRAN_ERROR;
   }
 
-  wait_thread_finish();
-
-  // close file handle
-  {
-    std::lock_guard<std::mutex> lock(mutex);
-    srsran::console("Saving MAC PCAP (DLT=%d) to %s\n", dlt, filename.c_str());
-    DLT_PCAP_Close(pcap_file);
-    pcap_file = nullptr;
-  }
+  // stop accepting PDUs and write the remaining ones
+  running = false;
+  srsran::console("Saving MAC PCAP (DLT=%d) to %s\n", dlt, filename.c_str());
+  writer.close();
 
   return SRSRAN_SUCCESS;
 }
 
+pcap_writer_metrics_t mac_pcap::get_metrics()
+{
+  return writer.get_metrics();
+}
+
 void mac_pcap::write_pdu(srsran::mac_pcap_base::pcap_pdu_t& pdu)
 {
   if (pdu.pdu != nullptr) {
-    switch (pdu.rat) {
-      case srsran_rat_t::lte:
-        LTE_PCAP_MAC_UDP_WritePDU(pcap_file, &pdu.context, pdu.pdu->msg, pdu.pdu->N_bytes);
-        break;
-      case srsran_rat_t::nr:
-        NR_PCAP_MAC_UDP_WritePDU(pcap_file, &pdu.context_nr, pdu.pdu->msg, pdu.pdu->N_bytes);
-        break;
-      default:
-        logger.error("Error writing PDU to PCAP. Unsupported RAT selected.");
-    }
+    queue_pdu(pdu, pdu.pdu->msg, pdu.pdu->N_bytes);
+  }
+}
+
+// Function called from PHY worker context, the writer gives each thread its own ring
+void mac_pcap::queue_pdu(pcap_pdu_t& pdu, const uint8_t* payload, uint32_t payload_len)
+{
+  uint8_t context_header[PCAP_CONTEXT_HEADER_MAX] = {};
+  int     offset                                  = -1;
+  switch (pdu.rat) {
+    case srsran_rat_t::lte:
+      offset =
+          LTE_PCAP_PACK_MAC_UDP_HEADER_TO_BUFFER(&pdu.context, payload_len, context_header, sizeof(context_header));
+      break;
+    case srsran_rat_t::nr:
+      offset =
+          NR_PCAP_PACK_MAC_UDP_HEADER_TO_BUFFER(&pdu.context_nr, payload_len, context_header, sizeof(context_header));
+      break;
+    default:
+      logger.error("Error writing PDU to PCAP. Unsupported RAT selected.");
+  }
+
+  // Drops are counted by the writer and reported through the metrics
+  if (offset > 0 and not writer.write(0, context_header, offset, payload, payload_len)) {
+    logger.debug("Dropping PDU (%d B) in PCAP. Write ring full.", payload_len);
   }
 }
 
-} // namespace srsran
\ No newline at end of file
+} // namespace srsran
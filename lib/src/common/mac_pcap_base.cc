@@ -71,6 +71,26 @@ void mac_pcap_base::run_thread()
   }
 }
 
+// Function called from PHY worker context, locking not needed as PDU queue is thread-safe
+void mac_pcap_base::queue_pdu(pcap_pdu_t& pdu, const uint8_t* payload, uint32_t payload_len)
+{
+  const char* rat_str = (pdu.rat == srsran_rat_t::nr) ? "NR " : "";
+
+  // try to allocate PDU buffer
+  pdu.pdu = srsran::make_byte_buffer();
+  if (pdu.pdu != nullptr && pdu.pdu->get_tailroom() >= payload_len) {
+    // copy payload into PDU buffer
+    memcpy(pdu.pdu->msg, payload, payload_len);
+    pdu.pdu->N_bytes = payload_len;
+    if (not queue.try_push(std::move(pdu))) {
+      logger.warning("Dropping PDU (%d B) in %sPCAP. Write queue full.", payload_len, rat_str);
+    }
+  } else {
+    logger.warning(
+        "Dropping PDU in %sPCAP. No buffer available or not enough space (pdu_len=%d).", rat_str, payload_len);
+  }
+}
+
 // Function called from PHY worker context, locking not needed as PDU queue is thread-safe
 void mac_pcap_base::pack_and_queue(uint8_t* payload,
                                    uint32_t payload_len,
@@ -96,19 +116,7 @@ void mac_pcap_base::pack_and_queue(uint8_t* payload,
     pdu.context.cc_idx         = cc_idx;
     pdu.context.sysFrameNumber = (uint16_t)(tti / 10);
     pdu.context.subFrameNumber = (uint16_t)(tti % 10);
-
-    // try to allocate PDU buffer
-    pdu.pdu = srsran::make_byte_buffer();
-    if (pdu.pdu != nullptr && pdu.pdu->get_tailroom() >= payload_len) {
-      // copy payload into PDU buffer
-      memcpy(pdu.pdu->msg, payload, payload_len);
-      pdu.pdu->N_bytes = payload_len;
-      if (not queue.try_push(std::move(pdu))) {
-        logger.warning("Dropping PDU (%d B) in PCAP. Write queue full.", payload_len);
-      }
-    } else {
-      logger.warning("Dropping PDU in PCAP. No buffer available or not enough space (pdu_len=%d).", payload_len);
-    }
+    queue_pdu(pdu, payload, payload_len);
   }
 }
 
@@ -133,19 +141,7 @@ void mac_pcap_base::pack_and_queue_nr(uint8_t* payload,
     pdu.context_nr.harqid              = harqid;
     pdu.context_nr.system_frame_number = tti / 10;
     pdu.context_nr.sub_frame_number    = tti % 10;
-
-    // try to allocate PDU buffer
-    pdu.pdu = srsran::make_byte_buffer();
-    if (pdu.pdu != nullptr && pdu.pdu->get_tailroom() >= payload_len) {
-      // copy payload into PDU buffer
-      memcpy(pdu.pdu->msg, payload, payload_len);
-      pdu.pdu->N_bytes = payload_len;
-      if (not queue.try_push(std::move(pdu))) {
-        logger.warning("Dropping PDU (%d B) in NR PCAP. Write queue full.", payload_len);
-      }
-    } else {
-      logger.warning("Dropping PDU in NR PCAP. No buffer available or not enough space (pdu_len=%d).", payload_len);
-    }
+    queue_pdu(pdu, payload, payload_len);
   }
 }
 
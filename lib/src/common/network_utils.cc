@@ -267,6 +267,115 @@ bool start_listen(int fd)
   return true;
 }
 
+/***************************************************************
+ *                 Batched UDP transmission
+ **************************************************************/
+
+void udp_tx_batch::init(int fd_, uint32_t max_batch_size)
+{
+  fd           = fd_;
+  max_batch    = std::max(max_batch_size, 1u);
+  nof_failures = 0;
+  pdus.clear();
+  pdus.reserve(max_batch);
+  addrs.resize(max_batch);
+  iovs.resize(max_batch);
+  msgs.resize(max_batch);
+}
+
+bool udp_tx_batch::push(srsran::unique_byte_buffer_t pdu, const sockaddr_in& addr)
+{
+  addrs[pdus.size()] = addr;
+  pdus.push_back(std::move(pdu));
+  if (pdus.size() < max_batch) {
+    return true;
+  }
+  return flush();
+}
+
+bool udp_tx_batch::flush()
+{
+  uint32_t nof_pdus = pdus.size();
+  for (uint32_t i = 0; i < nof_pdus; ++i) {
+    iovs[i].iov_base            = pdus[i]->msg;
+    iovs[i].iov_len             = pdus[i]->N_bytes;
+    msgs[i]                     = {};
+    msgs[i].msg_hdr.msg_name    = &addrs[i];
+    msgs[i].msg_hdr.msg_namelen = sizeof(sockaddr_in);
+    msgs[i].msg_hdr.msg_iov     = &iovs[i];
+    msgs[i].msg_hdr.msg_iovlen  = 1;
+  }
+
+  bool     success  = true;
+  uint32_t nof_sent = 0;
+  while (nof_sent < nof_pdus) {
+    int n = sendmmsg(fd, &msgs[nof_sent], nof_pdus - nof_sent, 0);
+    if (n < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      // Drop the datagram that failed and carry on with the rest
+      logger.error("Error sending datagram to %s: %s", get_ip(addrs[nof_sent]).c_str(), strerror(errno));
+      success = false;
+      nof_failures++;
+      n = 1;
+    }
+    nof_sent += n;
+  }
+  pdus.clear();
+  return success;
+}
+
+void udp_rx_batch::init(uint32_t max_batch_size)
+{
+  uint32_t nof_pdus = std::max(max_batch_size, 1u);
+  pdus.resize(nof_pdus);
+  addrs.resize(nof_pdus);
+  iovs.resize(nof_pdus);
+  msgs.resize(nof_pdus);
+}
+
+int udp_rx_batch::recv(int fd)
+{
+  // Refill the byte buffers taken over since the previous reception
+  uint32_t nof_buffers = 0;
+  for (; nof_buffers < pdus.size(); ++nof_buffers) {
+    srsran::unique_byte_buffer_t& pdu = pdus[nof_buffers];
+    if (pdu == nullptr) {
+      pdu = srsran::make_byte_buffer();
+      if (pdu == nullptr) {
+        break;
+      }
+    }
+    pdu->clear();
+    iovs[nof_buffers].iov_base            = pdu->msg;
+    iovs[nof_buffers].iov_len             = pdu->get_tailroom();
+    msgs[nof_buffers]                     = {};
+    msgs[nof_buffers].msg_hdr.msg_name    = &addrs[nof_buffers];
+    msgs[nof_buffers].msg_hdr.msg_namelen = sizeof(sockaddr_in);
+    msgs[nof_buffers].msg_hdr.msg_iov     = &iovs[nof_buffers];
+    msgs[nof_buffers].msg_hdr.msg_iovlen  = 1;
+  }
+  if (nof_buffers == 0) {
+    logger.error("Unable to allocate byte buffer");
+    return -1;
+  }
+
+  int n_recv = recvmmsg(fd, msgs.data(), nof_buffers, MSG_DONTWAIT, nullptr);
+  if (n_recv < 0) {
+    if (errno == EAGAIN or errno == EINTR) {
+      logger.debug("Socket timeout reached");
+      return 0;
+    }
+    logger.error("Error reading from socket: %s", strerror(errno));
+    return -1;
+  }
+  for (int i = 0; i < n_recv; ++i) {
+    pdus[i]->N_bytes = msgs[i].msg_len;
+  }
+  return n_recv;
+}
+
 } // namespace net_utils
 
 /********************************************
@@ -657,4 +766,65 @@ make_sdu_handler(srslog::basic_logger& logger, srsran::task_queue_handle& queue,
   return socket_manager_itf::recv_callback_t(recvfrom_pdu_task(logger, queue, std::move(rx_callback)));
 }
 
+/**
+ * Description: Functor for the case the received data is in the form of unique_byte_buffer, and a recvmmsg(...) call
+ * is used to read several datagrams at once. The reception is done by a net_utils::udp_rx_batch, which keeps the byte
+ * buffers not consumed by a reception for the next one.
+ */
+class recvmmsg_pdu_task
+{
+public:
+  using callback_t = recvfrom_callback_t;
+  using batch_t    = std::vector<std::pair<srsran::unique_byte_buffer_t, sockaddr_in> >;
+
+  explicit recvmmsg_pdu_task(srslog::basic_logger&      logger,
+                             srsran::task_queue_handle& queue_,
+                             callback_t                 func_,
+                             uint32_t                   max_batch) :
+    queue(queue_), func(std::move(func_)), rx_batch(logger)
+  {
+    rx_batch.init(max_batch);
+  }
+
+  bool operator()(int fd)
+  {
+    // The first datagram is available, the following ones are read only if already queued in the socket
+    int n_recv = rx_batch.recv(fd);
+    if (n_recv <= 0) {
+      return true;
+    }
+
+    batch_t batch;
+    batch.reserve(n_recv);
+    for (int i = 0; i < n_recv; ++i) {
+      batch.emplace_back(std::move(rx_batch.pdu(i)), rx_batch.from(i));
+    }
+
+    // Defer handling of the received packets to provided queue
+    queue.push(std::bind(
+        [this](batch_t& sdus) {
+          for (auto& sdu : sdus) {
+            func(std::move(sdu.first), sdu.second);
+          }
+        },
+        std::move(batch)));
+
+    return true;
+  }
+
+private:
+  srsran::task_queue_handle& queue;
+  callback_t                 func;
+  net_utils::udp_rx_batch    rx_batch;
+};
+
+socket_manager_itf::recv_callback_t make_batch_sdu_handler(srslog::basic_logger&      logger,
+                                                           srsran::task_queue_handle& queue,
+                                                           recvfrom_callback_t        rx_callback,
+                                                           uint32_t                   max_batch_size)
+{
+  return socket_manager_itf::recv_callback_t(
+      recvmmsg_pdu_task(logger, queue, std::move(rx_callback), max_batch_size));
+}
+
 } // namespace srsran
@@ -146,23 +146,22 @@ inline int LTE_PCAP_MAC_WritePDU(FILE* fd, MAC_Context_Info_t* context, const un
   return 1;
 }
 
-/* Write an individual PDU (PCAP packet header + mac-context + mac-pdu) */
-inline int
-LTE_PCAP_MAC_UDP_WritePDU(FILE* fd, MAC_Context_Info_t* context, const unsigned char* PDU, unsigned int length)
+/* Packs the dummy UDP header, start string and MAC context that precede a MAC PDU */
+int LTE_PCAP_PACK_MAC_UDP_HEADER_TO_BUFFER(MAC_Context_Info_t* context,
+                                           unsigned int        pdu_length,
+                                           uint8_t*            buffer,
+                                           unsigned int        length)
 {
-  pcaprec_hdr_t  packet_header;
-  uint8_t        context_header[PCAP_CONTEXT_HEADER_MAX] = {};
-  int            offset                                  = 0;
+  int            offset = 0;
   struct udphdr* udp_header;
-  // uint16_t       tmp16;
 
-  /* Can't write if file wasn't successfully opened */
-  if (fd == NULL) {
-    printf("Error: Can't write to empty file handle\n");
-    return 0;
+  if (buffer == NULL || length < PCAP_CONTEXT_HEADER_MAX) {
+    printf("Error: Writing buffer null or length to small \n");
+    return -1;
   }
+
   // Add dummy UDP header, start with src and dest port
-  udp_header       = (struct udphdr*)context_header;
+  udp_header       = (struct udphdr*)buffer;
   udp_header->dest = htons(0xdead);
   offset += 2;
   udp_header->source = htons(0xbeef);
@@ -175,11 +174,30 @@ LTE_PCAP_MAC_UDP_WritePDU(FILE* fd, MAC_Context_Info_t* context, const unsigned
   offset += 2;
 
   // Start magic string
-  memcpy(&context_header[offset], MAC_LTE_START_STRING, strlen(MAC_LTE_START_STRING));
+  memcpy(&buffer[offset], MAC_LTE_START_STRING, strlen(MAC_LTE_START_STRING));
   offset += strlen(MAC_LTE_START_STRING);
 
-  offset += LTE_PCAP_PACK_MAC_CONTEXT_TO_BUFFER(context, &context_header[offset], PCAP_CONTEXT_HEADER_MAX);
-  udp_header->len = htons(length + offset);
+  offset += LTE_PCAP_PACK_MAC_CONTEXT_TO_BUFFER(context, &buffer[offset], PCAP_CONTEXT_HEADER_MAX);
+  udp_header->len = htons(pdu_length + offset);
+
+  return offset;
+}
+
+/* Write an individual PDU (PCAP packet header + mac-context + mac-pdu) */
+inline int
+LTE_PCAP_MAC_UDP_WritePDU(FILE* fd, MAC_Context_Info_t* context, const unsigned char* PDU, unsigned int length)
+{
+  pcaprec_hdr_t packet_header;
+  uint8_t       context_header[PCAP_CONTEXT_HEADER_MAX] = {};
+  int           offset                                  = 0;
+
+  /* Can't write if file wasn't successfully opened */
+  if (fd == NULL) {
+    printf("Error: Can't write to empty file handle\n");
+    return 0;
+  }
+
+  offset = LTE_PCAP_PACK_MAC_UDP_HEADER_TO_BUFFER(context, length, context_header, PCAP_CONTEXT_HEADER_MAX);
 
   /****************************************************************/
   /* PCAP Header                                                  */
@@ -397,21 +415,22 @@ inline int NR_PCAP_PACK_MAC_CONTEXT_TO_BUFFER(mac_nr_context_info_t* context, ui
   return offset;
 }
 
-/* Write an individual NR MAC PDU (PCAP packet header + UDP header + nr-mac-context + mac-pdu) */
-int NR_PCAP_MAC_UDP_WritePDU(FILE* fd, mac_nr_context_info_t* context, const unsigned char* PDU, unsigned int length)
+/* Packs the dummy UDP header, start string and NR MAC context that precede a NR MAC PDU */
+int NR_PCAP_PACK_MAC_UDP_HEADER_TO_BUFFER(mac_nr_context_info_t* context,
+                                          unsigned int           pdu_length,
+                                          uint8_t*               buffer,
+                                          unsigned int           length)
 {
-  uint8_t        context_header[PCAP_CONTEXT_HEADER_MAX] = {};
   struct udphdr* udp_header;
   int            offset = 0;
 
-  /* Can't write if file wasn't successfully opened */
-  if (fd == NULL) {
-    printf("Error: Can't write to empty file handle\n");
+  if (buffer == NULL || length < PCAP_CONTEXT_HEADER_MAX) {
+    printf("Error: Writing buffer null or length to small \n");
     return -1;
   }
 
   // Add dummy UDP header, start with src and dest port
-  udp_header       = (struct udphdr*)context_header;
+  udp_header       = (struct udphdr*)buffer;
   udp_header->dest = htons(0xdead);
   offset += 2;
   udp_header->source = htons(0xbeef);
@@ -424,17 +443,34 @@ int NR_PCAP_MAC_UDP_WritePDU(FILE* fd, mac_nr_context_info_t* context, const uns
   offset += 2;
 
   // Start magic string
-  memcpy(&context_header[offset], MAC_NR_START_STRING, strlen(MAC_NR_START_STRING));
+  memcpy(&buffer[offset], MAC_NR_START_STRING, strlen(MAC_NR_START_STRING));
   offset += strlen(MAC_NR_START_STRING);
 
-  offset += NR_PCAP_PACK_MAC_CONTEXT_TO_BUFFER(context, &context_header[offset], PCAP_CONTEXT_HEADER_MAX);
+  offset += NR_PCAP_PACK_MAC_CONTEXT_TO_BUFFER(context, &buffer[offset], PCAP_CONTEXT_HEADER_MAX);
 
-  udp_header->len = htons(offset + length);
+  udp_header->len = htons(offset + pdu_length);
 
   if (offset != 31) {
     printf("ERROR Does not match offset %d != 31\n", offset);
   }
 
+  return offset;
+}
+
+/* Write an individual NR MAC PDU (PCAP packet header + UDP header + nr-mac-context + mac-pdu) */
+int NR_PCAP_MAC_UDP_WritePDU(FILE* fd, mac_nr_context_info_t* context, const unsigned char* PDU, unsigned int length)
+{
+  uint8_t context_header[PCAP_CONTEXT_HEADER_MAX] = {};
+  int     offset                                  = 0;
+
+  /* Can't write if file wasn't successfully opened */
+  if (fd == NULL) {
+    printf("Error: Can't write to empty file handle\n");
+    return -1;
+  }
+
+  offset = NR_PCAP_PACK_MAC_UDP_HEADER_TO_BUFFER(context, length, context_header, PCAP_CONTEXT_HEADER_MAX);
+
   /****************************************************************/
   /* PCAP Header                                                  */
   struct timeval t;
@@ -452,4 +488,4 @@ int NR_PCAP_MAC_UDP_WritePDU(FILE* fd, mac_nr_context_info_t* context, const uns
   fwrite(PDU, 1, length, fd);
 
   return 1;
-}
\ No newline at end of file
+}
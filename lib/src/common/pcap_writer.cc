@@ -0,0 +1,464 @@
+/**
+ * Copyright 2013-2021 Software Radio Systems Limited
+ *
+ * This file is part of srsRAN.
+ *
+ * srsRAN is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsRAN is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+#include "srsran/common/pcap_writer.h"
+#include "srsran/common/pcap.h"
+#include "srsran/support/srsran_assert.h"
+#include <array>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <fcntl.h>
+#include <time.h>
+#include <unistd.h>
+
+namespace srsran {
+
+/// Alignment of the write buffer and of the chunks written with O_DIRECT
+static const uint32_t io_block_size = 4096;
+
+/// pcapng block types and option codes
+static const uint32_t PCAPNG_SHB_TYPE       = 0x0A0D0D0A;
+static const uint32_t PCAPNG_IDB_TYPE       = 0x00000001;
+static const uint32_t PCAPNG_EPB_TYPE       = 0x00000006;
+static const uint32_t PCAPNG_BYTE_ORDER     = 0x1A2B3C4D;
+static const uint16_t PCAPNG_OPT_ENDOFOPT   = 0;
+static const uint16_t PCAPNG_OPT_IF_NAME    = 2;
+static const uint16_t PCAPNG_OPT_IF_TSRESOL = 9;
+
+/// Snapshot length of the interfaces, same as the one of DLT_PCAP_Open()
+static const uint32_t PCAP_SNAPLEN = 65535;
+
+static uint32_t align_to(uint32_t len, uint32_t alignment)
+{
+  return (len + alignment - 1) & ~(alignment - 1);
+}
+
+/**
+ * Byte ring with a single producer and a single consumer. Records are stored contiguously, a record that does not fit
+ * before the end of the ring is preceded by a skip marker and stored at its beginning
+ */
+class pcap_writer::ring
+{
+public:
+  struct record_t {
+    uint32_t size; ///< Size of the record in the ring, including this header
+    uint32_t if_idx;
+    uint64_t timestamp_ns;
+    uint32_t len;
+    uint32_t reserved;
+  };
+
+  explicit ring(uint32_t size) : buffer(size), mask(size - 1) {}
+
+  bool push(uint32_t       if_idx,
+            uint64_t       timestamp_ns,
+            const uint8_t* header,
+            uint32_t       header_len,
+            const uint8_t* payload,
+            uint32_t       payload_len)
+  {
+    uint32_t size   = align_to(sizeof(record_t) + header_len + payload_len, record_alignment);
+    uint64_t head   = write_pos.value.load(std::memory_order_relaxed);
+    uint64_t tail   = read_pos.value.load(std::memory_order_acquire);
+    uint32_t pos    = head & mask;
+    uint32_t to_end = buffer.size() - pos;
+    uint32_t needed = (to_end < size) ? to_end + size : size;
+    if (buffer.size() - (head - tail) < needed) {
+      nof_dropped.fetch_add(1, std::memory_order_relaxed);
+      return false;
+    }
+
+    if (to_end < size) {
+      uint32_t skip = to_end | skip_flag;
+      memcpy(&buffer[pos], &skip, sizeof(skip));
+      head += to_end;
+      pos = 0;
+    }
+
+    record_t record = {size, if_idx, timestamp_ns, header_len + payload_len, 0};
+    memcpy(&buffer[pos], &record, sizeof(record));
+    memcpy(&buffer[pos + sizeof(record)], header, header_len);
+    memcpy(&buffer[pos + sizeof(record) + header_len], payload, payload_len);
+    write_pos.value.store(head + size, std::memory_order_release);
+    return true;
+  }
+
+  /// Passes every record in the ring to func, returns the number of records
+  template <typename Func>
+  uint32_t pop_all(Func&& func)
+  {
+    uint64_t tail  = read_pos.value.load(std::memory_order_relaxed);
+    uint64_t head  = write_pos.value.load(std::memory_order_acquire);
+    uint32_t count = 0;
+    while (tail != head) {
+      uint32_t pos = tail & mask;
+      uint32_t size;
+      memcpy(&size, &buffer[pos], sizeof(size));
+      if (size & skip_flag) {
+        tail += size & ~skip_flag;
+        continue;
+      }
+      record_t record;
+      memcpy(&record, &buffer[pos], sizeof(record));
+      func(record, &buffer[pos + sizeof(record)]);
+      tail += record.size;
+      ++count;
+    }
+    read_pos.value.store(tail, std::memory_order_release);
+    return count;
+  }
+
+  uint64_t get_nof_dropped() const { return nof_dropped.load(std::memory_order_relaxed); }
+
+private:
+  static const uint32_t record_alignment = 8;
+  static const uint32_t skip_flag        = 1U << 31U;
+
+  struct padded_pos {
+    std::atomic<uint64_t> value{0};
+    char                  pad[64 - sizeof(std::atomic<uint64_t>)];
+  };
+
+  std::vector<uint8_t>  buffer;
+  const uint32_t        mask;
+  padded_pos            write_pos;
+  padded_pos            read_pos;
+  std::atomic<uint64_t> nof_dropped{0};
+};
+
+/// Cache of the rings of the calling thread, tagged with the session of the writer they belong to
+namespace {
+struct thread_ring_cache {
+  struct entry_t {
+    uint64_t session_id;
+    void*    ring;
+  };
+  std::array<entry_t, 4> entries = {};
+  uint32_t               next    = 0;
+};
+thread_local thread_ring_cache ring_cache;
+std::atomic<uint64_t>          next_session_id{1};
+} // namespace
+
+pcap_writer::pcap_writer(const std::string& thread_name, uint32_t ring_size_) :
+  thread(thread_name), logger(srslog::fetch_basic_logger("PCAP", false)), ring_size(ring_size_)
+{
+  srsran_assert((ring_size & (ring_size - 1)) == 0, "The ring size must be a power of two");
+}
+
+pcap_writer::~pcap_writer()
+{
+  close();
+}
+
+bool pcap_writer::open(const std::string&                   filename,
+                       const std::vector<pcap_interface_t>& interfaces,
+                       pcap_file_format                     format_)
+{
+  if (running) {
+    logger.error("PCAP writer for %s already running. Close first.", filename.c_str());
+    return false;
+  }
+  if (interfaces.empty() or (format_ == pcap_file_format::pcap and interfaces.size() > 1)) {
+    logger.error("Invalid number of interfaces (%zd) for %s", interfaces.size(), filename.c_str());
+    return false;
+  }
+
+  fd        = ::open(filename.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_DIRECT, 0644);
+  direct_io = fd >= 0;
+  if (fd < 0 and errno == EINVAL) {
+    // File system without O_DIRECT support, e.g. tmpfs
+    fd = ::open(filename.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+  }
+  if (fd < 0) {
+    logger.error("Couldn't open %s to write PCAP: %s", filename.c_str(), strerror(errno));
+    return false;
+  }
+
+  if (buffer == nullptr) {
+    void* p = nullptr;
+    if (posix_memalign(&p, io_block_size, write_buffer_size) != 0) {
+      logger.error("Couldn't allocate PCAP write buffer");
+      ::close(fd);
+      fd = -1;
+      return false;
+    }
+    buffer.reset(static_cast<uint8_t*>(p));
+  }
+  buffer_len     = 0;
+  file_size      = 0;
+  format         = format_;
+  nof_interfaces = interfaces.size();
+
+  if (format == pcap_file_format::pcap) {
+    pcap_hdr_t file_header = {0xa1b2c3d4, 2, 4, 0, 0, PCAP_SNAPLEN, interfaces[0].dlt};
+    append(&file_header, sizeof(file_header));
+  } else {
+    int64_t  section_len = -1;
+    uint32_t shb_len     = 28;
+    uint16_t version[]   = {1, 0};
+    append(&PCAPNG_SHB_TYPE, 4);
+    append(&shb_len, 4);
+    append(&PCAPNG_BYTE_ORDER, 4);
+    append(version, sizeof(version));
+    append(&section_len, sizeof(section_len));
+    append(&shb_len, 4);
+
+    for (const pcap_interface_t& iface : interfaces) {
+      uint16_t name_len    = iface.name.size();
+      uint32_t idb_len     = 20 + 4 + align_to(name_len, 4) + 8 + 4;
+      uint16_t link[]      = {(uint16_t)iface.dlt, 0};
+      uint16_t name_opt[]  = {PCAPNG_OPT_IF_NAME, name_len};
+      uint16_t tsres_opt[] = {PCAPNG_OPT_IF_TSRESOL, 1};
+      uint8_t  tsres[]     = {9, 0, 0, 0}; // nanoseconds
+      uint16_t end_opt[]   = {PCAPNG_OPT_ENDOFOPT, 0};
+      uint8_t  padding[4]  = {};
+      append(&PCAPNG_IDB_TYPE, 4);
+      append(&idb_len, 4);
+      append(link, sizeof(link));
+      append(&PCAP_SNAPLEN, 4);
+      append(name_opt, sizeof(name_opt));
+      append(iface.name.data(), name_len);
+      append(padding, align_to(name_len, 4) - name_len);
+      append(tsres_opt, sizeof(tsres_opt));
+      append(tsres, sizeof(tsres));
+      append(end_opt, sizeof(end_opt));
+      append(&idb_len, 4);
+    }
+  }
+
+  {
+    // Rings of a previous session are reused by the same threads, without the packets written after its end
+    std::lock_guard<std::mutex> lock(rings_mutex);
+    for (const auto& r : rings) {
+      r->pop_all([](const ring::record_t& record, const uint8_t* data) {});
+    }
+    session_id = next_session_id.fetch_add(1, std::memory_order_relaxed);
+  }
+  running = true;
+  start();
+
+  return true;
+}
+
+void pcap_writer::close()
+{
+  if (not running.exchange(false)) {
+    return;
+  }
+  wait_thread_finish();
+
+  write_buffer(true);
+  if (direct_io and ftruncate(fd, file_size) != 0) {
+    logger.error("Error truncating PCAP file: %s", strerror(errno));
+  }
+  ::close(fd);
+  fd = -1;
+}
+
+pcap_writer::ring* pcap_writer::get_thread_ring()
+{
+  uint64_t id = session_id.load(std::memory_order_relaxed);
+  for (const auto& e : ring_cache.entries) {
+    if (e.session_id == id) {
+      return static_cast<ring*>(e.ring);
+    }
+  }
+
+  ring* r = nullptr;
+  {
+    std::lock_guard<std::mutex> lock(rings_mutex);
+    auto                        it = thread_rings.find(std::this_thread::get_id());
+    if (it != thread_rings.end()) {
+      r = it->second;
+    } else {
+      rings.emplace_back(new ring(ring_size));
+      r                                         = rings.back().get();
+      thread_rings[std::this_thread::get_id()] = r;
+    }
+  }
+
+  ring_cache.entries[ring_cache.next] = {id, r};
+  ring_cache.next                     = (ring_cache.next + 1) % ring_cache.entries.size();
+  return r;
+}
+
+bool pcap_writer::write(uint32_t       if_idx,
+                        const uint8_t* header,
+                        uint32_t       header_len,
+                        const uint8_t* payload,
+                        uint32_t       payload_len)
+{
+  if (not running.load(std::memory_order_acquire) or if_idx >= nof_interfaces) {
+    return false;
+  }
+  if (header_len + payload_len > max_packet_size) {
+    nof_oversized.fetch_add(1, std::memory_order_relaxed);
+    return false;
+  }
+
+  struct timespec ts;
+  clock_gettime(CLOCK_REALTIME, &ts);
+  uint64_t timestamp_ns = ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+
+  return get_thread_ring()->push(if_idx, timestamp_ns, header, header_len, payload, payload_len);
+}
+
+pcap_writer_metrics_t pcap_writer::get_metrics()
+{
+  pcap_writer_metrics_t metrics = {};
+  metrics.nof_pdus              = nof_pdus.load(std::memory_order_relaxed);
+  metrics.nof_bytes             = nof_bytes.load(std::memory_order_relaxed);
+  metrics.nof_dropped           = nof_oversized.load(std::memory_order_relaxed);
+
+  std::lock_guard<std::mutex> lock(rings_mutex);
+  for (const auto& r : rings) {
+    metrics.nof_dropped += r->get_nof_dropped();
+  }
+  return metrics;
+}
+
+void pcap_writer::run_thread()
+{
+  auto last_write = std::chrono::steady_clock::now();
+  while (running.load(std::memory_order_relaxed)) {
+    if (drain_rings()) {
+      continue;
+    }
+
+    // Keep the file reasonably up to date when the traffic is low
+    auto now = std::chrono::steady_clock::now();
+    if (buffer_len >= io_block_size and now - last_write > std::chrono::seconds(1)) {
+      write_buffer(false);
+      last_write = now;
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+
+  // Write what the producers left behind
+  drain_rings();
+}
+
+bool pcap_writer::drain_rings()
+{
+  {
+    // Rings are never removed, so only new ones need to be picked up
+    std::lock_guard<std::mutex> lock(rings_mutex);
+    for (size_t i = drain_list.size(); i < rings.size(); ++i) {
+      drain_list.push_back(rings[i].get());
+    }
+  }
+
+  uint32_t count = 0;
+  for (ring* r : drain_list) {
+    count += r->pop_all([this](const ring::record_t& record, const uint8_t* data) {
+      append_record(record.if_idx, record.timestamp_ns, data, record.len);
+    });
+  }
+  return count > 0;
+}
+
+void pcap_writer::append_record(uint32_t if_idx, uint64_t timestamp_ns, const uint8_t* data, uint32_t len)
+{
+  if (format == pcap_file_format::pcap) {
+    pcaprec_hdr_t header = {(unsigned int)(timestamp_ns / 1000000000ULL),
+                            (unsigned int)(timestamp_ns % 1000000000ULL / 1000),
+                            len,
+                            len};
+    append(&header, sizeof(header));
+    append(data, len);
+  } else {
+    uint32_t epb_len    = 28 + align_to(len, 4) + 4;
+    uint32_t header[]   = {PCAPNG_EPB_TYPE,
+                         epb_len,
+                         if_idx,
+                         (uint32_t)(timestamp_ns >> 32U),
+                         (uint32_t)timestamp_ns,
+                         len,
+                         len};
+    uint8_t  padding[4] = {};
+    append(header, sizeof(header));
+    append(data, len);
+    append(padding, align_to(len, 4) - len);
+    append(&epb_len, 4);
+  }
+
+  nof_pdus.fetch_add(1, std::memory_order_relaxed);
+  nof_bytes.fetch_add(len, std::memory_order_relaxed);
+}
+
+void pcap_writer::append(const void* data, uint32_t len)
+{
+  const uint8_t* p = static_cast<const uint8_t*>(data);
+  while (len > 0) {
+    if (buffer_len == write_buffer_size) {
+      write_buffer(false);
+    }
+    uint32_t n = std::min(len, write_buffer_size - buffer_len);
+    memcpy(buffer.get() + buffer_len, p, n);
+    buffer_len += n;
+    p += n;
+    len -= n;
+  }
+}
+
+/**
+ * Writes the buffer to the file. With O_DIRECT only whole blocks are written and the remainder is kept in the buffer,
+ * unless flush_all is set: then the last block is padded, and the file is truncated to its real size when closed
+ */
+bool pcap_writer::write_buffer(bool flush_all)
+{
+  uint32_t len = buffer_len;
+  if (direct_io) {
+    len = flush_all ? align_to(buffer_len, io_block_size) : buffer_len & ~(io_block_size - 1);
+    memset(buffer.get() + buffer_len, 0, len - std::min(len, buffer_len));
+  }
+
+  uint32_t written = 0;
+  while (written < len) {
+    ssize_t n = ::write(fd, buffer.get() + written, len - written);
+    if (n < 0 and errno == EINTR) {
+      continue;
+    }
+    if (n < 0 and errno == EINVAL and direct_io) {
+      // O_DIRECT accepted at open but not supported for writing, continue with buffered writes
+      fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) & ~O_DIRECT);
+      direct_io = false;
+      len       = buffer_len;
+      continue;
+    }
+    if (n < 0) {
+      logger.error("Error writing PCAP file: %s", strerror(errno));
+      buffer_len = 0;
+      return false;
+    }
+    written += n;
+  }
+
+  uint32_t data_len = std::min(len, buffer_len);
+  file_size += data_len;
+  buffer_len -= data_len;
+  memmove(buffer.get(), buffer.get() + data_len, buffer_len);
+  return true;
+}
+
+} // namespace srsran
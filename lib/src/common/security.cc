@@ -22,6 +22,7 @@
 #include "srsran/common/security.h"
 #include "srsran/common/liblte_security.h"
 #include "srsran/common/s3g.h"
+#include "srsran/common/security_aes.h"
 #include "srsran/common/ssl.h"
 #include "srsran/config.h"
 
@@ -781,7 +782,8 @@ uint8_t security_128_eia2(const uint8_t* key,
                           uint32_t       msg_len,
                           uint8_t*       mac)
 {
-  return liblte_security_128_eia2(key, count, bearer, direction, msg, msg_len, mac);
+  security_pdu_t pdu = {key, count, (uint8_t)bearer, direction, msg, msg_len, mac};
+  return security_aes_eia2(pdu);
 }
 
 uint8_t security_128_eia3(const uint8_t* key,
@@ -830,7 +832,8 @@ uint8_t security_128_eea2(uint8_t* key,
                           uint32_t msg_len,
                           uint8_t* msg_out)
 {
-  return liblte_security_encryption_eea2(key, count, bearer, direction, msg, msg_len * 8, msg_out);
+  security_pdu_t pdu = {key, count, bearer, direction, msg, msg_len, msg_out};
+  return security_aes_eea2(pdu);
 }
 
 uint8_t security_128_eea3(uint8_t* key,
@@ -0,0 +1,414 @@
+/**
+ * Copyright 2013-2021 Software Radio Systems Limited
+ *
+ * This file is part of srsRAN.
+ *
+ * srsRAN is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsRAN is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+#include "srsran/common/security_aes.h"
+#include "srsran/common/liblte_security.h"
+#include "srsran/config.h"
+#include <algorithm>
+#include <atomic>
+#include <string.h>
+
+#if defined(__x86_64__) && defined(__GNUC__)
+#define SECURITY_AES_X86
+#include <cpuid.h>
+#include <immintrin.h>
+
+#ifndef bit_VAES
+#define bit_VAES (1 << 9)
+#endif
+
+// The rest of the build may target a baseline x86-64, so the accelerated code is enabled per function, and only
+// called after checking the CPU at runtime
+#define AES_NI_TARGET __attribute__((target("aes,sse4.1")))
+#define VAES_TARGET __attribute__((target("aes,sse4.1,avx,avx2,vaes")))
+#endif // defined(__x86_64__) && defined(__GNUC__)
+
+namespace srsran {
+
+/******************************************************************************
+ * Generic implementation
+ *****************************************************************************/
+
+static void generic_eea2(const security_pdu_t& pdu)
+{
+  liblte_security_encryption_eea2(
+      const_cast<uint8_t*>(pdu.key), pdu.count, pdu.bearer, pdu.direction, pdu.msg, pdu.msg_len * 8, pdu.out);
+}
+
+static void generic_eia2(const security_pdu_t& pdu)
+{
+  liblte_security_128_eia2(pdu.key, pdu.count, pdu.bearer, pdu.direction, pdu.msg, pdu.msg_len, pdu.out);
+}
+
+#ifdef SECURITY_AES_X86
+
+/******************************************************************************
+ * CPU feature detection
+ *****************************************************************************/
+
+static bool cpu_has_aes_ni()
+{
+  unsigned int eax, ebx, ecx, edx;
+  if (__get_cpuid(1, &eax, &ebx, &ecx, &edx) == 0) {
+    return false;
+  }
+  return (ecx & bit_AES) != 0 and (ecx & bit_SSE4_1) != 0;
+}
+
+static bool cpu_has_vaes()
+{
+  unsigned int eax, ebx, ecx, edx;
+  if (not cpu_has_aes_ni() or __get_cpuid_max(0, nullptr) < 7) {
+    return false;
+  }
+
+  // The OS must save the YMM registers on context switches
+  __cpuid(1, eax, ebx, ecx, edx);
+  if ((ecx & bit_OSXSAVE) == 0 or (ecx & bit_AVX) == 0) {
+    return false;
+  }
+  uint32_t xcr0_lo, xcr0_hi;
+  __asm__("xgetbv" : "=a"(xcr0_lo), "=d"(xcr0_hi) : "c"(0));
+  if ((xcr0_lo & 0x6) != 0x6) {
+    return false;
+  }
+
+  __cpuid_count(7, 0, eax, ebx, ecx, edx);
+  return (ebx & bit_AVX2) != 0 and (ecx & bit_VAES) != 0;
+}
+
+/******************************************************************************
+ * AES-NI implementation
+ *****************************************************************************/
+
+struct aes128_key_schedule_t {
+  __m128i rk[11];
+};
+
+AES_NI_TARGET static inline __m128i aes128_expand_step(__m128i key, __m128i keygen)
+{
+  keygen = _mm_shuffle_epi32(keygen, 0xff);
+  key    = _mm_xor_si128(key, _mm_slli_si128(key, 4));
+  key    = _mm_xor_si128(key, _mm_slli_si128(key, 4));
+  key    = _mm_xor_si128(key, _mm_slli_si128(key, 4));
+  return _mm_xor_si128(key, keygen);
+}
+
+// The round constant of aeskeygenassist must be an immediate
+#define AES128_EXPAND_ROUND(rk, i, rcon)                                                                               \
+  rk[i] = aes128_expand_step(rk[i - 1], _mm_aeskeygenassist_si128(rk[i - 1], rcon))
+
+AES_NI_TARGET static void aes128_expand_key(const uint8_t* key, aes128_key_schedule_t& ks)
+{
+  ks.rk[0] = _mm_loadu_si128((const __m128i*)key);
+  AES128_EXPAND_ROUND(ks.rk, 1, 0x01);
+  AES128_EXPAND_ROUND(ks.rk, 2, 0x02);
+  AES128_EXPAND_ROUND(ks.rk, 3, 0x04);
+  AES128_EXPAND_ROUND(ks.rk, 4, 0x08);
+  AES128_EXPAND_ROUND(ks.rk, 5, 0x10);
+  AES128_EXPAND_ROUND(ks.rk, 6, 0x20);
+  AES128_EXPAND_ROUND(ks.rk, 7, 0x40);
+  AES128_EXPAND_ROUND(ks.rk, 8, 0x80);
+  AES128_EXPAND_ROUND(ks.rk, 9, 0x1b);
+  AES128_EXPAND_ROUND(ks.rk, 10, 0x36);
+}
+
+AES_NI_TARGET static inline __m128i aes128_encrypt_block(const aes128_key_schedule_t& ks, __m128i block)
+{
+  block = _mm_xor_si128(block, ks.rk[0]);
+  for (uint32_t r = 1; r < 10; ++r) {
+    block = _mm_aesenc_si128(block, ks.rk[r]);
+  }
+  return _mm_aesenclast_si128(block, ks.rk[10]);
+}
+
+/// EEA2 counter block: COUNT | BEARER | DIRECTION | 0..0, with the block index in the last 32 bits (big-endian)
+static void eea2_nonce(const security_pdu_t& pdu, uint8_t nonce[16])
+{
+  memset(nonce, 0, 16);
+  nonce[0] = (pdu.count >> 24) & 0xff;
+  nonce[1] = (pdu.count >> 16) & 0xff;
+  nonce[2] = (pdu.count >> 8) & 0xff;
+  nonce[3] = pdu.count & 0xff;
+  nonce[4] = ((pdu.bearer & 0x1f) << 3) | ((pdu.direction & 0x01) << 2);
+}
+
+/// Ciphers pdu from block first_block on, eight independent blocks at a time to keep the AES units busy
+AES_NI_TARGET static void
+aes_ni_ctr(const aes128_key_schedule_t& ks, const security_pdu_t& pdu, const uint8_t nonce[16], uint32_t first_block)
+{
+  static const uint32_t NOF_WAYS = 8;
+
+  __m128i  ctr        = _mm_loadu_si128((const __m128i*)nonce);
+  uint32_t nof_blocks = pdu.msg_len / 16;
+  uint32_t b          = first_block;
+
+  for (; b + NOF_WAYS <= nof_blocks; b += NOF_WAYS) {
+    __m128i x[NOF_WAYS];
+    for (uint32_t j = 0; j < NOF_WAYS; ++j) {
+      x[j] = _mm_xor_si128(_mm_insert_epi32(ctr, __builtin_bswap32(b + j), 3), ks.rk[0]);
+    }
+    for (uint32_t r = 1; r < 10; ++r) {
+      for (uint32_t j = 0; j < NOF_WAYS; ++j) {
+        x[j] = _mm_aesenc_si128(x[j], ks.rk[r]);
+      }
+    }
+    for (uint32_t j = 0; j < NOF_WAYS; ++j) {
+      x[j]      = _mm_aesenclast_si128(x[j], ks.rk[10]);
+      __m128i m = _mm_loadu_si128((const __m128i*)(pdu.msg + 16 * (b + j)));
+      _mm_storeu_si128((__m128i*)(pdu.out + 16 * (b + j)), _mm_xor_si128(m, x[j]));
+    }
+  }
+
+  for (; b < nof_blocks; ++b) {
+    __m128i x = aes128_encrypt_block(ks, _mm_insert_epi32(ctr, __builtin_bswap32(b), 3));
+    __m128i m = _mm_loadu_si128((const __m128i*)(pdu.msg + 16 * b));
+    _mm_storeu_si128((__m128i*)(pdu.out + 16 * b), _mm_xor_si128(m, x));
+  }
+
+  uint32_t tail_len = pdu.msg_len % 16;
+  if (tail_len > 0) {
+    uint8_t keystream[16];
+    _mm_storeu_si128((__m128i*)keystream, aes128_encrypt_block(ks, _mm_insert_epi32(ctr, __builtin_bswap32(b), 3)));
+    for (uint32_t i = 0; i < tail_len; ++i) {
+      pdu.out[16 * b + i] = pdu.msg[16 * b + i] ^ keystream[i];
+    }
+  }
+}
+
+/// As aes_ni_ctr(), with two blocks per VAES instruction. The blocks that do not fill a whole round are left to AES-NI
+VAES_TARGET static void vaes_ctr(const aes128_key_schedule_t& ks, const security_pdu_t& pdu, const uint8_t nonce[16])
+{
+  static const uint32_t NOF_WAYS = 8;
+
+  __m256i rk[11];
+  for (uint32_t r = 0; r < 11; ++r) {
+    rk[r] = _mm256_broadcastsi128_si256(ks.rk[r]);
+  }
+  __m256i  ctr        = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i*)nonce));
+  uint32_t nof_blocks = pdu.msg_len / 16;
+  uint32_t b          = 0;
+
+  for (; b + 2 * NOF_WAYS <= nof_blocks; b += 2 * NOF_WAYS) {
+    __m256i x[NOF_WAYS];
+    for (uint32_t j = 0; j < NOF_WAYS; ++j) {
+      x[j] = _mm256_insert_epi32(ctr, __builtin_bswap32(b + 2 * j), 3);
+      x[j] = _mm256_insert_epi32(x[j], __builtin_bswap32(b + 2 * j + 1), 7);
+      x[j] = _mm256_xor_si256(x[j], rk[0]);
+    }
+    for (uint32_t r = 1; r < 10; ++r) {
+      for (uint32_t j = 0; j < NOF_WAYS; ++j) {
+        x[j] = _mm256_aesenc_epi128(x[j], rk[r]);
+      }
+    }
+    for (uint32_t j = 0; j < NOF_WAYS; ++j) {
+      x[j]      = _mm256_aesenclast_epi128(x[j], rk[10]);
+      __m256i m = _mm256_loadu_si256((const __m256i*)(pdu.msg + 16 * (b + 2 * j)));
+      _mm256_storeu_si256((__m256i*)(pdu.out + 16 * (b + 2 * j)), _mm256_xor_si256(m, x[j]));
+    }
+  }
+  _mm256_zeroupper();
+
+  aes_ni_ctr(ks, pdu, nonce, b);
+}
+
+AES_NI_TARGET static void aes_ni_eea2(const security_pdu_t& pdu, bool use_vaes)
+{
+  aes128_key_schedule_t ks;
+  uint8_t               nonce[16];
+
+  aes128_expand_key(pdu.key, ks);
+  eea2_nonce(pdu, nonce);
+  if (use_vaes) {
+    vaes_ctr(ks, pdu, nonce);
+  } else {
+    aes_ni_ctr(ks, pdu, nonce, 0);
+  }
+}
+
+/// CMAC subkey derivation (RFC 4493, Section 2.3)
+static void cmac_double(const uint8_t in[16], uint8_t out[16])
+{
+  for (uint32_t i = 0; i < 15; ++i) {
+    out[i] = (in[i] << 1) | (in[i + 1] >> 7);
+  }
+  out[15] = (in[15] << 1) ^ ((in[0] & 0x80) ? 0x87 : 0x00);
+}
+
+/// Block of the CMAC input, which is COUNT | BEARER | DIRECTION | 0..0 (8 bytes) followed by the message. The last
+/// block comes padded and combined with its subkey
+AES_NI_TARGET static __m128i
+eia2_block(const security_pdu_t& pdu, uint32_t block, uint32_t nof_blocks, __m128i k1, __m128i k2)
+{
+  uint32_t len      = pdu.msg_len + 8;
+  uint32_t blk_off  = 16 * block;
+  bool     is_last  = block + 1 == nof_blocks;
+  bool     complete = blk_off + 16 <= len;
+
+  __m128i m;
+  if (block > 0 and complete) {
+    m = _mm_loadu_si128((const __m128i*)(pdu.msg + blk_off - 8));
+  } else {
+    uint8_t buf[16] = {};
+    if (block == 0) {
+      buf[0] = (pdu.count >> 24) & 0xff;
+      buf[1] = (pdu.count >> 16) & 0xff;
+      buf[2] = (pdu.count >> 8) & 0xff;
+      buf[3] = pdu.count & 0xff;
+      buf[4] = ((pdu.bearer & 0x1f) << 3) | ((pdu.direction & 0x01) << 2);
+      memcpy(&buf[8], pdu.msg, std::min(pdu.msg_len, 8U));
+    } else {
+      memcpy(buf, pdu.msg + blk_off - 8, len - blk_off);
+    }
+    if (not complete) {
+      buf[len - blk_off] = 0x80;
+    }
+    m = _mm_loadu_si128((const __m128i*)buf);
+  }
+  if (is_last) {
+    m = _mm_xor_si128(m, complete ? k1 : k2);
+  }
+  return m;
+}
+
+AES_NI_TARGET static void aes_ni_eia2(const security_pdu_t& pdu)
+{
+  aes128_key_schedule_t ks;
+  aes128_expand_key(pdu.key, ks);
+
+  uint8_t l[16], k[16];
+  _mm_storeu_si128((__m128i*)l, aes128_encrypt_block(ks, _mm_setzero_si128()));
+  cmac_double(l, k);
+  __m128i k1 = _mm_loadu_si128((const __m128i*)k);
+  cmac_double(k, l);
+  __m128i k2 = _mm_loadu_si128((const __m128i*)l);
+
+  uint32_t nof_blocks = (pdu.msg_len + 8 + 15) / 16;
+  __m128i  state      = _mm_setzero_si128();
+  for (uint32_t block = 0; block < nof_blocks; ++block) {
+    state = aes128_encrypt_block(ks, _mm_xor_si128(state, eia2_block(pdu, block, nof_blocks, k1, k2)));
+  }
+
+  uint8_t mac[16];
+  _mm_storeu_si128((__m128i*)mac, state);
+  memcpy(pdu.out, mac, 4);
+}
+
+#endif // SECURITY_AES_X86
+
+/******************************************************************************
+ * Runtime dispatch
+ *****************************************************************************/
+
+const char* to_string(security_aes_impl_t impl)
+{
+  switch (impl) {
+    case security_aes_impl_t::generic:
+      return "generic";
+    case security_aes_impl_t::aes_ni:
+      return "AES-NI";
+    case security_aes_impl_t::vaes:
+      return "VAES";
+  }
+  return "invalid";
+}
+
+security_aes_impl_t security_aes_detect_impl()
+{
+#ifdef SECURITY_AES_X86
+  if (cpu_has_vaes()) {
+    return security_aes_impl_t::vaes;
+  }
+  if (cpu_has_aes_ni()) {
+    return security_aes_impl_t::aes_ni;
+  }
+#endif // SECURITY_AES_X86
+  return security_aes_impl_t::generic;
+}
+
+static std::atomic<security_aes_impl_t>& current_impl()
+{
+  static std::atomic<security_aes_impl_t> impl{security_aes_detect_impl()};
+  return impl;
+}
+
+security_aes_impl_t security_aes_get_impl()
+{
+  return current_impl().load(std::memory_order_relaxed);
+}
+
+bool security_aes_set_impl(security_aes_impl_t impl)
+{
+  if (impl > security_aes_detect_impl()) {
+    return false;
+  }
+  current_impl().store(impl, std::memory_order_relaxed);
+  return true;
+}
+
+static bool valid_pdu(const security_pdu_t& pdu)
+{
+  return pdu.key != nullptr and pdu.msg != nullptr and pdu.out != nullptr;
+}
+
+int security_aes_eea2(const security_pdu_t& pdu)
+{
+  if (not valid_pdu(pdu)) {
+    return SRSRAN_ERROR;
+  }
+
+  switch (security_aes_get_impl()) {
+#ifdef SECURITY_AES_X86
+    case security_aes_impl_t::vaes:
+      aes_ni_eea2(pdu, true);
+      break;
+    case security_aes_impl_t::aes_ni:
+      aes_ni_eea2(pdu, false);
+      break;
+#endif // SECURITY_AES_X86
+    default:
+      generic_eea2(pdu);
+      break;
+  }
+  return SRSRAN_SUCCESS;
+}
+
+int security_aes_eia2(const security_pdu_t& pdu)
+{
+  if (not valid_pdu(pdu)) {
+    return SRSRAN_ERROR;
+  }
+
+  switch (security_aes_get_impl()) {
+#ifdef SECURITY_AES_X86
+    case security_aes_impl_t::vaes:
+    case security_aes_impl_t::aes_ni:
+      aes_ni_eia2(pdu);
+      break;
+#endif // SECURITY_AES_X86
+    default:
+      generic_eia2(pdu);
+      break;
+  }
+  return SRSRAN_SUCCESS;
+}
+
+} // namespace srsran
@@ -19,12 +19,119 @@
  *
  */
 
+#include <atomic>
+#include <condition_variable>
 #include <cstdlib>
+#include <functional>
+#include <mutex>
 #include <srsran/phy/channel/channel.h>
 #include <srsran/srsran.h>
+#include <thread>
 
 using namespace srsran;
 
+/**
+ * Fork-join pool of the parallel mode. run() hands out the jobs to the pool threads and the calling thread, and
+ * returns when all of them are done, so the channel state is only touched by one stage at a time.
+ */
+class channel::worker_pool
+{
+public:
+  explicit worker_pool(uint32_t nof_threads)
+  {
+    for (uint32_t i = 0; i < nof_threads; i++) {
+      threads.emplace_back([this]() { work_loop(); });
+    }
+  }
+
+  ~worker_pool()
+  {
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      quit = true;
+    }
+    cvar_start.notify_all();
+    for (std::thread& t : threads) {
+      t.join();
+    }
+  }
+
+  uint32_t nof_workers() const { return (uint32_t)threads.size() + 1; }
+
+  void run(uint32_t nof_jobs, const std::function<void(uint32_t)>& job)
+  {
+    std::unique_lock<std::mutex> lock(mutex);
+    current_job = &job;
+    total_jobs  = nof_jobs;
+    next_job    = 0;
+    nof_done    = 0;
+    generation++;
+    lock.unlock();
+    cvar_start.notify_all();
+
+    uint32_t count = do_jobs(job, nof_jobs);
+
+    // Wait for the pool threads that joined this run to leave it, so none picks up jobs of the next one
+    lock.lock();
+    nof_done += count;
+    cvar_done.wait(lock, [this]() { return nof_done == total_jobs && nof_active == 0; });
+    current_job = nullptr;
+  }
+
+private:
+  uint32_t do_jobs(const std::function<void(uint32_t)>& job, uint32_t nof_jobs)
+  {
+    uint32_t count = 0;
+    for (uint32_t i = next_job++; i < nof_jobs; i = next_job++) {
+      job(i);
+      count++;
+    }
+    return count;
+  }
+
+  void work_loop()
+  {
+    uint64_t                     last_generation = 0;
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+      cvar_start.wait(lock, [this, &last_generation]() { return quit || generation != last_generation; });
+      if (quit) {
+        return;
+      }
+      last_generation = generation;
+      if (current_job == nullptr) {
+        continue;
+      }
+
+      const std::function<void(uint32_t)>* job      = current_job;
+      uint32_t                             nof_jobs = total_jobs;
+      nof_active++;
+      lock.unlock();
+
+      uint32_t count = do_jobs(*job, nof_jobs);
+
+      lock.lock();
+      nof_active--;
+      nof_done += count;
+      if (nof_done == total_jobs && nof_active == 0) {
+        cvar_done.notify_one();
+      }
+    }
+  }
+
+  std::vector<std::thread>             threads;
+  std::mutex                           mutex;
+  std::condition_variable              cvar_start;
+  std::condition_variable              cvar_done;
+  const std::function<void(uint32_t)>* current_job = nullptr;
+  uint32_t                             total_jobs  = 0;
+  uint32_t                             nof_done    = 0;
+  uint32_t                             nof_active  = 0;
+  uint64_t                             generation  = 0;
+  bool                                 quit        = false;
+  std::atomic<uint32_t>                next_job    = {0};
+};
+
 channel::channel(const channel::args_t& channel_args, uint32_t _nof_channels, srslog::basic_logger& logger) :
   logger(logger)
 {
@@ -75,11 +182,12 @@ channel::channel(const channel::args_t& channel_args, uint32_t _nof_channels, sr
     }
   }
 
-  // Create AWGN channnel
-  if (channel_args.awgn_enable && ret == SRSRAN_SUCCESS) {
-    awgn = (srsran_channel_awgn_t*)calloc(sizeof(srsran_channel_awgn_t), 1);
-    ret  = srsran_channel_awgn_init(awgn, 1234);
-    srsran_channel_awgn_set_n0(awgn, args.awgn_signal_power_dBfs - args.awgn_snr_dB);
+  // Create AWGN channnel, channels processed concurrently cannot share the random generator
+  uint32_t nof_awgn = channel_args.nof_threads > 0 ? nof_channels : 1;
+  for (uint32_t i = 0; i < nof_awgn && channel_args.awgn_enable && ret == SRSRAN_SUCCESS; i++) {
+    awgn[i] = (srsran_channel_awgn_t*)calloc(sizeof(srsran_channel_awgn_t), 1);
+    ret     = srsran_channel_awgn_init(awgn[i], 1234 + i);
+    srsran_channel_awgn_set_n0(awgn[i], args.awgn_signal_power_dBfs - args.awgn_snr_dB);
   }
 
   // Create high speed train
@@ -94,6 +202,19 @@ channel::channel(const channel::args_t& channel_args, uint32_t _nof_channels, sr
     srsran_channel_rlf_init(rlf, channel_args.rlf_t_on_ms, channel_args.rlf_t_off_ms);
   }
 
+  // Create parallel mode workers and per channel buffers
+  if (channel_args.nof_threads > 0 && ret == SRSRAN_SUCCESS) {
+    workers = std::unique_ptr<worker_pool>(new worker_pool(channel_args.nof_threads));
+    for (uint32_t i = 0; i < nof_channels; i++) {
+      channel_buffer_in[i]  = srsran_vec_cf_malloc(buffer_size);
+      channel_buffer_out[i] = srsran_vec_cf_malloc(buffer_size);
+      if (!channel_buffer_in[i] || !channel_buffer_out[i]) {
+        ret = SRSRAN_ERROR;
+      }
+    }
+    init_fading_blocks();
+  }
+
   if (ret != SRSRAN_SUCCESS) {
     fprintf(stderr, "Error: Creating channel\n\n");
   }
@@ -101,6 +222,10 @@ channel::channel(const channel::args_t& channel_args, uint32_t _nof_channels, sr
 
 channel::~channel()
 {
+  // Stop the workers before releasing anything they could use
+  workers.reset();
+  free_fading_blocks();
+
   if (buffer_in) {
     free(buffer_in);
   }
@@ -109,11 +234,6 @@ channel::~channel()
     free(buffer_out);
   }
 
-  if (awgn) {
-    srsran_channel_awgn_free(awgn);
-    free(awgn);
-  }
-
   if (hst) {
     srsran_channel_hst_free(hst);
     free(hst);
@@ -125,6 +245,19 @@ channel::~channel()
   }
 
   for (uint32_t i = 0; i < nof_channels; i++) {
+    if (awgn[i]) {
+      srsran_channel_awgn_free(awgn[i]);
+      free(awgn[i]);
+    }
+
+    if (channel_buffer_in[i]) {
+      free(channel_buffer_in[i]);
+    }
+
+    if (channel_buffer_out[i]) {
+      free(channel_buffer_out[i]);
+    }
+
     if (fading[i]) {
       srsran_channel_fading_free(fading[i]);
       free(fading[i]);
@@ -137,6 +270,36 @@ channel::~channel()
   }
 }
 
+void channel::init_fading_blocks()
+{
+  // Each channel can be split in as many blocks as workers
+  for (uint32_t i = 0; i < nof_channels && workers != nullptr; i++) {
+    if (fading[i]) {
+      fading_blocks[i].resize(workers->nof_workers());
+      for (srsran_channel_fading_block_t& b : fading_blocks[i]) {
+        if (srsran_channel_fading_block_init(&b, fading[i]) < SRSRAN_SUCCESS) {
+          logger.error("Error initialising fading blocks, channel %d fading will not be split", i);
+          for (srsran_channel_fading_block_t& c : fading_blocks[i]) {
+            srsran_channel_fading_block_free(&c);
+          }
+          fading_blocks[i].clear();
+          break;
+        }
+      }
+    }
+  }
+}
+
+void channel::free_fading_blocks()
+{
+  for (uint32_t i = 0; i < nof_channels; i++) {
+    for (srsran_channel_fading_block_t& b : fading_blocks[i]) {
+      srsran_channel_fading_block_free(&b);
+    }
+    fading_blocks[i].clear();
+  }
+}
+
 extern "C" {
 static inline cf_t local_cexpf(float phase)
 {
@@ -157,6 +320,44 @@ void channel::run(cf_t*                     in[SRSRAN_MAX_CHANNELS],
     return;
   }
 
+  if (workers != nullptr && current_srate != 0) {
+    run_parallel(in, out, len, t);
+  } else {
+    run_serial(in, out, len, t);
+  }
+
+  if (hst) {
+    // Increment phase to keep it coherent between frames
+    hst_init_phase += (2 * M_PI * len * hst->fs_hz / hst->srate_hz);
+
+    // Positive Remainder
+    while (hst_init_phase > 2 * M_PI) {
+      hst_init_phase -= 2 * M_PI;
+    }
+
+    // Negative Remainder
+    while (hst_init_phase < -2 * M_PI) {
+      hst_init_phase += 2 * M_PI;
+    }
+  }
+
+  // Logging
+  std::stringstream str;
+  str << "Channel: t=" << t.full_secs + t.frac_secs << "s; ";
+  if (delay[0]) {
+    str << "delay=" << delay[0]->delay_us << "us; ";
+  }
+  if (hst) {
+    str << "hst=" << hst->fs_hz << "Hz; ";
+  }
+  logger.debug("%s", str.str().c_str());
+}
+
+void channel::run_serial(cf_t*                     in[SRSRAN_MAX_CHANNELS],
+                         cf_t*                     out[SRSRAN_MAX_CHANNELS],
+                         uint32_t                  len,
+                         const srsran_timestamp_t& t)
+{
   // For each channel
   for (uint32_t i = 0; i < nof_channels; i++) {
     // Skip iteration if any buffer is null
@@ -180,8 +381,8 @@ void channel::run(cf_t*                     in[SRSRAN_MAX_CHANNELS],
       srsran_vec_sc_prod_ccc(buffer_out, local_cexpf(hst_init_phase), buffer_in, len);
     }
 
-    if (awgn) {
-      srsran_channel_awgn_run_c(awgn, buffer_in, buffer_out, len);
+    if (awgn[0]) {
+      srsran_channel_awgn_run_c(awgn[0], buffer_in, buffer_out, len);
       srsran_vec_cf_copy(buffer_in, buffer_out, len);
     }
 
@@ -203,37 +404,113 @@ void channel::run(cf_t*                     in[SRSRAN_MAX_CHANNELS],
     // Copy output buffer
     srsran_vec_cf_copy(out[i], buffer_in, len);
   }
+}
 
+void channel::run_parallel(cf_t*                     in[SRSRAN_MAX_CHANNELS],
+                           cf_t*                     out[SRSRAN_MAX_CHANNELS],
+                           uint32_t                  len,
+                           const srsran_timestamp_t& t)
+{
+  double init_time = t.full_secs + t.frac_secs;
+
+  // The doppler shift is common to all channels
   if (hst) {
-    // Increment phase to keep it coherent between frames
-    hst_init_phase += (2 * M_PI * len * hst->fs_hz / hst->srate_hz);
+    srsran_channel_hst_update(hst, &t);
+  }
 
-    // Positive Remainder
-    while (hst_init_phase > 2 * M_PI) {
-      hst_init_phase -= 2 * M_PI;
+  // Split the fading of each channel in blocks of whole N/2 sample segments, so that all workers get a share
+  bool     split      = fading[0] && !fading_blocks[0].empty();
+  uint32_t nof_blocks = 1;
+  uint32_t block_len  = len;
+  if (split) {
+    uint32_t segment_len    = fading[0]->N / 2;
+    uint32_t nof_segments   = SRSRAN_MAX(SRSRAN_CEIL(len, segment_len), 1);
+    uint32_t max_blocks     = SRSRAN_CEIL(workers->nof_workers(), nof_channels);
+    max_blocks              = SRSRAN_MIN(max_blocks, (uint32_t)fading_blocks[0].size());
+    uint32_t segs_per_block = SRSRAN_CEIL(nof_segments, max_blocks);
+    block_len               = segs_per_block * segment_len;
+    nof_blocks              = SRSRAN_CEIL(len, block_len);
+  }
+
+  // Stage 1: doppler shift and noise of each channel
+  workers->run(nof_channels, [this, in, out, len](uint32_t i) {
+    if (in[i] == nullptr || out[i] == nullptr) {
+      return;
     }
+    cf_t* bin  = channel_buffer_in[i];
+    cf_t* bout = channel_buffer_out[i];
 
-    // Negative Remainder
-    while (hst_init_phase < -2 * M_PI) {
-      hst_init_phase += 2 * M_PI;
+    srsran_vec_cf_copy(bin, in[i], len);
+
+    if (hst) {
+      srsran_channel_hst_apply(hst, bin, bout, len);
+      srsran_vec_sc_prod_ccc(bout, local_cexpf(hst_init_phase), bin, len);
     }
-  }
 
-  // Logging
-  std::stringstream str;
-  str << "Channel: t=" << t.full_secs + t.frac_secs << "s; ";
-  if (delay[0]) {
-    str << "delay=" << delay[0]->delay_us << "us; ";
-  }
-  if (hst) {
-    str << "hst=" << hst->fs_hz << "Hz; ";
+    if (awgn[i]) {
+      srsran_channel_awgn_run_c(awgn[i], bin, bout, len);
+      srsran_vec_cf_copy(bin, bout, len);
+    }
+  });
+
+  // Stage 2: fading of every block of every channel, channels without blocks are filtered as a whole in stage 3
+  if (split) {
+    workers->run(nof_channels * nof_blocks, [this, in, out, len, nof_blocks, block_len, init_time](uint32_t j) {
+      uint32_t i = j / nof_blocks;
+      uint32_t b = j % nof_blocks;
+      if (in[i] == nullptr || out[i] == nullptr || fading_blocks[i].size() != fading_blocks[0].size()) {
+        return;
+      }
+      uint32_t offset = b * block_len;
+      srsran_channel_fading_execute_block(fading[i],
+                                          &fading_blocks[i][b],
+                                          &channel_buffer_in[i][offset],
+                                          &channel_buffer_out[i][offset],
+                                          SRSRAN_MIN(block_len, len - offset),
+                                          init_time + (double)offset / current_srate);
+    });
   }
-  logger.debug("%s", str.str().c_str());
+
+  // Stage 3: merge the fading blocks, then delay and radio link failure of each channel
+  workers->run(nof_channels, [this, in, out, len, nof_blocks, block_len, split, init_time, &t](uint32_t i) {
+    if (in[i] == nullptr || out[i] == nullptr) {
+      return;
+    }
+    cf_t* bin  = channel_buffer_in[i];
+    cf_t* bout = channel_buffer_out[i];
+
+    if (fading[i] && split && fading_blocks[i].size() == fading_blocks[0].size()) {
+      for (uint32_t b = 0; b < nof_blocks; b++) {
+        uint32_t offset = b * block_len;
+        srsran_channel_fading_merge_block(
+            fading[i], &fading_blocks[i][b], &bout[offset], SRSRAN_MIN(block_len, len - offset));
+      }
+      srsran_vec_cf_copy(bin, bout, len);
+    } else if (fading[i]) {
+      srsran_channel_fading_execute(fading[i], bin, bout, len, init_time);
+      srsran_vec_cf_copy(bin, bout, len);
+    }
+
+    if (delay[i]) {
+      srsran_channel_delay_execute(delay[i], bin, bout, len, &t);
+      srsran_vec_cf_copy(bin, bout, len);
+    }
+
+    if (rlf) {
+      srsran_channel_rlf_execute(rlf, bin, bout, len, &t);
+      srsran_vec_cf_copy(bin, bout, len);
+    }
+
+    srsran_vec_cf_copy(out[i], bin, len);
+  });
 }
 
 void channel::set_srate(uint32_t srate)
 {
   if (current_srate != srate) {
+    // Fading blocks depend on the FFT size
+    free_fading_blocks();
+
     for (uint32_t i = 0; i < nof_channels; i++) {
       if (fading[i]) {
         srsran_channel_fading_free(fading[i]);
@@ -250,6 +527,8 @@ void channel::set_srate(uint32_t srate)
       srsran_channel_hst_update_srate(hst, srate);
     }
 
+    init_fading_blocks();
+
     // Update sampling rate
     current_srate = srate;
   }
@@ -257,7 +536,9 @@ void channel::set_srate(uint32_t srate)
 
 void channel::set_signal_power_dBfs(float power_dBfs)
 {
-  if (awgn != nullptr) {
-    srsran_channel_awgn_set_n0(awgn, power_dBfs - args.awgn_snr_dB);
+  for (srsran_channel_awgn_t* a : awgn) {
+    if (a != nullptr) {
+      srsran_channel_awgn_set_n0(a, power_dBfs - args.awgn_snr_dB);
+    }
   }
 }
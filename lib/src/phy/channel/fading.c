@@ -21,11 +21,13 @@
 
 #include "srsran/phy/channel/fading.h"
 #include "srsran/phy/utils/random.h"
+#include "srsran/phy/utils/simd.h"
 #include "srsran/phy/utils/vector.h"
 #include <math.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <strings.h>
 
 /*
  * Tables provided in 36.104 R10 section B.2 Multi-path fading propagation conditions
@@ -89,7 +91,7 @@ static inline __m128 _sine(const float* table, __m128 arg)
       _mm_round_ps(_mm_mul_ps(arg, _mm_set1_ps(1.0f / (2.0f * (float)M_PI))), (_MM_FROUND_TO_ZERO + _MM_FROUND_NO_EXC));
   __m128  argmod   = _mm_sub_ps(arg, _mm_mul_ps(turns, _mm_set1_ps(2.0f * (float)M_PI)));
   __m128  indexps  = _mm_mul_ps(argmod, _mm_set1_ps(1024.0f / (2.0f * (float)M_PI)));
-  __m128i indexi32 = _mm_abs_epi32(_mm_cvtps_epi32(indexps));
+  __m128i indexi32 = _mm_and_si128(_mm_cvtps_epi32(indexps), _mm_set1_epi32(1023));
   _mm_store_si128((__m128i*)idx, indexi32);
 
   for (int i = 0; i < 4; i++) {
@@ -99,58 +101,112 @@ static inline __m128 _sine(const float* table, __m128 arg)
   ret = _mm_load_ps(sine);
   return ret;
 }
+#endif /*LV_HAVE_SSE*/
 
-static inline __m128 _cosine(float* table, __m128 arg)
+#ifdef LV_HAVE_AVX2
+static inline __m256 _sine8(const float* table, __m256 arg)
 {
-  arg = _mm_add_ps(arg, _mm_set1_ps((float)M_PI_2));
-  return _sine(table, arg);
+  __m256 turns = _mm256_round_ps(_mm256_mul_ps(arg, _mm256_set1_ps(1.0f / (2.0f * (float)M_PI))),
+                                 (_MM_FROUND_TO_ZERO + _MM_FROUND_NO_EXC));
+  __m256  argmod   = _mm256_sub_ps(arg, _mm256_mul_ps(turns, _mm256_set1_ps(2.0f * (float)M_PI)));
+  __m256  indexps  = _mm256_mul_ps(argmod, _mm256_set1_ps(1024.0f / (2.0f * (float)M_PI)));
+  __m256i indexi32 = _mm256_and_si256(_mm256_cvtps_epi32(indexps), _mm256_set1_epi32(1023));
+
+  return _mm256_i32gather_ps(table, indexi32, 4);
 }
-#endif /*LV_HAVE_SSE*/
+#endif /*LV_HAVE_AVX2*/
 
-static inline cf_t
-get_doppler_dispersion(srsran_channel_fading_t* q, float t, float F_d, float* alpha, float* a, float* b)
+#ifdef LV_HAVE_AVX512
+static inline __m512 _sine16(const float* table, __m512 arg)
 {
-#ifdef LV_HAVE_SSE
-  const float recN   = 1.0f / sqrtf(SRSRAN_CHANNEL_FADING_NTERMS);
-  cf_t        ret    = 0;
-  __m128      _reacc = _mm_setzero_ps();
-  __m128      _imacc = _mm_setzero_ps();
-  __m128      _arg   = _mm_set1_ps((float)M_PI * F_d);
-  __m128      _t     = _mm_set1_ps(t);
-  __m128      _arg_  = (_mm_mul_ps(_arg, _t));
+  __m512 turns = _mm512_roundscale_ps(_mm512_mul_ps(arg, _mm512_set1_ps(1.0f / (2.0f * (float)M_PI))),
+                                      (_MM_FROUND_TO_ZERO + _MM_FROUND_NO_EXC));
+  __m512  argmod   = _mm512_sub_ps(arg, _mm512_mul_ps(turns, _mm512_set1_ps(2.0f * (float)M_PI)));
+  __m512  indexps  = _mm512_mul_ps(argmod, _mm512_set1_ps(1024.0f / (2.0f * (float)M_PI)));
+  __m512i indexi32 = _mm512_and_si512(_mm512_cvtps_epi32(indexps), _mm512_set1_epi32(1023));
+
+  return _mm512_i32gather_ps(indexi32, table, 4);
+}
+#endif /*LV_HAVE_AVX512*/
+
+/*
+ * Sum of sinusoids (Jakes) model of one tap: the real part adds cos(w*t + a), the imaginary part sin(w*t + b), where
+ * w = pi * F_d * cos(alpha) is precomputed at initialisation. Sines are read from a 1024 entry table.
+ */
+static inline cf_t get_doppler_dispersion(srsran_channel_fading_t* q, float t, float* w, float* a, float* b)
+{
+  const float recN = 1.0f / sqrtf(SRSRAN_CHANNEL_FADING_NTERMS);
+  cf_t        ret  = 0;
+
+#if defined(LV_HAVE_AVX512)
+  __m512 _reacc = _mm512_setzero_ps();
+  __m512 _imacc = _mm512_setzero_ps();
+  __m512 _t     = _mm512_set1_ps(t);
+  __m512 _pi_2  = _mm512_set1_ps((float)M_PI_2);
+
+  for (int i = 0; i < SRSRAN_CHANNEL_FADING_NTERMS; i += 16) {
+    __m512 _arg = _mm512_mul_ps(_mm512_loadu_ps(&w[i]), _t);
+    __m512 _re  = _sine16(q->sin_table, _mm512_add_ps(_mm512_add_ps(_arg, _mm512_loadu_ps(&a[i])), _pi_2));
+    __m512 _im  = _sine16(q->sin_table, _mm512_add_ps(_arg, _mm512_loadu_ps(&b[i])));
+    _reacc      = _mm512_add_ps(_reacc, _re);
+    _imacc      = _mm512_add_ps(_imacc, _im);
+  }
+
+  __real__ ret = _mm512_reduce_add_ps(_reacc);
+  __imag__ ret = _mm512_reduce_add_ps(_imacc);
+
+#elif defined(LV_HAVE_AVX2)
+  __m256 _reacc = _mm256_setzero_ps();
+  __m256 _imacc = _mm256_setzero_ps();
+  __m256 _t     = _mm256_set1_ps(t);
+  __m256 _pi_2  = _mm256_set1_ps((float)M_PI_2);
+
+  for (int i = 0; i < SRSRAN_CHANNEL_FADING_NTERMS; i += 8) {
+    __m256 _arg = _mm256_mul_ps(_mm256_loadu_ps(&w[i]), _t);
+    __m256 _re  = _sine8(q->sin_table, _mm256_add_ps(_mm256_add_ps(_arg, _mm256_loadu_ps(&a[i])), _pi_2));
+    __m256 _im  = _sine8(q->sin_table, _mm256_add_ps(_arg, _mm256_loadu_ps(&b[i])));
+    _reacc      = _mm256_add_ps(_reacc, _re);
+    _imacc      = _mm256_add_ps(_imacc, _im);
+  }
+
+  __m256 _tmp = _mm256_hadd_ps(_reacc, _imacc);
+  _tmp        = _mm256_hadd_ps(_tmp, _tmp);
+  __m128 _sum = _mm_add_ps(_mm256_castps256_ps128(_tmp), _mm256_extractf128_ps(_tmp, 1));
+  float  r[4];
+  _mm_storeu_ps(r, _sum);
+  __real__ ret = r[0];
+  __imag__ ret = r[1];
+
+#elif defined(LV_HAVE_SSE)
+  __m128 _reacc = _mm_setzero_ps();
+  __m128 _imacc = _mm_setzero_ps();
+  __m128 _t     = _mm_set1_ps(t);
+  __m128 _pi_2  = _mm_set1_ps((float)M_PI_2);
 
   for (int i = 0; i < SRSRAN_CHANNEL_FADING_NTERMS; i += 4) {
-    __m128 _alpha = _mm_loadu_ps(&alpha[i]);
-    __m128 _a     = _mm_loadu_ps(&a[i]);
-    __m128 _b     = _mm_loadu_ps(&b[i]);
-    __m128 _arg1  = _mm_mul_ps(_arg_, _cosine(q->sin_table, _alpha));
-    __m128 _re    = _cosine(q->sin_table, _mm_add_ps(_arg1, _a));
-    __m128 _im    = _sine(q->sin_table, _mm_add_ps(_arg1, _b));
-    _reacc        = _mm_add_ps(_reacc, _re);
-    _imacc        = _mm_add_ps(_imacc, _im);
+    __m128 _arg = _mm_mul_ps(_mm_loadu_ps(&w[i]), _t);
+    __m128 _re  = _sine(q->sin_table, _mm_add_ps(_mm_add_ps(_arg, _mm_loadu_ps(&a[i])), _pi_2));
+    __m128 _im  = _sine(q->sin_table, _mm_add_ps(_arg, _mm_loadu_ps(&b[i])));
+    _reacc      = _mm_add_ps(_reacc, _re);
+    _imacc      = _mm_add_ps(_imacc, _im);
   }
 
   __m128 _tmp = _mm_hadd_ps(_reacc, _imacc);
   _tmp        = _mm_hadd_ps(_tmp, _tmp);
   float r[4];
-  _mm_store_ps(r, _tmp);
+  _mm_storeu_ps(r, _tmp);
   __real__ ret = r[0];
   __imag__ ret = r[1];
 
-  return ret * recN;
-
 #else
-  const float recN = 1.0f / sqrtf(SRSRAN_CHANNEL_FADING_NTERMS);
-  cf_t        r    = 0;
-
   for (uint32_t i = 0; i < SRSRAN_CHANNEL_FADING_NTERMS; i++) {
-    float arg = (float)M_PI * F_d * cosf(alpha[i]) * t;
-    __real__ r += cosf(arg + a[i]);
-    __imag__ r += sinf(arg + b[i]);
+    float arg = w[i] * t;
+    __real__ ret += cosf(arg + a[i]);
+    __imag__ ret += sinf(arg + b[i]);
   }
+#endif /* LV_HAVE_AVX512 */
 
-  return recN * r;
-#endif /*LV_HAVE_SSE*/
+  return ret * recN;
 }
 
 static inline void generate_tap(float delay_ns, float power_db, float srate, cf_t* buf, uint32_t N, uint32_t path_delay)
@@ -160,55 +216,109 @@ static inline void generate_tap(float delay_ns, float power_db, float srate, cf_
   cf_t  a0        = amplitude / N;
 
   srsran_vec_gen_sine(a0, -O, buf, N);
+
+  // Shift the FFT once, so that the taps can be combined without shifting
+  for (uint32_t k = 0; k < N / 2; k++) {
+    cf_t tmp       = buf[k];
+    buf[k]         = buf[k + N / 2];
+    buf[k + N / 2] = tmp;
+  }
 }
 
-static inline void generate_taps(srsran_channel_fading_t* q, float time)
+static inline void generate_taps(srsran_channel_fading_t* q, cf_t* h_freq, float time)
 {
-  // Generate taps
-  for (int i = 0; i < nof_taps[q->model]; i++) {
-    // Compute phase for the doppler dispersion
-    cf_t a = get_doppler_dispersion(q, time, q->doppler, q->coeff_alpha[i], q->coeff_a[i], q->coeff_b[i]);
-
-    if (i) {
-      // Copy tap frequency response
-      srsran_vec_sc_prod_ccc(q->h_tap[i], a, q->temp, q->N);
-
-      // Add to frequency response, shifts FFT at same time
-      srsran_vec_sum_ccc(q->h_freq, &q->temp[q->N / 2], q->h_freq, q->N / 2);
-      srsran_vec_sum_ccc(&q->h_freq[q->N / 2], q->temp, &q->h_freq[q->N / 2], q->N / 2);
-    } else {
-      // Copy tap frequency response
-      srsran_vec_sc_prod_ccc(&q->h_tap[i][q->N / 2], a, q->h_freq, q->N / 2);
-      srsran_vec_sc_prod_ccc(&q->h_tap[i][0], a, &q->h_freq[q->N / 2], q->N / 2);
+  uint32_t ntaps = nof_taps[q->model];
+  cf_t     a[SRSRAN_CHANNEL_FADING_MAXTAPS];
+
+  // Compute phase for the doppler dispersion of each tap
+  for (uint32_t i = 0; i < ntaps; i++) {
+    a[i] = get_doppler_dispersion(q, time, q->coeff_w[i], q->coeff_a[i], q->coeff_b[i]);
+  }
+
+  // Combine all taps in a single pass over the frequency response
+  uint32_t k = 0;
+#if SRSRAN_SIMD_CF_SIZE
+  simd_cf_t _a[SRSRAN_CHANNEL_FADING_MAXTAPS];
+  for (uint32_t i = 0; i < ntaps; i++) {
+    _a[i] = srsran_simd_cf_set1(a[i]);
+  }
+
+  for (; k + SRSRAN_SIMD_CF_SIZE <= q->N; k += SRSRAN_SIMD_CF_SIZE) {
+    simd_cf_t acc = srsran_simd_cf_prod(_a[0], srsran_simd_cfi_load(&q->h_tap[0][k]));
+    for (uint32_t i = 1; i < ntaps; i++) {
+      acc = srsran_simd_cf_add(acc, srsran_simd_cf_prod(_a[i], srsran_simd_cfi_load(&q->h_tap[i][k])));
+    }
+    srsran_simd_cfi_store(&h_freq[k], acc);
+  }
+#endif /* SRSRAN_SIMD_CF_SIZE */
+
+  for (; k < q->N; k++) {
+    cf_t acc = a[0] * q->h_tap[0][k];
+    for (uint32_t i = 1; i < ntaps; i++) {
+      acc += a[i] * q->h_tap[i][k];
     }
+    h_freq[k] = acc;
   }
-  // at this stage, q->h_freq should contain the frequency response
+  // at this stage, h_freq should contain the frequency response
 }
 
-static inline void filter_segment(srsran_channel_fading_t* q, const cf_t* input, cf_t* output, uint32_t nsamples)
+static inline void filter_segment(srsran_channel_fading_t*       q,
+                                  srsran_channel_fading_block_t* b,
+                                  const cf_t*                    input,
+                                  cf_t*                          output,
+                                  uint32_t                       nsamples)
 {
   // Fill Input vector
-  srsran_vec_cf_copy(q->temp, input, nsamples);
-  srsran_vec_cf_zero(&q->temp[nsamples], q->N - nsamples);
+  srsran_vec_cf_copy(b->temp, input, nsamples);
+  srsran_vec_cf_zero(&b->temp[nsamples], q->N - nsamples);
 
   // Do FFT
-  srsran_dft_run_c_zerocopy(&q->fft, q->temp, q->y_freq);
+  srsran_dft_run_c_zerocopy(&q->fft, b->temp, b->y_freq);
 
   // Apply channel
-  srsran_vec_prod_ccc(q->y_freq, q->h_freq, q->y_freq, q->N);
+  srsran_vec_prod_ccc(b->y_freq, b->h_freq, b->y_freq, q->N);
 
   // Do iFFT
-  srsran_dft_run_c_zerocopy(&q->ifft, q->y_freq, q->temp);
+  srsran_dft_run_c_zerocopy(&q->ifft, b->y_freq, b->temp);
 
   // Add state
-  srsran_vec_sum_ccc(q->temp, q->state, q->temp, q->state_len);
+  srsran_vec_sum_ccc(b->temp, b->state, b->temp, b->state_len);
 
   // Copy the first nsamples into the output
-  srsran_vec_cf_copy(output, q->temp, nsamples);
+  srsran_vec_cf_copy(output, b->temp, nsamples);
 
   // Copy the rest of the samples into the state
-  q->state_len = q->N - nsamples;
-  srsran_vec_cf_copy(q->state, &q->temp[nsamples], q->state_len);
+  b->state_len = q->N - nsamples;
+  srsran_vec_cf_copy(b->state, &b->temp[nsamples], b->state_len);
+}
+
+static double filter_samples(srsran_channel_fading_t*       q,
+                             srsran_channel_fading_block_t* b,
+                             const cf_t*                    in,
+                             cf_t*                          out,
+                             uint32_t                       nsamples,
+                             double                         init_time)
+{
+  uint32_t counter = 0;
+
+  while (counter < nsamples) {
+    // Generate taps
+    generate_taps(q, b->h_freq, (float)init_time);
+
+    // Do not process more than N/2 samples
+    uint32_t n = SRSRAN_MIN(q->N / 2, nsamples - counter);
+
+    // Execute
+    filter_segment(q, b, &in[counter], &out[counter], n);
+
+    // Increment time
+    init_time += n / q->srate;
+
+    // Increment counter
+    counter += n;
+  }
+
+  return init_time;
 }
 
 int srsran_channel_fading_init(srsran_channel_fading_t* q, double srate, const char* model, uint32_t seed)
@@ -242,6 +352,7 @@ int srsran_channel_fading_init(srsran_channel_fading_t* q, double srate, const c
         q->coeff_a[i][j]     = srsran_random_uniform_real_dist(random, 0, 2.0f * (float)M_PI);
         q->coeff_b[i][j]     = srsran_random_uniform_real_dist(random, 0, 2.0f * (float)M_PI);
         q->coeff_alpha[i][j] = ((float)M_PI * ((float)i - (float)0.5f)) / (2.0f * nof_taps[q->model]);
+        q->coeff_w[i][j]     = (float)M_PI * q->doppler * cosf(q->coeff_alpha[i][j]);
       }
 
       // Allocate tap frequency response
@@ -341,27 +452,90 @@ double srsran_channel_fading_execute(srsran_channel_fading_t* q,
                                      uint32_t                 nsamples,
                                      double                   init_time)
 {
-  uint32_t counter = 0;
-
   if (q) {
-    while (counter < nsamples) {
-      // Generate taps
-      generate_taps(q, (float)init_time);
+    // The channel own buffers and state act as a single block spanning all calls
+    srsran_channel_fading_block_t b = {q->N, q->state_len, q->temp, q->h_freq, q->y_freq, q->state};
 
-      // Do not process more than N/2 samples
-      uint32_t n = SRSRAN_MIN(q->N / 2, nsamples - counter);
+    init_time    = filter_samples(q, &b, in, out, nsamples, init_time);
+    q->state_len = b.state_len;
+  }
+
+  // Return time
+  return init_time;
+}
 
-      // Execute
-      filter_segment(q, &in[counter], &out[counter], n);
+int srsran_channel_fading_block_init(srsran_channel_fading_block_t* b, const srsran_channel_fading_t* q)
+{
+  if (!b || !q) {
+    return SRSRAN_ERROR_INVALID_INPUTS;
+  }
 
-      // Increment time
-      init_time += n / q->srate;
+  b->N         = q->N;
+  b->state_len = 0;
+  b->temp      = srsran_vec_cf_malloc(q->N);
+  b->h_freq    = srsran_vec_cf_malloc(q->N);
+  b->y_freq    = srsran_vec_cf_malloc(q->N);
+  b->state     = srsran_vec_cf_malloc(q->N);
+  if (!b->temp || !b->h_freq || !b->y_freq || !b->state) {
+    fprintf(stderr, "Error: allocating fading block\n");
+    srsran_channel_fading_block_free(b);
+    return SRSRAN_ERROR;
+  }
+
+  return SRSRAN_SUCCESS;
+}
 
-      // Increment counter
-      counter += n;
+void srsran_channel_fading_block_free(srsran_channel_fading_block_t* b)
+{
+  if (b) {
+    if (b->temp) {
+      free(b->temp);
+    }
+
+    if (b->h_freq) {
+      free(b->h_freq);
+    }
+
+    if (b->y_freq) {
+      free(b->y_freq);
     }
+
+    if (b->state) {
+      free(b->state);
+    }
+
+    bzero(b, sizeof(srsran_channel_fading_block_t));
   }
+}
 
-  // Return time
-  return init_time;
+void srsran_channel_fading_execute_block(srsran_channel_fading_t*       q,
+                                         srsran_channel_fading_block_t* b,
+                                         const cf_t*                    in,
+                                         cf_t*                          out,
+                                         uint32_t                       nsamples,
+                                         double                         init_time)
+{
+  if (q && b && b->N == q->N) {
+    b->state_len = 0;
+    filter_samples(q, b, in, out, nsamples, init_time);
+  }
+}
+
+void srsran_channel_fading_merge_block(srsran_channel_fading_t*       q,
+                                       srsran_channel_fading_block_t* b,
+                                       cf_t*                          out,
+                                       uint32_t                       nsamples)
+{
+  if (q && b && b->N == q->N) {
+    // Add the state to the block output, whatever does not fit goes into the block tail
+    uint32_t n = SRSRAN_MIN(q->state_len, nsamples);
+    srsran_vec_sum_ccc(out, q->state, out, n);
+    if (q->state_len > n) {
+      srsran_vec_sum_ccc(b->state, &q->state[n], b->state, q->state_len - n);
+    }
+
+    // The block tail is the new state
+    q->state_len = b->state_len;
+    srsran_vec_cf_copy(q->state, b->state, q->state_len);
+  }
 }
@@ -48,11 +48,7 @@ void srsran_channel_hst_update_srate(srsran_channel_hst_t* q, uint32_t srate)
   }
 }
 
-void srsran_channel_hst_execute(srsran_channel_hst_t*     q,
-                                cf_t*                     in,
-                                cf_t*                     out,
-                                uint32_t                  len,
-                                const srsran_timestamp_t* ts)
+void srsran_channel_hst_update(srsran_channel_hst_t* q, const srsran_timestamp_t* ts)
 {
   if (q && q->srate_hz) {
     // Convert period from seconds to samples
@@ -79,12 +75,27 @@ void srsran_channel_hst_execute(srsran_channel_hst_t*     q,
 
     // Calculate doppler shift
     q->fs_hz = q->fd_hz * costheta;
+  }
+}
 
+void srsran_channel_hst_apply(const srsran_channel_hst_t* q, const cf_t* in, cf_t* out, uint32_t len)
+{
+  if (q && q->srate_hz) {
     // Apply doppler shift, assume the doppler does not vary in a sub-frame
     srsran_vec_apply_cfo(in, -q->fs_hz / q->srate_hz, out, len);
   }
 }
 
+void srsran_channel_hst_execute(srsran_channel_hst_t*     q,
+                                cf_t*                     in,
+                                cf_t*                     out,
+                                uint32_t                  len,
+                                const srsran_timestamp_t* ts)
+{
+  srsran_channel_hst_update(q, ts);
+  srsran_channel_hst_apply(q, in, out, len);
+}
+
 void srsran_channel_hst_free(srsran_channel_hst_t* q)
 {
   if (q) {
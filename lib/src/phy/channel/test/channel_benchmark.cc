@@ -0,0 +1,187 @@
+/**
+ * Copyright 2013-2021 Software Radio Systems Limited
+ *
+ * This file is part of srsRAN.
+ *
+ * srsRAN is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsRAN is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+#include "srsran/common/test_common.h"
+#include "srsran/phy/channel/channel.h"
+#include "srsran/phy/utils/vector.h"
+#include <chrono>
+#include <random>
+
+namespace srsran {
+
+/// Subframes of the serial run the parallel run is checked against
+static const uint32_t NOF_CHECK_SF = 4;
+
+struct run_params {
+  std::string model; ///< Fading model, none disables fading
+  bool        delay;
+  bool        hst;
+  uint32_t    nof_channels;
+  uint32_t    nof_threads;
+  uint32_t    srate;
+  uint32_t    nof_sf;
+};
+
+struct run_data {
+  run_params                   params;
+  float                        msps;
+  std::chrono::duration<float> avg_sf_time;
+};
+
+static channel::args_t make_args(const run_params& params, uint32_t nof_threads)
+{
+  channel::args_t args;
+  args.enable        = true;
+  args.nof_threads   = nof_threads;
+  args.fading_enable = params.model != "none";
+  args.fading_model  = params.model;
+  args.delay_enable  = params.delay;
+  args.hst_enable    = params.hst;
+  return args;
+}
+
+/**
+ * Runs params.nof_sf subframes of random samples through an emulator with params.nof_threads workers. The first
+ * subframes are checked against the emulator running in the calling thread
+ */
+int run_channel_scenario(const run_params& params, std::vector<run_data>& run_results)
+{
+  auto& logger = srslog::fetch_basic_logger("CHAN", false);
+  logger.set_level(srslog::basic_levels::warning);
+  uint32_t sf_len = params.srate / 1000;
+
+  channel emulator(make_args(params, params.nof_threads), params.nof_channels, logger);
+  channel reference(make_args(params, 0), params.nof_channels, logger);
+  emulator.set_srate(params.srate);
+  reference.set_srate(params.srate);
+
+  std::minstd_rand                rand_gen(params.nof_channels * sf_len);
+  std::normal_distribution<float> dist(0.0f, 0.1f);
+
+  std::vector<std::vector<cf_t> > in_data(params.nof_channels, std::vector<cf_t>(sf_len));
+  std::vector<std::vector<cf_t> > out_data(params.nof_channels, std::vector<cf_t>(sf_len));
+  std::vector<std::vector<cf_t> > ref_data(params.nof_channels, std::vector<cf_t>(sf_len));
+  cf_t*                           in[SRSRAN_MAX_CHANNELS]  = {};
+  cf_t*                           out[SRSRAN_MAX_CHANNELS] = {};
+  cf_t*                           ref[SRSRAN_MAX_CHANNELS] = {};
+  for (uint32_t i = 0; i < params.nof_channels; ++i) {
+    for (cf_t& s : in_data[i]) {
+      __real__ s = dist(rand_gen);
+      __imag__ s = dist(rand_gen);
+    }
+    in[i]  = in_data[i].data();
+    out[i] = out_data[i].data();
+    ref[i] = ref_data[i].data();
+  }
+
+  // TEST: the parallel emulator matches the serial one, up to the rounding of the fading block merge
+  srsran_timestamp_t ts = {};
+  for (uint32_t sf = 0; sf < NOF_CHECK_SF; ++sf) {
+    emulator.run(in, out, sf_len, ts);
+    reference.run(in, ref, sf_len, ts);
+    for (uint32_t i = 0; i < params.nof_channels; ++i) {
+      srsran_vec_sub_ccc(out[i], ref[i], out[i], sf_len);
+      float err_pwr = srsran_vec_avg_power_cf(out[i], sf_len);
+      float ref_pwr = srsran_vec_avg_power_cf(ref[i], sf_len);
+      TESTASSERT(err_pwr <= ref_pwr * 1e-6f);
+    }
+    srsran_timestamp_add(&ts, 0, 1e-3);
+  }
+
+  auto tp_start = std::chrono::steady_clock::now();
+  for (uint32_t sf = 0; sf < params.nof_sf; ++sf) {
+    emulator.run(in, out, sf_len, ts);
+    srsran_timestamp_add(&ts, 0, 1e-3);
+  }
+  std::chrono::duration<float> tot_time = std::chrono::steady_clock::now() - tp_start;
+
+  run_data r;
+  r.params      = params;
+  r.msps        = (float)params.nof_sf * sf_len * params.nof_channels / tot_time.count() / 1e6;
+  r.avg_sf_time = tot_time / params.nof_sf;
+  run_results.push_back(r);
+  return SRSRAN_SUCCESS;
+}
+
+void print_benchmark_results(const std::vector<run_data>& run_results)
+{
+  fmt::print("run |  model | delay | hst | channels | threads |  MSps | time/SF [usec]\n");
+  fmt::print("-----------------------------------------------------------------------\n");
+  for (uint32_t i = 0; i < run_results.size(); ++i) {
+    const run_data& r = run_results[i];
+    fmt::print("{:>3d}{:>9s}{:>8s}{:>6s}{:>11d}{:>10d}{:>8.1f}{:>17.1f}\n",
+               i,
+               r.params.model,
+               r.params.delay ? "yes" : "no",
+               r.params.hst ? "yes" : "no",
+               r.params.nof_channels,
+               r.params.nof_threads,
+               r.msps,
+               r.avg_sf_time.count() * 1e6);
+  }
+}
+
+int run_benchmark(const std::vector<uint32_t>& nof_channels_list,
+                  const std::vector<uint32_t>& nof_threads_list,
+                  uint32_t                     nof_sf)
+{
+  // Each fading model alone, then every model of the emulator at once
+  std::vector<std::tuple<std::string, bool, bool> > models = {
+      {"none", true, false}, {"none", false, true}, {"epa5", false, false}, {"eva70", false, false},
+      {"etu300", false, false}, {"etu300", true, true}};
+
+  // 20 MHz
+  uint32_t srate = (uint32_t)srsran_sampling_freq_hz(100);
+
+  std::vector<run_data> run_results;
+  for (const auto& model : models) {
+    for (uint32_t nof_channels : nof_channels_list) {
+      for (uint32_t nof_threads : nof_threads_list) {
+        run_params params = {
+            std::get<0>(model), std::get<1>(model), std::get<2>(model), nof_channels, nof_threads, srate, nof_sf};
+        TESTASSERT(run_channel_scenario(params, run_results) == SRSRAN_SUCCESS);
+      }
+    }
+  }
+
+  print_benchmark_results(run_results);
+
+  return SRSRAN_SUCCESS;
+}
+
+} // namespace srsran
+
+int main(int argc, char* argv[])
+{
+  auto& test_logger = srslog::fetch_basic_logger("TEST");
+  test_logger.set_level(srslog::basic_levels::warning);
+
+  // Start the log backend.
+  srslog::init();
+
+  if (argc == 1 or strcmp(argv[1], "test") == 0) {
+    TESTASSERT(srsran::run_benchmark({1, 4}, {0, 2}, 10) == SRSRAN_SUCCESS);
+  } else {
+    TESTASSERT(srsran::run_benchmark({1, 2, 4}, {0, 1, 2, 4, 8}, 200) == SRSRAN_SUCCESS);
+  }
+
+  return 0;
+}
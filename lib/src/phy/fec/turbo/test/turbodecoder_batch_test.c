@@ -0,0 +1,280 @@
+/**
+ * Copyright 2013-2021 Software Radio Systems Limited
+ *
+ * This file is part of srsRAN.
+ *
+ * srsRAN is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsRAN is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <sys/time.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "srsran/phy/fec/turbo/turbodecoder_batch.h"
+#include "srsran/phy/utils/random.h"
+#include "srsran/srsran.h"
+
+uint32_t long_cb        = 104;
+uint32_t nof_cb         = 0;
+uint32_t nof_frames     = 100;
+uint32_t nof_iterations = 8;
+float    ebno_db        = 4.0f;
+uint32_t seed           = 0;
+
+#define MIN_ITERATIONS 2
+
+void usage(char* prog)
+{
+  printf("Usage: %s [lcnies]\n", prog);
+  printf("\t-l code block length [Default %d]\n", long_cb);
+  printf("\t-c number of code blocks [Default number of SIMD lanes]\n");
+  printf("\t-n nof_frames [Default %d]\n", nof_frames);
+  printf("\t-i maximum number of half iterations [Default %d]\n", nof_iterations);
+  printf("\t-e ebno in dB [Default %.1f]\n", ebno_db);
+  printf("\t-s seed [Default 0=time]\n");
+}
+
+void parse_args(int argc, char** argv)
+{
+  int opt;
+  while ((opt = getopt(argc, argv, "lcniesv")) != -1) {
+    switch (opt) {
+      case 'l':
+        long_cb = (uint32_t)strtol(argv[optind], NULL, 10);
+        break;
+      case 'c':
+        nof_cb = (uint32_t)strtol(argv[optind], NULL, 10);
+        break;
+      case 'n':
+        nof_frames = (uint32_t)strtol(argv[optind], NULL, 10);
+        break;
+      case 'i':
+        nof_iterations = (uint32_t)strtol(argv[optind], NULL, 10);
+        break;
+      case 'e':
+        ebno_db = strtof(argv[optind], NULL);
+        break;
+      case 's':
+        seed = (uint32_t)strtoul(argv[optind], NULL, 0);
+        break;
+      case 'v':
+        increase_srsran_verbose_level();
+        break;
+      default:
+        usage(argv[0]);
+        exit(-1);
+    }
+  }
+}
+
+/* Stops a lane once its CRC is OK */
+static bool crc_stop(void* arg, uint32_t cb_idx, const uint8_t* output, uint32_t n_iter)
+{
+  srsran_crc_t* crc = (srsran_crc_t*)arg;
+  return n_iter >= MIN_ITERATIONS && srsran_crc_checksum_byte(crc, output, long_cb) == 0;
+}
+
+static double elapsed_us(struct timeval* t)
+{
+  get_time_interval(t);
+  return t[0].tv_sec * 1e6 + t[0].tv_usec;
+}
+
+int main(int argc, char** argv)
+{
+  int                 ret = SRSRAN_ERROR;
+  srsran_tdec_t       tdec;
+  srsran_tdec_batch_t tdec_batch;
+  srsran_tcod_t       tcod;
+  srsran_crc_t        crc;
+  struct timeval      t[3];
+
+  parse_args(argc, argv);
+
+  if (!seed) {
+    seed = time(NULL);
+  }
+  srsran_random_t random_gen = srsran_random_init(seed);
+
+  int n = srsran_cbsegm_cbsize(srsran_cbsegm_cbindex(long_cb));
+  if (n < SRSRAN_SUCCESS) {
+    ERROR("Invalid code block length %d", long_cb);
+    return SRSRAN_ERROR;
+  }
+  long_cb = (uint32_t)n;
+
+  if (srsran_tdec_batch_init(&tdec_batch, long_cb)) {
+    ERROR("Error initiating batched turbo decoder");
+    return SRSRAN_ERROR;
+  }
+  if (nof_cb == 0 || nof_cb > srsran_tdec_batch_get_nof_lanes(&tdec_batch)) {
+    nof_cb = srsran_tdec_batch_get_nof_lanes(&tdec_batch);
+  }
+  if (srsran_tdec_init(&tdec, long_cb) || srsran_tcod_init(&tcod, long_cb) ||
+      srsran_crc_init(&crc, SRSRAN_LTE_CRC24B, 24)) {
+    ERROR("Error initiating turbo coder/decoder");
+    return SRSRAN_ERROR;
+  }
+  srsran_tdec_force_not_sb(&tdec);
+
+  // Both decoders run the same algorithm when the reference does not use sub-blocks
+  bool bit_exact = srsran_tdec_autoimp_get_subblocks(long_cb) == 0;
+
+  uint32_t coded_length = SRSRAN_TCOD_RATE * long_cb + SRSRAN_TCOD_TOTALTAIL;
+  float    esno_db      = ebno_db + srsran_convert_power_to_dB(1.0f / 3.0f);
+  float    var          = srsran_convert_dB_to_amplitude(-esno_db);
+
+  uint8_t* data_tx[SRSRAN_TDEC_BATCH_MAX_LANES]    = {};
+  uint8_t* out_ref[SRSRAN_TDEC_BATCH_MAX_LANES]    = {};
+  uint8_t* out_batch[SRSRAN_TDEC_BATCH_MAX_LANES]  = {};
+  uint8_t* out_stop[SRSRAN_TDEC_BATCH_MAX_LANES]   = {};
+  int16_t* llr_s[SRSRAN_TDEC_BATCH_MAX_LANES]      = {};
+  uint8_t* symbols                                 = srsran_vec_u8_malloc(coded_length);
+  float*   llr                                     = srsran_vec_f_malloc(coded_length);
+  uint8_t* data_rx                                 = srsran_vec_u8_malloc(long_cb);
+  for (uint32_t cb = 0; cb < nof_cb; cb++) {
+    data_tx[cb]   = srsran_vec_u8_malloc(long_cb);
+    out_ref[cb]   = srsran_vec_u8_malloc(long_cb / 8);
+    out_batch[cb] = srsran_vec_u8_malloc(long_cb / 8);
+    out_stop[cb]  = srsran_vec_u8_malloc(long_cb / 8);
+    llr_s[cb]     = srsran_vec_i16_malloc(coded_length);
+    if (!data_tx[cb] || !out_ref[cb] || !out_batch[cb] || !out_stop[cb] || !llr_s[cb]) {
+      perror("malloc");
+      goto clean_exit;
+    }
+  }
+  if (!symbols || !llr || !data_rx) {
+    perror("malloc");
+    goto clean_exit;
+  }
+
+  printf("Code block length: %d, code blocks: %d/%d lanes, Eb/No: %.1f dB, half iterations: %d\n",
+         long_cb,
+         nof_cb,
+         srsran_tdec_batch_get_nof_lanes(&tdec_batch),
+         ebno_db,
+         nof_iterations);
+
+  double   usec_ref = 0, usec_batch = 0, usec_stop = 0;
+  uint32_t errors_ref = 0, errors_batch = 0, errors_stop = 0, mismatches = 0;
+  uint64_t iterations_stop = 0;
+  for (uint32_t frame = 0; frame < nof_frames; frame++) {
+    for (uint32_t cb = 0; cb < nof_cb; cb++) {
+      for (uint32_t i = 0; i < long_cb - 24; i++) {
+        data_tx[cb][i] = (uint8_t)srsran_random_uniform_int_dist(random_gen, 0, 1);
+      }
+      srsran_crc_attach(&crc, data_tx[cb], long_cb - 24);
+      srsran_tcod_encode(&tcod, data_tx[cb], symbols, long_cb);
+      for (uint32_t i = 0; i < coded_length; i++) {
+        llr[i] = symbols[i] ? 1 : -1;
+      }
+      srsran_ch_awgn_f(llr, llr, var, coded_length);
+      for (uint32_t i = 0; i < coded_length; i++) {
+        llr_s[cb][i] = (int16_t)(100 * llr[i]);
+      }
+    }
+
+    // Reference, one code block after the other
+    gettimeofday(&t[1], NULL);
+    for (uint32_t cb = 0; cb < nof_cb; cb++) {
+      srsran_tdec_run_all(&tdec, llr_s[cb], out_ref[cb], nof_iterations, long_cb);
+    }
+    gettimeofday(&t[2], NULL);
+    usec_ref += elapsed_us(t);
+
+    // All code blocks in parallel lanes
+    gettimeofday(&t[1], NULL);
+    srsran_tdec_batch_run_all(&tdec_batch, llr_s, out_batch, nof_cb, nof_iterations, long_cb, NULL, NULL);
+    gettimeofday(&t[2], NULL);
+    usec_batch += elapsed_us(t);
+
+    // All code blocks in parallel lanes with CRC early stop
+    gettimeofday(&t[1], NULL);
+    srsran_tdec_batch_run_all(&tdec_batch, llr_s, out_stop, nof_cb, nof_iterations, long_cb, crc_stop, &crc);
+    gettimeofday(&t[2], NULL);
+    usec_stop += elapsed_us(t);
+
+    for (uint32_t cb = 0; cb < nof_cb; cb++) {
+      if (bit_exact && memcmp(out_ref[cb], out_batch[cb], long_cb / 8) != 0) {
+        mismatches++;
+      }
+      srsran_bit_unpack_vector(out_ref[cb], data_rx, long_cb);
+      errors_ref += srsran_bit_diff(data_tx[cb], data_rx, long_cb);
+      srsran_bit_unpack_vector(out_batch[cb], data_rx, long_cb);
+      errors_batch += srsran_bit_diff(data_tx[cb], data_rx, long_cb);
+      srsran_bit_unpack_vector(out_stop[cb], data_rx, long_cb);
+      errors_stop += srsran_bit_diff(data_tx[cb], data_rx, long_cb);
+      iterations_stop += srsran_tdec_batch_get_nof_iterations(&tdec_batch, cb);
+    }
+  }
+
+  double nof_bits = (double)nof_frames * nof_cb * long_cb;
+  printf("  serial:             BER=%.2e, %6.1f Mbps/core\n", errors_ref / nof_bits, nof_bits / usec_ref);
+  printf("  batched:            BER=%.2e, %6.1f Mbps/core\n", errors_batch / nof_bits, nof_bits / usec_batch);
+  printf("  batched+early stop: BER=%.2e, %6.1f Mbps/core, avg half iterations=%.1f\n",
+         errors_stop / nof_bits,
+         nof_bits / usec_stop,
+         (double)iterations_stop / (nof_frames * nof_cb));
+
+  if (mismatches) {
+    printf("%d code blocks differ from the reference decoder\n", mismatches);
+  } else if (errors_stop > errors_batch) {
+    printf("Early stop increased the number of errors\n");
+  } else if (errors_ref == 0 && errors_batch > 0) {
+    printf("Batched decoder has errors while the reference decoder has none\n");
+  } else {
+    ret = SRSRAN_SUCCESS;
+  }
+
+clean_exit:
+  for (uint32_t cb = 0; cb < SRSRAN_TDEC_BATCH_MAX_LANES; cb++) {
+    if (data_tx[cb]) {
+      free(data_tx[cb]);
+    }
+    if (out_ref[cb]) {
+      free(out_ref[cb]);
+    }
+    if (out_batch[cb]) {
+      free(out_batch[cb]);
+    }
+    if (out_stop[cb]) {
+      free(out_stop[cb]);
+    }
+    if (llr_s[cb]) {
+      free(llr_s[cb]);
+    }
+  }
+  if (symbols) {
+    free(symbols);
+  }
+  if (llr) {
+    free(llr);
+  }
+  if (data_rx) {
+    free(data_rx);
+  }
+  srsran_tdec_batch_free(&tdec_batch);
+  srsran_tdec_free(&tdec);
+  srsran_tcod_free(&tcod);
+  srsran_random_free(random_gen);
+
+  printf("%s\n", ret == SRSRAN_SUCCESS ? "Ok" : "Error");
+  return ret;
+}
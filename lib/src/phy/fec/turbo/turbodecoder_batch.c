@@ -0,0 +1,560 @@
+/**
+ * Copyright 2013-2021 Software Radio Systems Limited
+ *
+ * This file is part of srsRAN.
+ *
+ * srsRAN is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsRAN is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <strings.h>
+
+#include "srsran/phy/fec/cbsegm.h"
+#include "srsran/phy/fec/turbo/turbodecoder.h"
+#include "srsran/phy/fec/turbo/turbodecoder_batch.h"
+#include "srsran/phy/utils/debug.h"
+#include "srsran/phy/utils/vector.h"
+
+#define INF 10000
+
+/* Every lane holds one code block. The arithmetic and normalization periods follow turbodecoder_gen.c, so that the
+ * output of every lane is bit-exact with the generic decoder. */
+#ifdef LV_HAVE_AVX2
+
+#include <immintrin.h>
+
+#define NOF_LANES 16
+
+#define simd_type_t __m256i
+#define simd_load(p) _mm256_load_si256((__m256i*)(p))
+#define simd_store(p, v) _mm256_store_si256((__m256i*)(p), v)
+#define simd_add _mm256_add_epi16
+#define simd_sub _mm256_sub_epi16
+#define simd_max _mm256_max_epi16
+#define simd_set1 _mm256_set1_epi16
+
+/* Returns one bit per lane, set if the lane is greater than zero */
+static inline uint32_t simd_gtz_mask(simd_type_t v)
+{
+  __m256i zero = _mm256_setzero_si256();
+  __m256i gt   = _mm256_packs_epi16(_mm256_cmpgt_epi16(v, zero), zero);
+  return (uint32_t)_mm256_movemask_epi8(_mm256_permute4x64_epi64(gt, 0xD8)) & 0xFFFF;
+}
+
+#else
+#ifdef LV_HAVE_SSE
+
+#include <emmintrin.h>
+
+#define NOF_LANES 8
+
+#define simd_type_t __m128i
+#define simd_load(p) _mm_load_si128((__m128i*)(p))
+#define simd_store(p, v) _mm_store_si128((__m128i*)(p), v)
+#define simd_add _mm_add_epi16
+#define simd_sub _mm_sub_epi16
+#define simd_max _mm_max_epi16
+#define simd_set1 _mm_set1_epi16
+
+static inline uint32_t simd_gtz_mask(simd_type_t v)
+{
+  __m128i zero = _mm_setzero_si128();
+  return (uint32_t)_mm_movemask_epi8(_mm_packs_epi16(_mm_cmpgt_epi16(v, zero), zero)) & 0xFF;
+}
+
+#else
+
+/* Plain C lanes, the compiler is expected to vectorize them */
+#define NOF_LANES 8
+
+typedef struct {
+  int16_t v[NOF_LANES];
+} tdec_batch_lanes_t;
+
+#define simd_type_t tdec_batch_lanes_t
+
+static inline simd_type_t simd_load(const int16_t* ptr)
+{
+  simd_type_t r;
+  for (int i = 0; i < NOF_LANES; i++) {
+    r.v[i] = ptr[i];
+  }
+  return r;
+}
+
+static inline void simd_store(int16_t* ptr, simd_type_t a)
+{
+  for (int i = 0; i < NOF_LANES; i++) {
+    ptr[i] = a.v[i];
+  }
+}
+
+static inline simd_type_t simd_add(simd_type_t a, simd_type_t b)
+{
+  simd_type_t r;
+  for (int i = 0; i < NOF_LANES; i++) {
+    r.v[i] = (int16_t)(a.v[i] + b.v[i]);
+  }
+  return r;
+}
+
+static inline simd_type_t simd_sub(simd_type_t a, simd_type_t b)
+{
+  simd_type_t r;
+  for (int i = 0; i < NOF_LANES; i++) {
+    r.v[i] = (int16_t)(a.v[i] - b.v[i]);
+  }
+  return r;
+}
+
+static inline simd_type_t simd_max(simd_type_t a, simd_type_t b)
+{
+  simd_type_t r;
+  for (int i = 0; i < NOF_LANES; i++) {
+    r.v[i] = a.v[i] > b.v[i] ? a.v[i] : b.v[i];
+  }
+  return r;
+}
+
+static inline simd_type_t simd_set1(int16_t a)
+{
+  simd_type_t r;
+  for (int i = 0; i < NOF_LANES; i++) {
+    r.v[i] = a;
+  }
+  return r;
+}
+
+static inline uint32_t simd_gtz_mask(simd_type_t a)
+{
+  uint32_t mask = 0;
+  for (int i = 0; i < NOF_LANES; i++) {
+    mask |= (a.v[i] > 0 ? 1U : 0U) << i;
+  }
+  return mask;
+}
+
+#endif /* LV_HAVE_SSE */
+#endif /* LV_HAVE_AVX2 */
+
+#define NUMSTATES 8
+#define TAIL 3
+
+int srsran_tdec_batch_init(srsran_tdec_batch_t* h, uint32_t max_long_cb)
+{
+  int ret = SRSRAN_ERROR;
+  if (h == NULL) {
+    return SRSRAN_ERROR_INVALID_INPUTS;
+  }
+  bzero(h, sizeof(srsran_tdec_batch_t));
+
+  uint32_t len   = (max_long_cb + TAIL) * NOF_LANES;
+  h->max_long_cb = max_long_cb;
+  h->nof_lanes   = NOF_LANES;
+
+  h->syst = srsran_vec_i16_malloc(len);
+  if (!h->syst) {
+    perror("srsran_vec_malloc");
+    goto clean_and_exit;
+  }
+  h->parity0 = srsran_vec_i16_malloc(len);
+  if (!h->parity0) {
+    perror("srsran_vec_malloc");
+    goto clean_and_exit;
+  }
+  h->parity1 = srsran_vec_i16_malloc(len);
+  if (!h->parity1) {
+    perror("srsran_vec_malloc");
+    goto clean_and_exit;
+  }
+  h->app1 = srsran_vec_i16_malloc(len);
+  if (!h->app1) {
+    perror("srsran_vec_malloc");
+    goto clean_and_exit;
+  }
+  h->app2 = srsran_vec_i16_malloc(len);
+  if (!h->app2) {
+    perror("srsran_vec_malloc");
+    goto clean_and_exit;
+  }
+  h->ext1 = srsran_vec_i16_malloc(len);
+  if (!h->ext1) {
+    perror("srsran_vec_malloc");
+    goto clean_and_exit;
+  }
+  h->ext2 = srsran_vec_i16_malloc(len);
+  if (!h->ext2) {
+    perror("srsran_vec_malloc");
+    goto clean_and_exit;
+  }
+  h->beta = srsran_vec_i16_malloc((max_long_cb + TAIL + 1) * NUMSTATES * NOF_LANES);
+  if (!h->beta) {
+    perror("srsran_vec_malloc");
+    goto clean_and_exit;
+  }
+  if (srsran_tc_interl_init(&h->interleaver, max_long_cb) < SRSRAN_SUCCESS) {
+    goto clean_and_exit;
+  }
+
+  ret = SRSRAN_SUCCESS;
+
+clean_and_exit:
+  if (ret < SRSRAN_SUCCESS) {
+    srsran_tdec_batch_free(h);
+  }
+  return ret;
+}
+
+void srsran_tdec_batch_free(srsran_tdec_batch_t* h)
+{
+  if (h == NULL) {
+    return;
+  }
+  if (h->syst) {
+    free(h->syst);
+  }
+  if (h->parity0) {
+    free(h->parity0);
+  }
+  if (h->parity1) {
+    free(h->parity1);
+  }
+  if (h->app1) {
+    free(h->app1);
+  }
+  if (h->app2) {
+    free(h->app2);
+  }
+  if (h->ext1) {
+    free(h->ext1);
+  }
+  if (h->ext2) {
+    free(h->ext2);
+  }
+  if (h->beta) {
+    free(h->beta);
+  }
+  srsran_tc_interl_free(&h->interleaver);
+
+  bzero(h, sizeof(srsran_tdec_batch_t));
+}
+
+uint32_t srsran_tdec_batch_get_nof_lanes(srsran_tdec_batch_t* h)
+{
+  return h ? h->nof_lanes : 0;
+}
+
+static void tdec_batch_beta(srsran_tdec_batch_t* h, int16_t* input, int16_t* app, int16_t* parity)
+{
+  simd_type_t m_b[8], new[8], old[8];
+  simd_type_t x, y, xy;
+  uint32_t    long_cb = h->current_long_cb;
+  int16_t*    beta    = h->beta;
+
+  // All the code blocks are terminated in state 0
+  old[0] = simd_set1(0);
+  for (int i = 1; i < 8; i++) {
+    old[i] = simd_set1(-INF);
+  }
+
+  for (int k = long_cb + TAIL - 1; k >= 0; k--) {
+    x = simd_load(&input[k * NOF_LANES]);
+    if (app && k < long_cb) {
+      x = simd_add(x, simd_load(&app[k * NOF_LANES]));
+    }
+    y = simd_load(&parity[k * NOF_LANES]);
+
+    xy = simd_add(x, y);
+
+    m_b[0] = simd_add(old[4], xy);
+    m_b[1] = old[4];
+    m_b[2] = simd_add(old[5], y);
+    m_b[3] = simd_add(old[5], x);
+    m_b[4] = simd_add(old[6], x);
+    m_b[5] = simd_add(old[6], y);
+    m_b[6] = old[7];
+    m_b[7] = simd_add(old[7], xy);
+
+    new[0] = old[0];
+    new[1] = simd_add(old[0], xy);
+    new[2] = simd_add(old[1], x);
+    new[3] = simd_add(old[1], y);
+    new[4] = simd_add(old[2], y);
+    new[5] = simd_add(old[2], x);
+    new[6] = simd_add(old[3], xy);
+    new[7] = old[3];
+
+    for (int i = 0; i < 8; i++) {
+      old[i] = simd_max(m_b[i], new[i]);
+      simd_store(&beta[(NUMSTATES * k + i) * NOF_LANES], old[i]);
+    }
+
+    if ((k % 4) == 0 && k < long_cb) {
+      for (int i = 1; i < 8; i++) {
+        old[i] = simd_sub(old[i], old[0]);
+      }
+      old[0] = simd_set1(0);
+    }
+  }
+}
+
+static void tdec_batch_alpha(srsran_tdec_batch_t* h, int16_t* input, int16_t* app, int16_t* parity, int16_t* output)
+{
+  simd_type_t m_b[8], new[8], old[8], max1[8], max0[8];
+  simd_type_t x, y, xy, m1, m0, beta;
+  uint32_t    long_cb  = h->current_long_cb;
+  int16_t*    beta_ptr = h->beta;
+
+  // All the code blocks start in state 0
+  old[0] = simd_set1(0);
+  for (int i = 1; i < 8; i++) {
+    old[i] = simd_set1(-INF);
+  }
+
+  for (uint32_t k = 1; k < long_cb + 1; k++) {
+    x = simd_load(&input[(k - 1) * NOF_LANES]);
+    if (app) {
+      x = simd_add(x, simd_load(&app[(k - 1) * NOF_LANES]));
+    }
+    y = simd_load(&parity[(k - 1) * NOF_LANES]);
+
+    xy = simd_add(x, y);
+
+    m_b[0] = old[0];
+    m_b[1] = simd_add(old[3], y);
+    m_b[2] = simd_add(old[4], y);
+    m_b[3] = old[7];
+    m_b[4] = old[1];
+    m_b[5] = simd_add(old[2], y);
+    m_b[6] = simd_add(old[5], y);
+    m_b[7] = old[6];
+
+    new[0] = simd_add(old[1], xy);
+    new[1] = simd_add(old[2], x);
+    new[2] = simd_add(old[5], x);
+    new[3] = simd_add(old[6], xy);
+    new[4] = simd_add(old[0], xy);
+    new[5] = simd_add(old[3], x);
+    new[6] = simd_add(old[4], x);
+    new[7] = simd_add(old[7], xy);
+
+    for (int i = 0; i < 8; i++) {
+      beta    = simd_load(&beta_ptr[(NUMSTATES * k + i) * NOF_LANES]);
+      max0[i] = simd_add(m_b[i], beta);
+      max1[i] = simd_add(new[i], beta);
+    }
+
+    m1 = max1[0];
+    m0 = max0[0];
+    for (int i = 1; i < 8; i++) {
+      m1 = simd_max(m1, max1[i]);
+      m0 = simd_max(m0, max0[i]);
+    }
+
+    for (int i = 0; i < 8; i++) {
+      old[i] = simd_max(m_b[i], new[i]);
+    }
+
+    if ((k % 4) == 0) {
+      for (int i = 1; i < 8; i++) {
+        old[i] = simd_sub(old[i], old[0]);
+      }
+      old[0] = simd_set1(0);
+    }
+
+    simd_store(&output[(k - 1) * NOF_LANES], simd_sub(m1, m0));
+  }
+}
+
+static void tdec_batch_dec(srsran_tdec_batch_t* h, int16_t* input, int16_t* app, int16_t* parity, int16_t* output)
+{
+  tdec_batch_beta(h, input, app, parity);
+  tdec_batch_alpha(h, input, app, parity, output);
+}
+
+/* Moves row i of x to row lut[i] of y, i.e. srsran_vec_lut_sss() applied to every lane */
+static void tdec_batch_lut(const int16_t* x, const uint16_t* lut, int16_t* y, uint32_t long_cb)
+{
+  for (uint32_t i = 0; i < long_cb; i++) {
+    simd_store(&y[lut[i] * NOF_LANES], simd_load(&x[i * NOF_LANES]));
+  }
+}
+
+static void tdec_batch_decision_byte(srsran_tdec_batch_t* h, const int16_t* app, uint8_t** output)
+{
+  uint32_t mask[8];
+  for (uint32_t i = 0; i < h->current_long_cb / 8; i++) {
+    for (uint32_t j = 0; j < 8; j++) {
+      mask[j] = simd_gtz_mask(simd_load(&app[(8 * i + j) * NOF_LANES]));
+    }
+    for (uint32_t cb = 0; cb < h->nof_cb; cb++) {
+      if (h->active_mask & (1U << cb)) {
+        uint8_t byte = 0;
+        for (uint32_t j = 0; j < 8; j++) {
+          byte |= (uint8_t)(((mask[j] >> cb) & 1U) << (7 - j));
+        }
+        output[cb][i] = byte;
+      }
+    }
+  }
+}
+
+int srsran_tdec_batch_new_cb(srsran_tdec_batch_t* h, int16_t** input, uint32_t nof_cb, uint32_t long_cb)
+{
+  if (h == NULL || input == NULL || nof_cb == 0) {
+    return SRSRAN_ERROR_INVALID_INPUTS;
+  }
+  if (nof_cb > h->nof_lanes) {
+    ERROR("Batched turbo decoder supports up to %d code blocks (%d)", h->nof_lanes, nof_cb);
+    return SRSRAN_ERROR;
+  }
+  if (long_cb > h->max_long_cb) {
+    ERROR("TDEC batch was initialized for max_long_cb=%d", h->max_long_cb);
+    return SRSRAN_ERROR;
+  }
+  if (srsran_cbsegm_cbindex(long_cb) < 0) {
+    ERROR("Invalid CB length %d", long_cb);
+    return SRSRAN_ERROR;
+  }
+
+  if (h->interleaver_long_cb != long_cb) {
+    if (srsran_tc_interl_LTE_gen_interl(&h->interleaver, long_cb, 1) < SRSRAN_SUCCESS) {
+      return SRSRAN_ERROR;
+    }
+    h->interleaver_long_cb = long_cb;
+  }
+
+  h->current_long_cb = long_cb;
+  h->nof_cb          = nof_cb;
+  h->active_mask     = (1U << nof_cb) - 1;
+  h->n_iter          = 0;
+  bzero(h->nof_iterations, sizeof(h->nof_iterations));
+
+  // Interleave the code blocks across lanes, unused lanes are set to zero
+  for (uint32_t cb = 0; cb < NOF_LANES; cb++) {
+    int16_t* in = cb < nof_cb ? input[cb] : NULL;
+    for (uint32_t k = 0; k < long_cb; k++) {
+      h->syst[k * NOF_LANES + cb]    = in ? in[SRSRAN_TCOD_RATE * k] : 0;
+      h->parity0[k * NOF_LANES + cb] = in ? in[SRSRAN_TCOD_RATE * k + 1] : 0;
+      h->parity1[k * NOF_LANES + cb] = in ? in[SRSRAN_TCOD_RATE * k + 2] : 0;
+    }
+    for (uint32_t k = long_cb; k < long_cb + TAIL; k++) {
+      uint32_t tail = SRSRAN_TCOD_RATE * long_cb + 2 * (k - long_cb);
+      h->syst[k * NOF_LANES + cb]    = in ? in[tail] : 0;
+      h->parity0[k * NOF_LANES + cb] = in ? in[tail + 1] : 0;
+      h->app2[k * NOF_LANES + cb]    = in ? in[tail + 2 * TAIL] : 0;
+      h->parity1[k * NOF_LANES + cb] = in ? in[tail + 2 * TAIL + 1] : 0;
+    }
+  }
+
+  return SRSRAN_SUCCESS;
+}
+
+void srsran_tdec_batch_iteration(srsran_tdec_batch_t* h, uint8_t** output)
+{
+  if (h == NULL || h->nof_cb == 0) {
+    return;
+  }
+
+  uint16_t* inter   = h->interleaver.forward;
+  uint16_t* deinter = h->interleaver.reverse;
+  uint32_t  long_cb = h->current_long_cb;
+  uint32_t  len     = long_cb * NOF_LANES;
+
+  if ((h->n_iter % 2) == 0) {
+    // Add apriori information to decoder 1
+    if (h->n_iter) {
+      srsran_vec_sub_sss(h->app1, h->ext1, h->app1, len);
+    }
+
+    // Run MAP DEC #1
+    tdec_batch_dec(h, h->syst, h->n_iter ? h->app1 : NULL, h->parity0, h->ext1);
+  } else {
+    // Convert aposteriori information into extrinsic information
+    if (h->n_iter > 1) {
+      srsran_vec_sub_sss(h->ext1, h->app1, h->ext1, len);
+    }
+
+    // Interleave extrinsic output of DEC1 to form apriori info for decoder 2
+    tdec_batch_lut(h->ext1, deinter, h->app2, long_cb);
+
+    // Run MAP DEC #2. 2nd decoder uses apriori information as systematic bits
+    tdec_batch_dec(h, h->app2, NULL, h->parity1, h->ext2);
+
+    // Deinterleaved extrinsic bits become apriori info for decoder 1
+    tdec_batch_lut(h->ext2, inter, h->app1, long_cb);
+  }
+  h->n_iter++;
+
+  for (uint32_t cb = 0; cb < h->nof_cb; cb++) {
+    if (h->active_mask & (1U << cb)) {
+      h->nof_iterations[cb] = h->n_iter;
+    }
+  }
+
+  if (output) {
+    tdec_batch_decision_byte(h, (h->n_iter % 2) ? h->ext1 : h->app1, output);
+  }
+}
+
+void srsran_tdec_batch_stop_cb(srsran_tdec_batch_t* h, uint32_t cb_idx)
+{
+  if (h && cb_idx < SRSRAN_TDEC_BATCH_MAX_LANES) {
+    h->active_mask &= ~(1U << cb_idx);
+  }
+}
+
+uint32_t srsran_tdec_batch_get_active_mask(srsran_tdec_batch_t* h)
+{
+  return h ? h->active_mask : 0;
+}
+
+uint32_t srsran_tdec_batch_get_nof_iterations(srsran_tdec_batch_t* h, uint32_t cb_idx)
+{
+  if (h == NULL || cb_idx >= SRSRAN_TDEC_BATCH_MAX_LANES) {
+    return 0;
+  }
+  return h->nof_iterations[cb_idx];
+}
+
+int srsran_tdec_batch_run_all(srsran_tdec_batch_t*     h,
+                              int16_t**                input,
+                              uint8_t**                output,
+                              uint32_t                 nof_cb,
+                              uint32_t                 nof_iterations,
+                              uint32_t                 long_cb,
+                              srsran_tdec_batch_stop_t stop,
+                              void*                    arg)
+{
+  if (srsran_tdec_batch_new_cb(h, input, nof_cb, long_cb) < SRSRAN_SUCCESS) {
+    return SRSRAN_ERROR;
+  }
+
+  do {
+    srsran_tdec_batch_iteration(h, output);
+
+    if (stop) {
+      for (uint32_t cb = 0; cb < nof_cb; cb++) {
+        if ((h->active_mask & (1U << cb)) && stop(arg, cb, output[cb], h->n_iter)) {
+          srsran_tdec_batch_stop_cb(h, cb);
+        }
+      }
+    }
+  } while (h->n_iter < nof_iterations && h->active_mask);
+
+  return (int)h->n_iter;
+}
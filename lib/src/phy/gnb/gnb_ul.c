@@ -194,6 +194,7 @@ int srsran_gnb_ul_get_pusch(srsran_gnb_ul_t*             q,
     // Set PUSCH data as not decoded
     data->tb[0].crc      = false;
     data->tb[0].avg_iter = NAN;
+    data->tb[0].nof_cb   = 0;
     data->uci.valid      = false;
     return SRSRAN_SUCCESS;
   }
@@ -89,6 +89,13 @@ static int pdcch_init(srsran_pdcch_t* q, uint32_t max_prb, uint32_t nof_rx_anten
 
     srsran_vec_f_zero(q->llr, q->max_bits);
 
+    q->cce_llr_mean = srsran_vec_f_malloc(q->max_bits / 72);
+    if (!q->cce_llr_mean) {
+      goto clean;
+    }
+
+    srsran_vec_f_zero(q->cce_llr_mean, q->max_bits / 72);
+
     q->d = srsran_vec_cf_malloc(q->max_bits / 2);
     if (!q->d) {
       goto clean;
@@ -140,6 +147,9 @@ void srsran_pdcch_free(srsran_pdcch_t* q)
   if (q->llr) {
     free(q->llr);
   }
+  if (q->cce_llr_mean) {
+    free(q->cce_llr_mean);
+  }
   if (q->d) {
     free(q->d);
   }
@@ -388,13 +398,9 @@ int srsran_pdcch_decode_msg(srsran_pdcch_t* q, srsran_dl_sf_cfg_t* sf, srsran_dc
       uint32_t e_bits   = PDCCH_FORMAT_NOF_BITS(msg->location.L);
 
       // Compute absolute mean of the LLRs
-      double mean = 0;
-      for (int i = 0; i < e_bits; i++) {
-        mean += fabsf(q->llr[msg->location.ncce * 72 + i]);
-      }
-      mean /= e_bits;
+      float mean = srsran_pdcch_candidate_llr_mean(q, sf, &msg->location);
 
-      if (mean > 0.3f) {
+      if (mean > SRSRAN_PDCCH_MIN_LLR_MEAN) {
         ret = srsran_pdcch_dci_decode(q, &q->llr[msg->location.ncce * 72], msg->payload, e_bits, nof_bits, &msg->rnti);
         if (ret == SRSRAN_SUCCESS) {
           msg->nof_bits = nof_bits;
@@ -422,6 +428,17 @@ int srsran_pdcch_decode_msg(srsran_pdcch_t* q, srsran_dl_sf_cfg_t* sf, srsran_dc
   return ret;
 }
 
+float srsran_pdcch_candidate_llr_mean(srsran_pdcch_t* q, srsran_dl_sf_cfg_t* sf, const srsran_dci_location_t* location)
+{
+  if (q == NULL || sf == NULL || location == NULL || location->L > 3 ||
+      location->ncce + (1U << location->L) > NOF_CCE(sf->cfi)) {
+    return -1.0f;
+  }
+
+  uint32_t nof_cce = 1U << location->L;
+  return srsran_vec_acc_ff(&q->cce_llr_mean[location->ncce], nof_cce) / nof_cce;
+}
+
 float srsran_pdcch_msg_corr(srsran_pdcch_t* q, srsran_dci_msg_t* msg)
 {
   if (q == NULL || msg == NULL) {
@@ -506,6 +523,16 @@ int srsran_pdcch_extract_llr(srsran_pdcch_t*        q,
     /* descramble */
     srsran_scrambling_f_offset(&q->seq[sf->tti % 10], q->llr, 0, e_bits);
 
+    /* mean absolute LLR of each CCE, shared by all the candidates that contain it */
+    for (uint32_t ncce = 0; ncce < NOF_CCE(sf->cfi); ncce++) {
+      const float* llr = &q->llr[ncce * 72];
+      float        acc = 0;
+      for (uint32_t k = 0; k < 72; k++) {
+        acc += fabsf(llr[k]);
+      }
+      q->cce_llr_mean[ncce] = acc / 72;
+    }
+
     ret = SRSRAN_SUCCESS;
   }
   return ret;
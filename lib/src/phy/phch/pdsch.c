@@ -902,6 +902,7 @@ int srsran_pdsch_decode(srsran_pdsch_t*        q,
             h->tb_idx                = tb_idx;
             h->ack                   = &data[tb_idx].crc;
             h->dl_sch.max_iterations = q->dl_sch.max_iterations;
+            h->dl_sch.cb_pool        = q->dl_sch.cb_pool;
             h->started               = true;
             sem_post(&h->start);
 
@@ -42,6 +42,7 @@
 #define PHI 7             // PRACH phi parameter
 #define PHI_4 2           // PRACH phi parameter for format 4
 #define MAX_ROOTS 838     // Max number of root sequences
+#define BATCH_STRIDE 848  // Distance between root correlation rows, keeps every row SIMD aligned
 //#define PRACH_CANCELLATION_HARD
 #define PRACH_AMP 1.0
 
@@ -568,7 +569,13 @@ int srsran_prach_init(srsran_prach_t* p, uint32_t max_N_ifft_ul)
     p->corr_spec  = srsran_vec_cf_malloc(SRSRAN_PRACH_N_ZC_LONG);
     p->corr       = srsran_vec_f_malloc(SRSRAN_PRACH_N_ZC_LONG);
     p->cross      = srsran_vec_cf_malloc(SRSRAN_PRACH_N_ZC_LONG);
-    p->corr_freq  = srsran_vec_cf_malloc(SRSRAN_PRACH_N_ZC_LONG);
+
+    p->corr_freq_batch = srsran_vec_cf_malloc(SRSRAN_PRACH_ROOT_BATCH * BATCH_STRIDE);
+    p->corr_spec_batch = srsran_vec_cf_malloc(SRSRAN_PRACH_ROOT_BATCH * BATCH_STRIDE);
+    if (!p->corr_freq_batch || !p->corr_spec_batch) {
+      ERROR("Error allocating memory");
+      return SRSRAN_ERROR;
+    }
 
     // Set up ZC FFTS
     if (srsran_dft_plan(&p->zc_fft, SRSRAN_PRACH_N_ZC_LONG, SRSRAN_DFT_FORWARD, SRSRAN_DFT_COMPLEX)) {
@@ -583,6 +590,19 @@ int srsran_prach_init(srsran_prach_t* p, uint32_t max_N_ifft_ul)
     srsran_dft_plan_set_mirror(&p->zc_ifft, false);
     srsran_dft_plan_set_norm(&p->zc_ifft, false);
 
+    if (srsran_dft_plan_guru_c(&p->zc_ifft_batch,
+                               SRSRAN_PRACH_N_ZC_LONG,
+                               SRSRAN_DFT_BACKWARD,
+                               p->corr_freq_batch,
+                               p->corr_spec_batch,
+                               1,
+                               1,
+                               SRSRAN_PRACH_ROOT_BATCH,
+                               BATCH_STRIDE,
+                               BATCH_STRIDE)) {
+      return SRSRAN_ERROR;
+    }
+
     uint32_t fft_size_alloc = max_N_ifft_ul * DELTA_F / DELTA_F_RA;
 
     p->ifft_in  = srsran_vec_cf_malloc(fft_size_alloc);
@@ -687,10 +707,28 @@ int srsran_prach_set_cell_(srsran_prach_t*      p,
         return SRSRAN_ERROR;
       }
     }
+    if (p->zc_ifft_batch.size != p->N_zc) {
+      if (srsran_dft_replan_guru_c(&p->zc_ifft_batch,
+                                   p->N_zc,
+                                   p->corr_freq_batch,
+                                   p->corr_spec_batch,
+                                   1,
+                                   1,
+                                   SRSRAN_PRACH_ROOT_BATCH,
+                                   BATCH_STRIDE,
+                                   BATCH_STRIDE)) {
+        return SRSRAN_ERROR;
+      }
+    }
 
     // Generate our 64 sequences
     p->N_roots = 0;
     srsran_prach_gen_seqs(p);
+
+    // Precompute the frequency-domain correlators of the root sequences, so that detection never has to
+    for (uint32_t i = 0; i < p->N_roots; i++) {
+      get_precoded_dft(p, p->root_seqs_idx[i]);
+    }
     // Ensure num_ra_preambles is valid, if not assign default value
     if (p->num_ra_preambles < 4 || p->num_ra_preambles > p->N_roots) {
       p->num_ra_preambles = p->N_roots;
@@ -866,76 +904,99 @@ void srsran_prach_calculate_correction_array(srsran_prach_t* p, cf_t* corr_freq)
   }
 }
 
-// This function carries out the main processing on the incomming PRACH signal
-int srsran_prach_process(srsran_prach_t* p,
-                         cf_t*           signal,
-                         uint32_t*       indices,
-                         float*          t_offsets,
-                         float*          peak_to_avg,
-                         uint32_t*       n_indices,
-                         int             cancellation_idx,
-                         uint32_t        begin,
-                         uint32_t        sig_len)
+/// Finds the highest correlation peak of each cyclic shift window of a root sequence, returns the highest of them all
+static float prach_search_windows(srsran_prach_t* p, uint32_t n_wins, uint32_t winsize)
 {
-  float max_to_cancel = 0;
-  cancellation_idx    = -1;
-  int max_idx         = 0;
-  srsran_vec_cf_zero(p->cross, p->N_zc);
-  srsran_vec_cf_zero(p->corr_freq, p->N_zc);
-  for (int i = 0; i < p->num_ra_preambles; i++) {
-    cf_t* root_spec = get_precoded_dft(p, p->root_seqs_idx[i]);
-
-    srsran_vec_prod_conj_ccc(p->prach_bins, root_spec, p->corr_spec, p->N_zc);
-
-    srsran_vec_prod_conj_ccc(p->corr_spec, &p->corr_spec[1], p->cross, p->N_zc - 1);
-    if (p->successive_cancellation) {
-      srsran_vec_cf_copy(p->corr_freq, p->corr_spec, p->N_zc);
+  float max_peak = 0;
+  for (int j = 0; j < n_wins; j++) {
+    uint32_t start = (p->N_zc - (j * p->N_cs)) % p->N_zc;
+    uint32_t end   = start + winsize;
+    if (end > p->deadzone) {
+      end -= p->deadzone;
+    }
+    start += p->deadzone;
+    p->peak_values[j] = 0;
+    if (end > start) {
+      uint32_t k         = srsran_vec_max_fi(&p->corr[start], end - start);
+      p->peak_values[j]  = p->corr[start + k];
+      p->peak_offsets[j] = k;
+      max_peak           = SRSRAN_MAX(max_peak, p->peak_values[j]);
     }
-    srsran_dft_run(&p->zc_ifft, p->corr_spec, p->corr_spec);
+  }
+  return max_peak;
+}
+
+/**
+ * Searches the preambles of the root sequences in [root_begin, root_end). The roots are correlated with the bins in
+ * batches of SRSRAN_PRACH_ROOT_BATCH, the correlations of a full batch are brought to the time domain by a single
+ * IFFT. Returns the index of the preamble to cancel, or -1 if there is none
+ */
+static int prach_detect_roots(srsran_prach_t* p,
+                              const cf_t*     bins,
+                              uint32_t        root_begin,
+                              uint32_t        root_end,
+                              uint32_t*       indices,
+                              float*          t_offsets,
+                              float*          peak_to_avg,
+                              uint32_t*       n_indices,
+                              bool            cancellation)
+{
+  float max_to_cancel    = 0;
+  int   cancellation_idx = -1;
 
-    srsran_vec_abs_square_cf(p->corr_spec, p->corr, p->N_zc);
+  uint32_t winsize = 0;
+  if (p->N_cs != 0) {
+    winsize = p->N_cs;
+  } else {
+    winsize = p->N_zc;
+  }
+  uint32_t n_wins = p->N_zc / winsize;
 
-    float corr_ave = srsran_vec_acc_ff(p->corr, p->N_zc) / p->N_zc;
+  for (uint32_t batch = root_begin; batch < root_end; batch += SRSRAN_PRACH_ROOT_BATCH) {
+    uint32_t nof_rows = SRSRAN_MIN(SRSRAN_PRACH_ROOT_BATCH, root_end - batch);
 
-    uint32_t winsize = 0;
-    if (p->N_cs != 0) {
-      winsize = p->N_cs;
+    // Correlate the bins with every root of the batch in the frequency domain
+    for (uint32_t r = 0; r < nof_rows; r++) {
+      cf_t* root_spec = get_precoded_dft(p, p->root_seqs_idx[batch + r]);
+      srsran_vec_prod_conj_ccc(bins, root_spec, &p->corr_freq_batch[r * BATCH_STRIDE], p->N_zc);
+    }
+    if (nof_rows == SRSRAN_PRACH_ROOT_BATCH) {
+      srsran_dft_run_guru_c(&p->zc_ifft_batch);
     } else {
-      winsize = p->N_zc;
+      for (uint32_t r = 0; r < nof_rows; r++) {
+        srsran_dft_run_c_zerocopy(
+            &p->zc_ifft, &p->corr_freq_batch[r * BATCH_STRIDE], &p->corr_spec_batch[r * BATCH_STRIDE]);
+      }
     }
-    uint32_t n_wins = p->N_zc / winsize;
-
-    float max_peak = 0;
-    for (int j = 0; j < n_wins; j++) {
-      uint32_t start = (p->N_zc - (j * p->N_cs)) % p->N_zc;
-      uint32_t end   = start + winsize;
-      if (end > p->deadzone) {
-        end -= p->deadzone;
+
+    for (uint32_t r = 0; r < nof_rows; r++) {
+      uint32_t i         = batch + r;
+      cf_t*    corr_freq = &p->corr_freq_batch[r * BATCH_STRIDE];
+
+      srsran_vec_abs_square_cf(&p->corr_spec_batch[r * BATCH_STRIDE], p->corr, p->N_zc);
+
+      float corr_ave  = srsran_vec_acc_ff(p->corr, p->N_zc) / p->N_zc;
+      float threshold = p->detect_factor * corr_ave;
+
+      float max_peak = prach_search_windows(p, n_wins, winsize);
+      if (max_peak <= threshold) {
+        continue;
       }
-      start += p->deadzone;
-      p->peak_values[j] = 0;
-      for (int k = start; k < end; k++) {
-        if (p->corr[k] > p->peak_values[j]) {
-          p->peak_values[j]  = p->corr[k];
-          p->peak_offsets[j] = k - start;
-          if (p->peak_values[j] > max_peak) {
-            max_peak = p->peak_values[j];
-            max_idx  = k;
-          }
-        }
+
+      if (t_offsets && p->freq_domain_offset_calc) {
+        srsran_vec_prod_conj_ccc(corr_freq, &corr_freq[1], p->cross, p->N_zc - 1);
+        p->cross[p->N_zc - 1] = 0;
       }
-    }
-    if (max_peak > (p->detect_factor * corr_ave)) {
       for (int j = 0; j < n_wins; j++) {
-        if (p->peak_values[j] > p->detect_factor * corr_ave) {
+        if (p->peak_values[j] > threshold) {
           if (indices) {
-            if (p->successive_cancellation) {
+            if (cancellation) {
               if (max_peak > max_to_cancel) {
                 cancellation_idx       = (i * n_wins) + j;
                 max_to_cancel          = max_peak;
                 p->prach_cancel.idx    = cancellation_idx;
                 p->prach_cancel.factor = (sqrt(max_peak / (p->N_zc * p->N_zc)));
-                srsran_prach_calculate_correction_array(p, p->corr_freq);
+                srsran_prach_calculate_correction_array(p, corr_freq);
               }
               if (srsran_prach_have_stored(((i * n_wins) + j), indices, *n_indices)) {
                 break;
@@ -957,6 +1018,29 @@ int srsran_prach_process(srsran_prach_t* p,
       }
     }
   }
+  return cancellation_idx;
+}
+
+// This function carries out the main processing on the incomming PRACH signal
+int srsran_prach_process(srsran_prach_t* p,
+                         cf_t*           signal,
+                         uint32_t*       indices,
+                         float*          t_offsets,
+                         float*          peak_to_avg,
+                         uint32_t*       n_indices,
+                         int             cancellation_idx,
+                         uint32_t        begin,
+                         uint32_t        sig_len)
+{
+  cancellation_idx = prach_detect_roots(p,
+                                        p->prach_bins,
+                                        0,
+                                        p->num_ra_preambles,
+                                        indices,
+                                        t_offsets,
+                                        peak_to_avg,
+                                        n_indices,
+                                        p->successive_cancellation);
   if (cancellation_idx != -1) {
     // if a peak has been found, this applies cancellation, if many found, subtracts strongest
     srsran_prach_cancellation(p);
@@ -966,6 +1050,50 @@ int srsran_prach_process(srsran_prach_t* p,
   return 0;
 }
 
+uint32_t srsran_prach_nof_roots(const srsran_prach_t* p)
+{
+  return p->num_ra_preambles;
+}
+
+int srsran_prach_extract_bins(srsran_prach_t* p, uint32_t freq_offset, const cf_t* signal, uint32_t sig_len)
+{
+  if (p == NULL || signal == NULL || sig_len == 0) {
+    return SRSRAN_ERROR_INVALID_INPUTS;
+  }
+  if (sig_len < p->N_ifft_prach) {
+    ERROR("srsran_prach_detect: Signal length is %d and should be %d", sig_len, p->N_ifft_prach);
+    return SRSRAN_ERROR_INVALID_INPUTS;
+  }
+
+  // FFT incoming signal
+  srsran_dft_run(&p->fft, signal, p->signal_fft);
+
+  // Extract bins of interest
+  uint32_t N_rb_ul = srsran_nof_prb(p->N_ifft_ul);
+  uint32_t k_0     = freq_offset * N_RB_SC - N_rb_ul * N_RB_SC / 2 + p->N_ifft_ul / 2;
+  uint32_t K       = DELTA_F / DELTA_F_RA;
+  uint32_t begin   = PHI + (K * k_0) + (p->is_nr ? 0 : (K / 2));
+
+  memcpy(p->prach_bins, &p->signal_fft[begin], p->N_zc * sizeof(cf_t));
+  return SRSRAN_SUCCESS;
+}
+
+int srsran_prach_detect_roots(srsran_prach_t* p,
+                              const cf_t*     bins,
+                              uint32_t        root_begin,
+                              uint32_t        root_end,
+                              uint32_t*       indices,
+                              float*          t_offsets,
+                              float*          peak_to_avg,
+                              uint32_t*       n_indices)
+{
+  if (p == NULL || bins == NULL || indices == NULL || n_indices == NULL || root_end > p->num_ra_preambles) {
+    return SRSRAN_ERROR_INVALID_INPUTS;
+  }
+  prach_detect_roots(p, bins, root_begin, root_end, indices, t_offsets, peak_to_avg, n_indices, false);
+  return SRSRAN_SUCCESS;
+}
+
 int srsran_prach_detect_offset(srsran_prach_t* p,
                                uint32_t        freq_offset,
                                cf_t*           signal,
@@ -977,31 +1105,20 @@ int srsran_prach_detect_offset(srsran_prach_t* p,
 {
   int ret = SRSRAN_ERROR;
   if (p != NULL && signal != NULL && sig_len > 0 && indices != NULL) {
-    if (sig_len < p->N_ifft_prach) {
-      ERROR("srsran_prach_detect: Signal length is %d and should be %d", sig_len, p->N_ifft_prach);
-      return SRSRAN_ERROR_INVALID_INPUTS;
-    }
     int cancellation_idx = -2;
     bzero(&p->prach_cancel, sizeof(srsran_prach_cancellation_t));
 
-    // FFT incoming signal
-    srsran_dft_run(&p->fft, signal, p->signal_fft);
-
     *n_indices = 0;
 
-    // Extract bins of interest
-    uint32_t N_rb_ul = srsran_nof_prb(p->N_ifft_ul);
-    uint32_t k_0     = freq_offset * N_RB_SC - N_rb_ul * N_RB_SC / 2 + p->N_ifft_ul / 2;
-    uint32_t K       = DELTA_F / DELTA_F_RA;
-    uint32_t begin   = PHI + (K * k_0) + (p->is_nr ? 0 : (K / 2));
+    if (srsran_prach_extract_bins(p, freq_offset, signal, sig_len)) {
+      return SRSRAN_ERROR_INVALID_INPUTS;
+    }
 
-    memcpy(p->prach_bins, &p->signal_fft[begin], p->N_zc * sizeof(cf_t));
     int loops = (p->successive_cancellation) ? SUCCESSIVE_CANCELLATION_ITS : 1;
     // if successive cancellation is enabled, we perform the entire search process p->num_ra_preambles times, removing
     // the highest power PRACH preamble each time.
     for (int l = 0; l < loops; l++) {
-      if (srsran_prach_process(
-              p, signal, indices, t_offsets, peak_to_avg, n_indices, cancellation_idx, begin, sig_len)) {
+      if (srsran_prach_process(p, signal, indices, t_offsets, peak_to_avg, n_indices, cancellation_idx, 0, sig_len)) {
         break;
       }
     }
@@ -1020,10 +1137,12 @@ int srsran_prach_free(srsran_prach_t* p)
   free(p->ifft_in);
   free(p->ifft_out);
   free(p->cross);
-  free(p->corr_freq);
+  free(p->corr_freq_batch);
+  free(p->corr_spec_batch);
   srsran_dft_plan_free(&p->fft);
   srsran_dft_plan_free(&p->zc_fft);
   srsran_dft_plan_free(&p->zc_ifft);
+  srsran_dft_plan_free(&p->zc_ifft_batch);
 
   if (p->signal_fft) {
     free(p->signal_fft);
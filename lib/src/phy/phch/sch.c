@@ -220,6 +220,11 @@ void srsran_sch_free(srsran_sch_t* q)
   bzero(q, sizeof(srsran_sch_t));
 }
 
+void srsran_sch_set_cb_pool(srsran_sch_t* q, srsran_sch_cb_pool_t* pool)
+{
+  q->cb_pool = pool;
+}
+
 void srsran_sch_set_max_noi(srsran_sch_t* q, uint32_t max_iterations)
 {
   if (max_iterations == 0) {
@@ -368,109 +373,163 @@ static int encode_tb(srsran_sch_t*           q,
   return encode_tb_off(q, soft_buffer, cb_segm, Qm, rv, nof_e_bits, data, e_bits, 0);
 }
 
-bool decode_tb_cb(srsran_sch_t*           q,
-                  srsran_softbuffer_rx_t* softbuffer,
-                  srsran_cbsegm_t*        cb_segm,
-                  uint32_t                Qm,
-                  uint32_t                rv,
-                  uint32_t                nof_e_bits,
-                  void*                   e_bits,
-                  uint8_t*                data)
+/* Arguments of a transport block decoding, shared by all its code block tasks */
+typedef struct {
+  srsran_sch_t*           q;
+  srsran_softbuffer_rx_t* softbuffer;
+  srsran_cbsegm_t*        cb_segm;
+  uint32_t                Qm;
+  uint32_t                rv;
+  uint32_t                nof_e_bits;
+  void*                   e_bits;
+  uint8_t*                data;
+  int                     ret[SRSRAN_MAX_CODEBLOCKS];
+  uint32_t                cb_noi[SRSRAN_MAX_CODEBLOCKS];
+} sch_decode_tb_args_t;
+
+static void decode_cb(void* arg, uint32_t cb_idx, void* ctx)
 {
-  int8_t*  e_bits_b = e_bits;
-  int16_t* e_bits_s = e_bits;
-
-  if (cb_segm->C > SRSRAN_MAX_CODEBLOCKS) {
-    ERROR("Error SRSRAN_MAX_CODEBLOCKS=%d", SRSRAN_MAX_CODEBLOCKS);
-    return false;
-  }
-
-  q->avg_iterations = 0;
-
-  for (int cb_idx = 0; cb_idx < cb_segm->C; cb_idx++) {
-    /* Do not process blocks with CRC Ok */
-    if (softbuffer->cb_crc[cb_idx] == false) {
-      uint32_t cb_len     = cb_idx < cb_segm->C1 ? cb_segm->K1 : cb_segm->K2;
-      uint32_t cb_len_idx = cb_idx < cb_segm->C1 ? cb_segm->K1_idx : cb_segm->K2_idx;
+  srsran_sch_cb_decoder_t* dec        = (srsran_sch_cb_decoder_t*)ctx;
+  sch_decode_tb_args_t*    args       = (sch_decode_tb_args_t*)arg;
+  srsran_sch_t*            q          = args->q;
+  srsran_softbuffer_rx_t*  softbuffer = args->softbuffer;
+  srsran_cbsegm_t*         cb_segm    = args->cb_segm;
+  uint32_t                 Qm         = args->Qm;
+  uint8_t*                 data       = args->data;
+  int8_t*                  e_bits_b   = args->e_bits;
+  int16_t*                 e_bits_s   = args->e_bits;
+
+  // Workers of the code block pool use their own decoder, the calling thread uses the SCH decoder
+  srsran_tdec_t* decoder = dec ? &dec->decoder : &q->decoder;
+  srsran_crc_t*  crc_cb  = dec ? &dec->crc_cb : &q->crc_cb;
+  srsran_crc_t*  crc_tb  = dec ? &dec->crc_tb : &q->crc_tb;
+  uint8_t*       cb_out  = dec ? dec->cb_out : q->cb_in;
+
+  args->ret[cb_idx]    = SRSRAN_SUCCESS;
+  args->cb_noi[cb_idx] = 0;
+
+  /* Do not process blocks with CRC Ok */
+  if (softbuffer->cb_crc[cb_idx] == false) {
+    uint32_t cb_len     = cb_idx < cb_segm->C1 ? cb_segm->K1 : cb_segm->K2;
+    uint32_t cb_len_idx = cb_idx < cb_segm->C1 ? cb_segm->K1_idx : cb_segm->K2_idx;
+
+    uint32_t rlen  = cb_segm->C == 1 ? cb_len : (cb_len - 24);
+    uint32_t Gp    = args->nof_e_bits / Qm;
+    uint32_t gamma = cb_segm->C > 0 ? Gp % cb_segm->C : Gp;
+    uint32_t n_e   = Qm * (Gp / cb_segm->C);
+
+    uint32_t rp   = cb_idx * n_e;
+    uint32_t n_e2 = n_e;
+
+    if (cb_idx > cb_segm->C - gamma) {
+      n_e2 = n_e + Qm;
+      rp   = (cb_segm->C - gamma) * n_e + (cb_idx - (cb_segm->C - gamma)) * n_e2;
+    }
 
-      uint32_t rlen  = cb_segm->C == 1 ? cb_len : (cb_len - 24);
-      uint32_t Gp    = nof_e_bits / Qm;
-      uint32_t gamma = cb_segm->C > 0 ? Gp % cb_segm->C : Gp;
-      uint32_t n_e   = Qm * (Gp / cb_segm->C);
+    if (q->llr_is_8bit) {
+      if (srsran_rm_turbo_rx_lut_8bit(&e_bits_b[rp], (int8_t*)softbuffer->buffer_f[cb_idx], n_e2, cb_len_idx, args->rv)) {
+        ERROR("Error in rate matching");
+        args->ret[cb_idx] = SRSRAN_ERROR;
+        return;
+      }
+    } else {
+      if (srsran_rm_turbo_rx_lut(&e_bits_s[rp], softbuffer->buffer_f[cb_idx], n_e2, cb_len_idx, args->rv)) {
+        ERROR("Error in rate matching");
+        args->ret[cb_idx] = SRSRAN_ERROR;
+        return;
+      }
+    }
 
-      uint32_t rp   = cb_idx * n_e;
-      uint32_t n_e2 = n_e;
+    srsran_tdec_new_cb(decoder, cb_len);
 
-      if (cb_idx > cb_segm->C - gamma) {
-        n_e2 = n_e + Qm;
-        rp   = (cb_segm->C - gamma) * n_e + (cb_idx - (cb_segm->C - gamma)) * n_e2;
+    // Run iterations and use CRC for early stopping
+    bool     early_stop = false;
+    uint32_t cb_noi     = 0;
+    do {
+      // Decode into a private buffer, the CB CRC bits would otherwise overlap with the next CB data
+      if (q->llr_is_8bit) {
+        srsran_tdec_iteration_8bit(decoder, (int8_t*)softbuffer->buffer_f[cb_idx], cb_out);
+      } else {
+        srsran_tdec_iteration(decoder, softbuffer->buffer_f[cb_idx], cb_out);
       }
+      cb_noi++;
 
-      if (q->llr_is_8bit) {
-        if (srsran_rm_turbo_rx_lut_8bit(&e_bits_b[rp], (int8_t*)softbuffer->buffer_f[cb_idx], n_e2, cb_len_idx, rv)) {
-          ERROR("Error in rate matching");
-          return SRSRAN_ERROR;
-        }
+      uint32_t      len_crc;
+      srsran_crc_t* crc_ptr;
+
+      if (cb_segm->C > 1) {
+        len_crc = cb_len;
+        crc_ptr = crc_cb;
       } else {
-        if (srsran_rm_turbo_rx_lut(&e_bits_s[rp], softbuffer->buffer_f[cb_idx], n_e2, cb_len_idx, rv)) {
-          ERROR("Error in rate matching");
-          return SRSRAN_ERROR;
-        }
+        len_crc = cb_segm->tbs + 24;
+        crc_ptr = crc_tb;
       }
 
-      srsran_tdec_new_cb(&q->decoder, cb_len);
+      // CRC is OK and ran the minimum number of iterations
+      if (!srsran_crc_checksum_byte(crc_ptr, cb_out, len_crc) &&
+          (cb_noi >= SRSRAN_PDSCH_MIN_TDEC_ITERS)) {
+        softbuffer->cb_crc[cb_idx] = true;
+        early_stop                 = true;
 
-      // Run iterations and use CRC for early stopping
-      bool     early_stop = false;
-      uint32_t cb_noi     = 0;
-      do {
-        if (q->llr_is_8bit) {
-          srsran_tdec_iteration_8bit(&q->decoder, (int8_t*)softbuffer->buffer_f[cb_idx], &data[cb_idx * rlen / 8]);
-        } else {
-          srsran_tdec_iteration(&q->decoder, softbuffer->buffer_f[cb_idx], &data[cb_idx * rlen / 8]);
-        }
-        q->avg_iterations++;
-        cb_noi++;
+        // CRC is error and exceeded maximum iterations for this CB.
+        // Early stop the whole transport block.
+      }
 
-        uint32_t      len_crc;
-        srsran_crc_t* crc_ptr;
+    } while (cb_noi < q->max_iterations && !early_stop);
+    args->cb_noi[cb_idx] = cb_noi;
+    memcpy(&data[cb_idx * rlen / 8], cb_out, rlen / 8);
 
-        if (cb_segm->C > 1) {
-          len_crc = cb_len;
-          crc_ptr = &q->crc_cb;
-        } else {
-          len_crc = cb_segm->tbs + 24;
-          crc_ptr = &q->crc_tb;
-        }
+    INFO("CB %d: rp=%d, n_e=%d, cb_len=%d, CRC=%s, rlen=%d, iterations=%d/%d",
+         cb_idx,
+         rp,
+         n_e2,
+         cb_len,
+         early_stop ? "OK" : "KO",
+         rlen,
+         cb_noi,
+         q->max_iterations);
 
-        // CRC is OK and ran the minimum number of iterations
-        if (!srsran_crc_checksum_byte(crc_ptr, &data[cb_idx * rlen / 8], len_crc) &&
-            (cb_noi >= SRSRAN_PDSCH_MIN_TDEC_ITERS)) {
-          softbuffer->cb_crc[cb_idx] = true;
-          early_stop                 = true;
+  } else {
+    // Copy decoded data from previous transmissions
+    uint32_t cb_len = cb_idx < cb_segm->C1 ? cb_segm->K1 : cb_segm->K2;
+    uint32_t rlen   = cb_segm->C == 1 ? cb_len : (cb_len - 24);
+    memcpy(&data[cb_idx * rlen / 8], softbuffer->data[cb_idx], rlen / 8 * sizeof(uint8_t));
+  }
+}
 
-          // CRC is error and exceeded maximum iterations for this CB.
-          // Early stop the whole transport block.
-        }
+bool decode_tb_cb(srsran_sch_t*           q,
+                  srsran_softbuffer_rx_t* softbuffer,
+                  srsran_cbsegm_t*        cb_segm,
+                  uint32_t                Qm,
+                  uint32_t                rv,
+                  uint32_t                nof_e_bits,
+                  void*                   e_bits,
+                  uint8_t*                data)
+{
+  if (cb_segm->C > SRSRAN_MAX_CODEBLOCKS) {
+    ERROR("Error SRSRAN_MAX_CODEBLOCKS=%d", SRSRAN_MAX_CODEBLOCKS);
+    return false;
+  }
 
-      } while (cb_noi < q->max_iterations && !early_stop);
+  sch_decode_tb_args_t args = {};
+  args.q                    = q;
+  args.softbuffer           = softbuffer;
+  args.cb_segm              = cb_segm;
+  args.Qm                   = Qm;
+  args.rv                   = rv;
+  args.nof_e_bits           = nof_e_bits;
+  args.e_bits               = e_bits;
+  args.data                 = data;
 
-      INFO("CB %d: rp=%d, n_e=%d, cb_len=%d, CRC=%s, rlen=%d, iterations=%d/%d",
-           cb_idx,
-           rp,
-           n_e2,
-           cb_len,
-           early_stop ? "OK" : "KO",
-           rlen,
-           cb_noi,
-           q->max_iterations);
+  // Decode all code blocks, possibly in parallel. Returns once all of them are finished.
+  srsran_sch_cb_pool_run(q->cb_pool, decode_cb, &args, cb_segm->C);
 
-    } else {
-      // Copy decoded data from previous transmissions
-      uint32_t cb_len = cb_idx < cb_segm->C1 ? cb_segm->K1 : cb_segm->K2;
-      uint32_t rlen   = cb_segm->C == 1 ? cb_len : (cb_len - 24);
-      memcpy(&data[cb_idx * rlen / 8], softbuffer->data[cb_idx], rlen / 8 * sizeof(uint8_t));
+  q->avg_iterations = 0;
+  for (int i = 0; i < cb_segm->C; i++) {
+    if (args.ret[i] < SRSRAN_SUCCESS) {
+      return SRSRAN_ERROR;
     }
+    q->avg_iterations += args.cb_noi[i];
   }
 
   softbuffer->tb_crc = true;
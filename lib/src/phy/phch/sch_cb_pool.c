@@ -0,0 +1,264 @@
+/**
+ * Copyright 2013-2021 Software Radio Systems Limited
+ *
+ * This file is part of srsRAN.
+ *
+ * srsRAN is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsRAN is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+#include "srsran/phy/phch/sch_cb_pool.h"
+#include "srsran/phy/common/phy_common.h"
+#include "srsran/phy/fec/turbo/turbocoder.h"
+#include "srsran/phy/utils/debug.h"
+#include "srsran/phy/utils/vector.h"
+#include <stdlib.h>
+#include <string.h>
+
+int srsran_sch_cb_decoder_init(srsran_sch_cb_decoder_t* dec)
+{
+  if (dec == NULL) {
+    return SRSRAN_ERROR_INVALID_INPUTS;
+  }
+
+  dec->cb_out = srsran_vec_u8_malloc((SRSRAN_TCOD_MAX_LEN_CB + 8) / 8);
+  if (dec->cb_out == NULL) {
+    return SRSRAN_ERROR;
+  }
+  if (srsran_tdec_init(&dec->decoder, SRSRAN_TCOD_MAX_LEN_CB)) {
+    ERROR("Error initiating Turbo Decoder");
+    return SRSRAN_ERROR;
+  }
+  if (srsran_crc_init(&dec->crc_cb, SRSRAN_LTE_CRC24B, 24)) {
+    ERROR("Error initiating CRC");
+    return SRSRAN_ERROR;
+  }
+  if (srsran_crc_init(&dec->crc_tb, SRSRAN_LTE_CRC24A, 24)) {
+    ERROR("Error initiating CRC");
+    return SRSRAN_ERROR;
+  }
+  return SRSRAN_SUCCESS;
+}
+
+void srsran_sch_cb_decoder_free(srsran_sch_cb_decoder_t* dec)
+{
+  if (dec != NULL) {
+    srsran_tdec_free(&dec->decoder);
+    if (dec->cb_out) {
+      free(dec->cb_out);
+    }
+  }
+}
+
+/* Claims the next code block of job. Removes the job from the pending list once all its code blocks are claimed.
+ * Must be called with the pool mutex locked. */
+static bool sch_cb_pool_claim(srsran_sch_cb_pool_t* q, srsran_sch_cb_job_t* job, uint32_t* cb_idx)
+{
+  if (job == NULL || job->next_cb >= job->nof_cb) {
+    return false;
+  }
+
+  *cb_idx = job->next_cb++;
+
+  if (job->next_cb == job->nof_cb) {
+    srsran_sch_cb_job_t* prev = NULL;
+    srsran_sch_cb_job_t* it   = q->job_head;
+    while (it != NULL && it != job) {
+      prev = it;
+      it   = it->next;
+    }
+    if (it != NULL) {
+      if (prev == NULL) {
+        q->job_head = job->next;
+      } else {
+        prev->next = job->next;
+      }
+      if (q->job_tail == job) {
+        q->job_tail = prev;
+      }
+    }
+    job->next = NULL;
+  }
+  return true;
+}
+
+/* Must be called with the pool mutex locked */
+static void sch_cb_pool_done(srsran_sch_cb_pool_t* q, srsran_sch_cb_job_t* job)
+{
+  job->nof_done++;
+  if (job->nof_done == job->nof_cb) {
+    pthread_cond_broadcast(&q->cvar_done);
+  }
+}
+
+static void* sch_cb_pool_thread(void* arg)
+{
+  srsran_sch_cb_worker_t* w = (srsran_sch_cb_worker_t*)arg;
+  srsran_sch_cb_pool_t*   q = w->pool;
+
+  pthread_mutex_lock(&q->mutex);
+  while (!q->quit) {
+    srsran_sch_cb_job_t* job    = q->job_head;
+    uint32_t             cb_idx = 0;
+    if (sch_cb_pool_claim(q, job, &cb_idx)) {
+      pthread_mutex_unlock(&q->mutex);
+      job->task(job->arg, cb_idx, w->ctx);
+      pthread_mutex_lock(&q->mutex);
+      sch_cb_pool_done(q, job);
+    } else {
+      pthread_cond_wait(&q->cvar_job, &q->mutex);
+    }
+  }
+  pthread_mutex_unlock(&q->mutex);
+
+  return NULL;
+}
+
+static void* sch_cb_decoder_new(void* arg)
+{
+  srsran_sch_cb_decoder_t* dec = calloc(1, sizeof(srsran_sch_cb_decoder_t));
+  if (dec == NULL) {
+    return NULL;
+  }
+  if (srsran_sch_cb_decoder_init(dec)) {
+    srsran_sch_cb_decoder_free(dec);
+    free(dec);
+    return NULL;
+  }
+  return dec;
+}
+
+static void sch_cb_decoder_delete(void* ctx)
+{
+  srsran_sch_cb_decoder_free((srsran_sch_cb_decoder_t*)ctx);
+  free(ctx);
+}
+
+int srsran_sch_cb_pool_init(srsran_sch_cb_pool_t* q, uint32_t nof_workers)
+{
+  return srsran_sch_cb_pool_init_ctx(q, nof_workers, sch_cb_decoder_new, sch_cb_decoder_delete, NULL);
+}
+
+int srsran_sch_cb_pool_init_ctx(srsran_sch_cb_pool_t*    q,
+                                uint32_t                 nof_workers,
+                                srsran_sch_cb_ctx_new_t  ctx_new,
+                                srsran_sch_cb_ctx_free_t ctx_free,
+                                void*                    arg)
+{
+  if (q == NULL || ctx_new == NULL || ctx_free == NULL) {
+    return SRSRAN_ERROR_INVALID_INPUTS;
+  }
+
+  bzero(q, sizeof(srsran_sch_cb_pool_t));
+  pthread_mutex_init(&q->mutex, NULL);
+  pthread_cond_init(&q->cvar_job, NULL);
+  pthread_cond_init(&q->cvar_done, NULL);
+  q->ctx_free = ctx_free;
+
+  if (nof_workers == 0) {
+    return SRSRAN_SUCCESS;
+  }
+
+  q->workers = calloc(nof_workers, sizeof(srsran_sch_cb_worker_t));
+  if (q->workers == NULL) {
+    ERROR("Error allocating code block decoder workers");
+    return SRSRAN_ERROR;
+  }
+
+  for (uint32_t i = 0; i < nof_workers; i++) {
+    srsran_sch_cb_worker_t* w = &q->workers[i];
+    w->pool                   = q;
+    w->ctx                    = ctx_new(arg);
+    if (w->ctx == NULL) {
+      ERROR("Error creating code block decoder context");
+      srsran_sch_cb_pool_free(q);
+      return SRSRAN_ERROR;
+    }
+    if (pthread_create(&w->thread, NULL, sch_cb_pool_thread, w)) {
+      ERROR("Error creating code block decoder thread");
+      ctx_free(w->ctx);
+      srsran_sch_cb_pool_free(q);
+      return SRSRAN_ERROR;
+    }
+    q->nof_workers++;
+  }
+
+  return SRSRAN_SUCCESS;
+}
+
+void srsran_sch_cb_pool_free(srsran_sch_cb_pool_t* q)
+{
+  if (q == NULL) {
+    return;
+  }
+
+  pthread_mutex_lock(&q->mutex);
+  q->quit = true;
+  pthread_cond_broadcast(&q->cvar_job);
+  pthread_mutex_unlock(&q->mutex);
+
+  for (uint32_t i = 0; i < q->nof_workers; i++) {
+    pthread_join(q->workers[i].thread, NULL);
+    q->ctx_free(q->workers[i].ctx);
+  }
+  if (q->workers) {
+    free(q->workers);
+  }
+
+  pthread_cond_destroy(&q->cvar_done);
+  pthread_cond_destroy(&q->cvar_job);
+  pthread_mutex_destroy(&q->mutex);
+  bzero(q, sizeof(srsran_sch_cb_pool_t));
+}
+
+void srsran_sch_cb_pool_run(srsran_sch_cb_pool_t* q, srsran_sch_cb_task_t task, void* arg, uint32_t nof_cb)
+{
+  // Serial decoding when there is nothing to share
+  if (q == NULL || q->nof_workers == 0 || nof_cb < 2) {
+    for (uint32_t i = 0; i < nof_cb; i++) {
+      task(arg, i, NULL);
+    }
+    return;
+  }
+
+  srsran_sch_cb_job_t job = {};
+  job.task                = task;
+  job.arg                 = arg;
+  job.nof_cb              = nof_cb;
+
+  pthread_mutex_lock(&q->mutex);
+  if (q->job_tail == NULL) {
+    q->job_head = &job;
+  } else {
+    q->job_tail->next = &job;
+  }
+  q->job_tail = &job;
+  pthread_cond_broadcast(&q->cvar_job);
+
+  // The caller decodes code blocks of its own job too
+  uint32_t cb_idx = 0;
+  while (sch_cb_pool_claim(q, &job, &cb_idx)) {
+    pthread_mutex_unlock(&q->mutex);
+    task(arg, cb_idx, NULL);
+    pthread_mutex_lock(&q->mutex);
+    sch_cb_pool_done(q, &job);
+  }
+
+  // Deterministic join: all code blocks are decoded before returning
+  while (job.nof_done < job.nof_cb) {
+    pthread_cond_wait(&q->cvar_done, &q->mutex);
+  }
+  pthread_mutex_unlock(&q->mutex);
+}
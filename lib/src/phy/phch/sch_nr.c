@@ -28,6 +28,7 @@
 #include "srsran/phy/utils/bit.h"
 #include "srsran/phy/utils/debug.h"
 #include "srsran/phy/utils/vector.h"
+#include <sys/time.h>
 
 #define SCH_INFO_TX(...) INFO("SCH Tx: " __VA_ARGS__)
 #define SCH_INFO_RX(...) INFO("SCH Rx: " __VA_ARGS__)
@@ -194,6 +195,8 @@ static inline int sch_nr_init_common(srsran_sch_nr_t* q)
     return SRSRAN_ERROR_INVALID_INPUTS;
   }
 
+  q->cb_pool = NULL;
+
   if (srsran_crc_init(&q->crc_tb_24, SRSRAN_LTE_CRC24A, 24) < SRSRAN_SUCCESS) {
     return SRSRAN_ERROR;
   }
@@ -370,6 +373,46 @@ int srsran_sch_nr_set_carrier(srsran_sch_nr_t* q, const srsran_carrier_nr_t* car
   return SRSRAN_SUCCESS;
 }
 
+static void* sch_nr_cb_decoder_new(void* arg)
+{
+  srsran_sch_nr_t* q = SRSRAN_MEM_ALLOC(srsran_sch_nr_t, 1);
+  if (q == NULL) {
+    return NULL;
+  }
+  SRSRAN_MEM_ZERO(q, srsran_sch_nr_t, 1);
+
+  if (srsran_sch_nr_init_rx(q, (const srsran_sch_nr_args_t*)arg) < SRSRAN_SUCCESS) {
+    srsran_sch_nr_free(q);
+    free(q);
+    return NULL;
+  }
+
+  return q;
+}
+
+static void sch_nr_cb_decoder_delete(void* ctx)
+{
+  srsran_sch_nr_free((srsran_sch_nr_t*)ctx);
+  free(ctx);
+}
+
+int srsran_sch_nr_cb_pool_init(srsran_sch_cb_pool_t* pool, uint32_t nof_workers, const srsran_sch_nr_args_t* args)
+{
+  if (pool == NULL || args == NULL) {
+    return SRSRAN_ERROR_INVALID_INPUTS;
+  }
+
+  // The arguments are only used while the workers are created
+  return srsran_sch_cb_pool_init_ctx(pool, nof_workers, sch_nr_cb_decoder_new, sch_nr_cb_decoder_delete, (void*)args);
+}
+
+void srsran_sch_nr_set_cb_pool(srsran_sch_nr_t* q, srsran_sch_cb_pool_t* pool)
+{
+  if (q != NULL) {
+    q->cb_pool = pool;
+  }
+}
+
 void srsran_sch_nr_free(srsran_sch_nr_t* q)
 {
   // Protect pointer
@@ -551,6 +594,98 @@ static inline int sch_nr_encode(srsran_sch_nr_t*        q,
   return SRSRAN_SUCCESS;
 }
 
+typedef struct {
+  srsran_sch_nr_t*               q;
+  const srsran_sch_tb_t*         tb;
+  const srsran_sch_nr_tb_info_t* cfg;
+  srsran_sch_cb_res_nr_t*        cb_res;
+  uint32_t                       nof_cb;                                 ///< Number of code blocks to decode
+  uint32_t                       cb_idx[SRSRAN_SCH_NR_MAX_NOF_CB_LDPC]; ///< Code block index r
+  uint32_t                       E[SRSRAN_SCH_NR_MAX_NOF_CB_LDPC];      ///< Rate matching output sequence length
+  int8_t*                        input[SRSRAN_SCH_NR_MAX_NOF_CB_LDPC];  ///< Rate matched code block LLRs
+  int                            ret[SRSRAN_SCH_NR_MAX_NOF_CB_LDPC];
+} sch_nr_decode_args_t;
+
+static void sch_nr_decode_cb(void* arg, uint32_t i, void* ctx)
+{
+  sch_nr_decode_args_t*          args = (sch_nr_decode_args_t*)arg;
+  const srsran_sch_tb_t*         tb   = args->tb;
+  const srsran_sch_nr_tb_info_t* cfg  = args->cfg;
+  uint32_t                       r    = args->cb_idx[i];
+  uint32_t                       E    = args->E[i];
+
+  // Workers of the code block pool use their own decoders, the calling thread uses the SCH object ones
+  srsran_sch_nr_t* q = (ctx != NULL) ? (srsran_sch_nr_t*)ctx : args->q;
+
+  struct timeval t[3] = {};
+  gettimeofday(&t[1], NULL);
+
+  args->ret[i] = SRSRAN_ERROR;
+
+  srsran_ldpc_decoder_t* decoder   = (cfg->bg == BG1) ? q->decoder_bg1[cfg->Z] : q->decoder_bg2[cfg->Z];
+  int8_t*                rm_buffer = (int8_t*)tb->softbuffer.tx->buffer_b[r];
+
+  // LDPC Rate matching
+  SCH_INFO_RX("RM CB %d: E=%d; F=%d; BG=%d; Z=%d; RV=%d; Qm=%d; Nref=%d;",
+              r,
+              E,
+              cfg->F,
+              cfg->bg == BG1 ? 1 : 2,
+              cfg->Z,
+              tb->rv,
+              cfg->Qm,
+              cfg->Nref);
+  int n_llr =
+      srsran_ldpc_rm_rx_c(&q->rx_rm, args->input[i], rm_buffer, E, cfg->F, cfg->bg, cfg->Z, tb->rv, tb->mod, cfg->Nref);
+  if (n_llr < SRSRAN_SUCCESS) {
+    ERROR("Error in LDPC rate mateching");
+    return;
+  }
+
+  // Select CB or TB early stop CRC
+  srsran_crc_t* crc = (cfg->L_tb == 16) ? &q->crc_tb_16 : &q->crc_tb_24;
+  if (cfg->L_cb) {
+    crc = &q->crc_cb;
+  }
+
+  // Decode. if CRC=KO, then ret=0
+  int ret = srsran_ldpc_decoder_decode_crc_c(decoder, rm_buffer, q->temp_cb, n_llr, crc);
+  if (ret < SRSRAN_SUCCESS) {
+    ERROR("Error decoding CB");
+    return;
+  }
+
+  // Compute number of iterations
+  uint32_t n_iter_cb = (ret == 0) ? decoder->max_nof_iter : (uint32_t)ret;
+
+  // Check if CB is all zeros
+  uint32_t cb_len = cfg->Kp - cfg->L_cb;
+
+  tb->softbuffer.rx->cb_crc[r] = (ret != 0);
+  SCH_INFO_RX("CB %d/%d iter=%d CRC=%s", r, cfg->C, n_iter_cb, tb->softbuffer.rx->cb_crc[r] ? "OK" : "KO");
+
+  // CB Debug trace
+  if (SRSRAN_DEBUG_ENABLED && get_srsran_verbose_level() >= SRSRAN_VERBOSE_DEBUG && !is_handler_registered()) {
+    DEBUG("CB %d/%d:", r, cfg->C);
+    srsran_vec_fprint_hex(stdout, q->temp_cb, cb_len);
+  }
+
+  // Pack only if CRC is match
+  if (tb->softbuffer.rx->cb_crc[r]) {
+    srsran_bit_pack_vector(q->temp_cb, tb->softbuffer.rx->data[r], cb_len);
+  }
+
+  gettimeofday(&t[2], NULL);
+  get_time_interval(t);
+
+  srsran_sch_cb_res_nr_t* cb_res = &args->cb_res[r];
+  cb_res->decoded                = true;
+  cb_res->nof_iter               = n_iter_cb;
+  cb_res->time_us                = (uint32_t)(t[0].tv_sec * 1000000 + t[0].tv_usec);
+
+  args->ret[i] = SRSRAN_SUCCESS;
+}
+
 static int sch_nr_decode(srsran_sch_nr_t*        q,
                          const srsran_sch_cfg_t* sch_cfg,
                          const srsran_sch_tb_t*  tb,
@@ -574,8 +709,7 @@ static int sch_nr_decode(srsran_sch_nr_t*        q,
     return SRSRAN_ERROR;
   }
 
-  int8_t*  input_ptr    = e_bits;
-  uint32_t nof_iter_sum = 0;
+  int8_t* input_ptr = e_bits;
 
   srsran_sch_nr_tb_info_t cfg = {};
   if (srsran_sch_nr_fill_tb_info(&q->carrier, sch_cfg, tb, &cfg) < SRSRAN_SUCCESS) {
@@ -603,24 +737,24 @@ static int sch_nr_decode(srsran_sch_nr_t*        q,
     return SRSRAN_ERROR;
   }
 
-  // Counter of code blocks that have matched CRC
-  uint32_t cb_ok = 0;
+  sch_nr_decode_args_t args = {};
+  args.q                    = q;
+  args.tb                   = tb;
+  args.cfg                  = &cfg;
+  args.cb_res               = res->cb;
 
-  // For each code block...
+  // Select the code blocks to decode and their input
   uint32_t j = 0;
   for (uint32_t r = 0; r < cfg.C; r++) {
-    bool    decoded   = tb->softbuffer.rx->cb_crc[r];
-    int8_t* rm_buffer = (int8_t*)tb->softbuffer.tx->buffer_b[r];
-    if (!rm_buffer) {
+    bool decoded = tb->softbuffer.rx->cb_crc[r];
+    if (!tb->softbuffer.tx->buffer_b[r]) {
       ERROR("Error: soft-buffer provided NULL buffer for cb_idx=%d", r);
       return SRSRAN_ERROR;
     }
+    SRSRAN_MEM_ZERO(&res->cb[r], srsran_sch_cb_res_nr_t, 1);
 
     // Skip CB if mask indicates no transmission of the CB
     if (!cfg.mask[r]) {
-      if (decoded) {
-        cb_ok++;
-      }
       SCH_INFO_RX("RM CB %d: Disabled, CRC %s ... Skipping", r, decoded ? "OK" : "KO");
       continue;
     }
@@ -629,69 +763,48 @@ static int sch_nr_decode(srsran_sch_nr_t*        q,
     uint32_t E = sch_nr_get_E(&cfg, j);
     j++;
 
-    // Skip CB if it has a matched CRC
+    // Skip CB if it has a matched CRC, its bits are still present in the input
     if (decoded) {
       SCH_INFO_RX("RM CB %d: CRC OK ... Skipping", r);
-      cb_ok++;
+      input_ptr += E;
       continue;
     }
 
-    // LDPC Rate matching
-    SCH_INFO_RX("RM CB %d: E=%d; F=%d; BG=%d; Z=%d; RV=%d; Qm=%d; Nref=%d;",
-                r,
-                E,
-                cfg.F,
-                cfg.bg == BG1 ? 1 : 2,
-                cfg.Z,
-                tb->rv,
-                cfg.Qm,
-                cfg.Nref);
-    int n_llr =
-        srsran_ldpc_rm_rx_c(&q->rx_rm, input_ptr, rm_buffer, E, cfg.F, cfg.bg, cfg.Z, tb->rv, tb->mod, cfg.Nref);
-    if (n_llr < SRSRAN_SUCCESS) {
-      ERROR("Error in LDPC rate mateching");
-      return SRSRAN_ERROR;
-    }
-
-    // Select CB or TB early stop CRC
-    srsran_crc_t* crc = (cfg.L_tb == 16) ? &q->crc_tb_16 : &q->crc_tb_24;
-    if (cfg.L_cb) {
-      crc = &q->crc_cb;
-    }
-
-    // Decode. if CRC=KO, then ret=0
-    int ret = srsran_ldpc_decoder_decode_crc_c(decoder, rm_buffer, q->temp_cb, n_llr, crc);
-    if (ret < SRSRAN_SUCCESS) {
-      ERROR("Error decoding CB");
-      return SRSRAN_ERROR;
-    }
-
-    // Compute number of iterations
-    uint32_t n_iter_cb = (ret == 0) ? decoder->max_nof_iter : (uint32_t)ret;
-    nof_iter_sum += n_iter_cb;
+    args.cb_idx[args.nof_cb] = r;
+    args.E[args.nof_cb]      = E;
+    args.input[args.nof_cb]  = input_ptr;
+    args.nof_cb++;
 
-    // Check if CB is all zeros
-    uint32_t cb_len = cfg.Kp - cfg.L_cb;
+    input_ptr += E;
+  }
 
-    tb->softbuffer.rx->cb_crc[r] = (ret != 0);
-    SCH_INFO_RX("CB %d/%d iter=%d CRC=%s", r, cfg.C, n_iter_cb, tb->softbuffer.rx->cb_crc[r] ? "OK" : "KO");
+  // Decode code blocks, in parallel if a pool is available
+  struct timeval t[3] = {};
+  gettimeofday(&t[1], NULL);
+  srsran_sch_cb_pool_run(q->cb_pool, sch_nr_decode_cb, &args, args.nof_cb);
+  gettimeofday(&t[2], NULL);
+  get_time_interval(t);
 
-    // CB Debug trace
-    if (SRSRAN_DEBUG_ENABLED && get_srsran_verbose_level() >= SRSRAN_VERBOSE_DEBUG && !is_handler_registered()) {
-      DEBUG("CB %d/%d:", r, cfg.C);
-      srsran_vec_fprint_hex(stdout, q->temp_cb, cb_len);
+  for (uint32_t i = 0; i < args.nof_cb; i++) {
+    if (args.ret[i] < SRSRAN_SUCCESS) {
+      return SRSRAN_ERROR;
     }
+  }
 
-    // Pack and count CRC OK only if CRC is match
-    if (tb->softbuffer.rx->cb_crc[r]) {
-      srsran_bit_pack_vector(q->temp_cb, tb->softbuffer.rx->data[r], cb_len);
+  // Counter of code blocks that have matched CRC
+  uint32_t cb_ok        = 0;
+  uint32_t nof_iter_sum = 0;
+  res->max_iter         = 0;
+  for (uint32_t r = 0; r < cfg.C; r++) {
+    res->cb[r].crc = tb->softbuffer.rx->cb_crc[r];
+    if (res->cb[r].crc) {
       cb_ok++;
     }
-
-    input_ptr += E;
+    nof_iter_sum += res->cb[r].nof_iter;
+    res->max_iter = SRSRAN_MAX(res->max_iter, res->cb[r].nof_iter);
   }
-  // Set average number of iterations
-  res->avg_iter = (float)nof_iter_sum / (float)cfg.C;
+  res->nof_cb  = cfg.C;
+  res->time_us = (uint32_t)(t[0].tv_sec * 1000000 + t[0].tv_usec);
 
   // Set average number of iterations
   if (cfg.C > 0) {
@@ -55,6 +55,7 @@ static char*       input_file                   = NULL;
 static int         M                            = 1;
 static bool        enable_256qam                = false;
 static bool        use_8_bit                    = false;
+static uint32_t    nof_tdec_threads             = 0;
 
 void usage(char* prog)
 {
@@ -76,6 +77,7 @@ void usage(char* prog)
   printf("\t-p pmi (multiplex only)  [Default %d]\n", pmi);
   printf("\t-w Swap Transport Blocks\n");
   printf("\t-j Enable PDSCH decoder coworker\n");
+  printf("\t-T Number of code block decoder threads [Default %d]\n", nof_tdec_threads);
   printf("\t-v [set srsran_verbose to debug, default none]\n");
   printf("\t-q Enable/Disable 256QAM modulation (default %s)\n", enable_256qam ? "enabled" : "disabled");
 }
@@ -83,7 +85,7 @@ void usage(char* prog)
 void parse_args(int argc, char** argv)
 {
   int opt;
-  while ((opt = getopt(argc, argv, "fmMcsbrtRFpnqawvXxj")) != -1) {
+  while ((opt = getopt(argc, argv, "fmMcsbrtRFpnqawvXxjT")) != -1) {
     switch (opt) {
       case 'f':
         input_file = argv[optind];
@@ -133,6 +135,9 @@ void parse_args(int argc, char** argv)
       case 'w':
         tb_cw_swap = true;
         break;
+      case 'T':
+        nof_tdec_threads = (uint32_t)strtol(argv[optind], NULL, 10);
+        break;
       case 'j':
         enable_coworker = true;
         break;
@@ -209,6 +214,7 @@ int main(int argc, char** argv)
   srsran_pdsch_res_t      pdsch_res[SRSRAN_MAX_CODEWORDS];
   srsran_random_t         random_gen = srsran_random_init(0x1234);
   srsran_crc_t            crc_tb;
+  srsran_sch_cb_pool_t    tdec_pool;
 
   /* Initialise to zeros */
   ZERO_OBJECT(softbuffers_tx);
@@ -230,6 +236,11 @@ int main(int argc, char** argv)
 
   parse_args(argc, argv);
 
+  if (srsran_sch_cb_pool_init(&tdec_pool, nof_tdec_threads)) {
+    ERROR("Error creating code block decoder pool");
+    exit(-1);
+  }
+
   if (tm == SRSRAN_TM1) {
     cell.nof_ports = 1;
     mcs[1]         = 0;
@@ -341,6 +352,7 @@ int main(int argc, char** argv)
 
   pdsch_rx.llr_is_8bit        = use_8_bit;
   pdsch_rx.dl_sch.llr_is_8bit = use_8_bit;
+  srsran_sch_set_cb_pool(&pdsch_rx.dl_sch, &tdec_pool);
 
   for (uint32_t i = 0; i < SRSRAN_MAX_CODEWORDS; i++) {
     softbuffers_rx[i] = calloc(sizeof(srsran_softbuffer_rx_t), 1);
@@ -506,11 +518,12 @@ int main(int argc, char** argv)
   }
   gettimeofday(&t[2], NULL);
   get_time_interval(t);
-  printf("DECODED %s in %.2f (PHY bitrate=%.2f Mbps. Processing bitrate=%.2f Mbps)\n",
+  printf("DECODED %s in %.2f (PHY bitrate=%.2f Mbps. Processing bitrate=%.2f Mbps. Decoder threads=%d)\n",
          r ? "Error" : "OK",
          (float)t[0].tv_usec / M,
          (float)(pdsch_cfg.grant.tb[0].tbs + pdsch_cfg.grant.tb[1].tbs) / 1000.0f,
-         (float)(pdsch_cfg.grant.tb[0].tbs + pdsch_cfg.grant.tb[1].tbs) * M / t[0].tv_usec);
+         (float)(pdsch_cfg.grant.tb[0].tbs + pdsch_cfg.grant.tb[1].tbs) * M / t[0].tv_usec,
+         nof_tdec_threads);
 
   /* If there is an error in PDSCH decode */
   if (r) {
@@ -564,6 +577,7 @@ quit:
   srsran_chest_dl_free(&chest);
   srsran_pdsch_free(&pdsch_tx);
   srsran_pdsch_free(&pdsch_rx);
+  srsran_sch_cb_pool_free(&tdec_pool);
   for (uint32_t i = 0; i < SRSRAN_MAX_CODEWORDS; i++) {
     srsran_softbuffer_tx_free(softbuffers_tx[i]);
     if (softbuffers_tx[i]) {
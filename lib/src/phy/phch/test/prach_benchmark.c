@@ -0,0 +1,286 @@
+/**
+ * Copyright 2013-2021 Software Radio Systems Limited
+ *
+ * This file is part of srsRAN.
+ *
+ * srsRAN is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsRAN is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+#include <complex.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+#include "srsran/srsran.h"
+
+#define MAX_THREADS 8
+#define MAX_DETECTIONS 165
+
+static uint32_t nof_prb         = 25;
+static int      zero_corr_zone  = -1; // sweep all
+static bool     high_speed_flag = false;
+static uint32_t nof_threads     = 1;
+static uint32_t nof_reps        = 100;
+
+static void usage(char* prog)
+{
+  printf("Usage: %s\n", prog);
+  printf("\t-n Uplink number of PRB [Default %d]\n", nof_prb);
+  printf("\t-z Zero correlation zone config, sets the number of roots [Default all]\n");
+  printf("\t-s Enable high speed flag (restricted set) [Default %s]\n", high_speed_flag ? "on" : "off");
+  printf("\t-t Number of threads sharing the roots of an occasion, up to %d [Default %d]\n", MAX_THREADS, nof_threads);
+  printf("\t-R Number of occasions per configuration [Default %d]\n", nof_reps);
+}
+
+static void parse_args(int argc, char** argv)
+{
+  int opt;
+  while ((opt = getopt(argc, argv, "nzstR")) != -1) {
+    switch (opt) {
+      case 'n':
+        nof_prb = (uint32_t)strtol(argv[optind], NULL, 10);
+        break;
+      case 'z':
+        zero_corr_zone = (int)strtol(argv[optind], NULL, 10);
+        break;
+      case 's':
+        high_speed_flag = !high_speed_flag;
+        break;
+      case 't':
+        if (strtol(argv[optind], NULL, 10) < 1) {
+          usage(argv[0]);
+          exit(-1);
+        }
+        nof_threads = SRSRAN_MIN((uint32_t)strtol(argv[optind], NULL, 10), MAX_THREADS);
+        break;
+      case 'R':
+        nof_reps = (uint32_t)strtol(argv[optind], NULL, 10);
+        break;
+      default:
+        usage(argv[0]);
+        exit(-1);
+    }
+  }
+}
+
+/// Detector object and results of one thread, which searches its share of the roots of every occasion
+typedef struct {
+  srsran_prach_t     prach;
+  const cf_t*        bins;
+  uint32_t           root_begin;
+  uint32_t           root_end;
+  uint32_t           indices[MAX_DETECTIONS];
+  float              offsets[MAX_DETECTIONS];
+  float              p2avg[MAX_DETECTIONS];
+  uint32_t           n_indices;
+  bool               quit;
+  pthread_t          thread;
+  pthread_barrier_t* start;
+  pthread_barrier_t* done;
+} share_t;
+
+static void detect_share(share_t* s)
+{
+  s->n_indices = 0;
+  srsran_prach_detect_roots(
+      &s->prach, s->bins, s->root_begin, s->root_end, s->indices, s->offsets, s->p2avg, &s->n_indices);
+}
+
+static void* share_thread(void* arg)
+{
+  share_t* s = (share_t*)arg;
+  while (true) {
+    pthread_barrier_wait(s->start);
+    if (s->quit) {
+      break;
+    }
+    detect_share(s);
+    pthread_barrier_wait(s->done);
+  }
+  return NULL;
+}
+
+static int init_share(share_t* s, srsran_prach_cfg_t* cfg)
+{
+  if (srsran_prach_init(&s->prach, srsran_symbol_sz(nof_prb))) {
+    return SRSRAN_ERROR;
+  }
+  if (srsran_prach_set_cfg(&s->prach, cfg, nof_prb)) {
+    ERROR("Error initiating PRACH object");
+    return SRSRAN_ERROR;
+  }
+  srsran_prach_set_detect_factor(&s->prach, 60);
+  return SRSRAN_SUCCESS;
+}
+
+/**
+ * Detects nof_reps occasions, each with a preamble buried in noise, with the roots split between nof_threads threads.
+ * Every occasion is checked against srsran_prach_detect_offset(). Prints the average detection time per occasion
+ */
+static int run_benchmark(uint32_t zczc, cf_t* signal)
+{
+  srsran_prach_cfg_t prach_cfg = {};
+  prach_cfg.config_idx         = 3;
+  prach_cfg.hs_flag            = high_speed_flag;
+  prach_cfg.zero_corr_zone     = zczc;
+  prach_cfg.freq_offset        = 2;
+
+  static share_t    shares[MAX_THREADS];
+  pthread_barrier_t start, done;
+  pthread_barrier_init(&start, NULL, nof_threads);
+  pthread_barrier_init(&done, NULL, nof_threads);
+  for (uint32_t i = 0; i < nof_threads; i++) {
+    if (init_share(&shares[i], &prach_cfg)) {
+      return SRSRAN_ERROR;
+    }
+    shares[i].quit  = false;
+    shares[i].start = &start;
+    shares[i].done  = &done;
+  }
+  srsran_prach_t* prach     = &shares[0].prach;
+  uint32_t        nof_roots = srsran_prach_nof_roots(prach);
+  for (uint32_t i = 0; i < nof_threads; i++) {
+    shares[i].bins       = prach->prach_bins;
+    shares[i].root_begin = i * nof_roots / nof_threads;
+    shares[i].root_end   = (i + 1) * nof_roots / nof_threads;
+    if (i > 0 && pthread_create(&shares[i].thread, NULL, share_thread, &shares[i])) {
+      ERROR("Error creating thread");
+      return SRSRAN_ERROR;
+    }
+  }
+
+  uint32_t sig_len  = prach->N_seq;
+  cf_t*    preamble = srsran_vec_cf_malloc(prach->N_cp + prach->N_seq);
+  if (preamble == NULL) {
+    return SRSRAN_ERROR;
+  }
+
+  int            ret         = SRSRAN_SUCCESS;
+  uint64_t       total_us    = 0;
+  uint32_t       nof_correct = 0;
+  struct timeval t[3]        = {};
+  for (uint32_t r = 0; r < nof_reps && ret == SRSRAN_SUCCESS; r++) {
+    uint32_t seq_index = r % 64;
+    srsran_prach_gen(prach, seq_index, prach_cfg.freq_offset, preamble);
+    for (uint32_t i = 0; i < sig_len; i++) {
+      signal[i] = preamble[prach->N_cp + i] + 0.1f * ((float)rand() / RAND_MAX - 0.5f) +
+                  0.1f * _Complex_I * ((float)rand() / RAND_MAX - 0.5f);
+    }
+
+    gettimeofday(&t[1], NULL);
+    if (srsran_prach_extract_bins(prach, prach_cfg.freq_offset, signal, sig_len)) {
+      ret = SRSRAN_ERROR;
+      break;
+    }
+    if (nof_threads > 1) {
+      pthread_barrier_wait(&start);
+    }
+    detect_share(&shares[0]);
+    if (nof_threads > 1) {
+      pthread_barrier_wait(&done);
+    }
+    gettimeofday(&t[2], NULL);
+    get_time_interval(t);
+    total_us += t[0].tv_usec + t[0].tv_sec * 1000000UL;
+
+    // Check the concatenation of all shares matches the detection of a single object
+    uint32_t indices[MAX_DETECTIONS];
+    float    offsets[MAX_DETECTIONS];
+    float    p2avg[MAX_DETECTIONS];
+    uint32_t n_indices = 0;
+    srsran_prach_detect_offset(prach, prach_cfg.freq_offset, signal, sig_len, indices, offsets, p2avg, &n_indices);
+    uint32_t n = 0;
+    for (uint32_t i = 0; i < nof_threads; i++) {
+      for (uint32_t j = 0; j < shares[i].n_indices; j++, n++) {
+        if (n >= n_indices || shares[i].indices[j] != indices[n] || shares[i].offsets[j] != offsets[n]) {
+          ERROR("Detection mismatch in root share %d", i);
+          ret = SRSRAN_ERROR;
+        }
+      }
+    }
+    if (n != n_indices) {
+      ERROR("Detected %d preambles, expected %d", n, n_indices);
+      ret = SRSRAN_ERROR;
+    }
+    // With restricted sets, the detector reports the window of the cyclic shift in the root, not the preamble index
+    if (high_speed_flag) {
+      nof_correct += (n_indices == 1) ? 1 : 0;
+    } else {
+      nof_correct += (n_indices > 0 && indices[0] == seq_index) ? 1 : 0;
+    }
+  }
+  if (ret == SRSRAN_SUCCESS && nof_correct != nof_reps) {
+    ERROR("Detected %d of %d transmitted preambles", nof_correct, nof_reps);
+    ret = SRSRAN_ERROR;
+  }
+
+  printf("%4d%7d%7d%9d%10d%20.1f\n",
+         zczc,
+         prach->N_cs,
+         nof_roots,
+         nof_threads,
+         nof_correct,
+         (float)total_us / SRSRAN_MAX(nof_reps, 1));
+
+  for (uint32_t i = 0; i < nof_threads; i++) {
+    if (i > 0) {
+      shares[i].quit = true;
+    }
+  }
+  if (nof_threads > 1) {
+    pthread_barrier_wait(&start);
+  }
+  for (uint32_t i = 0; i < nof_threads; i++) {
+    if (i > 0) {
+      pthread_join(shares[i].thread, NULL);
+    }
+    srsran_prach_free(&shares[i].prach);
+  }
+  pthread_barrier_destroy(&start);
+  pthread_barrier_destroy(&done);
+  free(preamble);
+  return ret;
+}
+
+int main(int argc, char** argv)
+{
+  parse_args(argc, argv);
+
+  cf_t* signal = srsran_vec_cf_malloc(SRSRAN_PRACH_MAX_LEN);
+  if (signal == NULL) {
+    return SRSRAN_ERROR;
+  }
+
+  printf("zczc   N_cs  roots  threads  detected  time/occasion [us]\n");
+  uint32_t max_zczc = high_speed_flag ? 15 : 16;
+  for (uint32_t zczc = 0; zczc < max_zczc; zczc++) {
+    if (zero_corr_zone >= 0 && zczc != zero_corr_zone) {
+      continue;
+    }
+    if (run_benchmark(zczc, signal)) {
+      free(signal);
+      printf("Failed\n");
+      exit(-1);
+    }
+  }
+
+  free(signal);
+  printf("Done\n");
+  exit(0);
+}
@@ -56,6 +56,7 @@ int          freq_hop      = -1;
 int          riv           = -1;
 uint32_t     mcs_idx       = 0;
 bool         enable_64_qam = false;
+uint32_t     nof_tdec_threads = 0;
 
 void usage(char* prog)
 {
@@ -84,6 +85,7 @@ void usage(char* prog)
   printf("\n\tOther parameters:\n");
   printf("\t\t-p enable_64qam [Default %s]\n", enable_64_qam ? "enabled" : "disabled");
   printf("\t\t-s number of subframes [Default %d]\n", subframe);
+  printf("\t\t-T number of code block decoder threads [Default %d]\n", nof_tdec_threads);
   printf("\t-v [set srsran_verbose to debug, default none]\n");
 }
 
@@ -139,7 +141,7 @@ void parse_extensive_param(char* param, char* arg)
 void parse_args(int argc, char** argv)
 {
   int opt;
-  while ((opt = getopt(argc, argv, "msLFrncpvf")) != -1) {
+  while ((opt = getopt(argc, argv, "msLFrncpvfT")) != -1) {
     switch (opt) {
       case 'm':
         mcs_idx = (uint32_t)strtol(argv[optind], NULL, 10);
@@ -165,6 +167,9 @@ void parse_args(int argc, char** argv)
       case 'c':
         cell.id = (uint32_t)strtol(argv[optind], NULL, 10);
         break;
+      case 'T':
+        nof_tdec_threads = (uint32_t)strtol(argv[optind], NULL, 10);
+        break;
       case 'p':
         parse_extensive_param(argv[optind], argv[optind + 1]);
         optind++;
@@ -194,6 +199,7 @@ int main(int argc, char** argv)
   srsran_softbuffer_tx_t softbuffer_tx;
   srsran_softbuffer_rx_t softbuffer_rx;
   srsran_crc_t           crc_tb;
+  srsran_sch_cb_pool_t   tdec_pool;
 
   ZERO_OBJECT(uci_data_tx);
   ZERO_OBJECT(crc_tb);
@@ -205,6 +211,11 @@ int main(int argc, char** argv)
 
   parse_args(argc, argv);
 
+  if (srsran_sch_cb_pool_init(&tdec_pool, nof_tdec_threads)) {
+    ERROR("Error creating code block decoder pool");
+    return ret;
+  }
+
   dci.freq_hop_fl = freq_hop;
   if (riv >= 0) {
     dci.type2_alloc.riv = (uint32_t)riv;
@@ -243,6 +254,7 @@ int main(int argc, char** argv)
     ERROR("Error creating PUSCH object");
     goto quit;
   }
+  srsran_sch_set_cb_pool(&pusch_rx.ul_sch, &tdec_pool);
 
   uint16_t rnti = 62;
   dci.rnti      = rnti;
@@ -281,8 +293,9 @@ int main(int argc, char** argv)
   srsran_chest_ul_res_set_identity(&chest_res);
 
   cfg.enable_64qam     = enable_64_qam;
-  uint64_t decode_us   = 0;
-  uint64_t decode_bits = 0;
+  uint64_t decode_us     = 0;
+  uint64_t decode_bits   = 0;
+  uint64_t decode_max_us = 0;
 
   for (int n = 0; n < subframe; n++) {
     ret = SRSRAN_SUCCESS;
@@ -396,13 +409,23 @@ int main(int argc, char** argv)
            (float)cfg.grant.tb.tbs / t[0].tv_usec);
     decode_us += t[0].tv_usec;
     decode_bits += cfg.grant.tb.tbs;
+    decode_max_us = SRSRAN_MAX(decode_max_us, (uint64_t)t[0].tv_usec);
   }
 
   printf("Decoded Rate: %f Mbps\n", (double)decode_bits / (double)decode_us);
+
+  srsran_cbsegm_t cb_segm = {};
+  srsran_cbsegm(&cb_segm, cfg.grant.tb.tbs);
+  printf("TB decode latency: avg=%.1f us, max=%d us (CBs per TB=%d, decoder threads=%d)\n",
+         (double)decode_us / SRSRAN_MAX(subframe, 1),
+         (int)decode_max_us,
+         cb_segm.C,
+         nof_tdec_threads);
 quit:
   srsran_chest_ul_res_free(&chest_res);
   srsran_pusch_free(&pusch_tx);
   srsran_pusch_free(&pusch_rx);
+  srsran_sch_cb_pool_free(&tdec_pool);
   srsran_softbuffer_tx_free(&softbuffer_tx);
   srsran_softbuffer_rx_free(&softbuffer_rx);
   srsran_random_free(random_h);
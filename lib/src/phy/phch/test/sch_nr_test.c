@@ -29,10 +29,11 @@
 
 static srsran_carrier_nr_t carrier = SRSRAN_DEFAULT_CARRIER_NR;
 
-static uint32_t            n_prb     = 0;  // Set to 0 for steering
-static uint32_t            mcs       = 30; // Set to 30 for steering
-static uint32_t            rv        = 4;  // Set to 30 for steering
-static srsran_sch_cfg_nr_t pdsch_cfg = {};
+static uint32_t            n_prb          = 0;  // Set to 0 for steering
+static uint32_t            mcs            = 30; // Set to 30 for steering
+static uint32_t            rv             = 4;  // Set to 30 for steering
+static uint32_t            nof_cb_workers = 0;
+static srsran_sch_cfg_nr_t pdsch_cfg      = {};
 
 static void usage(char* prog)
 {
@@ -44,13 +45,14 @@ static void usage(char* prog)
   printf("\t-T Provide MCS table (64qam, 256qam, 64qamLowSE) [Default %s]\n",
          srsran_mcs_table_to_str(pdsch_cfg.sch_cfg.mcs_table));
   printf("\t-L Provide number of layers [Default %d]\n", carrier.max_mimo_layers);
+  printf("\t-W Number of code block decoder threads [Default %d]\n", nof_cb_workers);
   printf("\t-v [set srsran_verbose to debug, default none]\n");
 }
 
 int parse_args(int argc, char** argv)
 {
   int opt;
-  while ((opt = getopt(argc, argv, "PpmTLvr")) != -1) {
+  while ((opt = getopt(argc, argv, "PpmTLWvr")) != -1) {
     switch (opt) {
       case 'P':
         carrier.nof_prb = (uint32_t)strtol(argv[optind], NULL, 10);
@@ -70,6 +72,9 @@ int parse_args(int argc, char** argv)
       case 'L':
         carrier.max_mimo_layers = (uint32_t)strtol(argv[optind], NULL, 10);
         break;
+      case 'W':
+        nof_cb_workers = (uint32_t)strtol(argv[optind], NULL, 10);
+        break;
       case 'v':
         increase_srsran_verbose_level();
         break;
@@ -86,8 +91,9 @@ int main(int argc, char** argv)
 {
   int             ret       = SRSRAN_ERROR;
   srsran_sch_nr_t sch_nr_tx = {};
-  srsran_sch_nr_t sch_nr_rx = {};
-  srsran_random_t rand_gen  = srsran_random_init(1234);
+  srsran_sch_nr_t      sch_nr_rx = {};
+  srsran_sch_cb_pool_t cb_pool   = {};
+  srsran_random_t      rand_gen  = srsran_random_init(1234);
 
   uint8_t* data_tx = srsran_vec_u8_malloc(1024 * 1024);
   uint8_t* encoded = srsran_vec_u8_malloc(1024 * 1024 * 8);
@@ -120,6 +126,12 @@ int main(int argc, char** argv)
     goto clean_exit;
   }
 
+  if (srsran_sch_nr_cb_pool_init(&cb_pool, nof_cb_workers, &args) < SRSRAN_SUCCESS) {
+    ERROR("Error initiating code block decoder pool");
+    goto clean_exit;
+  }
+  srsran_sch_nr_set_cb_pool(&sch_nr_rx, &cb_pool);
+
   if (srsran_sch_nr_set_carrier(&sch_nr_tx, &carrier)) {
     ERROR("Error setting SCH NR carrier");
     goto clean_exit;
@@ -227,6 +239,39 @@ int main(int argc, char** argv)
             srsran_vec_fprint_byte(stdout, data_rx, tb.tbs / 8);
             goto clean_exit;
           }
+
+          // Every code block is decoded and matches its CRC
+          uint32_t cb_time_us = 0;
+          for (uint32_t r = 0; r < res.nof_cb; r++) {
+            if (!res.cb[r].decoded || !res.cb[r].crc || res.cb[r].nof_iter == 0) {
+              ERROR("Invalid CB %d statistics; n_prb=%d; mcs=%d; TBS=%d;", r, n_prb, mcs, tb.tbs);
+              goto clean_exit;
+            }
+            cb_time_us += res.cb[r].time_us;
+          }
+          INFO("n_prb=%d; mcs=%d; nof_cb=%d; max_iter=%d; cb_time=%d us; tb_time=%d us;",
+               n_prb,
+               mcs,
+               res.nof_cb,
+               res.max_iter,
+               cb_time_us,
+               res.time_us);
+
+          // Code blocks that already matched the CRC are skipped in a new transmission
+          if (srsran_dlsch_nr_decode(&sch_nr_rx, &pdsch_cfg.sch_cfg, &tb, llr, &res) < SRSRAN_SUCCESS) {
+            ERROR("Error decoding");
+            goto clean_exit;
+          }
+          for (uint32_t r = 0; r < res.nof_cb; r++) {
+            if (res.cb[r].decoded || !res.cb[r].crc) {
+              ERROR("Invalid CB %d statistics after retransmission", r);
+              goto clean_exit;
+            }
+          }
+          if (!res.crc || memcmp(data_tx, data_rx, tb.tbs / 8) != 0) {
+            ERROR("Failed to match Tx/Rx data after retransmission; n_prb=%d; mcs=%d; TBS=%d;", n_prb, mcs, tb.tbs);
+            goto clean_exit;
+          }
         }
 
         INFO("n_prb=%d; mcs=%d; rv=%d TBS=%d; PASSED!\n", n_prb, mcs, rv, tb.tbs);
@@ -240,6 +285,7 @@ clean_exit:
   srsran_random_free(rand_gen);
   srsran_sch_nr_free(&sch_nr_tx);
   srsran_sch_nr_free(&sch_nr_rx);
+  srsran_sch_cb_pool_free(&cb_pool);
   if (data_tx) {
     free(data_tx);
   }
@@ -225,6 +225,41 @@ static rf_dev_t dev_zmq = {"zmq",
                            .srsran_rf_send_timed_multi = rf_zmq_send_timed_multi};
 #endif
 
+/* Define implementation for shared memory */
+#ifdef ENABLE_SHM
+
+#include "rf_shm_imp.h"
+
+static rf_dev_t dev_shm = {.name                             = "shm",
+                           .srsran_rf_devname                = rf_shm_devname,
+                           .srsran_rf_start_rx_stream        = rf_shm_start_rx_stream,
+                           .srsran_rf_stop_rx_stream         = rf_shm_stop_rx_stream,
+                           .srsran_rf_flush_buffer           = rf_shm_flush_buffer,
+                           .srsran_rf_has_rssi               = rf_shm_has_rssi,
+                           .srsran_rf_get_rssi               = rf_shm_get_rssi,
+                           .srsran_rf_suppress_stdout        = rf_shm_suppress_stdout,
+                           .srsran_rf_register_error_handler = rf_shm_register_error_handler,
+                           .srsran_rf_open                   = rf_shm_open,
+                           .srsran_rf_open_multi             = rf_shm_open_multi,
+                           .srsran_rf_close                  = rf_shm_close,
+                           .srsran_rf_set_rx_srate           = rf_shm_set_rx_srate,
+                           .srsran_rf_set_rx_gain            = rf_shm_set_rx_gain,
+                           .srsran_rf_set_rx_gain_ch         = rf_shm_set_rx_gain_ch,
+                           .srsran_rf_set_tx_gain            = rf_shm_set_tx_gain,
+                           .srsran_rf_set_tx_gain_ch         = rf_shm_set_tx_gain_ch,
+                           .srsran_rf_get_rx_gain            = rf_shm_get_rx_gain,
+                           .srsran_rf_get_tx_gain            = rf_shm_get_tx_gain,
+                           .srsran_rf_get_info               = rf_shm_get_info,
+                           .srsran_rf_set_rx_freq            = rf_shm_set_rx_freq,
+                           .srsran_rf_set_tx_srate           = rf_shm_set_tx_srate,
+                           .srsran_rf_set_tx_freq            = rf_shm_set_tx_freq,
+                           .srsran_rf_get_time               = rf_shm_get_time,
+                           .srsran_rf_recv_with_time         = rf_shm_recv_with_time,
+                           .srsran_rf_recv_with_time_multi   = rf_shm_recv_with_time_multi,
+                           .srsran_rf_send_timed             = rf_shm_send_timed,
+                           .srsran_rf_send_timed_multi       = rf_shm_send_timed_multi};
+#endif
+
 /* Define implementation for Sidekiq */
 #ifdef ENABLE_SIDEKIQ
 
@@ -290,6 +325,9 @@ static rf_dev_t* available_devices[] = {
 #ifdef ENABLE_ZEROMQ
     &dev_zmq,
 #endif
+#ifdef ENABLE_SHM
+    &dev_shm,
+#endif
 #ifdef ENABLE_SIDEKIQ
     &dev_skiq,
 #endif
@@ -0,0 +1,1042 @@
+/**
+ * Copyright 2013-2021 Software Radio Systems Limited
+ *
+ * This file is part of srsRAN.
+ *
+ * srsRAN is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsRAN is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+/*
+ * Shared memory no-RF module for processes running on the same host.
+ *
+ * Every Tx port creates a POSIX shared memory object holding a single-producer/single-consumer ring of base-band
+ * samples, and the Rx port of the peer maps the same object. The ring carries a continuous stream at base_srate, so
+ * the position of a sample in the stream is its timestamp. Producer and consumer only exchange their positions through
+ * atomic counters: samples are written once into the ring and read once into the caller buffer, without any system
+ * call while the ring is neither full nor empty.
+ *
+ * As in the ZMQ module, the Tx stream is padded with zeros up to the requested Tx time, and up to the current Rx time
+ * before receiving, so two processes that receive each other's samples run in lockstep.
+ */
+
+#include "rf_shm_imp.h"
+#include "rf_helper.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <math.h>
+#include <signal.h>
+#include <srsran/phy/common/phy_common.h>
+#include <srsran/phy/common/timestamp.h>
+#include <srsran/phy/utils/vector.h>
+#include <stdlib.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#define SHM_RING_MAGIC (0x53484d52) // "SHMR"
+#define SHM_RING_DEFAULT_SIZE (1U << 20)
+#define SHM_BASERATE_DEFAULT_HZ (23040000)
+#define SHM_TIMEOUT_MS (2000)
+#define SHM_SPIN_COUNT (1000)
+#define SHM_SLEEP_US (20)
+#define SHM_MAX_GAIN_DB (30.0f)
+#define SHM_MIN_GAIN_DB (0.0f)
+#define SHM_CACHE_LINE (64)
+
+/*
+ * Ring header at the start of the shared memory object, followed by the samples. Each counter is written by a single
+ * side and lives in its own cache line.
+ */
+typedef struct {
+  uint32_t magic;       // set by the producer once the ring is initialised
+  uint32_t nof_samples; // ring capacity, power of two
+  uint32_t base_srate;
+  int32_t  producer_pid;
+  uint8_t  reserved0[SHM_CACHE_LINE - 16];
+  uint64_t write_ts; // number of samples written, owned by the producer
+  uint8_t  reserved1[SHM_CACHE_LINE - 8];
+  uint64_t read_ts;      // number of samples read, owned by the consumer
+  int32_t  consumer_pid; // 0 if no consumer is attached
+  uint32_t detached;     // set once the consumer has left, the producer stops waiting for it
+  uint8_t  reserved2[SHM_CACHE_LINE - 16];
+} rf_shm_ring_hdr_t;
+
+typedef struct {
+  char               name[RF_PARAM_LEN];
+  uint32_t           frequency_mhz;
+  uint32_t           trx_timeout_ms;
+  bool               fail_on_disconnect;
+  bool               log_trx_timeout;
+  int                fd;
+  ino_t              inode;
+  size_t             map_len;
+  rf_shm_ring_hdr_t* hdr;
+  cf_t*              samples;
+  uint32_t           mask;
+  pthread_mutex_t    mutex; // Tx only, serialises the Tx thread and the Tx alignment done by the Rx thread
+} rf_shm_port_t;
+
+typedef struct {
+  // Common attributes
+  char*            devname;
+  srsran_rf_info_t info;
+  uint32_t         nof_channels;
+
+  // RF State
+  uint32_t srate; // radio rate configured by upper layers
+  uint32_t base_srate;
+  uint32_t decim_factor; // decimation factor between base_srate used on transport on radio's rate
+  uint32_t ring_size;
+  double   rx_gain;
+  double   tx_gain;
+  uint32_t tx_freq_mhz[SRSRAN_MAX_CHANNELS];
+  uint32_t rx_freq_mhz[SRSRAN_MAX_CHANNELS];
+  bool     tx_off;
+  bool     rx_off;
+  char     id[RF_PARAM_LEN];
+
+  rf_shm_port_t transmitter[SRSRAN_MAX_CHANNELS];
+  rf_shm_port_t receiver[SRSRAN_MAX_CHANNELS];
+
+  // Rx timestamp
+  uint64_t next_rx_ts;
+
+  pthread_mutex_t tx_config_mutex;
+  pthread_mutex_t rx_config_mutex;
+  pthread_mutex_t decim_mutex;
+  pthread_mutex_t rx_gain_mutex;
+} rf_shm_handler_t;
+
+static void update_rates(rf_shm_handler_t* handler, double srate);
+
+/*
+ * Static Atributes
+ */
+const char shm_devname[4] = "shm";
+
+/*
+ * Static methods
+ */
+
+typedef struct {
+  uint32_t        nof_spins;
+  struct timespec start;
+} shm_wait_t;
+
+/// Waits for the other end of the ring. Returns true every time timeout_ms elapse without progress
+static bool shm_wait(shm_wait_t* w, uint32_t timeout_ms)
+{
+  // Busy wait first, the other end is usually just about to publish its position
+  if (w->nof_spins < SHM_SPIN_COUNT) {
+    if (w->nof_spins++ == 0) {
+      clock_gettime(CLOCK_MONOTONIC, &w->start);
+    }
+    return false;
+  }
+
+  usleep(SHM_SLEEP_US);
+
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  int64_t elapsed_ms = (now.tv_sec - w->start.tv_sec) * 1000 + (now.tv_nsec - w->start.tv_nsec) / 1000000;
+  if (elapsed_ms >= (int64_t)timeout_ms) {
+    w->start = now;
+    return true;
+  }
+  return false;
+}
+
+static bool shm_pid_alive(int32_t pid)
+{
+  return pid > 0 && (kill(pid, 0) == 0 || errno != ESRCH);
+}
+
+static uint32_t shm_next_pow2(uint32_t n)
+{
+  uint32_t ret = 1;
+  while (ret < n) {
+    ret <<= 1;
+  }
+  return ret;
+}
+
+static bool shm_port_enabled(rf_shm_port_t* q)
+{
+  return q->name[0] != '\0';
+}
+
+static bool shm_port_match_freq(rf_shm_port_t* q, uint32_t freq_mhz)
+{
+  return shm_port_enabled(q) && (q->frequency_mhz == 0 || q->frequency_mhz == freq_mhz);
+}
+
+static int shm_port_map(rf_shm_port_t* q, size_t len)
+{
+  void* ptr = mmap(NULL, len, PROT_READ | PROT_WRITE, MAP_SHARED, q->fd, 0);
+  if (ptr == MAP_FAILED) {
+    perror("mmap");
+    return SRSRAN_ERROR;
+  }
+  q->map_len = len;
+  q->hdr     = (rf_shm_ring_hdr_t*)ptr;
+  q->samples = (cf_t*)((uint8_t*)ptr + sizeof(rf_shm_ring_hdr_t));
+  return SRSRAN_SUCCESS;
+}
+
+static void shm_port_unmap(rf_shm_port_t* q)
+{
+  if (q->hdr) {
+    munmap(q->hdr, q->map_len);
+    q->hdr     = NULL;
+    q->samples = NULL;
+  }
+  if (q->fd >= 0) {
+    close(q->fd);
+    q->fd = -1;
+  }
+}
+
+/// Creates the ring of a Tx port, replacing any object left behind by a previous producer
+static int shm_tx_open(rf_shm_port_t* q, uint32_t nof_samples, uint32_t base_srate)
+{
+  shm_unlink(q->name);
+  q->fd = shm_open(q->name, O_CREAT | O_EXCL | O_RDWR, 0666);
+  if (q->fd < 0) {
+    fprintf(stderr, "[shm] Error: creating shared memory object %s: %s\n", q->name, strerror(errno));
+    return SRSRAN_ERROR;
+  }
+
+  size_t      len = sizeof(rf_shm_ring_hdr_t) + (size_t)nof_samples * sizeof(cf_t);
+  struct stat st  = {};
+  if (ftruncate(q->fd, len) < 0 || fstat(q->fd, &st) < 0 || shm_port_map(q, len) != SRSRAN_SUCCESS) {
+    fprintf(stderr, "[shm] Error: allocating %zd B for %s: %s\n", len, q->name, strerror(errno));
+    shm_port_unmap(q);
+    shm_unlink(q->name);
+    return SRSRAN_ERROR;
+  }
+  q->inode             = st.st_ino;
+  q->mask              = nof_samples - 1;
+  q->hdr->nof_samples  = nof_samples;
+  q->hdr->base_srate   = base_srate;
+  q->hdr->producer_pid = getpid();
+  __atomic_store_n(&q->hdr->magic, SHM_RING_MAGIC, __ATOMIC_RELEASE);
+
+  if (pthread_mutex_init(&q->mutex, NULL)) {
+    perror("Mutex init");
+  }
+  return SRSRAN_SUCCESS;
+}
+
+static void shm_tx_close(rf_shm_port_t* q)
+{
+  if (q->hdr == NULL) {
+    return;
+  }
+  __atomic_store_n(&q->hdr->producer_pid, 0, __ATOMIC_RELEASE);
+  shm_port_unmap(q);
+
+  // Remove the object unless another producer has already replaced it
+  int fd = shm_open(q->name, O_RDONLY, 0);
+  if (fd >= 0) {
+    struct stat st = {};
+    if (fstat(fd, &st) == 0 && st.st_ino == q->inode) {
+      shm_unlink(q->name);
+    }
+    close(fd);
+  }
+  pthread_mutex_destroy(&q->mutex);
+}
+
+/// Maps the ring of an Rx port. Returns SRSRAN_ERROR if the producer has not created it yet
+static int shm_rx_attach(rf_shm_port_t* q, uint32_t base_srate)
+{
+  q->fd = shm_open(q->name, O_RDWR, 0);
+  if (q->fd < 0) {
+    return SRSRAN_ERROR;
+  }
+
+  struct stat st = {};
+  if (fstat(q->fd, &st) < 0 || (size_t)st.st_size < sizeof(rf_shm_ring_hdr_t) ||
+      shm_port_map(q, st.st_size) != SRSRAN_SUCCESS) {
+    shm_port_unmap(q);
+    return SRSRAN_ERROR;
+  }
+  q->inode = st.st_ino;
+
+  // The producer may still be initialising the ring
+  if (__atomic_load_n(&q->hdr->magic, __ATOMIC_ACQUIRE) != SHM_RING_MAGIC) {
+    shm_port_unmap(q);
+    return SRSRAN_ERROR;
+  }
+
+  uint32_t nof_samples = q->hdr->nof_samples;
+  if (nof_samples == 0 || (nof_samples & (nof_samples - 1)) != 0 ||
+      sizeof(rf_shm_ring_hdr_t) + (size_t)nof_samples * sizeof(cf_t) > q->map_len) {
+    fprintf(stderr, "[shm] Error: invalid ring in %s\n", q->name);
+    shm_port_unmap(q);
+    return SRSRAN_ERROR_INVALID_INPUTS;
+  }
+  if (q->hdr->base_srate != base_srate) {
+    fprintf(stderr,
+            "[shm] Error: %s carries samples at %.2f MHz but base_srate is %.2f MHz\n",
+            q->name,
+            q->hdr->base_srate / 1e6,
+            base_srate / 1e6);
+    shm_port_unmap(q);
+    return SRSRAN_ERROR_INVALID_INPUTS;
+  }
+  q->mask = nof_samples - 1;
+
+  // Claim the consumer side, taking over from a consumer that died without detaching
+  int32_t* consumer_pid = &q->hdr->consumer_pid;
+  int32_t  consumer     = __atomic_load_n(consumer_pid, __ATOMIC_ACQUIRE);
+  if ((consumer != 0 && shm_pid_alive(consumer)) ||
+      !__atomic_compare_exchange_n(consumer_pid, &consumer, getpid(), false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+    fprintf(stderr, "[shm] Error: %s is already being received by process %d\n", q->name, consumer);
+    shm_port_unmap(q);
+    return SRSRAN_ERROR_INVALID_INPUTS;
+  }
+
+  // After a previous consumer, resume from the current producer position. The producer does not overwrite unread
+  // samples once it sees the flag cleared, and anything it writes before lies after the position loaded here
+  if (__atomic_load_n(&q->hdr->detached, __ATOMIC_SEQ_CST)) {
+    __atomic_store_n(&q->hdr->detached, 0, __ATOMIC_SEQ_CST);
+    __atomic_store_n(&q->hdr->read_ts, __atomic_load_n(&q->hdr->write_ts, __ATOMIC_SEQ_CST), __ATOMIC_SEQ_CST);
+  }
+
+  printf("[shm] Attached to %s (%d samples)\n", q->name, nof_samples);
+  return SRSRAN_SUCCESS;
+}
+
+static void shm_rx_detach(rf_shm_port_t* q)
+{
+  if (q->hdr) {
+    __atomic_store_n(&q->hdr->detached, 1, __ATOMIC_SEQ_CST);
+    __atomic_store_n(&q->hdr->consumer_pid, 0, __ATOMIC_SEQ_CST);
+  }
+  shm_port_unmap(q);
+}
+
+/// Returns true if the object behind the port name is no longer the mapped ring, or its producer is gone
+static bool shm_rx_is_stale(rf_shm_port_t* q)
+{
+  if (!shm_pid_alive(__atomic_load_n(&q->hdr->producer_pid, __ATOMIC_ACQUIRE))) {
+    return true;
+  }
+  int fd = shm_open(q->name, O_RDONLY, 0);
+  if (fd < 0) {
+    return true;
+  }
+  struct stat st    = {};
+  bool        stale = fstat(fd, &st) < 0 || st.st_ino != q->inode;
+  close(fd);
+  return stale;
+}
+
+/// Writes nsamples at the producer position, holding each sample interp times. Zeros are written if buffer is NULL
+static int shm_tx_write(rf_shm_port_t* q, const cf_t* buffer, uint32_t nsamples, uint32_t interp)
+{
+  rf_shm_ring_hdr_t* hdr   = q->hdr;
+  uint64_t           w     = hdr->write_ts;
+  uint32_t           total = nsamples * interp;
+  uint32_t           count = 0;
+  shm_wait_t         wait  = {};
+
+  while (count < total) {
+    // Like the ZMQ transmitter, wait for the peer when it does not keep up or has not connected yet. A consumer that
+    // is attaching may not have published its position yet, hence the bound on the used space
+    uint64_t used  = SRSRAN_MIN(w - __atomic_load_n(&hdr->read_ts, __ATOMIC_ACQUIRE), (uint64_t)q->mask + 1);
+    uint32_t space = q->mask + 1 - (uint32_t)used;
+    if (space == 0 && __atomic_load_n(&hdr->detached, __ATOMIC_SEQ_CST)) {
+      // The consumer has left, overwrite the oldest samples rather than blocking until another one attaches
+      space = q->mask + 1;
+    }
+    if (space == 0) {
+      if (shm_wait(&wait, q->trx_timeout_ms)) {
+        if (q->log_trx_timeout) {
+          fprintf(stderr, "[shm] Error: timeout transmitting samples to %s after %dms\n", q->name, q->trx_timeout_ms);
+        }
+        int32_t pid = __atomic_load_n(&hdr->consumer_pid, __ATOMIC_ACQUIRE);
+        if (pid != 0 && !shm_pid_alive(pid)) {
+          __atomic_store_n(&hdr->detached, 1, __ATOMIC_SEQ_CST);
+        }
+      }
+      continue;
+    }
+    wait.nof_spins = 0;
+
+    uint32_t n   = SRSRAN_MIN(space, total - count);
+    uint32_t pos = (uint32_t)(w & q->mask);
+    if (buffer == NULL) {
+      uint32_t n1 = SRSRAN_MIN(n, q->mask + 1 - pos);
+      srsran_vec_cf_zero(&q->samples[pos], n1);
+      srsran_vec_cf_zero(q->samples, n - n1);
+    } else if (interp == 1) {
+      uint32_t n1 = SRSRAN_MIN(n, q->mask + 1 - pos);
+      srsran_vec_cf_copy(&q->samples[pos], &buffer[count], n1);
+      srsran_vec_cf_copy(q->samples, &buffer[count + n1], n - n1);
+    } else {
+      // Zero order hold
+      for (uint32_t i = 0; i < n; i++) {
+        q->samples[(pos + i) & q->mask] = buffer[(count + i) / interp];
+      }
+    }
+
+    w += n;
+    count += n;
+    __atomic_store_n(&hdr->write_ts, w, __ATOMIC_RELEASE);
+  }
+
+  return (int)nsamples;
+}
+
+/// Pads the Tx stream with zeros up to ts. Returns the number of padded samples, negative if ts is in the past
+static int shm_tx_align(rf_shm_port_t* q, uint64_t ts)
+{
+  int64_t nsamples = (int64_t)ts - (int64_t)q->hdr->write_ts;
+  if (nsamples > 0) {
+    shm_tx_write(q, NULL, (uint32_t)nsamples, 1);
+  }
+  return (int)nsamples;
+}
+
+/// Reads nsamples * decim samples from the consumer position. Samples are dropped if buffer is NULL
+static int shm_rx_read(rf_shm_port_t* q, cf_t* buffer, uint32_t nsamples, uint32_t decim, uint32_t base_srate)
+{
+  uint32_t   total = nsamples * decim;
+  shm_wait_t wait  = {};
+
+  // Wait for the producer to create the ring
+  while (q->hdr == NULL) {
+    int ret = shm_rx_attach(q, base_srate);
+    if (ret == SRSRAN_ERROR_INVALID_INPUTS) {
+      return SRSRAN_ERROR;
+    }
+    if (ret != SRSRAN_SUCCESS && shm_wait(&wait, q->trx_timeout_ms)) {
+      if (q->log_trx_timeout) {
+        fprintf(stderr, "[shm] Error: timeout waiting for %s after %dms\n", q->name, q->trx_timeout_ms);
+      }
+      if (q->fail_on_disconnect) {
+        return SRSRAN_ERROR_TIMEOUT;
+      }
+    }
+  }
+
+  if (total > q->mask + 1) {
+    fprintf(stderr, "[shm] Error: trying to receive %d samples but %s holds only %d\n", total, q->name, q->mask + 1);
+    return SRSRAN_ERROR;
+  }
+
+  // Wait for the whole chunk, it is needed anyway before returning
+  rf_shm_ring_hdr_t* hdr = q->hdr;
+  uint64_t           r   = hdr->read_ts;
+  wait.nof_spins         = 0;
+  while (__atomic_load_n(&hdr->write_ts, __ATOMIC_ACQUIRE) - r < total) {
+    if (shm_wait(&wait, q->trx_timeout_ms)) {
+      if (q->log_trx_timeout) {
+        fprintf(stderr, "[shm] Error: timeout receiving samples from %s after %dms\n", q->name, q->trx_timeout_ms);
+      }
+      if (q->fail_on_disconnect) {
+        return SRSRAN_ERROR_TIMEOUT;
+      }
+      // The producer has restarted, follow the new ring
+      if (shm_rx_is_stale(q)) {
+        shm_rx_detach(q);
+        return shm_rx_read(q, buffer, nsamples, decim, base_srate);
+      }
+    }
+  }
+
+  uint32_t pos = (uint32_t)(r & q->mask);
+  if (buffer == NULL) {
+    // Drop samples
+  } else if (decim == 1) {
+    uint32_t n1 = SRSRAN_MIN(total, q->mask + 1 - pos);
+    srsran_vec_cf_copy(buffer, &q->samples[pos], n1);
+    srsran_vec_cf_copy(&buffer[n1], q->samples, total - n1);
+  } else {
+    // Same decimation as the ZMQ module, so that signal levels do not depend on the transport
+    for (uint32_t i = 0, n = 0; i < nsamples; i++) {
+      cf_t avg = 0.0f;
+      for (uint32_t j = 0; j < decim; j++, n++) {
+        avg += q->samples[(pos + n) & q->mask];
+      }
+      buffer[i] = avg;
+    }
+  }
+  __atomic_store_n(&hdr->read_ts, r + total, __ATOMIC_RELEASE);
+
+  return (int)nsamples;
+}
+
+/*
+ * Public methods
+ */
+
+void rf_shm_suppress_stdout(void* h)
+{
+  // do nothing
+}
+
+void rf_shm_register_error_handler(void* h, srsran_rf_error_handler_t new_handler, void* arg)
+{
+  // do nothing
+}
+
+const char* rf_shm_devname(void* h)
+{
+  return shm_devname;
+}
+
+int rf_shm_start_rx_stream(void* h, bool now)
+{
+  return SRSRAN_SUCCESS;
+}
+
+int rf_shm_stop_rx_stream(void* h)
+{
+  return SRSRAN_SUCCESS;
+}
+
+void rf_shm_flush_buffer(void* h)
+{
+  // do nothing
+}
+
+bool rf_shm_has_rssi(void* h)
+{
+  return false;
+}
+
+float rf_shm_get_rssi(void* h)
+{
+  return 0.0;
+}
+
+int rf_shm_open(char* args, void** h)
+{
+  return rf_shm_open_multi(args, h, 1);
+}
+
+int rf_shm_open_multi(char* args, void** h, uint32_t nof_channels)
+{
+  int ret = SRSRAN_ERROR;
+  if (h && nof_channels <= SRSRAN_MAX_CHANNELS) {
+    *h = NULL;
+
+    rf_shm_handler_t* handler = (rf_shm_handler_t*)malloc(sizeof(rf_shm_handler_t));
+    if (!handler) {
+      perror("malloc");
+      return SRSRAN_ERROR;
+    }
+    bzero(handler, sizeof(rf_shm_handler_t));
+    *h                        = handler;
+    handler->base_srate       = SHM_BASERATE_DEFAULT_HZ; // Sample rate for 100 PRB cell
+    handler->ring_size        = SHM_RING_DEFAULT_SIZE;
+    handler->info.max_rx_gain = SHM_MAX_GAIN_DB;
+    handler->info.min_rx_gain = SHM_MIN_GAIN_DB;
+    handler->info.max_tx_gain = SHM_MAX_GAIN_DB;
+    handler->info.min_tx_gain = SHM_MIN_GAIN_DB;
+    handler->nof_channels     = nof_channels;
+    handler->tx_off           = true;
+    handler->rx_off           = true;
+    strcpy(handler->id, "shm\0");
+    for (uint32_t i = 0; i < SRSRAN_MAX_CHANNELS; i++) {
+      handler->transmitter[i].fd = -1;
+      handler->receiver[i].fd    = -1;
+    }
+
+    if (pthread_mutex_init(&handler->tx_config_mutex, NULL)) {
+      perror("Mutex init");
+    }
+    if (pthread_mutex_init(&handler->rx_config_mutex, NULL)) {
+      perror("Mutex init");
+    }
+    if (pthread_mutex_init(&handler->decim_mutex, NULL)) {
+      perror("Mutex init");
+    }
+    if (pthread_mutex_init(&handler->rx_gain_mutex, NULL)) {
+      perror("Mutex init");
+    }
+
+    // parse args
+    if (args && strlen(args)) {
+      // base_srate
+      parse_uint32(args, "base_srate", -1, &handler->base_srate);
+
+      // id
+      parse_string(args, "id", -1, handler->id);
+
+      // ring_size
+      parse_uint32(args, "ring_size", -1, &handler->ring_size);
+      handler->ring_size = shm_next_pow2(SRSRAN_MAX(handler->ring_size, 1));
+    } else {
+      fprintf(stderr,
+              "[shm] Error: No device 'args' option has been set. Please make sure to set this option to be able to "
+              "use the shared memory no-RF module\n");
+      goto clean_exit;
+    }
+
+    update_rates(handler, 1.92e6);
+
+    for (uint32_t i = 0; i < handler->nof_channels; i++) {
+      rf_shm_port_t* tx = &handler->transmitter[i];
+      rf_shm_port_t* rx = &handler->receiver[i];
+
+      // tx_port, rx_port
+      parse_string(args, "tx_port", i, tx->name);
+      parse_string(args, "rx_port", i, rx->name);
+
+      // tx_freq, rx_freq
+      double tx_freq = 0.0f;
+      parse_double(args, "tx_freq", i, &tx_freq);
+      tx->frequency_mhz = (uint32_t)(tx_freq / 1e6);
+      double rx_freq    = 0.0f;
+      parse_double(args, "rx_freq", i, &rx_freq);
+      rx->frequency_mhz = (uint32_t)(rx_freq / 1e6);
+
+      // fail_on_disconnect
+      char tmp[RF_PARAM_LEN] = {};
+      parse_string(args, "fail_on_disconnect", i, tmp);
+      if (strncmp(tmp, "true", RF_PARAM_LEN) == 0 || strncmp(tmp, "yes", RF_PARAM_LEN) == 0) {
+        rx->fail_on_disconnect = true;
+      }
+
+      // trx_timeout_ms
+      rx->trx_timeout_ms = SHM_TIMEOUT_MS;
+      parse_uint32(args, "trx_timeout_ms", i, &rx->trx_timeout_ms);
+      tx->trx_timeout_ms = rx->trx_timeout_ms;
+
+      // log_trx_timeout
+      char tmp2[RF_PARAM_LEN] = {};
+      parse_string(args, "log_trx_timeout", i, tmp2);
+      if (strncmp(tmp2, "true", RF_PARAM_LEN) == 0 || strncmp(tmp2, "yes", RF_PARAM_LEN) == 0) {
+        rx->log_trx_timeout = true;
+        tx->log_trx_timeout = true;
+      }
+
+      // initialize transmitter
+      if (shm_port_enabled(tx)) {
+        if (shm_tx_open(tx, handler->ring_size, handler->base_srate) != SRSRAN_SUCCESS) {
+          fprintf(stderr, "[shm] Error: opening transmitter\n");
+          goto clean_exit;
+        }
+        handler->tx_off = false;
+      } else {
+        fprintf(stdout, "[shm] %s Tx port not specified. Disabling transmitter.\n", handler->id);
+      }
+
+      // The receiver is attached on the first reception, once the peer has created its ring
+      if (shm_port_enabled(rx)) {
+        handler->rx_off = false;
+      } else {
+        fprintf(stdout, "[shm] %s Rx port not specified. Disabling receiver.\n", handler->id);
+      }
+
+      if (!shm_port_enabled(tx) && !shm_port_enabled(rx)) {
+        fprintf(stderr, "[shm] Error: Neither Tx port nor Rx port specified.\n");
+        goto clean_exit;
+      }
+    }
+
+    ret = SRSRAN_SUCCESS;
+
+  clean_exit:
+    if (ret) {
+      rf_shm_close(handler);
+    }
+  }
+  return ret;
+}
+
+int rf_shm_close(void* h)
+{
+  rf_shm_handler_t* handler = (rf_shm_handler_t*)h;
+
+  for (uint32_t i = 0; i < handler->nof_channels; i++) {
+    shm_tx_close(&handler->transmitter[i]);
+    shm_rx_detach(&handler->receiver[i]);
+  }
+
+  pthread_mutex_destroy(&handler->tx_config_mutex);
+  pthread_mutex_destroy(&handler->rx_config_mutex);
+  pthread_mutex_destroy(&handler->decim_mutex);
+  pthread_mutex_destroy(&handler->rx_gain_mutex);
+
+  // Free all
+  free(handler);
+
+  return SRSRAN_SUCCESS;
+}
+
+static void update_rates(rf_shm_handler_t* handler, double srate)
+{
+  pthread_mutex_lock(&handler->decim_mutex);
+  // Decimation must be full integer
+  if (((uint64_t)handler->base_srate % (uint64_t)srate) == 0) {
+    handler->srate        = (uint32_t)srate;
+    handler->decim_factor = handler->base_srate / handler->srate;
+  } else {
+    fprintf(stderr,
+            "Error: couldn't update sample rate. %.2f is not divisible by %.2f\n",
+            srate / 1e6,
+            handler->base_srate / 1e6);
+  }
+  printf("Current sample rate is %.2f MHz with a base rate of %.2f MHz (x%d decimation)\n",
+         handler->srate / 1e6,
+         handler->base_srate / 1e6,
+         handler->decim_factor);
+  pthread_mutex_unlock(&handler->decim_mutex);
+}
+
+double rf_shm_set_rx_srate(void* h, double srate)
+{
+  double ret = 0.0;
+  if (h) {
+    rf_shm_handler_t* handler = (rf_shm_handler_t*)h;
+    update_rates(handler, srate);
+    ret = handler->srate;
+  }
+  return ret;
+}
+
+double rf_shm_set_tx_srate(void* h, double srate)
+{
+  double ret = 0.0;
+  if (h) {
+    rf_shm_handler_t* handler = (rf_shm_handler_t*)h;
+    update_rates(handler, srate);
+    ret = srate;
+  }
+  return ret;
+}
+
+int rf_shm_set_rx_gain(void* h, double gain)
+{
+  if (h) {
+    rf_shm_handler_t* handler = (rf_shm_handler_t*)h;
+    pthread_mutex_lock(&handler->rx_gain_mutex);
+    handler->rx_gain = gain;
+    pthread_mutex_unlock(&handler->rx_gain_mutex);
+  }
+  return SRSRAN_SUCCESS;
+}
+
+int rf_shm_set_rx_gain_ch(void* h, uint32_t ch, double gain)
+{
+  return rf_shm_set_rx_gain(h, gain);
+}
+
+int rf_shm_set_tx_gain(void* h, double gain)
+{
+  if (h) {
+    rf_shm_handler_t* handler = (rf_shm_handler_t*)h;
+    pthread_mutex_lock(&handler->tx_config_mutex);
+    handler->tx_gain = gain;
+    pthread_mutex_unlock(&handler->tx_config_mutex);
+  }
+  return SRSRAN_SUCCESS;
+}
+
+int rf_shm_set_tx_gain_ch(void* h, uint32_t ch, double gain)
+{
+  return rf_shm_set_tx_gain(h, gain);
+}
+
+double rf_shm_get_rx_gain(void* h)
+{
+  double ret = 0.0;
+  if (h) {
+    rf_shm_handler_t* handler = (rf_shm_handler_t*)h;
+    pthread_mutex_lock(&handler->rx_gain_mutex);
+    ret = handler->rx_gain;
+    pthread_mutex_unlock(&handler->rx_gain_mutex);
+  }
+  return ret;
+}
+
+double rf_shm_get_tx_gain(void* h)
+{
+  double ret = NAN;
+  if (h) {
+    rf_shm_handler_t* handler = (rf_shm_handler_t*)h;
+    pthread_mutex_lock(&handler->tx_config_mutex);
+    ret = handler->tx_gain;
+    pthread_mutex_unlock(&handler->tx_config_mutex);
+  }
+  return ret;
+}
+
+srsran_rf_info_t* rf_shm_get_info(void* h)
+{
+  srsran_rf_info_t* info = NULL;
+  if (h) {
+    rf_shm_handler_t* handler = (rf_shm_handler_t*)h;
+    info                      = &handler->info;
+  }
+  return info;
+}
+
+double rf_shm_set_rx_freq(void* h, uint32_t ch, double freq)
+{
+  double ret = NAN;
+  if (h) {
+    rf_shm_handler_t* handler = (rf_shm_handler_t*)h;
+    pthread_mutex_lock(&handler->rx_config_mutex);
+    if (ch < handler->nof_channels && isnormal(freq) && freq > 0.0) {
+      handler->rx_freq_mhz[ch] = (uint32_t)(freq / 1e6);
+      ret                      = freq;
+    }
+    pthread_mutex_unlock(&handler->rx_config_mutex);
+  }
+  return ret;
+}
+
+double rf_shm_set_tx_freq(void* h, uint32_t ch, double freq)
+{
+  double ret = NAN;
+  if (h) {
+    rf_shm_handler_t* handler = (rf_shm_handler_t*)h;
+    pthread_mutex_lock(&handler->tx_config_mutex);
+    if (ch < handler->nof_channels && isnormal(freq) && freq > 0.0) {
+      handler->tx_freq_mhz[ch] = (uint32_t)(freq / 1e6);
+      ret                      = freq;
+    }
+    pthread_mutex_unlock(&handler->tx_config_mutex);
+  }
+  return ret;
+}
+
+void rf_shm_get_time(void* h, time_t* secs, double* frac_secs)
+{
+  if (h) {
+    if (secs) {
+      *secs = 0;
+    }
+
+    if (frac_secs) {
+      *frac_secs = 0;
+    }
+  }
+}
+
+int rf_shm_recv_with_time(void* h, void* data, uint32_t nsamples, bool blocking, time_t* secs, double* frac_secs)
+{
+  return rf_shm_recv_with_time_multi(h, &data, nsamples, blocking, secs, frac_secs);
+}
+
+int rf_shm_recv_with_time_multi(void* h, void** data, uint32_t nsamples, bool blocking, time_t* secs, double* frac_secs)
+{
+  int ret = SRSRAN_ERROR;
+
+  if (h) {
+    rf_shm_handler_t* handler = (rf_shm_handler_t*)h;
+
+    // Map ports to data buffers according to the selected frequencies
+    pthread_mutex_lock(&handler->rx_config_mutex);
+    bool  mapped[SRSRAN_MAX_CHANNELS]  = {}; // Mapped mask, set to true when the physical channel is used
+    cf_t* buffers[SRSRAN_MAX_CHANNELS] = {}; // Buffer pointers, NULL if unmatched
+
+    // For each logical channel...
+    for (uint32_t logical = 0; logical < handler->nof_channels; logical++) {
+      bool unmatched = true;
+
+      // For each physical channel...
+      for (uint32_t physical = 0; physical < handler->nof_channels; physical++) {
+        // Consider a match if the physical channel is NOT mapped and the frequency match
+        if (!mapped[physical] && shm_port_match_freq(&handler->receiver[physical], handler->rx_freq_mhz[logical])) {
+          buffers[physical] = (cf_t*)data[logical];
+          mapped[physical]  = true;
+          unmatched         = false;
+          break;
+        }
+      }
+
+      // If no matching frequency found; set data to zeros
+      if (unmatched && data[logical]) {
+        srsran_vec_cf_zero(data[logical], nsamples);
+      }
+    }
+    pthread_mutex_unlock(&handler->rx_config_mutex);
+
+    // Protect the access to decim_factor since is a shared variable
+    pthread_mutex_lock(&handler->decim_mutex);
+    uint32_t decim_factor = handler->decim_factor;
+    pthread_mutex_unlock(&handler->decim_mutex);
+
+    uint32_t nsamples_baserate = nsamples * decim_factor;
+
+    // set timestamp for this reception
+    if (secs != NULL && frac_secs != NULL) {
+      srsran_timestamp_t ts = {};
+      srsran_timestamp_init_uint64(&ts, handler->next_rx_ts, handler->base_srate);
+      *secs      = ts.full_secs;
+      *frac_secs = ts.frac_secs;
+    }
+
+    // return if receiver is turned off
+    if (handler->rx_off) {
+      handler->next_rx_ts += nsamples_baserate;
+      return nsamples;
+    }
+
+    // Fill the gap in our own Tx stream, so the peer is not blocked waiting for it while we wait for its samples
+    for (uint32_t i = 0; i < handler->nof_channels; i++) {
+      rf_shm_port_t* tx = &handler->transmitter[i];
+      if (tx->hdr) {
+        pthread_mutex_lock(&tx->mutex);
+        shm_tx_align(tx, handler->next_rx_ts + nsamples_baserate);
+        pthread_mutex_unlock(&tx->mutex);
+      }
+    }
+
+    // Read all channels
+    for (uint32_t i = 0; i < handler->nof_channels; i++) {
+      if (shm_port_enabled(&handler->receiver[i])) {
+        int n = shm_rx_read(&handler->receiver[i], buffers[i], nsamples, decim_factor, handler->base_srate);
+        if (n < SRSRAN_SUCCESS) {
+          fprintf(stderr, "Error: receiving data.\n");
+          goto clean_exit;
+        }
+      }
+    }
+
+    // Set gain
+    pthread_mutex_lock(&handler->rx_gain_mutex);
+    float scale = srsran_convert_dB_to_amplitude(handler->rx_gain);
+    pthread_mutex_unlock(&handler->rx_gain_mutex);
+    if (scale != 1.0f) {
+      for (uint32_t c = 0; c < handler->nof_channels; c++) {
+        if (buffers[c]) {
+          srsran_vec_sc_prod_cfc(buffers[c], scale, buffers[c], nsamples);
+        }
+      }
+    }
+
+    // update rx time
+    handler->next_rx_ts += nsamples_baserate;
+  }
+
+  ret = nsamples;
+
+clean_exit:
+
+  return ret;
+}
+
+int rf_shm_send_timed(void*  h,
+                      void*  data,
+                      int    nsamples,
+                      time_t secs,
+                      double frac_secs,
+                      bool   has_time_spec,
+                      bool   blocking,
+                      bool   is_start_of_burst,
+                      bool   is_end_of_burst)
+{
+  void* _data[4] = {data, NULL, NULL, NULL};
+
+  return rf_shm_send_timed_multi(
+      h, _data, nsamples, secs, frac_secs, has_time_spec, blocking, is_start_of_burst, is_end_of_burst);
+}
+
+int rf_shm_send_timed_multi(void*  h,
+                            void*  data[4],
+                            int    nsamples,
+                            time_t secs,
+                            double frac_secs,
+                            bool   has_time_spec,
+                            bool   blocking,
+                            bool   is_start_of_burst,
+                            bool   is_end_of_burst)
+{
+  int ret = SRSRAN_ERROR;
+
+  if (h && data && nsamples > 0) {
+    rf_shm_handler_t* handler = (rf_shm_handler_t*)h;
+
+    // return if transmitter is switched off
+    if (handler->tx_off) {
+      return SRSRAN_SUCCESS;
+    }
+
+    // Map ports to data buffers according to the selected frequencies
+    pthread_mutex_lock(&handler->tx_config_mutex);
+    bool  mapped[SRSRAN_MAX_CHANNELS]  = {}; // Mapped mask, set to true when the physical channel is used
+    cf_t* buffers[SRSRAN_MAX_CHANNELS] = {}; // Buffer pointers, NULL if unmatched or zero transmission
+
+    // For each logical channel...
+    for (uint32_t logical = 0; logical < handler->nof_channels; logical++) {
+      // For each physical channel...
+      for (uint32_t physical = 0; physical < handler->nof_channels; physical++) {
+        // Consider a match if the physical channel is NOT mapped and the frequency match
+        if (!mapped[physical] && shm_port_match_freq(&handler->transmitter[physical], handler->tx_freq_mhz[logical])) {
+          buffers[physical] = (cf_t*)data[logical];
+          mapped[physical]  = true;
+          break;
+        }
+      }
+    }
+    pthread_mutex_unlock(&handler->tx_config_mutex);
+
+    // Protect the access to decim_factor since is a shared variable
+    pthread_mutex_lock(&handler->decim_mutex);
+    uint32_t decim_factor = handler->decim_factor;
+    pthread_mutex_unlock(&handler->decim_mutex);
+
+    uint64_t tx_ts = 0;
+    if (has_time_spec) {
+      srsran_timestamp_t ts = {};
+      srsran_timestamp_init(&ts, secs, frac_secs);
+      tx_ts = srsran_timestamp_uint64(&ts, handler->base_srate);
+    }
+
+    for (uint32_t i = 0; i < handler->nof_channels; i++) {
+      rf_shm_port_t* tx = &handler->transmitter[i];
+      if (tx->hdr == NULL) {
+        continue;
+      }
+
+      pthread_mutex_lock(&tx->mutex);
+
+      // check if this is a tx in the future
+      if (has_time_spec) {
+        int num_tx_gap_samples = shm_tx_align(tx, tx_ts);
+        if (num_tx_gap_samples < 0) {
+          fprintf(stderr,
+                  "[shm] Error: tx time is %.3f ms in the past (%" PRIu64 " < %" PRIu64 ")\n",
+                  -1000.0 * num_tx_gap_samples / handler->base_srate,
+                  tx_ts,
+                  tx->hdr->write_ts);
+          pthread_mutex_unlock(&tx->mutex);
+          goto clean_exit;
+        }
+      }
+
+      // Write base-band samples straight into the ring, interpolating if required
+      shm_tx_write(tx, buffers[i], (uint32_t)nsamples, decim_factor);
+
+      pthread_mutex_unlock(&tx->mutex);
+    }
+  }
+
+  ret = SRSRAN_SUCCESS;
+
+clean_exit:
+
+  return ret;
+}
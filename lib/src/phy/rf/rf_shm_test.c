@@ -0,0 +1,305 @@
+/**
+ * Copyright 2013-2021 Software Radio Systems Limited
+ *
+ * This file is part of srsRAN.
+ *
+ * srsRAN is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsRAN is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+#include "rf_shm_imp.h"
+#include "srsran/common/tsan_options.h"
+#include "srsran/phy/common/timestamp.h"
+#include "srsran/phy/utils/debug.h"
+#include <complex.h>
+#include <pthread.h>
+#include <srsran/phy/common/phy_common.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+#define NOF_RX_ANT 1
+#define NUM_SF (500)
+#define SF_LEN (1920)
+#define RF_BUFFER_SIZE (SF_LEN * NUM_SF)
+#define TX_OFFSET_MS (4)
+
+static cf_t ue_rx_buffer[SRSRAN_MAX_CHANNELS][RF_BUFFER_SIZE];
+static cf_t enb_tx_buffer[SRSRAN_MAX_CHANNELS][RF_BUFFER_SIZE];
+static cf_t enb_rx_buffer[SRSRAN_MAX_CHANNELS][SF_LEN];
+
+static srsran_rf_t ue_radio, enb_radio;
+pthread_t          rx_thread;
+static uint32_t    nof_channels = NOF_RX_ANT;
+
+/// The ports name POSIX shared memory objects. The pid of the test is added to them, so that concurrent runs and
+/// objects left behind by a crashed run do not interfere with this one
+static const char* unique_ports(const char* args)
+{
+  static char buffers[2][RF_PARAM_LEN];
+  static int  idx    = 0;
+  const char* prefix = "/srsran_test_";
+  char*       out    = buffers[idx];
+  idx                = (idx + 1) % 2;
+
+  int         len = 0;
+  const char* in  = args;
+  const char* match;
+  while ((match = strstr(in, prefix)) != NULL && len < RF_PARAM_LEN) {
+    len += snprintf(out + len, RF_PARAM_LEN - len, "%.*s%s%d_", (int)(match - in), in, prefix, (int)getpid());
+    in = match + strlen(prefix);
+  }
+  if (len < RF_PARAM_LEN) {
+    snprintf(out + len, RF_PARAM_LEN - len, "%s", in);
+  }
+  return out;
+}
+
+void* ue_rx_thread_function(void* args)
+{
+  char rf_args[RF_PARAM_LEN];
+  strncpy(rf_args, (char*)args, RF_PARAM_LEN - 1);
+  rf_args[RF_PARAM_LEN - 1] = 0;
+
+  printf("opening rx device with args=%s\n", rf_args);
+  if (srsran_rf_open_devname(&ue_radio, "shm", rf_args, nof_channels)) {
+    fprintf(stderr, "Error opening rf\n");
+    exit(-1);
+  }
+
+  // receive 5 subframes at once (i.e. mimic initial rx that receives one slot)
+  uint32_t num_slots          = NUM_SF / 5;
+  uint32_t num_samps_per_slot = SF_LEN * 5;
+  uint32_t num_rxed_samps     = 0;
+  for (uint32_t i = 0; i < num_slots; ++i) {
+    void* data_ptr[SRSRAN_MAX_PORTS] = {NULL};
+    for (uint32_t c = 0; c < nof_channels; c++) {
+      data_ptr[c] = &ue_rx_buffer[c][i * num_samps_per_slot];
+    }
+    num_rxed_samps += srsran_rf_recv_with_time_multi(&ue_radio, data_ptr, num_samps_per_slot, true, NULL, NULL);
+  }
+
+  printf("received %d samples.\n", num_rxed_samps);
+
+  printf("closing ue norf device\n");
+  srsran_rf_close(&ue_radio);
+
+  return NULL;
+}
+
+void enb_tx_function(const char* tx_args, bool timed_tx)
+{
+  char rf_args[RF_PARAM_LEN];
+  strncpy(rf_args, tx_args, RF_PARAM_LEN - 1);
+  rf_args[RF_PARAM_LEN - 1] = 0;
+
+  printf("opening tx device with args=%s\n", rf_args);
+  if (srsran_rf_open_devname(&enb_radio, "shm", rf_args, nof_channels)) {
+    fprintf(stderr, "Error opening rf\n");
+    exit(-1);
+  }
+
+  // generate random tx data
+  for (uint32_t c = 0; c < nof_channels; c++) {
+    for (int i = 0; i < RF_BUFFER_SIZE; i++) {
+      enb_tx_buffer[c][i] = ((float)rand() / (float)RAND_MAX) + _Complex_I * ((float)rand() / (float)RAND_MAX);
+    }
+  }
+
+  // send data subframe per subframe
+  uint32_t num_txed_samples = 0;
+
+  // initial transmission without ts
+  void* data_ptr[SRSRAN_MAX_PORTS] = {NULL};
+  for (uint32_t c = 0; c < nof_channels; c++) {
+    data_ptr[c] = &enb_tx_buffer[c][num_txed_samples];
+  }
+  int ret = srsran_rf_send_multi(&enb_radio, (void**)data_ptr, SF_LEN, true, true, false);
+  num_txed_samples += SF_LEN;
+
+  // from here on, all transmissions are timed relative to the last rx time
+  srsran_timestamp_t rx_time, tx_time;
+
+  for (uint32_t i = 0; i < NUM_SF - ((timed_tx) ? TX_OFFSET_MS : 1); ++i) {
+    // first recv samples
+    for (uint32_t c = 0; c < nof_channels; c++) {
+      data_ptr[c] = enb_rx_buffer[c];
+    }
+    srsran_rf_recv_with_time_multi(&enb_radio, data_ptr, SF_LEN, true, &rx_time.full_secs, &rx_time.frac_secs);
+
+    // prepare data buffer
+    for (uint32_t c = 0; c < nof_channels; c++) {
+      data_ptr[c] = &enb_tx_buffer[c][num_txed_samples];
+    }
+
+    if (timed_tx) {
+      // timed tx relative to receive time (this will cause a cap in the rx'ed samples at the UE resulting in 3 zero
+      // subframes)
+      srsran_timestamp_copy(&tx_time, &rx_time);
+      srsran_timestamp_add(&tx_time, 0, TX_OFFSET_MS * 1e-3);
+      ret = srsran_rf_send_timed_multi(
+          &enb_radio, (void**)data_ptr, SF_LEN, tx_time.full_secs, tx_time.frac_secs, true, true, false);
+    } else {
+      // normal tx
+      ret = srsran_rf_send_multi(&enb_radio, (void**)data_ptr, SF_LEN, true, true, false);
+    }
+    if (ret != SRSRAN_SUCCESS) {
+      fprintf(stderr, "Error sending data\n");
+      exit(-1);
+    }
+
+    num_txed_samples += SF_LEN;
+  }
+
+  printf("transmitted %d samples in %d subframes\n", num_txed_samples, NUM_SF);
+
+  printf("closing tx device\n");
+  srsran_rf_close(&enb_radio);
+}
+
+int run_test(const char* rx_args, const char* tx_args, bool timed_tx, uint32_t nof_ch)
+{
+  int ret      = SRSRAN_ERROR;
+  nof_channels = nof_ch;
+  rx_args      = unique_ports(rx_args);
+  tx_args      = unique_ports(tx_args);
+
+  // make sure we can receive in slots
+  if (NUM_SF % 5 != 0) {
+    fprintf(stderr, "number of subframes must be multiple of 5\n");
+    goto exit;
+  }
+
+  struct timeval t[3];
+  gettimeofday(&t[1], NULL);
+
+  // start Rx thread
+  if (pthread_create(&rx_thread, NULL, ue_rx_thread_function, (void*)rx_args)) {
+    perror("pthread_create");
+    exit(-1);
+  }
+
+  enb_tx_function(tx_args, timed_tx);
+
+  // wait for rx thread
+  pthread_join(rx_thread, NULL);
+
+  gettimeofday(&t[2], NULL);
+  get_time_interval(t);
+  printf("transferred %d subframes in %ld us\n", NUM_SF, t[0].tv_sec * 1000000 + t[0].tv_usec);
+
+  // subframe-wise compare tx'ed and rx'ed data (stop 3 subframes earlier for timed tx)
+  for (uint32_t c = 0; c < nof_channels; c++) {
+    for (uint32_t i = 0; i < NUM_SF - (timed_tx ? 3 : 0); ++i) {
+      uint32_t sf_offet = 0;
+      if (timed_tx && i >= 1) {
+        // for timed transmission, the enb inserts 3 zero subframes after the first untimed tx
+        sf_offet = (TX_OFFSET_MS - 1) * SF_LEN;
+      }
+
+      if (memcmp(&ue_rx_buffer[c][sf_offet + i * SF_LEN], &enb_tx_buffer[c][i * SF_LEN], SF_LEN) != 0) {
+        fprintf(stderr, "data mismatch in subframe %d of channel %d\n", i, c);
+        goto exit;
+      }
+    }
+  }
+
+  ret = SRSRAN_SUCCESS;
+
+exit:
+  return ret;
+}
+
+int param_test(const char* args_param, const int num_channels)
+{
+  char rf_args[RF_PARAM_LEN] = {};
+  strncpy(rf_args, unique_ports(args_param), RF_PARAM_LEN - 1);
+  rf_args[RF_PARAM_LEN - 1] = 0;
+
+  printf("opening tx device with args=%s\n", rf_args);
+  if (srsran_rf_open_devname(&enb_radio, "shm", rf_args, num_channels)) {
+    fprintf(stderr, "Error opening rf\n");
+    return SRSRAN_ERROR;
+  }
+
+  srsran_rf_close(&enb_radio);
+
+  return SRSRAN_SUCCESS;
+}
+
+int main()
+{
+  // two Rx ports
+  if (param_test("rx_port=/srsran_test_dl0,rx_port1=/srsran_test_dl1", 2)) {
+    fprintf(stderr, "Param test failed!\n");
+    return SRSRAN_ERROR;
+  }
+
+  // 2 antennas, MIMO freq config and all generic options
+  if (param_test("tx_port0=/srsran_test_ul0,tx_port1=/srsran_test_ul1,rx_port0=/srsran_test_dl0,rx_port1=/"
+                 "srsran_test_dl1,id=ue,base_srate=23.04e6,ring_size=100000,tx_freq0=2510e6,tx_freq1=2510e6,rx_freq0="
+                 "2630e6,rx_freq1=2630e6",
+                 2)) {
+    fprintf(stderr, "Param test failed!\n");
+    return SRSRAN_ERROR;
+  }
+
+  // no port at all
+  if (param_test("id=enb,base_srate=1.92e6", 1) == SRSRAN_SUCCESS) {
+    fprintf(stderr, "Param test failed!\n");
+    return SRSRAN_ERROR;
+  }
+
+  // single tx, single rx with continuous transmissions (no timed tx)
+  if (run_test("rx_port=/srsran_test_link1,id=ue,base_srate=1.92e6",
+               "tx_port=/srsran_test_link1,id=enb,base_srate=1.92e6",
+               false,
+               1) != SRSRAN_SUCCESS) {
+    fprintf(stderr, "Single tx, single rx test failed!\n");
+    return -1;
+  }
+
+  // two trx radios with continous tx (no timed tx)
+  if (run_test("tx_port=/srsran_test_ul,rx_port=/srsran_test_dl,id=ue,base_srate=1.92e6,log_trx_timeout=true",
+               "rx_port=/srsran_test_ul,tx_port=/srsran_test_dl,id=enb,base_srate=1.92e6",
+               false,
+               1) != SRSRAN_SUCCESS) {
+    fprintf(stderr, "Two TRx radio test failed!\n");
+    return -1;
+  }
+
+  // two trx radios with timed tx, and rings that wrap around several times per test
+  if (run_test("tx_port=/srsran_test_ul,rx_port=/srsran_test_dl,id=ue,base_srate=1.92e6,ring_size=32768",
+               "rx_port=/srsran_test_ul,tx_port=/srsran_test_dl,id=enb,base_srate=1.92e6,ring_size=32768",
+               true,
+               1) != SRSRAN_SUCCESS) {
+    fprintf(stderr, "Two TRx radio test with timed tx failed!\n");
+    return -1;
+  }
+
+  // two trx radios with two channels each and timed tx
+  if (run_test("tx_port0=/srsran_test_ul0,tx_port1=/srsran_test_ul1,rx_port0=/srsran_test_dl0,rx_port1=/"
+               "srsran_test_dl1,id=ue,base_srate=1.92e6",
+               "rx_port0=/srsran_test_ul0,rx_port1=/srsran_test_ul1,tx_port0=/srsran_test_dl0,tx_port1=/"
+               "srsran_test_dl1,id=enb,base_srate=1.92e6",
+               true,
+               2) != SRSRAN_SUCCESS) {
+    fprintf(stderr, "Two TRx radio test with two channels failed!\n");
+    return -1;
+  }
+
+  return SRSRAN_SUCCESS;
+}
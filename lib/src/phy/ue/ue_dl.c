@@ -446,6 +446,39 @@ static bool dci_location_is_allocated(srsran_ue_dl_t* q, srsran_dci_location_t n
   return false;
 }
 
+/* Sorts the candidates of the search space by decreasing mean LLR magnitude, and drops the ones with too little energy
+ * to carry a DCI. Returns the number of candidates left in order.
+ */
+static uint32_t rank_candidates(srsran_ue_dl_t*     q,
+                                srsran_dl_sf_cfg_t* sf,
+                                dci_blind_search_t* search_space,
+                                uint32_t            order[SRSRAN_MAX_CANDIDATES])
+{
+  float    energy[SRSRAN_MAX_CANDIDATES];
+  uint32_t nof_candidates = 0;
+
+  for (uint32_t l = 0; l < search_space->nof_locations; l++) {
+    float e = srsran_pdcch_candidate_llr_mean(&q->pdcch, sf, &search_space->loc[l]);
+    if (e <= SRSRAN_PDCCH_MIN_LLR_MEAN) {
+      q->pdcch_stats.nof_skipped += search_space->nof_formats;
+      continue;
+    }
+
+    // Insertion sort, keeping the original order of candidates with the same energy
+    uint32_t i = nof_candidates;
+    while (i > 0 && energy[i - 1] < e) {
+      energy[i] = energy[i - 1];
+      order[i]  = order[i - 1];
+      i--;
+    }
+    energy[i] = e;
+    order[i]  = l;
+    nof_candidates++;
+  }
+
+  return nof_candidates;
+}
+
 static int dci_blind_search(srsran_ue_dl_t*     q,
                             srsran_dl_sf_cfg_t* sf,
                             uint16_t            rnti,
@@ -456,7 +489,19 @@ static int dci_blind_search(srsran_ue_dl_t*     q,
 {
   uint32_t nof_dci = 0;
   if (rnti) {
-    for (int l = 0; l < search_space->nof_locations; l++) {
+    // Only run the Viterbi decoder on the candidates that may hold a DCI, starting with the strongest ones
+    uint32_t order[SRSRAN_MAX_CANDIDATES];
+    uint32_t nof_candidates = 0;
+    if (q->dci_search_exhaustive) {
+      for (uint32_t l = 0; l < search_space->nof_locations; l++) {
+        order[nof_candidates++] = l;
+      }
+    } else {
+      nof_candidates = rank_candidates(q, sf, search_space, order);
+    }
+
+    for (uint32_t c = 0; c < nof_candidates; c++) {
+      uint32_t l = order[c];
       if (nof_dci >= SRSRAN_MAX_DCI_MSG) {
         ERROR("Can't store more DCIs in buffer");
         return nof_dci;
@@ -481,6 +526,9 @@ static int dci_blind_search(srsran_ue_dl_t*     q,
           ERROR("Error decoding DCI msg");
           return SRSRAN_ERROR;
         }
+        if (!q->dci_search_exhaustive) {
+          q->pdcch_stats.nof_decoded++;
+        }
 
         // Check if RNTI is matched
         if ((dci_msg[nof_dci].rnti == rnti) && (dci_msg[nof_dci].nof_bits > 0)) {
@@ -552,6 +600,40 @@ static int dci_blind_search(srsran_ue_dl_t*     q,
   return nof_dci;
 }
 
+/* Gets the UE-specific search space of the RNTI for the CFI and subframe index of sf. The locations are only computed
+ * the first time a {CFI, subframe} pair is searched for an RNTI, or if the number of CCEs changed (e.g. TDD mi value)
+ */
+static uint32_t
+ue_locations_cached(srsran_ue_dl_t* q, srsran_dl_sf_cfg_t* sf, uint16_t rnti, srsran_dci_location_t* locations)
+{
+  srsran_ue_dl_ss_cache_t* cache   = &q->ue_ss_cache;
+  uint32_t                 cfi_idx = SRSRAN_CFI_IDX(sf->cfi);
+  uint32_t                 sf_idx  = sf->tti % SRSRAN_NOF_SF_X_FRAME;
+  uint32_t                 nof_cce = q->pdcch.nof_cce[cfi_idx];
+
+  if (q->dci_search_exhaustive) {
+    return srsran_pdcch_ue_locations(&q->pdcch, sf, locations, SRSRAN_MAX_CANDIDATES_UE, rnti);
+  }
+
+  if (cache->rnti != rnti) {
+    cache->rnti = rnti;
+    memset(cache->nof_cce, 0, sizeof(cache->nof_cce));
+  }
+
+  if (cache->nof_cce[cfi_idx][sf_idx] != nof_cce) {
+    cache->nof_locations[cfi_idx][sf_idx] =
+        srsran_pdcch_ue_locations(&q->pdcch, sf, cache->loc[cfi_idx][sf_idx], SRSRAN_MAX_CANDIDATES_UE, rnti);
+    cache->nof_cce[cfi_idx][sf_idx] = nof_cce;
+    q->pdcch_stats.nof_ss_misses++;
+  } else {
+    q->pdcch_stats.nof_ss_hits++;
+  }
+
+  uint32_t nof_locations = cache->nof_locations[cfi_idx][sf_idx];
+  memcpy(locations, cache->loc[cfi_idx][sf_idx], sizeof(srsran_dci_location_t) * nof_locations);
+  return nof_locations;
+}
+
 static int find_dci_ss(srsran_ue_dl_t*            q,
                        srsran_dl_sf_cfg_t*        sf,
                        srsran_ue_dl_cfg_t*        cfg,
@@ -577,8 +659,7 @@ static int find_dci_ss(srsran_ue_dl_t*            q,
 
   // Generate Search Space
   if (is_ue) {
-    search_space.nof_locations =
-        srsran_pdcch_ue_locations(&q->pdcch, sf, search_space.loc, SRSRAN_MAX_CANDIDATES_UE, rnti);
+    search_space.nof_locations = ue_locations_cached(q, sf, rnti, search_space.loc);
   } else {
     // Disable extended CSI request and SRS request in common SS
     srsran_dci_cfg_set_common_ss(&dci_cfg);
@@ -721,6 +802,30 @@ int srsran_ue_dl_find_dl_dci(srsran_ue_dl_t*     q,
   return nof_msg;
 }
 
+void srsran_ue_dl_get_pdcch_stats(srsran_ue_dl_t* q, srsran_ue_dl_pdcch_stats_t* stats)
+{
+  if (q != NULL && stats != NULL) {
+    *stats = q->pdcch_stats;
+  }
+}
+
+void srsran_ue_dl_reset_pdcch_stats(srsran_ue_dl_t* q)
+{
+  if (q != NULL) {
+    bzero(&q->pdcch_stats, sizeof(srsran_ue_dl_pdcch_stats_t));
+  }
+}
+
+/* Makes the blind search compute the UE-specific search space every time and decode all the candidates in order, as
+ * it did before the cache and the pre-screen. These searches are not accounted in the PDCCH statistics
+ */
+void srsran_ue_dl_set_dci_search_exhaustive(srsran_ue_dl_t* q, bool exhaustive)
+{
+  if (q != NULL) {
+    q->dci_search_exhaustive = exhaustive;
+  }
+}
+
 int srsran_ue_dl_dci_to_pdsch_grant(srsran_ue_dl_t*       q,
                                     srsran_dl_sf_cfg_t*   sf,
                                     srsran_ue_dl_cfg_t*   cfg,
@@ -99,17 +99,15 @@ void backend_worker::do_work()
   constexpr std::chrono::microseconds sleep_period{100};
 
   while (running_flag) {
-    auto item = queue.try_pop();
+    report_queue_on_full_once();
+
+    size_t nof_entries =
+        queue.try_pop_batch([this](detail::log_entry&& entry) { process_log_entry(std::move(entry)); }, max_batch_size);
 
     // Spin while there are no new entries to process.
-    if (!item.first) {
+    if (!nof_entries) {
       std::this_thread::sleep_for(sleep_period);
-      continue;
     }
-
-    report_queue_on_full_once();
-
-    process_log_entry(std::move(item.second));
   }
 
   // When we reach here, the thread is about to terminate, last chance to
@@ -155,14 +153,8 @@ void backend_worker::process_outstanding_entries()
 {
   assert(!running_flag && "Cannot process outstanding entries while thread is running");
 
-  while (true) {
-    auto item = queue.try_pop();
-
-    // Check if the queue is empty.
-    if (!item.first) {
-      break;
-    }
-
-    process_log_entry(std::move(item.second));
+  // Drain the queue until it gets empty.
+  while (queue.try_pop_batch([this](detail::log_entry&& entry) { process_log_entry(std::move(entry)); },
+                             max_batch_size)) {
   }
 }
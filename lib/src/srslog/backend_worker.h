@@ -35,6 +35,9 @@ namespace srslog {
 /// log entries from a work queue and dispatches them to the selected sinks.
 class backend_worker
 {
+  /// Maximum number of entries processed between two checks of the termination flag and the queue occupancy.
+  static constexpr size_t max_batch_size = 64;
+
 public:
   backend_worker(detail::work_queue<detail::log_entry>& queue, detail::dyn_arg_store_pool& arg_pool) :
     queue(queue), arg_pool(arg_pool), running_flag(false)
@@ -0,0 +1,128 @@
+/**
+ * Copyright 2013-2021 Software Radio Systems Limited
+ *
+ * This file is part of srsRAN.
+ *
+ * srsRAN is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsRAN is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+#ifndef SRSLOG_BINARY_FORMAT_H
+#define SRSLOG_BINARY_FORMAT_H
+
+#include "srsran/srslog/bundled/fmt/format.h"
+#include <cstdint>
+#include <cstring>
+
+namespace srslog {
+
+/// Layout of the binary log files written by the binary file sink. All fields are stored in host byte order.
+///
+/// A file starts with the file magic followed by the format version (u32), then holds a sequence of records, each one
+/// made of a record_type (u8), the size of the record body (u32) and the body:
+///   - string: id (u32), followed by the string bytes. Defines the string referenced by id in later records.
+///   - entry: timestamp in ns since the epoch (i64), context value (u32), format string id (u32), log name id (u32),
+///     log tag (u8), entry_flags (u8), number of arguments (u8), the arguments, hex dump size (u32) and the hex dump
+///     bytes. Each argument is an arg_type (u8) followed by its value, strings being prefixed by their size (u32).
+///     Format strings that do not come from string literals are flagged with entry_flags::inline_fmtstring and stored
+///     inline, as a size prefixed string right after the entry flags.
+///   - context: the fields of an entry, then the context name and size (u32), followed by a sequence of
+///     context_event (u8) with their parameters, terminated by context_event::end.
+/// A string id of zero means the string is not present.
+namespace binary_format {
+
+constexpr char     file_magic[8] = {'S', 'R', 'S', 'L', 'O', 'G', 'B', 'N'};
+constexpr uint32_t version       = 1;
+constexpr size_t   header_size   = sizeof(file_magic) + sizeof(version);
+/// Size of the type and body size fields that precede every record body.
+constexpr size_t record_header_size = sizeof(uint8_t) + sizeof(uint32_t);
+
+enum class record_type : uint8_t { string = 1, entry, context };
+
+enum entry_flags : uint8_t { context_enabled = 1 << 0, has_arg_store = 1 << 1, inline_fmtstring = 1 << 2 };
+
+enum class arg_type : uint8_t {
+  int32 = 1,
+  uint32,
+  int64,
+  uint64,
+  boolean,
+  character,
+  float32,
+  float64,
+  long_double,
+  string,
+  pointer
+};
+
+/// Each event matches one of the context formatting callbacks of log_formatter. Names and values are stored inline
+/// as size prefixed strings.
+enum class context_event : uint8_t {
+  /// name, size (u32), level (u32).
+  set_begin = 1,
+  /// name, level (u32).
+  set_end,
+  /// name, size (u32), level (u32).
+  list_begin,
+  /// name, level (u32).
+  list_end,
+  /// name, value, units, metric_kind (u8), level (u32).
+  metric,
+  end
+};
+
+/// Appends the raw bytes of a trivially copyable value to the buffer.
+template <typename T>
+inline void put(fmt::memory_buffer& buffer, const T& value)
+{
+  const char* p = reinterpret_cast<const char*>(&value);
+  buffer.append(p, p + sizeof(T));
+}
+
+/// Appends a size prefixed string to the buffer.
+inline void put_string(fmt::memory_buffer& buffer, fmt::string_view str)
+{
+  put(buffer, static_cast<uint32_t>(str.size()));
+  buffer.append(str.data(), str.data() + str.size());
+}
+
+/// Writes the file magic and version into the buffer.
+inline void put_file_header(fmt::memory_buffer& buffer)
+{
+  buffer.append(file_magic, file_magic + sizeof(file_magic));
+  put(buffer, version);
+}
+
+/// Starts a new record of the given type, returns the offset to pass to end_record once the body is written.
+inline size_t begin_record(fmt::memory_buffer& buffer, record_type type)
+{
+  size_t offset = buffer.size();
+  put(buffer, type);
+  put(buffer, uint32_t(0));
+  return offset;
+}
+
+/// Fills in the body size of the record started at the given offset.
+inline void end_record(fmt::memory_buffer& buffer, size_t offset)
+{
+  uint32_t size = static_cast<uint32_t>(buffer.size() - offset - record_header_size);
+  std::memcpy(buffer.data() + offset + sizeof(uint8_t), &size, sizeof(size));
+}
+
+} // namespace binary_format
+
+} // namespace srslog
+
+#endif // SRSLOG_BINARY_FORMAT_H
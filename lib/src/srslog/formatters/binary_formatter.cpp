@@ -0,0 +1,317 @@
+/**
+ * Copyright 2013-2021 Software Radio Systems Limited
+ *
+ * This file is part of srsRAN.
+ *
+ * srsRAN is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsRAN is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+#include "binary_formatter.h"
+#include "binary_format.h"
+#include "srsran/srslog/detail/log_entry_metadata.h"
+
+using namespace srslog;
+using namespace binary_format;
+
+/// Format string of the entries whose message had to be rendered by the formatter.
+static const char rendered_message_fmtstring[] = "%s";
+
+/// Id of the format strings that change their contents, which get stored inline.
+static constexpr uint32_t inline_fmtstring_id = 0;
+
+constexpr size_t binary_formatter::max_strings;
+
+std::unique_ptr<log_formatter> binary_formatter::clone() const
+{
+  return std::unique_ptr<log_formatter>(new binary_formatter);
+}
+
+namespace {
+
+/// Visitor that appends the type and raw value of a format argument to a buffer. Returns false for the argument types
+/// that can not be stored in binary form, i.e. user defined types.
+class arg_encoder
+{
+public:
+  explicit arg_encoder(fmt::memory_buffer& buffer) : buffer(buffer) {}
+
+  bool operator()(int v) { return put_arg(arg_type::int32, v); }
+  bool operator()(unsigned v) { return put_arg(arg_type::uint32, v); }
+  bool operator()(long long v) { return put_arg(arg_type::int64, v); }
+  bool operator()(unsigned long long v) { return put_arg(arg_type::uint64, v); }
+  bool operator()(bool v) { return put_arg(arg_type::boolean, v); }
+  bool operator()(char v) { return put_arg(arg_type::character, v); }
+  bool operator()(float v) { return put_arg(arg_type::float32, v); }
+  bool operator()(double v) { return put_arg(arg_type::float64, v); }
+  bool operator()(long double v) { return put_arg(arg_type::long_double, v); }
+  bool operator()(const void* v) { return put_arg(arg_type::pointer, reinterpret_cast<uint64_t>(v)); }
+  bool operator()(const char* v) { return (*this)(fmt::string_view(v)); }
+  bool operator()(fmt::string_view v)
+  {
+    put(buffer, arg_type::string);
+    put_string(buffer, v);
+    return true;
+  }
+
+  /// Custom types, 128 bit integers and empty arguments.
+  template <typename T>
+  bool operator()(T)
+  {
+    return false;
+  }
+
+private:
+  template <typename T>
+  bool put_arg(arg_type type, T v)
+  {
+    put(buffer, type);
+    put(buffer, v);
+    return true;
+  }
+
+private:
+  fmt::memory_buffer& buffer;
+};
+
+} // namespace
+
+/// Writes the fields of an entry after its string ids: the arguments of the input store and the hex dump. Returns
+/// false when an argument can not be stored in binary form, leaving the buffer with a partial record.
+static bool format_arguments(const detail::log_entry_metadata&                         metadata,
+                             const fmt::dynamic_format_arg_store<fmt::printf_context>* store,
+                             fmt::memory_buffer&                                       buffer)
+{
+  if (store) {
+    fmt::basic_format_args<fmt::printf_context> args(*store);
+    size_t                                      nof_args_offset = buffer.size();
+    put(buffer, uint8_t(0));
+
+    uint8_t     nof_args = 0;
+    arg_encoder encoder(buffer);
+    for (auto arg = args.get(0); arg; arg = args.get(++nof_args)) {
+      if (nof_args == UINT8_MAX || !fmt::visit_format_arg(encoder, arg)) {
+        return false;
+      }
+    }
+    buffer.data()[nof_args_offset] = static_cast<char>(nof_args);
+  } else {
+    put(buffer, uint8_t(0));
+  }
+
+  put(buffer, static_cast<uint32_t>(metadata.hex_dump.size()));
+  buffer.append(reinterpret_cast<const char*>(metadata.hex_dump.data()),
+                reinterpret_cast<const char*>(metadata.hex_dump.data() + metadata.hex_dump.size()));
+
+  return true;
+}
+
+/// Writes the fields of an entry up to its arguments.
+static void format_fixed_fields(const detail::log_entry_metadata& metadata,
+                                const char*                       fmtstring,
+                                uint32_t                          fmtstring_id,
+                                uint32_t                          name_id,
+                                bool                              with_store,
+                                fmt::memory_buffer&               buffer)
+{
+  bool is_inline = fmtstring && fmtstring_id == inline_fmtstring_id;
+
+  put(buffer,
+      static_cast<int64_t>(
+          std::chrono::duration_cast<std::chrono::nanoseconds>(metadata.tp.time_since_epoch()).count()));
+  put(buffer, metadata.context.value);
+  put(buffer, fmtstring_id);
+  put(buffer, name_id);
+  put(buffer, metadata.log_tag);
+  put(buffer,
+      static_cast<uint8_t>((metadata.context.enabled ? context_enabled : 0) | (with_store ? has_arg_store : 0) |
+                           (is_inline ? inline_fmtstring : 0)));
+  if (is_inline) {
+    put_string(buffer, fmtstring);
+  }
+}
+
+size_t binary_formatter::format_entry(const detail::log_entry_metadata& metadata,
+                                      record_type                       type,
+                                      fmt::memory_buffer&               buffer)
+{
+  // Strings are defined before the record that references them.
+  uint32_t fmtstring_id = get_fmtstring_id(metadata.fmtstring, buffer);
+  uint32_t name_id      = get_string_id(metadata.log_name, buffer);
+
+  size_t offset = begin_record(buffer, type);
+  format_fixed_fields(metadata, metadata.fmtstring, fmtstring_id, name_id, metadata.store != nullptr, buffer);
+  if (format_arguments(metadata, metadata.store, buffer)) {
+    return offset;
+  }
+
+  // Arguments of user defined types can only be rendered by their own formatter, store the rendered message instead.
+  buffer.resize(offset);
+  fmt::memory_buffer message;
+  try {
+    fmt::vprintf(message,
+                 fmt::to_string_view(metadata.fmtstring),
+                 fmt::basic_format_args<fmt::printf_context>(*metadata.store));
+  } catch (...) {
+    fmt::print(stderr, "srsLog error - Invalid format string: \"{}\"\n", metadata.fmtstring);
+    fmt::format_to(message, " -> srsLog error - Invalid format string: \"{}\"", metadata.fmtstring);
+  }
+  fmt::dynamic_format_arg_store<fmt::printf_context> store;
+  store.push_back(std::string(message.data(), message.size()));
+
+  fmtstring_id = get_fmtstring_id(rendered_message_fmtstring, buffer);
+  offset       = begin_record(buffer, type);
+  format_fixed_fields(metadata, rendered_message_fmtstring, fmtstring_id, name_id, true, buffer);
+  format_arguments(metadata, &store, buffer);
+
+  return offset;
+}
+
+void binary_formatter::format(detail::log_entry_metadata&& metadata, fmt::memory_buffer& buffer)
+{
+  size_t offset = format_entry(metadata, record_type::entry, buffer);
+  end_record(buffer, offset);
+}
+
+uint32_t binary_formatter::get_fmtstring_id(const char* fmtstring, fmt::memory_buffer& buffer)
+{
+  if (!fmtstring) {
+    return 0;
+  }
+
+  auto it = fmtstring_ids.find(fmtstring);
+  if (it != fmtstring_ids.end()) {
+    // A format string whose contents have changed lives in a reused buffer rather than in a literal, interning all its
+    // versions would grow the tables without bound.
+    if (it->second != inline_fmtstring_id && std::strcmp(strings[it->second - 1].c_str(), fmtstring) != 0) {
+      it->second = inline_fmtstring_id;
+    }
+    return it->second;
+  }
+
+  // New address, look the format string up by contents, as strings built at run time may live in a new buffer each
+  // time. Once the string table is full, new format strings are stored inline.
+  uint32_t id     = inline_fmtstring_id;
+  auto     str_it = string_ids.find(fmtstring);
+  if (str_it != string_ids.end()) {
+    id = str_it->second;
+  } else if (strings.size() < max_strings) {
+    id = get_string_id(fmtstring, buffer);
+  }
+  if (fmtstring_ids.size() < max_strings) {
+    fmtstring_ids.emplace(fmtstring, id);
+  }
+  return id;
+}
+
+uint32_t binary_formatter::get_string_id(const std::string& str, fmt::memory_buffer& buffer)
+{
+  auto it = string_ids.find(str);
+  if (it != string_ids.end()) {
+    return it->second;
+  }
+
+  strings.push_back(str);
+  uint32_t id = static_cast<uint32_t>(strings.size());
+  string_ids.emplace(str, id);
+  format_string(id, buffer);
+
+  return id;
+}
+
+void binary_formatter::format_string(uint32_t id, fmt::memory_buffer& buffer) const
+{
+  const std::string& str    = strings[id - 1];
+  size_t             offset = begin_record(buffer, record_type::string);
+  put(buffer, id);
+  buffer.append(str.data(), str.data() + str.size());
+  end_record(buffer, offset);
+}
+
+void binary_formatter::format_string_table(fmt::memory_buffer& buffer) const
+{
+  for (uint32_t id = 1, e = static_cast<uint32_t>(strings.size()); id <= e; ++id) {
+    format_string(id, buffer);
+  }
+}
+
+void binary_formatter::format_context_begin(const detail::log_entry_metadata& md,
+                                            fmt::string_view                  ctx_name,
+                                            unsigned                          size,
+                                            fmt::memory_buffer&               buffer)
+{
+  context_record_offset = format_entry(md, record_type::context, buffer);
+  put_string(buffer, ctx_name);
+  put(buffer, static_cast<uint32_t>(size));
+}
+
+void binary_formatter::format_context_end(const detail::log_entry_metadata& md,
+                                          fmt::string_view                  ctx_name,
+                                          fmt::memory_buffer&               buffer)
+{
+  put(buffer, context_event::end);
+  end_record(buffer, context_record_offset);
+}
+
+void binary_formatter::format_metric_set_begin(fmt::string_view    set_name,
+                                               unsigned            size,
+                                               unsigned            level,
+                                               fmt::memory_buffer& buffer)
+{
+  put(buffer, context_event::set_begin);
+  put_string(buffer, set_name);
+  put(buffer, static_cast<uint32_t>(size));
+  put(buffer, static_cast<uint32_t>(level));
+}
+
+void binary_formatter::format_metric_set_end(fmt::string_view set_name, unsigned level, fmt::memory_buffer& buffer)
+{
+  put(buffer, context_event::set_end);
+  put_string(buffer, set_name);
+  put(buffer, static_cast<uint32_t>(level));
+}
+
+void binary_formatter::format_list_begin(fmt::string_view    list_name,
+                                         unsigned            size,
+                                         unsigned            level,
+                                         fmt::memory_buffer& buffer)
+{
+  put(buffer, context_event::list_begin);
+  put_string(buffer, list_name);
+  put(buffer, static_cast<uint32_t>(size));
+  put(buffer, static_cast<uint32_t>(level));
+}
+
+void binary_formatter::format_list_end(fmt::string_view list_name, unsigned level, fmt::memory_buffer& buffer)
+{
+  put(buffer, context_event::list_end);
+  put_string(buffer, list_name);
+  put(buffer, static_cast<uint32_t>(level));
+}
+
+void binary_formatter::format_metric(fmt::string_view    metric_name,
+                                     fmt::string_view    metric_value,
+                                     fmt::string_view    metric_units,
+                                     metric_kind         kind,
+                                     unsigned            level,
+                                     fmt::memory_buffer& buffer)
+{
+  put(buffer, context_event::metric);
+  put_string(buffer, metric_name);
+  put_string(buffer, metric_value);
+  put_string(buffer, metric_units);
+  put(buffer, static_cast<uint8_t>(kind));
+  put(buffer, static_cast<uint32_t>(level));
+}
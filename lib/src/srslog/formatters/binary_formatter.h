@@ -0,0 +1,111 @@
+/**
+ * Copyright 2013-2021 Software Radio Systems Limited
+ *
+ * This file is part of srsRAN.
+ *
+ * srsRAN is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsRAN is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+#ifndef SRSLOG_BINARY_FORMATTER_H
+#define SRSLOG_BINARY_FORMATTER_H
+
+#include "binary_format.h"
+#include "srsran/srslog/formatter.h"
+#include <unordered_map>
+
+namespace srslog {
+
+/// Binary formatter implementation class.
+/// Rather than rendering log entries into text, it records the timestamp, context, format string and raw arguments of
+/// each entry following the layout described in binary_format.h, leaving the text rendering to the offline decoder.
+/// Format strings and log names are defined once in the output and referenced by id afterwards.
+class binary_formatter : public log_formatter
+{
+public:
+  /// Maximum number of strings defined by the formatter. Format strings seen for the first time once it is reached are
+  /// stored inline in their entries.
+  static constexpr size_t max_strings = 16384;
+
+  binary_formatter() = default;
+
+  /// Clones start with empty string tables, as the strings defined so far have not been written to their output.
+  std::unique_ptr<log_formatter> clone() const override;
+
+  void format(detail::log_entry_metadata&& metadata, fmt::memory_buffer& buffer) override;
+
+  /// Writes the definitions of all the strings referenced so far into the buffer. This allows starting a new output
+  /// that can be decoded on its own, without the records written to the previous one.
+  void format_string_table(fmt::memory_buffer& buffer) const;
+
+private:
+  void format_context_begin(const detail::log_entry_metadata& md,
+                            fmt::string_view                  ctx_name,
+                            unsigned                          size,
+                            fmt::memory_buffer&               buffer) override;
+
+  void format_context_end(const detail::log_entry_metadata& md,
+                          fmt::string_view                  ctx_name,
+                          fmt::memory_buffer&               buffer) override;
+
+  void format_metric_set_begin(fmt::string_view    set_name,
+                               unsigned            size,
+                               unsigned            level,
+                               fmt::memory_buffer& buffer) override;
+
+  void format_metric_set_end(fmt::string_view set_name, unsigned level, fmt::memory_buffer& buffer) override;
+
+  void
+  format_list_begin(fmt::string_view list_name, unsigned size, unsigned level, fmt::memory_buffer& buffer) override;
+
+  void format_list_end(fmt::string_view list_name, unsigned level, fmt::memory_buffer& buffer) override;
+
+  void format_metric(fmt::string_view    metric_name,
+                     fmt::string_view    metric_value,
+                     fmt::string_view    metric_units,
+                     metric_kind         kind,
+                     unsigned            level,
+                     fmt::memory_buffer& buffer) override;
+
+  /// Returns the id of the input format string, writing its definition into the buffer the first time it is seen.
+  uint32_t get_fmtstring_id(const char* fmtstring, fmt::memory_buffer& buffer);
+
+  /// Returns the id of the input string, writing its definition into the buffer the first time it is seen.
+  uint32_t get_string_id(const std::string& str, fmt::memory_buffer& buffer);
+
+  /// Writes the definition record of the string with the input id.
+  void format_string(uint32_t id, fmt::memory_buffer& buffer) const;
+
+  /// Starts a record of the input type and writes the fields of the log entry into it. Returns the offset of the
+  /// record in the buffer, for the caller to complete it.
+  size_t format_entry(const detail::log_entry_metadata& metadata,
+                      binary_format::record_type        type,
+                      fmt::memory_buffer&               buffer);
+
+private:
+  /// Defined strings indexed by id - 1.
+  std::vector<std::string> strings;
+  /// Maps string contents to ids.
+  std::unordered_map<std::string, uint32_t> string_ids;
+  /// Maps format string addresses to ids, up to max_strings addresses. Format strings are usually literals, which
+  /// avoids hashing their contents.
+  std::unordered_map<const char*, uint32_t> fmtstring_ids;
+  /// Offset in the output buffer of the context record being formatted.
+  size_t context_record_offset = 0;
+};
+
+} // namespace srslog
+
+#endif // SRSLOG_BINARY_FORMATTER_H
@@ -0,0 +1,296 @@
+/**
+ * Copyright 2013-2021 Software Radio Systems Limited
+ *
+ * This file is part of srsRAN.
+ *
+ * srsRAN is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsRAN is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+#include "binary_log_decoder.h"
+#include "binary_format.h"
+#include "srsran/srslog/detail/log_entry_metadata.h"
+
+using namespace srslog;
+using namespace binary_format;
+
+/// Bounds checked reader of the fields of a record body. Reads past the end return empty values and flag the reader
+/// as failed.
+class binary_log_decoder::reader
+{
+public:
+  reader(const uint8_t* begin, const uint8_t* end) : p(begin), end(end) {}
+
+  template <typename T>
+  T get()
+  {
+    T value{};
+    if (remaining() < sizeof(T)) {
+      failed = true;
+      return value;
+    }
+    std::memcpy(&value, p, sizeof(T));
+    p += sizeof(T);
+    return value;
+  }
+
+  /// Reads the given number of bytes.
+  fmt::string_view get_bytes(size_t len)
+  {
+    if (remaining() < len) {
+      failed = true;
+      return {};
+    }
+    fmt::string_view str(reinterpret_cast<const char*>(p), len);
+    p += len;
+    return str;
+  }
+
+  /// Reads a size prefixed string.
+  fmt::string_view get_string() { return get_bytes(get<uint32_t>()); }
+
+  /// Reads a size prefixed string into the given storage. Formatters may rely on the names they receive being null
+  /// terminated, as they are when they come from a context object.
+  fmt::string_view get_string(std::string& storage)
+  {
+    fmt::string_view str = get_string();
+    storage.assign(str.data(), str.size());
+    return storage;
+  }
+
+  size_t remaining() const { return end - p; }
+
+  bool ok() const { return !failed; }
+
+private:
+  const uint8_t* p;
+  const uint8_t* end;
+  bool           failed = false;
+};
+
+const std::string* binary_log_decoder::find_string(uint32_t id) const
+{
+  auto it = strings.find(id);
+  return (it != strings.end()) ? &it->second : nullptr;
+}
+
+bool binary_log_decoder::decode_entry(reader& r, detail::log_entry_metadata& metadata)
+{
+  auto tp    = std::chrono::nanoseconds(r.get<int64_t>());
+  metadata.tp = std::chrono::high_resolution_clock::time_point(
+      std::chrono::duration_cast<std::chrono::high_resolution_clock::duration>(tp));
+  metadata.context.value   = r.get<uint32_t>();
+  uint32_t fmtstring_id    = r.get<uint32_t>();
+  uint32_t name_id         = r.get<uint32_t>();
+  metadata.log_tag         = r.get<char>();
+  uint8_t flags            = r.get<uint8_t>();
+  metadata.context.enabled = flags & context_enabled;
+
+  if (flags & inline_fmtstring) {
+    fmt::string_view str = r.get_string();
+    fmtstring_buffer.assign(str.data(), str.size());
+    metadata.fmtstring = fmtstring_buffer.c_str();
+  } else if (fmtstring_id) {
+    const std::string* str = find_string(fmtstring_id);
+    if (!str) {
+      return false;
+    }
+    metadata.fmtstring = str->c_str();
+  }
+
+  const std::string* name = find_string(name_id);
+  if (!name) {
+    return false;
+  }
+  metadata.log_name = *name;
+
+  store.clear();
+  metadata.store = (flags & has_arg_store) ? &store : nullptr;
+  for (unsigned i = 0, e = r.get<uint8_t>(); i != e && r.ok(); ++i) {
+    switch (static_cast<arg_type>(r.get<uint8_t>())) {
+      case arg_type::int32:
+        store.push_back(r.get<int>());
+        break;
+      case arg_type::uint32:
+        store.push_back(r.get<unsigned>());
+        break;
+      case arg_type::int64:
+        store.push_back(r.get<long long>());
+        break;
+      case arg_type::uint64:
+        store.push_back(r.get<unsigned long long>());
+        break;
+      case arg_type::boolean:
+        store.push_back(r.get<bool>());
+        break;
+      case arg_type::character:
+        store.push_back(r.get<char>());
+        break;
+      case arg_type::float32:
+        store.push_back(r.get<float>());
+        break;
+      case arg_type::float64:
+        store.push_back(r.get<double>());
+        break;
+      case arg_type::long_double:
+        store.push_back(r.get<long double>());
+        break;
+      case arg_type::string: {
+        // The printf formatter of the bundled fmt expects null terminated strings, so copy them into the store.
+        fmt::string_view str = r.get_string();
+        store.push_back(std::string(str.data(), str.size()));
+        break;
+      }
+      case arg_type::pointer:
+        store.push_back(reinterpret_cast<const void*>(r.get<uint64_t>()));
+        break;
+      default:
+        return false;
+    }
+  }
+
+  fmt::string_view hex_dump = r.get_string();
+  metadata.hex_dump.assign(hex_dump.data(), hex_dump.data() + hex_dump.size());
+
+  return r.ok();
+}
+
+bool binary_log_decoder::decode_context(reader& r, const detail::log_entry_metadata& metadata, log_formatter& formatter)
+{
+  std::string      ctx_name_buffer;
+  fmt::string_view ctx_name = r.get_string(ctx_name_buffer);
+  uint32_t         ctx_size = r.get<uint32_t>();
+  if (!r.ok()) {
+    return false;
+  }
+  formatter.format_context_begin(metadata, ctx_name, ctx_size, fmt_buffer);
+
+  std::string name_buffer, value_buffer, units_buffer;
+
+  while (r.ok()) {
+    switch (static_cast<context_event>(r.get<uint8_t>())) {
+      case context_event::set_begin: {
+        fmt::string_view name  = r.get_string(name_buffer);
+        uint32_t         size  = r.get<uint32_t>();
+        uint32_t         level = r.get<uint32_t>();
+        formatter.format_metric_set_begin(name, size, level, fmt_buffer);
+        break;
+      }
+      case context_event::set_end: {
+        fmt::string_view name  = r.get_string(name_buffer);
+        uint32_t         level = r.get<uint32_t>();
+        formatter.format_metric_set_end(name, level, fmt_buffer);
+        break;
+      }
+      case context_event::list_begin: {
+        fmt::string_view name  = r.get_string(name_buffer);
+        uint32_t         size  = r.get<uint32_t>();
+        uint32_t         level = r.get<uint32_t>();
+        formatter.format_list_begin(name, size, level, fmt_buffer);
+        break;
+      }
+      case context_event::list_end: {
+        fmt::string_view name  = r.get_string(name_buffer);
+        uint32_t         level = r.get<uint32_t>();
+        formatter.format_list_end(name, level, fmt_buffer);
+        break;
+      }
+      case context_event::metric: {
+        fmt::string_view name  = r.get_string(name_buffer);
+        fmt::string_view value = r.get_string(value_buffer);
+        fmt::string_view units = r.get_string(units_buffer);
+        auto             kind  = static_cast<metric_kind>(r.get<uint8_t>());
+        uint32_t         level = r.get<uint32_t>();
+        formatter.format_metric(name, value, units, kind, level, fmt_buffer);
+        break;
+      }
+      case context_event::end:
+        formatter.format_context_end(metadata, ctx_name, fmt_buffer);
+        return true;
+      default:
+        return false;
+    }
+  }
+
+  return false;
+}
+
+detail::error_string binary_log_decoder::decode(const uint8_t* data, size_t size, sink& output)
+{
+  if (size < header_size || std::memcmp(data, file_magic, sizeof(file_magic)) != 0) {
+    return "Input is not a srslog binary log file";
+  }
+  uint32_t file_version;
+  std::memcpy(&file_version, data + sizeof(file_magic), sizeof(file_version));
+  if (file_version != version) {
+    return fmt::format("Unsupported binary log version {}", file_version);
+  }
+
+  log_formatter& formatter = output.get_formatter();
+  for (size_t offset = header_size; offset != size;) {
+    if (size - offset < record_header_size) {
+      return fmt::format("Truncated record at offset {}", offset);
+    }
+    auto     type      = static_cast<record_type>(data[offset]);
+    uint32_t body_size = 0;
+    std::memcpy(&body_size, data + offset + sizeof(uint8_t), sizeof(body_size));
+    if (size - offset - record_header_size < body_size) {
+      return fmt::format("Truncated record at offset {}", offset);
+    }
+
+    const uint8_t* body = data + offset + record_header_size;
+    reader         r(body, body + body_size);
+    bool           valid = true;
+    switch (type) {
+      case record_type::string: {
+        uint32_t id  = r.get<uint32_t>();
+        auto     str = r.get_bytes(r.remaining());
+        strings[id].assign(str.data(), str.size());
+        valid       = r.ok() && id != 0;
+        break;
+      }
+      case record_type::entry:
+      case record_type::context: {
+        detail::log_entry_metadata metadata{};
+        valid = decode_entry(r, metadata);
+        if (!valid) {
+          break;
+        }
+        fmt_buffer.clear();
+        if (type == record_type::entry) {
+          formatter.format(std::move(metadata), fmt_buffer);
+        } else {
+          valid = decode_context(r, metadata, formatter);
+        }
+        if (valid) {
+          if (auto err_str = output.write({fmt_buffer.data(), fmt_buffer.size()})) {
+            return err_str;
+          }
+        }
+        break;
+      }
+      default:
+        valid = false;
+        break;
+    }
+    if (!valid) {
+      return fmt::format("Malformed record at offset {}", offset);
+    }
+
+    offset += record_header_size + body_size;
+  }
+
+  return {};
+}
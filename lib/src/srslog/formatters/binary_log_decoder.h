@@ -0,0 +1,67 @@
+/**
+ * Copyright 2013-2021 Software Radio Systems Limited
+ *
+ * This file is part of srsRAN.
+ *
+ * srsRAN is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsRAN is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+#ifndef SRSLOG_BINARY_LOG_DECODER_H
+#define SRSLOG_BINARY_LOG_DECODER_H
+
+#include "srsran/srslog/bundled/fmt/printf.h"
+#include "srsran/srslog/sink.h"
+#include <unordered_map>
+
+namespace srslog {
+
+namespace detail {
+struct log_entry_metadata;
+}
+
+/// Turns the contents of a binary log file, as written by the binary formatter, back into log entries. Each entry is
+/// formatted with the formatter of the output sink and written into it, producing the same output the sink would have
+/// written if it had received the entry in the first place.
+class binary_log_decoder
+{
+public:
+  /// Decodes the contents of a binary log file into the output sink. Returns an error when the data is not a binary
+  /// log file or contains a truncated or malformed record, in which case the entries decoded up to that point have
+  /// already been written to the sink.
+  detail::error_string decode(const uint8_t* data, size_t size, sink& output);
+
+private:
+  class reader;
+
+  /// Decodes the fields of an entry up to the hex dump.
+  bool decode_entry(reader& r, detail::log_entry_metadata& metadata);
+
+  /// Decodes the name and events of a context, replaying them into the formatter.
+  bool decode_context(reader& r, const detail::log_entry_metadata& metadata, log_formatter& formatter);
+
+  /// Returns the string defined with the input id, nullptr when it is not defined.
+  const std::string* find_string(uint32_t id) const;
+
+private:
+  std::unordered_map<uint32_t, std::string>          strings;
+  std::string                                        fmtstring_buffer;
+  fmt::dynamic_format_arg_store<fmt::printf_context> store;
+  fmt::memory_buffer                                 fmt_buffer;
+};
+
+} // namespace srslog
+
+#endif // SRSLOG_BINARY_LOG_DECODER_H
@@ -60,6 +60,12 @@ public:
   /// Stops the backend worker thread.
   void stop() { worker.stop(); }
 
+  /// Returns the counters of the backend.
+  backend_metrics get_metrics() const
+  {
+    return {queue.get_nof_dropped() + arg_pool.get_nof_alloc_failures(), queue.size(), queue.get_capacity()};
+  }
+
 private:
   detail::work_queue<detail::log_entry> queue;
   detail::dyn_arg_store_pool            arg_pool;
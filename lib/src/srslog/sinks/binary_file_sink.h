@@ -0,0 +1,169 @@
+/**
+ * Copyright 2013-2021 Software Radio Systems Limited
+ *
+ * This file is part of srsRAN.
+ *
+ * srsRAN is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsRAN is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+#ifndef SRSLOG_BINARY_FILE_SINK_H
+#define SRSLOG_BINARY_FILE_SINK_H
+
+#include "../formatters/binary_formatter.h"
+#include "file_utils.h"
+#include "srsran/srslog/sink.h"
+#include <cstdlib>
+#include <cstring>
+
+namespace srslog {
+
+/// This sink writes the records of a binary formatter into files. Incoming data is accumulated in a large page aligned
+/// buffer that is written to the file in one call once full, bypassing the stdio buffering. Includes the optional
+/// feature of file rotation: a new file is created when file size exceeds an established threshold. Every file starts
+/// with the file header and the string table of the formatter, so that it can be decoded on its own.
+class binary_file_sink : public sink
+{
+public:
+  /// Default size of the write buffer in bytes.
+  static constexpr size_t default_capacity = 1024 * 1024;
+
+  binary_file_sink(std::string name, size_t max_size, size_t capacity, std::unique_ptr<binary_formatter> f) :
+    sink(std::move(f)),
+    formatter(static_cast<binary_formatter&>(get_formatter())),
+    max_size((max_size == 0) ? 0 : std::max<size_t>(max_size, 4 * 1024)),
+    base_filename(std::move(name)),
+    capacity(capacity)
+  {
+    void* p = nullptr;
+    if (capacity && ::posix_memalign(&p, 4096, capacity) == 0) {
+      buffer.reset(static_cast<char*>(p));
+    }
+  }
+
+  ~binary_file_sink() override { flush_buffer(); }
+
+  binary_file_sink(const binary_file_sink& other) = delete;
+  binary_file_sink& operator=(const binary_file_sink& other) = delete;
+
+  detail::error_string write(detail::memory_buffer input_buffer) override
+  {
+    // Create a new file the first time we hit this method.
+    if (is_first_write()) {
+      assert(!handler && "No handler should be created yet");
+      if (auto err_str = create_file()) {
+        return err_str;
+      }
+    }
+
+    // Do not bother doing any work when the file was closed on a previous
+    // error.
+    if (!handler) {
+      return {};
+    }
+
+    // Rotate before the entry that would exceed the maximum size, entries are never split across files.
+    if (max_size && current_size + input_buffer.size() > max_size) {
+      if (auto err_str = flush_buffer()) {
+        return err_str;
+      }
+      if (auto err_str = create_file()) {
+        return err_str;
+      }
+    }
+
+    current_size += input_buffer.size();
+    return append(input_buffer);
+  }
+
+  detail::error_string flush() override
+  {
+    if (auto err_str = flush_buffer()) {
+      return err_str;
+    }
+    return handler.flush();
+  }
+
+private:
+  /// Returns true when the sink has never written data to a file, otherwise
+  /// returns false.
+  bool is_first_write() const { return file_index == 0; }
+
+  /// Creates a new file, starting it with the file header and the string table.
+  detail::error_string create_file()
+  {
+    if (auto err_str = handler.create(file_utils::build_filename_with_index(base_filename, file_index++))) {
+      return err_str;
+    }
+    if (buffer) {
+      std::setvbuf(handler.get_handle(), nullptr, _IONBF, 0);
+    }
+
+    fmt::memory_buffer header;
+    binary_format::put_file_header(header);
+    formatter.format_string_table(header);
+    current_size = header.size();
+
+    return append({header.data(), header.size()});
+  }
+
+  /// Copies the input data into the write buffer, writing the buffer to the file when it has no room left.
+  detail::error_string append(detail::memory_buffer input_buffer)
+  {
+    if (!buffer || buffer_size + input_buffer.size() > capacity) {
+      if (auto err_str = flush_buffer()) {
+        return err_str;
+      }
+      // Data that does not fit in the buffer goes straight to the file.
+      if (!buffer || input_buffer.size() > capacity) {
+        return handler.write(input_buffer);
+      }
+    }
+
+    std::memcpy(buffer.get() + buffer_size, input_buffer.data(), input_buffer.size());
+    buffer_size += input_buffer.size();
+    return {};
+  }
+
+  /// Writes the contents of the buffer into the file.
+  detail::error_string flush_buffer()
+  {
+    if (buffer_size == 0) {
+      return {};
+    }
+    auto err_str = handler.write({buffer.get(), buffer_size});
+    buffer_size  = 0;
+    return err_str;
+  }
+
+private:
+  struct free_deleter {
+    void operator()(char* p) const { ::free(p); }
+  };
+
+  binary_formatter&                   formatter;
+  const size_t                        max_size;
+  const std::string                   base_filename;
+  const size_t                        capacity;
+  std::unique_ptr<char, free_deleter> buffer;
+  size_t                              buffer_size = 0;
+  file_utils::file                    handler;
+  size_t                              current_size = 0;
+  uint32_t                            file_index   = 0;
+};
+
+} // namespace srslog
+
+#endif // SRSLOG_BINARY_FILE_SINK_H
@@ -88,6 +88,9 @@ public:
   /// Installs the specified error handler into the backend.
   void set_error_handler(error_handler callback) { backend.set_error_handler(std::move(callback)); }
 
+  /// Returns the counters of the backend.
+  backend_metrics get_backend_metrics() const { return backend.get_metrics(); }
+
   /// Set the specified sink as the default one.
   void set_default_sink(sink& s) { default_sink = &s; }
 
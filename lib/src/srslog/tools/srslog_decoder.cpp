@@ -0,0 +1,135 @@
+/**
+ * Copyright 2013-2021 Software Radio Systems Limited
+ *
+ * This file is part of srsRAN.
+ *
+ * srsRAN is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsRAN is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+/// Offline decoder of the files written by the srslog binary file sink. Renders the log entries with the text or JSON
+/// formatter into stdout or into a file.
+
+#include "../formatters/binary_log_decoder.h"
+#include "../formatters/json_formatter.h"
+#include "../formatters/text_formatter.h"
+#include "../sinks/file_sink.h"
+#include "../sinks/stream_sink.h"
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace srslog;
+
+static void usage(const char* prog)
+{
+  fmt::print("Usage: {} [-j] [-o output_file] binary_log_file...\n", prog);
+  fmt::print("\t-j Format the entries as JSON [Default text]\n");
+  fmt::print("\t-o Write into the given file [Default stdout]\n");
+}
+
+/// Maps the input file into memory and decodes it into the sink.
+static detail::error_string decode_file(const std::string& path, sink& output)
+{
+  int fd = ::open(path.c_str(), O_RDONLY);
+  if (fd < 0) {
+    return file_utils::format_error(fmt::format("Unable to open \"{}\"", path), errno);
+  }
+
+  struct stat st = {};
+  if (::fstat(fd, &st) < 0) {
+    auto err_str = file_utils::format_error(fmt::format("Unable to read \"{}\"", path), errno);
+    ::close(fd);
+    return err_str;
+  }
+
+  void* data = nullptr;
+  if (st.st_size > 0) {
+    data = ::mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (data == MAP_FAILED) {
+      auto err_str = file_utils::format_error(fmt::format("Unable to map \"{}\"", path), errno);
+      ::close(fd);
+      return err_str;
+    }
+    ::madvise(data, st.st_size, MADV_SEQUENTIAL);
+  }
+  ::close(fd);
+
+  // Each file carries its own string table.
+  binary_log_decoder decoder;
+  auto               err_str = decoder.decode(static_cast<const uint8_t*>(data), st.st_size, output);
+  if (data) {
+    ::munmap(data, st.st_size);
+  }
+  if (err_str) {
+    return fmt::format("{}: {}", path, err_str.get_error());
+  }
+
+  return {};
+}
+
+int main(int argc, char** argv)
+{
+  bool        use_json = false;
+  std::string output_path;
+
+  int opt;
+  while ((opt = getopt(argc, argv, "jo:h")) != -1) {
+    switch (opt) {
+      case 'j':
+        use_json = true;
+        break;
+      case 'o':
+        output_path = optarg;
+        break;
+      default:
+        usage(argv[0]);
+        return -1;
+    }
+  }
+  if (optind == argc) {
+    usage(argv[0]);
+    return -1;
+  }
+
+  std::unique_ptr<log_formatter> formatter;
+  if (use_json) {
+    formatter.reset(new json_formatter);
+  } else {
+    formatter.reset(new text_formatter);
+  }
+
+  std::unique_ptr<sink> output;
+  if (output_path.empty()) {
+    output.reset(new stream_sink(sink_stream_type::stdout, std::move(formatter)));
+  } else {
+    output.reset(new file_sink(output_path, 0, false, std::move(formatter)));
+  }
+
+  int ret = 0;
+  for (int i = optind; i != argc; ++i) {
+    if (auto err_str = decode_file(argv[i], *output)) {
+      fmt::print(stderr, "srslog_decoder error - {}\n", err_str.get_error());
+      ret = -1;
+    }
+  }
+  if (auto err_str = output->flush()) {
+    fmt::print(stderr, "srslog_decoder error - {}\n", err_str.get_error());
+    ret = -1;
+  }
+
+  return ret;
+}
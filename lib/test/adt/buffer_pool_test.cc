@@ -0,0 +1,198 @@
+/**
+ * Copyright 2013-2021 Software Radio Systems Limited
+ *
+ * This file is part of srsRAN.
+ *
+ * srsRAN is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsRAN is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+#include "srsran/common/buffer_pool.h"
+#include "srsran/common/test_common.h"
+#include <chrono>
+#include <thread>
+
+struct test_buffer_t {
+  uint8_t  payload[512];
+  uint32_t N_bytes = 0;
+#ifdef SRSRAN_BUFFER_POOL_LOG_ENABLED
+  char debug_name[SRSRAN_BUFFER_POOL_LOG_NAME_LEN];
+#endif
+};
+
+using test_pool_t = srsran::buffer_pool<test_buffer_t>;
+
+const char* to_string(srsran::buffer_pool_mode mode)
+{
+  return mode == srsran::buffer_pool_mode::locked ? "locked" : "lock_free";
+}
+
+int test_pool_ownership(srsran::buffer_pool_mode mode)
+{
+  const uint32_t nof_buffers = 64;
+  test_pool_t    pool(nof_buffers, mode);
+  TESTASSERT(pool.get_mode() == mode);
+  TESTASSERT(pool.nof_available_pdus() == nof_buffers);
+
+  std::vector<test_buffer_t*> bufs;
+  for (uint32_t i = 0; i < nof_buffers; ++i) {
+    test_buffer_t* b = pool.allocate();
+    TESTASSERT(b != nullptr);
+    TESTASSERT(pool.owns(b));
+    bufs.push_back(b);
+  }
+  TESTASSERT(pool.nof_available_pdus() == 0);
+
+  // all buffers are distinct
+  std::sort(bufs.begin(), bufs.end());
+  TESTASSERT(std::adjacent_find(bufs.begin(), bufs.end()) == bufs.end());
+
+  // pool depleted
+  TESTASSERT(pool.allocate() == nullptr);
+
+  // foreign and misaligned addresses are rejected
+  test_buffer_t foreign;
+  TESTASSERT(not pool.owns(&foreign));
+  TESTASSERT(not pool.deallocate(&foreign));
+  TESTASSERT(not pool.owns(reinterpret_cast<test_buffer_t*>(reinterpret_cast<uint8_t*>(bufs[0]) + 1)));
+
+  for (test_buffer_t* b : bufs) {
+    TESTASSERT(pool.deallocate(b));
+  }
+  TESTASSERT(pool.nof_available_pdus() == nof_buffers);
+
+  srsran::buffer_pool_metrics_t m = pool.get_metrics();
+  TESTASSERT(m.capacity == nof_buffers);
+  TESTASSERT(m.nof_available == nof_buffers);
+  TESTASSERT(m.high_water_mark == nof_buffers);
+  TESTASSERT(m.nof_alloc_failures == 1);
+  return SRSRAN_SUCCESS;
+}
+
+int test_pool_blocking_alloc(srsran::buffer_pool_mode mode)
+{
+  test_pool_t    pool(4, mode);
+  test_buffer_t* bufs[4];
+  for (test_buffer_t*& b : bufs) {
+    b = pool.allocate();
+    TESTASSERT(b != nullptr);
+  }
+
+  // the blocking allocation returns once another thread releases a buffer
+  std::thread t([&pool, &bufs]() {
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    pool.deallocate(bufs[2]);
+  });
+  test_buffer_t* b = pool.allocate(nullptr, true);
+  TESTASSERT(b == bufs[2]);
+  t.join();
+
+  for (test_buffer_t* buf : bufs) {
+    TESTASSERT(pool.deallocate(buf));
+  }
+  TESTASSERT(pool.nof_available_pdus() == 4);
+  return SRSRAN_SUCCESS;
+}
+
+/// Each worker keeps a small window of live buffers, and frees buffers allocated by its neighbour, to emulate
+/// PDUs allocated in PHY workers and released in the stack thread.
+int test_pool_concurrent_alloc(srsran::buffer_pool_mode mode, uint32_t nof_threads, uint32_t nof_iters)
+{
+  using std::chrono::high_resolution_clock;
+  using std::chrono::microseconds;
+
+  using queue_t = srsran::dyn_blocking_queue<test_buffer_t*>;
+
+  const uint32_t                        window = 8;
+  test_pool_t                           pool(nof_threads * window * 4, mode);
+  std::vector<std::unique_ptr<queue_t> > queues;
+  std::atomic<uint32_t>                 nof_failures{0};
+  for (uint32_t i = 0; i < nof_threads; ++i) {
+    queues.emplace_back(new queue_t(window * 2));
+  }
+
+  high_resolution_clock::time_point tp = high_resolution_clock::now();
+  std::vector<std::thread>          workers;
+  for (uint32_t i = 0; i < nof_threads; ++i) {
+    workers.emplace_back([&, i]() {
+      queue_t& tx_queue = *queues[(i + 1) % nof_threads];
+      queue_t& rx_queue = *queues[i];
+      for (uint32_t n = 0; n < nof_iters; ++n) {
+        test_buffer_t* b = pool.allocate();
+        if (b == nullptr) {
+          nof_failures++;
+        } else {
+          b->N_bytes = n;
+          if (not tx_queue.try_push(b)) {
+            pool.deallocate(b);
+          }
+        }
+        test_buffer_t* rx = nullptr;
+        if (rx_queue.try_pop(rx) and not pool.deallocate(rx)) {
+          nof_failures++;
+        }
+      }
+    });
+  }
+  for (std::thread& t : workers) {
+    t.join();
+  }
+  microseconds elapsed = std::chrono::duration_cast<microseconds>(high_resolution_clock::now() - tp);
+
+  // drain leftovers
+  for (auto& q : queues) {
+    test_buffer_t* b = nullptr;
+    while (q->try_pop(b)) {
+      TESTASSERT(pool.deallocate(b));
+    }
+  }
+  TESTASSERT(nof_failures == 0);
+  TESTASSERT(pool.nof_available_pdus() == pool.get_metrics().capacity);
+
+  srsran::buffer_pool_metrics_t m = pool.get_metrics();
+  TESTASSERT(m.high_water_mark <= m.capacity);
+  fmt::print("mode={:<9} threads={} ops={}: {:.1f} Mops/s, high_water_mark={}/{}, contentions={}\n",
+             to_string(mode),
+             nof_threads,
+             nof_threads * nof_iters * 2,
+             nof_threads * nof_iters * 2 / (double)std::max(elapsed.count(), (long)1),
+             m.high_water_mark,
+             m.capacity,
+             m.nof_contentions);
+  return SRSRAN_SUCCESS;
+}
+
+int main(int argc, char** argv)
+{
+  srsran::test_init(argc, argv);
+
+  uint32_t nof_iters = 200000;
+  if (argc > 1) {
+    nof_iters = std::strtoul(argv[1], nullptr, 10);
+  }
+
+  for (srsran::buffer_pool_mode mode : {srsran::buffer_pool_mode::locked, srsran::buffer_pool_mode::lock_free}) {
+    TESTASSERT(test_pool_ownership(mode) == SRSRAN_SUCCESS);
+    TESTASSERT(test_pool_blocking_alloc(mode) == SRSRAN_SUCCESS);
+  }
+  for (uint32_t nof_threads : {1, 2, 4, 8}) {
+    for (srsran::buffer_pool_mode mode : {srsran::buffer_pool_mode::locked, srsran::buffer_pool_mode::lock_free}) {
+      TESTASSERT(test_pool_concurrent_alloc(mode, nof_threads, nof_iters) == SRSRAN_SUCCESS);
+    }
+  }
+
+  printf("Success\n");
+  return 0;
+}
@@ -0,0 +1,111 @@
+/**
+ * Copyright 2013-2021 Software Radio Systems Limited
+ *
+ * This file is part of srsRAN.
+ *
+ * srsRAN is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsRAN is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+#include "srsran/adt/mpmc_queue.h"
+#include "srsran/common/test_common.h"
+#include <memory>
+#include <thread>
+#include <vector>
+
+namespace srsran {
+
+int test_mpmc_queue_single_thread()
+{
+  static_mpmc_queue<std::unique_ptr<int>, 8> q;
+  TESTASSERT(q.max_size() == 8 and q.empty());
+
+  // push until full
+  for (int i = 0; i < 8; ++i) {
+    TESTASSERT(q.try_push(std::unique_ptr<int>(new int(i))));
+    TESTASSERT(q.size() == (size_t)i + 1);
+  }
+  TESTASSERT(not q.try_push(std::unique_ptr<int>(new int(8))));
+
+  // elements come out in FIFO order
+  std::unique_ptr<int> val;
+  for (int i = 0; i < 4; ++i) {
+    TESTASSERT(q.try_pop(val) and *val == i);
+  }
+
+  // wrap-around
+  for (int i = 8; i < 12; ++i) {
+    TESTASSERT(q.try_push(std::unique_ptr<int>(new int(i))));
+  }
+  for (int i = 4; i < 12; ++i) {
+    TESTASSERT(q.try_pop(val) and *val == i);
+  }
+  TESTASSERT(q.empty() and not q.try_pop(val));
+
+  // pending elements are destroyed with the queue
+  TESTASSERT(q.try_push(std::unique_ptr<int>(new int(0))));
+  return SRSRAN_SUCCESS;
+}
+
+int test_mpmc_queue_multi_thread()
+{
+  const uint32_t                   nof_producers = 4, nof_consumers = 2, nof_items = 100000;
+  static_mpmc_queue<uint64_t, 256> q;
+  std::atomic<uint64_t>            sum{0};
+  std::atomic<uint32_t>            nof_popped{0};
+
+  std::vector<std::thread> threads;
+  for (uint32_t p = 0; p < nof_producers; ++p) {
+    threads.emplace_back([&q, p, nof_items]() {
+      for (uint64_t i = 0; i < nof_items; ++i) {
+        while (not q.try_push(p * nof_items + i)) {
+          std::this_thread::yield();
+        }
+      }
+    });
+  }
+  for (uint32_t c = 0; c < nof_consumers; ++c) {
+    threads.emplace_back([&]() {
+      uint64_t val;
+      while (nof_popped < nof_producers * nof_items) {
+        if (q.try_pop(val)) {
+          sum += val;
+          nof_popped++;
+        } else {
+          std::this_thread::yield();
+        }
+      }
+    });
+  }
+  for (std::thread& t : threads) {
+    t.join();
+  }
+
+  uint64_t n = nof_producers * nof_items;
+  TESTASSERT(nof_popped == n);
+  TESTASSERT(sum == n * (n - 1) / 2);
+  TESTASSERT(q.empty());
+  return SRSRAN_SUCCESS;
+}
+
+} // namespace srsran
+
+int main()
+{
+  TESTASSERT(srsran::test_mpmc_queue_single_thread() == SRSRAN_SUCCESS);
+  TESTASSERT(srsran::test_mpmc_queue_multi_thread() == SRSRAN_SUCCESS);
+  srsran::console("Success\n");
+  return SRSRAN_SUCCESS;
+}
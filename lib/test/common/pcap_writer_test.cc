@@ -0,0 +1,212 @@
+/**
+ * Copyright 2013-2021 Software Radio Systems Limited
+ *
+ * This file is part of srsRAN.
+ *
+ * srsRAN is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsRAN is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+#include "srsran/common/mac_pcap.h"
+#include "srsran/common/pcap.h"
+#include "srsran/common/pcap_writer.h"
+#include "srsran/common/test_common.h"
+#include <fstream>
+#include <iterator>
+#include <thread>
+
+static std::vector<uint8_t> read_file(const char* filename)
+{
+  std::ifstream file(filename, std::ios::binary);
+  return std::vector<uint8_t>(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+}
+
+static uint32_t read_u32(const std::vector<uint8_t>& data, size_t offset)
+{
+  uint32_t value = 0;
+  memcpy(&value, &data[offset], sizeof(value));
+  return value;
+}
+
+// Write #num_pdus UL MAC PDUs using PCAP handle
+void write_pcap_eutra_thread_function(srsran::mac_pcap* pcap_handle, std::vector<uint8_t> pdu, uint32_t num_pdus)
+{
+  for (uint32_t i = 0; i < num_pdus; i++) {
+    pcap_handle->write_ul_crnti(pdu.data(), pdu.size(), 0x1001, true, 1, 0);
+  }
+}
+
+int mac_pcap_file_test()
+{
+  const char*          filename            = "pcap_writer_test_mac.pcap";
+  uint32_t             num_threads         = 8;
+  uint32_t             num_pdus_per_thread = 1000;
+  std::vector<uint8_t> tv(150, 0x02);
+  tv[0] = 0x21;
+
+  srsran::mac_pcap pcap_handle;
+  TESTASSERT(pcap_handle.open(filename) == SRSRAN_SUCCESS);
+  TESTASSERT(pcap_handle.open(filename) != SRSRAN_SUCCESS); // open again will fail
+
+  std::vector<std::thread> writer_threads;
+  for (uint32_t i = 0; i < num_threads; i++) {
+    writer_threads.push_back(std::thread(write_pcap_eutra_thread_function, &pcap_handle, tv, num_pdus_per_thread));
+  }
+  for (std::thread& thread : writer_threads) {
+    thread.join();
+  }
+
+  TESTASSERT(pcap_handle.close() == SRSRAN_SUCCESS);
+  TESTASSERT(pcap_handle.close() != SRSRAN_SUCCESS); // closing twice will fail
+
+  // The rings of 2 MiB hold all the PDUs of a thread
+  srsran::pcap_writer_metrics_t metrics = pcap_handle.get_metrics();
+  TESTASSERT(metrics.nof_dropped == 0);
+  TESTASSERT(metrics.nof_pdus == num_threads * num_pdus_per_thread);
+
+  // TEST: the file is a classic pcap file with one record per PDU, each ending with the PDU
+  std::vector<uint8_t> data = read_file(filename);
+  TESTASSERT(data.size() > sizeof(pcap_hdr_t));
+  TESTASSERT(read_u32(data, 0) == 0xa1b2c3d4);
+  TESTASSERT(read_u32(data, 20) == UDP_DLT);
+  size_t   offset    = sizeof(pcap_hdr_t);
+  uint32_t nof_recs  = 0;
+  uint64_t nof_bytes = 0;
+  while (offset < data.size()) {
+    TESTASSERT(offset + sizeof(pcaprec_hdr_t) <= data.size());
+    uint32_t len = read_u32(data, offset + 8);
+    TESTASSERT(len == read_u32(data, offset + 12));
+    TESTASSERT(len > tv.size() and offset + sizeof(pcaprec_hdr_t) + len <= data.size());
+    offset += sizeof(pcaprec_hdr_t) + len;
+    TESTASSERT(memcmp(&data[offset - tv.size()], tv.data(), tv.size()) == 0);
+    nof_bytes += len;
+    nof_recs++;
+  }
+  TESTASSERT(offset == data.size());
+  TESTASSERT(nof_recs == metrics.nof_pdus);
+  TESTASSERT(nof_bytes == metrics.nof_bytes);
+
+  remove(filename);
+  return SRSRAN_SUCCESS;
+}
+
+int pcapng_test()
+{
+  const char*                           filename   = "pcap_writer_test.pcapng";
+  std::vector<srsran::pcap_interface_t> interfaces = {{UDP_DLT, "mac"}, {S1AP_LTE_DLT, "s1ap"}};
+  uint32_t                              num_pdus   = 500;
+
+  srsran::pcap_writer writer("PCAP_TEST");
+  TESTASSERT(not writer.open(filename, interfaces, srsran::pcap_file_format::pcap)); // one interface per pcap file
+  TESTASSERT(writer.open(filename, interfaces, srsran::pcap_file_format::pcapng));
+
+  // One thread per interface, payload sizes that need padding
+  std::vector<std::thread> writer_threads;
+  for (uint32_t if_idx = 0; if_idx < interfaces.size(); if_idx++) {
+    writer_threads.push_back(std::thread([&writer, if_idx, num_pdus]() {
+      uint8_t header[3] = {0xaa, 0xbb, (uint8_t)if_idx};
+      uint8_t payload[64];
+      for (uint32_t i = 0; i < num_pdus; i++) {
+        memset(payload, i, sizeof(payload));
+        writer.write(if_idx, header, sizeof(header), payload, i % sizeof(payload));
+      }
+    }));
+  }
+  for (std::thread& thread : writer_threads) {
+    thread.join();
+  }
+  TESTASSERT(not writer.write(interfaces.size(), nullptr, 0, nullptr, 0)); // unknown interface
+  writer.close();
+  TESTASSERT(not writer.is_open());
+
+  // TEST: section header, one interface description per interface and one enhanced packet per PDU
+  std::vector<uint8_t>  data    = read_file(filename);
+  size_t                offset  = 0;
+  uint32_t              nof_idb = 0;
+  std::vector<uint32_t> nof_epb(interfaces.size(), 0);
+  while (offset < data.size()) {
+    TESTASSERT(offset + 12 <= data.size());
+    uint32_t type = read_u32(data, offset);
+    uint32_t len  = read_u32(data, offset + 4);
+    TESTASSERT(len % 4 == 0 and offset + len <= data.size());
+    TESTASSERT(read_u32(data, offset + len - 4) == len);
+    if (offset == 0) {
+      TESTASSERT(type == 0x0A0D0D0A);
+      TESTASSERT(read_u32(data, offset + 8) == 0x1A2B3C4D);
+    } else if (type == 1) {
+      TESTASSERT((read_u32(data, offset + 8) & 0xffffU) == interfaces[nof_idb].dlt);
+      TESTASSERT(memcmp(&data[offset + 20], interfaces[nof_idb].name.data(), interfaces[nof_idb].name.size()) == 0);
+      nof_idb++;
+    } else {
+      TESTASSERT(type == 6);
+      uint32_t if_idx = read_u32(data, offset + 8);
+      uint32_t cap    = read_u32(data, offset + 20);
+      TESTASSERT(if_idx < interfaces.size());
+      TESTASSERT(cap == 3 + nof_epb[if_idx] % 64);
+      TESTASSERT(data[offset + 28 + 2] == if_idx);
+      nof_epb[if_idx]++;
+    }
+    offset += len;
+  }
+  TESTASSERT(nof_idb == interfaces.size());
+  for (uint32_t n : nof_epb) {
+    TESTASSERT(n == num_pdus);
+  }
+
+  remove(filename);
+  return SRSRAN_SUCCESS;
+}
+
+int drop_test()
+{
+  const char* filename = "pcap_writer_test_drop.pcap";
+  uint32_t    num_pdus = 20000;
+
+  // A ring smaller than a burst of PDUs
+  srsran::pcap_writer writer("PCAP_TEST", 4096);
+  TESTASSERT(writer.open(filename, {{UDP_DLT, "mac"}}, srsran::pcap_file_format::pcap));
+
+  std::vector<uint8_t> payload(200, 0x5a);
+  uint32_t             nof_written = 0;
+  for (uint32_t i = 0; i < num_pdus; i++) {
+    nof_written += writer.write(0, nullptr, 0, payload.data(), payload.size()) ? 1 : 0;
+  }
+  std::vector<uint8_t> big(srsran::pcap_writer::max_packet_size + 1);
+  TESTASSERT(not writer.write(0, nullptr, 0, big.data(), big.size()));
+  writer.close();
+
+  // TEST: every PDU is either in the file or counted as dropped
+  srsran::pcap_writer_metrics_t metrics = writer.get_metrics();
+  TESTASSERT(metrics.nof_pdus == nof_written);
+  TESTASSERT(metrics.nof_pdus + metrics.nof_dropped == num_pdus + 1);
+  TESTASSERT(metrics.nof_dropped > 1);
+
+  std::vector<uint8_t> data = read_file(filename);
+  TESTASSERT(data.size() == sizeof(pcap_hdr_t) + nof_written * (sizeof(pcaprec_hdr_t) + payload.size()));
+
+  remove(filename);
+  return SRSRAN_SUCCESS;
+}
+
+int main(int argc, char** argv)
+{
+  srslog::init();
+
+  TESTASSERT(mac_pcap_file_test() == SRSRAN_SUCCESS);
+  TESTASSERT(pcapng_test() == SRSRAN_SUCCESS);
+  TESTASSERT(drop_test() == SRSRAN_SUCCESS);
+
+  return SRSRAN_SUCCESS;
+}
@@ -0,0 +1,216 @@
+/**
+ * Copyright 2013-2021 Software Radio Systems Limited
+ *
+ * This file is part of srsRAN.
+ *
+ * srsRAN is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsRAN is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+#include "srsran/common/security_aes.h"
+#include "srsran/common/test_common.h"
+#include <chrono>
+#include <random>
+
+namespace srsran {
+
+static const uint32_t NOF_BEARERS = 4;
+
+struct run_params {
+  CIPHERING_ALGORITHM_ID_ENUM cipher_algo; ///< EEA0 when benchmarking an integrity algorithm
+  INTEGRITY_ALGORITHM_ID_ENUM integ_algo;
+  security_aes_impl_t         impl;
+  uint32_t                    pdu_size;
+  uint32_t                    nof_pdus; ///< PDUs processed per TTI, grouped in NOF_BEARERS bearers
+  uint32_t                    nof_ttis;
+};
+
+struct run_data {
+  run_params                   params;
+  float                        mbps;
+  std::chrono::duration<float> avg_tti_time;
+};
+
+/// Runs params.nof_pdus PDUs of one TTI through the algorithm under test
+static void process_tti(const run_params& params, std::vector<security_pdu_t>& pdus)
+{
+  // One call per PDU, as PDCP does
+  for (security_pdu_t& p : pdus) {
+    uint8_t* key = const_cast<uint8_t*>(p.key);
+    switch (params.cipher_algo) {
+      case CIPHERING_ALGORITHM_ID_128_EEA1:
+        security_128_eea1(key, p.count, p.bearer, p.direction, p.msg, p.msg_len, p.out);
+        break;
+      case CIPHERING_ALGORITHM_ID_128_EEA2:
+        security_128_eea2(key, p.count, p.bearer, p.direction, p.msg, p.msg_len, p.out);
+        break;
+      case CIPHERING_ALGORITHM_ID_128_EEA3:
+        security_128_eea3(key, p.count, p.bearer, p.direction, p.msg, p.msg_len, p.out);
+        break;
+      default:
+        break;
+    }
+    switch (params.integ_algo) {
+      case INTEGRITY_ALGORITHM_ID_128_EIA1:
+        security_128_eia1(key, p.count, p.bearer, p.direction, p.msg, p.msg_len, p.out);
+        break;
+      case INTEGRITY_ALGORITHM_ID_128_EIA2:
+        security_128_eia2(key, p.count, p.bearer, p.direction, p.msg, p.msg_len, p.out);
+        break;
+      case INTEGRITY_ALGORITHM_ID_128_EIA3:
+        security_128_eia3(key, p.count, p.bearer, p.direction, p.msg, p.msg_len, p.out);
+        break;
+      default:
+        break;
+    }
+  }
+}
+
+/**
+ * Ciphers (or computes the MAC of) params.nof_pdus random PDUs per TTI for params.nof_ttis TTIs, with the AES backend
+ * forced to params.impl. The first TTI is checked against the generic implementation
+ */
+int run_security_scenario(const run_params& params, std::vector<run_data>& run_results)
+{
+  std::minstd_rand                        rand_gen(params.pdu_size * params.nof_pdus);
+  std::uniform_int_distribution<uint32_t> byte_dist(0, 255);
+
+  std::array<std::array<uint8_t, 16>, NOF_BEARERS> keys;
+  for (auto& key : keys) {
+    for (uint8_t& b : key) {
+      b = byte_dist(rand_gen);
+    }
+  }
+  std::vector<std::vector<uint8_t> > msgs(params.nof_pdus, std::vector<uint8_t>(params.pdu_size));
+  std::vector<std::vector<uint8_t> > outs(params.nof_pdus, std::vector<uint8_t>(params.pdu_size));
+  std::vector<std::vector<uint8_t> > refs(params.nof_pdus, std::vector<uint8_t>(params.pdu_size));
+  std::vector<security_pdu_t>        pdus(params.nof_pdus);
+  for (uint32_t i = 0; i < params.nof_pdus; ++i) {
+    for (uint8_t& b : msgs[i]) {
+      b = byte_dist(rand_gen);
+    }
+    uint32_t bearer = i * NOF_BEARERS / params.nof_pdus;
+    pdus[i]         = {keys[bearer].data(), i, (uint8_t)bearer, 1, msgs[i].data(), params.pdu_size};
+  }
+
+  // TEST: all implementations produce the same output
+  TESTASSERT(security_aes_set_impl(security_aes_impl_t::generic));
+  for (uint32_t i = 0; i < params.nof_pdus; ++i) {
+    pdus[i].out = refs[i].data();
+  }
+  process_tti(params, pdus);
+  TESTASSERT(security_aes_set_impl(params.impl));
+  for (uint32_t i = 0; i < params.nof_pdus; ++i) {
+    pdus[i].out = outs[i].data();
+  }
+  process_tti(params, pdus);
+  uint32_t out_len = params.cipher_algo != CIPHERING_ALGORITHM_ID_EEA0 ? params.pdu_size : 4;
+  for (uint32_t i = 0; i < params.nof_pdus; ++i) {
+    TESTASSERT(memcmp(outs[i].data(), refs[i].data(), out_len) == 0);
+  }
+
+  auto tp_start = std::chrono::steady_clock::now();
+  for (uint32_t t = 0; t < params.nof_ttis; ++t) {
+    for (uint32_t i = 0; i < params.nof_pdus; ++i) {
+      pdus[i].count = t * params.nof_pdus + i;
+    }
+    process_tti(params, pdus);
+  }
+  std::chrono::duration<float> tot_time = std::chrono::steady_clock::now() - tp_start;
+
+  run_data r;
+  r.params       = params;
+  r.mbps         = (float)params.nof_ttis * params.nof_pdus * params.pdu_size * 8 / tot_time.count() / 1e6;
+  r.avg_tti_time = tot_time / params.nof_ttis;
+  run_results.push_back(r);
+  return SRSRAN_SUCCESS;
+}
+
+void print_benchmark_results(const std::vector<run_data>& run_results)
+{
+  fmt::print("run |     algo |    impl | PDU [B] | PDUs/TTI |  Mbit/s | time/TTI [usec]\n");
+  fmt::print("-------------------------------------------------------------------------\n");
+  for (uint32_t i = 0; i < run_results.size(); ++i) {
+    const run_data& r    = run_results[i];
+    const char*     algo = r.params.cipher_algo != CIPHERING_ALGORITHM_ID_EEA0
+                               ? ciphering_algorithm_id_text[r.params.cipher_algo]
+                               : integrity_algorithm_id_text[r.params.integ_algo];
+    fmt::print("{:>3d}{:>11s}{:>10s}{:>10d}{:>11d}{:>10.0f}{:>18.2f}\n",
+               i,
+               algo,
+               to_string(r.params.impl),
+               r.params.pdu_size,
+               r.params.nof_pdus,
+               r.mbps,
+               r.avg_tti_time.count() * 1e6);
+  }
+}
+
+int run_benchmark(const std::vector<uint32_t>& pdu_size_list,
+                  const std::vector<uint32_t>& nof_pdus_list,
+                  bool                         all_algos,
+                  uint32_t                     nof_ttis)
+{
+  std::vector<std::pair<CIPHERING_ALGORITHM_ID_ENUM, INTEGRITY_ALGORITHM_ID_ENUM> > algos = {
+      {CIPHERING_ALGORITHM_ID_128_EEA2, INTEGRITY_ALGORITHM_ID_EIA0},
+      {CIPHERING_ALGORITHM_ID_EEA0, INTEGRITY_ALGORITHM_ID_128_EIA2}};
+  if (all_algos) {
+    algos.insert(algos.end(),
+                 {{CIPHERING_ALGORITHM_ID_128_EEA1, INTEGRITY_ALGORITHM_ID_EIA0},
+                  {CIPHERING_ALGORITHM_ID_128_EEA3, INTEGRITY_ALGORITHM_ID_EIA0},
+                  {CIPHERING_ALGORITHM_ID_EEA0, INTEGRITY_ALGORITHM_ID_128_EIA1},
+                  {CIPHERING_ALGORITHM_ID_EEA0, INTEGRITY_ALGORITHM_ID_128_EIA3}});
+  }
+
+  std::vector<run_data> run_results;
+  for (const auto& algo : algos) {
+    // Only EEA2/EIA2 have accelerated implementations
+    security_aes_impl_t max_impl = security_aes_impl_t::generic;
+    if (algo.first == CIPHERING_ALGORITHM_ID_128_EEA2 or algo.second == INTEGRITY_ALGORITHM_ID_128_EIA2) {
+      max_impl = security_aes_detect_impl();
+    }
+    for (uint32_t impl = 0; impl <= (uint32_t)max_impl; ++impl) {
+      for (uint32_t pdu_size : pdu_size_list) {
+        for (uint32_t nof_pdus : nof_pdus_list) {
+          run_params params = {algo.first, algo.second, (security_aes_impl_t)impl, pdu_size, nof_pdus, nof_ttis};
+          TESTASSERT(run_security_scenario(params, run_results) == SRSRAN_SUCCESS);
+        }
+      }
+    }
+  }
+
+  print_benchmark_results(run_results);
+
+  return SRSRAN_SUCCESS;
+}
+
+} // namespace srsran
+
+int main(int argc, char* argv[])
+{
+  auto& test_logger = srslog::fetch_basic_logger("TEST");
+  test_logger.set_level(srslog::basic_levels::warning);
+
+  // Start the log backend.
+  srslog::init();
+
+  if (argc == 1 or strcmp(argv[1], "test") == 0) {
+    TESTASSERT(srsran::run_benchmark({5, 40, 1500}, {1, 16}, false, 100) == SRSRAN_SUCCESS);
+  } else {
+    TESTASSERT(srsran::run_benchmark({40, 100, 500, 1500, 9000}, {1, 8, 32}, true, 100) == SRSRAN_SUCCESS);
+  }
+
+  return 0;
+}
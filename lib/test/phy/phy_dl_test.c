@@ -20,6 +20,7 @@
  */
 
 #include <srsran/phy/utils/random.h>
+#include <inttypes.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <unistd.h>
@@ -316,6 +317,49 @@ static int check_evm(srsran_enb_dl_t* enb_dl, srsran_ue_dl_t* ue_dl, srsran_ue_d
   return ret;
 }
 
+/* Runs the DCI blind search of the subframe again, with and without the UE search space cache and the candidate
+ * pre-screen, and checks that both searches find the same DCIs
+ */
+static int check_dci_search(srsran_ue_dl_t* ue_dl, srsran_dl_sf_cfg_t* sf_cfg_dl, srsran_ue_dl_cfg_t* ue_dl_cfg)
+{
+  srsran_dci_dl_t dci[SRSRAN_MAX_DCI_MSG]     = {};
+  srsran_dci_dl_t dci_ref[SRSRAN_MAX_DCI_MSG] = {};
+
+  int nof_dci = srsran_ue_dl_find_dl_dci(ue_dl, sf_cfg_dl, ue_dl_cfg, rnti, dci);
+  srsran_ue_dl_set_dci_search_exhaustive(ue_dl, true);
+  int nof_dci_ref = srsran_ue_dl_find_dl_dci(ue_dl, sf_cfg_dl, ue_dl_cfg, rnti, dci_ref);
+  srsran_ue_dl_set_dci_search_exhaustive(ue_dl, false);
+
+  if (nof_dci != nof_dci_ref) {
+    printf("Found %d DCIs in subframe %d, and %d without the search space cache and the pre-screen\n",
+           nof_dci,
+           sf_cfg_dl->tti,
+           nof_dci_ref);
+    return SRSRAN_ERROR;
+  }
+
+  // The pre-screen may change the order of the DCIs
+  for (int i = 0; i < nof_dci; i++) {
+    char str[512];
+    srsran_dci_dl_info(&dci[i], str, sizeof(str));
+    bool found = false;
+    for (int j = 0; j < nof_dci_ref && !found; j++) {
+      char str_ref[512];
+      srsran_dci_dl_info(&dci_ref[j], str_ref, sizeof(str_ref));
+      found = strcmp(str, str_ref) == 0 && dci[i].location.L == dci_ref[j].location.L &&
+              dci[i].location.ncce == dci_ref[j].location.ncce;
+    }
+    if (!found) {
+      printf("DCI %s in subframe %d not found without the search space cache and the pre-screen\n",
+             str,
+             sf_cfg_dl->tti);
+      return SRSRAN_ERROR;
+    }
+  }
+
+  return SRSRAN_SUCCESS;
+}
+
 int main(int argc, char** argv)
 {
   srsran_enb_dl_t*        enb_dl      = srsran_vec_malloc(sizeof(srsran_enb_dl_t));
@@ -627,6 +671,10 @@ int main(int argc, char** argv)
 
     snr_db_avg += ue_dl->chest_res.snr_db;
 
+    if (check_dci_search(ue_dl, &sf_cfg_dl, &ue_dl_cfg)) {
+      goto quit;
+    }
+
     for (int i = 0; i < SRSRAN_MAX_TB; i++) {
       if (ue_dl_cfg.cfg.pdsch.grant.tb[i].enabled) {
         if (!isnormal(snr_db) && check_evm(enb_dl, ue_dl, &ue_dl_cfg, i)) {
@@ -671,6 +719,22 @@ int main(int argc, char** argv)
 
   printf("BLER: %5.1f%%\n", (float)count_failures / (float)count_tbs * 100.0f);
 
+  srsran_ue_dl_pdcch_stats_t pdcch_stats = {};
+  srsran_ue_dl_get_pdcch_stats(ue_dl, &pdcch_stats);
+  printf("PDCCH candidates: %" PRIu64 " decoded, %" PRIu64 " skipped\n",
+         pdcch_stats.nof_decoded,
+         pdcch_stats.nof_skipped);
+  printf("UE search spaces: %" PRIu64 " cached, %" PRIu64 " computed\n",
+         pdcch_stats.nof_ss_hits,
+         pdcch_stats.nof_ss_misses);
+
+  // The C-RNTI does not change, so each {CFI, subframe} search space is only computed once
+  if (pdcch_stats.nof_decoded == 0 || pdcch_stats.nof_ss_hits == 0 ||
+      pdcch_stats.nof_ss_misses > SRSRAN_NOF_CFI * SRSRAN_NOF_SF_X_FRAME) {
+    printf("Unexpected PDCCH blind search statistics\n");
+    ret = SRSRAN_ERROR;
+  }
+
   if (isnormal(snr_db)) {
     printf("SNR Real: %+.2f; estimated: %+.2f\n", snr_db, snr_db_avg / nof_subframes);
   }
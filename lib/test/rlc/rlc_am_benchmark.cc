@@ -0,0 +1,202 @@
+/**
+ * Copyright 2013-2021 Software Radio Systems Limited
+ *
+ * This file is part of srsRAN.
+ *
+ * srsRAN is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsRAN is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+#include "srsran/common/test_common.h"
+#include "srsran/interfaces/ue_pdcp_interfaces.h"
+#include "srsran/interfaces/ue_rrc_interfaces.h"
+#include "srsran/rlc/rlc_am_lte.h"
+#include <chrono>
+#include <random>
+
+namespace srsran {
+
+/// Checks that SDUs are delivered in order, without keeping them around
+class rlc_am_bench_tester : public srsue::pdcp_interface_rlc, public srsue::rrc_interface_rlc
+{
+public:
+  // PDCP interface
+  void write_pdu(uint32_t lcid, unique_byte_buffer_t sdu)
+  {
+    if (sdu->N_bytes != sdu_size or sdu->msg[0] != (uint8_t)nof_sdus or sdu->msg[sdu->N_bytes - 1] != sdu->msg[0]) {
+      nof_errors++;
+    }
+    nof_sdus++;
+    nof_bytes += sdu->N_bytes;
+  }
+  void write_pdu_bcch_bch(unique_byte_buffer_t sdu) {}
+  void write_pdu_bcch_dlsch(unique_byte_buffer_t sdu) {}
+  void write_pdu_pcch(unique_byte_buffer_t sdu) {}
+  void write_pdu_mch(uint32_t mch_idx, uint32_t lcid, unique_byte_buffer_t sdu) {}
+  void notify_delivery(uint32_t lcid, const pdcp_sn_vector_t& pdcp_sns) {}
+  void notify_failure(uint32_t lcid, const pdcp_sn_vector_t& pdcp_sns) {}
+
+  // RRC interface
+  void        max_retx_attempted() { nof_errors++; }
+  void        protocol_failure() { nof_errors++; }
+  const char* get_rb_name(uint32_t lcid) { return "DRB1"; }
+
+  uint32_t sdu_size   = 0;
+  uint64_t nof_sdus   = 0;
+  uint64_t nof_bytes  = 0;
+  uint32_t nof_errors = 0;
+};
+
+struct run_params {
+  uint32_t sdu_size;
+  uint32_t tb_size;   ///< TBs are drawn uniformly from [tb_size/2, tb_size], forcing re-segmentation on reTx
+  float    loss_rate; ///< Rate at which data PDUs are dropped
+  uint32_t nof_ttis;
+};
+
+struct run_data {
+  run_params                   params;
+  uint64_t                     nof_sdus;
+  float                        mbps;
+  std::chrono::duration<float> avg_tx_time;
+  std::chrono::duration<float> avg_rx_time;
+};
+
+/**
+ * Pushes full-buffer traffic of params.sdu_size SDUs from one RLC AM entity to its peer for params.nof_ttis TTIs, one
+ * TB per TTI, with status PDUs flowing back without loss. The time spent building (read_pdu) and handling (write_pdu)
+ * the data PDUs is measured, as well as the SDU throughput this processing alone would sustain
+ */
+int run_rlc_am_scenario(const run_params& params, std::vector<run_data>& run_results)
+{
+  rlc_am_bench_tester tester;
+  timer_handler       timers(8);
+  tester.sdu_size = params.sdu_size;
+
+  rlc_config_t cfg       = rlc_config_t::default_rlc_am_config();
+  cfg.am.max_retx_thresh = 32;
+
+  rlc_am_lte rlc_tx(srslog::fetch_basic_logger("RLC_AM_1"), 1, &tester, &tester, &timers);
+  rlc_am_lte rlc_rx(srslog::fetch_basic_logger("RLC_AM_2"), 1, &tester, &tester, &timers);
+  TESTASSERT(rlc_tx.configure(cfg) and rlc_rx.configure(cfg));
+
+  std::minstd_rand                        rand_gen(params.sdu_size + params.tb_size);
+  std::uniform_int_distribution<uint32_t> tb_dist(params.tb_size / 2, params.tb_size);
+  std::bernoulli_distribution             loss_dist(params.loss_rate);
+  std::vector<uint8_t>                    tb(params.tb_size), status(params.tb_size);
+  std::chrono::nanoseconds                tx_time{0}, rx_time{0};
+  uint32_t                                sdu_count = 0, nof_pdus = 0;
+
+  for (uint32_t t = 0; t < params.nof_ttis; ++t) {
+    // Keep a couple of TBs worth of SDUs queued
+    while (rlc_tx.get_buffer_state() < 2 * params.tb_size and not rlc_tx.sdu_queue_is_full()) {
+      unique_byte_buffer_t sdu = make_byte_buffer(params.sdu_size, (uint8_t)sdu_count);
+      TESTASSERT(sdu != nullptr);
+      sdu->md.pdcp_sn = sdu_count++ % 4096;
+      rlc_tx.write_sdu(std::move(sdu));
+    }
+
+    auto     tp_start = std::chrono::steady_clock::now();
+    uint32_t len      = rlc_tx.read_pdu(tb.data(), tb_dist(rand_gen));
+    auto     tp_mid   = std::chrono::steady_clock::now();
+    if (len > 0 and not loss_dist(rand_gen)) {
+      rlc_rx.write_pdu(tb.data(), len);
+    }
+    auto tp_end = std::chrono::steady_clock::now();
+    tx_time += std::chrono::duration_cast<std::chrono::nanoseconds>(tp_mid - tp_start);
+    rx_time += std::chrono::duration_cast<std::chrono::nanoseconds>(tp_end - tp_mid);
+    nof_pdus += len > 0 ? 1 : 0;
+
+    // Status PDUs are not lost
+    if (rlc_rx.get_buffer_state() > 0) {
+      len = rlc_rx.read_pdu(status.data(), status.size());
+      rlc_tx.write_pdu(status.data(), len);
+    }
+    timers.step_all();
+  }
+
+  // TEST: SDUs were delivered in order and without corruption
+  TESTASSERT(tester.nof_errors == 0);
+  TESTASSERT(tester.nof_sdus > 0);
+
+  run_data r;
+  r.params      = params;
+  r.nof_sdus    = tester.nof_sdus;
+  r.mbps        = tester.nof_bytes * 8 / std::chrono::duration<float>(tx_time + rx_time).count() / 1e6;
+  r.avg_tx_time = tx_time / std::max(nof_pdus, 1U);
+  r.avg_rx_time = rx_time / std::max(nof_pdus, 1U);
+  run_results.push_back(r);
+  return SRSRAN_SUCCESS;
+}
+
+void print_benchmark_results(const std::vector<run_data>& run_results)
+{
+  fmt::print("run | SDU [B] | TB [B] | loss [%] | SDUs rxed | Mbit/s | time/PDU tx/rx [usec]\n");
+  fmt::print("------------------------------------------------------------------------------\n");
+  for (uint32_t i = 0; i < run_results.size(); ++i) {
+    const run_data& r = run_results[i];
+    fmt::print("{:>3d}{:>10d}{:>9d}{:>11.1f}{:>12d}{:>9.0f}{:>15.2f}/{:>6.2f}\n",
+               i,
+               r.params.sdu_size,
+               r.params.tb_size,
+               r.params.loss_rate * 100,
+               r.nof_sdus,
+               r.mbps,
+               r.avg_tx_time.count() * 1e6,
+               r.avg_rx_time.count() * 1e6);
+  }
+}
+
+int run_benchmark(const std::vector<uint32_t>& sdu_size_list,
+                  const std::vector<uint32_t>& tb_size_list,
+                  const std::vector<float>&    loss_rate_list,
+                  uint32_t                     nof_ttis)
+{
+  std::vector<run_data> run_results;
+  for (uint32_t sdu_size : sdu_size_list) {
+    for (uint32_t tb_size : tb_size_list) {
+      for (float loss_rate : loss_rate_list) {
+        run_params params = {sdu_size, tb_size, loss_rate, nof_ttis};
+        TESTASSERT(run_rlc_am_scenario(params, run_results) == SRSRAN_SUCCESS);
+      }
+    }
+  }
+
+  print_benchmark_results(run_results);
+
+  return SRSRAN_SUCCESS;
+}
+
+} // namespace srsran
+
+int main(int argc, char* argv[])
+{
+  srslog::fetch_basic_logger("RLC_AM_1").set_level(srslog::basic_levels::none);
+  srslog::fetch_basic_logger("RLC_AM_2").set_level(srslog::basic_levels::none);
+  auto& test_logger = srslog::fetch_basic_logger("TEST");
+  test_logger.set_level(srslog::basic_levels::warning);
+
+  // Start the log backend.
+  srslog::init();
+
+  if (argc == 1 or strcmp(argv[1], "test") == 0) {
+    TESTASSERT(srsran::run_benchmark({100, 1500}, {1000}, {0, 0.1}, 2000) == SRSRAN_SUCCESS);
+  } else {
+    TESTASSERT(srsran::run_benchmark({40, 100, 500, 1500}, {300, 1500, 6000}, {0, 0.01, 0.1}, 20000) ==
+               SRSRAN_SUCCESS);
+  }
+
+  return 0;
+}
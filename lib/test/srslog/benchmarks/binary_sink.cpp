@@ -0,0 +1,95 @@
+/**
+ * Copyright 2013-2021 Software Radio Systems Limited
+ *
+ * This file is part of srsRAN.
+ *
+ * srsRAN is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsRAN is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+#include "src/srslog/formatters/binary_formatter.h"
+#include "src/srslog/formatters/text_formatter.h"
+#include "src/srslog/sinks/binary_file_sink.h"
+#include "src/srslog/sinks/buffered_file_sink.h"
+#include "srsran/srslog/detail/log_entry_metadata.h"
+#include <cstdio>
+
+using namespace srslog;
+
+static constexpr unsigned num_entries = 1000000;
+
+/// Formats and writes the entries with the given sink from the calling thread, measuring the work done by the backend
+/// for each entry.
+static void benchmark(const char* name, sink& s, const std::string& filename)
+{
+  fmt::dynamic_format_arg_store<fmt::printf_context> store;
+  fmt::memory_buffer                                 buffer;
+
+  auto begin = std::chrono::steady_clock::now();
+  for (unsigned i = 0; i != num_entries; ++i) {
+    store.clear();
+    store.push_back(i);
+    store.push_back(i * 0.5);
+    store.push_back("test");
+
+    detail::log_entry_metadata metadata = {std::chrono::high_resolution_clock::now(),
+                                           {i, true},
+                                           "SRSLOG binary sink benchmark: int: %u, double: %f, string: %s",
+                                           &store,
+                                           "BENCH",
+                                           'I'};
+    buffer.clear();
+    s.get_formatter().format(std::move(metadata), buffer);
+    s.write({buffer.data(), buffer.size()});
+  }
+  s.flush();
+  std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - begin;
+
+  size_t file_size = 0;
+  if (std::FILE* f = std::fopen(filename.c_str(), "rb")) {
+    std::fseek(f, 0, SEEK_END);
+    file_size = std::ftell(f);
+    std::fclose(f);
+  }
+
+  fmt::print("{:<7}| {:8.2f} | {:12.1f} | {:15.1f}\n",
+             name,
+             num_entries / elapsed.count() / 1e6,
+             elapsed.count() * 1e9 / num_entries,
+             static_cast<double>(file_size) / num_entries);
+}
+
+int main()
+{
+  std::string text_filename   = "srslog_binary_sink_benchmark.txt";
+  std::string binary_filename = "srslog_binary_sink_benchmark.bin";
+
+  fmt::print("SRSLOG Binary Sink Benchmark - {} entries formatted and written from one thread\n"
+             "sink   | Mentry/s | ns per entry | bytes per entry\n",
+             num_entries);
+  {
+    buffered_file_sink s(text_filename, 1024 * 1024, std::unique_ptr<log_formatter>(new text_formatter));
+    benchmark("text", s, text_filename);
+  }
+  {
+    binary_file_sink s(binary_filename,
+                       0,
+                       binary_file_sink::default_capacity,
+                       std::unique_ptr<binary_formatter>(new binary_formatter));
+    benchmark("binary", s, binary_filename);
+  }
+
+  return 0;
+}
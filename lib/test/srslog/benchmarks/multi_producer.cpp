@@ -0,0 +1,152 @@
+/**
+ * Copyright 2013-2021 Software Radio Systems Limited
+ *
+ * This file is part of srsRAN.
+ *
+ * srsRAN is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsRAN is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+#include "srsran/srslog/srslog.h"
+#include <algorithm>
+#include <atomic>
+#include <thread>
+
+using namespace srslog;
+
+static constexpr unsigned num_bursts            = 2000;
+static constexpr unsigned num_entries_per_burst = 40;
+
+/// Busy waits in the calling thread for the specified amount of time.
+static void busy_wait(std::chrono::microseconds interval)
+{
+  auto end = std::chrono::steady_clock::now() + interval;
+
+  while (std::chrono::steady_clock::now() < end) {
+  }
+}
+
+/// Worker function used for each producer thread of the benchmark. Entries are generated back to back in bursts
+/// separated by the given pause, and the average time taken by an entry is recorded for each burst.
+static void run_thread(log_channel&              c,
+                       std::chrono::microseconds pause,
+                       std::vector<uint64_t>&    results,
+                       std::atomic<unsigned>&    nof_ready,
+                       std::atomic<unsigned>&    nof_done)
+{
+  // Start all producers at once to maximize contention.
+  nof_ready.fetch_sub(1, std::memory_order_relaxed);
+  while (nof_ready.load(std::memory_order_relaxed)) {
+  }
+
+  for (unsigned burst = 0; burst != num_bursts; ++burst) {
+    auto begin = std::chrono::steady_clock::now();
+    for (unsigned entry_num = 0; entry_num != num_entries_per_burst; ++entry_num) {
+      double d = entry_num;
+      c("SRSLOG multi producer benchmark: int: %u, double: %f, string: %s", burst, d, "test");
+    }
+    auto end = std::chrono::steady_clock::now();
+
+    results.push_back(std::chrono::duration_cast<std::chrono::nanoseconds>(end - begin).count() /
+                      num_entries_per_burst);
+
+    busy_wait(pause);
+  }
+
+  nof_done.fetch_add(1, std::memory_order_relaxed);
+}
+
+/// This function runs the benchmark generating log entries from the specified number of threads at once, while the
+/// calling thread samples the queue depth. Without a pause the producers outpace the backend and the queue saturates.
+static void benchmark(log_channel& channel, unsigned num_threads, std::chrono::microseconds pause)
+{
+  std::vector<std::vector<uint64_t> > thread_results;
+  thread_results.resize(num_threads);
+  for (auto& v : thread_results) {
+    v.reserve(num_bursts);
+  }
+
+  // Let the backend drain the previous run.
+  srslog::flush();
+  uint64_t dropped_before = srslog::get_backend_metrics().nof_dropped_entries;
+
+  std::vector<std::thread> workers;
+  workers.reserve(num_threads);
+
+  std::atomic<unsigned> nof_ready(num_threads);
+  std::atomic<unsigned> nof_done(0);
+  auto                  begin = std::chrono::steady_clock::now();
+  for (unsigned i = 0; i != num_threads; ++i) {
+    workers.emplace_back(
+        run_thread, std::ref(channel), pause, std::ref(thread_results[i]), std::ref(nof_ready), std::ref(nof_done));
+  }
+
+  size_t max_depth = 0;
+  while (nof_done.load(std::memory_order_relaxed) != num_threads) {
+    max_depth = std::max(max_depth, srslog::get_backend_metrics().queue_depth);
+    std::this_thread::sleep_for(std::chrono::microseconds(50));
+  }
+  for (auto& w : workers) {
+    w.join();
+  }
+  std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - begin;
+
+  backend_metrics metrics = srslog::get_backend_metrics();
+  unsigned        total   = num_threads * num_bursts * num_entries_per_burst;
+
+  std::vector<uint64_t> results;
+  results.reserve(num_threads * num_bursts);
+  for (const auto& v : thread_results) {
+    results.insert(results.end(), v.begin(), v.end());
+  }
+  std::sort(results.begin(), results.end());
+
+  fmt::print("SRSLOG Multi Producer Benchmark - logging with {} thread{}, {} us pause between bursts\n"
+             "Throughput: {:.2f} Mentries/s\n"
+             "Latency in nanoseconds\n"
+             "Percentiles: | 50th | 75th | 90th | 99th | 99.9th | Worst |\n"
+             "             |{:6}|{:6}|{:6}|{:6}|{:8}|{:7}|\n"
+             "Dropped: {} of {} generated entries, max queue depth: {} of {}\n\n",
+             num_threads,
+             (num_threads > 1) ? "s" : "",
+             pause.count(),
+             total / elapsed.count() / 1e6,
+             results[static_cast<size_t>(results.size() * 0.5)],
+             results[static_cast<size_t>(results.size() * 0.75)],
+             results[static_cast<size_t>(results.size() * 0.9)],
+             results[static_cast<size_t>(results.size() * 0.99)],
+             results[static_cast<size_t>(results.size() * 0.999)],
+             results.back(),
+             metrics.nof_dropped_entries - dropped_before,
+             total,
+             max_depth,
+             metrics.queue_capacity);
+}
+
+int main()
+{
+  auto& s       = srslog::fetch_file_sink("srslog_multi_producer_benchmark.txt");
+  auto& channel = srslog::fetch_log_channel("bench", s, {});
+
+  srslog::init();
+
+  for (auto pause : {0, 500}) {
+    for (auto n : {1, 2, 4, 8}) {
+      benchmark(channel, n, std::chrono::microseconds(pause));
+    }
+  }
+
+  return 0;
+}
@@ -0,0 +1,348 @@
+/**
+ * Copyright 2013-2021 Software Radio Systems Limited
+ *
+ * This file is part of srsRAN.
+ *
+ * srsRAN is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsRAN is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+#include "file_test_utils.h"
+#include "src/srslog/formatters/binary_formatter.h"
+#include "src/srslog/formatters/binary_log_decoder.h"
+#include "src/srslog/formatters/json_formatter.h"
+#include "src/srslog/formatters/text_formatter.h"
+#include "src/srslog/sinks/binary_file_sink.h"
+#include "srsran/srslog/detail/log_entry_metadata.h"
+#include "testing_helpers.h"
+#include <fstream>
+#include <numeric>
+
+using namespace srslog;
+
+namespace {
+
+/// A sink that accumulates the written data into a string.
+class string_sink : public sink
+{
+public:
+  explicit string_sink(std::unique_ptr<log_formatter> f) : sink(std::move(f)) {}
+
+  detail::error_string write(detail::memory_buffer buffer) override
+  {
+    str.append(buffer.data(), buffer.size());
+    return {};
+  }
+
+  detail::error_string flush() override { return {}; }
+
+  const std::string& contents() const { return str; }
+
+private:
+  std::string str;
+};
+
+/// A user defined type that can only be rendered by its stream operator.
+struct custom_type {
+  int value;
+};
+
+std::ostream& operator<<(std::ostream& os, const custom_type& v)
+{
+  return os << "custom<" << v.value << ">";
+}
+
+DECLARE_METRIC("SNR", snr_t, float, "dB");
+DECLARE_METRIC("PWR", pwr_t, int, "dBm");
+DECLARE_METRIC_SET("RF", rf_set, snr_t, pwr_t);
+DECLARE_METRIC("Address", ip_addr_t, std::string, "");
+DECLARE_METRIC_LIST("Antennas", antenna_list_t, std::vector<rf_set>);
+DECLARE_METRIC_SET("ue_container", ue_set, ip_addr_t, antenna_list_t);
+DECLARE_METRIC_LIST("ue_list", ue_list_t, std::vector<ue_set>);
+using ctx_t = srslog::build_context_type<ue_list_t>;
+
+} // namespace
+
+/// Helper to build a log entry.
+static detail::log_entry_metadata build_log_entry_metadata(fmt::dynamic_format_arg_store<fmt::printf_context>* store,
+                                                           const char* fmtstring)
+{
+  // Create a time point 50000us from epoch.
+  using tp_ty = std::chrono::time_point<std::chrono::high_resolution_clock>;
+  tp_ty tp(std::chrono::microseconds(50000));
+
+  return {tp, {10, true}, fmtstring, store, "ABC", 'Z'};
+}
+
+/// Builds a context object filled in with some data.
+static ctx_t build_context()
+{
+  ctx_t ctx("Context");
+
+  ctx.get<ue_list_t>().emplace_back();
+  auto& ue = ctx.at<ue_list_t>(0);
+  ue.write<ip_addr_t>("10.20.30.40");
+  ue.get<antenna_list_t>().emplace_back();
+  ue.at<antenna_list_t>(0).write<snr_t>(5.1);
+  ue.at<antenna_list_t>(0).write<pwr_t>(-11);
+  ue.get<antenna_list_t>().emplace_back();
+  ue.at<antenna_list_t>(1).write<snr_t>(10.1);
+  ue.at<antenna_list_t>(1).write<pwr_t>(-20);
+
+  return ctx;
+}
+
+/// Formats the input entry with the input formatter and with the binary formatter, then decodes the binary output
+/// with the input formatter. Returns true when both outputs match.
+static bool check_round_trip(log_formatter&                    f,
+                             binary_formatter&                 binary,
+                             fmt::memory_buffer&               binary_log,
+                             const detail::log_entry_metadata& metadata,
+                             const ctx_t*                      ctx = nullptr)
+{
+  fmt::memory_buffer         expected;
+  detail::log_entry_metadata copy = metadata;
+  if (ctx) {
+    f.format_ctx(*ctx, std::move(copy), expected);
+  } else {
+    f.format(std::move(copy), expected);
+  }
+
+  fmt::memory_buffer encoded;
+  binary_format::put_file_header(encoded);
+  copy = metadata;
+  if (ctx) {
+    binary.format_ctx(*ctx, std::move(copy), binary_log);
+  } else {
+    binary.format(std::move(copy), binary_log);
+  }
+  encoded.append(binary_log.data(), binary_log.data() + binary_log.size());
+
+  string_sink        output(f.clone());
+  binary_log_decoder decoder;
+  ASSERT_EQ(decoder.decode(reinterpret_cast<const uint8_t*>(encoded.data()), encoded.size(), output).get_error(), "");
+  ASSERT_EQ(output.contents(), fmt::to_string(expected));
+
+  // Leave only the records that define strings for the next entries.
+  binary_log.clear();
+  binary.format_string_table(binary_log);
+
+  return true;
+}
+
+static bool when_log_entries_are_decoded_then_output_matches_text_and_json_formatters()
+{
+  std::unique_ptr<log_formatter> formatters[] = {std::unique_ptr<log_formatter>(new text_formatter),
+                                                 std::unique_ptr<log_formatter>(new json_formatter)};
+
+  for (auto& f : formatters) {
+    binary_formatter   binary;
+    fmt::memory_buffer binary_log;
+
+    fmt::dynamic_format_arg_store<fmt::printf_context> store;
+    store.push_back(-88);
+    store.push_back(88u);
+    store.push_back(-1234567890123ll);
+    store.push_back(1234567890123ull);
+    store.push_back(true);
+    store.push_back('c');
+    store.push_back(1.5f);
+    store.push_back(-2.25);
+    store.push_back(3.125l);
+    store.push_back("text");
+    store.push_back(std::string("string"));
+    store.push_back(reinterpret_cast<const void*>(0x1234));
+    auto entry = build_log_entry_metadata(&store, "%d %u %lld %llu %d %c %.2f %.3f %.4Lf %s %s %p");
+    ASSERT_EQ(check_round_trip(*f, binary, binary_log, entry), true);
+
+    // Entry with a hex dump, no context, no name and no tag.
+    entry.hex_dump.resize(20);
+    std::iota(entry.hex_dump.begin(), entry.hex_dump.end(), 0);
+    entry.context.enabled = false;
+    entry.log_name        = "";
+    entry.log_tag         = '\0';
+    ASSERT_EQ(check_round_trip(*f, binary, binary_log, entry), true);
+
+    // Entry without arguments keeps its format string as is.
+    auto no_args = build_log_entry_metadata(nullptr, "100%");
+    ASSERT_EQ(check_round_trip(*f, binary, binary_log, no_args), true);
+
+    // Context only and context with message entries.
+    auto ctx      = build_context();
+    auto ctx_only = build_log_entry_metadata(nullptr, nullptr);
+    ASSERT_EQ(check_round_trip(*f, binary, binary_log, ctx_only, &ctx), true);
+    fmt::dynamic_format_arg_store<fmt::printf_context> ctx_store;
+    ctx_store.push_back(7);
+    auto ctx_msg = build_log_entry_metadata(&ctx_store, "Message %d");
+    ASSERT_EQ(check_round_trip(*f, binary, binary_log, ctx_msg, &ctx), true);
+  }
+
+  return true;
+}
+
+static bool when_fmtstring_contents_change_then_entries_are_decoded_correctly()
+{
+  text_formatter     text;
+  binary_formatter   binary;
+  fmt::memory_buffer binary_log;
+
+  char fmtstring[16];
+  for (unsigned i = 0; i != 3; ++i) {
+    fmt::format_to_n(fmtstring, sizeof(fmtstring), "Msg{} %d{}", i, '\0');
+    fmt::dynamic_format_arg_store<fmt::printf_context> store;
+    store.push_back(i);
+    ASSERT_EQ(check_round_trip(text, binary, binary_log, build_log_entry_metadata(&store, fmtstring)), true);
+  }
+
+  return true;
+}
+
+static bool when_fmtstrings_are_built_at_run_time_then_string_table_is_bounded()
+{
+  text_formatter     text;
+  binary_formatter   binary;
+  fmt::memory_buffer binary_log;
+
+  // Equal contents in different buffers are defined once.
+  std::string first("Built %d"), second("Built %d");
+  binary.format(build_log_entry_metadata(nullptr, first.c_str()), binary_log);
+  size_t defined_size = binary_log.size();
+  binary_log.clear();
+  binary.format(build_log_entry_metadata(nullptr, second.c_str()), binary_log);
+  ASSERT_EQ(binary_log.size() < defined_size, true);
+
+  // Fill the string table with distinct format strings, each one in its own buffer.
+  std::vector<std::string> fmtstrings(binary_formatter::max_strings + 3);
+  for (size_t i = 0; i != binary_formatter::max_strings; ++i) {
+    fmtstrings[i] = fmt::format("Built {} %d", i);
+    binary_log.clear();
+    binary.format(build_log_entry_metadata(nullptr, fmtstrings[i].c_str()), binary_log);
+  }
+  binary_log.clear();
+  binary.format_string_table(binary_log);
+  size_t table_size = binary_log.size();
+
+  // New format strings are stored inline from now on.
+  for (unsigned i = 0; i != 3; ++i) {
+    std::string& fmtstring = fmtstrings[binary_formatter::max_strings + i];
+    fmtstring              = fmt::format("Inline {} %d", i);
+    fmt::dynamic_format_arg_store<fmt::printf_context> store;
+    store.push_back(i);
+    ASSERT_EQ(check_round_trip(text, binary, binary_log, build_log_entry_metadata(&store, fmtstring.c_str())), true);
+    ASSERT_EQ(binary_log.size(), table_size);
+  }
+
+  return true;
+}
+
+static bool when_argument_has_user_defined_type_then_message_is_rendered()
+{
+  text_formatter     text;
+  binary_formatter   binary;
+  fmt::memory_buffer binary_log;
+
+  fmt::dynamic_format_arg_store<fmt::printf_context> store;
+  store.push_back(1);
+  store.push_back(custom_type{2});
+  ASSERT_EQ(check_round_trip(text, binary, binary_log, build_log_entry_metadata(&store, "%d %s")), true);
+
+  return true;
+}
+
+static bool when_binary_log_is_truncated_then_complete_records_are_decoded()
+{
+  binary_formatter   binary;
+  fmt::memory_buffer encoded;
+  binary_format::put_file_header(encoded);
+  fmt::dynamic_format_arg_store<fmt::printf_context> store;
+  store.push_back(88);
+  binary.format(build_log_entry_metadata(&store, "Text %d"), encoded);
+  size_t first_size = encoded.size();
+  binary.format(build_log_entry_metadata(&store, "Text %d"), encoded);
+
+  string_sink        output(std::unique_ptr<log_formatter>(new text_formatter));
+  binary_log_decoder decoder;
+  auto err_str = decoder.decode(reinterpret_cast<const uint8_t*>(encoded.data()), encoded.size() - 1, output);
+  ASSERT_EQ(err_str.get_error(), fmt::format("Truncated record at offset {}", first_size));
+  ASSERT_EQ(output.contents(), "1970-01-01T00:00:00.050000 [ABC    ] [Z] [   10] Text 88\n");
+
+  string_sink not_binary(std::unique_ptr<log_formatter>(new text_formatter));
+  err_str = binary_log_decoder().decode(reinterpret_cast<const uint8_t*>("text log"), 8, not_binary);
+  ASSERT_EQ(err_str.get_error(), "Input is not a srslog binary log file");
+
+  return true;
+}
+
+/// Reads the whole contents of a file.
+static std::string read_file(const std::string& path)
+{
+  std::ifstream file(path, std::ios::binary);
+  return {std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>()};
+}
+
+static bool when_binary_file_sink_rotates_then_each_file_is_decoded_on_its_own()
+{
+  static constexpr char log_filename[] = "binary_formatter_test.log";
+  std::string           filename0      = file_utils::build_filename_with_index(log_filename, 0);
+  std::string           filename1      = file_utils::build_filename_with_index(log_filename, 1);
+  std::string           filename2      = file_utils::build_filename_with_index(log_filename, 2);
+  file_test_utils::scoped_file_deleter deleter = {filename0, filename1, filename2};
+
+  std::string expected;
+  {
+    // Use a write buffer smaller than the files to exercise both limits.
+    binary_file_sink file(log_filename, 5000, 1000, std::unique_ptr<binary_formatter>(new binary_formatter));
+    text_formatter   text;
+    for (unsigned i = 0; i != 320; ++i) {
+      fmt::dynamic_format_arg_store<fmt::printf_context> store;
+      store.push_back(i);
+      fmt::memory_buffer buffer;
+      file.get_formatter().format(build_log_entry_metadata(&store, (i % 2) ? "Odd %d" : "Even %d"), buffer);
+      ASSERT_EQ(file.write({buffer.data(), buffer.size()}).get_error(), "");
+      buffer.clear();
+      text.format(build_log_entry_metadata(&store, (i % 2) ? "Odd %d" : "Even %d"), buffer);
+      expected += fmt::to_string(buffer);
+    }
+    ASSERT_EQ(file.flush().get_error(), "");
+  }
+
+  ASSERT_EQ(file_test_utils::file_exists(filename2), true);
+  std::string decoded;
+  for (const auto& filename : {filename0, filename1, filename2}) {
+    std::string contents = read_file(filename);
+    ASSERT_EQ(contents.size() <= 5000, true);
+
+    string_sink        output(std::unique_ptr<log_formatter>(new text_formatter));
+    binary_log_decoder decoder;
+    ASSERT_EQ(decoder.decode(reinterpret_cast<const uint8_t*>(contents.data()), contents.size(), output).get_error(),
+              "");
+    decoded += output.contents();
+  }
+  ASSERT_EQ(decoded, expected);
+
+  return true;
+}
+
+int main()
+{
+  TEST_FUNCTION(when_log_entries_are_decoded_then_output_matches_text_and_json_formatters);
+  TEST_FUNCTION(when_fmtstring_contents_change_then_entries_are_decoded_correctly);
+  TEST_FUNCTION(when_fmtstrings_are_built_at_run_time_then_string_table_is_bounded);
+  TEST_FUNCTION(when_argument_has_user_defined_type_then_message_is_rendered);
+  TEST_FUNCTION(when_binary_log_is_truncated_then_complete_records_are_decoded);
+  TEST_FUNCTION(when_binary_file_sink_rotates_then_each_file_is_decoded_on_its_own);
+
+  return 0;
+}
@@ -233,6 +233,39 @@ static bool when_empty_handler_is_used_then_backend_does_not_crash()
   return true;
 }
 
+static bool when_arg_stores_and_queue_are_exhausted_then_entries_are_dropped_and_counted()
+{
+  sink_spy         spy;
+  log_backend_impl backend;
+  backend.set_error_handler({});
+
+  // Fill the queue with the backend stopped.
+  for (unsigned i = 0; i != SRSLOG_QUEUE_CAPACITY; ++i) {
+    auto* store = backend.alloc_arg_store();
+    ASSERT_NE(store, nullptr);
+    ASSERT_EQ(backend.push(build_log_entry(&spy, store)), true);
+  }
+  ASSERT_EQ(backend.alloc_arg_store(), nullptr);
+  ASSERT_EQ(backend.push(build_log_entry(&spy, nullptr)), false);
+
+  auto metrics = backend.get_metrics();
+  ASSERT_EQ(metrics.nof_dropped_entries, 2);
+  ASSERT_EQ(metrics.queue_depth, SRSLOG_QUEUE_CAPACITY);
+  ASSERT_EQ(metrics.queue_capacity, SRSLOG_QUEUE_CAPACITY);
+
+  // Stop the backend to ensure the entries have been processed and the arg stores returned.
+  backend.start();
+  backend.stop();
+
+  ASSERT_EQ(spy.write_invocation_count(), SRSLOG_QUEUE_CAPACITY);
+  ASSERT_EQ(backend.get_metrics().queue_depth, 0);
+  for (unsigned i = 0; i != SRSLOG_QUEUE_CAPACITY; ++i) {
+    ASSERT_NE(backend.alloc_arg_store(), nullptr);
+  }
+
+  return true;
+}
+
 int main()
 {
   TEST_FUNCTION(when_backend_is_started_then_is_started_returns_true);
@@ -243,6 +276,7 @@ int main()
   TEST_FUNCTION(when_sink_write_fails_then_error_handler_is_invoked);
   TEST_FUNCTION(when_handler_is_set_after_start_then_handler_is_not_used);
   TEST_FUNCTION(when_empty_handler_is_used_then_backend_does_not_crash);
+  TEST_FUNCTION(when_arg_stores_and_queue_are_exhausted_then_entries_are_dropped_and_counted);
 
   return 0;
 }
@@ -0,0 +1,131 @@
+/**
+ * Copyright 2013-2021 Software Radio Systems Limited
+ *
+ * This file is part of srsRAN.
+ *
+ * srsRAN is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsRAN is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+#include "srsran/srslog/detail/support/work_queue.h"
+#include "testing_helpers.h"
+#include <thread>
+#include <vector>
+
+using namespace srslog;
+
+static bool when_queue_is_full_then_push_fails_and_drop_is_counted()
+{
+  detail::work_queue<int, 4> queue;
+
+  for (int i = 0; i != 4; ++i) {
+    ASSERT_EQ(queue.push(i), true);
+  }
+  ASSERT_EQ(queue.size(), 4);
+  ASSERT_EQ(queue.push(4), false);
+  ASSERT_EQ(queue.get_nof_dropped(), 1);
+
+  auto item = queue.try_pop();
+  ASSERT_EQ(item.first, true);
+  ASSERT_EQ(item.second, 0);
+  ASSERT_EQ(queue.push(5), true);
+  ASSERT_EQ(queue.size(), 4);
+  ASSERT_EQ(queue.get_nof_dropped(), 1);
+
+  return true;
+}
+
+static bool when_queue_is_empty_then_pop_fails()
+{
+  detail::work_queue<int, 4> queue;
+
+  ASSERT_EQ(queue.try_pop().first, false);
+  ASSERT_EQ(queue.try_pop_batch([](int) {}, 4), 0);
+  ASSERT_EQ(queue.size(), 0);
+
+  return true;
+}
+
+static bool when_popping_in_batches_then_elements_are_received_in_order()
+{
+  detail::work_queue<int, 8> queue;
+  std::vector<int>           received;
+
+  // Wrap around the end of the ring several times.
+  int next = 0;
+  for (unsigned round = 0; round != 5; ++round) {
+    for (unsigned i = 0; i != 6; ++i) {
+      ASSERT_EQ(queue.push(next++), true);
+    }
+    ASSERT_EQ(queue.try_pop_batch([&received](int v) { received.push_back(v); }, 4), 4);
+    ASSERT_EQ(queue.try_pop_batch([&received](int v) { received.push_back(v); }, 4), 2);
+  }
+
+  ASSERT_EQ(received.size(), size_t(next));
+  for (int i = 0; i != next; ++i) {
+    ASSERT_EQ(received[i], i);
+  }
+
+  return true;
+}
+
+static bool when_multiple_producers_push_then_all_elements_are_received_in_producer_order()
+{
+  constexpr unsigned nof_producers = 4;
+  constexpr unsigned nof_elements  = 100000;
+
+  detail::work_queue<std::pair<unsigned, unsigned>, 64> queue;
+
+  std::vector<std::thread> producers;
+  for (unsigned p = 0; p != nof_producers; ++p) {
+    producers.emplace_back([&queue, p]() {
+      for (unsigned i = 0; i != nof_elements; ++i) {
+        while (!queue.push(std::make_pair(p, i))) {
+          std::this_thread::yield();
+        }
+      }
+    });
+  }
+
+  std::vector<unsigned> next(nof_producers, 0);
+  bool                  in_order = true;
+  unsigned              count    = 0;
+  while (count != nof_producers * nof_elements) {
+    count += queue.try_pop_batch(
+        [&next, &in_order](std::pair<unsigned, unsigned> v) { in_order &= (v.second == next[v.first]++); }, 16);
+  }
+
+  for (auto& t : producers) {
+    t.join();
+  }
+
+  ASSERT_EQ(in_order, true);
+  for (unsigned p = 0; p != nof_producers; ++p) {
+    ASSERT_EQ(next[p], nof_elements);
+  }
+  ASSERT_EQ(queue.try_pop().first, false);
+
+  return true;
+}
+
+int main()
+{
+  TEST_FUNCTION(when_queue_is_full_then_push_fails_and_drop_is_counted);
+  TEST_FUNCTION(when_queue_is_empty_then_pop_fails);
+  TEST_FUNCTION(when_popping_in_batches_then_elements_are_received_in_order);
+  TEST_FUNCTION(when_multiple_producers_push_then_all_elements_are_received_in_producer_order);
+
+  return 0;
+}
@@ -0,0 +1,222 @@
+/**
+ * Copyright 2013-2021 Software Radio Systems Limited
+ *
+ * This file is part of srsRAN.
+ *
+ * srsRAN is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsRAN is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+#ifndef SRSENB_RNTI_TABLE_H
+#define SRSENB_RNTI_TABLE_H
+
+#include "srsran/adt/detail/type_storage.h"
+#include "srsran/support/srsran_assert.h"
+#include <array>
+#include <atomic>
+#include <thread>
+
+namespace srsenb {
+
+/**
+ * Fixed-capacity table of objects indexed by RNTI, that can be looked up concurrently without a global lock.
+ *
+ * As in rnti_map_t, the object of a given RNTI lives in the slot with index rnti % N. Each slot keeps its state in a
+ * single atomic word, stored in its own cache line, with the RNTI of the slot, its occupancy flags and the number of
+ * readers that currently hold a reference to the object. Lookups pin the object by incrementing the readers count with
+ * a CAS that also checks the RNTI, so a reference always points to the object of the requested RNTI. Removal first
+ * hides the object from new lookups and then waits for the existing references to be released before destroying it.
+ *
+ * Insertions and removals may be called from any thread. Removal blocks until all references to the object have been
+ * released, so it must not be called by a thread that holds a reference to the same object.
+ */
+template <typename T, size_t N>
+class rnti_table
+{
+  static const uint64_t READERS_MASK = 0xffffffffu;
+  static const uint64_t USED_FLAG    = 1ull << 32; ///< Slot is owned by an RNTI
+  static const uint64_t VALID_FLAG   = 1ull << 33; ///< Object is constructed and can be looked up
+  static const int      RNTI_SHIFT   = 48;
+
+  static uint64_t rnti_tag(uint16_t rnti) { return static_cast<uint64_t>(rnti) << RNTI_SHIFT; }
+  static uint16_t slot_rnti(uint64_t state) { return static_cast<uint16_t>(state >> RNTI_SHIFT); }
+
+  struct slot_t {
+    std::atomic<uint64_t>           state{0};
+    // Keep the state words of consecutive slots in different cache lines
+    char                            pad[64 - sizeof(std::atomic<uint64_t>)];
+    srsran::detail::type_storage<T> obj;
+  };
+
+  // Pins the object of the slot if it is valid and belongs to the given RNTI
+  static bool try_acquire(slot_t& slot, uint16_t rnti)
+  {
+    uint64_t s = slot.state.load(std::memory_order_relaxed);
+    do {
+      if ((s & VALID_FLAG) == 0 or slot_rnti(s) != rnti) {
+        return false;
+      }
+    } while (not slot.state.compare_exchange_weak(s, s + 1, std::memory_order_acquire, std::memory_order_relaxed));
+    return true;
+  }
+
+  static void release(slot_t& slot) { slot.state.fetch_sub(1, std::memory_order_release); }
+
+public:
+  using key_type    = uint16_t;
+  using mapped_type = T;
+
+  /// Reference to an object of the table. The object is not destroyed while the reference is held
+  class ptr
+  {
+  public:
+    ptr() = default;
+    ptr(ptr&& other) noexcept : slot(other.slot) { other.slot = nullptr; }
+    ptr(const ptr&) = delete;
+    ~ptr() { reset(); }
+    ptr& operator=(ptr&& other) noexcept
+    {
+      if (this != &other) {
+        reset();
+        slot       = other.slot;
+        other.slot = nullptr;
+      }
+      return *this;
+    }
+    ptr& operator=(const ptr&) = delete;
+
+    void reset()
+    {
+      if (slot != nullptr) {
+        release(*slot);
+        slot = nullptr;
+      }
+    }
+
+    explicit operator bool() const { return slot != nullptr; }
+    T&       operator*() const
+    {
+      srsran_assert(slot != nullptr, "Dereferencing empty rnti_table reference");
+      return slot->obj.get();
+    }
+    T* operator->() const { return &operator*(); }
+
+  private:
+    friend class rnti_table<T, N>;
+    explicit ptr(slot_t* slot_) : slot(slot_) {}
+
+    slot_t* slot = nullptr;
+  };
+
+  rnti_table() = default;
+  rnti_table(const rnti_table&) = delete;
+  rnti_table& operator=(const rnti_table&) = delete;
+  ~rnti_table() { clear(); }
+
+  /// Looks up the object of the given RNTI. Returns an empty reference if the RNTI is not in the table
+  ptr find(uint16_t rnti)
+  {
+    slot_t& slot = slots[rnti % N];
+    return try_acquire(slot, rnti) ? ptr(&slot) : ptr();
+  }
+
+  bool contains(uint16_t rnti) const
+  {
+    uint64_t s = slots[rnti % N].state.load(std::memory_order_acquire);
+    return (s & VALID_FLAG) != 0 and slot_rnti(s) == rnti;
+  }
+
+  /// Constructs the object of the given RNTI in place. Fails if the slot of the RNTI is taken
+  template <typename... Args>
+  bool emplace(uint16_t rnti, Args&&... args)
+  {
+    slot_t&  slot     = slots[rnti % N];
+    uint64_t expected = 0;
+    if (not slot.state.compare_exchange_strong(
+            expected, rnti_tag(rnti) | USED_FLAG, std::memory_order_acquire, std::memory_order_relaxed)) {
+      return false;
+    }
+    slot.obj.emplace(std::forward<Args>(args)...);
+    slot.state.store(rnti_tag(rnti) | USED_FLAG | VALID_FLAG, std::memory_order_release);
+    count.fetch_add(1, std::memory_order_relaxed);
+    return true;
+  }
+
+  bool insert(uint16_t rnti, T&& obj) { return emplace(rnti, std::move(obj)); }
+
+  /// Removes the object of the given RNTI, waiting for all its references to be released
+  bool erase(uint16_t rnti)
+  {
+    slot_t&  slot = slots[rnti % N];
+    uint64_t s    = slot.state.load(std::memory_order_relaxed);
+    do {
+      if ((s & VALID_FLAG) == 0 or slot_rnti(s) != rnti) {
+        return false;
+      }
+    } while (not slot.state.compare_exchange_weak(s, s & ~VALID_FLAG, std::memory_order_relaxed));
+
+    // No new references can be taken from now on. Wait for the existing ones to go away
+    while ((slot.state.load(std::memory_order_acquire) & READERS_MASK) != 0) {
+      std::this_thread::yield();
+    }
+    slot.obj.destroy();
+    count.fetch_sub(1, std::memory_order_relaxed);
+    slot.state.store(0, std::memory_order_release);
+    return true;
+  }
+
+  void clear()
+  {
+    for (slot_t& slot : slots) {
+      uint64_t s = slot.state.load(std::memory_order_acquire);
+      if ((s & VALID_FLAG) != 0) {
+        erase(slot_rnti(s));
+      }
+    }
+  }
+
+  /// Calls f(rnti, obj) for every object in the table, holding a reference to each object during the call
+  template <typename F>
+  void for_each(F&& f)
+  {
+    for (slot_t& slot : slots) {
+      uint64_t s = slot.state.load(std::memory_order_relaxed);
+      if ((s & VALID_FLAG) == 0) {
+        continue;
+      }
+      uint16_t rnti = slot_rnti(s);
+      if (try_acquire(slot, rnti)) {
+        f(rnti, slot.obj.get());
+        release(slot);
+      }
+    }
+  }
+
+  /// Whether the slot of the given RNTI is free. The result may be outdated by concurrent insertions
+  bool has_space(uint16_t rnti) const { return slots[rnti % N].state.load(std::memory_order_relaxed) == 0; }
+
+  size_t size() const { return count.load(std::memory_order_relaxed); }
+  bool   empty() const { return size() == 0; }
+  bool   full() const { return size() == N; }
+  size_t capacity() const { return N; }
+
+private:
+  std::array<slot_t, N> slots;
+  std::atomic<size_t>   count{0};
+};
+
+} // namespace srsenb
+
+#endif // SRSENB_RNTI_TABLE_H
@@ -50,9 +50,10 @@ private:
   std::string float_to_string(float f, int digits, int field_width = 6);
   std::string float_to_eng_string(float f, int digits);
 
-  std::atomic<bool>      do_print  = {false};
-  uint8_t                n_reports = 0;
-  enb_metrics_interface* enb       = nullptr;
+  std::atomic<bool>      do_print         = {false};
+  uint8_t                n_reports        = 0;
+  enb_metrics_interface* enb              = nullptr;
+  uint64_t               pcap_nof_dropped = 0;
 };
 
 } // namespace srsenb
@@ -68,6 +68,7 @@ public:
     uint32_t                    pusch_max_its    = 10;
     float                       pusch_min_snr_dB = -10.0f;
     double                      srate_hz         = 0.0;
+    srsran_sch_cb_pool_t*       ldpc_pool        = nullptr; ///< Optional PUSCH code block decoder threads
   };
 
   slot_worker(srsran::phy_common_interface& common_,
@@ -98,16 +98,19 @@ private:
   prach_stack_adaptor_t                      prach_stack_adaptor;
   uint32_t                                   nof_prach_workers = 0;
   double                                     srate_hz          = 0.0; ///< Current sampling rate in Hz
+  srsran_sch_cb_pool_t                       ldpc_pool         = {};  ///< PUSCH code block decoder threads
+  bool                                       ldpc_enabled      = false;
 
 public:
   struct args_t {
-    double                 srate_hz          = 0.0;
-    uint32_t               nof_phy_threads   = 3;
-    uint32_t               nof_prach_workers = 0;
-    uint32_t               prio              = 52;
-    uint32_t               pusch_max_its     = 10;
-    float                  pusch_min_snr_dB  = -10;
-    srsran::phy_log_args_t log               = {};
+    double                 srate_hz           = 0.0;
+    uint32_t               nof_phy_threads    = 3;
+    uint32_t               nof_prach_workers  = 0;
+    uint32_t               prio               = 52;
+    uint32_t               pusch_max_its      = 10;
+    uint32_t               pusch_ldpc_threads = 0;
+    float                  pusch_min_snr_dB   = -10;
+    srsran::phy_log_args_t log                = {};
   };
   slot_worker* operator[](std::size_t pos) { return workers.at(pos).get(); }
 
@@ -115,6 +118,7 @@ public:
               stack_interface_phy_nr&       stack,
               srslog::sink&                 log_sink,
               uint32_t                      max_workers);
+  ~worker_pool();
   bool         init(const args_t& args, const phy_cell_cfg_list_nr_t& cell_list);
   slot_worker* wait_worker(uint32_t tti);
   slot_worker* wait_worker_id(uint32_t id);
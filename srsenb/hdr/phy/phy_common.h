@@ -45,6 +45,7 @@ class phy_common : public srsran::phy_common_interface
 {
 public:
   phy_common() = default;
+  ~phy_common();
 
   bool init(const phy_cell_cfg_list_t&    cell_list_,
             const phy_cell_cfg_list_nr_t& cell_list_nr_,
@@ -240,6 +241,12 @@ public:
   void set_ul_grants(uint32_t tti, const stack_interface_phy_lte::ul_sched_list_t& ul_grants);
   void clear_grants(uint16_t rnti);
 
+  /**
+   * Returns the PUSCH code block decoding pool shared by all carrier workers, or nullptr when parallel code block
+   * decoding is disabled (expert.pusch_tdec_threads = 0)
+   */
+  srsran_sch_cb_pool_t* get_tdec_pool() { return tdec_enabled ? &tdec_pool : nullptr; }
+
 private:
   // Common objects for scheduling grants
   srsran::circular_array<stack_interface_phy_lte::ul_sched_list_t, TTIMOD_SZ> ul_grants   = {};
@@ -259,6 +266,8 @@ private:
   uint8_t                 mcch_table[10]   = {};
   uint32_t                mch_period_stop  = 0;
   srsran::rf_buffer_t     tx_buffer        = {};
+  srsran_sch_cb_pool_t    tdec_pool        = {};
+  bool                    tdec_enabled     = false;
   bool                    is_mch_subframe(srsran_mbsfn_cfg_t* cfg, uint32_t phy_tti);
   bool                    is_mcch_subframe(srsran_mbsfn_cfg_t* cfg, uint32_t phy_tti);
 };
@@ -67,6 +67,7 @@ struct phy_args_t {
   uint32_t                pusch_max_its       = 10;
   uint32_t                nr_pusch_max_its    = 10;
   bool                    pusch_8bit_decoder  = false;
+  uint32_t                pusch_tdec_threads  = 0;
   float                   tx_amplitude        = 1.0f;
   uint32_t                nof_phy_threads     = 1;
   std::string             equalizer_mode      = "mmse";
@@ -76,10 +77,13 @@ struct phy_args_t {
   bool                    pusch_meas_ta       = true;
   bool                    pucch_meas_ta       = true;
   uint32_t                nof_prach_threads   = 1;
+  bool                    prach_lockfree_pool = false;
   bool                    extended_cp         = false;
   srsran::channel::args_t dl_channel_args;
   srsran::channel::args_t ul_channel_args;
 
+  uint32_t nr_pusch_ldpc_threads = 0;
+
   srsran::vnf_args_t vnf_args;
 };
 
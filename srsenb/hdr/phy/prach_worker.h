@@ -24,10 +24,13 @@
 
 #include "srsran/common/block_queue.h"
 #include "srsran/common/buffer_pool.h"
+#include "srsran/common/thread_pool.h"
 #include "srsran/common/threads.h"
 #include "srsran/interfaces/enb_phy_interfaces.h"
 #include "srsran/srslog/srslog.h"
 #include <atomic>
+#include <condition_variable>
+#include <mutex>
 
 // Setting ENABLE_PRACH_GUI to non zero enables a GUI showing signal received in the PRACH window.
 #define ENABLE_PRACH_GUI 0
@@ -43,8 +46,8 @@ class stack_interface_phy_lte;
 class prach_worker : srsran::thread
 {
 public:
-  prach_worker(uint32_t cc_idx_, srslog::basic_logger& logger) :
-    buffer_pool(8), thread("PRACH_WORKER"), logger(logger), running(false)
+  prach_worker(uint32_t cc_idx_, srslog::basic_logger& logger, srsran::buffer_pool_mode pool_mode) :
+    buffer_pool(8, pool_mode), thread("PRACH_WORKER"), logger(logger), running(false)
   {
     cc_idx = cc_idx_;
   }
@@ -69,6 +72,22 @@ private:
   srsran_prach_cfg_t prach_cfg = {};
   srsran_prach_t     prach     = {};
 
+  /// Searches a share of the root sequences of every occasion, in parallel with the worker thread
+  struct root_helper {
+    srsran_prach_t prach        = {};
+    uint32_t       root_begin   = 0;
+    uint32_t       root_end     = 0;
+    uint32_t       nof_det      = 0;
+    uint32_t       indices[165] = {};
+    float          offsets[165] = {};
+    float          p2avg[165]   = {};
+  };
+  std::vector<std::unique_ptr<root_helper> > helpers;
+  std::unique_ptr<srsran::task_thread_pool>  helper_pool;
+  std::mutex                                 helper_mutex;
+  std::condition_variable                    helper_cvar;
+  uint32_t                                   nof_pending_helpers = 0;
+
 #if defined(ENABLE_GUI) and ENABLE_PRACH_GUI
   plot_real_t                              plot_real;
   std::array<float, 3 * SRSRAN_SF_LEN_MAX> plot_buffer;
@@ -106,6 +125,8 @@ private:
 
   void run_thread() final;
   int  run_tti(sf_buffer* b);
+  int  init_helpers(int priority);
+  int  detect_parallel(sf_buffer* b, uint32_t* nof_det);
 };
 
 class prach_worker_pool
@@ -123,11 +144,12 @@ public:
             stack_interface_phy_lte*  mac,
             srslog::basic_logger&     logger,
             int                       priority,
-            uint32_t                  nof_workers_x_cc)
+            uint32_t                  nof_workers_x_cc,
+            srsran::buffer_pool_mode  pool_mode = srsran::buffer_pool_mode::locked)
   {
     // Create PRACH worker if required
     while (cc_idx >= prach_vec.size()) {
-      prach_vec.push_back(std::unique_ptr<prach_worker>(new prach_worker(prach_vec.size(), logger)));
+      prach_vec.push_back(std::unique_ptr<prach_worker>(new prach_worker(prach_vec.size(), logger, pool_mode)));
     }
 
     prach_vec[cc_idx]->init(cell_, prach_cfg_, mac, priority, nof_workers_x_cc);
@@ -33,6 +33,7 @@ namespace srsenb {
 typedef struct {
   bool        enable;
   std::string filename;
+  bool        pcapng;
 } pcap_args_t;
 
 typedef struct {
@@ -71,6 +72,7 @@ typedef struct {
 typedef struct {
   uint32_t         sync_queue_size; // Max allowed difference between PHY and Stack clocks (in TTI)
   uint32_t         gtpu_indirect_tunnel_timeout_msec;
+  uint32_t         gtpu_io_batch_size;
   mac_args_t       mac;
   s1ap_args_t      s1ap;
   pcap_args_t      mac_pcap;
@@ -50,6 +50,10 @@ struct mac_ue_metrics_t {
   float    pucch_sinr;
   float    ul_rssi;
   float    fec_iters;
+  uint32_t fec_max_iters; ///< Maximum LDPC iterations of a PUSCH code block
+  uint32_t fec_nof_cb;    ///< Number of decoded PUSCH code blocks
+  uint32_t fec_cb_errors; ///< Number of decoded PUSCH code blocks with CRC KO
+  float    fec_time_us;   ///< Average PUSCH code block decoding time per transport block
   float    dl_mcs;
   int      dl_mcs_samples;
   float    ul_mcs;
@@ -23,8 +23,10 @@
 #define SRSENB_MAC_H
 
 #include "sched.h"
+#include "mch_sched.h"
 #include "sched_interface.h"
 #include "srsenb/hdr/common/rnti_pool.h"
+#include "srsenb/hdr/common/rnti_table.h"
 #include "srsenb/hdr/stack/mac/schedulers/sched_time_rr.h"
 #include "srsran/adt/circular_map.h"
 #include "srsran/adt/pool/batch_mem_pool.h"
@@ -80,7 +82,8 @@ public:
   {
     scheduler.set_dl_tti_mask(tti_mask, nof_sfs);
   }
-  void build_mch_sched(uint32_t tbs);
+  void build_mch_sched();
+  int  get_mch_sched_tbs(uint32_t mcs_idx);
 
   /******** Interface from RRC (RRC -> MAC) ****************/
   /* Provides cell configuration including SIB periodicity, etc. */
@@ -115,15 +118,15 @@ public:
                   const uint8_t              mcch_payload_length) override;
 
 private:
-  bool     check_ue_active(uint16_t rnti);
-  uint16_t allocate_ue(uint32_t enb_cc_idx);
-  bool     is_valid_rnti_unprotected(uint16_t rnti);
+  // UE contexts are looked up by the PHY workers without a global lock. A reference to a UE context returned by
+  // ue_db.find() keeps it alive until it goes out of scope
+  using ue_db_t = rnti_table<unique_rnti_ptr<ue>, SRSENB_MAX_UES>;
 
-  srslog::basic_logger& logger;
+  ue_db_t::ptr find_active_ue(uint16_t rnti);
+  uint16_t     allocate_ue(uint32_t enb_cc_idx);
+  bool         is_valid_rnti(uint16_t rnti);
 
-  // We use a rwlock in MAC to allow multiple workers to access MAC simultaneously. No conflicts will happen since
-  // access for different TTIs
-  pthread_rwlock_t rwlock = {};
+  srslog::basic_logger& logger;
 
   // Interaction with PHY
   phy_interface_stack_lte*      phy_h = nullptr;
@@ -137,18 +140,19 @@ private:
   // derived from args
   srsran::task_multiqueue::queue_handle stack_task_queue;
 
-  bool started = false;
+  std::atomic<bool> started{false};
 
   /* Scheduler unit */
   sched                                    scheduler;
   std::vector<sched_interface::cell_cfg_t> cell_config;
 
   sched_interface::dl_pdu_mch_t mch = {};
+  mch_sched                     mch_scheduler{logger};
 
   /* Map of active UEs */
-  static const uint16_t            FIRST_RNTI = 0x46;
-  rnti_map_t<unique_rnti_ptr<ue> > ue_db;
-  std::atomic<uint16_t>            ue_counter{0};
+  static const uint16_t FIRST_RNTI = 0x46;
+  ue_db_t               ue_db;
+  std::atomic<uint16_t> ue_counter{0};
 
   uint8_t* assemble_rar(sched_interface::dl_sched_rar_grant_t* grants,
                         uint32_t                               enb_cc_idx,
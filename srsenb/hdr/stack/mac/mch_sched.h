@@ -0,0 +1,124 @@
+/**
+ * Copyright 2013-2021 Software Radio Systems Limited
+ *
+ * This file is part of srsRAN.
+ *
+ * srsRAN is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsRAN is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+#ifndef SRSENB_MCH_SCHED_H
+#define SRSENB_MCH_SCHED_H
+
+#include "srsran/srslog/srslog.h"
+#include <array>
+#include <atomic>
+#include <vector>
+
+namespace srsenb {
+
+/**
+ * MCH scheduler of an MBSFN area.
+ *
+ * The subframes of the common subframe allocation (CSA) period are split among the PMCHs of the area, as signalled by
+ * their sf_alloc_end. At the start of every MCH scheduling period, each PMCH shares its subframes among its MTCHs with
+ * deficit round robin, using the RLC buffer state of each MTCH as demand. The MTCHs of a PMCH are laid out in
+ * consecutive subframes in MCCH order, and the MSI carries, for each MTCH, the last subframe it occupies relative to
+ * the first subframe of the PMCH. The first subframe of each PMCH carries the MSI (and the MCCH, for the first PMCH)
+ * and no MTCH data.
+ */
+class mch_sched
+{
+public:
+  /// Maximum number of MTCHs per PMCH, bounded by the MSI entries of sched_interface::dl_pdu_mch_t
+  static const uint32_t MAX_MTCH_PER_PMCH = 8;
+  static const uint32_t MAX_MTCH_LCID     = 28;
+  /// Stop of an MTCH that is not scheduled in the period (TS 36.321, 6.1.3.7)
+  static const uint32_t MTCH_STOP_EMPTY = 2047;
+
+  struct pmch_cfg_t {
+    uint32_t              sf_alloc_end = 0; ///< Last subframe of the PMCH in the CSA period
+    uint32_t              sf_bytes     = 0; ///< MTCH bytes that fit in a subframe of the PMCH
+    std::vector<uint32_t> lcids;            ///< MTCHs of the PMCH, in MCCH order
+  };
+
+  /// MSI entry of an MTCH. A stop of MTCH_STOP_EMPTY means the MTCH is not scheduled in the period
+  struct msi_entry_t {
+    uint32_t lcid;
+    uint32_t stop;
+  };
+
+  struct sf_alloc_t {
+    enum class type_t { none, msi, mtch } type = type_t::none;
+    uint32_t pmch_idx                          = 0;
+    uint32_t lcid                              = 0;
+  };
+
+  /// Subframe usage of the last scheduled period
+  struct period_metrics_t {
+    uint32_t nof_data_sfs  = 0; ///< Subframes available to MTCHs
+    uint32_t nof_alloc_sfs = 0; ///< Subframes allocated to MTCHs
+  };
+
+  explicit mch_sched(srslog::basic_logger& logger_) : logger(logger_) {}
+
+  void set_cfg(const std::vector<pmch_cfg_t>& cfg);
+  void clear_cfg();
+  bool is_configured() const { return not pmchs.empty(); }
+
+  /// Called from the RLC with the pending bytes of an MTCH
+  void set_buffer_state(uint32_t lcid, uint32_t tx_queue);
+  uint32_t get_buffer_state(uint32_t lcid) const;
+
+  /// Samples the MTCH buffer states and computes the subframe allocation of all PMCHs for a new scheduling period
+  void new_sched_period();
+
+  uint32_t                        nof_pmchs() const { return pmchs.size(); }
+  const pmch_cfg_t&               get_pmch_cfg(uint32_t pmch_idx) const { return pmchs[pmch_idx].cfg; }
+  const std::vector<msi_entry_t>& get_msi(uint32_t pmch_idx) const { return pmchs[pmch_idx].msi; }
+
+  /// Allocation of the subframe with index sf_idx in the CSA period
+  sf_alloc_t get_sf_alloc(uint32_t sf_idx) const;
+
+  /// Index of the last subframe of the CSA period that carries MSI or MTCH data
+  uint32_t get_last_alloc_sf() const;
+
+  const period_metrics_t& get_period_metrics() const { return metrics; }
+
+private:
+  struct mtch_t {
+    uint32_t lcid    = 0;
+    uint32_t nof_sfs = 0;
+    int64_t  deficit = 0;
+  };
+  struct pmch_t {
+    pmch_cfg_t               cfg;
+    uint32_t                 first_sf = 0;
+    uint32_t                 rr_start = 0;
+    std::vector<mtch_t>      mtchs;
+    std::vector<msi_entry_t> msi;
+  };
+
+  void sched_pmch(pmch_t& pmch);
+
+  srslog::basic_logger&                                logger;
+  std::vector<pmch_t>                                  pmchs;
+  std::array<std::atomic<uint32_t>, MAX_MTCH_LCID + 1> buffer_state = {};
+  period_metrics_t                                     metrics;
+};
+
+} // namespace srsenb
+
+#endif // SRSENB_MCH_SCHED_H
@@ -90,12 +90,14 @@ public:
   };
 
   struct sched_args_t {
-    bool        pdsch_enabled      = true;
-    bool        pusch_enabled      = true;
-    bool        auto_refill_buffer = false;
-    int         fixed_dl_mcs       = 28;
-    int         fixed_ul_mcs       = 28;
-    std::string logger_name        = "MAC-NR";
+    bool        pdsch_enabled       = true;
+    bool        pusch_enabled       = true;
+    bool        auto_refill_buffer  = false;
+    int         fixed_dl_mcs        = 28;
+    int         fixed_ul_mcs        = 28;
+    std::string logger_name         = "MAC-NR";
+    uint32_t    nof_pipelined_slots = 0;  ///< Slots scheduled ahead of run_slot by a worker per cell (0: no workers)
+    int         worker_cpu          = -1; ///< CPU of the worker of cell 0, with cell cc on worker_cpu + cc (-1: any)
   };
 
   using ue_cc_cfg_t = sched_nr_ue_cc_cfg_t;
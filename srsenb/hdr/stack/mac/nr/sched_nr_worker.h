@@ -27,10 +27,10 @@
 #include "sched_nr_grant_allocator.h"
 #include "sched_nr_ue.h"
 #include "srsran/adt/circular_array.h"
+#include "srsran/adt/mpmc_queue.h"
 #include "srsran/adt/optional.h"
 #include "srsran/adt/pool/cached_alloc.h"
 #include "srsran/adt/span.h"
-#include <condition_variable>
 #include <mutex>
 
 namespace srsenb {
@@ -39,6 +39,63 @@ struct mac_metrics_t;
 
 namespace sched_nr_impl {
 
+/**
+ * Queue of scheduler events with multiple producers (e.g. PHY and RLC threads) and one consumer (the worker of the
+ * slot). Events are pushed into a lock-free ring. Only when the ring is full, they are stored in a mutex-protected
+ * overflow list, so that no event is dropped. The events of each producer keep their order, but events of different
+ * producers may be reordered
+ */
+template <typename T, size_t N>
+class sched_event_queue
+{
+public:
+  void push(T&& ev)
+  {
+    if (not overflow_pending.load(std::memory_order_acquire) and ring.try_push(std::move(ev))) {
+      return;
+    }
+    std::lock_guard<std::mutex> lock(overflow_mutex);
+    overflow.push_back(std::move(ev));
+    overflow_pending.store(true, std::memory_order_release);
+  }
+
+  /// Run f for all the pending events. The events of each producer run in the order they were pushed
+  template <typename Func>
+  void drain(Func&& f)
+  {
+    T ev;
+    while (ring.try_pop(ev)) {
+      f(ev);
+    }
+    if (overflow_pending.load(std::memory_order_acquire)) {
+      // The producers keep using the overflow list until it is found empty, so that none of their events reaches the
+      // ring while older ones are still in the list
+      {
+        std::lock_guard<std::mutex> lock(overflow_mutex);
+        tmp_overflow.swap(overflow);
+      }
+      // Events that reached the ring while the overflow list was being filled are older than the ones in the list
+      while (ring.try_pop(ev)) {
+        f(ev);
+      }
+      for (T& e : tmp_overflow) {
+        f(e);
+      }
+      tmp_overflow.clear();
+      std::lock_guard<std::mutex> lock(overflow_mutex);
+      if (overflow.empty()) {
+        overflow_pending.store(false, std::memory_order_release);
+      }
+    }
+  }
+
+private:
+  srsran::static_mpmc_queue<T, N> ring;
+  std::atomic<bool>               overflow_pending{false};
+  std::mutex                      overflow_mutex;
+  srsran::deque<T>                overflow, tmp_overflow;
+};
+
 class slot_cc_worker
 {
 public:
@@ -71,27 +128,17 @@ private:
 
   // Process of UE cell-specific feedback
   struct feedback_t {
-    uint16_t            rnti;
+    uint16_t            rnti = SRSRAN_INVALID_RNTI;
     feedback_callback_t fdbk;
   };
-  std::mutex                                    feedback_mutex;
-  srsran::deque<feedback_t>                     pending_feedback, tmp_feedback_to_run;
-  srsran::deque<srsran::move_callback<void()> > pending_events, tmp_events_to_run;
+  sched_event_queue<feedback_t, 1024>                   pending_feedback;
+  sched_event_queue<srsran::move_callback<void()>, 64> pending_events;
 
   slot_ue_map_t slot_ues;
 };
 
 class sched_worker_manager
 {
-  struct slot_worker_ctxt {
-    std::mutex                  slot_mutex; // lock of all workers of the same slot.
-    std::condition_variable     cvar;
-    slot_point                  slot_rx;
-    int                         nof_workers_waiting = 0;
-    std::atomic<int>            worker_count{0}; // variable shared across slot_cc_workers
-    std::vector<slot_cc_worker> workers;
-  };
-
 public:
   explicit sched_worker_manager(ue_map_t&                                         ue_db_,
                                 const sched_params&                               cfg_,
@@ -102,6 +149,9 @@ public:
 
   void run_slot(slot_point slot_tx, uint32_t cc, dl_sched_res_t& dl_res, ul_sched_t& ul_res);
 
+  /// Stop the pipelined cell workers, if any. Called before the cells are destroyed
+  void stop();
+
   void get_metrics(mac_metrics_t& metrics);
 
   void enqueue_event(uint16_t rnti, srsran::move_callback<void()> ev);
@@ -112,7 +162,10 @@ public:
   }
 
 private:
-  void update_ue_db(slot_point slot_tx, bool locked_context);
+  class cell_worker;
+
+  void run_slot_impl(slot_point slot_tx, uint32_t cc, dl_sched_res_t& dl_res, ul_sched_t& ul_res);
+  void update_ue_db(slot_point slot_tx);
   void get_metrics_nolocking(mac_metrics_t& metrics);
   bool save_sched_result(slot_point pdcch_slot, uint32_t cc, dl_sched_res_t& dl_res, ul_sched_t& ul_res);
 
@@ -122,26 +175,31 @@ private:
   srslog::basic_logger&                             logger;
 
   struct ue_event_t {
-    uint16_t                      rnti;
+    uint16_t                      rnti = SRSRAN_INVALID_RNTI;
     srsran::move_callback<void()> callback;
   };
-  std::mutex                event_mutex;
-  srsran::deque<ue_event_t> next_slot_events, slot_events;
+  sched_event_queue<ue_event_t, 1024> pending_events;
 
-  std::vector<std::unique_ptr<slot_worker_ctxt> > slot_worker_ctxts;
   struct cc_context {
-    std::condition_variable cvar;
-    int                     waiting = 0;
-    slot_cc_worker          worker;
+    slot_cc_worker worker;
 
     cc_context(serv_cell_manager& sched) : worker(sched) {}
   };
-
-  std::mutex                                slot_mutex;
-  std::condition_variable                   cvar;
-  slot_point                                current_slot;
-  std::atomic<int>                          worker_count{0}; // variable shared across slot_cc_workers
   std::vector<std::unique_ptr<cc_context> > cc_worker_list;
+
+  // Synchronization of the CC workers of the same slot. The first worker to start a slot updates the UE DB, while the
+  // others spin until slot_ready is set. The last worker to finish the slot releases it
+  static constexpr uint32_t no_slot = std::numeric_limits<uint32_t>::max();
+  std::atomic<uint32_t>     current_slot{no_slot};
+  std::atomic<bool>         slot_ready{false};
+  std::atomic<int>          worker_count{0}; // variable shared across slot_cc_workers
+
+  // Only contended by get_metrics, as changes in the UE DB are made by the first worker of the slot
+  std::mutex ue_db_mutex;
+
+  // Pinned workers that schedule nof_pipelined_slots ahead of run_slot. Empty if the slots are scheduled in the
+  // calling thread
+  std::vector<std::unique_ptr<cell_worker> > cell_workers;
 };
 
 } // namespace sched_nr_impl
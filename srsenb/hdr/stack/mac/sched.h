@@ -88,13 +88,35 @@ public:
   int                                  ul_buffer_add(uint16_t rnti, uint32_t lcid, uint32_t bytes) final;
 
   class carrier_sched;
+  class carrier_worker;
+
+  /// UE feedback that only concerns the state of the UE in one carrier
+  struct cc_feedback_t {
+    enum type_t { ul_crc, dl_ri, dl_pmi, dl_cqi, dl_sb_cqi, ul_snr };
+
+    cc_feedback_t() = default;
+    cc_feedback_t(type_t type_, uint16_t rnti_, uint32_t tti_rx_, uint32_t value_, uint32_t idx_ = 0, float snr_ = 0) :
+      type(type_), rnti(rnti_), tti_rx(tti_rx_), value(value_), idx(idx_), snr(snr_)
+    {}
+
+    type_t            type  = ul_crc;
+    uint16_t          rnti  = 0;
+    srsran::tti_point tti_rx;
+    uint32_t          value = 0; ///< CRC, RI, PMI or CQI
+    uint32_t          idx   = 0; ///< Subband index of the CQI or UL channel code of the SNR
+    float             snr   = 0;
+  };
 
 protected:
   void new_tti(srsran::tti_point tti_rx);
+  void new_tti_parallel(srsran::tti_point tti_rx);
   bool is_generated(srsran::tti_point, uint32_t enb_cc_idx) const;
   // Helper methods
   template <typename Func>
   int ue_db_access_locked(uint16_t rnti, Func&& f, const char* func_name = nullptr, bool log_fail = true);
+  int  handle_cc_feedback(uint32_t enb_cc_idx, const cc_feedback_t& ev);
+  void flush_cc_feedback();
+  void notify_ue_activity(uint16_t rnti);
 
   // args
   rrc_interface_mac*               rrc       = nullptr;
@@ -102,10 +124,16 @@ protected:
   std::vector<sched_cell_params_t> sched_cell_params;
 
   rnti_map_t<std::unique_ptr<sched_ue> > ue_db;
+  // RNTI of the UE in each slot of ue_db, for the lookups done without sched_mutex. 0 marks an empty slot
+  std::array<std::atomic<uint16_t>, SRSENB_MAX_UES> ue_db_rntis = {};
 
   // independent schedulers for each carrier
   std::vector<std::unique_ptr<carrier_sched> > carrier_schedulers;
 
+  // Workers of the carriers other than the first one, when the carriers are scheduled in parallel. The first carrier is
+  // scheduled by the thread that calls dl_sched/ul_sched
+  std::vector<std::unique_ptr<carrier_worker> > carrier_workers;
+
   // Storage of past scheduling results
   sched_result_ringbuffer sched_results;
 
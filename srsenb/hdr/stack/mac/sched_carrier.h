@@ -24,8 +24,11 @@
 
 #include "sched.h"
 #include "schedulers/sched_base.h"
+#include "srsran/adt/mpmc_queue.h"
 #include "srsran/adt/pool/cached_alloc.h"
+#include "srsran/common/threads.h"
 #include "srsran/srslog/srslog.h"
+#include <condition_variable>
 
 namespace srsenb {
 
@@ -46,6 +49,23 @@ public:
   const cc_sched_result& generate_tti_result(srsran::tti_point tti_rx);
   int                    dl_rach_info(dl_sched_rar_info_t rar_info);
 
+  // Steps of generate_tti_result, called separately when the carriers are scheduled in parallel
+  //! Carrier-local step. Applies the queued UE feedback and schedules PHICH, broadcast, RAR and Msg3
+  void start_tti(srsran::tti_point tti_rx, uint32_t paging_payload);
+  //! Schedules the UE data and generates the DCIs/UCI of the carrier. Depends on the other carriers of the UEs with
+  //! cells in more than one carrier
+  void sched_users(srsran::tti_point tti_rx);
+  //! Carrier-local step. Clears the HARQ state of the TTI and logs the result
+  const cc_sched_result& finish_tti(srsran::tti_point tti_rx);
+
+  // UE feedback inbox
+  bool push_feedback(const cc_feedback_t& ev) { return feedback_inbox.try_push(ev); }
+  void process_feedback();
+  void apply_feedback(sched_ue& ue, const cc_feedback_t& ev);
+
+  //! Notifies the scheduling policy that the state of a UE changed
+  void ue_activity(uint16_t rnti);
+
   // getters
   const ra_sched* get_ra_sched() const { return ra_sched_ptr.get(); }
   //! Get a subframe result for a given tti
@@ -58,6 +78,8 @@ private:
   int alloc_ul_users(sf_sched* tti_sched);
   //! Get sf_sched for a given TTI
   sf_sched* get_sf_sched(srsran::tti_point tti_rx);
+  //! Schedule PHICH, broadcast, RAR and Msg3
+  void sched_cell_ctrl(srsran::tti_point tti_rx, uint32_t paging_payload);
 
   // args
   const sched_cell_params_t* cc_cfg = nullptr;
@@ -74,17 +96,52 @@ private:
 
   std::vector<uint8_t> sf_dl_mask; ///< Some TTIs may be forbidden for DL sched due to MBMS
 
+  // UE feedback received from the PHY and not yet applied. Only used in parallel mode
+  srsran::static_mpmc_queue<cc_feedback_t, 1024> feedback_inbox;
+
   std::unique_ptr<bc_sched>   bc_sched_ptr;
   std::unique_ptr<ra_sched>   ra_sched_ptr;
   std::unique_ptr<sched_base> sched_algo;
 };
 
+/**
+ * Thread that runs the TTIs of a carrier, when the carriers are scheduled in parallel. Each TTI is pushed by the thread
+ * that generates the TTI, which then waits for its completion with wait()
+ */
+class sched::carrier_worker : public srsran::thread
+{
+public:
+  carrier_worker(carrier_sched& carrier_, uint32_t enb_cc_idx_);
+  ~carrier_worker() override;
+
+  //! All the steps of the TTI. Only used when no UE has cells in other carriers
+  void run_tti(srsran::tti_point tti_rx, uint32_t paging_payload);
+  void wait();
+  void stop();
+
+private:
+  enum class job_t { none, run_tti, stop };
+
+  void push_job(job_t job_, srsran::tti_point tti_rx, uint32_t paging_payload);
+  void run_thread() override;
+
+  carrier_sched&          carrier;
+  bool                    running = false;
+  std::mutex              mutex;
+  std::condition_variable job_cvar;
+  std::condition_variable done_cvar;
+  job_t                   job      = job_t::none;
+  bool                    job_done = true;
+  srsran::tti_point       job_tti;
+  uint32_t                job_paging_payload = 0;
+};
+
 //! Broadcast (SIB + paging) scheduler
 class bc_sched
 {
 public:
-  explicit bc_sched(const sched_cell_params_t& cfg_, rrc_interface_mac* rrc_);
-  void dl_sched(sf_sched* tti_sched);
+  explicit bc_sched(const sched_cell_params_t& cfg_);
+  void dl_sched(sf_sched* tti_sched, uint32_t paging_payload);
   void reset();
 
 private:
@@ -96,11 +153,10 @@ private:
 
   void update_si_windows(sf_sched* tti_sched);
   void alloc_sibs(sf_sched* tti_sched);
-  void alloc_paging(sf_sched* tti_sched);
+  void alloc_paging(sf_sched* tti_sched, uint32_t paging_payload);
 
   // args
   const sched_cell_params_t* cc_cfg = nullptr;
-  rrc_interface_mac*         rrc    = nullptr;
   srslog::basic_logger&      logger;
 
   std::array<sched_sib_t, sched_interface::MAX_SIBS> pending_sibs;
@@ -79,6 +79,8 @@ public:
     int         init_dl_cqi               = 5;
     float       max_sib_coderate          = 0.8;
     int         pdcch_cqi_offset          = 0;
+    bool        parallel_cc               = false;
+    uint32_t    max_pdcch_search_nodes    = 2000;
   };
 
   struct cell_cfg_t {
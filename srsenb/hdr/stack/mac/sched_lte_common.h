@@ -34,13 +34,14 @@ namespace srsenb {
 
 constexpr float    tti_duration_ms = 1;
 constexpr uint32_t NOF_AGGR_LEVEL  = 4;
+constexpr uint32_t MAX_NOF_CCE_POS = 6; ///< Maximum number of PDCCH candidates per aggregation level
 
 /***********************
  *   Helper Types
  **********************/
 
 /// List of CCE start positions in PDCCH
-using cce_position_list = srsran::bounded_vector<uint32_t, 6>;
+using cce_position_list = srsran::bounded_vector<uint32_t, MAX_NOF_CCE_POS>;
 
 /// Map {L} -> list of CCE positions
 using cce_cfi_position_table = std::array<cce_position_list, NOF_AGGR_LEVEL>;
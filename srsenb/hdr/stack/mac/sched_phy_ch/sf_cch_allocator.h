@@ -44,7 +44,10 @@ public:
     pdcch_mask_t total_mask, current_mask;
     prbmask_t    total_pucch_mask;
   };
-  using alloc_result_t = srsran::bounded_vector<const tree_node*, 16>;
+  /// Maximum number of DCIs in a TTI, namely the broadcast, RAR and DL/UL data allocations
+  const static uint32_t MAX_NOF_ALLOCS = sched_interface::MAX_BC_LIST + sched_interface::MAX_RAR_LIST +
+                                         2 * sched_interface::MAX_DATA_LIST;
+  using alloc_result_t = srsran::bounded_vector<const tree_node*, MAX_NOF_ALLOCS>;
 
   sf_cch_allocator() : logger(srslog::fetch_basic_logger("MAC")) {}
 
@@ -68,20 +71,37 @@ public:
   uint32_t    nof_cces() const { return cc_cfg->nof_cce_table[current_cfix]; }
   size_t      nof_allocs() const { return dci_record_list.size(); }
   std::string result_to_string(bool verbose = false) const;
+  /// Number of DFS nodes expanded in the current TTI
+  uint32_t nof_search_nodes() const { return nof_dfs_nodes; }
 
 private:
+  /// DCI position of the search space of an allocation, with its PDCCH and PUCCH resources precomputed
+  struct dci_cand {
+    uint32_t     dci_pos_idx; ///< index in the DCI location table
+    uint32_t     ncce;
+    int8_t       pucch_n_prb;
+    pdcch_mask_t mask;
+  };
+  using dci_cand_list = srsran::bounded_vector<dci_cand, MAX_NOF_CCE_POS>;
+
   /// DCI allocation parameters
   struct alloc_record {
     bool         pusch_uci;
     uint32_t     aggr_idx;
     alloc_type_t alloc_type;
     sched_ue*    user;
+    /// Candidates that do not collide with the UE SR and fall within the PUCCH HARQ region, for each CFI. They are
+    /// computed the first time the DFS visits the record with a given CFI
+    std::array<dci_cand_list, MAX_CFI> cands;
+    std::array<bool, MAX_CFI>          cands_set;
   };
   const cce_cfi_position_table* get_cce_loc_table(alloc_type_t alloc_type, sched_ue* user, uint32_t cfix) const;
+  const dci_cand_list&          get_cands(alloc_record& record, uint32_t cfix);
 
   // PDCCH allocation algorithm
-  bool alloc_dfs_node(const alloc_record& record, uint32_t start_child_idx);
+  bool alloc_dfs_node(uint32_t record_idx, uint32_t start_child_idx);
   bool get_next_dfs();
+  bool remaining_records_fit(uint32_t record_idx, const pdcch_mask_t& total_mask);
 
   // consts
   const sched_cell_params_t* cc_cfg = nullptr;
@@ -92,6 +112,7 @@ private:
   tti_point                 tti_rx;
   uint32_t                  current_cfix     = 0;
   uint32_t                  current_max_cfix = 0;
+  uint32_t                  nof_dfs_nodes    = 0; ///< DFS nodes expanded in this TTI, capped by max_pdcch_search_nodes
   std::vector<tree_node>    last_dci_dfs, temp_dci_dfs;
   std::vector<alloc_record> dci_record_list; ///< Keeps a record of all the PDCCH allocations done so far
 };
@@ -46,6 +46,9 @@ class sched_ue
 public:
   sched_ue(uint16_t rnti, const std::vector<sched_cell_params_t>& cell_list_params_, const ue_cfg_t& cfg);
   void new_subframe(tti_point tti_rx, uint32_t enb_cc_idx);
+  // Split version of new_subframe, used when the carriers are scheduled in parallel
+  void new_ue_tti(tti_point tti_rx);
+  void new_cell_tti(tti_point tti_rx, uint32_t enb_cc_idx);
 
   /*************************************************************
    *
@@ -103,6 +106,9 @@ public:
   uint32_t get_pending_ul_old_data(uint32_t enb_cc_idx);
   uint32_t get_expected_ul_bitrate(uint32_t enb_cc_idx, int nof_prbs = -1) const;
 
+  /// Whether the UE has DL/UL data or HARQ processes in use that the carrier enb_cc_idx may need to schedule
+  bool has_pending_txs(uint32_t enb_cc_idx) const;
+
   dl_harq_proc* get_pending_dl_harq(tti_point tti_tx_dl, uint32_t enb_cc_idx);
   dl_harq_proc* get_empty_dl_harq(tti_point tti_tx_dl, uint32_t enb_cc_idx);
   ul_harq_proc* get_ul_harq(tti_point tti_tx_ul, uint32_t enb_cc_idx);
@@ -140,6 +146,7 @@ public:
 
   sched_ue_cell*                   find_ue_carrier(uint32_t enb_cc_idx);
   size_t                           nof_carriers_configured() const { return cfg.supported_cc_list.size(); }
+  bool                             is_multi_carrier() const;
   std::bitset<SRSRAN_MAX_CARRIERS> scell_activation_mask() const;
   int                              enb_to_ue_cc_idx(uint32_t enb_cc_idx) const;
 
@@ -141,6 +141,7 @@ public:
   std::vector<dl_harq_proc>&       dl_harq_procs() { return dl_harqs; }
   const std::vector<dl_harq_proc>& dl_harq_procs() const { return dl_harqs; }
   std::vector<ul_harq_proc>&       ul_harq_procs() { return ul_harqs; }
+  const std::vector<ul_harq_proc>& ul_harq_procs() const { return ul_harqs; }
 
   /**
    * Get the DL harq proc based on tti_tx_dl
@@ -38,6 +38,9 @@ public:
   virtual void sched_dl_users(sched_ue_list& ue_db, sf_sched* tti_sched) = 0;
   virtual void sched_ul_users(sched_ue_list& ue_db, sf_sched* tti_sched) = 0;
 
+  /// Called when the state of a UE changed (e.g. buffer status, HARQ feedback, CQI, config or removal)
+  virtual void ue_activity(uint16_t rnti) {}
+
 protected:
   srslog::basic_logger& logger = srslog::fetch_basic_logger("MAC");
 };
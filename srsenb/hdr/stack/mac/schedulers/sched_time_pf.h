@@ -29,6 +29,14 @@
 
 namespace srsenb {
 
+/**
+ * Time-domain proportional fair scheduler.
+ *
+ * Only the UEs with pending data or HARQ processes in use in the carrier (active UEs) are ranked every TTI. UEs enter
+ * the active set when their state changes (see ue_activity), and leave it at the start of the first TTI in which they
+ * have nothing to schedule. The average rates of idle UEs are not updated while they are idle. Instead, the zero-rate
+ * samples of the TTIs they missed are applied once, when they become active again.
+ */
 class sched_time_pf final : public sched_base
 {
   using ue_cit_t = sched_ue_list::const_iterator;
@@ -37,14 +45,17 @@ public:
   sched_time_pf(const sched_cell_params_t& cell_params_, const sched_interface::sched_args_t& sched_args);
   void sched_dl_users(sched_ue_list& ue_db, sf_sched* tti_sched) override;
   void sched_ul_users(sched_ue_list& ue_db, sf_sched* tti_sched) override;
+  void ue_activity(uint16_t rnti) override;
 
 private:
   void new_tti(sched_ue_list& ue_db, sf_sched* tti_sched);
+  void activate_pending_ues(sched_ue_list& ue_db);
 
   const sched_cell_params_t* cc_cfg         = nullptr;
   float                      fairness_coeff = 1;
 
   srsran::tti_point current_tti_rx;
+  uint64_t          tti_count = 0; ///< Number of TTIs scheduled so far. Unlike tti_point, it does not wrap around
 
   struct ue_ctxt {
     ue_ctxt(uint16_t rnti_, float fairness_coeff_) : rnti(rnti_), fairness_coeff(fairness_coeff_) {}
@@ -55,10 +66,16 @@ private:
     void     new_tti(const sched_cell_params_t& cell, sched_ue& ue, sf_sched* tti_sched);
     void     save_dl_alloc(uint32_t alloc_bytes, float alpha);
     void     save_ul_alloc(uint32_t alloc_bytes, float alpha);
+    void     save_idle_ttis(uint64_t nof_ttis, float alpha);
+    void     reset(sched_ue* ue_);
 
     const uint16_t rnti;
     const float    fairness_coeff;
 
+    sched_ue* ue         = nullptr; ///< UE object of the RNTI the history refers to
+    bool      active     = false;
+    uint64_t  idle_since = 0; ///< Value of tti_count when the UE left the active set
+
     int                 ue_cc_idx  = 0;
     float               dl_prio    = 0;
     float               ul_prio    = 0;
@@ -73,20 +90,25 @@ private:
     uint32_t ul_nof_samples = 0;
   };
 
-  rnti_map_t<ue_ctxt> ue_history_db;
+  rnti_map_t<ue_ctxt>   ue_history_db;
+  std::vector<ue_ctxt*> active_ues;
+  std::vector<uint16_t> pending_ues; ///< UEs signalled by ue_activity since the last TTI
 
-  struct ue_dl_prio_compare {
-    bool operator()(const ue_ctxt* lhs, const ue_ctxt* rhs) const;
+  /// Entry of the priority queues. The sort keys are stored in the entry, so that the heap operations do not need to
+  /// access the UE contexts
+  struct ue_prio_t {
+    float    prio;
+    bool     is_retx;
+    ue_ctxt* ue;
   };
-  struct ue_ul_prio_compare {
-    bool operator()(const ue_ctxt* lhs, const ue_ctxt* rhs) const;
+  struct ue_prio_compare {
+    bool operator()(const ue_prio_t& lhs, const ue_prio_t& rhs) const;
   };
 
-  using ue_dl_queue_t = std::priority_queue<ue_ctxt*, std::vector<ue_ctxt*>, ue_dl_prio_compare>;
-  using ue_ul_queue_t = std::priority_queue<ue_ctxt*, std::vector<ue_ctxt*>, ue_ul_prio_compare>;
+  using ue_queue_t = std::priority_queue<ue_prio_t, std::vector<ue_prio_t>, ue_prio_compare>;
 
-  ue_dl_queue_t dl_queue;
-  ue_ul_queue_t ul_queue;
+  ue_queue_t dl_queue;
+  ue_queue_t ul_queue;
 
   uint32_t try_dl_alloc(ue_ctxt& ue_ctxt, sched_ue& ue, sf_sched* tti_sched);
   uint32_t try_ul_alloc(ue_ctxt& ue_ctxt, sched_ue& ue, sf_sched* tti_sched);
@@ -150,6 +150,9 @@ public:
   int  init(const gtpu_args_t& gtpu_args, pdcp_interface_gtpu* pdcp_);
   void stop();
 
+  // Transmits the GTP-U PDUs collected during the TTI, when batched I/O is enabled
+  void tti_clock();
+
   // gtpu_interface_rrc
   srsran::expected<uint32_t> add_bearer(uint16_t            rnti,
                                         uint32_t            eps_bearer_id,
@@ -219,6 +222,10 @@ private:
   // Socket file descriptor
   int fd = -1;
 
+  // PDUs pending transmission, when batched I/O is enabled
+  srsran::net_utils::udp_tx_batch tx_batch;
+
+  bool send_datagram(srsran::unique_byte_buffer_t pdu, const sockaddr_in& addr);
   void send_pdu_to_tunnel(const gtpu_tunnel& tx_tun, srsran::unique_byte_buffer_t pdu, int pdcp_sn = -1);
 
   void echo_response(in_addr_t addr, in_port_t port, uint16_t seq);
@@ -143,6 +143,7 @@ void parse_args(all_args_t* args, int argc, char* argv[])
     /* PCAP */
     ("pcap.enable",    bpo::value<bool>(&args->stack.mac_pcap.enable)->default_value(false),         "Enable MAC packet captures for wireshark")
     ("pcap.filename",  bpo::value<string>(&args->stack.mac_pcap.filename)->default_value("enb_mac.pcap"), "MAC layer capture filename")
+    ("pcap.pcapng",    bpo::value<bool>(&args->stack.mac_pcap.pcapng)->default_value(false),         "Write the MAC layer capture in pcapng format")
     ("pcap.nr_filename",  bpo::value<string>(&args->nr_stack.mac.pcap.filename)->default_value("enb_mac_nr.pcap"), "NR MAC layer capture filename")
     ("pcap.s1ap_enable",   bpo::value<bool>(&args->stack.s1ap_pcap.enable)->default_value(false),         "Enable S1AP packet captures for wireshark")
     ("pcap.s1ap_filename", bpo::value<string>(&args->stack.s1ap_pcap.filename)->default_value("enb_s1ap.pcap"), "S1AP layer capture filename")
@@ -177,11 +178,14 @@ void parse_args(all_args_t* args, int argc, char* argv[])
     ("scheduler.init_dl_cqi", bpo::value<int>(&args->stack.mac.sched.init_dl_cqi)->default_value(5), "DL CQI value used before any CQI report is available to the eNB")
     ("scheduler.max_sib_coderate", bpo::value<float>(&args->stack.mac.sched.max_sib_coderate)->default_value(0.8), "Upper bound on SIB and RAR grants coderate")
     ("scheduler.pdcch_cqi_offset", bpo::value<int>(&args->stack.mac.sched.pdcch_cqi_offset)->default_value(0), "CQI offset in derivation of PDCCH aggregation level")
+    ("scheduler.parallel_cc", bpo::value<bool>(&args->stack.mac.sched.parallel_cc)->default_value(false), "Schedule each carrier in its own thread")
+    ("scheduler.max_pdcch_search_nodes", bpo::value<uint32_t>(&args->stack.mac.sched.max_pdcch_search_nodes)->default_value(2000), "Maximum number of steps of the PDCCH allocation search per TTI and carrier (0 for no limit)")
 
 
 
     /* Downlink Channel emulator section */
     ("channel.dl.enable",            bpo::value<bool>(&args->phy.dl_channel_args.enable)->default_value(false),               "Enable/Disable internal Downlink channel emulator")
+    ("channel.dl.nof_threads",       bpo::value<uint32_t>(&args->phy.dl_channel_args.nof_threads)->default_value(0),          "Worker threads of the Downlink channel emulator, 0 runs it in the radio thread")
     ("channel.dl.awgn.enable",       bpo::value<bool>(&args->phy.dl_channel_args.awgn_enable)->default_value(false),          "Enable/Disable AWGN simulator")
     ("channel.dl.awgn.snr",          bpo::value<float>(&args->phy.dl_channel_args.awgn_snr_dB)->default_value(30.0f),         "Target SNR in dB")
     ("channel.dl.fading.enable",     bpo::value<bool>(&args->phy.dl_channel_args.fading_enable)->default_value(false),        "Enable/Disable Fading model")
@@ -201,6 +205,7 @@ void parse_args(all_args_t* args, int argc, char* argv[])
 
     /* Uplink Channel emulator section */
     ("channel.ul.enable",            bpo::value<bool>(&args->phy.ul_channel_args.enable)->default_value(false),                  "Enable/Disable internal Downlink channel emulator")
+    ("channel.ul.nof_threads",       bpo::value<uint32_t>(&args->phy.ul_channel_args.nof_threads)->default_value(0),             "Worker threads of the Uplink channel emulator, 0 runs it in the radio thread")
     ("channel.ul.awgn.enable",       bpo::value<bool>(&args->phy.ul_channel_args.awgn_enable)->default_value(false),             "Enable/Disable AWGN simulator")
     ("channel.ul.awgn.signal_power", bpo::value<float>(&args->phy.ul_channel_args.awgn_signal_power_dBfs)->default_value(30.0f), "Received signal power in decibels full scale (dBfs)")
     ("channel.ul.awgn.snr",          bpo::value<float>(&args->phy.ul_channel_args.awgn_snr_dB)->default_value(30.0f),            "Noise level in decibels full scale (dBfs)")
@@ -225,10 +230,12 @@ void parse_args(all_args_t* args, int argc, char* argv[])
     ("expert.metrics_csv_filename", bpo::value<string>(&args->general.metrics_csv_filename)->default_value("/tmp/enb_metrics.csv"), "Metrics CSV filename.")
     ("expert.pusch_max_its", bpo::value<uint32_t>(&args->phy.pusch_max_its)->default_value(8), "Maximum number of turbo decoder iterations for LTE.")
     ("expert.pusch_8bit_decoder", bpo::value<bool>(&args->phy.pusch_8bit_decoder)->default_value(false), "Use 8-bit for LLR representation and turbo decoder trellis computation (Experimental).")
+    ("expert.pusch_tdec_threads", bpo::value<uint32_t>(&args->phy.pusch_tdec_threads)->default_value(0), "Number of threads used to decode the PUSCH code blocks of a transport block in parallel (0 disables it).")
     ("expert.pusch_meas_evm", bpo::value<bool>(&args->phy.pusch_meas_evm)->default_value(false), "Enable/Disable PUSCH EVM measure.")
     ("expert.tx_amplitude", bpo::value<float>(&args->phy.tx_amplitude)->default_value(0.6), "Transmit amplitude factor.")
     ("expert.nof_phy_threads", bpo::value<uint32_t>(&args->phy.nof_phy_threads)->default_value(3), "Number of PHY threads.")
-    ("expert.nof_prach_threads", bpo::value<uint32_t>(&args->phy.nof_prach_threads)->default_value(1), "Number of PRACH workers per carrier. Only 1 or 0 is supported.")
+    ("expert.nof_prach_threads", bpo::value<uint32_t>(&args->phy.nof_prach_threads)->default_value(1), "Number of PRACH workers per carrier. 0 detects in the PHY workers, more than 1 split the root sequences of each occasion.")
+    ("expert.prach_lockfree_pool", bpo::value<bool>(&args->phy.prach_lockfree_pool)->default_value(false), "Use the lock-free buffer pool mode for the PRACH buffers (Experimental).")
     ("expert.max_prach_offset_us", bpo::value<float>(&args->phy.max_prach_offset_us)->default_value(30), "Maximum allowed RACH offset (in us).")
     ("expert.equalizer_mode", bpo::value<string>(&args->phy.equalizer_mode)->default_value("mmse"), "Equalizer mode.")
     ("expert.estimator_fil_w", bpo::value<float>(&args->phy.estimator_fil_w)->default_value(0.1), "Chooses the coefficients for the 3-tap channel estimator centered filter.")
@@ -251,6 +258,7 @@ void parse_args(all_args_t* args, int argc, char* argv[])
     ("expert.max_mac_dl_kos", bpo::value<uint32_t>(&args->general.max_mac_dl_kos)->default_value(100), "Maximum number of consecutive KOs in DL before triggering the UE's release (default 100).")
     ("expert.max_mac_ul_kos", bpo::value<uint32_t>(&args->general.max_mac_ul_kos)->default_value(100), "Maximum number of consecutive KOs in UL before triggering the UE's release (default 100).")
     ("expert.gtpu_tunnel_timeout", bpo::value<uint32_t>(&args->stack.gtpu_indirect_tunnel_timeout_msec)->default_value(0), "Maximum time that GTPU takes to release indirect forwarding tunnel since the last received GTPU PDU (0 for infinity).")
+    ("expert.gtpu_io_batch_size", bpo::value<uint32_t>(&args->stack.gtpu_io_batch_size)->default_value(0), "Maximum number of GTPU PDUs sent/received per sendmmsg/recvmmsg call. Tx PDUs are flushed every TTI (0 for one syscall per PDU).")
     ("expert.rlf_release_timer_ms", bpo::value<uint32_t>(&args->general.rlf_release_timer_ms)->default_value(4000), "Time taken by eNB to release UE context after it detects an RLF.")
     ("expert.extended_cp", bpo::value<bool>(&args->phy.extended_cp)->default_value(false), "Use extended cyclic prefix")
     ("expert.ts1_reloc_prep_timeout", bpo::value<uint32_t>(&args->stack.s1ap.ts1_reloc_prep_timeout)->default_value(10000), "S1AP TS 36.413 TS1RelocPrep Expiry Timeout value in milliseconds.")
@@ -266,7 +274,10 @@ void parse_args(all_args_t* args, int argc, char* argv[])
     // NR section
     ("scheduler.nr_pdsch_mcs", bpo::value<int>(&args->nr_stack.mac.sched_cfg.fixed_dl_mcs)->default_value(28), "Fixed NR DL MCS (-1 for dynamic).")
     ("scheduler.nr_pusch_mcs", bpo::value<int>(&args->nr_stack.mac.sched_cfg.fixed_ul_mcs)->default_value(28), "Fixed NR UL MCS (-1 for dynamic).")
+    ("scheduler.nr_pipelined_slots", bpo::value<uint32_t>(&args->nr_stack.mac.sched_cfg.nof_pipelined_slots)->default_value(0), "Number of slots each NR cell is scheduled ahead of time by its own worker (0 to schedule in the PHY thread).")
+    ("scheduler.nr_worker_cpu", bpo::value<int>(&args->nr_stack.mac.sched_cfg.worker_cpu)->default_value(-1), "CPU core of the NR scheduler worker of the first cell, with the following cells on the next cores (-1 for no pinning).")
     ("expert.nr_pusch_max_its", bpo::value<uint32_t>(&args->phy.nr_pusch_max_its)->default_value(10),     "Maximum number of LDPC iterations for NR.")
+    ("expert.nr_pusch_ldpc_threads", bpo::value<uint32_t>(&args->phy.nr_pusch_ldpc_threads)->default_value(0), "Number of threads used to decode the NR PUSCH code blocks of a transport block in parallel (0 disables it).")
 
     // VNF params
     ("vnf.type", bpo::value<string>(&args->phy.vnf_args.type)->default_value("gnb"), "VNF instance type [gnb,ue].")
@@ -355,14 +366,6 @@ void parse_args(all_args_t* args, int argc, char* argv[])
     }
   }
 
-  // Check PRACH workers
-  if (args->phy.nof_prach_threads > 1) {
-    fprintf(stderr,
-            "nof_prach_workers = %d. Value is not supported, only 0 or 1 are allowed\n",
-            args->phy.nof_prach_threads);
-    exit(1);
-  }
-
   // Convert eNB Id
   std::size_t pos = {};
   try {
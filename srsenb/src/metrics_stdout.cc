@@ -187,6 +187,11 @@ void metrics_stdout::set_metrics(const enb_metrics_t& metrics, const uint32_t pe
     fmt::print("RF status: O={}, U={}, L={}\n", metrics.rf.rf_o, metrics.rf.rf_u, metrics.rf.rf_l);
   }
 
+  if (metrics.stack.mac_pcap.nof_dropped > pcap_nof_dropped) {
+    fmt::print("MAC PCAP: dropped {} PDUs\n", metrics.stack.mac_pcap.nof_dropped - pcap_nof_dropped);
+  }
+  pcap_nof_dropped = metrics.stack.mac_pcap.nof_dropped;
+
   if (metrics.stack.rrc.ues.size() == 0) {
     return;
   }
@@ -149,6 +149,7 @@ void cc_worker::init(phy_common* phy_, uint32_t cc_idx_)
     enb_ul.pusch.llr_is_8bit        = true;
     enb_ul.pusch.ul_sch.llr_is_8bit = true;
   }
+  srsran_sch_set_cb_pool(&enb_ul.pusch.ul_sch, phy->get_tdec_pool());
   initiated = true;
 
 #ifdef DEBUG_WRITE_FILE
@@ -237,7 +238,8 @@ void cc_worker::work_dl(const srsran_dl_sf_cfg_t&            dl_sf_cfg,
     encode_pdcch_dl(dl_grants.pdsch, dl_grants.nof_grants);
     encode_pdsch(dl_grants.pdsch, dl_grants.nof_grants);
   } else {
-    if (mbsfn_cfg->enable) {
+    // Subframes within the MCH period stop may still be left empty by the MAC, e.g. the end of a partially used PMCH
+    if (mbsfn_cfg->enable and dl_grants.pdsch[0].data[0] != nullptr) {
       encode_pmch(dl_grants.pdsch, mbsfn_cfg);
     }
   }
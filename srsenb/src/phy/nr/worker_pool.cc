@@ -38,6 +38,15 @@ worker_pool::worker_pool(srsran::phy_common_interface& common_,
   // Do nothing
 }
 
+worker_pool::~worker_pool()
+{
+  // Workers are destroyed before the pool, so no code block decoding is in progress
+  workers.clear();
+  if (ldpc_enabled) {
+    srsran_sch_cb_pool_free(&ldpc_pool);
+  }
+}
+
 bool worker_pool::init(const args_t& args, const phy_cell_cfg_list_nr_t& cell_list)
 {
   nof_prach_workers = args.nof_prach_workers;
@@ -53,6 +62,17 @@ bool worker_pool::init(const args_t& args, const phy_cell_cfg_list_nr_t& cell_li
   srslog::basic_levels log_level = srslog::str_to_basic_level(args.log.phy_level);
   logger.set_level(log_level);
 
+  // Create the PUSCH code block decoder threads shared by all workers, using the same decoder configuration
+  if (args.pusch_ldpc_threads > 0 and not ldpc_enabled) {
+    srsran_sch_nr_args_t sch_args = {};
+    sch_args.max_nof_iter         = args.pusch_max_its;
+    if (srsran_sch_nr_cb_pool_init(&ldpc_pool, args.pusch_ldpc_threads, &sch_args) < SRSRAN_SUCCESS) {
+      logger.error("Error initiating PUSCH code block decoder pool");
+      return false;
+    }
+    ldpc_enabled = true;
+  }
+
   // Add workers to workers pool and start threads
   for (uint32_t i = 0; i < args.nof_phy_threads; i++) {
     auto& log = srslog::fetch_basic_logger(fmt::format("{}PHY{}-NR", args.log.id_preamble, i), log_sink);
@@ -73,6 +93,7 @@ bool worker_pool::init(const args_t& args, const phy_cell_cfg_list_nr_t& cell_li
     w_args.srate_hz                = srate_hz;
     w_args.pusch_max_its           = args.pusch_max_its;
     w_args.pusch_min_snr_dB        = args.pusch_min_snr_dB;
+    w_args.ldpc_pool               = ldpc_enabled ? &ldpc_pool : nullptr;
 
     if (not w->init(w_args)) {
       return false;
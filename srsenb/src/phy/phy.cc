@@ -191,7 +191,8 @@ int phy::init_lte(const phy_args_t&            args,
                stack_lte_,
                phy_log,
                PRACH_WORKER_THREAD_PRIO,
-               args.nof_prach_threads);
+               args.nof_prach_threads,
+               args.prach_lockfree_pool ? srsran::buffer_pool_mode::lock_free : srsran::buffer_pool_mode::locked);
   }
   prach.set_max_prach_offset_us(args.max_prach_offset_us);
 
@@ -358,6 +359,7 @@ int phy::init_nr(const phy_args_t& args, const phy_cfg_t& cfg, stack_interface_p
   worker_args.log.phy_level           = args.log.phy_level;
   worker_args.log.phy_hex_limit       = args.log.phy_hex_limit;
   worker_args.pusch_max_its           = args.nr_pusch_max_its;
+  worker_args.pusch_ldpc_threads      = args.nr_pusch_ldpc_threads;
 
   if (not nr_workers->init(worker_args, cfg.phy_cell_cfg_nr)) {
     return SRSRAN_ERROR;
@@ -61,6 +61,15 @@ bool phy_common::init(const phy_cell_cfg_list_t&    cell_list_,
     dl_channel->set_signal_power_dBfs(srsran_enb_dl_get_maximum_signal_power_dBfs(cell_list_lte[0].cell.nof_prb));
   }
 
+  // Create PUSCH code block decoding threads
+  if (params.pusch_tdec_threads > 0 and not tdec_enabled) {
+    if (srsran_sch_cb_pool_init(&tdec_pool, params.pusch_tdec_threads) < SRSRAN_SUCCESS) {
+      srsran::console("Error initiating PUSCH code block decoding pool\n");
+      return false;
+    }
+    tdec_enabled = true;
+  }
+
   // Create grants
   for (auto& q : ul_grants) {
     q.resize(cell_list_lte.size());
@@ -82,6 +91,13 @@ void phy_common::stop()
   semaphore.wait_all();
 }
 
+phy_common::~phy_common()
+{
+  if (tdec_enabled) {
+    srsran_sch_cb_pool_free(&tdec_pool);
+  }
+}
+
 void phy_common::clear_grants(uint16_t rnti)
 {
   std::lock_guard<std::mutex> lock(grant_mutex);
@@ -286,19 +302,22 @@ bool phy_common::is_mch_subframe(srsran_mbsfn_cfg_t* cfg, uint32_t phy_tti)
       if (sib13_configured) {
         cfg->mbsfn_area_id           = area_info->mbsfn_area_id;
         cfg->non_mbsfn_region_length = enum_to_number(area_info->non_mbsfn_region_len);
-        if (mcch_configured) {
+        if (mcch_configured && mbsfn.mcch.nof_pmch_info > 0) {
           // Iterate through PMCH configs to see which one applies in the current frame
+          const srsran::pmch_info_t& last_pmch = mbsfn.mcch.pmch_info_list[mbsfn.mcch.nof_pmch_info - 1];
+
           uint32_t frame_alloc_idx = sfn % enum_to_number(mbsfn.mcch.common_sf_alloc_period);
-          uint32_t mbsfn_per_frame = mbsfn.mcch.pmch_info_list[0].sf_alloc_end /
-                                     +enum_to_number(mbsfn.mcch.pmch_info_list[0].mch_sched_period);
-          uint32_t sf_alloc_idx = frame_alloc_idx * mbsfn_per_frame + ((sf < 4) ? sf - 1 : sf - 3);
+          uint32_t mbsfn_per_frame = last_pmch.sf_alloc_end / +enum_to_number(last_pmch.mch_sched_period);
+          uint32_t sf_alloc_idx    = frame_alloc_idx * mbsfn_per_frame + ((sf < 4) ? sf - 1 : sf - 3);
           while (!have_mtch_stop) {
             pthread_cond_wait(&mtch_cvar, &mtch_mutex);
           }
+          // Each PMCH occupies the subframes that follow the previous one, up to its sf_alloc_end, with its own MCS
           for (uint32_t i = 0; i < mbsfn.mcch.nof_pmch_info; i++) {
-            if (sf_alloc_idx <= mch_period_stop) {
+            if (sf_alloc_idx <= mbsfn.mcch.pmch_info_list[i].sf_alloc_end) {
               cfg->mbsfn_mcs = mbsfn.mcch.pmch_info_list[i].data_mcs;
-              cfg->enable    = true;
+              cfg->enable    = sf_alloc_idx <= mch_period_stop;
+              break;
             }
           }
         }
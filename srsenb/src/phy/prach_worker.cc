@@ -51,6 +51,10 @@ int prach_worker::init(const srsran_cell_t&      cell_,
 
   nof_sf = (uint32_t)ceilf(prach.T_tot * 1000);
 
+  if (nof_workers > 1 and init_helpers(priority)) {
+    return -1;
+  }
+
   if (nof_workers > 0) {
     start(priority);
   }
@@ -78,6 +82,33 @@ int prach_worker::init(const srsran_cell_t&      cell_,
   return 0;
 }
 
+int prach_worker::init_helpers(int priority)
+{
+  // Successive cancellation goes through all the roots sequentially, the search cannot be split
+  if (prach.successive_cancellation) {
+    logger.info("PRACH: successive cancellation enabled, %d PRACH workers will not share the root search", nof_workers);
+    return 0;
+  }
+
+  for (uint32_t i = 1; i < nof_workers; i++) {
+    std::unique_ptr<root_helper> h(new root_helper);
+    if (srsran_prach_init(&h->prach, srsran_symbol_sz(cell.nof_prb))) {
+      return -1;
+    }
+    if (srsran_prach_set_cfg(&h->prach, &prach_cfg, cell.nof_prb)) {
+      ERROR("Error initiating PRACH");
+      srsran_prach_free(&h->prach);
+      return -1;
+    }
+    srsran_prach_set_detect_factor(&h->prach, 60);
+    helpers.push_back(std::move(h));
+  }
+
+  helper_pool.reset(new srsran::task_thread_pool(helpers.size(), true));
+  helper_pool->start(priority);
+  return 0;
+}
+
 void prach_worker::stop()
 {
   running      = false;
@@ -88,6 +119,14 @@ void prach_worker::stop()
     wait_thread_finish();
   }
 
+  if (helper_pool != nullptr) {
+    helper_pool->stop();
+  }
+  for (auto& h : helpers) {
+    srsran_prach_free(&h->prach);
+  }
+  helpers.clear();
+
   srsran_prach_free(&prach);
 }
 
@@ -138,19 +177,74 @@ int prach_worker::new_tti(uint32_t tti_rx, cf_t* buffer_rx)
   return 0;
 }
 
+int prach_worker::detect_parallel(sf_buffer* b, uint32_t* nof_det)
+{
+  uint32_t sig_len = nof_sf * SRSRAN_SF_LEN_PRB(cell.nof_prb) - prach.N_cp;
+  if (srsran_prach_extract_bins(&prach, prach_cfg.freq_offset, &b->samples[prach.N_cp], sig_len)) {
+    return SRSRAN_ERROR;
+  }
+
+  // Split the roots evenly between this thread, which takes the first share, and the helpers
+  uint32_t nof_roots  = srsran_prach_nof_roots(&prach);
+  uint32_t nof_shares = helpers.size() + 1;
+  {
+    std::lock_guard<std::mutex> lock(helper_mutex);
+    nof_pending_helpers = helpers.size();
+  }
+  for (uint32_t i = 0; i < helpers.size(); i++) {
+    root_helper* h = helpers[i].get();
+    h->root_begin  = (i + 1) * nof_roots / nof_shares;
+    h->root_end    = (i + 2) * nof_roots / nof_shares;
+    helper_pool->push_task([this, h]() {
+      h->nof_det = 0;
+      srsran_prach_detect_roots(
+          &h->prach, prach.prach_bins, h->root_begin, h->root_end, h->indices, h->offsets, h->p2avg, &h->nof_det);
+
+      std::lock_guard<std::mutex> lock(helper_mutex);
+      if (--nof_pending_helpers == 0) {
+        helper_cvar.notify_one();
+      }
+    });
+  }
+
+  *nof_det = 0;
+  srsran_prach_detect_roots(
+      &prach, prach.prach_bins, 0, nof_roots / nof_shares, prach_indices, prach_offsets, prach_p2avg, nof_det);
+
+  std::unique_lock<std::mutex> lock(helper_mutex);
+  while (nof_pending_helpers > 0) {
+    helper_cvar.wait(lock);
+  }
+
+  // Concatenate the detections in root order, as a single search would have found them
+  for (const auto& h : helpers) {
+    std::copy(h->indices, h->indices + h->nof_det, prach_indices + *nof_det);
+    std::copy(h->offsets, h->offsets + h->nof_det, prach_offsets + *nof_det);
+    std::copy(h->p2avg, h->p2avg + h->nof_det, prach_p2avg + *nof_det);
+    *nof_det += h->nof_det;
+  }
+  return SRSRAN_SUCCESS;
+}
+
 int prach_worker::run_tti(sf_buffer* b)
 {
   uint32_t prach_nof_det = 0;
   if (srsran_prach_tti_opportunity(&prach, b->tti, -1)) {
     // Detect possible PRACHs
-    if (srsran_prach_detect_offset(&prach,
-                                   prach_cfg.freq_offset,
-                                   &b->samples[prach.N_cp],
-                                   nof_sf * SRSRAN_SF_LEN_PRB(cell.nof_prb) - prach.N_cp,
-                                   prach_indices,
-                                   prach_offsets,
-                                   prach_p2avg,
-                                   &prach_nof_det)) {
+    int ret = SRSRAN_SUCCESS;
+    if (helpers.empty()) {
+      ret = srsran_prach_detect_offset(&prach,
+                                       prach_cfg.freq_offset,
+                                       &b->samples[prach.N_cp],
+                                       nof_sf * SRSRAN_SF_LEN_PRB(cell.nof_prb) - prach.N_cp,
+                                       prach_indices,
+                                       prach_offsets,
+                                       prach_p2avg,
+                                       &prach_nof_det);
+    } else {
+      ret = detect_parallel(b, &prach_nof_det);
+    }
+    if (ret) {
       logger.error("Error detecting PRACH");
       return SRSRAN_ERROR;
     }
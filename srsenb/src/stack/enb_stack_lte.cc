@@ -153,7 +153,9 @@ int enb_stack_lte::init(const stack_args_t&      args_,
 
   // Set up pcap and trace
   if (args.mac_pcap.enable) {
-    mac_pcap.open(args.mac_pcap.filename);
+    mac_pcap.open(args.mac_pcap.filename,
+                  0,
+                  args.mac_pcap.pcapng ? srsran::pcap_file_format::pcapng : srsran::pcap_file_format::pcap);
     mac.start_pcap(&mac_pcap);
   }
 
@@ -204,6 +206,7 @@ int enb_stack_lte::init(const stack_args_t&      args_,
   gtpu_args.mme_addr                     = args.s1ap.mme_addr;
   gtpu_args.gtp_bind_addr                = args.s1ap.gtp_bind_addr;
   gtpu_args.indirect_tunnel_timeout_msec = args.gtpu_indirect_tunnel_timeout_msec;
+  gtpu_args.io_batch_size                = args.gtpu_io_batch_size;
   if (gtpu.init(gtpu_args, gtpu_adapter.get()) != SRSRAN_SUCCESS) {
     stack_logger.error("Couldn't initialize GTPU");
     return SRSRAN_ERROR;
@@ -226,6 +229,7 @@ void enb_stack_lte::tti_clock_impl()
 {
   task_sched.tic();
   rrc.tti_clock();
+  gtpu.tti_clock();
 }
 
 void enb_stack_lte::stop()
@@ -277,6 +281,9 @@ bool enb_stack_lte::get_metrics(stack_metrics_t* metrics)
     }
     rrc.get_metrics(metrics.rrc);
     s1ap.get_metrics(metrics.s1ap);
+    if (args.mac_pcap.enable) {
+      metrics.mac_pcap = mac_pcap.get_metrics();
+    }
     if (not pending_stack_metrics.try_push(metrics)) {
       stack_logger.error("Unable to push metrics to queue");
     }
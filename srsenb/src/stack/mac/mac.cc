@@ -19,12 +19,10 @@
  *
  */
 
-#include <pthread.h>
 #include <string.h>
 
 #include "srsenb/hdr/stack/mac/mac.h"
 #include "srsran/adt/pool/obj_pool.h"
-#include "srsran/common/rwlock_guard.h"
 #include "srsran/common/standard_streams.h"
 #include "srsran/common/time_prof.h"
 #include "srsran/interfaces/enb_phy_interfaces.h"
@@ -40,14 +38,12 @@ namespace srsenb {
 mac::mac(srsran::ext_task_sched_handle task_sched_, srslog::basic_logger& logger) :
   logger(logger), rar_payload(), common_buffers(SRSRAN_MAX_CARRIERS), task_sched(task_sched_)
 {
-  pthread_rwlock_init(&rwlock, nullptr);
   stack_task_queue = task_sched.make_task_queue();
 }
 
 mac::~mac()
 {
   stop();
-  pthread_rwlock_destroy(&rwlock);
 }
 
 bool mac::init(const mac_args_t&        args_,
@@ -94,12 +90,10 @@ bool mac::init(const mac_args_t&        args_,
   return true;
 }
 
+// Note: The PHY workers must be stopped before the MAC
 void mac::stop()
 {
-  srsran::rwlock_write_guard lock(rwlock);
-  if (started) {
-    started = false;
-
+  if (started.exchange(false)) {
     ue_db.clear();
     for (auto& cc : common_buffers) {
       for (int i = 0; i < NOF_BCCH_DLSCH_MSG; i++) {
@@ -113,22 +107,16 @@ void mac::stop()
 
 void mac::start_pcap(srsran::mac_pcap* pcap_)
 {
-  srsran::rwlock_read_guard lock(rwlock);
   pcap = pcap_;
   // Set pcap in all UEs for UL messages
-  for (auto& u : ue_db) {
-    u.second->start_pcap(pcap);
-  }
+  ue_db.for_each([this](uint16_t rnti, unique_rnti_ptr<ue>& u) { u->start_pcap(pcap); });
 }
 
 void mac::start_pcap_net(srsran::mac_pcap_net* pcap_net_)
 {
-  srsran::rwlock_read_guard lock(rwlock);
   pcap_net = pcap_net_;
   // Set pcap in all UEs for UL messages
-  for (auto& u : ue_db) {
-    u.second->start_pcap_net(pcap_net);
-  }
+  ue_db.for_each([this](uint16_t rnti, unique_rnti_ptr<ue>& u) { u->start_pcap_net(pcap_net); });
 }
 
 /********************************************************
@@ -139,17 +127,12 @@ void mac::start_pcap_net(srsran::mac_pcap_net* pcap_net_)
 
 int mac::rlc_buffer_state(uint16_t rnti, uint32_t lc_id, uint32_t tx_queue, uint32_t retx_queue)
 {
-  srsran::rwlock_read_guard lock(rwlock);
-  int                       ret = -1;
-  if (check_ue_active(rnti)) {
+  int ret = -1;
+  if (find_active_ue(rnti)) {
     if (rnti != SRSRAN_MRNTI) {
       ret = scheduler.dl_rlc_buffer_state(rnti, lc_id, tx_queue, retx_queue);
     } else {
-      for (uint32_t i = 0; i < mch.num_mtch_sched; i++) {
-        if (lc_id == mch.mtch_sched[i].lcid) {
-          mch.mtch_sched[i].lcid_buffer_size = tx_queue;
-        }
-      }
+      mch_scheduler.set_buffer_state(lc_id, tx_queue);
       ret = 0;
     }
   }
@@ -158,14 +141,12 @@ int mac::rlc_buffer_state(uint16_t rnti, uint32_t lc_id, uint32_t tx_queue, uint
 
 int mac::bearer_ue_cfg(uint16_t rnti, uint32_t lc_id, mac_lc_ch_cfg_t* cfg)
 {
-  srsran::rwlock_read_guard lock(rwlock);
-  return check_ue_active(rnti) ? scheduler.bearer_ue_cfg(rnti, lc_id, *cfg) : -1;
+  return find_active_ue(rnti) ? scheduler.bearer_ue_cfg(rnti, lc_id, *cfg) : -1;
 }
 
 int mac::bearer_ue_rem(uint16_t rnti, uint32_t lc_id)
 {
-  srsran::rwlock_read_guard lock(rwlock);
-  return check_ue_active(rnti) ? scheduler.bearer_ue_rem(rnti, lc_id) : -1;
+  return find_active_ue(rnti) ? scheduler.bearer_ue_rem(rnti, lc_id) : -1;
 }
 
 void mac::phy_config_enabled(uint16_t rnti, bool enabled)
@@ -176,11 +157,11 @@ void mac::phy_config_enabled(uint16_t rnti, bool enabled)
 // Update UE configuration
 int mac::ue_cfg(uint16_t rnti, const sched_interface::ue_cfg_t* cfg)
 {
-  srsran::rwlock_read_guard lock(rwlock);
-  if (not check_ue_active(rnti)) {
+  ue_db_t::ptr ue_ref = find_active_ue(rnti);
+  if (not ue_ref) {
     return SRSRAN_ERROR;
   }
-  ue* ue_ptr = ue_db[rnti].get();
+  ue* ue_ptr = ue_ref->get();
 
   // Start TA FSM in UE entity
   ue_ptr->start_ta();
@@ -202,13 +183,11 @@ int mac::ue_rem(uint16_t rnti)
 {
   // Remove UE from the perspective of L2/L3
   {
-    srsran::rwlock_read_guard lock(rwlock);
-    if (check_ue_active(rnti)) {
-      ue_db[rnti]->set_active(false);
-    } else {
-      logger.error("User rnti=0x%x not found", rnti);
+    ue_db_t::ptr ue_ref = find_active_ue(rnti);
+    if (not ue_ref) {
       return SRSRAN_ERROR;
     }
+    (*ue_ref)->set_active(false);
   }
   scheduler.ue_rem(rnti);
 
@@ -216,7 +195,6 @@ int mac::ue_rem(uint16_t rnti)
   // Note: Let any pending retx ACK to arrive, so that PHY recognizes rnti
   task_sched.defer_callback(FDD_HARQ_DELAY_DL_MS + FDD_HARQ_DELAY_UL_MS, [this, rnti]() {
     phy_h->rem_rnti(rnti);
-    srsran::rwlock_write_guard lock(rwlock);
     ue_db.erase(rnti);
     logger.info("User rnti=0x%x removed from MAC/PHY", rnti);
   });
@@ -226,7 +204,6 @@ int mac::ue_rem(uint16_t rnti)
 // Called after Msg3
 int mac::ue_set_crnti(uint16_t temp_crnti, uint16_t crnti, const sched_interface::ue_cfg_t& cfg)
 {
-  srsran::rwlock_read_guard lock(rwlock);
   if (temp_crnti == crnti) {
     // Schedule ConRes Msg4
     scheduler.dl_mac_buffer_state(crnti, (uint32_t)srsran::dl_sch_lcid::CON_RES_ID);
@@ -234,24 +211,22 @@ int mac::ue_set_crnti(uint16_t temp_crnti, uint16_t crnti, const sched_interface
   return ue_cfg(crnti, &cfg);
 }
 
+// Note: Called by the RRC at initialization, before the PHY workers start
 int mac::cell_cfg(const std::vector<sched_interface::cell_cfg_t>& cell_cfg_)
 {
-  srsran::rwlock_write_guard lock(rwlock);
   cell_config = cell_cfg_;
   return scheduler.cell_cfg(cell_config);
 }
 
 void mac::get_metrics(mac_metrics_t& metrics)
 {
-  srsran::rwlock_read_guard lock(rwlock);
   metrics.ues.reserve(ue_db.size());
-  for (auto& u : ue_db) {
-    if (not scheduler.ue_exists(u.first)) {
-      continue;
+  ue_db.for_each([this, &metrics](uint16_t rnti, unique_rnti_ptr<ue>& u) {
+    if (scheduler.ue_exists(rnti)) {
+      metrics.ues.emplace_back();
+      u->metrics_read(&metrics.ues.back());
     }
-    metrics.ues.emplace_back();
-    u.second->metrics_read(&metrics.ues.back());
-  }
+  });
   metrics.cc_info.resize(detected_rachs.size());
   for (unsigned cc = 0, e = detected_rachs.size(); cc != e; ++cc) {
     metrics.cc_info[cc].cc_rach_counter = detected_rachs[cc];
@@ -266,13 +241,10 @@ void mac::toggle_padding()
 
 void mac::add_padding()
 {
-  srsran::rwlock_read_guard lock(rwlock);
-  for (auto it = ue_db.begin(); it != ue_db.end(); ++it) {
-    uint16_t cur_rnti = it->first;
-    auto     ue       = it;
-    scheduler.dl_rlc_buffer_state(ue->first, args.lcid_padding, 20e6, 0);
-    ue->second->trigger_padding(args.lcid_padding);
-  }
+  ue_db.for_each([this](uint16_t rnti, unique_rnti_ptr<ue>& u) {
+    scheduler.dl_rlc_buffer_state(rnti, args.lcid_padding, 20e6, 0);
+    u->trigger_padding(args.lcid_padding);
+  });
 }
 
 /********************************************************
@@ -284,14 +256,13 @@ void mac::add_padding()
 int mac::ack_info(uint32_t tti_rx, uint16_t rnti, uint32_t enb_cc_idx, uint32_t tb_idx, bool ack)
 {
   logger.set_context(tti_rx);
-  srsran::rwlock_read_guard lock(rwlock);
-
-  if (not check_ue_active(rnti)) {
+  ue_db_t::ptr ue_ref = find_active_ue(rnti);
+  if (not ue_ref) {
     return SRSRAN_ERROR;
   }
 
   int nof_bytes = scheduler.dl_ack_info(tti_rx, rnti, enb_cc_idx, tb_idx, ack);
-  ue_db[rnti]->metrics_tx(ack, nof_bytes);
+  (*ue_ref)->metrics_tx(ack, nof_bytes);
 
   rrc_h->set_radiolink_dl_state(rnti, ack);
 
@@ -301,14 +272,13 @@ int mac::ack_info(uint32_t tti_rx, uint16_t rnti, uint32_t enb_cc_idx, uint32_t
 int mac::crc_info(uint32_t tti_rx, uint16_t rnti, uint32_t enb_cc_idx, uint32_t nof_bytes, bool crc)
 {
   logger.set_context(tti_rx);
-  srsran::rwlock_read_guard lock(rwlock);
-
-  if (not check_ue_active(rnti)) {
+  ue_db_t::ptr ue_ref = find_active_ue(rnti);
+  if (not ue_ref) {
     return SRSRAN_ERROR;
   }
 
-  ue_db[rnti]->set_tti(tti_rx);
-  ue_db[rnti]->metrics_rx(crc, nof_bytes);
+  (*ue_ref)->set_tti(tti_rx);
+  (*ue_ref)->metrics_rx(crc, nof_bytes);
 
   rrc_h->set_radiolink_ul_state(rnti, crc);
 
@@ -323,13 +293,12 @@ int mac::push_pdu(uint32_t tti_rx,
                   bool     crc,
                   uint32_t ul_nof_prbs)
 {
-  srsran::rwlock_read_guard lock(rwlock);
-
-  if (not check_ue_active(rnti)) {
+  ue_db_t::ptr ue_ref = find_active_ue(rnti);
+  if (not ue_ref) {
     return SRSRAN_ERROR;
   }
 
-  srsran::unique_byte_buffer_t pdu = ue_db[rnti]->release_pdu(tti_rx, enb_cc_idx);
+  srsran::unique_byte_buffer_t pdu = (*ue_ref)->release_pdu(tti_rx, enb_cc_idx);
   if (pdu == nullptr) {
     logger.warning("Could not find MAC UL PDU for rnti=0x%x, cc=%d, tti=%d", rnti, enb_cc_idx, tti_rx);
     return SRSRAN_ERROR;
@@ -345,9 +314,9 @@ int mac::push_pdu(uint32_t tti_rx,
                   nof_bytes,
                   (int)pdu->size());
     auto process_pdu_task = [this, rnti, enb_cc_idx, ul_nof_prbs](srsran::unique_byte_buffer_t& pdu) {
-      srsran::rwlock_read_guard lock(rwlock);
-      if (check_ue_active(rnti)) {
-        ue_db[rnti]->process_pdu(std::move(pdu), enb_cc_idx, ul_nof_prbs);
+      ue_db_t::ptr ue_ref = find_active_ue(rnti);
+      if (ue_ref) {
+        (*ue_ref)->process_pdu(std::move(pdu), enb_cc_idx, ul_nof_prbs);
       } else {
         logger.debug("Discarding PDU rnti=0x%x", rnti);
       }
@@ -362,14 +331,13 @@ int mac::push_pdu(uint32_t tti_rx,
 int mac::ri_info(uint32_t tti, uint16_t rnti, uint32_t enb_cc_idx, uint32_t ri_value)
 {
   logger.set_context(tti);
-  srsran::rwlock_read_guard lock(rwlock);
-
-  if (not check_ue_active(rnti)) {
+  ue_db_t::ptr ue_ref = find_active_ue(rnti);
+  if (not ue_ref) {
     return SRSRAN_ERROR;
   }
 
   scheduler.dl_ri_info(tti, rnti, enb_cc_idx, ri_value);
-  ue_db[rnti]->metrics_dl_ri(ri_value);
+  (*ue_ref)->metrics_dl_ri(ri_value);
 
   return SRSRAN_SUCCESS;
 }
@@ -377,14 +345,13 @@ int mac::ri_info(uint32_t tti, uint16_t rnti, uint32_t enb_cc_idx, uint32_t ri_v
 int mac::pmi_info(uint32_t tti, uint16_t rnti, uint32_t enb_cc_idx, uint32_t pmi_value)
 {
   logger.set_context(tti);
-  srsran::rwlock_read_guard lock(rwlock);
-
-  if (not check_ue_active(rnti)) {
+  ue_db_t::ptr ue_ref = find_active_ue(rnti);
+  if (not ue_ref) {
     return SRSRAN_ERROR;
   }
 
   scheduler.dl_pmi_info(tti, rnti, enb_cc_idx, pmi_value);
-  ue_db[rnti]->metrics_dl_pmi(pmi_value);
+  (*ue_ref)->metrics_dl_pmi(pmi_value);
 
   return SRSRAN_SUCCESS;
 }
@@ -392,14 +359,13 @@ int mac::pmi_info(uint32_t tti, uint16_t rnti, uint32_t enb_cc_idx, uint32_t pmi
 int mac::cqi_info(uint32_t tti, uint16_t rnti, uint32_t enb_cc_idx, uint32_t cqi_value)
 {
   logger.set_context(tti);
-  srsran::rwlock_read_guard lock(rwlock);
-
-  if (not check_ue_active(rnti)) {
+  ue_db_t::ptr ue_ref = find_active_ue(rnti);
+  if (not ue_ref) {
     return SRSRAN_ERROR;
   }
 
   scheduler.dl_cqi_info(tti, rnti, enb_cc_idx, cqi_value);
-  ue_db[rnti]->metrics_dl_cqi(cqi_value);
+  (*ue_ref)->metrics_dl_cqi(cqi_value);
 
   return SRSRAN_SUCCESS;
 }
@@ -407,9 +373,8 @@ int mac::cqi_info(uint32_t tti, uint16_t rnti, uint32_t enb_cc_idx, uint32_t cqi
 int mac::sb_cqi_info(uint32_t tti, uint16_t rnti, uint32_t enb_cc_idx, uint32_t sb_idx, uint32_t cqi_value)
 {
   logger.set_context(tti);
-  srsran::rwlock_read_guard lock(rwlock);
-
-  if (not check_ue_active(rnti)) {
+  ue_db_t::ptr ue_ref = find_active_ue(rnti);
+  if (not ue_ref) {
     return SRSRAN_ERROR;
   }
 
@@ -420,9 +385,8 @@ int mac::sb_cqi_info(uint32_t tti, uint16_t rnti, uint32_t enb_cc_idx, uint32_t
 int mac::snr_info(uint32_t tti_rx, uint16_t rnti, uint32_t enb_cc_idx, float snr, ul_channel_t ch)
 {
   logger.set_context(tti_rx);
-  srsran::rwlock_read_guard lock(rwlock);
-
-  if (not check_ue_active(rnti)) {
+  ue_db_t::ptr ue_ref = find_active_ue(rnti);
+  if (not ue_ref) {
     return SRSRAN_ERROR;
   }
 
@@ -433,13 +397,12 @@ int mac::snr_info(uint32_t tti_rx, uint16_t rnti, uint32_t enb_cc_idx, float snr
 
 int mac::ta_info(uint32_t tti, uint16_t rnti, float ta_us)
 {
-  srsran::rwlock_read_guard lock(rwlock);
-
-  if (not check_ue_active(rnti)) {
+  ue_db_t::ptr ue_ref = find_active_ue(rnti);
+  if (not ue_ref) {
     return SRSRAN_ERROR;
   }
 
-  uint32_t nof_ta_count = ue_db[rnti]->set_ta_us(ta_us);
+  uint32_t nof_ta_count = (*ue_ref)->set_ta_us(ta_us);
   if (nof_ta_count > 0) {
     return scheduler.dl_mac_buffer_state(rnti, (uint32_t)srsran::dl_sch_lcid::TA_CMD, nof_ta_count);
   }
@@ -449,16 +412,15 @@ int mac::ta_info(uint32_t tti, uint16_t rnti, float ta_us)
 int mac::sr_detected(uint32_t tti, uint16_t rnti)
 {
   logger.set_context(tti);
-  srsran::rwlock_read_guard lock(rwlock);
-
-  if (not check_ue_active(rnti)) {
+  ue_db_t::ptr ue_ref = find_active_ue(rnti);
+  if (not ue_ref) {
     return SRSRAN_ERROR;
   }
 
   return scheduler.ul_sr_info(tti, rnti);
 }
 
-bool mac::is_valid_rnti_unprotected(uint16_t rnti)
+bool mac::is_valid_rnti(uint16_t rnti)
 {
   if (not started) {
     logger.info("RACH ignored as eNB is being shutdown");
@@ -477,46 +439,37 @@ bool mac::is_valid_rnti_unprotected(uint16_t rnti)
 
 uint16_t mac::allocate_ue(uint32_t enb_cc_idx)
 {
-  ue*      inserted_ue = nullptr;
-  uint16_t rnti        = SRSRAN_INVALID_RNTI;
+  bool     inserted = false;
+  uint16_t rnti     = SRSRAN_INVALID_RNTI;
 
   do {
     // Assign new RNTI
     rnti = FIRST_RNTI + (ue_counter.fetch_add(1, std::memory_order_relaxed) % 60000);
 
     // Pre-check if rnti is valid
-    {
-      srsran::rwlock_read_guard read_lock(rwlock);
-      if (not is_valid_rnti_unprotected(rnti)) {
-        continue;
-      }
+    if (not is_valid_rnti(rnti)) {
+      continue;
     }
 
     // Allocate and initialize UE object
     unique_rnti_ptr<ue> ue_ptr = make_rnti_obj<ue>(
         rnti, rnti, enb_cc_idx, &scheduler, rrc_h, rlc_h, phy_h, logger, cells.size(), softbuffer_pool.get());
 
-    // Add UE to rnti map
-    srsran::rwlock_write_guard rw_lock(rwlock);
-    if (not is_valid_rnti_unprotected(rnti)) {
-      continue;
-    }
-    auto ret = ue_db.insert(rnti, std::move(ue_ptr));
-    if (ret.has_value()) {
-      inserted_ue = ret.value()->second.get();
-    } else {
-      logger.info("Failed to allocate rnti=0x%x. Attempting a different rnti.", rnti);
+    // Set PCAP if available
+    if (pcap != nullptr) {
+      ue_ptr->start_pcap(pcap);
     }
-  } while (inserted_ue == nullptr);
 
-  // Set PCAP if available
-  if (pcap != nullptr) {
-    inserted_ue->start_pcap(pcap);
-  }
+    if (pcap_net != nullptr) {
+      ue_ptr->start_pcap_net(pcap_net);
+    }
 
-  if (pcap_net != nullptr) {
-    inserted_ue->start_pcap_net(pcap_net);
-  }
+    // Add UE to rnti map. The insertion fails if the slot of the rnti was taken in the meantime
+    inserted = ue_db.insert(rnti, std::move(ue_ptr));
+    if (not inserted) {
+      logger.info("Failed to allocate rnti=0x%x. Attempting a different rnti.", rnti);
+    }
+  } while (not inserted);
 
   return rnti;
 }
@@ -602,8 +555,6 @@ int mac::get_dl_sched(uint32_t tti_tx_dl, dl_sched_list_t& dl_sched_res_list)
     add_padding();
   }
 
-  srsran::rwlock_read_guard lock(rwlock);
-
   for (uint32_t enb_cc_idx = 0; enb_cc_idx < cell_config.size(); enb_cc_idx++) {
     // Run scheduler with current info
     sched_interface::dl_sched_res_t sched_result = {};
@@ -622,13 +573,14 @@ int mac::get_dl_sched(uint32_t tti_tx_dl, dl_sched_list_t& dl_sched_res_list)
       // Get UE
       uint16_t rnti = sched_result.data[i].dci.rnti;
 
-      if (ue_db.contains(rnti)) {
+      ue_db_t::ptr ue_ref = ue_db.find(rnti);
+      if (ue_ref) {
         // Copy dci info
         dl_sched_res->pdsch[n].dci = sched_result.data[i].dci;
 
         for (uint32_t tb = 0; tb < SRSRAN_MAX_TB; tb++) {
           dl_sched_res->pdsch[n].softbuffer_tx[tb] =
-              ue_db[rnti]->get_tx_softbuffer(enb_cc_idx, sched_result.data[i].dci.pid, tb);
+              (*ue_ref)->get_tx_softbuffer(enb_cc_idx, sched_result.data[i].dci.pid, tb);
 
           // If the Rx soft-buffer is not given, abort transmission
           if (dl_sched_res->pdsch[n].softbuffer_tx[tb] == nullptr) {
@@ -637,12 +589,12 @@ int mac::get_dl_sched(uint32_t tti_tx_dl, dl_sched_list_t& dl_sched_res_list)
 
           if (sched_result.data[i].nof_pdu_elems[tb] > 0) {
             /* Get PDU if it's a new transmission */
-            dl_sched_res->pdsch[n].data[tb] = ue_db[rnti]->generate_pdu(enb_cc_idx,
-                                                                        sched_result.data[i].dci.pid,
-                                                                        tb,
-                                                                        sched_result.data[i].pdu[tb],
-                                                                        sched_result.data[i].nof_pdu_elems[tb],
-                                                                        sched_result.data[i].tbs[tb]);
+            dl_sched_res->pdsch[n].data[tb] = (*ue_ref)->generate_pdu(enb_cc_idx,
+                                                                      sched_result.data[i].dci.pid,
+                                                                      tb,
+                                                                      sched_result.data[i].pdu[tb],
+                                                                      sched_result.data[i].nof_pdu_elems[tb],
+                                                                      sched_result.data[i].tbs[tb]);
 
             if (!dl_sched_res->pdsch[n].data[tb]) {
               logger.error("Error! PDU was not generated (rnti=0x%04x, tb=%d)", rnti, tb);
@@ -750,117 +702,122 @@ int mac::get_dl_sched(uint32_t tti_tx_dl, dl_sched_list_t& dl_sched_res_list)
   }
 
   // Count number of TTIs for all active users
-  for (auto& u : ue_db) {
-    u.second->metrics_cnt();
-  }
+  ue_db.for_each([](uint16_t rnti, unique_rnti_ptr<ue>& u) { u->metrics_cnt(); });
 
   return SRSRAN_SUCCESS;
 }
 
-void mac::build_mch_sched(uint32_t tbs)
+int mac::get_mch_sched_tbs(uint32_t mcs_idx)
 {
-  int sfs_per_sched_period = mcch.pmch_info_list[0].sf_alloc_end;
-  int bytes_per_sf         = tbs / 8 - 6; // leave 6 bytes for header
-
-  int total_space_avail_bytes = sfs_per_sched_period * bytes_per_sf;
-
-  int total_bytes_to_tx = 0;
-
-  // calculate total bytes to be scheduled
-  for (uint32_t i = 0; i < mch.num_mtch_sched; i++) {
-    total_bytes_to_tx += mch.mtch_sched[i].lcid_buffer_size;
-    mch.mtch_sched[i].stop = 0;
-  }
-
-  int last_mtch_stop = 0;
+  srsran_ra_tb_t mcs = {};
+  mcs.mcs_idx        = mcs_idx;
+  srsran_dl_fill_ra_mcs(&mcs, 0, cell_config[0].cell.nof_prb, false);
+  return mcs.tbs;
+}
 
-  if (total_bytes_to_tx > 0 && total_bytes_to_tx >= total_space_avail_bytes) {
-    for (uint32_t i = 0; i < mch.num_mtch_sched; i++) {
-      double ratio           = mch.mtch_sched[i].lcid_buffer_size / total_bytes_to_tx;
-      float  assigned_sfs    = floor(sfs_per_sched_period * ratio);
-      mch.mtch_sched[i].stop = last_mtch_stop + (uint32_t)assigned_sfs;
-      last_mtch_stop         = mch.mtch_sched[i].stop;
-    }
-  } else {
-    for (uint32_t i = 0; i < mch.num_mtch_sched; i++) {
-      float assigned_sfs     = ceil(((float)mch.mtch_sched[i].lcid_buffer_size) / ((float)bytes_per_sf));
-      mch.mtch_sched[i].stop = last_mtch_stop + (uint32_t)assigned_sfs;
-      last_mtch_stop         = mch.mtch_sched[i].stop;
+void mac::build_mch_sched()
+{
+  // The TBS of each PMCH depends on the cell bandwidth, which is only known once the cells are configured
+  if (not mch_scheduler.is_configured()) {
+    std::vector<mch_sched::pmch_cfg_t> pmch_cfgs(mcch.nof_pmch_info);
+    for (uint32_t i = 0; i < mcch.nof_pmch_info; ++i) {
+      const srsran::pmch_info_t& pmch = mcch.pmch_info_list[i];
+      pmch_cfgs[i].sf_alloc_end       = pmch.sf_alloc_end;
+      pmch_cfgs[i].sf_bytes           = get_mch_sched_tbs(pmch.data_mcs) / 8 - 6; // leave 6 bytes for header
+      for (uint32_t j = 0; j < pmch.nof_mbms_session_info; ++j) {
+        pmch_cfgs[i].lcids.push_back(pmch.mbms_session_info_list[j].lc_ch_id);
+      }
     }
+    mch_scheduler.set_cfg(pmch_cfgs);
   }
+  mch_scheduler.new_sched_period();
 }
 
 int mac::get_mch_sched(uint32_t tti, bool is_mcch, dl_sched_list_t& dl_sched_res_list)
 {
-  srsran::rwlock_read_guard lock(rwlock);
-  dl_sched_t*               dl_sched_res = &dl_sched_res_list[0];
+  dl_sched_t* dl_sched_res = &dl_sched_res_list[0];
   logger.set_context(tti);
-  srsran_ra_tb_t mcs      = {};
-  srsran_ra_tb_t mcs_data = {};
-  mcs.mcs_idx             = enum_to_number(this->sib13.mbsfn_area_info_list[0].mcch_cfg.sig_mcs);
-  mcs_data.mcs_idx        = this->mcch.pmch_info_list[0].data_mcs;
-  srsran_dl_fill_ra_mcs(&mcs, 0, cell_config[0].cell.nof_prb, false);
-  srsran_dl_fill_ra_mcs(&mcs_data, 0, cell_config[0].cell.nof_prb, false);
+  if (mcch.nof_pmch_info == 0) {
+    return SRSRAN_SUCCESS;
+  }
+  ue_db_t::ptr mch_ue_ref = ue_db.find(SRSRAN_MRNTI);
+  if (not mch_ue_ref) {
+    logger.error("User rnti=0x%x not found", SRSRAN_MRNTI);
+    return SRSRAN_ERROR;
+  }
+  ue* mch_ue = mch_ue_ref->get();
   if (is_mcch) {
-    build_mch_sched(mcs_data.tbs);
+    build_mch_sched();
     mch.mcch_payload              = mcch_payload_buffer;
     mch.current_sf_allocation_num = 1;
-    logger.info("MCH Sched Info: LCID: %d, Stop: %d, tti is %d ",
-                mch.mtch_sched[0].lcid,
-                mch.mtch_sched[mch.num_mtch_sched - 1].stop,
+    logger.info("MCH Sched Info: nof_pmch=%d, last_sf=%d, alloc_sfs=%d/%d, tti is %d ",
+                mch_scheduler.nof_pmchs(),
+                mch_scheduler.get_last_alloc_sf(),
+                mch_scheduler.get_period_metrics().nof_alloc_sfs,
+                mch_scheduler.get_period_metrics().nof_data_sfs,
                 tti);
-    phy_h->set_mch_period_stop(mch.mtch_sched[mch.num_mtch_sched - 1].stop);
-    for (uint32_t i = 0; i < mch.num_mtch_sched; i++) {
-      mch.pdu[i].lcid = (uint32_t)srsran::mch_lcid::MCH_SCHED_INFO;
-      // m1u.mtch_sched[i].lcid = 1+i;
+    phy_h->set_mch_period_stop(mch_scheduler.get_last_alloc_sf());
+
+    // The MCCH subframe carries the MSI of the first PMCH, followed by the MCCH
+    uint32_t mcch_tbs = get_mch_sched_tbs(enum_to_number(this->sib13.mbsfn_area_info_list[0].mcch_cfg.sig_mcs));
+    uint32_t nof_msi  = 0;
+    if (mch_scheduler.nof_pmchs() > 0) {
+      for (const mch_sched::msi_entry_t& e : mch_scheduler.get_msi(0)) {
+        mch.pdu[nof_msi].lcid        = (uint32_t)srsran::mch_lcid::MCH_SCHED_INFO;
+        mch.mtch_sched[nof_msi].lcid = e.lcid;
+        mch.mtch_sched[nof_msi].stop = e.stop;
+        nof_msi++;
+      }
     }
-
-    mch.pdu[mch.num_mtch_sched].lcid   = 0;
-    mch.pdu[mch.num_mtch_sched].nbytes = current_mcch_length;
-    dl_sched_res->pdsch[0].dci.rnti    = SRSRAN_MRNTI;
+    mch.pdu[nof_msi].lcid           = 0;
+    mch.pdu[nof_msi].nbytes         = current_mcch_length;
+    dl_sched_res->pdsch[0].dci.rnti = SRSRAN_MRNTI;
 
     // we use TTI % HARQ to make sure we use different buffers for consecutive TTIs to avoid races between PHY workers
-    ue_db[SRSRAN_MRNTI]->metrics_tx(true, mcs.tbs);
+    mch_ue->metrics_tx(true, mcch_tbs);
     dl_sched_res->pdsch[0].data[0] =
-        ue_db[SRSRAN_MRNTI]->generate_mch_pdu(tti % SRSRAN_FDD_NOF_HARQ, mch, mch.num_mtch_sched + 1, mcs.tbs / 8);
+        mch_ue->generate_mch_pdu(tti % SRSRAN_FDD_NOF_HARQ, mch, nof_msi + 1, mcch_tbs / 8);
 
   } else {
-    uint32_t current_lcid = 1;
-    uint32_t mtch_index   = 0;
-    uint32_t mtch_stop    = mch.mtch_sched[mch.num_mtch_sched - 1].stop;
-
-    for (uint32_t i = 0; i < mch.num_mtch_sched; i++) {
-      if (mch.current_sf_allocation_num <= mch.mtch_sched[i].stop) {
-        current_lcid = mch.mtch_sched[i].lcid;
-        mtch_index   = i;
-        break;
+    mch_sched::sf_alloc_t alloc     = mch_scheduler.get_sf_alloc(mch.current_sf_allocation_num);
+    dl_sched_res->pdsch[0].dci.rnti = 0;
+    dl_sched_res->pdsch[0].data[0]  = nullptr;
+
+    if (alloc.type == mch_sched::sf_alloc_t::type_t::msi) {
+      // The first subframe of the other PMCHs only carries their MSI
+      uint32_t                      tbs     = get_mch_sched_tbs(mcch.pmch_info_list[alloc.pmch_idx].data_mcs);
+      sched_interface::dl_pdu_mch_t msi     = {};
+      uint32_t                      nof_msi = 0;
+      for (const mch_sched::msi_entry_t& e : mch_scheduler.get_msi(alloc.pmch_idx)) {
+        msi.pdu[nof_msi].lcid        = (uint32_t)srsran::mch_lcid::MCH_SCHED_INFO;
+        msi.mtch_sched[nof_msi].lcid = e.lcid;
+        msi.mtch_sched[nof_msi].stop = e.stop;
+        nof_msi++;
       }
-    }
-    if (mch.current_sf_allocation_num <= mtch_stop) {
-      int requested_bytes = (mcs_data.tbs / 8 > (int)mch.mtch_sched[mtch_index].lcid_buffer_size)
-                                ? (mch.mtch_sched[mtch_index].lcid_buffer_size)
-                                : ((mcs_data.tbs / 8) - 2);
-      int bytes_received = ue_db[SRSRAN_MRNTI]->read_pdu(current_lcid, mtch_payload_buffer, requested_bytes);
-      mch.pdu[0].lcid    = current_lcid;
-      mch.pdu[0].nbytes  = bytes_received;
-      mch.mtch_sched[0].mtch_payload  = mtch_payload_buffer;
       dl_sched_res->pdsch[0].dci.rnti = SRSRAN_MRNTI;
+      mch_ue->metrics_tx(true, tbs);
+      dl_sched_res->pdsch[0].data[0] =
+          mch_ue->generate_mch_pdu(tti % SRSRAN_FDD_NOF_HARQ, msi, nof_msi, tbs / 8);
+    } else if (alloc.type == mch_sched::sf_alloc_t::type_t::mtch) {
+      int      tbs             = get_mch_sched_tbs(mcch.pmch_info_list[alloc.pmch_idx].data_mcs);
+      uint32_t buffer_size     = mch_scheduler.get_buffer_state(alloc.lcid);
+      int      requested_bytes = (tbs / 8 > (int)buffer_size) ? buffer_size : ((tbs / 8) - 2);
+      int      bytes_received  = mch_ue->read_pdu(alloc.lcid, mtch_payload_buffer, requested_bytes);
+      mch.pdu[0].lcid                = alloc.lcid;
+      mch.pdu[0].nbytes              = bytes_received;
+      mch.mtch_sched[0].mtch_payload = mtch_payload_buffer;
       if (bytes_received) {
-        ue_db[SRSRAN_MRNTI]->metrics_tx(true, mcs.tbs);
+        dl_sched_res->pdsch[0].dci.rnti = SRSRAN_MRNTI;
+        mch_ue->metrics_tx(true, tbs);
         dl_sched_res->pdsch[0].data[0] =
-            ue_db[SRSRAN_MRNTI]->generate_mch_pdu(tti % SRSRAN_FDD_NOF_HARQ, mch, 1, mcs_data.tbs / 8);
+            mch_ue->generate_mch_pdu(tti % SRSRAN_FDD_NOF_HARQ, mch, 1, tbs / 8);
       }
-    } else {
-      dl_sched_res->pdsch[0].dci.rnti = 0;
-      dl_sched_res->pdsch[0].data[0]  = nullptr;
     }
     mch.current_sf_allocation_num++;
   }
 
   // Count number of TTIs for all active users
-  for (auto& u : ue_db) {
-    u.second->metrics_cnt();
-  }
+  ue_db.for_each([](uint16_t rnti, unique_rnti_ptr<ue>& u) { u->metrics_cnt(); });
   return SRSRAN_SUCCESS;
 }
 
@@ -906,12 +863,8 @@ int mac::get_ul_sched(uint32_t tti_tx_ul, ul_sched_list_t& ul_sched_res_list)
 
   logger.set_context(TTI_SUB(tti_tx_ul, FDD_HARQ_DELAY_UL_MS + FDD_HARQ_DELAY_DL_MS));
 
-  srsran::rwlock_read_guard lock(rwlock);
-
   // Execute UE FSMs (e.g. TA)
-  for (auto& ue : ue_db) {
-    ue.second->tic();
-  }
+  ue_db.for_each([](uint16_t rnti, unique_rnti_ptr<ue>& u) { u->tic(); });
 
   for (uint32_t enb_cc_idx = 0; enb_cc_idx < cell_config.size(); enb_cc_idx++) {
     ul_sched_t* phy_ul_sched_res = &ul_sched_res_list[enb_cc_idx];
@@ -931,13 +884,14 @@ int mac::get_ul_sched(uint32_t tti_tx_ul, ul_sched_list_t& ul_sched_res_list)
         // Get UE
         uint16_t rnti = sched_result.pusch[i].dci.rnti;
 
-        if (ue_db.contains(rnti)) {
+        ue_db_t::ptr ue_ref = ue_db.find(rnti);
+        if (ue_ref) {
           // Copy grant info
           phy_ul_sched_res->pusch[n].current_tx_nb = sched_result.pusch[i].current_tx_nb;
           phy_ul_sched_res->pusch[n].pid           = TTI_RX(tti_tx_ul) % SRSRAN_FDD_NOF_HARQ;
           phy_ul_sched_res->pusch[n].needs_pdcch   = sched_result.pusch[i].needs_pdcch;
           phy_ul_sched_res->pusch[n].dci           = sched_result.pusch[i].dci;
-          phy_ul_sched_res->pusch[n].softbuffer_rx = ue_db[rnti]->get_rx_softbuffer(enb_cc_idx, tti_tx_ul);
+          phy_ul_sched_res->pusch[n].softbuffer_rx = (*ue_ref)->get_rx_softbuffer(enb_cc_idx, tti_tx_ul);
 
           // If the Rx soft-buffer is not given, abort reception
           if (phy_ul_sched_res->pusch[n].softbuffer_rx == nullptr) {
@@ -949,7 +903,7 @@ int mac::get_ul_sched(uint32_t tti_tx_ul, ul_sched_list_t& ul_sched_res_list)
             srsran_softbuffer_rx_reset_tbs(phy_ul_sched_res->pusch[n].softbuffer_rx, sched_result.pusch[i].tbs * 8);
           }
           phy_ul_sched_res->pusch[n].data =
-              ue_db[rnti]->request_buffer(tti_tx_ul, enb_cc_idx, sched_result.pusch[i].tbs);
+              (*ue_ref)->request_buffer(tti_tx_ul, enb_cc_idx, sched_result.pusch[i].tbs);
           if (phy_ul_sched_res->pusch[n].data) {
             phy_ul_sched_res->nof_grants++;
           } else {
@@ -973,24 +927,19 @@ int mac::get_ul_sched(uint32_t tti_tx_ul, ul_sched_list_t& ul_sched_res_list)
     phy_ul_sched_res->nof_phich = sched_result.phich.size();
   }
   // clear old buffers from all users
-  for (auto& u : ue_db) {
-    u.second->clear_old_buffers(tti_tx_ul);
-  }
+  ue_db.for_each([tti_tx_ul](uint16_t rnti, unique_rnti_ptr<ue>& u) { u->clear_old_buffers(tti_tx_ul); });
   return SRSRAN_SUCCESS;
 }
 
+// Note: Called by the RRC at initialization, before the PHY workers start
 void mac::write_mcch(const srsran::sib2_mbms_t* sib2_,
                      const srsran::sib13_t*     sib13_,
                      const srsran::mcch_msg_t*  mcch_,
                      const uint8_t*             mcch_payload,
                      const uint8_t              mcch_payload_length)
 {
-  srsran::rwlock_write_guard lock(rwlock);
-  mcch               = *mcch_;
-  mch.num_mtch_sched = this->mcch.pmch_info_list[0].nof_mbms_session_info;
-  for (uint32_t i = 0; i < mch.num_mtch_sched; ++i) {
-    mch.mtch_sched[i].lcid = this->mcch.pmch_info_list[0].mbms_session_info_list[i].lc_ch_id;
-  }
+  mcch = *mcch_;
+  mch_scheduler.clear_cfg();
   sib2  = *sib2_;
   sib13 = *sib13_;
   memcpy(mcch_payload_buffer, mcch_payload, mcch_payload_length * sizeof(uint8_t));
@@ -999,21 +948,22 @@ void mac::write_mcch(const srsran::sib2_mbms_t* sib2_,
   unique_rnti_ptr<ue> ue_ptr = make_rnti_obj<ue>(
       SRSRAN_MRNTI, SRSRAN_MRNTI, 0, &scheduler, rrc_h, rlc_h, phy_h, logger, cells.size(), softbuffer_pool.get());
 
-  auto ret = ue_db.insert(SRSRAN_MRNTI, std::move(ue_ptr));
-  if (!ret) {
+  if (not ue_db.insert(SRSRAN_MRNTI, std::move(ue_ptr))) {
     logger.info("Failed to allocate rnti=0x%x.for eMBMS", SRSRAN_MRNTI);
   }
   rrc_h->add_user(SRSRAN_MRNTI, {});
 }
 
-// Internal helper function, caller must hold UE DB rwlock
-bool mac::check_ue_active(uint16_t rnti)
+// Internal helper function. Returns an empty reference if the UE does not exist or is not active
+mac::ue_db_t::ptr mac::find_active_ue(uint16_t rnti)
 {
-  if (not ue_db.contains(rnti)) {
+  ue_db_t::ptr ue_ref = ue_db.find(rnti);
+  if (not ue_ref) {
     logger.error("User rnti=0x%x not found", rnti);
-    return false;
+  } else if (not(*ue_ref)->is_active()) {
+    ue_ref.reset();
   }
-  return ue_db[rnti]->is_active();
+  return ue_ref;
 }
 
 } // namespace srsenb
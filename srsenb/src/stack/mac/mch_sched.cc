@@ -0,0 +1,190 @@
+/**
+ * Copyright 2013-2021 Software Radio Systems Limited
+ *
+ * This file is part of srsRAN.
+ *
+ * srsRAN is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsRAN is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+#include "srsenb/hdr/stack/mac/mch_sched.h"
+#include <algorithm>
+
+namespace srsenb {
+
+const uint32_t mch_sched::MAX_MTCH_PER_PMCH;
+const uint32_t mch_sched::MAX_MTCH_LCID;
+const uint32_t mch_sched::MTCH_STOP_EMPTY;
+
+void mch_sched::set_cfg(const std::vector<pmch_cfg_t>& cfg)
+{
+  pmchs.clear();
+  pmchs.reserve(cfg.size());
+
+  uint32_t first_sf = 0;
+  for (const pmch_cfg_t& pmch_cfg : cfg) {
+    if (pmch_cfg.sf_alloc_end < first_sf or pmch_cfg.sf_bytes == 0) {
+      logger.error(
+          "Invalid PMCH configuration. sf_alloc_end=%d, sf_bytes=%d", pmch_cfg.sf_alloc_end, pmch_cfg.sf_bytes);
+      pmchs.clear();
+      return;
+    }
+    pmchs.emplace_back();
+    pmch_t& pmch  = pmchs.back();
+    pmch.cfg      = pmch_cfg;
+    pmch.first_sf = first_sf;
+    if (pmch.cfg.lcids.size() > MAX_MTCH_PER_PMCH) {
+      logger.warning("PMCH %zd: Only the first %d of %zd MTCHs are scheduled",
+                     pmchs.size() - 1,
+                     MAX_MTCH_PER_PMCH,
+                     pmch.cfg.lcids.size());
+      pmch.cfg.lcids.resize(MAX_MTCH_PER_PMCH);
+    }
+    for (uint32_t lcid : pmch.cfg.lcids) {
+      pmch.mtchs.emplace_back();
+      pmch.mtchs.back().lcid = lcid;
+      pmch.msi.push_back(msi_entry_t{lcid, MTCH_STOP_EMPTY});
+    }
+    first_sf = pmch_cfg.sf_alloc_end + 1;
+  }
+  metrics = {};
+}
+
+void mch_sched::clear_cfg()
+{
+  pmchs.clear();
+  metrics = {};
+}
+
+void mch_sched::set_buffer_state(uint32_t lcid, uint32_t tx_queue)
+{
+  if (lcid <= MAX_MTCH_LCID) {
+    buffer_state[lcid].store(tx_queue, std::memory_order_relaxed);
+  }
+}
+
+uint32_t mch_sched::get_buffer_state(uint32_t lcid) const
+{
+  return lcid <= MAX_MTCH_LCID ? buffer_state[lcid].load(std::memory_order_relaxed) : 0;
+}
+
+void mch_sched::new_sched_period()
+{
+  metrics = {};
+  for (pmch_t& pmch : pmchs) {
+    sched_pmch(pmch);
+  }
+}
+
+void mch_sched::sched_pmch(pmch_t& pmch)
+{
+  const uint32_t sf_bytes     = pmch.cfg.sf_bytes;
+  const uint32_t nof_data_sfs = pmch.cfg.sf_alloc_end - pmch.first_sf;
+  const uint32_t nof_mtchs    = pmch.mtchs.size();
+
+  // Pending bytes of each MTCH, sampled once for the whole period
+  std::array<uint32_t, MAX_MTCH_PER_PMCH> pending = {};
+  for (uint32_t i = 0; i < nof_mtchs; ++i) {
+    pending[i]            = get_buffer_state(pmch.mtchs[i].lcid);
+    pmch.mtchs[i].nof_sfs = 0;
+    pmch.mtchs[i].deficit = (pending[i] > 0) ? pmch.mtchs[i].deficit : 0;
+  }
+
+  // Deficit round robin with a quantum of one subframe. The cost of a subframe is the number of bytes it carries, so
+  // an MTCH that only fills part of its last subframe is charged accordingly. Deficits of MTCHs that are still
+  // backlogged when the subframes run out carry over to the next period, and the first MTCH of a round rotates
+  uint32_t nof_free_sfs = nof_data_sfs;
+  bool     backlogged   = true;
+  while (nof_free_sfs > 0 and backlogged) {
+    backlogged = false;
+    for (uint32_t n = 0; n < nof_mtchs and nof_free_sfs > 0; ++n) {
+      mtch_t&   mtch = pmch.mtchs[(pmch.rr_start + n) % nof_mtchs];
+      uint32_t& rem  = pending[(pmch.rr_start + n) % nof_mtchs];
+      if (rem == 0) {
+        mtch.deficit = 0;
+        continue;
+      }
+      mtch.deficit += sf_bytes;
+      while (rem > 0 and nof_free_sfs > 0 and mtch.deficit >= (int64_t)std::min(rem, sf_bytes)) {
+        uint32_t nbytes = std::min(rem, sf_bytes);
+        mtch.deficit -= nbytes;
+        rem -= nbytes;
+        mtch.nof_sfs++;
+        nof_free_sfs--;
+      }
+      backlogged |= rem > 0;
+    }
+  }
+  if (nof_mtchs > 0) {
+    pmch.rr_start = (pmch.rr_start + 1) % nof_mtchs;
+  }
+
+  // Lay out the MTCHs in consecutive subframes, after the MSI subframe
+  uint32_t stop = 0;
+  for (uint32_t i = 0; i < nof_mtchs; ++i) {
+    if (pmch.mtchs[i].nof_sfs > 0) {
+      stop += pmch.mtchs[i].nof_sfs;
+      pmch.msi[i].stop = stop;
+    } else {
+      pmch.msi[i].stop = MTCH_STOP_EMPTY;
+    }
+  }
+
+  metrics.nof_data_sfs += nof_data_sfs;
+  metrics.nof_alloc_sfs += stop;
+}
+
+mch_sched::sf_alloc_t mch_sched::get_sf_alloc(uint32_t sf_idx) const
+{
+  sf_alloc_t alloc;
+  for (uint32_t pmch_idx = 0; pmch_idx < pmchs.size(); ++pmch_idx) {
+    const pmch_t& pmch = pmchs[pmch_idx];
+    if (sf_idx > pmch.cfg.sf_alloc_end) {
+      continue;
+    }
+    alloc.pmch_idx = pmch_idx;
+    uint32_t rel   = sf_idx - pmch.first_sf;
+    if (rel == 0) {
+      alloc.type = sf_alloc_t::type_t::msi;
+      return alloc;
+    }
+    for (const msi_entry_t& e : pmch.msi) {
+      if (e.stop != MTCH_STOP_EMPTY and e.stop >= rel) {
+        alloc.type = sf_alloc_t::type_t::mtch;
+        alloc.lcid = e.lcid;
+        return alloc;
+      }
+    }
+    return alloc;
+  }
+  return alloc;
+}
+
+uint32_t mch_sched::get_last_alloc_sf() const
+{
+  uint32_t last = 0;
+  for (const pmch_t& pmch : pmchs) {
+    uint32_t stop = 0;
+    for (const msi_entry_t& e : pmch.msi) {
+      if (e.stop != MTCH_STOP_EMPTY) {
+        stop = std::max(stop, e.stop);
+      }
+    }
+    last = pmch.first_sf + stop;
+  }
+  return last;
+}
+
+} // namespace srsenb
@@ -449,6 +449,7 @@ int mac_nr::pusch_info(const srsran_slot_cfg_t& slot_cfg, mac_interface_phy_nr::
   if (ue_db.contains(rnti)) {
     ue_db[rnti]->metrics_rx(pusch_info.pusch_data.tb[0].crc, nof_bytes);
     ue_db[rnti]->metrics_pusch_sinr(pusch_info.csi.snr_dB);
+    ue_db[rnti]->metrics_pusch_fec(pusch_info.pusch_data.tb[0]);
   }
   return SRSRAN_SUCCESS;
 }
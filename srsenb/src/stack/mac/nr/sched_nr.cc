@@ -77,7 +77,13 @@ private:
 
 sched_nr::sched_nr() : logger(&srslog::fetch_basic_logger("MAC-NR")) {}
 
-sched_nr::~sched_nr() {}
+sched_nr::~sched_nr()
+{
+  // The cell workers must stop before the cells they schedule are destroyed
+  if (sched_workers != nullptr) {
+    sched_workers->stop();
+  }
+}
 
 int sched_nr::config(const sched_args_t& sched_cfg, srsran::const_span<cell_cfg_t> cell_list)
 {
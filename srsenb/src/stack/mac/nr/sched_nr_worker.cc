@@ -23,6 +23,9 @@
 #include "srsenb/hdr/stack/mac/common/mac_metrics.h"
 #include "srsenb/hdr/stack/mac/nr/sched_nr_signalling.h"
 #include "srsran/common/string_helpers.h"
+#include "srsran/common/threads.h"
+#include <semaphore.h>
+#include <thread>
 
 namespace srsenb {
 namespace sched_nr_impl {
@@ -36,43 +39,31 @@ slot_cc_worker::slot_cc_worker(serv_cell_manager& cc_sched) :
 
 void slot_cc_worker::enqueue_cc_event(srsran::move_callback<void()> ev)
 {
-  std::lock_guard<std::mutex> lock(feedback_mutex);
-  pending_events.emplace_back();
-  pending_events.back() = std::move(ev);
+  pending_events.push(std::move(ev));
 }
 
 void slot_cc_worker::enqueue_cc_feedback(uint16_t rnti, feedback_callback_t fdbk)
 {
-  std::lock_guard<std::mutex> lock(feedback_mutex);
-  pending_feedback.emplace_back();
-  pending_feedback.back().rnti = rnti;
-  pending_feedback.back().fdbk = std::move(fdbk);
+  feedback_t f;
+  f.rnti = rnti;
+  f.fdbk = std::move(fdbk);
+  pending_feedback.push(std::move(f));
 }
 
 void slot_cc_worker::run_feedback(ue_map_t& ue_db)
 {
-  {
-    std::lock_guard<std::mutex> lock(feedback_mutex);
-    tmp_feedback_to_run.swap(pending_feedback);
-    tmp_events_to_run.swap(pending_events);
-  }
+  pending_events.drain([](srsran::move_callback<void()>& ev) { ev(); });
 
-  for (srsran::move_callback<void()>& ev : tmp_events_to_run) {
-    ev();
-  }
-  tmp_events_to_run.clear();
-
-  for (feedback_t& f : tmp_feedback_to_run) {
+  pending_feedback.drain([this, &ue_db](feedback_t& f) {
     if (ue_db.contains(f.rnti) and ue_db[f.rnti]->carriers[cfg.cc] != nullptr) {
       f.fdbk(*ue_db[f.rnti]->carriers[cfg.cc]);
     } else {
       logger.info("SCHED: feedback received for rnti=0x%x, cc=%d that has been removed.", f.rnti, cfg.cc);
     }
-  }
-  tmp_feedback_to_run.clear();
+  });
 }
 
-/// Called within a locked context, to generate {slot, cc} scheduling decision
+/// Called once the UE DB is updated for the slot, to generate {slot, cc} scheduling decision
 void slot_cc_worker::run(slot_point pdcch_slot, ue_map_t& ue_db)
 {
   srsran_assert(not running(), "scheduler worker::start() called for active worker");
@@ -229,6 +220,107 @@ void slot_cc_worker::postprocess_decisions()
 
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
+/**
+ * Pinned worker that generates the scheduling decisions of one cell ahead of time. The slots to schedule are pushed by
+ * the thread that calls run_slot, which then collects the result of the slot once the worker has generated it
+ */
+class sched_worker_manager::cell_worker final : public srsran::thread
+{
+public:
+  static constexpr uint32_t max_pipelined_slots = 4;
+
+  cell_worker(sched_worker_manager& parent_, uint32_t cc_) :
+    thread("SCHED_NR_CC" + std::to_string(cc_)), parent(parent_), cc(cc_)
+  {
+    sem_init(&pending_requests, 0, 0);
+    int cpu = parent.cfg.sched_cfg.worker_cpu;
+    running = cpu >= 0 ? start_cpu(-1, cpu + cc) : start();
+  }
+  ~cell_worker() override
+  {
+    stop();
+    sem_destroy(&pending_requests);
+  }
+
+  /// Request the scheduling of all the slots up to slot_tx + nof_slots_ahead that were not requested yet
+  void request_slots(slot_point slot_tx, uint32_t nof_slots_ahead)
+  {
+    slot_point last_slot = slot_tx + nof_slots_ahead;
+    slot_point next_slot = (last_requested.valid() and slot_tx <= last_requested) ? last_requested + 1 : slot_tx;
+    for (; next_slot <= last_slot; ++next_slot) {
+      push_request(next_slot);
+    }
+    last_requested = last_slot;
+  }
+
+  /// Wait for the result of slot_tx and copy it
+  void pop_result(slot_point slot_tx, dl_sched_res_t& dl_res, ul_sched_t& ul_res)
+  {
+    slot_result_t& r = results[slot_tx.to_uint() % results.size()];
+    // The generation of a slot takes tens of microseconds, so it is cheaper to spin than to block
+    while (r.slot_idx.load(std::memory_order_acquire) != slot_tx.to_uint()) {
+      std::this_thread::yield();
+    }
+    dl_res.dl_sched = r.dl_sched;
+    dl_res.rar      = r.rar;
+    ul_res          = r.ul_res;
+  }
+
+  void stop()
+  {
+    if (running) {
+      push_request(slot_point{});
+      wait_thread_finish();
+      running = false;
+    }
+  }
+
+private:
+  void push_request(slot_point slot_tx)
+  {
+    bool success = requests.try_push(slot_tx);
+    srsran_assert(success, "Too many slots requested to the scheduler worker of cc=%d", cc);
+    sem_post(&pending_requests);
+  }
+
+  void run_thread() override
+  {
+    while (true) {
+      if (sem_wait(&pending_requests) != 0) {
+        continue;
+      }
+      slot_point slot_tx;
+      if (not requests.try_pop(slot_tx) or not slot_tx.valid()) {
+        return;
+      }
+      slot_result_t& r = results[slot_tx.to_uint() % results.size()];
+      dl_sched_res_t dl_res{r.rar, r.dl_sched};
+      parent.run_slot_impl(slot_tx, cc, dl_res, r.ul_res);
+      r.slot_idx.store(slot_tx.to_uint(), std::memory_order_release);
+    }
+  }
+
+  struct slot_result_t {
+    std::atomic<uint32_t> slot_idx{no_slot};
+    dl_sched_t            dl_sched;
+    sched_rar_list_t      rar;
+    ul_sched_t            ul_res;
+  };
+
+  sched_worker_manager& parent;
+  const uint32_t        cc;
+  bool                  running = false;
+
+  // Only accessed by the thread that calls run_slot
+  slot_point last_requested;
+
+  srsran::static_mpmc_queue<slot_point, 2 * max_pipelined_slots> requests;
+  sem_t                                                          pending_requests;
+  std::array<slot_result_t, 2 * max_pipelined_slots>             results;
+};
+
+constexpr uint32_t sched_worker_manager::cell_worker::max_pipelined_slots;
+
 sched_worker_manager::sched_worker_manager(ue_map_t&                                         ue_db_,
                                            const sched_params&                               cfg_,
                                            srsran::span<std::unique_ptr<serv_cell_manager> > cells_) :
@@ -238,14 +330,38 @@ sched_worker_manager::sched_worker_manager(ue_map_t&
   for (uint32_t cc = 0; cc < cfg.cells.size(); ++cc) {
     cc_worker_list.emplace_back(new cc_context{*cells[cc]});
   }
+
+  if (cfg.sched_cfg.nof_pipelined_slots > 0) {
+    if (cfg.sched_cfg.nof_pipelined_slots > cell_worker::max_pipelined_slots) {
+      logger.warning("SCHED: Number of pipelined slots=%d is limited to %d",
+                     cfg.sched_cfg.nof_pipelined_slots,
+                     cell_worker::max_pipelined_slots);
+    }
+    cell_workers.reserve(cfg.cells.size());
+    for (uint32_t cc = 0; cc < cfg.cells.size(); ++cc) {
+      cell_workers.emplace_back(new cell_worker{*this, cc});
+    }
+  }
 }
 
-sched_worker_manager::~sched_worker_manager() = default;
+sched_worker_manager::~sched_worker_manager()
+{
+  stop();
+}
+
+void sched_worker_manager::stop()
+{
+  for (auto& w : cell_workers) {
+    w->stop();
+  }
+}
 
 void sched_worker_manager::enqueue_event(uint16_t rnti, srsran::move_callback<void()> ev)
 {
-  std::lock_guard<std::mutex> lock(event_mutex);
-  next_slot_events.push_back(ue_event_t{rnti, std::move(ev)});
+  ue_event_t e;
+  e.rnti     = rnti;
+  e.callback = std::move(ev);
+  pending_events.push(std::move(e));
 }
 
 void sched_worker_manager::enqueue_cc_event(uint32_t cc, srsran::move_callback<void()> ev)
@@ -254,29 +370,39 @@ void sched_worker_manager::enqueue_cc_event(uint32_t cc, srsran::move_callback<v
 }
 
 /**
- * Update UEs state that is non-CC specific (e.g. SRs, buffer status, UE configuration)
+ * Update UEs state that is non-CC specific (e.g. SRs, buffer status, UE configuration), and prepare the UEs with CA for
+ * the new slot. Called by the first worker of the slot, before the other workers start
  * @param slot_tx
- * @param locked_context to update only UEs with CA enabled or not
  */
-void sched_worker_manager::update_ue_db(slot_point slot_tx, bool locked_context)
+void sched_worker_manager::update_ue_db(slot_point slot_tx)
 {
+  std::lock_guard<std::mutex> lock(ue_db_mutex);
+
   // process non-cc specific feedback if pending (e.g. SRs, buffer updates, UE config)
-  for (ue_event_t& ev : slot_events) {
-    if ((locked_context and not ue_db.contains(ev.rnti)) or
-        (ue_db.contains(ev.rnti) and ue_db[ev.rnti]->has_ca() == locked_context)) {
-      ev.callback();
-    }
-  }
+  pending_events.drain([](ue_event_t& ev) { ev.callback(); });
 
-  // prepare UEs internal state for new slot
+  // prepare internal state of UEs with CA for new slot. The other UEs are prepared by the worker of their PCell
   for (auto& u : ue_db) {
-    if (u.second->has_ca() == locked_context) {
+    if (u.second->has_ca()) {
       u.second->new_slot(slot_tx);
     }
   }
 }
 
 void sched_worker_manager::run_slot(slot_point slot_tx, uint32_t cc, dl_sched_res_t& dl_res, ul_sched_t& ul_res)
+{
+  if (cell_workers.empty()) {
+    run_slot_impl(slot_tx, cc, dl_res, ul_res);
+    return;
+  }
+
+  // Keep the cell worker nof_pipelined_slots ahead, and collect the result of slot_tx
+  uint32_t nof_slots_ahead = std::min(cfg.sched_cfg.nof_pipelined_slots, cell_worker::max_pipelined_slots);
+  cell_workers[cc]->request_slots(slot_tx, nof_slots_ahead);
+  cell_workers[cc]->pop_result(slot_tx, dl_res, ul_res);
+}
+
+void sched_worker_manager::run_slot_impl(slot_point slot_tx, uint32_t cc, dl_sched_res_t& dl_res, ul_sched_t& ul_res)
 {
   // Fill DL signalling messages that do not depend on UEs state
   serv_cell_manager& serv_cell = *cells[cc];
@@ -284,73 +410,53 @@ void sched_worker_manager::run_slot(slot_point slot_tx, uint32_t cc, dl_sched_re
   sched_dl_signalling(*serv_cell.bwps[0].cfg, slot_tx, bwp_slot.ssb, bwp_slot.nzp_csi_rs);
 
   // Synchronization point between CC workers, to avoid concurrency in UE state access
-  srsran::bounded_vector<std::condition_variable*, SRSRAN_MAX_CARRIERS> waiting_cvars;
-  {
-    std::unique_lock<std::mutex> lock(slot_mutex);
-    while (current_slot.valid() and current_slot != slot_tx) {
-      // Wait for previous slot to finish
-      cc_worker_list[cc]->waiting++;
-      cc_worker_list[cc]->cvar.wait(lock);
-      cc_worker_list[cc]->waiting--;
-    }
-    if (not current_slot.valid()) {
-      /* First Worker to start slot */
-
-      // process non-cc specific feedback if pending for UEs with CA
-      // NOTE: there is no parallelism in these operations
-      slot_events.clear();
-      {
-        std::lock_guard<std::mutex> ev_lock(event_mutex);
-        next_slot_events.swap(slot_events);
-      }
-      update_ue_db(slot_tx, true);
-
-      // mark the start of slot. awake remaining workers if locking on the mutex
-      current_slot = slot_tx;
-      worker_count.store(static_cast<int>(cc_worker_list.size()), std::memory_order_relaxed);
-      for (auto& w : cc_worker_list) {
-        if (w->waiting > 0) {
-          waiting_cvars.push_back(&w->cvar);
-        }
-      }
-      lock.unlock();
-      for (auto& w : waiting_cvars) {
-        w->notify_one();
+  uint32_t slot_idx = slot_tx.to_uint();
+  uint32_t prev_idx = no_slot;
+  while (not current_slot.compare_exchange_weak(prev_idx, slot_idx, std::memory_order_acq_rel)) {
+    if (prev_idx == slot_idx) {
+      // Another worker started the slot. Wait for it to update the UE DB
+      while (not slot_ready.load(std::memory_order_acquire)) {
+        std::this_thread::yield();
       }
-      waiting_cvars.clear();
+      break;
     }
+    // Wait for previous slot to finish
+    prev_idx = no_slot;
+    std::this_thread::yield();
+  }
+  if (prev_idx == no_slot) {
+    /* First Worker to start slot */
+
+    // process non-cc specific feedback and prepare UEs with CA for the new slot
+    // NOTE: there is no parallelism in these operations
+    worker_count.store(static_cast<int>(cc_worker_list.size()), std::memory_order_relaxed);
+    update_ue_db(slot_tx);
+
+    // mark the start of slot. Remaining workers stop spinning
+    slot_ready.store(true, std::memory_order_release);
   }
 
   /* Parallel Region */
 
-  // process non-cc specific feedback if pending (e.g. SRs, buffer updates, UE config) for UEs without CA
-  update_ue_db(slot_tx, false);
+  // prepare internal state of the UEs without CA that have this cell as PCell for new slot
+  for (auto& u : ue_db) {
+    if (not u.second->has_ca() and u.second->pcell_cc() == cc) {
+      u.second->new_slot(slot_tx);
+    }
+  }
 
   // process pending feedback, generate {slot, cc} scheduling decision
   cc_worker_list[cc]->worker.run(slot_tx, ue_db);
 
   // decrement the number of active workers
-  int rem_workers = worker_count.fetch_sub(1, std::memory_order_release) - 1;
+  int rem_workers = worker_count.fetch_sub(1, std::memory_order_acq_rel) - 1;
   srsran_assert(rem_workers >= 0, "invalid number of calls to run_slot(slot, cc)");
   if (rem_workers == 0) {
     /* Last Worker to finish slot */
 
-    // Signal the release of slot if it is the last worker that finished its own generation
-    std::unique_lock<std::mutex> lock(slot_mutex);
-    current_slot = {};
-
-    // All the workers of the same slot have finished. Synchronize scheduling decisions with UEs state
-    for (auto& c : cc_worker_list) {
-      if (c->waiting > 0) {
-        waiting_cvars.push_back(&c->cvar);
-      }
-    }
-
-    // Awake waiting workers
-    lock.unlock();
-    for (auto& c : waiting_cvars) {
-      c->notify_one();
-    }
+    // Release the slot, so that the workers of the next slot can start
+    slot_ready.store(false, std::memory_order_relaxed);
+    current_slot.store(no_slot, std::memory_order_release);
   }
 
   // Post-process and copy results to intermediate buffer
@@ -359,7 +465,7 @@ void sched_worker_manager::run_slot(slot_point slot_tx, uint32_t cc, dl_sched_re
 
 void sched_worker_manager::get_metrics(mac_metrics_t& metrics)
 {
-  std::unique_lock<std::mutex> lock(slot_mutex);
+  std::lock_guard<std::mutex> lock(ue_db_mutex);
   get_metrics_nolocking(metrics);
 }
 
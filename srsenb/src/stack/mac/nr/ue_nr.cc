@@ -247,6 +247,7 @@ void ue_nr::metrics_read(mac_ue_metrics_t* metrics_)
   dl_cqi_valid_counter = 0;
   pucch_sinr_counter   = 0;
   pusch_sinr_counter   = 0;
+  pusch_fec_counter    = 0;
   ue_metrics           = {};
 }
 
@@ -330,6 +331,28 @@ void ue_nr::metrics_pusch_sinr(float sinr)
   }
 }
 
+void ue_nr::metrics_pusch_fec(const srsran_sch_tb_res_nr_t& tb)
+{
+  std::lock_guard<std::mutex> lock(metrics_mutex);
+  // discard transport blocks that were not decoded (e.g. PUSCH SNR below threshold)
+  if (tb.nof_cb == 0 or std::isnan(tb.avg_iter)) {
+    return;
+  }
+  ue_metrics.fec_iters     = SRSRAN_VEC_SAFE_CMA(tb.avg_iter, ue_metrics.fec_iters, pusch_fec_counter);
+  ue_metrics.fec_time_us   = SRSRAN_VEC_SAFE_CMA((float)tb.time_us, ue_metrics.fec_time_us, pusch_fec_counter);
+  ue_metrics.fec_max_iters = std::max(ue_metrics.fec_max_iters, tb.max_iter);
+  pusch_fec_counter++;
+
+  for (uint32_t i = 0; i < tb.nof_cb; i++) {
+    if (tb.cb[i].decoded) {
+      ue_metrics.fec_nof_cb++;
+      if (not tb.cb[i].crc) {
+        ue_metrics.fec_cb_errors++;
+      }
+    }
+  }
+}
+
 /** Converts the buffer size field of a BSR (5 or 8-bit Buffer Size field) into Bytes
  * @param buff_size_field The buffer size field contained in the MAC PDU
  * @param format          The BSR format that determines the buffer size field length
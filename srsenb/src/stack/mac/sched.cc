@@ -25,6 +25,7 @@
 #include "srsenb/hdr/stack/mac/sched.h"
 #include "srsenb/hdr/stack/mac/sched_carrier.h"
 #include "srsenb/hdr/stack/mac/sched_helpers.h"
+#include "srsran/interfaces/enb_rrc_interfaces.h"
 #include "srsran/srslog/srslog.h"
 
 #define Console(fmt, ...) srsran::console(fmt, ##__VA_ARGS__)
@@ -62,6 +63,9 @@ int sched::reset()
     c->reset();
   }
   ue_db.clear();
+  for (std::atomic<uint16_t>& rnti : ue_db_rntis) {
+    rnti.store(0, std::memory_order_relaxed);
+  }
   return 0;
 }
 
@@ -69,6 +73,8 @@ int sched::reset()
 int sched::cell_cfg(const std::vector<sched_interface::cell_cfg_t>& cell_cfg)
 {
   std::lock_guard<std::mutex> lock(sched_mutex);
+  carrier_workers.clear();
+
   // Setup derived config params
   sched_cell_params.resize(cell_cfg.size());
   for (uint32_t cc_idx = 0; cc_idx < cell_cfg.size(); ++cc_idx) {
@@ -91,6 +97,13 @@ int sched::cell_cfg(const std::vector<sched_interface::cell_cfg_t>& cell_cfg)
     carrier_schedulers[i]->carrier_cfg(sched_cell_params[i]);
   }
 
+  // Start one worker per secondary carrier
+  if (sched_cfg.parallel_cc) {
+    for (uint32_t i = 1; i < carrier_schedulers.size(); ++i) {
+      carrier_workers.emplace_back(new carrier_worker{*carrier_schedulers[i], i});
+    }
+  }
+
   configured = true;
   return 0;
 }
@@ -108,7 +121,9 @@ int sched::ue_cfg(uint16_t rnti, const sched_interface::ue_cfg_t& ue_cfg)
     std::lock_guard<std::mutex> lock(sched_mutex);
     auto                        it = ue_db.find(rnti);
     if (it != ue_db.end()) {
+      flush_cc_feedback();
       it->second->set_cfg(ue_cfg);
+      notify_ue_activity(rnti);
       return SRSRAN_SUCCESS;
     }
   }
@@ -116,7 +131,10 @@ int sched::ue_cfg(uint16_t rnti, const sched_interface::ue_cfg_t& ue_cfg)
   // Add new user case
   std::unique_ptr<sched_ue>   ue{new sched_ue(rnti, sched_cell_params, ue_cfg)};
   std::lock_guard<std::mutex> lock(sched_mutex);
-  ue_db.insert(rnti, std::move(ue));
+  if (ue_db.insert(rnti, std::move(ue))) {
+    ue_db_rntis[rnti % SRSENB_MAX_UES].store(rnti, std::memory_order_release);
+  }
+  notify_ue_activity(rnti);
   return SRSRAN_SUCCESS;
 }
 
@@ -124,7 +142,10 @@ int sched::ue_rem(uint16_t rnti)
 {
   std::lock_guard<std::mutex> lock(sched_mutex);
   if (ue_db.contains(rnti)) {
+    ue_db_rntis[rnti % SRSENB_MAX_UES].store(0, std::memory_order_release);
+    flush_cc_feedback();
     ue_db.erase(rnti);
+    notify_ue_activity(rnti);
   } else {
     Error("User rnti=0x%x not found", rnti);
     return SRSRAN_ERROR;
@@ -142,17 +163,28 @@ void sched::phy_config_enabled(uint16_t rnti, bool enabled)
 {
   // TODO: Check if correct use of last_tti
   ue_db_access_locked(
-      rnti, [this, enabled](sched_ue& ue) { ue.phy_config_enabled(last_tti, enabled); }, __PRETTY_FUNCTION__);
+      rnti,
+      [this, rnti, enabled](sched_ue& ue) {
+        ue.phy_config_enabled(last_tti, enabled);
+        notify_ue_activity(rnti);
+      },
+      __PRETTY_FUNCTION__);
 }
 
 int sched::bearer_ue_cfg(uint16_t rnti, uint32_t lc_id, const mac_lc_ch_cfg_t& cfg_)
 {
-  return ue_db_access_locked(rnti, [lc_id, cfg_](sched_ue& ue) { ue.set_bearer_cfg(lc_id, cfg_); });
+  return ue_db_access_locked(rnti, [this, rnti, lc_id, cfg_](sched_ue& ue) {
+    ue.set_bearer_cfg(lc_id, cfg_);
+    notify_ue_activity(rnti);
+  });
 }
 
 int sched::bearer_ue_rem(uint16_t rnti, uint32_t lc_id)
 {
-  return ue_db_access_locked(rnti, [lc_id](sched_ue& ue) { ue.rem_bearer(lc_id); });
+  return ue_db_access_locked(rnti, [this, rnti, lc_id](sched_ue& ue) {
+    ue.rem_bearer(lc_id);
+    notify_ue_activity(rnti);
+  });
 }
 
 uint32_t sched::get_dl_buffer(uint16_t rnti)
@@ -176,12 +208,18 @@ uint32_t sched::get_ul_buffer(uint16_t rnti)
 
 int sched::dl_rlc_buffer_state(uint16_t rnti, uint32_t lc_id, uint32_t tx_queue, uint32_t prio_tx_queue)
 {
-  return ue_db_access_locked(rnti, [&](sched_ue& ue) { ue.dl_buffer_state(lc_id, tx_queue, prio_tx_queue); });
+  return ue_db_access_locked(rnti, [&](sched_ue& ue) {
+    ue.dl_buffer_state(lc_id, tx_queue, prio_tx_queue);
+    notify_ue_activity(rnti);
+  });
 }
 
 int sched::dl_mac_buffer_state(uint16_t rnti, uint32_t ce_code, uint32_t nof_cmds)
 {
-  return ue_db_access_locked(rnti, [ce_code, nof_cmds](sched_ue& ue) { ue.mac_buffer_state(ce_code, nof_cmds); });
+  return ue_db_access_locked(rnti, [this, rnti, ce_code, nof_cmds](sched_ue& ue) {
+    ue.mac_buffer_state(ce_code, nof_cmds);
+    notify_ue_activity(rnti);
+  });
 }
 
 int sched::dl_ack_info(uint32_t tti_rx, uint16_t rnti, uint32_t enb_cc_idx, uint32_t tb_idx, bool ack)
@@ -189,40 +227,37 @@ int sched::dl_ack_info(uint32_t tti_rx, uint16_t rnti, uint32_t enb_cc_idx, uint
   int ret = -1;
   ue_db_access_locked(
       rnti,
-      [&](sched_ue& ue) { ret = ue.set_ack_info(tti_point{tti_rx}, enb_cc_idx, tb_idx, ack); },
+      [&](sched_ue& ue) {
+        ret = ue.set_ack_info(tti_point{tti_rx}, enb_cc_idx, tb_idx, ack);
+        notify_ue_activity(rnti);
+      },
       __PRETTY_FUNCTION__);
   return ret;
 }
 
 int sched::ul_crc_info(uint32_t tti_rx, uint16_t rnti, uint32_t enb_cc_idx, bool crc)
 {
-  return ue_db_access_locked(
-      rnti, [tti_rx, enb_cc_idx, crc](sched_ue& ue) { ue.set_ul_crc(tti_point{tti_rx}, enb_cc_idx, crc); });
+  return handle_cc_feedback(enb_cc_idx, cc_feedback_t{cc_feedback_t::ul_crc, rnti, tti_rx, crc});
 }
 
 int sched::dl_ri_info(uint32_t tti, uint16_t rnti, uint32_t enb_cc_idx, uint32_t ri_value)
 {
-  return ue_db_access_locked(
-      rnti, [tti, enb_cc_idx, ri_value](sched_ue& ue) { ue.set_dl_ri(tti_point{tti}, enb_cc_idx, ri_value); });
+  return handle_cc_feedback(enb_cc_idx, cc_feedback_t{cc_feedback_t::dl_ri, rnti, tti, ri_value});
 }
 
 int sched::dl_pmi_info(uint32_t tti, uint16_t rnti, uint32_t enb_cc_idx, uint32_t pmi_value)
 {
-  return ue_db_access_locked(
-      rnti, [tti, enb_cc_idx, pmi_value](sched_ue& ue) { ue.set_dl_pmi(tti_point{tti}, enb_cc_idx, pmi_value); });
+  return handle_cc_feedback(enb_cc_idx, cc_feedback_t{cc_feedback_t::dl_pmi, rnti, tti, pmi_value});
 }
 
 int sched::dl_cqi_info(uint32_t tti, uint16_t rnti, uint32_t enb_cc_idx, uint32_t cqi_value)
 {
-  return ue_db_access_locked(
-      rnti, [tti, enb_cc_idx, cqi_value](sched_ue& ue) { ue.set_dl_cqi(tti_point{tti}, enb_cc_idx, cqi_value); });
+  return handle_cc_feedback(enb_cc_idx, cc_feedback_t{cc_feedback_t::dl_cqi, rnti, tti, cqi_value});
 }
 
 int sched::dl_sb_cqi_info(uint32_t tti, uint16_t rnti, uint32_t enb_cc_idx, uint32_t sb_idx, uint32_t cqi_value)
 {
-  return ue_db_access_locked(rnti, [tti, enb_cc_idx, cqi_value, sb_idx](sched_ue& ue) {
-    ue.set_dl_sb_cqi(tti_point{tti}, enb_cc_idx, sb_idx, cqi_value);
-  });
+  return handle_cc_feedback(enb_cc_idx, cc_feedback_t{cc_feedback_t::dl_sb_cqi, rnti, tti, cqi_value, sb_idx});
 }
 
 int sched::dl_rach_info(uint32_t enb_cc_idx, dl_sched_rar_info_t rar_info)
@@ -233,18 +268,23 @@ int sched::dl_rach_info(uint32_t enb_cc_idx, dl_sched_rar_info_t rar_info)
 
 int sched::ul_snr_info(uint32_t tti_rx, uint16_t rnti, uint32_t enb_cc_idx, float snr, uint32_t ul_ch_code)
 {
-  return ue_db_access_locked(rnti,
-                             [&](sched_ue& ue) { ue.set_ul_snr(tti_point{tti_rx}, enb_cc_idx, snr, ul_ch_code); });
+  return handle_cc_feedback(enb_cc_idx, cc_feedback_t{cc_feedback_t::ul_snr, rnti, tti_rx, 0, ul_ch_code, snr});
 }
 
 int sched::ul_bsr(uint16_t rnti, uint32_t lcg_id, uint32_t bsr)
 {
-  return ue_db_access_locked(rnti, [lcg_id, bsr](sched_ue& ue) { ue.ul_buffer_state(lcg_id, bsr); });
+  return ue_db_access_locked(rnti, [this, rnti, lcg_id, bsr](sched_ue& ue) {
+    ue.ul_buffer_state(lcg_id, bsr);
+    notify_ue_activity(rnti);
+  });
 }
 
 int sched::ul_buffer_add(uint16_t rnti, uint32_t lcid, uint32_t bytes)
 {
-  return ue_db_access_locked(rnti, [lcid, bytes](sched_ue& ue) { ue.ul_buffer_add(lcid, bytes); });
+  return ue_db_access_locked(rnti, [this, rnti, lcid, bytes](sched_ue& ue) {
+    ue.ul_buffer_add(lcid, bytes);
+    notify_ue_activity(rnti);
+  });
 }
 
 int sched::ul_phr(uint16_t rnti, int phr, uint32_t ul_nof_prb)
@@ -256,7 +296,12 @@ int sched::ul_phr(uint16_t rnti, int phr, uint32_t ul_nof_prb)
 int sched::ul_sr_info(uint32_t tti, uint16_t rnti)
 {
   return ue_db_access_locked(
-      rnti, [](sched_ue& ue) { ue.set_sr(); }, __PRETTY_FUNCTION__);
+      rnti,
+      [this, rnti](sched_ue& ue) {
+        ue.set_sr();
+        notify_ue_activity(rnti);
+      },
+      __PRETTY_FUNCTION__);
 }
 
 void sched::set_dl_tti_mask(uint8_t* tti_mask, uint32_t nof_sfs)
@@ -355,6 +400,13 @@ void sched::new_tti(tti_point tti_rx)
 {
   last_tti = std::max(last_tti, tti_rx);
 
+  if (not carrier_workers.empty()) {
+    if (not is_generated(tti_rx, 0)) {
+      new_tti_parallel(tti_rx);
+    }
+    return;
+  }
+
   // Generate sched results for all CCs, if not yet generated
   for (size_t cc_idx = 0; cc_idx < carrier_schedulers.size(); ++cc_idx) {
     if (not is_generated(tti_rx, cc_idx)) {
@@ -364,6 +416,47 @@ void sched::new_tti(tti_point tti_rx)
   }
 }
 
+/// Generate the scheduling decision of all CCs for tti_rx, with each CC scheduled in its own worker. The carriers only
+/// depend on each other through the UEs with cells in more than one carrier (shared DL/UL buffers, CA state and UCI on
+/// PUSCH of other CCs). If there are none, the carriers run the whole TTI concurrently. Otherwise, the carriers are
+/// scheduled one after the other in CC order by the calling thread, as in the sequential scheduler. Splitting the TTI
+/// of a CA cell across the workers serializes the carriers anyway, and the thread handoffs made it slower than this
+void sched::new_tti_parallel(tti_point tti_rx)
+{
+  // Prepare the state shared by all carriers before the carrier workers start
+  bool multi_carrier_ues = false;
+  for (auto& user : ue_db) {
+    user.second->new_ue_tti(tti_rx);
+    multi_carrier_ues |= user.second->is_multi_carrier();
+  }
+  for (tti_point tti : {tti_rx, tti_rx + MSG3_DELAY_MS}) {
+    if (not sched_results.has_sf(tti)) {
+      sched_results.new_tti(tti);
+    }
+  }
+  uint32_t paging_payload = 0;
+  rrc->is_paging_opportunity(to_tx_dl(tti_rx).to_uint(), &paging_payload);
+
+  if (multi_carrier_ues) {
+    for (auto& c : carrier_schedulers) {
+      c->start_tti(tti_rx, paging_payload);
+      c->sched_users(tti_rx);
+      c->finish_tti(tti_rx);
+    }
+    return;
+  }
+
+  for (auto& w : carrier_workers) {
+    w->run_tti(tti_rx, paging_payload);
+  }
+  carrier_schedulers[0]->start_tti(tti_rx, paging_payload);
+  carrier_schedulers[0]->sched_users(tti_rx);
+  carrier_schedulers[0]->finish_tti(tti_rx);
+  for (auto& w : carrier_workers) {
+    w->wait();
+  }
+}
+
 /// Check if TTI result is generated
 bool sched::is_generated(srsran::tti_point tti_rx, uint32_t enb_cc_idx) const
 {
@@ -375,7 +468,8 @@ template <typename Func>
 int sched::ue_db_access_locked(uint16_t rnti, Func&& f, const char* func_name, bool log_fail)
 {
   std::lock_guard<std::mutex> lock(sched_mutex);
-  auto                        it = ue_db.find(rnti);
+  flush_cc_feedback();
+  auto it = ue_db.find(rnti);
   if (it != ue_db.end()) {
     f(*it->second);
   } else {
@@ -391,4 +485,44 @@ int sched::ue_db_access_locked(uint16_t rnti, Func&& f, const char* func_name, b
   return SRSRAN_SUCCESS;
 }
 
+/// Carrier-scoped UE feedback. In parallel mode, it is queued in the inbox of the carrier without taking sched_mutex, and
+/// applied by the carrier worker at the start of the next TTI. Feedback of a UE removed before that is discarded there
+int sched::handle_cc_feedback(uint32_t enb_cc_idx, const cc_feedback_t& ev)
+{
+  if (enb_cc_idx >= carrier_schedulers.size()) {
+    Error("SCHED: Invalid cc=%d for feedback of rnti=0x%x", enb_cc_idx, ev.rnti);
+    return SRSRAN_ERROR;
+  }
+  carrier_sched& carrier = *carrier_schedulers[enb_cc_idx];
+  if (not carrier_workers.empty()) {
+    if (ue_db_rntis[ev.rnti % SRSENB_MAX_UES].load(std::memory_order_acquire) != ev.rnti) {
+      Error("SCHED: User rnti=0x%x not found.", ev.rnti);
+      return SRSRAN_ERROR;
+    }
+    if (carrier.push_feedback(ev)) {
+      return SRSRAN_SUCCESS;
+    }
+  }
+
+  // Sequential mode or full inbox. In the latter case, the queued feedback is applied first to keep the order
+  return ue_db_access_locked(ev.rnti, [&carrier, &ev](sched_ue& ue) { carrier.apply_feedback(ue, ev); });
+}
+
+/// Wakes up the UE in the scheduling policies of all carriers, after a change in its state
+void sched::notify_ue_activity(uint16_t rnti)
+{
+  for (auto& c : carrier_schedulers) {
+    c->ue_activity(rnti);
+  }
+}
+
+/// Applies the UE feedback still queued in the carrier inboxes. Called with sched_mutex held by the operations that
+/// access the UE state, so that they see the feedback received before them
+void sched::flush_cc_feedback()
+{
+  for (auto& c : carrier_schedulers) {
+    c->process_feedback();
+  }
+}
+
 } // namespace srsenb
@@ -26,6 +26,7 @@
 #include "srsran/common/standard_streams.h"
 #include "srsran/common/string_helpers.h"
 #include "srsran/interfaces/enb_rrc_interfaces.h"
+#include <thread>
 
 namespace srsenb {
 
@@ -35,11 +36,9 @@ using srsran::tti_point;
  *        Broadcast (SIB+Paging) scheduling
  *******************************************************/
 
-bc_sched::bc_sched(const sched_cell_params_t& cfg_, srsenb::rrc_interface_mac* rrc_) :
-  cc_cfg(&cfg_), rrc(rrc_), logger(srslog::fetch_basic_logger("MAC"))
-{}
+bc_sched::bc_sched(const sched_cell_params_t& cfg_) : cc_cfg(&cfg_), logger(srslog::fetch_basic_logger("MAC")) {}
 
-void bc_sched::dl_sched(sf_sched* tti_sched)
+void bc_sched::dl_sched(sf_sched* tti_sched, uint32_t paging_payload)
 {
   current_tti   = tti_sched->get_tti_tx_dl();
   bc_aggr_level = 2;
@@ -51,8 +50,7 @@ void bc_sched::dl_sched(sf_sched* tti_sched)
   alloc_sibs(tti_sched);
 
   /* Allocate Paging */
-  // NOTE: It blocks
-  alloc_paging(tti_sched);
+  alloc_paging(tti_sched, paging_payload);
 }
 
 void bc_sched::update_si_windows(sf_sched* tti_sched)
@@ -141,12 +139,10 @@ void bc_sched::alloc_sibs(sf_sched* tti_sched)
   }
 }
 
-void bc_sched::alloc_paging(sf_sched* tti_sched)
+void bc_sched::alloc_paging(sf_sched* tti_sched, uint32_t paging_payload)
 {
-  uint32_t paging_payload = 0;
-
   // Check if pending Paging message
-  if (not rrc->is_paging_opportunity(tti_sched->get_tti_tx_dl().to_uint(), &paging_payload) or paging_payload == 0) {
+  if (paging_payload == 0) {
     return;
   }
 
@@ -349,6 +345,9 @@ void sched::carrier_sched::reset()
 {
   ra_sched_ptr.reset();
   bc_sched_ptr.reset();
+  cc_feedback_t ev;
+  while (feedback_inbox.try_pop(ev)) {
+  }
 }
 
 void sched::carrier_sched::carrier_cfg(const sched_cell_params_t& cell_params_)
@@ -357,7 +356,7 @@ void sched::carrier_sched::carrier_cfg(const sched_cell_params_t& cell_params_)
   cc_cfg = &cell_params_;
 
   // init Broadcast/RA schedulers
-  bc_sched_ptr.reset(new bc_sched{*cc_cfg, rrc});
+  bc_sched_ptr.reset(new bc_sched{*cc_cfg});
   ra_sched_ptr.reset(new ra_sched{*cc_cfg, *ue_db});
 
   // Setup data scheduling algorithms
@@ -382,17 +381,37 @@ void sched::carrier_sched::set_dl_tti_mask(uint8_t* tti_mask, uint32_t nof_sfs)
 
 const cc_sched_result& sched::carrier_sched::generate_tti_result(tti_point tti_rx)
 {
-  sf_sched*        tti_sched = get_sf_sched(tti_rx);
-  sf_sched_result* sf_result = prev_sched_results->get_sf(tti_rx);
-  cc_sched_result* cc_result = sf_result->get_cc(enb_cc_idx);
-
-  bool dl_active = sf_dl_mask[tti_sched->get_tti_tx_dl().to_uint() % sf_dl_mask.size()] == 0;
-
   /* Refresh UE internal buffers and subframe vars */
   for (auto& user : *ue_db) {
     user.second->new_subframe(tti_rx, enb_cc_idx);
   }
 
+  uint32_t paging_payload = 0;
+  rrc->is_paging_opportunity(to_tx_dl(tti_rx).to_uint(), &paging_payload);
+
+  sched_cell_ctrl(tti_rx, paging_payload);
+  sched_users(tti_rx);
+  return finish_tti(tti_rx);
+}
+
+void sched::carrier_sched::start_tti(tti_point tti_rx, uint32_t paging_payload)
+{
+  process_feedback();
+
+  /* Refresh the UE state of this carrier. The state shared by all carriers was refreshed by the caller */
+  for (auto& user : *ue_db) {
+    user.second->new_cell_tti(tti_rx, enb_cc_idx);
+  }
+
+  sched_cell_ctrl(tti_rx, paging_payload);
+}
+
+void sched::carrier_sched::sched_cell_ctrl(tti_point tti_rx, uint32_t paging_payload)
+{
+  sf_sched* tti_sched = get_sf_sched(tti_rx);
+
+  bool dl_active = sf_dl_mask[tti_sched->get_tti_tx_dl().to_uint() % sf_dl_mask.size()] == 0;
+
   /* Schedule PHICH */
   for (auto& ue_pair : *ue_db) {
     if (tti_sched->alloc_phich(ue_pair.second.get()) == alloc_result::no_grant_space) {
@@ -403,7 +422,7 @@ const cc_sched_result& sched::carrier_sched::generate_tti_result(tti_point tti_r
   /* Schedule DL control data */
   if (dl_active) {
     /* Schedule Broadcast data (SIB and paging) */
-    bc_sched_ptr->dl_sched(tti_sched);
+    bc_sched_ptr->dl_sched(tti_sched, paging_payload);
 
     /* Schedule RAR */
     ra_sched_ptr->dl_sched(tti_sched);
@@ -412,6 +431,11 @@ const cc_sched_result& sched::carrier_sched::generate_tti_result(tti_point tti_r
     sf_sched* sf_msg3_sched = get_sf_sched(tti_rx + MSG3_DELAY_MS);
     ra_sched_ptr->ul_sched(tti_sched, sf_msg3_sched);
   }
+}
+
+void sched::carrier_sched::sched_users(tti_point tti_rx)
+{
+  sf_sched* tti_sched = get_sf_sched(tti_rx);
 
   /* Prioritize PDCCH scheduling for DL and UL data in a RoundRobin fashion */
   if ((tti_rx.to_uint() % 2) == 0) {
@@ -427,6 +451,11 @@ const cc_sched_result& sched::carrier_sched::generate_tti_result(tti_point tti_r
 
   /* Select the winner DCI allocation combination, store all the scheduling results */
   tti_sched->generate_sched_results(*ue_db);
+}
+
+const cc_sched_result& sched::carrier_sched::finish_tti(tti_point tti_rx)
+{
+  cc_sched_result* cc_result = prev_sched_results->get_cc(tti_rx, enb_cc_idx);
 
   /* Reset ue harq pending ack state, clean-up blocked pids */
   for (auto& user : *ue_db) {
@@ -439,6 +468,51 @@ const cc_sched_result& sched::carrier_sched::generate_tti_result(tti_point tti_r
   return *cc_result;
 }
 
+void sched::carrier_sched::process_feedback()
+{
+  cc_feedback_t ev;
+  while (feedback_inbox.try_pop(ev)) {
+    auto it = ue_db->find(ev.rnti);
+    if (it == ue_db->end()) {
+      logger.warning("SCHED: User rnti=0x%x not found. Discarding feedback for cc=%d", ev.rnti, enb_cc_idx);
+      continue;
+    }
+    apply_feedback(*it->second, ev);
+  }
+}
+
+void sched::carrier_sched::apply_feedback(sched_ue& ue, const cc_feedback_t& ev)
+{
+  switch (ev.type) {
+    case cc_feedback_t::ul_crc:
+      ue.set_ul_crc(ev.tti_rx, enb_cc_idx, ev.value != 0);
+      break;
+    case cc_feedback_t::dl_ri:
+      ue.set_dl_ri(ev.tti_rx, enb_cc_idx, ev.value);
+      break;
+    case cc_feedback_t::dl_pmi:
+      ue.set_dl_pmi(ev.tti_rx, enb_cc_idx, ev.value);
+      break;
+    case cc_feedback_t::dl_cqi:
+      ue.set_dl_cqi(ev.tti_rx, enb_cc_idx, ev.value);
+      break;
+    case cc_feedback_t::dl_sb_cqi:
+      ue.set_dl_sb_cqi(ev.tti_rx, enb_cc_idx, ev.idx, ev.value);
+      break;
+    case cc_feedback_t::ul_snr:
+      ue.set_ul_snr(ev.tti_rx, enb_cc_idx, ev.snr, ev.idx);
+      break;
+  }
+  ue_activity(ev.rnti);
+}
+
+void sched::carrier_sched::ue_activity(uint16_t rnti)
+{
+  if (sched_algo != nullptr) {
+    sched_algo->ue_activity(rnti);
+  }
+}
+
 void sched::carrier_sched::alloc_dl_users(sf_sched* tti_result)
 {
   if (sf_dl_mask[tti_result->get_tti_tx_dl().to_uint() % sf_dl_mask.size()] != 0) {
@@ -490,4 +564,83 @@ int sched::carrier_sched::dl_rach_info(dl_sched_rar_info_t rar_info)
   return ra_sched_ptr->dl_rach_info(rar_info);
 }
 
+/*******************************************************
+ *                 Carrier worker
+ *******************************************************/
+
+sched::carrier_worker::carrier_worker(carrier_sched& carrier_, uint32_t enb_cc_idx_) :
+  thread("SCHED_CC" + std::to_string(enb_cc_idx_)), carrier(carrier_)
+{
+  running = start();
+}
+
+sched::carrier_worker::~carrier_worker()
+{
+  stop();
+}
+
+void sched::carrier_worker::run_tti(tti_point tti_rx, uint32_t paging_payload)
+{
+  push_job(job_t::run_tti, tti_rx, paging_payload);
+}
+
+void sched::carrier_worker::wait()
+{
+  std::unique_lock<std::mutex> lock(mutex);
+  done_cvar.wait(lock, [this]() { return job_done; });
+}
+
+void sched::carrier_worker::stop()
+{
+  if (running) {
+    wait();
+    push_job(job_t::stop, tti_point{}, 0);
+    wait_thread_finish();
+    running = false;
+  }
+}
+
+void sched::carrier_worker::push_job(job_t job_, tti_point tti_rx, uint32_t paging_payload)
+{
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    srsran_assert(job_done, "Carrier worker job pushed while the previous one is running");
+    job_done           = false;
+    job                = job_;
+    job_tti            = tti_rx;
+    job_paging_payload = paging_payload;
+  }
+  job_cvar.notify_one();
+}
+
+void sched::carrier_worker::run_thread()
+{
+  while (true) {
+    job_t next_job;
+    {
+      std::unique_lock<std::mutex> lock(mutex);
+      job_cvar.wait(lock, [this]() { return job != job_t::none; });
+      next_job = job;
+      job      = job_t::none;
+    }
+    switch (next_job) {
+      case job_t::run_tti:
+        carrier.start_tti(job_tti, job_paging_payload);
+        carrier.sched_users(job_tti);
+        carrier.finish_tti(job_tti);
+        break;
+      default:
+        break;
+    }
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      job_done = true;
+    }
+    done_cvar.notify_one();
+    if (next_job == job_t::stop) {
+      return;
+    }
+  }
+}
+
 } // namespace srsenb
@@ -503,7 +503,10 @@ alloc_result sf_sched::alloc_dl_user(sched_ue* user, const rbgmask_t& user_mask,
     }
   }
 
-  bool has_pusch_grant = is_ul_alloc(user->get_rnti()) or cc_results->is_ul_alloc(user->get_rnti());
+  // The PUSCH grants of other CCs are only looked up for UEs with cells in them, as those CCs may be scheduled in
+  // parallel otherwise
+  bool has_pusch_grant =
+      is_ul_alloc(user->get_rnti()) or (user->is_multi_carrier() and cc_results->is_ul_alloc(user->get_rnti()));
 
   // Check if there is space in the PUCCH for HARQ ACKs
   const sched_interface::ue_cfg_t& ue_cfg    = user->get_ue_cfg();
@@ -787,12 +790,16 @@ uci_pusch_t is_uci_included(const sf_sched*        sf_sched,
   }
 
   for (uint32_t enbccidx = 0; enbccidx < other_cc_results.enb_cc_list.size(); ++enbccidx) {
+    // Only the CCs where the UE is active are looked up, as the other ones may be scheduled in parallel
+    auto p = user->get_active_cell_index(enbccidx);
+    if (not p.first) {
+      continue;
+    }
     for (uint32_t j = 0; j < other_cc_results.enb_cc_list[enbccidx].ul_sched_result.pusch.size(); ++j) {
       // Checks all the UL grants already allocated for the given rnti
       if (other_cc_results.enb_cc_list[enbccidx].ul_sched_result.pusch[j].dci.rnti == user->get_rnti()) {
-        auto p = user->get_active_cell_index(enbccidx);
         // If the UE CC Idx is the lowest so far
-        if (p.first and p.second < ue_cc_idx) {
+        if (p.second < ue_cc_idx) {
           ue_cc_idx      = p.second;
           sel_enb_cc_idx = enbccidx;
         }
@@ -37,9 +37,9 @@ void sf_cch_allocator::init(const sched_cell_params_t& cell_params_)
 {
   cc_cfg           = &cell_params_;
   pucch_cfg_common = cc_cfg->pucch_cfg_common;
-  dci_record_list.reserve(16);
-  last_dci_dfs.reserve(16);
-  temp_dci_dfs.reserve(16);
+  dci_record_list.reserve(MAX_NOF_ALLOCS);
+  last_dci_dfs.reserve(MAX_NOF_ALLOCS);
+  temp_dci_dfs.reserve(MAX_NOF_ALLOCS);
 }
 
 void sf_cch_allocator::new_tti(tti_point tti_rx_)
@@ -50,6 +50,7 @@ void sf_cch_allocator::new_tti(tti_point tti_rx_)
   last_dci_dfs.clear();
   current_cfix     = cc_cfg->sched_cfg->min_nof_ctrl_symbols - 1;
   current_max_cfix = cc_cfg->sched_cfg->max_nof_ctrl_symbols - 1;
+  nof_dfs_nodes    = 0;
 }
 
 const cce_cfi_position_table*
@@ -70,6 +71,58 @@ sf_cch_allocator::get_cce_loc_table(alloc_type_t alloc_type, sched_ue* user, uin
   return nullptr;
 }
 
+/// Get the DCI positions of the record for the given CFI that do not depend on the other allocations to be valid.
+/// Positions whose PUCCH HARQ-ACK resource collides with the UE SR or falls outside the PUCCH HARQ region are discarded
+/// once here, rather than every time the DFS revisits the record
+const sf_cch_allocator::dci_cand_list& sf_cch_allocator::get_cands(alloc_record& record, uint32_t cfix)
+{
+  dci_cand_list& cands = record.cands[cfix];
+  if (record.cands_set[cfix]) {
+    return cands;
+  }
+  record.cands_set[cfix] = true;
+  cands.clear();
+
+  // Get DCI Location Table
+  const cce_cfi_position_table* dci_locs = get_cce_loc_table(record.alloc_type, record.user, cfix);
+  if (dci_locs == nullptr) {
+    return cands;
+  }
+  const cce_position_list& dci_pos_list = (*dci_locs)[record.aggr_idx];
+
+  for (uint32_t i = 0; i < dci_pos_list.size(); ++i) {
+    dci_cand cand;
+    cand.dci_pos_idx = i;
+    cand.ncce        = dci_pos_list[i];
+    cand.pucch_n_prb = -1;
+
+    if (record.alloc_type == alloc_type_t::DL_DATA and not record.pusch_uci) {
+      // The UE needs to allocate space in PUCCH for HARQ-ACK
+      pucch_cfg_common.n_pucch = cand.ncce + pucch_cfg_common.N_pucch_1;
+
+      if (is_pucch_sr_collision(record.user->get_ue_cfg().pucch_cfg, to_tx_dl_ack(tti_rx), pucch_cfg_common.n_pucch)) {
+        // avoid collision of HARQ-ACK with own SR n(1)_pucch
+        continue;
+      }
+
+      cand.pucch_n_prb = srsran_pucch_n_prb(&cc_cfg->cfg.cell, &pucch_cfg_common, 0);
+      int low_rb       = cand.pucch_n_prb < (int)cc_cfg->cfg.cell.nof_prb / 2
+                             ? cand.pucch_n_prb
+                             : cc_cfg->cfg.cell.nof_prb - cand.pucch_n_prb - 1;
+      if (cc_cfg->sched_cfg->pucch_harq_max_rb > 0 && low_rb >= cc_cfg->sched_cfg->pucch_harq_max_rb) {
+        // PUCCH allocation would fall outside the maximum allowed PUCCH HARQ region. Try another CCE position
+        logger.info("Skipping PDCCH allocation for CCE=%d due to PUCCH HARQ falling outside region\n", cand.ncce);
+        continue;
+      }
+    }
+
+    cand.mask.resize(cc_cfg->nof_cce_table[cfix]);
+    cand.mask.fill(cand.ncce, cand.ncce + (1U << record.aggr_idx));
+    cands.push_back(cand);
+  }
+  return cands;
+}
+
 bool sf_cch_allocator::alloc_dci(alloc_type_t alloc_type, uint32_t aggr_idx, sched_ue* user, bool has_pusch_grant)
 {
   temp_dci_dfs.clear();
@@ -80,6 +133,7 @@ bool sf_cch_allocator::alloc_dci(alloc_type_t alloc_type, uint32_t aggr_idx, sch
   record.aggr_idx   = aggr_idx;
   record.alloc_type = alloc_type;
   record.pusch_uci  = has_pusch_grant;
+  record.cands_set.fill(false);
 
   if (is_dl_ctrl_alloc(alloc_type) and nof_allocs() == 0 and cc_cfg->nof_prb() <= 25 and
       current_max_cfix > current_cfix) {
@@ -97,48 +151,60 @@ bool sf_cch_allocator::alloc_dci(alloc_type_t alloc_type, uint32_t aggr_idx, sch
     }
   }
 
-  // Try to allocate grant. If it fails, attempt the same grant, but using a different permutation of past grant DCI
-  // positions
-  do {
-    bool success = alloc_dfs_node(record, 0);
-    if (success) {
-      // DCI record allocation successful
-      dci_record_list.push_back(record);
-
-      if (is_dl_ctrl_alloc(alloc_type)) {
-        // Dynamic CFI not yet supported for DL control allocations, as coderate can be exceeded
-        current_max_cfix = current_cfix;
-      }
-      return true;
-    }
-    if (temp_dci_dfs.empty()) {
-      temp_dci_dfs = last_dci_dfs;
+  // Try to allocate grant on top of the current solution. If it fails, attempt the same grant, but using a different
+  // permutation of past grant DCI positions
+  dci_record_list.push_back(record);
+  bool success = alloc_dfs_node(dci_record_list.size() - 1, 0);
+  if (not success) {
+    temp_dci_dfs = last_dci_dfs;
+    success      = get_next_dfs();
+  }
+  if (success) {
+    // DCI record allocation successful
+    if (is_dl_ctrl_alloc(alloc_type)) {
+      // Dynamic CFI not yet supported for DL control allocations, as coderate can be exceeded
+      current_max_cfix = current_cfix;
     }
-  } while (get_next_dfs());
+    return true;
+  }
 
   // Revert steps to initial state, before dci record allocation was attempted
+  dci_record_list.pop_back();
   last_dci_dfs.swap(temp_dci_dfs);
   current_cfix = start_cfix;
   return false;
 }
 
+/// Computes the next DFS solution that fits all the DCI records, or returns false if there is none left or if the
+/// search budget of the TTI was exhausted. In the latter case, the DCI being allocated is dropped and the previous
+/// solution is kept
 bool sf_cch_allocator::get_next_dfs()
 {
+  uint32_t nof_cces_required = 0;
+  for (const alloc_record& record : dci_record_list) {
+    nof_cces_required += 1U << record.aggr_idx;
+  }
+  uint32_t max_nodes = cc_cfg->sched_cfg->max_pdcch_search_nodes;
+
   do {
     uint32_t start_child_idx = 0;
+    if (max_nodes > 0 and nof_dfs_nodes >= max_nodes) {
+      return false;
+    }
     if (last_dci_dfs.empty()) {
-      // If we reach root, increase CFI
-      current_cfix++;
-      if (current_cfix > current_max_cfix) {
-        return false;
-      }
+      // If we reach root, increase CFI. CFIs without enough CCEs for all the records are skipped
+      do {
+        current_cfix++;
+        if (current_cfix > current_max_cfix) {
+          return false;
+        }
+      } while (nof_cces() < nof_cces_required);
     } else {
       // Attempt to re-add last tree node, but with a higher node child index
       start_child_idx = last_dci_dfs.back().dci_pos_idx + 1;
       last_dci_dfs.pop_back();
     }
-    while (last_dci_dfs.size() < dci_record_list.size() and
-           alloc_dfs_node(dci_record_list[last_dci_dfs.size()], start_child_idx)) {
+    while (last_dci_dfs.size() < dci_record_list.size() and alloc_dfs_node(last_dci_dfs.size(), start_child_idx)) {
       start_child_idx = 0;
     }
   } while (last_dci_dfs.size() < dci_record_list.size());
@@ -147,23 +213,16 @@ bool sf_cch_allocator::get_next_dfs()
   return true;
 }
 
-bool sf_cch_allocator::alloc_dfs_node(const alloc_record& record, uint32_t start_dci_idx)
+bool sf_cch_allocator::alloc_dfs_node(uint32_t record_idx, uint32_t start_dci_idx)
 {
-  // Get DCI Location Table
-  const cce_cfi_position_table* dci_locs = get_cce_loc_table(record.alloc_type, record.user, current_cfix);
-  if (dci_locs == nullptr or (*dci_locs)[record.aggr_idx].empty()) {
-    return false;
-  }
-  const cce_position_list& dci_pos_list = (*dci_locs)[record.aggr_idx];
-  if (start_dci_idx >= dci_pos_list.size()) {
-    return false;
-  }
+  nof_dfs_nodes++;
+  alloc_record&        record = dci_record_list[record_idx];
+  const dci_cand_list& cands  = get_cands(record, current_cfix);
 
   tree_node node;
-  node.dci_pos_idx = start_dci_idx;
-  node.dci_pos.L   = record.aggr_idx;
-  node.rnti        = record.user != nullptr ? record.user->get_rnti() : SRSRAN_INVALID_RNTI;
-  node.current_mask.resize(nof_cces());
+  node.record_idx = record_idx;
+  node.dci_pos.L  = record.aggr_idx;
+  node.rnti       = record.user != nullptr ? record.user->get_rnti() : SRSRAN_INVALID_RNTI;
   // get cumulative pdcch & pucch masks
   if (not last_dci_dfs.empty()) {
     node.total_mask       = last_dci_dfs.back().total_mask;
@@ -173,43 +232,31 @@ bool sf_cch_allocator::alloc_dfs_node(const alloc_record& record, uint32_t start
     node.total_pucch_mask.resize(cc_cfg->nof_prb());
   }
 
-  for (; node.dci_pos_idx < dci_pos_list.size(); ++node.dci_pos_idx) {
-    node.dci_pos.ncce = dci_pos_list[node.dci_pos_idx];
-
-    if (record.alloc_type == alloc_type_t::DL_DATA and not record.pusch_uci) {
-      // The UE needs to allocate space in PUCCH for HARQ-ACK
-      pucch_cfg_common.n_pucch = node.dci_pos.ncce + pucch_cfg_common.N_pucch_1;
-
-      if (is_pucch_sr_collision(record.user->get_ue_cfg().pucch_cfg, to_tx_dl_ack(tti_rx), pucch_cfg_common.n_pucch)) {
-        // avoid collision of HARQ-ACK with own SR n(1)_pucch
-        continue;
-      }
-
-      node.pucch_n_prb = srsran_pucch_n_prb(&cc_cfg->cfg.cell, &pucch_cfg_common, 0);
-      if (not cc_cfg->sched_cfg->pucch_mux_enabled and node.total_pucch_mask.test(node.pucch_n_prb)) {
-        // PUCCH allocation would collide with other PUCCH/PUSCH grants. Try another CCE position
-        continue;
-      }
-      int low_rb = node.pucch_n_prb < (int)cc_cfg->cfg.cell.nof_prb / 2
-                       ? node.pucch_n_prb
-                       : cc_cfg->cfg.cell.nof_prb - node.pucch_n_prb - 1;
-      if (cc_cfg->sched_cfg->pucch_harq_max_rb > 0 && low_rb >= cc_cfg->sched_cfg->pucch_harq_max_rb) {
-        // PUCCH allocation would fall outside the maximum allowed PUCCH HARQ region. Try another CCE position
-        logger.info("Skipping PDCCH allocation for CCE=%d due to PUCCH HARQ falling outside region\n",
-                    node.dci_pos.ncce);
-        continue;
-      }
+  for (const dci_cand& cand : cands) {
+    if (cand.dci_pos_idx < start_dci_idx) {
+      continue;
     }
-
-    node.current_mask.reset();
-    node.current_mask.fill(node.dci_pos.ncce, node.dci_pos.ncce + (1U << record.aggr_idx));
-    if ((node.total_mask & node.current_mask).any()) {
+    if ((node.total_mask & cand.mask).any()) {
       // there is a PDCCH collision. Try another CCE position
       continue;
     }
+    if (cand.pucch_n_prb >= 0 and not cc_cfg->sched_cfg->pucch_mux_enabled and
+        node.total_pucch_mask.test(cand.pucch_n_prb)) {
+      // PUCCH allocation would collide with other PUCCH/PUSCH grants. Try another CCE position
+      continue;
+    }
+    pdcch_mask_t total_mask = node.total_mask | cand.mask;
+    if (not remaining_records_fit(record_idx + 1, total_mask)) {
+      // No solution down this branch. Try another CCE position
+      continue;
+    }
 
     // Allocation successful
-    node.total_mask |= node.current_mask;
+    node.dci_pos_idx  = cand.dci_pos_idx;
+    node.dci_pos.ncce = cand.ncce;
+    node.pucch_n_prb  = cand.pucch_n_prb;
+    node.current_mask = cand.mask;
+    node.total_mask   = total_mask;
     if (node.pucch_n_prb >= 0) {
       node.total_pucch_mask.set(node.pucch_n_prb);
     }
@@ -220,6 +267,28 @@ bool sf_cch_allocator::alloc_dfs_node(const alloc_record& record, uint32_t start
   return false;
 }
 
+/// Checks whether the records from record_idx onwards may still be allocated, given the CCEs already occupied. They
+/// must fit in the free CCEs, and each of them must have at least one candidate that does not collide with total_mask
+bool sf_cch_allocator::remaining_records_fit(uint32_t record_idx, const pdcch_mask_t& total_mask)
+{
+  uint32_t nof_free_cces = total_mask.size() - total_mask.count();
+  for (; record_idx < dci_record_list.size(); ++record_idx) {
+    alloc_record& record   = dci_record_list[record_idx];
+    uint32_t      nof_cces = 1U << record.aggr_idx;
+    if (nof_cces > nof_free_cces) {
+      return false;
+    }
+    nof_free_cces -= nof_cces;
+    const dci_cand_list& cands = get_cands(record, current_cfix);
+    if (std::none_of(cands.begin(), cands.end(), [&total_mask](const dci_cand& c) {
+          return (total_mask & c.mask).none();
+        })) {
+      return false;
+    }
+  }
+  return true;
+}
+
 void sf_cch_allocator::rem_last_dci()
 {
   assert(not dci_record_list.empty());
@@ -107,6 +107,19 @@ void sched_ue::new_subframe(tti_point tti_rx, uint32_t enb_cc_idx)
   }
 }
 
+/// Refreshes the state shared by all the carriers of the UE. Called once per TTI, before new_cell_tti
+void sched_ue::new_ue_tti(tti_point tti_rx)
+{
+  current_tti = tti_rx;
+  lch_handler.new_tti();
+}
+
+/// Refreshes the state of a single carrier of the UE. Only touches the carrier enb_cc_idx
+void sched_ue::new_cell_tti(tti_point tti_rx, uint32_t enb_cc_idx)
+{
+  cells[enb_cc_idx].new_tti(tti_rx);
+}
+
 /*******************************************************
  *
  * FAPI-like main scheduler interface.
@@ -874,6 +887,28 @@ uint32_t sched_ue::get_pending_ul_old_data()
   return pending_ul_data;
 }
 
+bool sched_ue::has_pending_txs(uint32_t enb_cc_idx) const
+{
+  if (enb_to_ue_cc_idx(enb_cc_idx) < 0) {
+    return false;
+  }
+  if (sr or lch_handler.has_pending_dl_txs() or lch_handler.get_bsr() > 0) {
+    return true;
+  }
+  const harq_entity& harq_ent = cells[enb_cc_idx].harq_ent;
+  for (const dl_harq_proc& h : harq_ent.dl_harq_procs()) {
+    if (not h.is_empty()) {
+      return true;
+    }
+  }
+  for (const ul_harq_proc& h : harq_ent.ul_harq_procs()) {
+    if (not h.is_empty()) {
+      return true;
+    }
+  }
+  return false;
+}
+
 uint32_t sched_ue::get_pending_ul_data_total(tti_point tti_tx_ul, int this_enb_cc_idx)
 {
   static constexpr uint32_t lbsr_size = 4, sbsr_size = 2;
@@ -1049,6 +1084,12 @@ sched_ue_cell* sched_ue::find_ue_carrier(uint32_t enb_cc_idx)
   return cells[enb_cc_idx].configured() ? &cells[enb_cc_idx] : nullptr;
 }
 
+/// Whether the UE has cells in more than one eNB carrier, counting the ones still being deactivated
+bool sched_ue::is_multi_carrier() const
+{
+  return std::count_if(cells.begin(), cells.end(), [](const sched_ue_cell& c) { return c.configured(); }) > 1;
+}
+
 std::bitset<SRSRAN_MAX_CARRIERS> sched_ue::scell_activation_mask() const
 {
   std::bitset<SRSRAN_MAX_CARRIERS> ret{0};
@@ -26,6 +26,9 @@ namespace srsenb {
 
 using srsran::tti_point;
 
+/// Weight of the last allocation in the exponential average of the rate of a UE
+static const float avg_rate_alpha = 0.01;
+
 sched_time_pf::sched_time_pf(const sched_cell_params_t& cell_params_, const sched_interface::sched_args_t& sched_args)
 {
   cc_cfg = &cell_params_;
@@ -33,13 +36,55 @@ sched_time_pf::sched_time_pf(const sched_cell_params_t& cell_params_, const sche
     fairness_coeff = std::stof(sched_args.sched_policy_args);
   }
 
-  std::vector<ue_ctxt*> dl_storage;
+  active_ues.reserve(SRSENB_MAX_UES);
+  pending_ues.reserve(SRSENB_MAX_UES);
+
+  std::vector<ue_prio_t> dl_storage;
   dl_storage.reserve(SRSENB_MAX_UES);
-  dl_queue = ue_dl_queue_t(ue_dl_prio_compare{}, std::move(dl_storage));
+  dl_queue = ue_queue_t(ue_prio_compare{}, std::move(dl_storage));
 
-  std::vector<ue_ctxt*> ul_storage;
+  std::vector<ue_prio_t> ul_storage;
   ul_storage.reserve(SRSENB_MAX_UES);
-  ul_queue = ue_ul_queue_t(ue_ul_prio_compare{}, std::move(ul_storage));
+  ul_queue = ue_queue_t(ue_prio_compare{}, std::move(ul_storage));
+}
+
+void sched_time_pf::ue_activity(uint16_t rnti)
+{
+  auto it = ue_history_db.find(rnti);
+  if (it == ue_history_db.end() or not it->second.active) {
+    pending_ues.push_back(rnti);
+  }
+}
+
+/// Moves the UEs signalled since the last TTI to the active set, and drops the history of the removed ones
+void sched_time_pf::activate_pending_ues(sched_ue_list& ue_db)
+{
+  for (uint16_t rnti : pending_ues) {
+    auto ue_it = ue_db.find(rnti);
+    auto it    = ue_history_db.find(rnti);
+    if (ue_it == ue_db.end()) {
+      // Removed UE. If still in the active set, it is dropped when the active set is traversed
+      if (it != ue_history_db.end() and not it->second.active) {
+        ue_history_db.erase(it);
+      }
+      continue;
+    }
+    sched_ue* ue = ue_it->second.get();
+    if (it == ue_history_db.end()) {
+      it = ue_history_db.insert(rnti, ue_ctxt{rnti, fairness_coeff}).value();
+      it->second.reset(ue);
+    } else if (it->second.active) {
+      continue;
+    } else if (it->second.ue != ue) {
+      // The RNTI now belongs to a new UE
+      it->second.reset(ue);
+    } else {
+      it->second.save_idle_ttis(tti_count - it->second.idle_since, avg_rate_alpha);
+    }
+    it->second.active = true;
+    active_ues.push_back(&it->second);
+  }
+  pending_ues.clear();
 }
 
 void sched_time_pf::new_tti(sched_ue_list& ue_db, sf_sched* tti_sched)
@@ -51,27 +96,36 @@ void sched_time_pf::new_tti(sched_ue_list& ue_db, sf_sched* tti_sched)
     ul_queue.pop();
   }
   current_tti_rx = tti_point{tti_sched->get_tti_rx()};
-  // remove deleted users from history
-  for (auto it = ue_history_db.begin(); it != ue_history_db.end();) {
-    if (not ue_db.contains(it->first)) {
-      it = ue_history_db.erase(it);
-    } else {
-      ++it;
+  tti_count++;
+  activate_pending_ues(ue_db);
+
+  // Update the priority queues with the active UEs. UEs that were removed or have nothing left to schedule in this
+  // carrier leave the active set
+  for (size_t i = 0; i < active_ues.size();) {
+    ue_ctxt& ctxt  = *active_ues[i];
+    auto     ue_it = ue_db.find(ctxt.rnti);
+    if (ue_it == ue_db.end() or not ue_it->second->has_pending_txs(cc_cfg->enb_cc_idx)) {
+      ctxt.active     = false;
+      ctxt.idle_since = tti_count;
+      active_ues[i]   = active_ues.back();
+      active_ues.pop_back();
+      if (ue_it == ue_db.end()) {
+        ue_history_db.erase(ctxt.rnti);
+      }
+      continue;
     }
-  }
-  // add new users to history db, and update priority queues
-  for (auto& u : ue_db) {
-    auto it = ue_history_db.find(u.first);
-    if (it == ue_history_db.end()) {
-      it = ue_history_db.insert(u.first, ue_ctxt{u.first, fairness_coeff}).value();
+    if (ue_it->second.get() != ctxt.ue) {
+      // The RNTI now belongs to a new UE
+      ctxt.reset(ue_it->second.get());
     }
-    it->second.new_tti(*cc_cfg, *u.second, tti_sched);
-    if (it->second.dl_newtx_h != nullptr or it->second.dl_retx_h != nullptr) {
-      dl_queue.push(&it->second);
+    ctxt.new_tti(*cc_cfg, *ctxt.ue, tti_sched);
+    if (ctxt.dl_newtx_h != nullptr or ctxt.dl_retx_h != nullptr) {
+      dl_queue.push(ue_prio_t{ctxt.dl_prio, ctxt.dl_retx_h != nullptr, &ctxt});
     }
-    if (it->second.ul_h != nullptr) {
-      ul_queue.push(&it->second);
+    if (ctxt.ul_h != nullptr) {
+      ul_queue.push(ue_prio_t{ctxt.ul_prio, ctxt.ul_h->has_pending_retx(), &ctxt});
     }
+    ++i;
   }
 }
 
@@ -87,8 +141,8 @@ void sched_time_pf::sched_dl_users(sched_ue_list& ue_db, sf_sched* tti_sched)
   }
 
   while (not dl_queue.empty()) {
-    ue_ctxt& ue = *dl_queue.top();
-    ue.save_dl_alloc(try_dl_alloc(ue, *ue_db[ue.rnti], tti_sched), 0.01);
+    ue_ctxt& ue = *dl_queue.top().ue;
+    ue.save_dl_alloc(try_dl_alloc(ue, *ue.ue, tti_sched), avg_rate_alpha);
     dl_queue.pop();
   }
 }
@@ -126,8 +180,8 @@ void sched_time_pf::sched_ul_users(sched_ue_list& ue_db, sf_sched* tti_sched)
   }
 
   while (not ul_queue.empty()) {
-    ue_ctxt& ue = *ul_queue.top();
-    ue.save_ul_alloc(try_ul_alloc(ue, *ue_db[ue.rnti], tti_sched), 0.01);
+    ue_ctxt& ue = *ul_queue.top().ue;
+    ue.save_ul_alloc(try_ul_alloc(ue, *ue.ue, tti_sched), avg_rate_alpha);
     ul_queue.pop();
   }
 }
@@ -228,18 +282,34 @@ void sched_time_pf::ue_ctxt::save_ul_alloc(uint32_t alloc_bytes, float exp_avg_a
   ul_nof_samples++;
 }
 
-bool sched_time_pf::ue_dl_prio_compare::operator()(const sched_time_pf::ue_ctxt* lhs,
-                                                   const sched_time_pf::ue_ctxt* rhs) const
+void sched_time_pf::ue_ctxt::save_idle_ttis(uint64_t nof_ttis, float exp_avg_alpha)
+{
+  // Same as saving nof_ttis allocations of zero bytes in DL and UL
+  for (; nof_ttis > 0 and (dl_nof_samples < 1 / exp_avg_alpha or ul_nof_samples < 1 / exp_avg_alpha); --nof_ttis) {
+    save_dl_alloc(0, exp_avg_alpha);
+    save_ul_alloc(0, exp_avg_alpha);
+  }
+  if (nof_ttis > 0) {
+    float decay = std::pow(1 - exp_avg_alpha, static_cast<double>(nof_ttis));
+    dl_avg_rate_ *= decay;
+    ul_avg_rate_ *= decay;
+    dl_nof_samples += nof_ttis;
+    ul_nof_samples += nof_ttis;
+  }
+}
+
+void sched_time_pf::ue_ctxt::reset(sched_ue* ue_)
 {
-  bool is_retx1 = lhs->dl_retx_h != nullptr, is_retx2 = rhs->dl_retx_h != nullptr;
-  return (not is_retx1 and is_retx2) or (is_retx1 == is_retx2 and lhs->dl_prio < rhs->dl_prio);
+  ue             = ue_;
+  dl_avg_rate_   = 0;
+  ul_avg_rate_   = 0;
+  dl_nof_samples = 0;
+  ul_nof_samples = 0;
 }
 
-bool sched_time_pf::ue_ul_prio_compare::operator()(const sched_time_pf::ue_ctxt* lhs,
-                                                   const sched_time_pf::ue_ctxt* rhs) const
+bool sched_time_pf::ue_prio_compare::operator()(const ue_prio_t& lhs, const ue_prio_t& rhs) const
 {
-  bool is_retx1 = lhs->ul_h->has_pending_retx(), is_retx2 = rhs->ul_h->has_pending_retx();
-  return (not is_retx1 and is_retx2) or (is_retx1 == is_retx2 and lhs->ul_prio < rhs->ul_prio);
+  return (not lhs.is_retx and rhs.is_retx) or (lhs.is_retx == rhs.is_retx and lhs.prio < rhs.prio);
 }
 
 } // namespace srsenb
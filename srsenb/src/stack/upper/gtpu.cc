@@ -365,7 +365,8 @@ gtpu::gtpu(srsran::task_sched_handle   task_sched_,
   task_sched(task_sched_),
   logger(logger),
   tunnels(task_sched_, logger),
-  rx_socket_handler(rx_socket_handler_)
+  rx_socket_handler(rx_socket_handler_),
+  tx_batch(logger)
 {
   gtpu_queue = task_sched.make_task_queue();
 }
@@ -415,7 +416,13 @@ int gtpu::init(const gtpu_args_t& gtpu_args, pdcp_interface_gtpu* pdcp_)
   auto rx_callback = [this](srsran::unique_byte_buffer_t pdu, const sockaddr_in& from) {
     handle_gtpu_s1u_rx_packet(std::move(pdu), from);
   };
-  rx_socket_handler->add_socket_handler(fd, srsran::make_sdu_handler(logger, gtpu_queue, rx_callback));
+  if (args.io_batch_size > 0) {
+    tx_batch.init(fd, args.io_batch_size);
+    rx_socket_handler->add_socket_handler(
+        fd, srsran::make_batch_sdu_handler(logger, gtpu_queue, rx_callback, args.io_batch_size));
+  } else {
+    rx_socket_handler->add_socket_handler(fd, srsran::make_sdu_handler(logger, gtpu_queue, rx_callback));
+  }
 
   // Start MCH socket if enabled
   if (args.embms_enable) {
@@ -429,11 +436,32 @@ int gtpu::init(const gtpu_args_t& gtpu_args, pdcp_interface_gtpu* pdcp_)
 void gtpu::stop()
 {
   if (fd > 0) {
+    tx_batch.flush();
     close(fd);
     fd = -1;
   }
 }
 
+void gtpu::tti_clock()
+{
+  if (tx_batch.size() > 0) {
+    tx_batch.flush();
+  }
+}
+
+bool gtpu::send_datagram(srsran::unique_byte_buffer_t pdu, const sockaddr_in& addr)
+{
+  if (args.io_batch_size > 0) {
+    // The GTP-U header already sits in the PDU headroom, so the buffer is handed over as is
+    return tx_batch.push(std::move(pdu), addr);
+  }
+  if (sendto(fd, pdu->msg, pdu->N_bytes, MSG_EOR, (const struct sockaddr*)&addr, sizeof(struct sockaddr_in)) < 0) {
+    perror("sendto");
+    return false;
+  }
+  return true;
+}
+
 // gtpu_interface_pdcp
 void gtpu::write_pdu(uint16_t rnti, uint32_t eps_bearer_id, srsran::unique_byte_buffer_t pdu)
 {
@@ -481,9 +509,7 @@ void gtpu::send_pdu_to_tunnel(const gtpu_tunnel& tx_tun, srsran::unique_byte_buf
     logger.error("Error writing GTP-U Header. Flags 0x%x, Message Type 0x%x", header.flags, header.message_type);
     return;
   }
-  if (sendto(fd, pdu->msg, pdu->N_bytes, MSG_EOR, (struct sockaddr*)&servaddr, sizeof(struct sockaddr_in)) < 0) {
-    perror("sendto");
-  }
+  send_datagram(std::move(pdu), servaddr);
 }
 
 srsran::expected<uint32_t> gtpu::add_bearer(uint16_t            rnti,
@@ -761,7 +787,7 @@ void gtpu::error_indication(in_addr_t addr, in_port_t port, uint32_t err_teid)
   servaddr.sin_addr.s_addr = addr;
   servaddr.sin_port        = port;
 
-  sendto(fd, pdu->msg, 12, MSG_EOR, (struct sockaddr*)&servaddr, sizeof(struct sockaddr_in));
+  send_datagram(std::move(pdu), servaddr);
   tx_seq++;
 }
 
@@ -795,7 +821,7 @@ void gtpu::echo_response(in_addr_t addr, in_port_t port, uint16_t seq)
   servaddr.sin_addr.s_addr = addr;
   servaddr.sin_port        = port;
 
-  sendto(fd, pdu->msg, 12, MSG_EOR, (struct sockaddr*)&servaddr, sizeof(struct sockaddr_in));
+  send_datagram(std::move(pdu), servaddr);
 }
 
 /****************************************************************************
@@ -830,8 +856,11 @@ bool gtpu::send_end_marker(uint32_t teidin)
   servaddr.sin_addr.s_addr    = htonl(tx_tun->spgw_addr);
   servaddr.sin_port           = htons(GTPU_PORT);
 
-  bool success =
-      sendto(fd, pdu->msg, pdu->N_bytes, MSG_EOR, (struct sockaddr*)&servaddr, sizeof(struct sockaddr_in)) > 0;
+  // The End Marker must follow the forwarded PDUs, so any pending batch is transmitted along with it
+  bool success = send_datagram(std::move(pdu), servaddr);
+  if (args.io_batch_size > 0) {
+    success = tx_batch.flush() and success;
+  }
   if (success) {
     tunnels.deactivate_tunnel(tx_tun->teid_in);
   }
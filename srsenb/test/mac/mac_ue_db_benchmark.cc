@@ -0,0 +1,220 @@
+/**
+ * Copyright 2013-2021 Software Radio Systems Limited
+ *
+ * This file is part of srsRAN.
+ *
+ * srsRAN is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsRAN is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+#include "sched_test_common.h"
+#include "sched_test_utils.h"
+#include "srsenb/hdr/stack/mac/mac.h"
+#include "srsenb/test/common/rlc_test_dummy.h"
+#include "srsran/common/test_common.h"
+#include "srsran/interfaces/enb_phy_interfaces.h"
+#include <chrono>
+#include <random>
+#include <thread>
+
+namespace srsenb {
+
+class phy_dummy : public phy_interface_stack_lte
+{
+public:
+  void rem_rnti(uint16_t rnti) override { nof_rem_rnti++; }
+  void set_mch_period_stop(uint32_t stop) override {}
+  void set_activation_deactivation_scell(uint16_t                                     rnti,
+                                         const std::array<bool, SRSRAN_MAX_CARRIERS>& activation) override
+  {}
+  void configure_mbsfn(srsran::sib2_mbms_t* sib2, srsran::sib13_t* sib13, const srsran::mcch_msg_t& mcch) override {}
+  void set_config(uint16_t rnti, const phy_rrc_cfg_list_t& phy_cfg_list) override {}
+  void complete_config(uint16_t rnti) override {}
+
+  std::atomic<uint32_t> nof_rem_rnti{0};
+};
+
+struct run_params {
+  uint32_t nof_workers;
+  uint32_t nof_ues;
+  uint32_t duration_ms;
+};
+
+struct run_data {
+  run_params params;
+  uint64_t   nof_phy_calls;
+  uint32_t   nof_ttis;
+  uint32_t   nof_ue_rem;
+  float      duration_s;
+};
+
+/**
+ * Drives one MAC instance from several PHY worker threads, which report the UL/DL feedback of randomly picked UEs,
+ * while a TTI thread runs the DL/UL scheduling and the stack thread keeps removing UEs and adding new ones.
+ */
+int run_stress_scenario(const run_params& params, std::vector<run_data>& run_results)
+{
+  srslog::basic_logger&  mac_logger = srslog::fetch_basic_logger("MAC");
+  srsran::task_scheduler task_sched;
+  phy_dummy              phy;
+  rlc_dummy              rlc;
+  rrc_dummy              rrc;
+  mac                    mac_obj(srsran::ext_task_sched_handle(&task_sched), mac_logger);
+
+  mac_args_t args       = {};
+  args.nof_prb          = 25;
+  args.lcid_padding     = 3;
+  args.nof_prealloc_ues = params.nof_ues;
+  args.max_nof_kos      = 100;
+  cell_list_t cells(1);
+  TESTASSERT(mac_obj.init(args, cells, &phy, &rlc, &rrc));
+  std::vector<sched_interface::cell_cfg_t> cell_cfg_list = {generate_default_cell_cfg(args.nof_prb)};
+  TESTASSERT(mac_obj.cell_cfg(cell_cfg_list) == SRSRAN_SUCCESS);
+
+  // UEs seen by the PHY workers. The stack thread replaces the entries of the UEs it removes
+  sched_interface::ue_cfg_t           ue_cfg = generate_default_ue_cfg();
+  std::vector<std::atomic<uint16_t> > rntis(params.nof_ues);
+  for (auto& rnti : rntis) {
+    rnti = mac_obj.reserve_new_crnti(ue_cfg);
+    TESTASSERT(rnti != SRSRAN_INVALID_RNTI);
+  }
+
+  std::atomic<bool>     running{true};
+  std::atomic<uint64_t> nof_phy_calls{0};
+  std::atomic<uint32_t> nof_ttis{0};
+
+  std::vector<std::thread> workers;
+  for (uint32_t w = 0; w < params.nof_workers; ++w) {
+    workers.emplace_back([&, w]() {
+      std::minstd_rand rand_gen(w + 1);
+      uint64_t         count  = 0;
+      uint32_t         tti_rx = 0;
+      while (running.load(std::memory_order_relaxed)) {
+        uint16_t rnti = rntis[rand_gen() % rntis.size()].load(std::memory_order_relaxed);
+        tti_rx        = TTI_ADD(tti_rx, 1);
+        mac_obj.crc_info(tti_rx, rnti, 0, 0, true);
+        mac_obj.ack_info(tti_rx, rnti, 0, 0, true);
+        mac_obj.cqi_info(tti_rx, rnti, 0, 15);
+        mac_obj.snr_info(tti_rx, rnti, 0, 20.0, mac_interface_phy_lte::PUSCH);
+        mac_obj.ta_info(tti_rx, rnti, 0.0);
+        count += 5;
+      }
+      nof_phy_calls += count;
+    });
+  }
+  workers.emplace_back([&]() {
+    mac_interface_phy_lte::dl_sched_list_t dl_res(cell_cfg_list.size());
+    mac_interface_phy_lte::ul_sched_list_t ul_res(cell_cfg_list.size());
+    uint32_t                               tti_rx = 0;
+    while (running.load(std::memory_order_relaxed)) {
+      tti_rx = TTI_ADD(tti_rx, 1);
+      mac_obj.get_dl_sched(TTI_ADD(tti_rx, FDD_HARQ_DELAY_UL_MS), dl_res);
+      mac_obj.get_ul_sched(TTI_ADD(tti_rx, FDD_HARQ_DELAY_UL_MS + FDD_HARQ_DELAY_DL_MS), ul_res);
+      nof_ttis++;
+    }
+  });
+
+  // Stack thread. Replaces one UE per millisecond
+  std::minstd_rand rand_gen(0);
+  uint32_t         nof_ue_rem = 0;
+  auto             tp_start   = std::chrono::steady_clock::now();
+  for (uint32_t t = 0; t < params.duration_ms; ++t) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    task_sched.tic();
+    task_sched.run_pending_tasks();
+
+    std::atomic<uint16_t>& rnti = rntis[rand_gen() % rntis.size()];
+    TESTASSERT(mac_obj.ue_rem(rnti) == SRSRAN_SUCCESS);
+    rnti = mac_obj.reserve_new_crnti(ue_cfg);
+    TESTASSERT(rnti != SRSRAN_INVALID_RNTI);
+    nof_ue_rem++;
+
+    if (t % 100 == 0) {
+      mac_metrics_t metrics = {};
+      mac_obj.get_metrics(metrics);
+    }
+  }
+  running = false;
+  for (std::thread& w : workers) {
+    w.join();
+  }
+  float duration_s = std::chrono::duration<float>(std::chrono::steady_clock::now() - tp_start).count();
+
+  // Let the pending UE removals complete
+  for (uint32_t t = 0; t < FDD_HARQ_DELAY_DL_MS + FDD_HARQ_DELAY_UL_MS + 1; ++t) {
+    task_sched.tic();
+    task_sched.run_pending_tasks();
+  }
+  TESTASSERT(phy.nof_rem_rnti == nof_ue_rem);
+  mac_metrics_t metrics = {};
+  mac_obj.get_metrics(metrics);
+  TESTASSERT(metrics.ues.size() == params.nof_ues);
+  TESTASSERT(nof_phy_calls > 0 and nof_ttis > 0);
+
+  mac_obj.stop();
+
+  run_results.push_back(run_data{params, nof_phy_calls, nof_ttis, nof_ue_rem, duration_s});
+  return SRSRAN_SUCCESS;
+}
+
+void print_benchmark_results(const std::vector<run_data>& run_results)
+{
+  fmt::print("run | workers | Nue | PHY calls [Mcalls/s] | TTIs [kTTI/s] | UE removals\n");
+  fmt::print("---------------------------------------------------------------------\n");
+  for (uint32_t i = 0; i < run_results.size(); ++i) {
+    const run_data& r = run_results[i];
+    fmt::print("{:>3d}{:>10d}{:>6d}{:>23.2f}{:>16.2f}{:>14d}\n",
+               i,
+               r.params.nof_workers,
+               r.params.nof_ues,
+               r.nof_phy_calls / r.duration_s / 1e6,
+               r.nof_ttis / r.duration_s / 1e3,
+               r.nof_ue_rem);
+  }
+}
+
+int run_benchmark(const std::vector<uint32_t>& nof_workers_list, uint32_t duration_ms)
+{
+  std::vector<run_data> run_results;
+  for (uint32_t nof_workers : nof_workers_list) {
+    run_params params = {nof_workers, 32, duration_ms};
+    TESTASSERT(run_stress_scenario(params, run_results) == SRSRAN_SUCCESS);
+  }
+
+  print_benchmark_results(run_results);
+
+  return SRSRAN_SUCCESS;
+}
+
+} // namespace srsenb
+
+int main(int argc, char* argv[])
+{
+  auto& mac_log = srslog::fetch_basic_logger("MAC");
+  mac_log.set_level(srslog::basic_levels::none);
+  auto& test_log = srslog::fetch_basic_logger("TEST");
+  test_log.set_level(srslog::basic_levels::warning);
+
+  // Start the log backend.
+  srslog::init();
+
+  if (argc == 1 or strcmp(argv[1], "test") == 0) {
+    TESTASSERT(srsenb::run_benchmark({1, 4}, 200) == SRSRAN_SUCCESS);
+  } else {
+    TESTASSERT(srsenb::run_benchmark({1, 2, 4, 8}, 2000) == SRSRAN_SUCCESS);
+  }
+
+  return 0;
+}
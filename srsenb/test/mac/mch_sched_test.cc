@@ -0,0 +1,302 @@
+/**
+ * Copyright 2013-2021 Software Radio Systems Limited
+ *
+ * This file is part of srsRAN.
+ *
+ * srsRAN is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsRAN is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+#include "srsenb/hdr/stack/mac/mch_sched.h"
+#include "srsran/common/test_common.h"
+#include <chrono>
+#include <random>
+
+using namespace srsenb;
+
+using sf_type_t = mch_sched::sf_alloc_t::type_t;
+
+uint32_t ceil_div(uint32_t a, uint32_t b)
+{
+  return (a + b - 1) / b;
+}
+
+/// Checks that the MSI of every PMCH is consistent with the per-subframe allocation
+int check_msi_consistency(const mch_sched& sched)
+{
+  uint32_t first_sf = 0;
+  for (uint32_t pmch_idx = 0; pmch_idx < sched.nof_pmchs(); ++pmch_idx) {
+    const mch_sched::pmch_cfg_t& cfg = sched.get_pmch_cfg(pmch_idx);
+
+    mch_sched::sf_alloc_t alloc = sched.get_sf_alloc(first_sf);
+    TESTASSERT(alloc.type == sf_type_t::msi);
+    TESTASSERT(alloc.pmch_idx == pmch_idx);
+
+    uint32_t prev_stop = 0;
+    for (const mch_sched::msi_entry_t& e : sched.get_msi(pmch_idx)) {
+      if (e.stop == mch_sched::MTCH_STOP_EMPTY) {
+        continue;
+      }
+      TESTASSERT(e.stop > prev_stop);
+      TESTASSERT(first_sf + e.stop <= cfg.sf_alloc_end);
+      for (uint32_t rel = prev_stop + 1; rel <= e.stop; ++rel) {
+        alloc = sched.get_sf_alloc(first_sf + rel);
+        TESTASSERT(alloc.type == sf_type_t::mtch);
+        TESTASSERT(alloc.pmch_idx == pmch_idx);
+        TESTASSERT(alloc.lcid == e.lcid);
+      }
+      prev_stop = e.stop;
+    }
+    for (uint32_t sf_idx = first_sf + prev_stop + 1; sf_idx <= cfg.sf_alloc_end; ++sf_idx) {
+      TESTASSERT(sched.get_sf_alloc(sf_idx).type == sf_type_t::none);
+    }
+    first_sf = cfg.sf_alloc_end + 1;
+  }
+  return SRSRAN_SUCCESS;
+}
+
+uint32_t get_nof_sfs(const mch_sched& sched, uint32_t pmch_idx, uint32_t lcid)
+{
+  uint32_t prev_stop = 0;
+  for (const mch_sched::msi_entry_t& e : sched.get_msi(pmch_idx)) {
+    if (e.stop == mch_sched::MTCH_STOP_EMPTY) {
+      continue;
+    }
+    if (e.lcid == lcid) {
+      return e.stop - prev_stop;
+    }
+    prev_stop = e.stop;
+  }
+  return 0;
+}
+
+int test_mch_sched_backlogged()
+{
+  mch_sched                          sched(srslog::fetch_basic_logger("MAC"));
+  std::vector<mch_sched::pmch_cfg_t> cfg(1);
+  cfg[0].sf_alloc_end = 30;
+  cfg[0].sf_bytes     = 1000;
+  cfg[0].lcids        = {1, 2, 3};
+  sched.set_cfg(cfg);
+  TESTASSERT(sched.is_configured());
+
+  // All MTCHs have more data than fits in the period
+  for (uint32_t lcid : cfg[0].lcids) {
+    sched.set_buffer_state(lcid, 100000);
+  }
+  sched.new_sched_period();
+  TESTASSERT(check_msi_consistency(sched) == SRSRAN_SUCCESS);
+  TESTASSERT(sched.get_period_metrics().nof_data_sfs == 30);
+  TESTASSERT(sched.get_period_metrics().nof_alloc_sfs == 30);
+  TESTASSERT(sched.get_last_alloc_sf() == 30);
+  for (uint32_t lcid : cfg[0].lcids) {
+    TESTASSERT(get_nof_sfs(sched, 0, lcid) == 10);
+  }
+
+  // A backlogged MTCH takes the capacity left by the others
+  sched.set_buffer_state(1, 2500);
+  sched.set_buffer_state(2, 0);
+  sched.new_sched_period();
+  TESTASSERT(check_msi_consistency(sched) == SRSRAN_SUCCESS);
+  TESTASSERT(get_nof_sfs(sched, 0, 1) == 3);
+  TESTASSERT(get_nof_sfs(sched, 0, 2) == 0);
+  TESTASSERT(get_nof_sfs(sched, 0, 3) == 27);
+  TESTASSERT(sched.get_msi(0)[1].stop == mch_sched::MTCH_STOP_EMPTY);
+  TESTASSERT(sched.get_period_metrics().nof_alloc_sfs == 30);
+  return SRSRAN_SUCCESS;
+}
+
+int test_mch_sched_underloaded()
+{
+  mch_sched                          sched(srslog::fetch_basic_logger("MAC"));
+  std::vector<mch_sched::pmch_cfg_t> cfg(1);
+  cfg[0].sf_alloc_end = 40;
+  cfg[0].sf_bytes     = 500;
+  cfg[0].lcids        = {1, 2};
+  sched.set_cfg(cfg);
+
+  sched.set_buffer_state(1, 1200);
+  sched.set_buffer_state(2, 100);
+  sched.new_sched_period();
+  TESTASSERT(check_msi_consistency(sched) == SRSRAN_SUCCESS);
+  TESTASSERT(get_nof_sfs(sched, 0, 1) == 3);
+  TESTASSERT(get_nof_sfs(sched, 0, 2) == 1);
+  TESTASSERT(sched.get_last_alloc_sf() == 4);
+
+  // No data, only the MSI is sent
+  sched.set_buffer_state(1, 0);
+  sched.set_buffer_state(2, 0);
+  sched.new_sched_period();
+  TESTASSERT(check_msi_consistency(sched) == SRSRAN_SUCCESS);
+  TESTASSERT(sched.get_period_metrics().nof_alloc_sfs == 0);
+  TESTASSERT(sched.get_last_alloc_sf() == 0);
+  return SRSRAN_SUCCESS;
+}
+
+int test_mch_sched_multi_pmch()
+{
+  mch_sched                          sched(srslog::fetch_basic_logger("MAC"));
+  std::vector<mch_sched::pmch_cfg_t> cfg(2);
+  cfg[0].sf_alloc_end = 9;
+  cfg[0].sf_bytes     = 300;
+  cfg[0].lcids        = {1};
+  cfg[1].sf_alloc_end = 29;
+  cfg[1].sf_bytes     = 2000;
+  cfg[1].lcids        = {2, 3};
+  sched.set_cfg(cfg);
+  TESTASSERT(sched.nof_pmchs() == 2);
+
+  sched.set_buffer_state(1, 300 * 4);
+  sched.set_buffer_state(2, 2000 * 5);
+  sched.set_buffer_state(3, 100000);
+  sched.new_sched_period();
+  TESTASSERT(check_msi_consistency(sched) == SRSRAN_SUCCESS);
+  TESTASSERT(get_nof_sfs(sched, 0, 1) == 4);
+  TESTASSERT(get_nof_sfs(sched, 1, 2) == 5);
+  TESTASSERT(get_nof_sfs(sched, 1, 3) == 14);
+  TESTASSERT(sched.get_period_metrics().nof_data_sfs == 9 + 19);
+  TESTASSERT(sched.get_period_metrics().nof_alloc_sfs == 4 + 19);
+
+  // The MSI of the second PMCH is sent in its first subframe, and its stops are relative to it
+  TESTASSERT(sched.get_sf_alloc(10).type == sf_type_t::msi);
+  TESTASSERT(sched.get_sf_alloc(10).pmch_idx == 1);
+  TESTASSERT(sched.get_msi(1)[0].stop == 5);
+  TESTASSERT(sched.get_msi(1)[1].stop == 19);
+  TESTASSERT(sched.get_sf_alloc(5).type == sf_type_t::none);
+  TESTASSERT(sched.get_last_alloc_sf() == 29);
+
+  // An MTCH left out of the period does not extend the allocation of its PMCH
+  sched.set_buffer_state(3, 0);
+  sched.new_sched_period();
+  TESTASSERT(check_msi_consistency(sched) == SRSRAN_SUCCESS);
+  TESTASSERT(sched.get_msi(1)[1].stop == mch_sched::MTCH_STOP_EMPTY);
+  TESTASSERT(sched.get_sf_alloc(16).type == sf_type_t::none);
+  TESTASSERT(sched.get_last_alloc_sf() == 15);
+  return SRSRAN_SUCCESS;
+}
+
+/// Subframes left over by an uneven split go to a different MTCH every period
+int test_mch_sched_fairness()
+{
+  mch_sched                          sched(srslog::fetch_basic_logger("MAC"));
+  std::vector<mch_sched::pmch_cfg_t> cfg(1);
+  cfg[0].sf_alloc_end = 10;
+  cfg[0].sf_bytes     = 1000;
+  cfg[0].lcids        = {1, 2, 3};
+  sched.set_cfg(cfg);
+  for (uint32_t lcid : cfg[0].lcids) {
+    sched.set_buffer_state(lcid, 1000000);
+  }
+
+  std::array<uint32_t, 4> total = {};
+  for (uint32_t period = 0; period < 3; ++period) {
+    sched.new_sched_period();
+    TESTASSERT(check_msi_consistency(sched) == SRSRAN_SUCCESS);
+    for (uint32_t lcid : cfg[0].lcids) {
+      uint32_t nof_sfs = get_nof_sfs(sched, 0, lcid);
+      TESTASSERT(nof_sfs == 3 or nof_sfs == 4);
+      total[lcid] += nof_sfs;
+    }
+  }
+  TESTASSERT(total[1] == 10 and total[2] == 10 and total[3] == 10);
+  return SRSRAN_SUCCESS;
+}
+
+/// Allocation of the previous MCH scheduler, which split the period with an integer buffer ratio
+uint32_t legacy_nof_alloc_sfs(const std::vector<uint32_t>& buffers, uint32_t nof_sfs, uint32_t sf_bytes)
+{
+  uint32_t total_bytes = 0;
+  for (uint32_t b : buffers) {
+    total_bytes += b;
+  }
+  uint32_t stop = 0;
+  for (uint32_t b : buffers) {
+    if (total_bytes > 0 and total_bytes >= nof_sfs * sf_bytes) {
+      stop += nof_sfs * (b / total_bytes);
+    } else {
+      stop += ceil_div(b, sf_bytes);
+    }
+  }
+  return std::min(stop, nof_sfs);
+}
+
+/// Random MTCH load. Measures the share of the subframes that could be used (limited by demand or capacity) that are
+/// actually allocated, and compares it with the previous scheduler
+int test_mch_sched_utilisation(uint32_t nof_periods)
+{
+  std::mt19937                            rgen(1234);
+  std::uniform_int_distribution<uint32_t> load_dist(0, 60000);
+
+  mch_sched                          sched(srslog::fetch_basic_logger("MAC"));
+  std::vector<mch_sched::pmch_cfg_t> cfg(2);
+  cfg[0].sf_alloc_end = 191;
+  cfg[0].sf_bytes     = 900;
+  cfg[0].lcids        = {1, 2, 3, 4};
+  cfg[1].sf_alloc_end = 383;
+  cfg[1].sf_bytes     = 3000;
+  cfg[1].lcids        = {5, 6};
+  sched.set_cfg(cfg);
+
+  uint64_t usable = 0, alloc = 0, legacy_alloc = 0, first_sf = 0;
+  auto     tp     = std::chrono::high_resolution_clock::now();
+  for (uint32_t period = 0; period < nof_periods; ++period) {
+    first_sf = 0;
+    for (const mch_sched::pmch_cfg_t& pmch : cfg) {
+      uint32_t              nof_sfs = pmch.sf_alloc_end - first_sf;
+      uint32_t              demand  = 0;
+      std::vector<uint32_t> buffers;
+      for (uint32_t lcid : pmch.lcids) {
+        buffers.push_back(load_dist(rgen));
+        sched.set_buffer_state(lcid, buffers.back());
+        demand += ceil_div(buffers.back(), pmch.sf_bytes);
+      }
+      usable += std::min(demand, nof_sfs);
+      legacy_alloc += legacy_nof_alloc_sfs(buffers, nof_sfs, pmch.sf_bytes);
+      first_sf = pmch.sf_alloc_end + 1;
+    }
+    sched.new_sched_period();
+    TESTASSERT(check_msi_consistency(sched) == SRSRAN_SUCCESS);
+    alloc += sched.get_period_metrics().nof_alloc_sfs;
+  }
+  auto elapsed =
+      std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::high_resolution_clock::now() - tp).count();
+
+  TESTASSERT(alloc == usable);
+  fmt::print("MCH utilisation over {} periods: DRR={:.1f}%, integer ratio={:.1f}%, {:.2f} us/period\n",
+             nof_periods,
+             100.0 * alloc / usable,
+             100.0 * legacy_alloc / usable,
+             elapsed / (double)nof_periods);
+  return SRSRAN_SUCCESS;
+}
+
+int main(int argc, char** argv)
+{
+  srsran::test_init(argc, argv);
+
+  uint32_t nof_periods = 1000;
+  if (argc > 1) {
+    nof_periods = std::strtoul(argv[1], nullptr, 10);
+  }
+
+  TESTASSERT(test_mch_sched_backlogged() == SRSRAN_SUCCESS);
+  TESTASSERT(test_mch_sched_underloaded() == SRSRAN_SUCCESS);
+  TESTASSERT(test_mch_sched_multi_pmch() == SRSRAN_SUCCESS);
+  TESTASSERT(test_mch_sched_fairness() == SRSRAN_SUCCESS);
+  TESTASSERT(test_mch_sched_utilisation(nof_periods) == SRSRAN_SUCCESS);
+
+  printf("Success\n");
+  return 0;
+}
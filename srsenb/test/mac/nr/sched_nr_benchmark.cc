@@ -0,0 +1,186 @@
+/**
+ * Copyright 2013-2021 Software Radio Systems Limited
+ *
+ * This file is part of srsRAN.
+ *
+ * srsRAN is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsRAN is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+#include "sched_nr_cfg_generators.h"
+#include "srsenb/hdr/stack/mac/nr/sched_nr.h"
+#include "srsran/common/test_common.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+namespace srsenb {
+
+struct run_params {
+  uint32_t nof_cells;
+  uint32_t nof_ues;
+  uint32_t nof_pipelined_slots;
+  uint32_t nof_slots;
+};
+
+struct run_data {
+  run_params                   params;
+  float                        slots_per_sec;
+  float                        avg_pdsch_per_slot;
+  std::chrono::duration<float> p50_slot_time;
+  std::chrono::duration<float> p99_slot_time;
+  std::chrono::duration<float> max_slot_time;
+};
+
+/**
+ * Runs params.nof_slots slots of a scheduler with full-buffer UEs spread over params.nof_cells cells. As the PHY would
+ * do, each cell calls run_slot from its own thread, and feeds back positive HARQ-ACKs and CRCs for the allocated grants.
+ * The time spent in each {slot, cc} call is measured
+ */
+int run_sched_nr_scenario(const run_params& params, std::vector<run_data>& run_results)
+{
+  sched_nr_interface::sched_args_t sched_args;
+  sched_args.auto_refill_buffer  = true;
+  sched_args.nof_pipelined_slots = params.nof_pipelined_slots;
+
+  std::vector<sched_nr_interface::cell_cfg_t> cells_cfg = get_default_cells_cfg(params.nof_cells);
+
+  sched_nr sched;
+  TESTASSERT(sched.config(sched_args, cells_cfg) == SRSRAN_SUCCESS);
+  for (uint32_t i = 0; i < params.nof_ues; ++i) {
+    sched_nr_interface::ue_cfg_t uecfg = get_default_ue_cfg(1);
+    uecfg.carriers[0].cc               = i % params.nof_cells;
+    sched.ue_cfg(0x4601 + i, uecfg);
+  }
+
+  std::vector<std::vector<std::chrono::nanoseconds> > slot_times(params.nof_cells);
+  std::atomic<uint64_t>                               nof_pdschs{0};
+
+  auto cell_phy = [&sched, &params, &slot_times, &nof_pdschs](uint32_t cc) {
+    sched_nr_interface::sched_rar_list_t rar;
+    sched_nr_interface::dl_sched_t       dl_sched;
+    sched_nr_interface::ul_res_t         ul_res;
+    slot_times[cc].reserve(params.nof_slots);
+
+    for (uint32_t n = 0; n < params.nof_slots; ++n) {
+      slot_point                   slot_tx{0, (n + TX_ENB_DELAY) % 10240};
+      sched_nr_interface::dl_res_t dl_res(rar, dl_sched);
+
+      auto tp_start = std::chrono::steady_clock::now();
+      TESTASSERT(sched.run_slot(slot_tx, cc, dl_res) == SRSRAN_SUCCESS);
+      TESTASSERT(sched.get_ul_sched(slot_tx, cc, ul_res) == SRSRAN_SUCCESS);
+      slot_times[cc].push_back(
+          std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - tp_start));
+
+      // Positive feedback, so that the HARQ processes are freed for the next slots
+      for (const auto& pdcch : dl_sched.pdcch_dl) {
+        if (pdcch.dci.ctx.rnti_type == srsran_rnti_type_c) {
+          sched.dl_ack_info(pdcch.dci.ctx.rnti, cc, pdcch.dci.pid, 0, true);
+        }
+      }
+      for (const auto& pdcch : dl_sched.pdcch_ul) {
+        sched.ul_crc_info(pdcch.dci.ctx.rnti, cc, pdcch.dci.pid, true);
+      }
+      nof_pdschs += dl_sched.pdsch.size();
+    }
+  };
+
+  auto                     tp_start = std::chrono::steady_clock::now();
+  std::vector<std::thread> phy_threads;
+  for (uint32_t cc = 0; cc < params.nof_cells; ++cc) {
+    phy_threads.emplace_back(cell_phy, cc);
+  }
+  for (auto& t : phy_threads) {
+    t.join();
+  }
+  std::chrono::duration<float> tot_time = std::chrono::steady_clock::now() - tp_start;
+
+  std::vector<std::chrono::nanoseconds> all_times;
+  for (auto& v : slot_times) {
+    all_times.insert(all_times.end(), v.begin(), v.end());
+  }
+  std::sort(all_times.begin(), all_times.end());
+
+  run_data r;
+  r.params             = params;
+  r.slots_per_sec      = params.nof_slots / tot_time.count();
+  r.avg_pdsch_per_slot = nof_pdschs / (float)(params.nof_slots * params.nof_cells);
+  r.p50_slot_time      = all_times[all_times.size() / 2];
+  r.p99_slot_time      = all_times[(all_times.size() * 99) / 100];
+  r.max_slot_time      = all_times.back();
+  run_results.push_back(r);
+  return SRSRAN_SUCCESS;
+}
+
+void print_benchmark_results(const std::vector<run_data>& run_results)
+{
+  fmt::print("run | Ncell | Nue | pipelined | slots/s | PDSCH/{{slot,cc}} | time p50/p99/max [usec]\n");
+  fmt::print("-------------------------------------------------------------------------------------\n");
+  for (uint32_t i = 0; i < run_results.size(); ++i) {
+    const run_data& r = run_results[i];
+    fmt::print("{:>3d}{:>8d}{:>6d}{:>12d}{:>10.0f}{:>19.2f}{:>10.1f}/{:>6.1f}/{:>7.1f}\n",
+               i,
+               r.params.nof_cells,
+               r.params.nof_ues,
+               r.params.nof_pipelined_slots,
+               r.slots_per_sec,
+               r.avg_pdsch_per_slot,
+               r.p50_slot_time.count() * 1e6,
+               r.p99_slot_time.count() * 1e6,
+               r.max_slot_time.count() * 1e6);
+  }
+}
+
+int run_benchmark(const std::vector<uint32_t>& nof_ues_list,
+                  const std::vector<uint32_t>& pipeline_list,
+                  uint32_t                     nof_slots)
+{
+  std::vector<run_data> run_results;
+  for (uint32_t nof_cells = 1; nof_cells <= SCHED_NR_MAX_CARRIERS; ++nof_cells) {
+    for (uint32_t nof_ues : nof_ues_list) {
+      for (uint32_t nof_pipelined : pipeline_list) {
+        // The UE DB holds at most SCHED_NR_MAX_USERS UEs
+        run_params params = {nof_cells, std::min(nof_ues, (uint32_t)SCHED_NR_MAX_USERS), nof_pipelined, nof_slots};
+        TESTASSERT(run_sched_nr_scenario(params, run_results) == SRSRAN_SUCCESS);
+      }
+    }
+  }
+
+  print_benchmark_results(run_results);
+
+  return SRSRAN_SUCCESS;
+}
+
+} // namespace srsenb
+
+int main(int argc, char* argv[])
+{
+  auto& mac_nr_logger = srslog::fetch_basic_logger("MAC-NR");
+  mac_nr_logger.set_level(srslog::basic_levels::none);
+  auto& test_logger = srslog::fetch_basic_logger("TEST");
+  test_logger.set_level(srslog::basic_levels::warning);
+
+  // Start the log backend.
+  srslog::init();
+
+  if (argc == 1 or strcmp(argv[1], "test") == 0) {
+    TESTASSERT(srsenb::run_benchmark({8}, {0, 2}, 200) == SRSRAN_SUCCESS);
+  } else {
+    TESTASSERT(srsenb::run_benchmark({1, 16, 64, 256}, {0, 1, 2, 4}, 10000) == SRSRAN_SUCCESS);
+  }
+
+  return 0;
+}
@@ -0,0 +1,88 @@
+/**
+ * Copyright 2013-2021 Software Radio Systems Limited
+ *
+ * This file is part of srsRAN.
+ *
+ * srsRAN is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsRAN is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+#include "srsenb/hdr/stack/mac/nr/sched_nr_worker.h"
+#include "srsran/common/test_common.h"
+#include <thread>
+
+namespace srsenb {
+
+/// Several producers push numbered events into a queue whose ring is much smaller than the number of events in
+/// flight, so that the overflow list is used, while the consumer drains the queue. The events of each producer must be
+/// drained in the order they were pushed, and none can be lost
+void test_event_queue_order()
+{
+  using namespace sched_nr_impl;
+
+  struct event_t {
+    uint32_t producer = 0;
+    uint32_t count    = 0;
+  };
+  const uint32_t nof_producers = 4, nof_events = 100000;
+
+  sched_event_queue<event_t, 4> queue;
+  std::atomic<uint32_t>         nof_producers_done{0};
+  std::vector<std::thread>      producers;
+  for (uint32_t p = 0; p < nof_producers; ++p) {
+    producers.emplace_back([&queue, &nof_producers_done, p, nof_events]() {
+      for (uint32_t i = 0; i < nof_events; ++i) {
+        event_t ev;
+        ev.producer = p;
+        ev.count    = i;
+        queue.push(std::move(ev));
+      }
+      nof_producers_done++;
+    });
+  }
+
+  std::vector<uint32_t> next_count(nof_producers, 0);
+  uint32_t              nof_out_of_order = 0;
+  auto                  check_event      = [&next_count, &nof_out_of_order](event_t& ev) {
+    if (ev.count != next_count[ev.producer]) {
+      nof_out_of_order++;
+    }
+    next_count[ev.producer] = ev.count + 1;
+  };
+  while (nof_producers_done < nof_producers) {
+    queue.drain(check_event);
+  }
+  for (std::thread& t : producers) {
+    t.join();
+  }
+  queue.drain(check_event);
+
+  TESTASSERT(nof_out_of_order == 0);
+  for (uint32_t p = 0; p < nof_producers; ++p) {
+    TESTASSERT(next_count[p] == nof_events);
+  }
+}
+
+} // namespace srsenb
+
+int main(int argc, char** argv)
+{
+  auto& test_logger = srslog::fetch_basic_logger("TEST");
+  test_logger.set_level(srslog::basic_levels::info);
+
+  srsran::test_init(argc, argv);
+
+  srsenb::test_event_queue_order();
+}
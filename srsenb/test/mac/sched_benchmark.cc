@@ -24,6 +24,7 @@
 #include "srsran/adt/accumulators.h"
 #include "srsran/common/common_lte.h"
 #include <chrono>
+#include <limits>
 
 namespace srsenb {
 
@@ -33,16 +34,28 @@ struct run_params {
   uint32_t    nof_ttis;
   uint32_t    cqi;
   const char* sched_policy;
+  uint32_t    nof_ccs;
+  bool        parallel_cc;
+  uint32_t    nof_active_ues; ///< UEs with DL/UL traffic. The other UEs stay connected with empty buffers
+  bool        ca;             ///< UEs with all the carriers configured. Otherwise, each UE only has its PCell
 };
 
 struct run_params_range {
   std::vector<uint32_t>    nof_prbs{srsran::lte_cell_nof_prbs.begin(), srsran::lte_cell_nof_prbs.end()};
-  std::vector<uint32_t>    nof_ues      = {1, 2, 5, 32};
-  uint32_t                 nof_ttis     = 10000;
-  std::vector<uint32_t>    cqi          = {5, 10, 15};
-  std::vector<const char*> sched_policy = {"time_rr", "time_pf"};
-
-  size_t     nof_runs() const { return nof_prbs.size() * nof_ues.size() * cqi.size() * sched_policy.size(); }
+  std::vector<uint32_t>    nof_ues        = {1, 2, 5, 32};
+  uint32_t                 nof_ttis       = 10000;
+  std::vector<uint32_t>    cqi            = {5, 10, 15};
+  std::vector<const char*> sched_policy   = {"time_rr", "time_pf"};
+  std::vector<uint32_t>    nof_ccs        = {1};
+  std::vector<bool>        parallel_cc    = {false};
+  std::vector<bool>        ca             = {true};
+  uint32_t                 max_active_ues = std::numeric_limits<uint32_t>::max();
+
+  size_t nof_runs() const
+  {
+    return nof_prbs.size() * nof_ues.size() * cqi.size() * sched_policy.size() * nof_ccs.size() * parallel_cc.size() *
+           ca.size();
+  }
   run_params get_params(size_t idx) const
   {
     run_params r = {};
@@ -53,7 +66,14 @@ struct run_params_range {
     idx /= nof_ues.size();
     r.cqi = cqi[idx % cqi.size()];
     idx /= cqi.size();
-    r.sched_policy = sched_policy.at(idx);
+    r.sched_policy = sched_policy[idx % sched_policy.size()];
+    idx /= sched_policy.size();
+    r.nof_ccs = nof_ccs[idx % nof_ccs.size()];
+    idx /= nof_ccs.size();
+    r.parallel_cc = parallel_cc[idx % parallel_cc.size()];
+    idx /= parallel_cc.size();
+    r.ca             = ca.at(idx);
+    r.nof_active_ues = std::min(r.nof_ues, max_active_ues);
     return r;
   }
 };
@@ -79,6 +99,8 @@ public:
     ul_result(cell_cfg_list.size())
   {}
 
+  static const uint16_t first_rnti = 0x46;
+
   srslog::basic_logger& mac_logger = srslog::fetch_basic_logger("MAC");
   sched*                sched_ptr;
   uint32_t              dl_bytes_per_tti   = 100000;
@@ -101,15 +123,16 @@ public:
     mac_logger.set_context(tti_rx.to_uint());
     new_tti(tti_rx);
 
+    // The latency of a TTI covers the scheduling of all the carriers
+    std::chrono::time_point<std::chrono::steady_clock> tp = std::chrono::steady_clock::now();
     for (uint32_t cc = 0; cc < get_cell_params().size(); ++cc) {
-      std::chrono::time_point<std::chrono::steady_clock> tp = std::chrono::steady_clock::now();
       TESTASSERT(sched_ptr->dl_sched(to_tx_dl(tti_rx).to_uint(), cc, dl_result[cc]) == SRSRAN_SUCCESS);
       TESTASSERT(sched_ptr->ul_sched(to_tx_ul(tti_rx).to_uint(), cc, ul_result[cc]) == SRSRAN_SUCCESS);
-      std::chrono::time_point<std::chrono::steady_clock> tp2 = std::chrono::steady_clock::now();
-      std::chrono::nanoseconds tdur = std::chrono::duration_cast<std::chrono::nanoseconds>(tp2 - tp);
-      total_stats.avg_latency.push(tdur.count());
-      total_stats.latency_samples.push_back(tdur.count());
     }
+    std::chrono::time_point<std::chrono::steady_clock> tp2 = std::chrono::steady_clock::now();
+    std::chrono::nanoseconds tdur = std::chrono::duration_cast<std::chrono::nanoseconds>(tp2 - tp);
+    total_stats.avg_latency.push(tdur.count());
+    total_stats.latency_samples.push_back(tdur.count());
 
     sf_output_res_t sf_out{get_cell_params(), tti_rx, ul_result, dl_result};
     update(sf_out);
@@ -122,8 +145,10 @@ public:
   {
     // do nothing
     if (ue_ctxt.conres_rx) {
-      sched_ptr->ul_bsr(ue_ctxt.rnti, 1, dl_bytes_per_tti);
-      sched_ptr->dl_rlc_buffer_state(ue_ctxt.rnti, 3, ul_bytes_per_tti, 0);
+      if (static_cast<uint32_t>(ue_ctxt.rnti - first_rnti) < current_run_params.nof_active_ues) {
+        sched_ptr->ul_bsr(ue_ctxt.rnti, 1, dl_bytes_per_tti);
+        sched_ptr->dl_rlc_buffer_state(ue_ctxt.rnti, 3, ul_bytes_per_tti, 0);
+      }
 
       if (get_tti_rx().to_uint() % 5 == 0) {
         for (auto& cc : pending_events.cc_list) {
@@ -166,15 +191,61 @@ struct run_data {
   float                     avg_dl_mcs;
   float                     avg_ul_mcs;
   std::chrono::microseconds avg_latency;
-  std::chrono::microseconds q0_9_latency;
+  std::chrono::microseconds p50_latency;
+  std::chrono::microseconds p99_latency;
 };
 
+/// Cell list where every carrier can be configured as SCell of the UEs whose PCell is any of the other carriers
+std::vector<sched_interface::cell_cfg_t> generate_cell_list(uint32_t nof_prbs, uint32_t nof_ccs)
+{
+  std::vector<sched_interface::cell_cfg_t> cell_list(nof_ccs, generate_default_cell_cfg(nof_prbs));
+  for (uint32_t cc = 0; cc < nof_ccs; ++cc) {
+    cell_list[cc].cell.id = cc + 1;
+    for (uint32_t scc = 0; scc < nof_ccs; ++scc) {
+      if (scc != cc) {
+        cell_list[cc].scell_list.emplace_back();
+        cell_list[cc].scell_list.back().enb_cc_idx               = scc;
+        cell_list[cc].scell_list.back().cross_carrier_scheduling = false;
+        cell_list[cc].scell_list.back().ul_allowed               = true;
+      }
+    }
+  }
+  return cell_list;
+}
+
+/// UE config with all the carriers, or only with the PCell if ca is false. The PCells of the UEs are spread across the
+/// carriers
+sched_interface::ue_cfg_t generate_ca_ue_cfg(uint32_t ue_idx, uint32_t nof_ccs, bool ca)
+{
+  sched_interface::ue_cfg_t ue_cfg = generate_default_ue_cfg();
+  if (not ca) {
+    ue_cfg.supported_cc_list[0].enb_cc_idx = ue_idx % nof_ccs;
+    return ue_cfg;
+  }
+  ue_cfg.supported_cc_list.resize(nof_ccs, ue_cfg.supported_cc_list[0]);
+  for (uint32_t i = 0; i < nof_ccs; ++i) {
+    ue_cfg.supported_cc_list[i].enb_cc_idx = (ue_idx + i) % nof_ccs;
+    if (nof_ccs > 1) {
+      // With CA, each carrier needs its own periodic CQI resources
+      ue_cfg.supported_cc_list[i].dl_cfg.cqi_report.periodic_configured = true;
+      ue_cfg.supported_cc_list[i].dl_cfg.cqi_report.pmi_idx             = 37 + i;
+    }
+  }
+  return ue_cfg;
+}
+
+/// Quantile q of the sorted latency samples, in usec
+std::chrono::microseconds latency_quantile(const std::vector<uint32_t>& sorted_samples, double q)
+{
+  return std::chrono::microseconds(sorted_samples[static_cast<size_t>(sorted_samples.size() * q)] / 1000);
+}
+
 int run_benchmark_scenario(run_params params, std::vector<run_data>& run_results)
 {
-  std::vector<sched_interface::cell_cfg_t> cell_list(1, generate_default_cell_cfg(params.nof_prbs));
-  sched_interface::ue_cfg_t                ue_cfg_default = generate_default_ue_cfg();
-  sched_interface::sched_args_t            sched_args     = {};
-  sched_args.sched_policy                                 = params.sched_policy;
+  std::vector<sched_interface::cell_cfg_t> cell_list  = generate_cell_list(params.nof_prbs, params.nof_ccs);
+  sched_interface::sched_args_t            sched_args = {};
+  sched_args.sched_policy                             = params.sched_policy;
+  sched_args.parallel_cc                              = params.parallel_cc;
 
   sched     sched_obj;
   rrc_dummy rrc{};
@@ -185,15 +256,16 @@ int run_benchmark_scenario(run_params params, std::vector<run_data>& run_results
   tester.current_run_params = params;
 
   for (uint32_t ue_idx = 0; ue_idx < params.nof_ues; ++ue_idx) {
-    uint16_t rnti = 0x46 + ue_idx;
+    uint16_t                  rnti   = sched_tester::first_rnti + ue_idx;
+    sched_interface::ue_cfg_t ue_cfg = generate_ca_ue_cfg(ue_idx, params.nof_ccs, params.ca);
     // Add user (first need to advance to a PRACH TTI)
     while (not srsran_prach_tti_opportunity_config_fdd(
-        tester.get_cell_params()[ue_cfg_default.supported_cc_list[0].enb_cc_idx].cfg.prach_config,
+        tester.get_cell_params()[ue_cfg.supported_cc_list[0].enb_cc_idx].cfg.prach_config,
         tester.get_tti_rx().to_uint(),
         -1)) {
       TESTASSERT(tester.advance_tti() == SRSRAN_SUCCESS);
     }
-    TESTASSERT(tester.add_user(rnti, ue_cfg_default, 16) == SRSRAN_SUCCESS);
+    TESTASSERT(tester.add_user(rnti, ue_cfg, 16) == SRSRAN_SUCCESS);
     TESTASSERT(tester.advance_tti() == SRSRAN_SUCCESS);
   }
 
@@ -220,9 +292,9 @@ int run_benchmark_scenario(run_params params, std::vector<run_data>& run_results
   run_result.avg_ul_throughput = tester.total_stats.mean_ul_tbs.value() * 8.0F / 1e-3F;
   run_result.avg_dl_mcs        = tester.total_stats.avg_dl_mcs.value();
   run_result.avg_ul_mcs        = tester.total_stats.avg_ul_mcs.value();
-  run_result.avg_latency  = std::chrono::microseconds(static_cast<int>(tester.total_stats.avg_latency.value() / 1000));
-  run_result.q0_9_latency = std::chrono::microseconds(
-      tester.total_stats.latency_samples[static_cast<size_t>(tester.total_stats.latency_samples.size() * 0.9)] / 1000);
+  run_result.avg_latency = std::chrono::microseconds(static_cast<int>(tester.total_stats.avg_latency.value() / 1000));
+  run_result.p50_latency = latency_quantile(tester.total_stats.latency_samples, 0.5);
+  run_result.p99_latency = latency_quantile(tester.total_stats.latency_samples, 0.99);
   run_results.push_back(run_result);
 
   return SRSRAN_SUCCESS;
@@ -264,10 +336,10 @@ run_data expected_run_result(run_params params)
 void print_benchmark_results(const std::vector<run_data>& run_results)
 {
   srslog::flush();
-  fmt::print("run | Nprb | cqi | sched pol | Nue | DL/UL [Mbps] | DL/UL mcs | DL/UL OH [%] | latency | latency q0.9 "
+  fmt::print("run | Nprb | cqi | sched pol | Nue | DL/UL [Mbps] | DL/UL mcs | DL/UL OH [%] | latency avg/p50/p99 "
              "[usec]\n");
   fmt::print("------------------------------------------------------------------------------------------------------"
-             "------\n");
+             "-----\n");
   for (uint32_t i = 0; i < run_results.size(); ++i) {
     const run_data& r = run_results[i];
 
@@ -279,7 +351,7 @@ void print_benchmark_results(const std::vector<run_data>& run_results)
     tbs                     = srsran_ra_tbs_from_idx(tbs_idx, nof_pusch_prbs);
     float ul_rate_overhead  = 1.0F - r.avg_ul_throughput / (static_cast<float>(tbs) * 1e3F);
 
-    fmt::print("{:>3d}{:>6d}{:>6d}{:>12}{:>6d}{:>9.2}/{:>4.2}{:>9.1f}/{:>4.1f}{:9.1f}/{:>4.1f}{:>9d}{:12d}\n",
+    fmt::print("{:>3d}{:>6d}{:>6d}{:>12}{:>6d}{:>9.2}/{:>4.2}{:>9.1f}/{:>4.1f}{:9.1f}/{:>4.1f}{:>11d}/{:>4d}/{:>4d}\n",
                i,
                r.params.nof_prbs,
                r.params.cqi,
@@ -292,10 +364,97 @@ void print_benchmark_results(const std::vector<run_data>& run_results)
                dl_rate_overhead * 100,
                ul_rate_overhead * 100,
                r.avg_latency.count(),
-               r.q0_9_latency.count());
+               r.p50_latency.count(),
+               r.p99_latency.count());
+  }
+}
+
+void print_latency_results(const std::vector<run_data>& run_results)
+{
+  srslog::flush();
+  fmt::print("run | Nprb | Ncc | CA  | parallel | Nue | active | DL/UL [Mbps] | latency avg/p50/p99 [usec]\n");
+  fmt::print("-----------------------------------------------------------------------------------------\n");
+  for (uint32_t i = 0; i < run_results.size(); ++i) {
+    const run_data& r = run_results[i];
+    fmt::print("{:>3d}{:>6d}{:>6d}{:>6}{:>11}{:>6d}{:>9d}{:>9.2}/{:>4.2}{:>12d}/{:>4d}/{:>4d}\n",
+               i,
+               r.params.nof_prbs,
+               r.params.nof_ccs,
+               r.params.ca ? "yes" : "no",
+               r.params.parallel_cc ? "yes" : "no",
+               r.params.nof_ues,
+               r.params.nof_active_ues,
+               r.avg_dl_throughput / 1e6,
+               r.avg_ul_throughput / 1e6,
+               r.avg_latency.count(),
+               r.p50_latency.count(),
+               r.p99_latency.count());
   }
 }
 
+/// Latency of the scheduling of a TTI as a function of the number of carriers and UEs, with and without one scheduling
+/// thread per carrier, and with and without UEs configured in several carriers
+int run_latency_sweep(uint32_t nof_ttis, const std::vector<uint32_t>& nof_ccs, const std::vector<uint32_t>& nof_ues)
+{
+  run_params_range      run_param_list{};
+  srslog::basic_logger& mac_logger = srslog::fetch_basic_logger("MAC");
+
+  run_param_list.nof_ttis     = nof_ttis;
+  run_param_list.nof_prbs     = {100};
+  run_param_list.cqi          = {15};
+  run_param_list.nof_ues      = nof_ues;
+  run_param_list.sched_policy = {"time_pf"};
+  run_param_list.nof_ccs      = nof_ccs;
+  run_param_list.parallel_cc  = {false, true};
+  run_param_list.ca           = {false, true};
+
+  std::vector<run_data> run_results;
+  size_t                nof_runs = run_param_list.nof_runs();
+  fmt::print("\n====== Scheduler Latency vs Carriers and UEs ======\n\n");
+  for (size_t r = 0; r < nof_runs; ++r) {
+    run_params runparams = run_param_list.get_params(r);
+    if (runparams.nof_ccs == 1 and (runparams.parallel_cc or not runparams.ca)) {
+      // Same as the sequential run
+      continue;
+    }
+
+    mac_logger.info("\n### New run {} ###\n", r);
+    TESTASSERT(run_benchmark_scenario(runparams, run_results) == SRSRAN_SUCCESS);
+  }
+
+  print_latency_results(run_results);
+
+  return SRSRAN_SUCCESS;
+}
+
+/// Latency of the scheduling of a TTI with many connected UEs, of which only a few have traffic
+int run_idle_ues_sweep(uint32_t nof_ttis, const std::vector<uint32_t>& nof_ues, uint32_t nof_active_ues)
+{
+  run_params_range      run_param_list{};
+  srslog::basic_logger& mac_logger = srslog::fetch_basic_logger("MAC");
+
+  run_param_list.nof_ttis       = nof_ttis;
+  run_param_list.nof_prbs       = {100};
+  run_param_list.cqi            = {15};
+  run_param_list.nof_ues        = nof_ues;
+  run_param_list.sched_policy   = {"time_pf"};
+  run_param_list.max_active_ues = nof_active_ues;
+
+  std::vector<run_data> run_results;
+  size_t                nof_runs = run_param_list.nof_runs();
+  fmt::print("\n====== Scheduler Latency with Idle UEs ======\n\n");
+  for (size_t r = 0; r < nof_runs; ++r) {
+    run_params runparams = run_param_list.get_params(r);
+
+    mac_logger.info("\n### New run {} ###\n", r);
+    TESTASSERT(run_benchmark_scenario(runparams, run_results) == SRSRAN_SUCCESS);
+  }
+
+  print_latency_results(run_results);
+
+  return SRSRAN_SUCCESS;
+}
+
 int run_rate_test()
 {
   fmt::print("\n====== Scheduler Rate Test ======\n\n");
@@ -422,8 +581,13 @@ int main(int argc, char* argv[])
 
   if (argc == 1 or strcmp(argv[1], "test") == 0) {
     TESTASSERT(srsenb::run_rate_test() == SRSRAN_SUCCESS);
+    TESTASSERT(srsenb::run_latency_sweep(1000, {2}, {4}) == SRSRAN_SUCCESS);
   } else if (strcmp(argv[1], "benchmark") == 0) {
     TESTASSERT(srsenb::run_benchmark() == SRSRAN_SUCCESS);
+  } else if (strcmp(argv[1], "latency") == 0) {
+    TESTASSERT(srsenb::run_latency_sweep(100000, {1, 2, 3, 4}, {1, 8, 32}) == SRSRAN_SUCCESS);
+  } else if (strcmp(argv[1], "idle") == 0) {
+    TESTASSERT(srsenb::run_idle_ues_sweep(100000, {8, 32, SRSENB_MAX_UES}, 4) == SRSRAN_SUCCESS);
   } else {
     TESTASSERT(srsenb::run_all() == SRSRAN_SUCCESS);
   }
@@ -0,0 +1,173 @@
+/**
+ * Copyright 2013-2021 Software Radio Systems Limited
+ *
+ * This file is part of srsRAN.
+ *
+ * srsRAN is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsRAN is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+#include "sched_test_common.h"
+#include "srsenb/hdr/stack/mac/sched_grid.h"
+#include "srsran/common/test_common.h"
+#include <chrono>
+#include <random>
+
+namespace srsenb {
+
+struct run_params {
+  uint32_t nof_prb;
+  uint32_t nof_dcis; ///< DCIs requested per TTI
+  uint32_t max_search_nodes;
+  uint32_t nof_ttis;
+};
+
+struct run_data {
+  run_params                   params;
+  float                        success_rate;
+  float                        avg_nof_nodes;
+  std::chrono::duration<float> avg_tti_time;
+  std::chrono::duration<float> max_tti_time;
+};
+
+/**
+ * Requests params.nof_dcis PDCCH allocations per TTI for a mix of DL/UL data grants of UEs with random aggregation
+ * levels, as the scheduler would for a loaded cell, and measures the fraction of DCIs allocated and the time spent in
+ * the allocator.
+ */
+int run_pdcch_scenario(const run_params& params, std::vector<run_data>& run_results)
+{
+  const uint32_t nof_ues = 32;
+
+  std::vector<sched_cell_params_t> cell_params(1);
+  sched_interface::cell_cfg_t      cell_cfg = generate_default_cell_cfg(params.nof_prb);
+  sched_interface::sched_args_t    sched_args{};
+  sched_args.max_pdcch_search_nodes = params.max_search_nodes;
+  TESTASSERT(cell_params[0].set_cfg(0, cell_cfg, sched_args));
+
+  std::vector<std::unique_ptr<sched_ue> > ues;
+  for (uint32_t i = 0; i < nof_ues; ++i) {
+    sched_interface::ue_cfg_t ue_cfg = generate_default_ue_cfg();
+    ues.emplace_back(new sched_ue(0x46 + i, cell_params, ue_cfg));
+  }
+
+  sf_cch_allocator pdcch;
+  pdcch.init(cell_params[0]);
+
+  std::minstd_rand                     rand_gen(params.nof_dcis);
+  std::discrete_distribution<uint32_t> aggr_dist{4, 3, 2, 1};
+  uint64_t                             nof_allocs = 0, nof_nodes = 0;
+  std::chrono::nanoseconds             tot_time{0}, max_time{0};
+  sf_cch_allocator::alloc_result_t     dci_result;
+  pdcch_mask_t                         pdcch_mask;
+  std::vector<sched_ue*>               users(params.nof_dcis);
+  std::vector<bool>                    is_dl(params.nof_dcis);
+  std::vector<uint32_t>                aggr_idxs(params.nof_dcis);
+
+  for (uint32_t t = 0; t < params.nof_ttis; ++t) {
+    tti_point tti_rx{t % 10240};
+    for (uint32_t i = 0; i < params.nof_dcis; ++i) {
+      users[i]     = ues[rand_gen() % nof_ues].get();
+      is_dl[i]     = rand_gen() % 2 == 0;
+      aggr_idxs[i] = aggr_dist(rand_gen);
+    }
+
+    auto tp_start = std::chrono::steady_clock::now();
+    pdcch.new_tti(tti_rx);
+    for (uint32_t i = 0; i < params.nof_dcis; ++i) {
+      alloc_type_t alloc_type = is_dl[i] ? alloc_type_t::DL_DATA : alloc_type_t::UL_DATA;
+      nof_allocs += pdcch.alloc_dci(alloc_type, aggr_idxs[i], users[i], false) ? 1 : 0;
+    }
+    auto dur = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - tp_start);
+    tot_time += dur;
+    max_time = std::max(max_time, dur);
+    nof_nodes += pdcch.nof_search_nodes();
+
+    // TEST: The allocated DCIs do not overlap
+    pdcch.get_allocs(&dci_result, &pdcch_mask);
+    uint32_t nof_cces = 0;
+    for (const auto* node : dci_result) {
+      nof_cces += node->current_mask.count();
+    }
+    TESTASSERT(nof_cces == pdcch_mask.count());
+  }
+
+  run_data r;
+  r.params        = params;
+  r.success_rate  = nof_allocs / (float)(params.nof_ttis * params.nof_dcis);
+  r.avg_nof_nodes = nof_nodes / (float)params.nof_ttis;
+  r.avg_tti_time  = tot_time / params.nof_ttis;
+  r.max_tti_time  = max_time;
+  run_results.push_back(r);
+  return SRSRAN_SUCCESS;
+}
+
+void print_benchmark_results(const std::vector<run_data>& run_results)
+{
+  fmt::print("run | Nprb | Ndci | max nodes | allocated [%] | nodes/TTI | time avg/max [usec]\n");
+  fmt::print("-------------------------------------------------------------------------------\n");
+  for (uint32_t i = 0; i < run_results.size(); ++i) {
+    const run_data& r = run_results[i];
+    fmt::print("{:>3d}{:>7d}{:>7d}{:>12d}{:>16.1f}{:>12.1f}{:>15.1f}/{:>6.1f}\n",
+               i,
+               r.params.nof_prb,
+               r.params.nof_dcis,
+               r.params.max_search_nodes,
+               r.success_rate * 100,
+               r.avg_nof_nodes,
+               r.avg_tti_time.count() * 1e6,
+               r.max_tti_time.count() * 1e6);
+  }
+}
+
+int run_benchmark(const std::vector<uint32_t>& nof_dcis_list,
+                  const std::vector<uint32_t>& max_nodes_list,
+                  uint32_t                     nof_ttis)
+{
+  std::vector<run_data> run_results;
+  for (uint32_t nof_prb : {50, 100}) {
+    for (uint32_t max_nodes : max_nodes_list) {
+      for (uint32_t nof_dcis : nof_dcis_list) {
+        run_params params = {nof_prb, nof_dcis, max_nodes, nof_ttis};
+        TESTASSERT(run_pdcch_scenario(params, run_results) == SRSRAN_SUCCESS);
+      }
+    }
+  }
+
+  print_benchmark_results(run_results);
+
+  return SRSRAN_SUCCESS;
+}
+
+} // namespace srsenb
+
+int main(int argc, char* argv[])
+{
+  auto& mac_log = srslog::fetch_basic_logger("MAC");
+  mac_log.set_level(srslog::basic_levels::none);
+  auto& test_log = srslog::fetch_basic_logger("TEST");
+  test_log.set_level(srslog::basic_levels::warning);
+
+  // Start the log backend.
+  srslog::init();
+
+  if (argc == 1 or strcmp(argv[1], "test") == 0) {
+    TESTASSERT(srsenb::run_benchmark({10, 30}, {2000}, 100) == SRSRAN_SUCCESS);
+  } else {
+    TESTASSERT(srsenb::run_benchmark({10, 15, 20, 25, 30}, {500, 2000, 10000}, 10000) == SRSRAN_SUCCESS);
+  }
+
+  return 0;
+}
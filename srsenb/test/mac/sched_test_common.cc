@@ -207,6 +207,12 @@ int common_sched_tester::process_results()
 
 int common_sched_tester::process_tti_events(const tti_ev& tti_ev)
 {
+  {
+    // The UE state is read directly below. Apply the UE feedback that may still be queued in parallel mode
+    std::lock_guard<std::mutex> lock(sched_mutex);
+    flush_cc_feedback();
+  }
+
   for (const tti_ev::user_cfg_ev& ue_ev : tti_ev.user_updates) {
     // There is a new configuration
     if (ue_ev.ue_sim_cfg != nullptr) {
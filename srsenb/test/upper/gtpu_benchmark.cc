@@ -0,0 +1,287 @@
+/**
+ * Copyright 2013-2021 Software Radio Systems Limited
+ *
+ * This file is part of srsRAN.
+ *
+ * srsRAN is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsRAN is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+/**
+ * Loopback throughput benchmark of the eNB GTP-U data path, with and without batched socket I/O.
+ * For every io_batch_size, the UL direction (PDCP -> GTP-U -> socket) and DL direction (socket -> GTP-U -> PDCP) are
+ * measured separately. Only the CPU time of the thread running the GTP-U layer is accounted.
+ *
+ * Usage: gtpu_benchmark [nof_pdus] [pdu_size]
+ */
+
+#include "srsenb/hdr/stack/upper/gtpu.h"
+#include "srsenb/test/common/dummy_classes_common.h"
+#include "srsran/common/network_utils.h"
+#include "srsran/common/test_common.h"
+#include "srsran/upper/gtpu.h"
+#include <atomic>
+#include <chrono>
+#include <linux/ip.h>
+#include <poll.h>
+#include <sys/resource.h>
+#include <thread>
+
+namespace srsenb {
+
+const int       GTPU_PORT      = 2152;
+const uint16_t  rnti           = 0x46;
+const uint32_t  drb1_bearer_id = 5;
+const uint32_t  pdus_per_tti   = 32;
+const char*     sgw_addr_str   = "127.0.0.1";
+const char*     enb_addr_str   = "127.0.1.1";
+static uint32_t nof_pdus       = 100000;
+static uint32_t pdu_size       = 1400;
+
+class pdcp_counter : public pdcp_dummy
+{
+public:
+  void write_sdu(uint16_t rnti, uint32_t eps_bearer_id, srsran::unique_byte_buffer_t sdu, int pdcp_sn) override
+  {
+    nof_sdus++;
+  }
+  uint32_t nof_sdus = 0;
+};
+
+struct dummy_socket_manager : public srsran::socket_manager_itf {
+  dummy_socket_manager() : srsran::socket_manager_itf(srslog::fetch_basic_logger("TEST")) {}
+
+  bool add_socket_handler(int fd, recv_callback_t handler) final
+  {
+    s1u_fd   = fd;
+    callback = std::move(handler);
+    return true;
+  }
+  bool remove_socket(int fd) final { return true; }
+
+  int             s1u_fd = -1;
+  recv_callback_t callback;
+};
+
+struct run_result {
+  uint32_t nof_pdus;
+  double   wall_sec;
+  double   cpu_sec;
+};
+
+static double thread_cpu_sec()
+{
+  struct rusage usage = {};
+  getrusage(RUSAGE_THREAD, &usage);
+  return usage.ru_utime.tv_sec + usage.ru_stime.tv_sec + (usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) * 1e-6;
+}
+
+static srsran::unique_byte_buffer_t make_ip_pdu()
+{
+  srsran::unique_byte_buffer_t pdu = srsran::make_byte_buffer();
+  if (pdu == nullptr) {
+    return nullptr;
+  }
+  struct iphdr* ip_pkt = (struct iphdr*)pdu->msg;
+  memset(pdu->msg, 0xab, pdu_size);
+  ip_pkt->version = 4;
+  ip_pkt->tot_len = htons(pdu_size);
+  pdu->N_bytes    = pdu_size;
+  return pdu;
+}
+
+static int open_udp_socket(const char* addr_str, int port)
+{
+  int fd = socket(AF_INET, SOCK_DGRAM, 0);
+  if (fd < 0) {
+    return -1;
+  }
+  int rcvbuf = 8 * 1024 * 1024;
+  setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &rcvbuf, sizeof(rcvbuf));
+  struct timeval tv = {0, 100000};
+  setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+  struct sockaddr_in bindaddr = {};
+  if (not srsran::net_utils::bind_addr(fd, addr_str, port, &bindaddr)) {
+    close(fd);
+    return -1;
+  }
+  return fd;
+}
+
+/// PDCP SDUs are written to GTP-U and sent to a SGW socket drained by a separate thread
+int run_ul(uint32_t io_batch_size, run_result& res)
+{
+  int sgw_fd = open_udp_socket(sgw_addr_str, GTPU_PORT);
+  TESTASSERT(sgw_fd >= 0);
+
+  srsran::task_scheduler task_sched;
+  dummy_socket_manager   rx_sockets;
+  pdcp_counter           pdcp;
+  srsenb::gtpu           enb_gtpu(&task_sched, srslog::fetch_basic_logger("GTPU"), &rx_sockets);
+  gtpu_args_t            gtpu_args;
+  gtpu_args.gtp_bind_addr = enb_addr_str;
+  gtpu_args.mme_addr      = sgw_addr_str;
+  gtpu_args.io_batch_size = io_batch_size;
+  TESTASSERT(enb_gtpu.init(gtpu_args, &pdcp) == SRSRAN_SUCCESS);
+  struct sockaddr_in sgw_sockaddr = {};
+  srsran::net_utils::set_sockaddr(&sgw_sockaddr, sgw_addr_str, GTPU_PORT);
+  uint32_t addr_in;
+  TESTASSERT(enb_gtpu.add_bearer(rnti, drb1_bearer_id, ntohl(sgw_sockaddr.sin_addr.s_addr), 1, addr_in).has_value());
+
+  std::atomic<bool> running{true};
+  uint32_t          nof_rx = 0;
+  std::thread       sgw_thread([&]() {
+    std::vector<uint8_t> buf(SRSRAN_MAX_BUFFER_SIZE_BYTES);
+    while (running or recv(sgw_fd, buf.data(), buf.size(), MSG_PEEK | MSG_DONTWAIT) > 0) {
+      if (recv(sgw_fd, buf.data(), buf.size(), 0) > 0) {
+        nof_rx++;
+      }
+    }
+  });
+
+  auto   tp  = std::chrono::steady_clock::now();
+  double cpu = thread_cpu_sec();
+  for (uint32_t i = 0; i < nof_pdus; ++i) {
+    srsran::unique_byte_buffer_t pdu = make_ip_pdu();
+    TESTASSERT(pdu != nullptr);
+    enb_gtpu.write_pdu(rnti, drb1_bearer_id, std::move(pdu));
+    if (i % pdus_per_tti == pdus_per_tti - 1) {
+      enb_gtpu.tti_clock();
+    }
+  }
+  enb_gtpu.tti_clock();
+  res.cpu_sec  = thread_cpu_sec() - cpu;
+  res.wall_sec = std::chrono::duration<double>(std::chrono::steady_clock::now() - tp).count();
+
+  running = false;
+  sgw_thread.join();
+  res.nof_pdus = nof_rx;
+  enb_gtpu.stop();
+  close(sgw_fd);
+  return SRSRAN_SUCCESS;
+}
+
+/// A SGW thread blasts GTP-U PDUs to the eNB socket, which are read and delivered to PDCP by the GTP-U layer
+int run_dl(uint32_t io_batch_size, run_result& res)
+{
+  srsran::task_scheduler task_sched;
+  dummy_socket_manager   rx_sockets;
+  pdcp_counter           pdcp;
+  srsenb::gtpu           enb_gtpu(&task_sched, srslog::fetch_basic_logger("GTPU"), &rx_sockets);
+  gtpu_args_t            gtpu_args;
+  gtpu_args.gtp_bind_addr = enb_addr_str;
+  gtpu_args.mme_addr      = sgw_addr_str;
+  gtpu_args.io_batch_size = io_batch_size;
+  TESTASSERT(enb_gtpu.init(gtpu_args, &pdcp) == SRSRAN_SUCCESS);
+  int rcvbuf = 8 * 1024 * 1024;
+  setsockopt(rx_sockets.s1u_fd, SOL_SOCKET, SO_RCVBUF, &rcvbuf, sizeof(rcvbuf));
+  struct sockaddr_in sgw_sockaddr = {}, enb_sockaddr = {};
+  srsran::net_utils::set_sockaddr(&sgw_sockaddr, sgw_addr_str, GTPU_PORT);
+  srsran::net_utils::set_sockaddr(&enb_sockaddr, enb_addr_str, GTPU_PORT);
+  uint32_t addr_in;
+  uint32_t teid_in =
+      enb_gtpu.add_bearer(rnti, drb1_bearer_id, ntohl(sgw_sockaddr.sin_addr.s_addr), 1, addr_in).value();
+
+  srsran::unique_byte_buffer_t pdu = make_ip_pdu();
+  srsran::gtpu_header_t        header = {};
+  header.flags                        = GTPU_FLAGS_VERSION_V1 | GTPU_FLAGS_GTP_PROTOCOL;
+  header.message_type                 = GTPU_MSG_DATA_PDU;
+  header.length                       = pdu->N_bytes;
+  header.teid                         = teid_in;
+  TESTASSERT(gtpu_write_header(&header, pdu.get(), srslog::fetch_basic_logger("GTPU")));
+
+  std::atomic<bool> running{true};
+  std::thread       sgw_thread([&]() {
+    int fd = socket(AF_INET, SOCK_DGRAM, 0);
+    for (uint32_t i = 0; i < nof_pdus; ++i) {
+      sendto(fd, pdu->msg, pdu->N_bytes, 0, (struct sockaddr*)&enb_sockaddr, sizeof(enb_sockaddr));
+    }
+    close(fd);
+    running = false;
+  });
+
+  auto          tp  = std::chrono::steady_clock::now();
+  double        cpu = thread_cpu_sec();
+  struct pollfd pfd = {rx_sockets.s1u_fd, POLLIN, 0};
+  while (pdcp.nof_sdus < nof_pdus) {
+    int ret = poll(&pfd, 1, 10);
+    if (ret > 0) {
+      rx_sockets.callback(rx_sockets.s1u_fd);
+      task_sched.run_pending_tasks();
+    } else if (not running) {
+      // The remaining PDUs were dropped by the socket
+      break;
+    }
+  }
+  res.cpu_sec  = thread_cpu_sec() - cpu;
+  res.wall_sec = std::chrono::duration<double>(std::chrono::steady_clock::now() - tp).count();
+  res.nof_pdus = pdcp.nof_sdus;
+
+  sgw_thread.join();
+  enb_gtpu.stop();
+  return SRSRAN_SUCCESS;
+}
+
+void print_result(const char* dir, uint32_t io_batch_size, const run_result& res)
+{
+  double gbit = res.nof_pdus * pdu_size * 8 / 1e9;
+  fmt::print("{:>4}{:>8d}{:>10d}{:>10.1f}{:>12.1f}{:>11.2f}{:>14.1f}\n",
+             dir,
+             io_batch_size,
+             res.nof_pdus,
+             100.0 * (nof_pdus - res.nof_pdus) / nof_pdus,
+             res.nof_pdus / res.wall_sec / 1e3,
+             gbit / res.wall_sec,
+             gbit > 0 ? 100.0 * res.cpu_sec / gbit : 0.0);
+}
+
+int run_benchmark()
+{
+  fmt::print("Nof PDUs={}, PDU size={} bytes, PDUs per TTI={}\n\n", nof_pdus, pdu_size, pdus_per_tti);
+  fmt::print("{:>4}{:>8}{:>10}{:>10}{:>12}{:>11}{:>14}\n", "dir", "batch", "Nof PDUs", "loss[%]", "rate[kpps]", "rate[Gbps]",
+             "CPU[%/Gbps]");
+  fmt::print("---------------------------------------------------------------------\n");
+  for (uint32_t io_batch_size : {0, 8, 32, 64}) {
+    run_result res = {};
+    TESTASSERT(run_ul(io_batch_size, res) == SRSRAN_SUCCESS);
+    print_result("UL", io_batch_size, res);
+    TESTASSERT(run_dl(io_batch_size, res) == SRSRAN_SUCCESS);
+    print_result("DL", io_batch_size, res);
+  }
+  return SRSRAN_SUCCESS;
+}
+
+} // namespace srsenb
+
+int main(int argc, char** argv)
+{
+  srslog::fetch_basic_logger("GTPU", false).set_level(srslog::basic_levels::warning);
+  srslog::fetch_basic_logger("TEST", false).set_level(srslog::basic_levels::warning);
+  srslog::fetch_basic_logger("COMN", false).set_level(srslog::basic_levels::warning);
+  srslog::init();
+
+  if (argc > 1) {
+    srsenb::nof_pdus = std::strtoul(argv[1], nullptr, 10);
+  }
+  if (argc > 2) {
+    srsenb::pdu_size = std::min(std::strtoul(argv[2], nullptr, 10), (unsigned long)SRSRAN_MAX_BUFFER_SIZE_BYTES / 2);
+  }
+  TESTASSERT(srsenb::nof_pdus > 0 and srsenb::pdu_size >= sizeof(struct iphdr));
+
+  TESTASSERT(srsenb::run_benchmark() == SRSRAN_SUCCESS);
+
+  srslog::flush();
+  return 0;
+}
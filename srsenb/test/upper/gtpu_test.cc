@@ -42,6 +42,7 @@ public:
   {
     last_sdu           = std::move(sdu);
     last_pdcp_sn       = pdcp_sn;
+    nof_sdus++;
     last_rnti          = rnti;
     last_eps_bearer_id = eps_bearer_id;
   }
@@ -67,6 +68,7 @@ public:
   int                                              last_pdcp_sn       = -1;
   uint16_t                                         last_rnti          = SRSRAN_INVALID_RNTI;
   uint32_t                                         last_eps_bearer_id = 0;
+  uint32_t                                         nof_sdus           = 0;
 };
 
 struct dummy_socket_manager : public srsran::socket_manager_itf {
@@ -217,12 +219,12 @@ void test_gtpu_tunnel_manager()
 
 enum class tunnel_test_event { success, wait_end_marker_timeout, ue_removal_no_marker, reest_senb };
 
-int test_gtpu_direct_tunneling(tunnel_test_event event)
+int test_gtpu_direct_tunneling(tunnel_test_event event, uint32_t io_batch_size)
 {
   std::random_device    rd;
   std::mt19937          g(rd());
   srslog::basic_logger& logger = srslog::fetch_basic_logger("TEST");
-  logger.info("\n\n**** Test GTPU Direct Tunneling ****\n");
+  logger.info("\n\n**** Test GTPU Direct Tunneling (io_batch_size=%d) ****\n", io_batch_size);
   uint16_t           rnti = 0x46, rnti2 = 0x50;
   uint32_t           drb1_bearer_id = 5;
   uint32_t           sgw_teidout1 = 1, sgw_teidout2 = 2;
@@ -250,11 +252,17 @@ int test_gtpu_direct_tunneling(tunnel_test_event event)
   gtpu_args.gtp_bind_addr                = senb_addr_str;
   gtpu_args.mme_addr                     = sgw_addr_str;
   gtpu_args.indirect_tunnel_timeout_msec = std::uniform_int_distribution<uint32_t>{500, 2000}(g);
+  gtpu_args.io_batch_size                = io_batch_size;
   senb_gtpu.init(gtpu_args, &senb_pdcp);
   gtpu_args.gtp_bind_addr = tenb_addr_str;
   tenb_gtpu.init(gtpu_args, &tenb_pdcp);
   uint32_t addr_in1;
   uint32_t addr_in2;
+  // In batched mode, the PDUs forwarded by the SeNB only reach the socket at the TTI boundary
+  auto read_fwd_pdu = [&senb_gtpu, &tenb_rx_sockets]() {
+    senb_gtpu.tti_clock();
+    return read_socket(tenb_rx_sockets.s1u_fd);
+  };
   // create tunnels MME-SeNB and MME-TeNB
   uint32_t senb_teid_in = senb_gtpu.add_bearer(rnti, drb1_bearer_id, sgw_addr, sgw_teidout1, addr_in1).value();
   uint32_t tenb_teid_in = tenb_gtpu.add_bearer(rnti2, drb1_bearer_id, sgw_addr, sgw_teidout2, addr_in2).value();
@@ -284,9 +292,9 @@ int test_gtpu_direct_tunneling(tunnel_test_event event)
   srsran::span<uint8_t> pdu_view{};
 
   // TEST: GTPU buffers incoming PDCP buffered SNs until the TEID is explicitly activated
-  tenb_gtpu.handle_gtpu_s1u_rx_packet(read_socket(tenb_rx_sockets.s1u_fd), senb_sockaddr);
+  tenb_gtpu.handle_gtpu_s1u_rx_packet(read_fwd_pdu(), senb_sockaddr);
   TESTASSERT(tenb_pdcp.last_sdu == nullptr);
-  tenb_gtpu.handle_gtpu_s1u_rx_packet(read_socket(tenb_rx_sockets.s1u_fd), senb_sockaddr);
+  tenb_gtpu.handle_gtpu_s1u_rx_packet(read_fwd_pdu(), senb_sockaddr);
   TESTASSERT(tenb_pdcp.last_sdu == nullptr);
   tenb_gtpu.set_tunnel_status(dl_tenb_teid_in, true);
   pdu_view = srsran::make_span(tenb_pdcp.last_sdu);
@@ -297,7 +305,7 @@ int test_gtpu_direct_tunneling(tunnel_test_event event)
 
   // TEST: verify that PDCP buffered SNs have been forwarded through SeNB->TeNB tunnel
   for (size_t sn = 8; sn < 10; ++sn) {
-    tenb_gtpu.handle_gtpu_s1u_rx_packet(read_socket(tenb_rx_sockets.s1u_fd), senb_sockaddr);
+    tenb_gtpu.handle_gtpu_s1u_rx_packet(read_fwd_pdu(), senb_sockaddr);
     pdu_view = srsran::make_span(tenb_pdcp.last_sdu);
     TESTASSERT(std::count(pdu_view.begin() + PDU_HEADER_SIZE, pdu_view.end(), sn) == 10);
     TESTASSERT(tenb_pdcp.last_rnti == rnti2);
@@ -310,7 +318,7 @@ int test_gtpu_direct_tunneling(tunnel_test_event event)
   pdu = encode_gtpu_packet(data_vec, senb_teid_in, sgw_sockaddr, senb_sockaddr);
   encoded_data.assign(pdu->msg + 8u, pdu->msg + pdu->N_bytes);
   senb_gtpu.handle_gtpu_s1u_rx_packet(std::move(pdu), sgw_sockaddr);
-  tenb_gtpu.handle_gtpu_s1u_rx_packet(read_socket(tenb_rx_sockets.s1u_fd), senb_sockaddr);
+  tenb_gtpu.handle_gtpu_s1u_rx_packet(read_fwd_pdu(), senb_sockaddr);
   pdu_view = srsran::make_span(tenb_pdcp.last_sdu);
   TESTASSERT(pdu_view.size() == encoded_data.size() and
              std::equal(pdu_view.begin(), pdu_view.end(), encoded_data.begin()));
@@ -332,7 +340,7 @@ int test_gtpu_direct_tunneling(tunnel_test_event event)
   pdu = encode_gtpu_packet(data_vec, senb_teid_in, sgw_sockaddr, senb_sockaddr);
   encoded_data.assign(pdu->msg + 8u, pdu->msg + pdu->N_bytes);
   senb_gtpu.handle_gtpu_s1u_rx_packet(std::move(pdu), sgw_sockaddr);
-  tenb_gtpu.handle_gtpu_s1u_rx_packet(read_socket(tenb_rx_sockets.s1u_fd), senb_sockaddr);
+  tenb_gtpu.handle_gtpu_s1u_rx_packet(read_fwd_pdu(), senb_sockaddr);
   TESTASSERT(tenb_pdcp.last_sdu->N_bytes == encoded_data.size() and
              memcmp(tenb_pdcp.last_sdu->msg, encoded_data.data(), encoded_data.size()) == 0);
   tenb_pdcp.clear();
@@ -347,7 +355,7 @@ int test_gtpu_direct_tunneling(tunnel_test_event event)
     // TEST: EndMarker may even reach SeNB, but the SeNB receives in tandem the UEContextReleaseCommand and closes
     //       the user tunnels before the chance to send an EndMarker
     senb_gtpu.rem_user(0x46);
-    tenb_gtpu.handle_gtpu_s1u_rx_packet(read_socket(tenb_rx_sockets.s1u_fd), senb_sockaddr);
+    tenb_gtpu.handle_gtpu_s1u_rx_packet(read_fwd_pdu(), senb_sockaddr);
   } else if (event == tunnel_test_event::reest_senb) {
     // TEST: UE may start a Reestablishment to the SeNB. In such case, the rnti will be updated, the forwarding tunnel
     //       taken down, and the previous main tunnel reestablished
@@ -366,7 +374,7 @@ int test_gtpu_direct_tunneling(tunnel_test_event event)
     // TEST: EndMarker is forwarded via MME->SeNB->TeNB, and TeNB buffered PDUs are flushed
     pdu = encode_end_marker(senb_teid_in);
     senb_gtpu.handle_gtpu_s1u_rx_packet(std::move(pdu), sgw_sockaddr);
-    tenb_gtpu.handle_gtpu_s1u_rx_packet(read_socket(tenb_rx_sockets.s1u_fd), senb_sockaddr);
+    tenb_gtpu.handle_gtpu_s1u_rx_packet(read_fwd_pdu(), senb_sockaddr);
   }
   srsran::span<uint8_t> encoded_data2{tenb_pdcp.last_sdu->msg + 20u, tenb_pdcp.last_sdu->msg + 30u};
   TESTASSERT(std::all_of(encoded_data2.begin(), encoded_data2.end(), [N_pdus](uint8_t b) { return b == N_pdus - 1; }));
@@ -381,6 +389,91 @@ int test_gtpu_direct_tunneling(tunnel_test_event event)
   return SRSRAN_SUCCESS;
 }
 
+int test_gtpu_batched_io()
+{
+  srslog::basic_logger& logger = srslog::fetch_basic_logger("TEST");
+  logger.info("\n\n**** Test GTPU batched I/O ****\n");
+  const uint32_t     batch_size = 8, nof_pdus = 20;
+  uint16_t           rnti           = 0x46;
+  uint32_t           drb1_bearer_id = 5;
+  const char *       sgw_addr_str = "127.0.0.1", *enb_addr_str = "127.0.1.1";
+  struct sockaddr_in enb_sockaddr = {}, sgw_sockaddr = {};
+  srsran::net_utils::set_sockaddr(&enb_sockaddr, enb_addr_str, GTPU_PORT);
+  srsran::net_utils::set_sockaddr(&sgw_sockaddr, sgw_addr_str, GTPU_PORT);
+
+  // The SGW side is a plain UDP socket
+  int sgw_fd = socket(AF_INET, SOCK_DGRAM, 0);
+  TESTASSERT(sgw_fd >= 0);
+  struct sockaddr_in bindaddr = {};
+  TESTASSERT(srsran::net_utils::bind_addr(sgw_fd, sgw_addr_str, GTPU_PORT, &bindaddr));
+
+  srsran::task_scheduler task_sched;
+  dummy_socket_manager   rx_sockets;
+  srsenb::gtpu           enb_gtpu(&task_sched, srslog::fetch_basic_logger("GTPU1"), &rx_sockets);
+  pdcp_tester            pdcp;
+  gtpu_args_t            gtpu_args;
+  gtpu_args.gtp_bind_addr = enb_addr_str;
+  gtpu_args.mme_addr      = sgw_addr_str;
+  gtpu_args.io_batch_size = batch_size;
+  TESTASSERT(enb_gtpu.init(gtpu_args, &pdcp) == SRSRAN_SUCCESS);
+  uint32_t addr_in;
+  uint32_t teid_in =
+      enb_gtpu.add_bearer(rnti, drb1_bearer_id, ntohl(sgw_sockaddr.sin_addr.s_addr), 1, addr_in).value();
+
+  // TEST: DL PDUs queued in the socket are read by a single recvmmsg call, and handled in order
+  std::vector<uint8_t> data(10);
+  for (uint32_t i = 0; i < nof_pdus; ++i) {
+    std::fill(data.begin(), data.end(), i);
+    srsran::unique_byte_buffer_t pdu = encode_gtpu_packet(data, teid_in, sgw_sockaddr, enb_sockaddr);
+    TESTASSERT(sendto(sgw_fd, pdu->msg, pdu->N_bytes, 0, (struct sockaddr*)&enb_sockaddr, sizeof(enb_sockaddr)) ==
+               (ssize_t)pdu->N_bytes);
+  }
+  uint32_t nof_reads = 0;
+  while (pdcp.nof_sdus < nof_pdus) {
+    rx_sockets.callback(rx_sockets.s1u_fd);
+    task_sched.run_pending_tasks();
+    nof_reads++;
+    TESTASSERT(pdcp.nof_sdus == std::min(nof_reads * batch_size, nof_pdus));
+    TESTASSERT(pdcp.last_sdu->msg[PDU_HEADER_SIZE] == pdcp.nof_sdus - 1);
+  }
+  TESTASSERT(nof_reads == (nof_pdus + batch_size - 1) / batch_size);
+
+  // TEST: UL PDUs are held until the TTI boundary or until the batch is full, and leave in order
+  uint8_t buf[128];
+  for (uint32_t i = 0; i < batch_size - 1; ++i) {
+    std::fill(data.begin(), data.end(), i);
+    enb_gtpu.write_pdu(rnti, drb1_bearer_id, encode_ipv4_packet(data, teid_in, enb_sockaddr, sgw_sockaddr));
+  }
+  TESTASSERT(recv(sgw_fd, buf, sizeof(buf), MSG_DONTWAIT) < 0 and errno == EAGAIN);
+  enb_gtpu.tti_clock();
+  for (uint32_t i = 0; i < batch_size - 1; ++i) {
+    TESTASSERT(recv(sgw_fd, buf, sizeof(buf), MSG_DONTWAIT) == 8 + PDU_HEADER_SIZE + 10);
+    TESTASSERT(buf[8 + PDU_HEADER_SIZE] == i);
+  }
+  for (uint32_t i = 0; i < batch_size; ++i) {
+    enb_gtpu.write_pdu(rnti, drb1_bearer_id, encode_ipv4_packet(data, teid_in, enb_sockaddr, sgw_sockaddr));
+  }
+  for (uint32_t i = 0; i < batch_size; ++i) {
+    TESTASSERT(recv(sgw_fd, buf, sizeof(buf), MSG_DONTWAIT) > 0);
+  }
+
+  // TEST: The End Marker is transmitted right away, after the PDUs pending in the forwarding tunnel
+  gtpu::bearer_props props;
+  props.forward_from_teidin_present = true;
+  props.forward_from_teidin         = teid_in;
+  enb_gtpu.add_bearer(rnti, drb1_bearer_id, ntohl(sgw_sockaddr.sin_addr.s_addr), 2, addr_in, &props);
+  enb_gtpu.handle_gtpu_s1u_rx_packet(encode_gtpu_packet(data, teid_in, sgw_sockaddr, enb_sockaddr), sgw_sockaddr);
+  TESTASSERT(recv(sgw_fd, buf, sizeof(buf), MSG_DONTWAIT) < 0 and errno == EAGAIN);
+  enb_gtpu.rem_user(rnti);
+  TESTASSERT(recv(sgw_fd, buf, sizeof(buf), MSG_DONTWAIT) == 8 + PDU_HEADER_SIZE + 10);
+  TESTASSERT(buf[1] == GTPU_MSG_DATA_PDU);
+  TESTASSERT(recv(sgw_fd, buf, sizeof(buf), MSG_DONTWAIT) == 8);
+  TESTASSERT(buf[1] == GTPU_MSG_END_MARKER);
+
+  close(sgw_fd);
+  return SRSRAN_SUCCESS;
+}
+
 } // namespace srsenb
 
 int main(int argc, char** argv)
@@ -394,10 +487,17 @@ int main(int argc, char** argv)
   srsran::test_init(argc, argv);
 
   srsenb::test_gtpu_tunnel_manager();
-  TESTASSERT(srsenb::test_gtpu_direct_tunneling(srsenb::tunnel_test_event::success) == SRSRAN_SUCCESS);
-  TESTASSERT(srsenb::test_gtpu_direct_tunneling(srsenb::tunnel_test_event::wait_end_marker_timeout) == SRSRAN_SUCCESS);
-  TESTASSERT(srsenb::test_gtpu_direct_tunneling(srsenb::tunnel_test_event::ue_removal_no_marker) == SRSRAN_SUCCESS);
-  TESTASSERT(srsenb::test_gtpu_direct_tunneling(srsenb::tunnel_test_event::reest_senb) == SRSRAN_SUCCESS);
+  for (uint32_t io_batch_size : {0, 16}) {
+    TESTASSERT(srsenb::test_gtpu_direct_tunneling(srsenb::tunnel_test_event::success, io_batch_size) ==
+               SRSRAN_SUCCESS);
+    TESTASSERT(srsenb::test_gtpu_direct_tunneling(srsenb::tunnel_test_event::wait_end_marker_timeout, io_batch_size) ==
+               SRSRAN_SUCCESS);
+    TESTASSERT(srsenb::test_gtpu_direct_tunneling(srsenb::tunnel_test_event::ue_removal_no_marker, io_batch_size) ==
+               SRSRAN_SUCCESS);
+    TESTASSERT(srsenb::test_gtpu_direct_tunneling(srsenb::tunnel_test_event::reest_senb, io_batch_size) ==
+               SRSRAN_SUCCESS);
+  }
+  TESTASSERT(srsenb::test_gtpu_batched_io() == SRSRAN_SUCCESS);
 
   srslog::flush();
 
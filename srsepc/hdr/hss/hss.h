@@ -28,6 +28,7 @@
 #ifndef SRSEPC_HSS_H
 #define SRSEPC_HSS_H
 
+#include "srsepc/hdr/hss/hss_store.h"
 #include "srsran/common/buffer_pool.h"
 #include "srsran/common/standard_streams.h"
 #include "srsran/interfaces/epc_interfaces.h"
@@ -35,6 +36,7 @@
 #include <cstddef>
 
 #include <map>
+#include <mutex>
 
 #define LTE_FDD_ENB_IND_HE_N_BITS 5
 #define LTE_FDD_ENB_IND_HE_MASK 0x1FUL
@@ -45,6 +47,7 @@ namespace srsepc {
 
 struct hss_args_t {
   std::string db_file;
+  std::string db_store; ///< Store of the SQN of each subscriber, saved on every authentication. Empty to disable
   uint16_t    mcc;
   uint16_t    mnc;
 };
@@ -65,6 +68,8 @@ struct hss_ue_ctx_t {
   uint16_t           qci;
   uint8_t            last_rand[16];
   std::string        static_ip_addr;
+  uint32_t           store_idx;
+  std::mutex         mutex; // Serializes the authentications of the UE, requested by the NAS workers
 
   // Helper getters/setters
   void set_sqn(const uint8_t* sqn_);
@@ -112,11 +117,14 @@ private:
   bool          set_auth_algo(std::string auth_algo);
   bool          read_db_file(std::string db_file);
   bool          write_db_file(std::string db_file);
+  bool          open_store(std::string store_file);
+  void          save_ue_state(hss_ue_ctx_t* ue_ctx);
   hss_ue_ctx_t* get_ue_ctx(uint64_t imsi);
 
   std::string hex_string(uint8_t* hex, int size);
 
   std::string db_file;
+  hss_store   store;
 
   /*Logs*/
   srslog::basic_logger& m_logger = srslog::fetch_basic_logger("HSS");
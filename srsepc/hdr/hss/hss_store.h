@@ -0,0 +1,98 @@
+/**
+ * Copyright 2013-2021 Software Radio Systems Limited
+ *
+ * This file is part of srsRAN.
+ *
+ * srsRAN is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsRAN is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+/******************************************************************************
+ * File:        hss_store.h
+ * Description: Persistent store of the authentication state of the HSS
+ *              subscribers. The state of each subscriber lives in a fixed
+ *              size record of a memory mapped file, so every authentication
+ *              is saved at the cost of a copy and survives a crash of the
+ *              EPC, without rewriting the user database.
+ *****************************************************************************/
+
+#ifndef SRSEPC_HSS_STORE_H
+#define SRSEPC_HSS_STORE_H
+
+#include "srsran/srslog/srslog.h"
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+namespace srsepc {
+
+/// Record of a subscriber in the store
+struct hss_store_record_t {
+  uint64_t imsi;
+  uint8_t  sqn[6];
+  uint8_t  csv_sqn[6]; ///< SQN of the user database when the record was last synchronized with it
+  uint8_t  reserved[4];
+  uint8_t  last_rand[16];
+};
+
+class hss_store
+{
+public:
+  hss_store() = default;
+  ~hss_store();
+
+  hss_store(const hss_store& other) = delete;
+  hss_store& operator=(const hss_store& other) = delete;
+
+  /**
+   * Opens the store for the subscribers in records, which hold the state read from the user database. Subscribers
+   * found in the store get the state saved there, unless their SQN was changed in the user database since. The file
+   * is rewritten with one record per subscriber, in the order of records, dropping the subscribers no longer in the
+   * user database
+   */
+  bool open(const std::string& filename, std::vector<hss_store_record_t>& records);
+  void close();
+
+  bool is_open() const { return fd >= 0; }
+
+  /// Saves the authentication state of the subscriber with index idx
+  void update(uint32_t idx, const uint8_t* sqn, const uint8_t* last_rand);
+
+  /// Marks the store as synchronized with the user database, after it has been written
+  void set_csv_synced();
+
+private:
+  struct header_t {
+    char     magic[8];
+    uint32_t version;
+    uint32_t record_size;
+    uint64_t nof_records;
+  };
+
+  bool read_file(const std::string& filename, std::vector<hss_store_record_t>& saved);
+  bool write_file(const std::string& filename, const std::vector<hss_store_record_t>& new_records);
+
+  srslog::basic_logger& logger = srslog::fetch_basic_logger("HSS");
+
+  int                 fd          = -1;
+  void*               map         = nullptr;
+  size_t              map_size    = 0;
+  hss_store_record_t* records     = nullptr;
+  uint64_t            nof_records = 0;
+};
+
+} // namespace srsepc
+
+#endif // SRSEPC_HSS_STORE_H
@@ -30,15 +30,23 @@
 
 #include "srsran/asn1/gtpc.h"
 #include "srsran/common/buffer_pool.h"
+#include "srsran/common/network_utils.h"
 #include "srsran/common/threads.h"
 #include "srsran/srslog/srslog.h"
 #include "srsran/srsran.h"
+#include "srsran/upper/gtpu.h"
 #include <cstddef>
+#include <map>
+#include <mutex>
+#include <vector>
 
 namespace srsepc {
 
 const uint16_t GTPU_RX_PORT = 2152;
 
+// Flows beyond this are only accounted in the aggregate counters
+const uint32_t MBMS_GW_MAX_FLOWS = 64;
+
 typedef struct {
   std::string name;
   std::string sgi_mb_if_name;
@@ -47,8 +55,29 @@ typedef struct {
   std::string m1u_multi_addr;
   std::string m1u_multi_if;
   int         m1u_multi_ttl;
+  uint32_t    io_batch_size;
 } mbms_gw_args_t;
 
+// Counters of a multicast flow, identified by the destination of the SGi-mb packets
+typedef struct {
+  uint32_t dst_addr; // network byte order
+  uint16_t dst_port; // 0 for non-UDP traffic
+  uint64_t nof_packets;
+  uint64_t nof_bytes;
+} mbms_gw_flow_metrics_t;
+
+typedef struct {
+  uint32_t                            teid;        // TEID of the MBMS bearer (one TMGI for now)
+  uint64_t                            nof_packets; // packets read from SGi-mb
+  uint64_t                            nof_bytes;
+  uint64_t                            nof_dropped; // packets read from SGi-mb and not sent to M1-U
+  uint64_t                            nof_wakeups;
+  uint64_t                            nof_full_batches; // wakeups that hit io_batch_size, i.e. SGi-mb was backlogged
+  uint32_t                            max_batch_size;
+  int                                 m1u_queue_bytes; // bytes pending in the M1-U socket send queue
+  std::vector<mbms_gw_flow_metrics_t> flows;
+} mbms_gw_metrics_t;
+
 struct pseudo_hdr {
   uint32_t src_addr;
   uint32_t dst_addr;
@@ -65,6 +94,7 @@ public:
   int             init(mbms_gw_args_t* args);
   void            stop();
   void            run_thread();
+  void            get_metrics(mbms_gw_metrics_t& metrics);
 
 private:
   /* Methods */
@@ -74,7 +104,8 @@ private:
 
   int      init_sgi_mb_if(mbms_gw_args_t* args);
   int      init_m1_u(mbms_gw_args_t* args);
-  void     handle_sgi_md_pdu(srsran::byte_buffer_t* msg);
+  bool     handle_sgi_md_pdu(srsran::unique_byte_buffer_t msg);
+  void     update_flow_metrics(const srsran::byte_buffer_t* msg);
   uint16_t in_cksum(uint16_t* iphdr, int count);
 
   /* Members */
@@ -87,6 +118,16 @@ private:
   bool               m_m1u_up;
   int                m_m1u;
   struct sockaddr_in m_m1u_multi_addr;
+
+  // Batched forwarding
+  uint32_t                        m_io_batch_size = 1;
+  uint8_t                         m_gtpu_hdr_template[GTPU_BASE_HEADER_LEN];
+  srsran::net_utils::udp_tx_batch m_tx_batch{m_logger};
+
+  // Metrics, written by the MBMS-GW thread and read through get_metrics()
+  std::mutex                                 m_metrics_mutex;
+  mbms_gw_metrics_t                          m_metrics = {};
+  std::map<uint64_t, mbms_gw_flow_metrics_t> m_flows;
 };
 
 } // namespace srsepc
@@ -32,7 +32,10 @@
 #include "srsran/common/buffer_pool.h"
 #include "srsran/common/standard_streams.h"
 #include "srsran/common/threads.h"
+#include <atomic>
 #include <cstddef>
+#include <mutex>
+#include <unordered_map>
 
 namespace srsepc {
 
@@ -71,14 +74,21 @@ private:
   s1ap*       m_s1ap;
   mme_gtpc*   m_mme_gtpc;
 
-  bool   m_running;
-  fd_set m_set;
+  std::atomic<bool> m_running;
+  int               m_epoll_fd = -1;
+  int               m_stop_fd  = -1; // Event that wakes up the MME thread to stop it
 
-  // Timer map
-  std::vector<mme_timer_t> timers;
+  // Timer maps, indexed by IMSI and timer type and by timer fd. Timers are added and removed by the NAS workers
+  std::mutex                                m_timers_mutex;
+  std::unordered_map<uint64_t, mme_timer_t> m_timers;
+  std::unordered_map<int, uint64_t>         m_timer_fd_to_key;
 
   // Timer Methods
-  void handle_timer_expire(int timer_fd);
+  static uint64_t get_timer_key(enum nas_timer_type type, uint64_t imsi);
+  bool            add_epoll_fd(int fd);
+  void            close_timer(int timer_fd);
+  void            handle_timer_expire(int timer_fd);
+  void            handle_s1mme(int s1mme, srsran::byte_buffer_t* pdu);
 
   // Logs
   srslog::basic_logger& m_s1ap_logger = srslog::fetch_basic_logger("S1AP");
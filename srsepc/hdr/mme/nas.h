@@ -262,6 +262,9 @@ public:
   esm_ctx_t m_esm_ctx[MAX_ERABS_PER_UE] = {};
   sec_ctx_t m_sec_ctx                   = {};
 
+  /* NAS worker shard handling the UE, set on creation */
+  uint32_t m_shard = 0;
+
 private:
   srslog::basic_logger& m_logger = srslog::fetch_basic_logger("NAS");
   gtpc_interface_nas*   m_gtpc   = nullptr;
@@ -0,0 +1,75 @@
+/**
+ * Copyright 2013-2021 Software Radio Systems Limited
+ *
+ * This file is part of srsRAN.
+ *
+ * srsRAN is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsRAN is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+/******************************************************************************
+ * File:        nas_worker_pool.h
+ * Description: Pool of NAS worker threads of the MME. UEs are sharded
+ *              across the workers and every message of a UE is handled by
+ *              the worker owning it, so the messages of each UE are
+ *              processed in order while different UEs run in parallel.
+ *****************************************************************************/
+
+#ifndef SRSEPC_NAS_WORKER_POOL_H
+#define SRSEPC_NAS_WORKER_POOL_H
+
+#include "srsran/adt/move_callback.h"
+#include <memory>
+#include <vector>
+
+namespace srsepc {
+
+class nas_worker_pool
+{
+public:
+  using task_t = srsran::move_callback<void(), srsran::default_move_callback_buffer_size, true>;
+
+  nas_worker_pool();
+  ~nas_worker_pool();
+
+  nas_worker_pool(const nas_worker_pool& other) = delete;
+  nas_worker_pool& operator=(const nas_worker_pool& other) = delete;
+
+  /// Starts nof_workers workers. Without workers, tasks are meant to be run by the caller
+  void init(uint32_t nof_workers, uint32_t queue_size);
+  void stop();
+
+  uint32_t nof_workers() const { return m_workers.size(); }
+
+  /// Number of shards the UEs are spread over, 1 without workers
+  uint32_t nof_shards() const { return m_workers.empty() ? 1 : m_workers.size(); }
+
+  /// Queues a task in the worker of the shard. Outside the workers, this waits for room in the queue if it is full,
+  /// which holds back the MME until the workers catch up. A worker can't wait for another one, as both could be waiting
+  /// for each other, so its tasks go to the unbounded inbox of the destination worker instead, and are never lost
+  void push_task(uint32_t shard, task_t&& task);
+
+  /// Shard of the worker running the calling thread, -1 outside the workers
+  static int32_t get_current_shard();
+
+private:
+  class worker;
+
+  std::vector<std::unique_ptr<worker> > m_workers;
+};
+
+} // namespace srsepc
+
+#endif // SRSEPC_NAS_WORKER_POOL_H
@@ -23,6 +23,7 @@
 
 #include "mme_gtpc.h"
 #include "nas.h"
+#include "nas_worker_pool.h"
 #include "s1ap_ctx_mngmt_proc.h"
 #include "s1ap_erab_mngmt_proc.h"
 #include "s1ap_mngmt_proc.h"
@@ -39,12 +40,15 @@
 #include "srsran/srslog/srslog.h"
 #include <arpa/inet.h>
 #include <map>
+#include <memory>
+#include <mutex>
 #include <netinet/sctp.h>
-#include <set>
 #include <strings.h>
 #include <sys/socket.h>
 #include <sys/types.h>
 #include <unistd.h>
+#include <unordered_map>
+#include <unordered_set>
 
 namespace srsepc {
 
@@ -68,6 +72,7 @@ public:
 
   bool s1ap_tx_pdu(const s1ap_pdu_t& pdu, struct sctp_sndrcvinfo* enb_sri);
   void handle_s1ap_rx_pdu(srsran::byte_buffer_t* pdu, struct sctp_sndrcvinfo* enb_sri);
+  void handle_s1ap_rx_pdu(const s1ap_pdu_t& rx_pdu, struct sctp_sndrcvinfo* enb_sri);
   void handle_initiating_message(const asn1::s1ap::init_msg_s& msg, struct sctp_sndrcvinfo* enb_sri);
   void handle_successful_outcome(const asn1::s1ap::successful_outcome_s& msg);
 
@@ -82,6 +87,8 @@ public:
   void       add_new_enb_ctx(const enb_ctx_t& enb_ctx, const struct sctp_sndrcvinfo* enb_sri);
   void       get_enb_ctx(uint16_t sctp_stream);
 
+  std::vector<struct sctp_sndrcvinfo> get_enb_sris();
+
   bool add_nas_ctx_to_imsi_map(nas* nas_ctx);
   bool add_nas_ctx_to_mme_ue_s1ap_id_map(nas* nas_ctx);
   bool add_ue_to_enb_set(int32_t enb_assoc, uint32_t mme_ue_s1ap_id);
@@ -96,6 +103,13 @@ public:
   uint32_t         allocate_m_tmsi(uint64_t imsi);
   virtual uint64_t find_imsi_from_m_tmsi(uint32_t m_tmsi);
 
+  // NAS workers. Every UE belongs to the shard of one worker, which handles all its messages
+  uint32_t get_nof_nas_workers();
+  uint32_t get_imsi_shard(uint64_t imsi);
+  uint32_t get_mme_ue_s1ap_id_shard(uint32_t mme_ue_s1ap_id);
+  bool     is_current_shard(uint32_t shard);
+  void     push_nas_task(uint32_t shard, nas_worker_pool::task_t&& task);
+
   s1ap_args_t           m_s1ap_args;
   srslog::basic_logger& m_logger = srslog::fetch_basic_logger("S1AP");
 
@@ -105,8 +119,8 @@ public:
   s1ap_erab_mngmt_proc* m_s1ap_erab_mngmt_proc;
   s1ap_paging*          m_s1ap_paging;
 
-  std::map<uint32_t, uint64_t>   m_tmsi_to_imsi;
-  std::map<uint16_t, enb_ctx_t*> m_active_enbs;
+  std::unordered_map<uint32_t, uint64_t>   m_tmsi_to_imsi;
+  std::unordered_map<uint16_t, enb_ctx_t*> m_active_enbs;
 
   // Interfaces
   virtual bool send_initial_context_setup_request(uint64_t imsi, uint16_t erab_to_setup);
@@ -136,22 +150,36 @@ private:
 
   uint32_t m_plmn;
 
-  hss_interface_nas*                     m_hss;
-  int                                    m_s1mme;
-  std::map<int32_t, uint16_t>            m_sctp_to_enb_id;
-  std::map<int32_t, std::set<uint32_t> > m_enb_assoc_to_ue_ids;
+  struct rx_pdu_t {
+    s1ap_pdu_t             pdu;
+    struct sctp_sndrcvinfo enb_sri;
+  };
+  bool find_pdu_shard(const s1ap_pdu_t& rx_pdu, uint32_t* shard);
+  void release_ue_ecm_ctx_in_enb(uint32_t mme_ue_s1ap_id);
+  void delete_nas_ctx(nas* nas_ctx);
+
+  hss_interface_nas*                                         m_hss;
+  int                                                        m_s1mme;
+  std::unordered_map<int32_t, uint16_t>                      m_sctp_to_enb_id;
+  std::unordered_map<int32_t, std::unordered_set<uint32_t> > m_enb_assoc_to_ue_ids;
+
+  std::unordered_map<uint64_t, nas*> m_imsi_to_nas_ctx;
+  std::unordered_map<uint32_t, nas*> m_mme_ue_s1ap_id_to_nas_ctx;
 
-  std::map<uint64_t, nas*> m_imsi_to_nas_ctx;
-  std::map<uint32_t, nas*> m_mme_ue_s1ap_id_to_nas_ctx;
+  // Protects the tables above, read by the MME thread and modified by the NAS workers
+  std::mutex m_ctx_mutex;
 
-  uint32_t m_next_mme_ue_s1ap_id;
-  uint32_t m_next_m_tmsi;
+  std::vector<uint32_t> m_next_mme_ue_s1ap_id; // Per shard
+  uint32_t              m_next_m_tmsi;
+
+  nas_worker_pool m_nas_workers;
 
   // GTP-C Interface
   mme_gtpc* m_mme_gtpc;
 
   // PCAP
   bool              m_pcap_enable;
+  std::mutex        m_pcap_mutex;
   srsran::s1ap_pcap m_pcap;
 };
 
@@ -165,5 +193,10 @@ inline uint16_t s1ap::get_tac()
   return m_s1ap_args.tac;
 }
 
+inline uint32_t s1ap::get_nof_nas_workers()
+{
+  return m_nas_workers.nof_workers();
+}
+
 } // namespace srsepc
 #endif // SRSEPC_S1AP_H
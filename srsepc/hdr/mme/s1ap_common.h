@@ -52,6 +52,7 @@ typedef struct {
   srsran::CIPHERING_ALGORITHM_ID_ENUM encryption_algo;
   srsran::INTEGRITY_ALGORITHM_ID_ENUM integrity_algo;
   bool                                request_imeisv;
+  uint32_t                            nas_nof_workers; // NAS worker threads, 0 to handle NAS in the MME thread
 } s1ap_args_t;
 
 typedef struct {
@@ -39,6 +39,8 @@ public:
   void                       init();
 
   bool handle_initial_ue_message(const asn1::s1ap::init_ue_msg_s& init_ue, struct sctp_sndrcvinfo* enb_sri);
+  // IMSI of the UE sending an initial UE message, if it can be told without handling the message. 0 otherwise
+  uint64_t find_initial_ue_message_imsi(const asn1::s1ap::init_ue_msg_s& init_ue);
   bool handle_uplink_nas_transport(const asn1::s1ap::ul_nas_transport_s& ul_xport, struct sctp_sndrcvinfo* enb_sri);
   bool send_downlink_nas_transport(uint32_t               enb_ue_s1ap_id,
                                    uint32_t               mme_ue_s1ap_id,
@@ -29,7 +29,10 @@
 #include "srsran/interfaces/epc_interfaces.h"
 #include "srsran/srslog/srslog.h"
 #include <cstddef>
+#include <memory>
+#include <mutex>
 #include <queue>
+#include <vector>
 
 namespace srsepc {
 
@@ -41,14 +44,20 @@ public:
   int  init(spgw_args_t* args, spgw* spgw, gtpc_interface_gtpu* gtpc);
   void stop();
 
-  int init_sgi(spgw_args_t* args);
-  int init_s1u(spgw_args_t* args);
-  int get_sgi();
-  int get_s1u();
+  int      init_sgi(spgw_args_t* args);
+  int      init_s1u(spgw_args_t* args);
+  int      init_workers(spgw_args_t* args);
+  int      get_sgi();
+  int      get_s1u();
+  int      get_deferred_sgi();
+  uint32_t get_nof_workers();
 
   void handle_sgi_pdu(srsran::unique_byte_buffer_t msg);
+  void handle_deferred_sgi_pdus();
   void handle_s1u_pdu(srsran::byte_buffer_t* msg);
+  void handle_s1u_pdu(srsran::byte_buffer_t* msg, int sgi);
   void send_s1u_pdu(srsran::gtp_fteid_t enb_fteid, srsran::byte_buffer_t* msg);
+  bool write_s1u_header(const srsran::gtp_fteid_t& enb_fteid, srsran::byte_buffer_t* msg, struct sockaddr_in* enb_addr);
 
   virtual in_addr_t get_s1u_addr();
 
@@ -68,10 +77,33 @@ public:
   int         m_s1u;
   sockaddr_in m_s1u_addr;
 
-  std::map<in_addr_t, srsran::gtp_fteid_t> m_ip_to_usr_teid; // Map IP to User-plane TEID for downlink traffic
-  std::map<in_addr_t, uint32_t>            m_ip_to_ctr_teid; // IP to control TEID map. Important to check if
+  struct tunnel_tables_t {
+    std::map<in_addr_t, srsran::gtp_fteid_t> ip_to_usr_teid; // Map IP to User-plane TEID for downlink traffic
+    std::map<in_addr_t, uint32_t>            ip_to_ctr_teid; // IP to control TEID map. Important to check if
                                                              // UE is attached without an active user-plane
                                                              // for downlink notifications.
+  };
+
+  enum class sgi_route_t { drop, s1u, paging };
+  sgi_route_t route_sgi_pdu(const tunnel_tables_t& tables,
+                            srsran::byte_buffer_t* msg,
+                            srsran::gtp_fteid_t*   enb_fteid,
+                            uint32_t*              spgw_teid);
+
+  // The tunnel tables are only modified by the SP-GW thread. After every change, it publishes an immutable copy that
+  // the user plane workers load once per batch of SGi PDUs, so that routing takes no lock.
+  tunnel_tables_t                        m_tunnel_tables;
+  std::shared_ptr<const tunnel_tables_t> m_tunnel_snapshot;
+  void                                   publish_tunnel_tables();
+  std::shared_ptr<const tunnel_tables_t> get_tunnel_snapshot() const;
+
+  // User plane workers. SGi PDUs of UEs that need paging are deferred to the SP-GW thread
+  class worker;
+  void                                      defer_sgi_pdu(srsran::unique_byte_buffer_t msg);
+  std::vector<std::unique_ptr<worker> >     m_workers;
+  std::mutex                                m_deferred_mutex;
+  std::vector<srsran::unique_byte_buffer_t> m_deferred_sgi_pdus;
+  int                                       m_deferred_pipe[2] = {-1, -1};
 
   srslog::basic_logger& m_logger = srslog::fetch_basic_logger("GTPU");
 };
@@ -86,6 +118,16 @@ inline int spgw::gtpu::get_s1u()
   return m_s1u;
 }
 
+inline int spgw::gtpu::get_deferred_sgi()
+{
+  return m_deferred_pipe[0];
+}
+
+inline uint32_t spgw::gtpu::get_nof_workers()
+{
+  return m_workers.size();
+}
+
 inline in_addr_t spgw::gtpu::get_s1u_addr()
 {
   return m_s1u_addr.sin_addr.s_addr;
@@ -46,6 +46,8 @@ typedef struct {
   std::string sgi_if_addr;
   std::string sgi_if_name;
   uint32_t    max_paging_queue;
+  uint32_t    gtpu_nof_workers;   // 0 handles the user plane in the SP-GW thread
+  uint32_t    gtpu_io_batch_size; // Max packets per sendmmsg/recvmmsg call of the user plane workers
 } spgw_args_t;
 
 typedef struct spgw_tunnel_ctx {
@@ -74,6 +74,12 @@ int hss::init(hss_args_t* hss_args)
     return -1;
   }
 
+  /*Restore the SQNs saved since the DB file was last written*/
+  if (not hss_args->db_store.empty() and not open_store(hss_args->db_store)) {
+    srsran::console("Error opening HSS store %s\n", hss_args->db_store.c_str());
+    return -1;
+  }
+
   mcc = hss_args->mcc;
   mnc = hss_args->mnc;
 
@@ -86,7 +92,10 @@ int hss::init(hss_args_t* hss_args)
 
 void hss::stop()
 {
-  write_db_file(db_file);
+  if (write_db_file(db_file) and store.is_open()) {
+    store.set_csv_synced();
+  }
+  store.close();
   return;
 }
 
@@ -114,7 +123,7 @@ bool hss::read_db_file(std::string db_filename)
         srsran::console("See 'srsepc/user_db.csv.example' for an example.\n\n");
         return false;
       }
-      std::unique_ptr<hss_ue_ctx_t> ue_ctx = std::unique_ptr<hss_ue_ctx_t>(new hss_ue_ctx_t);
+      std::unique_ptr<hss_ue_ctx_t> ue_ctx = std::unique_ptr<hss_ue_ctx_t>(new hss_ue_ctx_t());
       ue_ctx->name                         = split[0];
       if (split[1] == std::string("xor")) {
         ue_ctx->algo = HSS_ALGO_XOR;
@@ -254,6 +263,40 @@ bool hss::write_db_file(std::string db_filename)
   return true;
 }
 
+bool hss::open_store(std::string store_file)
+{
+  // Records are in the order of the subscriber map, which is fixed once the DB file is read
+  std::vector<hss_store_record_t> records;
+  records.reserve(m_imsi_to_ue_ctx.size());
+  for (const auto& ue : m_imsi_to_ue_ctx) {
+    hss_store_record_t record = {};
+    record.imsi               = ue.first;
+    memcpy(record.sqn, ue.second->sqn, sizeof(record.sqn));
+    memcpy(record.csv_sqn, ue.second->sqn, sizeof(record.csv_sqn));
+    ue.second->get_last_rand(record.last_rand);
+    records.push_back(record);
+  }
+
+  if (not store.open(store_file, records)) {
+    return false;
+  }
+
+  uint32_t idx = 0;
+  for (const auto& ue : m_imsi_to_ue_ctx) {
+    ue.second->set_sqn(records[idx].sqn);
+    ue.second->set_last_rand(records[idx].last_rand);
+    ue.second->store_idx = idx++;
+  }
+  return true;
+}
+
+void hss::save_ue_state(hss_ue_ctx_t* ue_ctx)
+{
+  if (store.is_open()) {
+    store.update(ue_ctx->store_idx, ue_ctx->sqn, ue_ctx->last_rand);
+  }
+}
+
 bool hss::gen_auth_info_answer(uint64_t imsi, uint8_t* k_asme, uint8_t* autn, uint8_t* rand, uint8_t* xres)
 {
 
@@ -265,6 +308,7 @@ bool hss::gen_auth_info_answer(uint64_t imsi, uint8_t* k_asme, uint8_t* autn, ui
     return false;
   }
 
+  std::lock_guard<std::mutex> lock(ue_ctx->mutex);
   switch (ue_ctx->algo) {
     case HSS_ALGO_XOR:
       gen_auth_info_answer_xor(ue_ctx, k_asme, autn, rand, xres);
@@ -274,6 +318,7 @@ bool hss::gen_auth_info_answer(uint64_t imsi, uint8_t* k_asme, uint8_t* autn, ui
       break;
   }
   increment_ue_sqn(ue_ctx);
+  save_ue_state(ue_ctx);
   return true;
 }
 
@@ -462,6 +507,7 @@ bool hss::resync_sqn(uint64_t imsi, uint8_t* auts)
     return false;
   }
 
+  std::lock_guard<std::mutex> lock(ue_ctx->mutex);
   switch (ue_ctx->algo) {
     case HSS_ALGO_XOR:
       resync_sqn_xor(ue_ctx, auts);
@@ -472,6 +518,7 @@ bool hss::resync_sqn(uint64_t imsi, uint8_t* auts)
   }
 
   increment_seq_after_resync(ue_ctx);
+  save_ue_state(ue_ctx);
   return true;
 }
 
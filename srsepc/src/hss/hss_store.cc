@@ -0,0 +1,195 @@
+/**
+ * Copyright 2013-2021 Software Radio Systems Limited
+ *
+ * This file is part of srsRAN.
+ *
+ * srsRAN is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsRAN is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+#include "srsepc/hdr/hss/hss_store.h"
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unordered_map>
+#include <unistd.h>
+
+namespace srsepc {
+
+static const char     store_magic[8] = {'S', 'R', 'S', 'H', 'S', 'S', 'D', 'B'};
+static const uint32_t store_version  = 1;
+
+hss_store::~hss_store()
+{
+  close();
+}
+
+bool hss_store::open(const std::string& filename, std::vector<hss_store_record_t>& new_records)
+{
+  if (is_open()) {
+    logger.error("HSS store already open");
+    return false;
+  }
+
+  std::vector<hss_store_record_t> saved;
+  if (not read_file(filename, saved)) {
+    return false;
+  }
+
+  std::unordered_map<uint64_t, const hss_store_record_t*> saved_map(saved.size());
+  for (const hss_store_record_t& r : saved) {
+    saved_map[r.imsi] = &r;
+  }
+  uint32_t nof_restored = 0;
+  for (hss_store_record_t& r : new_records) {
+    auto it = saved_map.find(r.imsi);
+    if (it == saved_map.end()) {
+      continue;
+    }
+    if (memcmp(it->second->csv_sqn, r.sqn, sizeof(r.sqn)) != 0) {
+      logger.info("SQN of IMSI %015" PRIu64 " changed in the user database, not restoring it", r.imsi);
+      continue;
+    }
+    memcpy(r.sqn, it->second->sqn, sizeof(r.sqn));
+    memcpy(r.last_rand, it->second->last_rand, sizeof(r.last_rand));
+    nof_restored++;
+  }
+
+  // Compact the store, written aside and renamed so that a crash never leaves a partial store
+  std::string tmp_filename = filename + ".tmp";
+  if (not write_file(tmp_filename, new_records)) {
+    return false;
+  }
+  if (rename(tmp_filename.c_str(), filename.c_str()) != 0) {
+    logger.error("Error renaming HSS store %s: %s", tmp_filename.c_str(), strerror(errno));
+    return false;
+  }
+
+  fd = ::open(filename.c_str(), O_RDWR);
+  if (fd < 0) {
+    logger.error("Error opening HSS store %s: %s", filename.c_str(), strerror(errno));
+    return false;
+  }
+  if (new_records.empty()) {
+    return true;
+  }
+  map_size = sizeof(header_t) + new_records.size() * sizeof(hss_store_record_t);
+  map      = mmap(nullptr, map_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  if (map == MAP_FAILED) {
+    logger.error("Error mapping HSS store %s: %s", filename.c_str(), strerror(errno));
+    map = nullptr;
+    ::close(fd);
+    fd = -1;
+    return false;
+  }
+  records     = reinterpret_cast<hss_store_record_t*>(static_cast<uint8_t*>(map) + sizeof(header_t));
+  nof_records = new_records.size();
+
+  logger.info("Opened HSS store %s. Subscribers: %zd, restored from the store: %d",
+              filename.c_str(),
+              new_records.size(),
+              nof_restored);
+  return true;
+}
+
+void hss_store::close()
+{
+  if (map != nullptr) {
+    msync(map, map_size, MS_SYNC);
+    munmap(map, map_size);
+    map     = nullptr;
+    records = nullptr;
+  }
+  if (fd >= 0) {
+    ::close(fd);
+    fd = -1;
+  }
+  nof_records = 0;
+}
+
+void hss_store::update(uint32_t idx, const uint8_t* sqn, const uint8_t* last_rand)
+{
+  if (records == nullptr or idx >= nof_records) {
+    return;
+  }
+  memcpy(records[idx].sqn, sqn, sizeof(records[idx].sqn));
+  memcpy(records[idx].last_rand, last_rand, sizeof(records[idx].last_rand));
+}
+
+void hss_store::set_csv_synced()
+{
+  for (uint64_t i = 0; i < nof_records; i++) {
+    memcpy(records[i].csv_sqn, records[i].sqn, sizeof(records[i].csv_sqn));
+  }
+}
+
+bool hss_store::read_file(const std::string& filename, std::vector<hss_store_record_t>& saved)
+{
+  int rfd = ::open(filename.c_str(), O_RDONLY);
+  if (rfd < 0) {
+    if (errno == ENOENT) {
+      logger.info("HSS store %s not found, creating it", filename.c_str());
+      return true;
+    }
+    logger.error("Error opening HSS store %s: %s", filename.c_str(), strerror(errno));
+    return false;
+  }
+
+  header_t header = {};
+  bool     ret    = true;
+  if (read(rfd, &header, sizeof(header)) != sizeof(header) or memcmp(header.magic, store_magic, sizeof(store_magic)) or
+      header.version != store_version or header.record_size != sizeof(hss_store_record_t)) {
+    logger.error("Invalid HSS store %s", filename.c_str());
+    ret = false;
+  } else {
+    saved.resize(header.nof_records);
+    ssize_t len = saved.size() * sizeof(hss_store_record_t);
+    if (read(rfd, saved.data(), len) != len) {
+      logger.error("Truncated HSS store %s", filename.c_str());
+      ret = false;
+    }
+  }
+  ::close(rfd);
+  return ret;
+}
+
+bool hss_store::write_file(const std::string& filename, const std::vector<hss_store_record_t>& new_records)
+{
+  int wfd = ::open(filename.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0600);
+  if (wfd < 0) {
+    logger.error("Error creating HSS store %s: %s", filename.c_str(), strerror(errno));
+    return false;
+  }
+
+  header_t header = {};
+  memcpy(header.magic, store_magic, sizeof(store_magic));
+  header.version     = store_version;
+  header.record_size = sizeof(hss_store_record_t);
+  header.nof_records = new_records.size();
+
+  ssize_t len = new_records.size() * sizeof(hss_store_record_t);
+  bool    ret = write(wfd, &header, sizeof(header)) == sizeof(header) and
+             write(wfd, new_records.data(), len) == len and fsync(wfd) == 0;
+  if (not ret) {
+    logger.error("Error writing HSS store %s: %s", filename.c_str(), strerror(errno));
+  }
+  ::close(wfd);
+  return ret;
+}
+
+} // namespace srsepc
@@ -85,8 +85,11 @@ void parse_args(all_args_t* args, int argc, char* argv[])
   string   mme_apn;
   string   encryption_algo;
   string   integrity_algo;
-  uint16_t paging_timer     = 0;
-  uint32_t max_paging_queue = 0;
+  uint16_t paging_timer       = 0;
+  uint32_t max_paging_queue   = 0;
+  uint32_t nas_nof_workers    = 0;
+  uint32_t gtpu_nof_workers   = 0;
+  uint32_t gtpu_io_batch_size = 0;
   string   spgw_bind_addr;
   string   sgi_if_addr;
   string   sgi_if_name;
@@ -95,6 +98,7 @@ void parse_args(all_args_t* args, int argc, char* argv[])
   string   short_net_name;
   bool     request_imeisv;
   string   hss_db_file;
+  string   hss_db_store;
   string   hss_auth_algo;
   string   log_filename;
 
@@ -124,11 +128,15 @@ void parse_args(all_args_t* args, int argc, char* argv[])
     ("mme.integrity_algo",  bpo::value<string>(&integrity_algo)->default_value("EIA1"),      "Set preferred integrity protection algorithm for NAS")
     ("mme.paging_timer",    bpo::value<uint16_t>(&paging_timer)->default_value(2),           "Set paging timer value in seconds (T3413)")
     ("mme.request_imeisv",  bpo::value<bool>(&request_imeisv)->default_value(false),         "Enable IMEISV request in Security mode command")
+    ("mme.nas_nof_workers", bpo::value<uint32_t>(&nas_nof_workers)->default_value(0),        "Number of NAS worker threads (0 to handle NAS in the MME thread)")
     ("hss.db_file",         bpo::value<string>(&hss_db_file)->default_value("ue_db.csv"),    ".csv file that stores UE's keys")
+    ("hss.db_store",        bpo::value<string>(&hss_db_store)->default_value(""),            "File that saves the SQN of each UE on every authentication (empty to disable)")
     ("spgw.gtpu_bind_addr", bpo::value<string>(&spgw_bind_addr)->default_value("127.0.0.1"), "IP address of SP-GW for the S1-U connection")
     ("spgw.sgi_if_addr",    bpo::value<string>(&sgi_if_addr)->default_value("176.16.0.1"),   "IP address of TUN interface for the SGi connection")
     ("spgw.sgi_if_name",    bpo::value<string>(&sgi_if_name)->default_value("srs_spgw_sgi"), "Name of TUN interface for the SGi connection")
     ("spgw.max_paging_queue", bpo::value<uint32_t>(&max_paging_queue)->default_value(100), "Max number of packets in paging queue")
+    ("spgw.gtpu_nof_workers",   bpo::value<uint32_t>(&gtpu_nof_workers)->default_value(0),  "Number of GTP-U user plane worker threads (0 to handle the user plane in the SP-GW thread)")
+    ("spgw.gtpu_io_batch_size", bpo::value<uint32_t>(&gtpu_io_batch_size)->default_value(32), "Max number of packets per sendmmsg/recvmmsg call of the GTP-U workers")
 
     ("pcap.enable",   bpo::value<bool>(&args->mme_args.s1ap_args.pcap_enable)->default_value(false),         "Enable S1AP PCAP")
     ("pcap.filename", bpo::value<string>(&args->mme_args.s1ap_args.pcap_filename)->default_value("/tmp/epc.pcap"), "PCAP filename")
@@ -276,19 +284,23 @@ void parse_args(all_args_t* args, int argc, char* argv[])
     cout << "Using default mme.integrity_algo: EIA1" << endl;
   }
 
-  args->mme_args.s1ap_args.mme_bind_addr  = mme_bind_addr;
-  args->mme_args.s1ap_args.mme_name       = mme_name;
-  args->mme_args.s1ap_args.dns_addr       = dns_addr;
-  args->mme_args.s1ap_args.full_net_name  = full_net_name;
-  args->mme_args.s1ap_args.short_net_name = short_net_name;
-  args->mme_args.s1ap_args.mme_apn        = mme_apn;
-  args->mme_args.s1ap_args.paging_timer   = paging_timer;
-  args->mme_args.s1ap_args.request_imeisv = request_imeisv;
-  args->spgw_args.gtpu_bind_addr          = spgw_bind_addr;
-  args->spgw_args.sgi_if_addr             = sgi_if_addr;
-  args->spgw_args.sgi_if_name             = sgi_if_name;
-  args->spgw_args.max_paging_queue        = max_paging_queue;
-  args->hss_args.db_file                  = hss_db_file;
+  args->mme_args.s1ap_args.mme_bind_addr   = mme_bind_addr;
+  args->mme_args.s1ap_args.mme_name        = mme_name;
+  args->mme_args.s1ap_args.dns_addr        = dns_addr;
+  args->mme_args.s1ap_args.full_net_name   = full_net_name;
+  args->mme_args.s1ap_args.short_net_name  = short_net_name;
+  args->mme_args.s1ap_args.mme_apn         = mme_apn;
+  args->mme_args.s1ap_args.paging_timer    = paging_timer;
+  args->mme_args.s1ap_args.request_imeisv  = request_imeisv;
+  args->mme_args.s1ap_args.nas_nof_workers = nas_nof_workers;
+  args->spgw_args.gtpu_bind_addr           = spgw_bind_addr;
+  args->spgw_args.sgi_if_addr              = sgi_if_addr;
+  args->spgw_args.sgi_if_name              = sgi_if_name;
+  args->spgw_args.max_paging_queue         = max_paging_queue;
+  args->spgw_args.gtpu_nof_workers         = gtpu_nof_workers;
+  args->spgw_args.gtpu_io_batch_size       = gtpu_io_batch_size;
+  args->hss_args.db_file                   = hss_db_file;
+  args->hss_args.db_store                  = hss_db_store;
 
   // Apply all_level to any unset layers
   if (vm.count("log.all_level")) {
@@ -21,6 +21,7 @@
 
 #include "srsepc/hdr/mbms-gw/mbms-gw.h"
 #include "srsran/common/config_file.h"
+#include "srsran/common/standard_streams.h"
 #include "srsran/srslog/srslog.h"
 #include <boost/program_options.hpp>
 #include <iostream>
@@ -48,6 +49,7 @@ typedef struct {
 typedef struct {
   mbms_gw_args_t mbms_gw_args;
   log_args_t     log_args;
+  uint32_t       metrics_period_secs;
 } all_args_t;
 
 /**********************************************************************
@@ -86,6 +88,8 @@ void parse_args(all_args_t* args, int argc, char* argv[])
     ("mbms_gw.m1u_multi_addr",      bpo::value<string>(&mbms_gw_m1u_multi_addr)->default_value("239.255.0.1"), "M1-u GTPu destination multicast address.")
     ("mbms_gw.m1u_multi_if",        bpo::value<string>(&mbms_gw_m1u_multi_if)->default_value("127.0.1.200"), "Local interface IP for M1-U multicast packets.")
     ("mbms_gw.m1u_multi_ttl",       bpo::value<int>(&args->mbms_gw_args.m1u_multi_ttl)->default_value(1), "TTL for M1-U multicast packets.")
+    ("mbms_gw.io_batch_size",       bpo::value<uint32_t>(&args->mbms_gw_args.io_batch_size)->default_value(32), "Maximum number of packets forwarded per wakeup.")
+    ("mbms_gw.metrics_period_secs", bpo::value<uint32_t>(&args->metrics_period_secs)->default_value(0), "Period of the forwarding metrics report in seconds (0 to disable).")
 
     ("log.all_level",     bpo::value<string>(&args->log_args.all_level)->default_value("info"),   "ALL log level")
     ("log.all_hex_limit", bpo::value<int>(&args->log_args.all_hex_limit)->default_value(32),  "ALL log hex dump limit")
@@ -165,6 +169,33 @@ void parse_args(all_args_t* args, int argc, char* argv[])
   return;
 }
 
+void print_metrics(const mbms_gw_metrics_t& metrics, const mbms_gw_metrics_t& prev, uint32_t period_secs)
+{
+  double rate_pkts = (metrics.nof_packets - prev.nof_packets) / (double)period_secs;
+  double rate_mbps = (metrics.nof_bytes - prev.nof_bytes) * 8 / (period_secs * 1e6);
+  double avg_batch =
+      (metrics.nof_wakeups > prev.nof_wakeups)
+          ? (metrics.nof_packets - prev.nof_packets) / (double)(metrics.nof_wakeups - prev.nof_wakeups)
+          : 0;
+
+  srsran::console("MBMS-GW TEID=0x%x: %.1f pkt/s, %.2f Mbps, dropped=%" PRIu64 ", avg_batch=%.1f, max_batch=%d, "
+                  "full_batches=%" PRIu64 ", m1u_queue=%d bytes\n",
+                  metrics.teid,
+                  rate_pkts,
+                  rate_mbps,
+                  metrics.nof_dropped,
+                  avg_batch,
+                  metrics.max_batch_size,
+                  metrics.nof_full_batches,
+                  metrics.m1u_queue_bytes);
+  for (const mbms_gw_flow_metrics_t& flow : metrics.flows) {
+    char addr[INET_ADDRSTRLEN];
+    inet_ntop(AF_INET, &flow.dst_addr, addr, sizeof(addr));
+    srsran::console(
+        "  flow %s:%d: packets=%" PRIu64 ", bytes=%" PRIu64 "\n", addr, flow.dst_port, flow.nof_packets, flow.nof_bytes);
+  }
+}
+
 int main(int argc, char* argv[])
 {
   cout << endl << "---  Software Radio Systems MBMS  ---" << endl << endl;
@@ -205,8 +236,16 @@ int main(int argc, char* argv[])
   }
 
   mbms_gw->start();
+  mbms_gw_metrics_t prev_metrics = {};
+  uint32_t          nof_secs     = 0;
   while (running) {
     sleep(1);
+    if (args.metrics_period_secs > 0 && ++nof_secs % args.metrics_period_secs == 0) {
+      mbms_gw_metrics_t metrics;
+      mbms_gw->get_metrics(metrics);
+      print_metrics(metrics, prev_metrics, args.metrics_period_secs);
+      prev_metrics = metrics;
+    }
   }
 
   mbms_gw->stop();
@@ -20,6 +20,7 @@
  */
 
 #include "srsepc/hdr/mbms-gw/mbms-gw.h"
+#include "srsran/common/int_helpers.h"
 #include "srsran/common/standard_streams.h"
 #include "srsran/common/network_utils.h"
 #include "srsran/upper/gtpu.h"
@@ -29,8 +30,10 @@
 #include <linux/if.h>
 #include <linux/if_tun.h>
 #include <linux/ip.h>
+#include <linux/sockios.h>
 #include <netinet/in.h>
 #include <netinet/udp.h>
+#include <poll.h>
 #include <sys/ioctl.h>
 #include <sys/socket.h>
 
@@ -39,7 +42,9 @@ namespace srsepc {
 mbms_gw*        mbms_gw::m_instance    = NULL;
 pthread_mutex_t mbms_gw_instance_mutex = PTHREAD_MUTEX_INITIALIZER;
 
-const uint16_t MBMS_GW_BUFFER_SIZE = 2500;
+const uint16_t MBMS_GW_BUFFER_SIZE     = 2500;
+const uint32_t MBMS_GW_TEID            = 0xAAAA; // Single MBMS bearer, no M3/Sm signalling assigns TEIDs
+const int      MBMS_GW_POLL_TIMEOUT_MS = 100;
 
 mbms_gw::mbms_gw() : m_running(false), m_sgi_mb_up(false), thread("MBMS_GW")
 {
@@ -75,6 +80,8 @@ int mbms_gw::init(mbms_gw_args_t* args)
 {
   int err;
 
+  m_io_batch_size = std::max(args->io_batch_size, 1u);
+
   err = init_sgi_mb_if(args);
   if (err != SRSRAN_SUCCESS) {
     srsran::console("Error initializing SGi-MB.\n");
@@ -95,13 +102,13 @@ int mbms_gw::init(mbms_gw_args_t* args)
 void mbms_gw::stop()
 {
   if (m_running) {
+    // The forwarding loop wakes up at least every MBMS_GW_POLL_TIMEOUT_MS to check m_running
+    m_running = false;
+    wait_thread_finish();
     if (m_sgi_mb_up) {
       close(m_sgi_mb_if);
       m_logger.info("Closed SGi-MB interface");
     }
-    m_running = false;
-    thread_cancel();
-    wait_thread_finish();
   }
   return;
 }
@@ -114,8 +121,8 @@ int mbms_gw::init_sgi_mb_if(mbms_gw_args_t* args)
     return SRSRAN_ERROR_ALREADY_STARTED;
   }
 
-  // Construct the TUN device
-  m_sgi_mb_if = open("/dev/net/tun", O_RDWR);
+  // Construct the TUN device. It is non-blocking, so that each wakeup drains a batch of packets
+  m_sgi_mb_if = open("/dev/net/tun", O_RDWR | O_NONBLOCK);
   m_logger.info("TUN file descriptor = %d", m_sgi_mb_if);
   if (m_sgi_mb_if < 0) {
     m_logger.error("Failed to open TUN device: %s", strerror(errno));
@@ -249,7 +256,24 @@ int mbms_gw::init_m1_u(mbms_gw_args_t* args)
     perror("inet_pton");
     return SRSRAN_ERROR_CANT_START;
   }
-  m_logger.info("Initialized M1-U");
+
+  // Pre-build the GTP-U header. All packets go to the same TEID, so only the length changes per packet
+  srsran::gtpu_header_t header;
+  header.flags        = GTPU_FLAGS_VERSION_V1 | GTPU_FLAGS_GTP_PROTOCOL;
+  header.message_type = GTPU_MSG_DATA_PDU;
+  header.length       = 0;
+  header.teid         = MBMS_GW_TEID;
+
+  srsran::byte_buffer_t hdr;
+  if (!srsran::gtpu_write_header(&header, &hdr, m_logger) || hdr.N_bytes != GTPU_BASE_HEADER_LEN) {
+    m_logger.error("Error building the GTP-U header template");
+    return SRSRAN_ERROR_CANT_START;
+  }
+  memcpy(m_gtpu_hdr_template, hdr.msg, GTPU_BASE_HEADER_LEN);
+  m_metrics.teid = MBMS_GW_TEID;
+
+  m_tx_batch.init(m_m1u, m_io_batch_size);
+  m_logger.info("Initialized M1-U. I/O batch size: %d", m_io_batch_size);
 
   return SRSRAN_SUCCESS;
 }
@@ -257,65 +281,130 @@ int mbms_gw::init_m1_u(mbms_gw_args_t* args)
 void mbms_gw::run_thread()
 {
   // Mark the thread as running
-  m_running                        = true;
-  srsran::unique_byte_buffer_t msg = srsran::make_byte_buffer();
-  if (msg == nullptr) {
-    m_logger.error("Couldn't allocate PDU in %s().", __FUNCTION__);
-    return;
-  }
+  m_running = true;
 
-  uint8_t seq = 0;
+  struct pollfd sgi_mb = {};
+  sgi_mb.fd            = m_sgi_mb_if;
+  sgi_mb.events        = POLLIN;
   while (m_running) {
-    msg->clear();
-    int n;
-    do {
-      n = read(m_sgi_mb_if, msg->msg, SRSRAN_MAX_BUFFER_SIZE_BYTES);
-    } while (n == -1 && errno == EAGAIN);
-
-    if (n < 0) {
-      m_logger.error("Error reading from TUN interface. Error: %s", strerror(errno));
-    } else {
+    int ret = poll(&sgi_mb, 1, MBMS_GW_POLL_TIMEOUT_MS);
+    if (ret < 0 && errno != EINTR) {
+      m_logger.error("Error polling TUN interface. Error: %s", strerror(errno));
+      break;
+    }
+    if (ret <= 0) {
+      continue;
+    }
+
+    // Drain up to a batch of packets from SGi-mb, and forward them to M1-U with a single sendmmsg()
+    uint32_t nof_pdus     = 0;
+    uint32_t nof_bytes    = 0;
+    uint32_t nof_dropped  = 0;
+    uint64_t nof_tx_fails = m_tx_batch.get_nof_failures();
+    while (nof_pdus < m_io_batch_size) {
+      srsran::unique_byte_buffer_t msg = srsran::make_byte_buffer();
+      if (msg == nullptr) {
+        m_logger.error("Couldn't allocate PDU in %s().", __FUNCTION__);
+        break;
+      }
+      int n = read(m_sgi_mb_if, msg->msg, msg->get_tailroom());
+      if (n < 0) {
+        if (errno != EAGAIN && errno != EINTR) {
+          m_logger.error("Error reading from TUN interface. Error: %s", strerror(errno));
+        }
+        break;
+      }
       msg->N_bytes = n;
-      handle_sgi_md_pdu(msg.get());
+      nof_pdus++;
+      nof_bytes += n;
+      if (!handle_sgi_md_pdu(std::move(msg))) {
+        nof_dropped++;
+      }
     }
+    if (!m_tx_batch.flush()) {
+      srsran::console("Error writing to M1-U socket.\n");
+    }
+    // Datagrams that sendmmsg() did not take, in this flush or when a full batch was sent from push()
+    nof_dropped += m_tx_batch.get_nof_failures() - nof_tx_fails;
+
+    std::lock_guard<std::mutex> lock(m_metrics_mutex);
+    m_metrics.nof_wakeups++;
+    m_metrics.nof_packets += nof_pdus;
+    m_metrics.nof_bytes += nof_bytes;
+    m_metrics.nof_dropped += nof_dropped;
+    m_metrics.nof_full_batches += (nof_pdus == m_io_batch_size) ? 1 : 0;
+    m_metrics.max_batch_size = std::max(m_metrics.max_batch_size, nof_pdus);
   }
   return;
 }
 
-void mbms_gw::handle_sgi_md_pdu(srsran::byte_buffer_t* msg)
+bool mbms_gw::handle_sgi_md_pdu(srsran::unique_byte_buffer_t msg)
 {
-  uint8_t               version;
-  srsran::gtpu_header_t header;
-
-  // Setup GTP-U header
-  header.flags        = GTPU_FLAGS_VERSION_V1 | GTPU_FLAGS_GTP_PROTOCOL;
-  header.message_type = GTPU_MSG_DATA_PDU;
-  header.length       = msg->N_bytes;
-  header.teid         = 0xAAAA; // TODO Harcoded TEID for now
-
   // Sanity Check IP packet
   if (msg->N_bytes < 20) {
     m_logger.error("IPv4 min len: %d, drop msg len %d", 20, msg->N_bytes);
-    return;
+    return false;
   }
 
   // IP Headers
   struct iphdr* iph = (struct iphdr*)msg->msg;
   if (iph->version != 4) {
     m_logger.info("IPv6 not supported yet.");
-    return;
+    return false;
   }
+  update_flow_metrics(msg.get());
 
   // Write GTP-U header into packet
-  if (!srsran::gtpu_write_header(&header, msg, m_logger)) {
+  if (msg->get_headroom() < GTPU_BASE_HEADER_LEN) {
     srsran::console("Error writing GTP-U header on PDU\n");
+    return false;
   }
+  msg->msg -= GTPU_BASE_HEADER_LEN;
+  memcpy(msg->msg, m_gtpu_hdr_template, GTPU_BASE_HEADER_LEN);
+  srsran::uint16_to_uint8(msg->N_bytes, &msg->msg[2]);
+  msg->N_bytes += GTPU_BASE_HEADER_LEN;
+
+  m_logger.debug("Sending %d Bytes", msg->N_bytes);
+  m_tx_batch.push(std::move(msg), m_m1u_multi_addr);
+  return true;
+}
 
-  int n = sendto(m_m1u, msg->msg, msg->N_bytes, 0, (sockaddr*)&m_m1u_multi_addr, sizeof(struct sockaddr));
-  if (n < 0) {
-    srsran::console("Error writing to M1-U socket.\n");
-  } else {
-    m_logger.debug("Sent %d Bytes", msg->N_bytes);
+void mbms_gw::update_flow_metrics(const srsran::byte_buffer_t* msg)
+{
+  const struct iphdr* iph      = (const struct iphdr*)msg->msg;
+  uint32_t            ip_len   = iph->ihl * 4;
+  uint16_t            dst_port = 0;
+  if (iph->protocol == IPPROTO_UDP && msg->N_bytes >= ip_len + sizeof(struct udphdr)) {
+    const struct udphdr* udph = (const struct udphdr*)(msg->msg + ip_len);
+    dst_port                  = ntohs(udph->dest);
+  }
+  uint64_t key = ((uint64_t)iph->daddr << 16U) | dst_port;
+
+  std::lock_guard<std::mutex> lock(m_metrics_mutex);
+  auto                        it = m_flows.find(key);
+  if (it == m_flows.end()) {
+    if (m_flows.size() >= MBMS_GW_MAX_FLOWS) {
+      return;
+    }
+    mbms_gw_flow_metrics_t flow = {};
+    flow.dst_addr               = iph->daddr;
+    flow.dst_port               = dst_port;
+    it                          = m_flows.emplace(key, flow).first;
+  }
+  it->second.nof_packets++;
+  it->second.nof_bytes += msg->N_bytes;
+}
+
+void mbms_gw::get_metrics(mbms_gw_metrics_t& metrics)
+{
+  std::lock_guard<std::mutex> lock(m_metrics_mutex);
+  metrics = m_metrics;
+  metrics.flows.clear();
+  for (const auto& flow : m_flows) {
+    metrics.flows.push_back(flow.second);
+  }
+  if (ioctl(m_m1u, SIOCOUTQ, &metrics.m1u_queue_bytes) < 0) {
+    metrics.m1u_queue_bytes = -1;
   }
 }
 
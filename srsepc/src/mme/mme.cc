@@ -22,7 +22,10 @@
 #include "srsepc/hdr/mme/mme.h"
 #include <arpa/inet.h>
 #include <inttypes.h> // for printing uint64_t
+#include <fcntl.h>
 #include <netinet/sctp.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
 #include <sys/socket.h>
 #include <sys/types.h>
 
@@ -31,6 +34,8 @@ namespace srsepc {
 mme*            mme::m_instance    = NULL;
 pthread_mutex_t mme_instance_mutex = PTHREAD_MUTEX_INITIALIZER;
 
+static const int max_epoll_events = 64;
+
 mme::mme() : m_running(false), thread("MME")
 {
   return;
@@ -77,6 +82,15 @@ int mme::init(mme_args_t* args)
     exit(-1);
   }
 
+  /*Init event loop*/
+  m_epoll_fd = epoll_create1(0);
+  m_stop_fd  = eventfd(0, EFD_NONBLOCK);
+  if (m_epoll_fd == -1 || m_stop_fd == -1 || !add_epoll_fd(m_s1ap->get_s1_mme()) ||
+      !add_epoll_fd(m_mme_gtpc->get_s11()) || !add_epoll_fd(m_stop_fd)) {
+    srsran::console("Error initializing MME event loop: %s\n", strerror(errno));
+    exit(-1);
+  }
+
   /*Log successful initialization*/
   m_s1ap_logger.info("MME Initialized. MCC: 0x%x, MNC: 0x%x", args->s1ap_args.mcc, args->s1ap_args.mnc);
   srsran::console("MME Initialized. MCC: 0x%x, MNC: 0x%x\n", args->s1ap_args.mcc, args->s1ap_args.mnc);
@@ -86,11 +100,31 @@ int mme::init(mme_args_t* args)
 void mme::stop()
 {
   if (m_running) {
+    // Wake up the MME thread, which stops before handling more messages
+    m_running     = false;
+    uint64_t stop = 1;
+    if (write(m_stop_fd, &stop, sizeof(stop)) != sizeof(stop)) {
+      m_s1ap_logger.error("Error waking up the MME thread: %s", strerror(errno));
+    }
+    wait_thread_finish();
     m_s1ap->stop();
     m_s1ap->cleanup();
-    m_running = false;
-    thread_cancel();
-    wait_thread_finish();
+    m_mme_gtpc->stop();
+  }
+
+  std::lock_guard<std::mutex> lock(m_timers_mutex);
+  for (std::pair<const int, uint64_t>& timer : m_timer_fd_to_key) {
+    close(timer.first);
+  }
+  m_timers.clear();
+  m_timer_fd_to_key.clear();
+  if (m_epoll_fd != -1) {
+    close(m_epoll_fd);
+    m_epoll_fd = -1;
+  }
+  if (m_stop_fd != -1) {
+    close(m_stop_fd);
+    m_stop_fd = -1;
   }
   return;
 }
@@ -102,14 +136,7 @@ void mme::run_thread()
     m_s1ap_logger.error("Couldn't allocate PDU in %s().", __FUNCTION__);
     return;
   }
-  uint32_t                     sz  = SRSRAN_MAX_BUFFER_SIZE_BYTES - SRSRAN_BUFFER_HEADER_OFFSET;
-
-  struct sockaddr_in     enb_addr;
-  struct sctp_sndrcvinfo sri;
-  socklen_t              fromlen = sizeof(enb_addr);
-  bzero(&enb_addr, sizeof(enb_addr));
-  int rd_sz;
-  int msg_flags = 0;
+  uint32_t sz = SRSRAN_MAX_BUFFER_SIZE_BYTES - SRSRAN_BUFFER_HEADER_OFFSET;
 
   // Mark the thread as running
   m_running = true;
@@ -118,79 +145,89 @@ void mme::run_thread()
   int s1mme = m_s1ap->get_s1_mme();
   int s11   = m_mme_gtpc->get_s11();
 
+  struct epoll_event events[max_epoll_events];
   while (m_running) {
-    pdu->clear();
-    int max_fd = std::max(s1mme, s11);
-
-    FD_ZERO(&m_set);
-    FD_SET(s1mme, &m_set);
-    FD_SET(s11, &m_set);
-
-    // Add timers to select
-    for (std::vector<mme_timer_t>::iterator it = timers.begin(); it != timers.end(); ++it) {
-      FD_SET(it->fd, &m_set);
-      max_fd = std::max(max_fd, it->fd);
-      m_s1ap_logger.debug("Adding Timer fd %d to fd_set", it->fd);
-    }
-
     m_s1ap_logger.debug("Waiting for S1-MME or S11 Message");
-    int n = select(max_fd + 1, &m_set, NULL, NULL, NULL);
+    int n = epoll_wait(m_epoll_fd, events, max_epoll_events, -1);
     if (n == -1) {
-      m_s1ap_logger.error("Error from select");
-    } else if (n) {
-      // Handle S1-MME
-      if (FD_ISSET(s1mme, &m_set)) {
-        rd_sz = sctp_recvmsg(s1mme, pdu->msg, sz, (struct sockaddr*)&enb_addr, &fromlen, &sri, &msg_flags);
-        if (rd_sz == -1 && errno != EAGAIN) {
-          m_s1ap_logger.error("Error reading from SCTP socket: %s", strerror(errno));
-        } else if (rd_sz == -1 && errno == EAGAIN) {
-          m_s1ap_logger.debug("Socket timeout reached");
-        } else {
-          if (msg_flags & MSG_NOTIFICATION) {
-            // Received notification
-            union sctp_notification* notification = (union sctp_notification*)pdu->msg;
-            m_s1ap_logger.debug("SCTP Notification %d", notification->sn_header.sn_type);
-            if (notification->sn_header.sn_type == SCTP_SHUTDOWN_EVENT) {
-              m_s1ap_logger.info("SCTP Association Shutdown. Association: %d", sri.sinfo_assoc_id);
-              srsran::console("SCTP Association Shutdown. Association: %d\n", sri.sinfo_assoc_id);
-              m_s1ap->delete_enb_ctx(sri.sinfo_assoc_id);
-            }
-          } else {
-            // Received data
-            pdu->N_bytes = rd_sz;
-            m_s1ap_logger.info("Received S1AP msg. Size: %d", pdu->N_bytes);
-            m_s1ap->handle_s1ap_rx_pdu(pdu.get(), &sri);
-          }
-        }
+      if (errno != EINTR) {
+        m_s1ap_logger.error("Error from epoll_wait: %s", strerror(errno));
       }
-      // Handle S11
-      if (FD_ISSET(s11, &m_set)) {
+      continue;
+    }
+    for (int i = 0; i < n && m_running; ++i) {
+      int fd = events[i].data.fd;
+      pdu->clear();
+      if (fd == s1mme) {
+        // Handle S1-MME
+        handle_s1mme(s1mme, pdu.get());
+      } else if (fd == s11) {
+        // Handle S11
         pdu->N_bytes = recvfrom(s11, pdu->msg, sz, 0, NULL, NULL);
         m_mme_gtpc->handle_s11_pdu(pdu.get());
+      } else if (fd != m_stop_fd) {
+        // Handle NAS Timers
+        handle_timer_expire(fd);
       }
-      // Handle NAS Timers
-      for (std::vector<mme_timer_t>::iterator it = timers.begin(); it != timers.end();) {
-        if (FD_ISSET(it->fd, &m_set)) {
-          m_s1ap_logger.info("Timer expired");
-          uint64_t exp;
-          rd_sz = read(it->fd, &exp, sizeof(uint64_t));
-          m_s1ap->expire_nas_timer(it->type, it->imsi);
-          close(it->fd);
-          timers.erase(it);
-        } else {
-          ++it;
-        }
+    }
+  }
+  return;
+}
+
+void mme::handle_s1mme(int s1mme, srsran::byte_buffer_t* pdu)
+{
+  uint32_t               sz = SRSRAN_MAX_BUFFER_SIZE_BYTES - SRSRAN_BUFFER_HEADER_OFFSET;
+  struct sockaddr_in     enb_addr;
+  struct sctp_sndrcvinfo sri;
+  socklen_t              fromlen = sizeof(enb_addr);
+  bzero(&enb_addr, sizeof(enb_addr));
+  int msg_flags = 0;
+
+  int rd_sz = sctp_recvmsg(s1mme, pdu->msg, sz, (struct sockaddr*)&enb_addr, &fromlen, &sri, &msg_flags);
+  if (rd_sz == -1 && errno != EAGAIN) {
+    m_s1ap_logger.error("Error reading from SCTP socket: %s", strerror(errno));
+  } else if (rd_sz == -1 && errno == EAGAIN) {
+    m_s1ap_logger.debug("Socket timeout reached");
+  } else {
+    if (msg_flags & MSG_NOTIFICATION) {
+      // Received notification
+      union sctp_notification* notification = (union sctp_notification*)pdu->msg;
+      m_s1ap_logger.debug("SCTP Notification %d", notification->sn_header.sn_type);
+      if (notification->sn_header.sn_type == SCTP_SHUTDOWN_EVENT) {
+        m_s1ap_logger.info("SCTP Association Shutdown. Association: %d", sri.sinfo_assoc_id);
+        srsran::console("SCTP Association Shutdown. Association: %d\n", sri.sinfo_assoc_id);
+        m_s1ap->delete_enb_ctx(sri.sinfo_assoc_id);
       }
     } else {
-      m_s1ap_logger.debug("No data from select.");
+      // Received data
+      pdu->N_bytes = rd_sz;
+      m_s1ap_logger.info("Received S1AP msg. Size: %d", pdu->N_bytes);
+      m_s1ap->handle_s1ap_rx_pdu(pdu, &sri);
     }
   }
-  return;
+}
+
+bool mme::add_epoll_fd(int fd)
+{
+  struct epoll_event event = {};
+  event.events             = EPOLLIN;
+  event.data.fd            = fd;
+  if (epoll_ctl(m_epoll_fd, EPOLL_CTL_ADD, fd, &event) == -1) {
+    m_s1ap_logger.error("Error adding fd %d to the MME event loop: %s", fd, strerror(errno));
+    return false;
+  }
+  return true;
 }
 
 /*
  * Timer Handling
  */
+uint64_t mme::get_timer_key(enum nas_timer_type type, uint64_t imsi)
+{
+  // IMSIs take at most 50 bits
+  return (imsi << 8U) | type;
+}
+
 bool mme::add_nas_timer(int timer_fd, nas_timer_type type, uint64_t imsi)
 {
   m_s1ap_logger.debug("Adding NAS timer to MME. IMSI %" PRIu64 ", Type %d, Fd: %d", imsi, type, timer_fd);
@@ -200,40 +237,76 @@ bool mme::add_nas_timer(int timer_fd, nas_timer_type type, uint64_t imsi)
   timer.type = type;
   timer.imsi = imsi;
 
-  timers.push_back(timer);
+  std::lock_guard<std::mutex> lock(m_timers_mutex);
+  uint64_t                    key = get_timer_key(type, imsi);
+  if (m_timers.count(key) > 0) {
+    m_s1ap_logger.warning("Replacing running NAS timer. IMSI %" PRIu64 ", Type %d", imsi, type);
+    close_timer(m_timers[key].fd);
+  }
+
+  // Timers are read without blocking, in case they are removed after waking up the MME thread
+  fcntl(timer_fd, F_SETFL, fcntl(timer_fd, F_GETFL) | O_NONBLOCK);
+  if (!add_epoll_fd(timer_fd)) {
+    // The MME owns the timer from here on
+    close(timer_fd);
+    return false;
+  }
+  m_timers[key]               = timer;
+  m_timer_fd_to_key[timer_fd] = key;
   return true;
 }
 
 bool mme::is_nas_timer_running(nas_timer_type type, uint64_t imsi)
 {
-  std::vector<mme_timer_t>::iterator it;
-  for (it = timers.begin(); it != timers.end(); ++it) {
-    if (it->type == type && it->imsi == imsi) {
-      return true; // found timer
-    }
-  }
-  return false;
+  std::lock_guard<std::mutex> lock(m_timers_mutex);
+  return m_timers.count(get_timer_key(type, imsi)) > 0;
 }
 
 bool mme::remove_nas_timer(nas_timer_type type, uint64_t imsi)
 {
-  std::vector<mme_timer_t>::iterator it;
-  for (it = timers.begin(); it != timers.end(); ++it) {
-    if (it->type == type && it->imsi == imsi) {
-      break; // found timer to remove
-    }
-  }
-  if (it == timers.end()) {
+  std::lock_guard<std::mutex>                         lock(m_timers_mutex);
+  std::unordered_map<uint64_t, mme_timer_t>::iterator it = m_timers.find(get_timer_key(type, imsi));
+  if (it == m_timers.end()) {
     m_s1ap_logger.warning("Could not find timer to remove. IMSI %" PRIu64 ", Type %d", imsi, type);
     return false;
   }
 
   // removing timer
-  m_s1ap_logger.debug("Removing NAS timer from MME. IMSI %" PRIu64 ", Type %d, Fd: %d", imsi, type, it->fd);
-  FD_CLR(it->fd, &m_set);
-  close(it->fd);
-  timers.erase(it);
+  m_s1ap_logger.debug("Removing NAS timer from MME. IMSI %" PRIu64 ", Type %d, Fd: %d", imsi, type, it->second.fd);
+  close_timer(it->second.fd);
   return true;
 }
 
+void mme::close_timer(int timer_fd)
+{
+  std::unordered_map<int, uint64_t>::iterator it = m_timer_fd_to_key.find(timer_fd);
+  if (it != m_timer_fd_to_key.end()) {
+    m_timers.erase(it->second);
+    m_timer_fd_to_key.erase(it);
+  }
+  epoll_ctl(m_epoll_fd, EPOLL_CTL_DEL, timer_fd, NULL);
+  close(timer_fd);
+}
+
+void mme::handle_timer_expire(int timer_fd)
+{
+  mme_timer_t timer;
+  {
+    std::lock_guard<std::mutex> lock(m_timers_mutex);
+    if (m_timer_fd_to_key.count(timer_fd) == 0) {
+      // Removed after it expired
+      return;
+    }
+    uint64_t exp;
+    if (read(timer_fd, &exp, sizeof(uint64_t)) != sizeof(uint64_t)) {
+      // Removed after it expired, and the fd was reused by a new timer
+      return;
+    }
+    timer = m_timers[m_timer_fd_to_key[timer_fd]];
+    close_timer(timer_fd);
+  }
+  m_s1ap_logger.info("Timer expired");
+  m_s1ap->expire_nas_timer(timer.type, timer.imsi);
+}
+
 } // namespace srsepc
@@ -50,6 +50,7 @@ nas::nas(const nas_init_t& args, const nas_if_t& itf) :
 {
   m_sec_ctx.integ_algo  = args.integ_algo;
   m_sec_ctx.cipher_algo = args.cipher_algo;
+  m_shard               = std::max(nas_worker_pool::get_current_shard(), 0);
   m_logger.debug("NAS Context Initialized. MCC: 0x%x, MNC 0x%x", m_mcc, m_mnc);
 }
 
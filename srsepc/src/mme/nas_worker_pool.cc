@@ -0,0 +1,142 @@
+/**
+ * Copyright 2013-2021 Software Radio Systems Limited
+ *
+ * This file is part of srsRAN.
+ *
+ * srsRAN is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsRAN is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+#include "srsepc/hdr/mme/nas_worker_pool.h"
+#include "srsran/adt/circular_buffer.h"
+#include "srsran/common/threads.h"
+#include <atomic>
+#include <deque>
+#include <mutex>
+
+namespace srsepc {
+
+static thread_local int32_t current_shard = -1;
+
+/**
+ * Worker thread of a shard. It runs the tasks of the bounded queue filled by the MME thread, and the tasks that other
+ * workers leave in its inbox. The inbox keeps the order of the tasks of each worker, and is emptied before every pop
+ * from the queue, so that a task posted by a worker runs before the ones the MME thread queues after it.
+ */
+class nas_worker_pool::worker : public srsran::thread
+{
+public:
+  worker(uint32_t shard_, uint32_t queue_size) : thread("NAS" + std::to_string(shard_)), shard(shard_), queue(queue_size)
+  {
+    start();
+  }
+  ~worker() { stop(); }
+
+  void stop()
+  {
+    if (not queue.is_stopped()) {
+      queue.stop();
+      wait_thread_finish();
+    }
+  }
+
+  void push_task(task_t&& task) { queue.push_blocking(std::move(task)); }
+
+  void push_inbox_task(task_t&& task)
+  {
+    {
+      std::lock_guard<std::mutex> lock(inbox_mutex);
+      inbox.push_back(std::move(task));
+      inbox_pending.store(true, std::memory_order_release);
+    }
+    // Wake up the worker if it is waiting for the queue. A full queue means it is busy, and checks the inbox next
+    queue.try_push(task_t([]() {}));
+  }
+
+private:
+  void run_thread() override
+  {
+    current_shard = shard;
+    while (true) {
+      run_inbox_tasks();
+      bool   success;
+      task_t task = queue.pop_blocking(&success);
+      if (not success) {
+        break;
+      }
+      task();
+    }
+  }
+
+  void run_inbox_tasks()
+  {
+    while (inbox_pending.load(std::memory_order_acquire)) {
+      std::deque<task_t> tasks;
+      {
+        std::lock_guard<std::mutex> lock(inbox_mutex);
+        tasks.swap(inbox);
+        inbox_pending.store(false, std::memory_order_relaxed);
+      }
+      for (task_t& t : tasks) {
+        t();
+      }
+    }
+  }
+
+  const uint32_t                     shard;
+  srsran::dyn_blocking_queue<task_t> queue;
+  std::mutex                         inbox_mutex;
+  std::deque<task_t>                 inbox;
+  std::atomic<bool>                  inbox_pending{false};
+};
+
+nas_worker_pool::nas_worker_pool() {}
+
+nas_worker_pool::~nas_worker_pool()
+{
+  stop();
+}
+
+void nas_worker_pool::init(uint32_t nof_workers, uint32_t queue_size)
+{
+  for (uint32_t i = 0; i < nof_workers; ++i) {
+    m_workers.emplace_back(new worker(i, queue_size));
+  }
+}
+
+void nas_worker_pool::stop()
+{
+  for (std::unique_ptr<worker>& w : m_workers) {
+    w->stop();
+  }
+  m_workers.clear();
+}
+
+void nas_worker_pool::push_task(uint32_t shard, task_t&& task)
+{
+  worker& w = *m_workers[shard % m_workers.size()];
+  if (get_current_shard() < 0) {
+    w.push_task(std::move(task));
+  } else {
+    w.push_inbox_task(std::move(task));
+  }
+}
+
+int32_t nas_worker_pool::get_current_shard()
+{
+  return current_shard;
+}
+
+} // namespace srsepc
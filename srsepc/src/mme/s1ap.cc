@@ -33,7 +33,9 @@ namespace srsepc {
 s1ap*           s1ap::m_instance    = NULL;
 pthread_mutex_t s1ap_instance_mutex = PTHREAD_MUTEX_INITIALIZER;
 
-s1ap::s1ap() : m_s1mme(-1), m_next_mme_ue_s1ap_id(1), m_mme_gtpc(NULL) {}
+static const uint32_t nas_worker_queue_size = 8192;
+
+s1ap::s1ap() : m_s1mme(-1), m_mme_gtpc(NULL) {}
 
 s1ap::~s1ap()
 {
@@ -99,16 +101,22 @@ int s1ap::init(const s1ap_args_t& s1ap_args)
   if (m_pcap_enable) {
     m_pcap.open(s1ap_args.pcap_filename.c_str());
   }
-  m_logger.info("S1AP Initialized");
+
+  // Init NAS workers. Each shard allocates the MME UE S1AP Ids of its own residue class
+  m_nas_workers.init(s1ap_args.nas_nof_workers, nas_worker_queue_size);
+  m_next_mme_ue_s1ap_id.assign(m_nas_workers.nof_shards(), 0);
+
+  m_logger.info("S1AP Initialized. NAS workers: %d", m_nas_workers.nof_workers());
   return SRSRAN_SUCCESS;
 }
 
 void s1ap::stop()
 {
+  m_nas_workers.stop();
   if (m_s1mme != -1) {
     close(m_s1mme);
   }
-  std::map<uint16_t, enb_ctx_t*>::iterator enb_it = m_active_enbs.begin();
+  std::unordered_map<uint16_t, enb_ctx_t*>::iterator enb_it = m_active_enbs.begin();
   while (enb_it != m_active_enbs.end()) {
     m_logger.info("Deleting eNB context. eNB Id: 0x%x", enb_it->second->enb_id);
     srsran::console("Deleting eNB context. eNB Id: 0x%x\n", enb_it->second->enb_id);
@@ -116,7 +124,7 @@ void s1ap::stop()
     m_active_enbs.erase(enb_it++);
   }
 
-  std::map<uint64_t, nas*>::iterator ue_it = m_imsi_to_nas_ctx.begin();
+  std::unordered_map<uint64_t, nas*>::iterator ue_it = m_imsi_to_nas_ctx.begin();
   while (ue_it != m_imsi_to_nas_ctx.end()) {
     m_logger.info("Deleting UE EMM context. IMSI: %015" PRIu64 "", ue_it->first);
     srsran::console("Deleting UE EMM context. IMSI: %015" PRIu64 "\n", ue_it->first);
@@ -143,7 +151,10 @@ int s1ap::get_s1_mme()
 
 uint32_t s1ap::get_next_mme_ue_s1ap_id()
 {
-  return m_next_mme_ue_s1ap_id++;
+  // Only the worker of a shard allocates its Ids, so that the shard can be found from the Id alone
+  uint32_t nof_shards = m_next_mme_ue_s1ap_id.size();
+  int32_t  shard      = std::max(nas_worker_pool::get_current_shard(), 0);
+  return m_next_mme_ue_s1ap_id[shard]++ * nof_shards + shard + 1;
 }
 
 int s1ap::enb_listen()
@@ -223,6 +234,7 @@ bool s1ap::s1ap_tx_pdu(const asn1::s1ap::s1ap_pdu_c& pdu, struct sctp_sndrcvinfo
   }
 
   if (m_pcap_enable) {
+    std::lock_guard<std::mutex> lock(m_pcap_mutex);
     m_pcap.write_s1ap(buf->msg, buf->N_bytes);
   }
 
@@ -233,17 +245,38 @@ void s1ap::handle_s1ap_rx_pdu(srsran::byte_buffer_t* pdu, struct sctp_sndrcvinfo
 {
   // Save PCAP
   if (m_pcap_enable) {
+    std::lock_guard<std::mutex> lock(m_pcap_mutex);
     m_pcap.write_s1ap(pdu->msg, pdu->N_bytes);
   }
 
-  // Get PDU type
-  s1ap_pdu_t     rx_pdu;
   asn1::cbit_ref bref(pdu->msg, pdu->N_bytes);
-  if (rx_pdu.unpack(bref) != asn1::SRSASN_SUCCESS) {
+  if (m_nas_workers.nof_workers() == 0) {
+    s1ap_pdu_t rx_pdu;
+    if (rx_pdu.unpack(bref) != asn1::SRSASN_SUCCESS) {
+      m_logger.error("Failed to unpack received PDU");
+      return;
+    }
+    handle_s1ap_rx_pdu(rx_pdu, enb_sri);
+    return;
+  }
+
+  // Hand UE associated messages over to the worker of the UE. The rest is handled here
+  std::shared_ptr<rx_pdu_t> rx = std::make_shared<rx_pdu_t>();
+  if (rx->pdu.unpack(bref) != asn1::SRSASN_SUCCESS) {
     m_logger.error("Failed to unpack received PDU");
     return;
   }
+  uint32_t shard = 0;
+  if (not find_pdu_shard(rx->pdu, &shard)) {
+    handle_s1ap_rx_pdu(rx->pdu, enb_sri);
+    return;
+  }
+  rx->enb_sri = *enb_sri;
+  push_nas_task(shard, [this, rx]() { handle_s1ap_rx_pdu(rx->pdu, &rx->enb_sri); });
+}
 
+void s1ap::handle_s1ap_rx_pdu(const s1ap_pdu_t& rx_pdu, struct sctp_sndrcvinfo* enb_sri)
+{
   switch (rx_pdu.type().value) {
     case s1ap_pdu_t::types_opts::init_msg:
       m_logger.info("Received Initiating PDU");
@@ -310,21 +343,66 @@ void s1ap::handle_successful_outcome(const asn1::s1ap::successful_outcome_s& msg
   }
 }
 
+bool s1ap::find_pdu_shard(const s1ap_pdu_t& rx_pdu, uint32_t* shard)
+{
+  using init_msg_type_opts_t           = asn1::s1ap::s1ap_elem_procs_o::init_msg_c::types_opts;
+  using successful_outcome_type_opts_t = asn1::s1ap::s1ap_elem_procs_o::successful_outcome_c::types_opts;
+
+  if (rx_pdu.type().value == s1ap_pdu_t::types_opts::init_msg) {
+    const asn1::s1ap::s1ap_elem_procs_o::init_msg_c& msg = rx_pdu.init_msg().value;
+    switch (msg.type().value) {
+      case init_msg_type_opts_t::init_ue_msg: {
+        // UEs not known yet are spread by eNB UE S1AP Id
+        const asn1::s1ap::init_ue_msg_s& init_ue   = msg.init_ue_msg();
+        uint64_t                         imsi      = m_s1ap_nas_transport->find_initial_ue_message_imsi(init_ue);
+        uint32_t                         enb_ue_id = init_ue.protocol_ies.enb_ue_s1ap_id.value.value;
+        *shard = imsi != 0 ? get_imsi_shard(imsi) : enb_ue_id % m_nas_workers.nof_shards();
+        return true;
+      }
+      case init_msg_type_opts_t::ul_nas_transport:
+        *shard = get_mme_ue_s1ap_id_shard(msg.ul_nas_transport().protocol_ies.mme_ue_s1ap_id.value.value);
+        return true;
+      case init_msg_type_opts_t::ue_context_release_request:
+        *shard = get_mme_ue_s1ap_id_shard(msg.ue_context_release_request().protocol_ies.mme_ue_s1ap_id.value.value);
+        return true;
+      default:
+        return false;
+    }
+  }
+  if (rx_pdu.type().value == s1ap_pdu_t::types_opts::successful_outcome) {
+    const asn1::s1ap::s1ap_elem_procs_o::successful_outcome_c& msg = rx_pdu.successful_outcome().value;
+    switch (msg.type().value) {
+      case successful_outcome_type_opts_t::init_context_setup_resp:
+        *shard = get_mme_ue_s1ap_id_shard(msg.init_context_setup_resp().protocol_ies.mme_ue_s1ap_id.value.value);
+        return true;
+      case successful_outcome_type_opts_t::ue_context_release_complete:
+        *shard = get_mme_ue_s1ap_id_shard(msg.ue_context_release_complete().protocol_ies.mme_ue_s1ap_id.value.value);
+        return true;
+      default:
+        return false;
+    }
+  }
+  return false;
+}
+
 // eNB Context Managment
 void s1ap::add_new_enb_ctx(const enb_ctx_t& enb_ctx, const struct sctp_sndrcvinfo* enb_sri)
 {
   m_logger.info("Adding new eNB context. eNB ID %d", enb_ctx.enb_id);
-  std::set<uint32_t> ue_set;
-  enb_ctx_t*         enb_ptr = new enb_ctx_t;
-  *enb_ptr                   = enb_ctx;
+  std::unordered_set<uint32_t> ue_set;
+  enb_ctx_t*                   enb_ptr = new enb_ctx_t;
+  *enb_ptr                             = enb_ctx;
+
+  std::lock_guard<std::mutex> lock(m_ctx_mutex);
   m_active_enbs.insert(std::pair<uint16_t, enb_ctx_t*>(enb_ptr->enb_id, enb_ptr));
   m_sctp_to_enb_id.insert(std::pair<int32_t, uint16_t>(enb_sri->sinfo_assoc_id, enb_ptr->enb_id));
-  m_enb_assoc_to_ue_ids.insert(std::pair<int32_t, std::set<uint32_t> >(enb_sri->sinfo_assoc_id, ue_set));
+  m_enb_assoc_to_ue_ids.insert(std::pair<int32_t, std::unordered_set<uint32_t> >(enb_sri->sinfo_assoc_id, ue_set));
 }
 
 enb_ctx_t* s1ap::find_enb_ctx(uint16_t enb_id)
 {
-  std::map<uint16_t, enb_ctx_t*>::iterator it = m_active_enbs.find(enb_id);
+  std::lock_guard<std::mutex>                        lock(m_ctx_mutex);
+  std::unordered_map<uint16_t, enb_ctx_t*>::iterator it = m_active_enbs.find(enb_id);
   if (it == m_active_enbs.end()) {
     return nullptr;
   } else {
@@ -332,16 +410,35 @@ enb_ctx_t* s1ap::find_enb_ctx(uint16_t enb_id)
   }
 }
 
-void s1ap::delete_enb_ctx(int32_t assoc_id)
+std::vector<struct sctp_sndrcvinfo> s1ap::get_enb_sris()
 {
-  std::map<int32_t, uint16_t>::iterator it_assoc = m_sctp_to_enb_id.find(assoc_id);
-  uint16_t                              enb_id   = it_assoc->second;
+  std::lock_guard<std::mutex>         lock(m_ctx_mutex);
+  std::vector<struct sctp_sndrcvinfo> sris;
+  sris.reserve(m_active_enbs.size());
+  for (const std::pair<const uint16_t, enb_ctx_t*>& enb : m_active_enbs) {
+    sris.push_back(enb.second->sri);
+  }
+  return sris;
+}
 
-  std::map<uint16_t, enb_ctx_t*>::iterator it_ctx = m_active_enbs.find(enb_id);
-  if (it_ctx == m_active_enbs.end() || it_assoc == m_sctp_to_enb_id.end()) {
+void s1ap::delete_enb_ctx(int32_t assoc_id)
+{
+  enb_ctx_t* enb_ctx = nullptr;
+  {
+    std::lock_guard<std::mutex>                       lock(m_ctx_mutex);
+    std::unordered_map<int32_t, uint16_t>::iterator it_assoc = m_sctp_to_enb_id.find(assoc_id);
+    if (it_assoc != m_sctp_to_enb_id.end()) {
+      std::unordered_map<uint16_t, enb_ctx_t*>::iterator it_ctx = m_active_enbs.find(it_assoc->second);
+      if (it_ctx != m_active_enbs.end()) {
+        enb_ctx = it_ctx->second;
+      }
+    }
+  }
+  if (enb_ctx == nullptr) {
     m_logger.error("Could not find eNB to delete. Association: %d", assoc_id);
     return;
   }
+  uint16_t enb_id = enb_ctx->enb_id;
 
   m_logger.info("Deleting eNB context. eNB Id: 0x%x", enb_id);
   srsran::console("Deleting eNB context. eNB Id: 0x%x\n", enb_id);
@@ -350,22 +447,27 @@ void s1ap::delete_enb_ctx(int32_t assoc_id)
   release_ues_ecm_ctx_in_enb(assoc_id);
 
   // Delete eNB
-  delete it_ctx->second;
-  m_active_enbs.erase(it_ctx);
-  m_sctp_to_enb_id.erase(it_assoc);
+  {
+    std::lock_guard<std::mutex> lock(m_ctx_mutex);
+    m_active_enbs.erase(enb_id);
+    m_sctp_to_enb_id.erase(assoc_id);
+  }
+  delete enb_ctx;
   return;
 }
 
 // UE Context Management
 bool s1ap::add_nas_ctx_to_imsi_map(nas* nas_ctx)
 {
-  std::map<uint64_t, nas*>::iterator ctx_it = m_imsi_to_nas_ctx.find(nas_ctx->m_emm_ctx.imsi);
+  std::lock_guard<std::mutex>                  lock(m_ctx_mutex);
+  std::unordered_map<uint64_t, nas*>::iterator ctx_it = m_imsi_to_nas_ctx.find(nas_ctx->m_emm_ctx.imsi);
   if (ctx_it != m_imsi_to_nas_ctx.end()) {
     m_logger.error("UE Context already exists. IMSI %015" PRIu64 "", nas_ctx->m_emm_ctx.imsi);
     return false;
   }
   if (nas_ctx->m_ecm_ctx.mme_ue_s1ap_id != 0) {
-    std::map<uint32_t, nas*>::iterator ctx_it2 = m_mme_ue_s1ap_id_to_nas_ctx.find(nas_ctx->m_ecm_ctx.mme_ue_s1ap_id);
+    std::unordered_map<uint32_t, nas*>::iterator ctx_it2 =
+        m_mme_ue_s1ap_id_to_nas_ctx.find(nas_ctx->m_ecm_ctx.mme_ue_s1ap_id);
     if (ctx_it2 != m_mme_ue_s1ap_id_to_nas_ctx.end() && ctx_it2->second != nas_ctx) {
       m_logger.error("Context identified with IMSI does not match context identified by MME UE S1AP Id.");
       return false;
@@ -382,13 +484,16 @@ bool s1ap::add_nas_ctx_to_mme_ue_s1ap_id_map(nas* nas_ctx)
     m_logger.error("Could not add UE context to MME UE S1AP map. MME UE S1AP ID 0 is not valid.");
     return false;
   }
-  std::map<uint32_t, nas*>::iterator ctx_it = m_mme_ue_s1ap_id_to_nas_ctx.find(nas_ctx->m_ecm_ctx.mme_ue_s1ap_id);
+  std::lock_guard<std::mutex>                  lock(m_ctx_mutex);
+  std::unordered_map<uint32_t, nas*>::iterator ctx_it =
+      m_mme_ue_s1ap_id_to_nas_ctx.find(nas_ctx->m_ecm_ctx.mme_ue_s1ap_id);
   if (ctx_it != m_mme_ue_s1ap_id_to_nas_ctx.end()) {
     m_logger.error("UE Context already exists. MME UE S1AP Id %015" PRIu64 "", nas_ctx->m_emm_ctx.imsi);
     return false;
   }
   if (nas_ctx->m_emm_ctx.imsi != 0) {
-    std::map<uint32_t, nas*>::iterator ctx_it2 = m_mme_ue_s1ap_id_to_nas_ctx.find(nas_ctx->m_ecm_ctx.mme_ue_s1ap_id);
+    std::unordered_map<uint32_t, nas*>::iterator ctx_it2 =
+        m_mme_ue_s1ap_id_to_nas_ctx.find(nas_ctx->m_ecm_ctx.mme_ue_s1ap_id);
     if (ctx_it2 != m_mme_ue_s1ap_id_to_nas_ctx.end() && ctx_it2->second != nas_ctx) {
       m_logger.error("Context identified with MME UE S1AP Id does not match context identified by IMSI.");
       return false;
@@ -401,12 +506,13 @@ bool s1ap::add_nas_ctx_to_mme_ue_s1ap_id_map(nas* nas_ctx)
 
 bool s1ap::add_ue_to_enb_set(int32_t enb_assoc, uint32_t mme_ue_s1ap_id)
 {
-  std::map<int32_t, std::set<uint32_t> >::iterator ues_in_enb = m_enb_assoc_to_ue_ids.find(enb_assoc);
+  std::lock_guard<std::mutex> lock(m_ctx_mutex);
+  auto                        ues_in_enb = m_enb_assoc_to_ue_ids.find(enb_assoc);
   if (ues_in_enb == m_enb_assoc_to_ue_ids.end()) {
     m_logger.error("Could not find eNB from eNB SCTP association %d", enb_assoc);
     return false;
   }
-  std::set<uint32_t>::iterator ue_id = ues_in_enb->second.find(mme_ue_s1ap_id);
+  std::unordered_set<uint32_t>::iterator ue_id = ues_in_enb->second.find(mme_ue_s1ap_id);
   if (ue_id != ues_in_enb->second.end()) {
     m_logger.error("UE with MME UE S1AP Id already exists %d", mme_ue_s1ap_id);
     return false;
@@ -418,7 +524,8 @@ bool s1ap::add_ue_to_enb_set(int32_t enb_assoc, uint32_t mme_ue_s1ap_id)
 
 nas* s1ap::find_nas_ctx_from_mme_ue_s1ap_id(uint32_t mme_ue_s1ap_id)
 {
-  std::map<uint32_t, nas*>::iterator it = m_mme_ue_s1ap_id_to_nas_ctx.find(mme_ue_s1ap_id);
+  std::lock_guard<std::mutex>                  lock(m_ctx_mutex);
+  std::unordered_map<uint32_t, nas*>::iterator it = m_mme_ue_s1ap_id_to_nas_ctx.find(mme_ue_s1ap_id);
   if (it == m_mme_ue_s1ap_id_to_nas_ctx.end()) {
     return NULL;
   } else {
@@ -428,7 +535,8 @@ nas* s1ap::find_nas_ctx_from_mme_ue_s1ap_id(uint32_t mme_ue_s1ap_id)
 
 nas* s1ap::find_nas_ctx_from_imsi(uint64_t imsi)
 {
-  std::map<uint64_t, nas*>::iterator it = m_imsi_to_nas_ctx.find(imsi);
+  std::lock_guard<std::mutex>                  lock(m_ctx_mutex);
+  std::unordered_map<uint64_t, nas*>::iterator it = m_imsi_to_nas_ctx.find(imsi);
   if (it == m_imsi_to_nas_ctx.end()) {
     return NULL;
   } else {
@@ -439,56 +547,83 @@ nas* s1ap::find_nas_ctx_from_imsi(uint64_t imsi)
 void s1ap::release_ues_ecm_ctx_in_enb(int32_t enb_assoc)
 {
   srsran::console("Releasing UEs context\n");
-  std::map<int32_t, std::set<uint32_t> >::iterator ues_in_enb = m_enb_assoc_to_ue_ids.find(enb_assoc);
-  std::set<uint32_t>::iterator                     ue_id      = ues_in_enb->second.begin();
-  if (ue_id == ues_in_enb->second.end()) {
+  std::vector<uint32_t> ue_ids;
+  {
+    std::lock_guard<std::mutex>                                          lock(m_ctx_mutex);
+    std::unordered_map<int32_t, std::unordered_set<uint32_t> >::iterator ues_in_enb =
+        m_enb_assoc_to_ue_ids.find(enb_assoc);
+    if (ues_in_enb != m_enb_assoc_to_ue_ids.end()) {
+      ue_ids.assign(ues_in_enb->second.begin(), ues_in_enb->second.end());
+      ues_in_enb->second.clear();
+    }
+  }
+  if (ue_ids.empty()) {
     srsran::console("No UEs to be released\n");
-  } else {
-    while (ue_id != ues_in_enb->second.end()) {
-      std::map<uint32_t, nas*>::iterator nas_ctx = m_mme_ue_s1ap_id_to_nas_ctx.find(*ue_id);
-      emm_ctx_t*                         emm_ctx = &nas_ctx->second->m_emm_ctx;
-      ecm_ctx_t*                         ecm_ctx = &nas_ctx->second->m_ecm_ctx;
-
-      m_logger.info(
-          "Releasing UE context. IMSI: %015" PRIu64 ", UE-MME S1AP Id: %d", emm_ctx->imsi, ecm_ctx->mme_ue_s1ap_id);
-      if (emm_ctx->state == EMM_STATE_REGISTERED) {
-        m_mme_gtpc->send_delete_session_request(emm_ctx->imsi);
-        emm_ctx->state = EMM_STATE_DEREGISTERED;
-      }
-      srsran::console("Releasing UE ECM context. UE-MME S1AP Id: %d\n", ecm_ctx->mme_ue_s1ap_id);
-      ecm_ctx->state          = ECM_STATE_IDLE;
-      ecm_ctx->mme_ue_s1ap_id = 0;
-      ecm_ctx->enb_ue_s1ap_id = 0;
-      ues_in_enb->second.erase(ue_id++);
+    return;
+  }
+
+  // Each UE is released by the worker of its shard
+  for (uint32_t mme_ue_s1ap_id : ue_ids) {
+    uint32_t shard = get_mme_ue_s1ap_id_shard(mme_ue_s1ap_id);
+    if (is_current_shard(shard)) {
+      release_ue_ecm_ctx_in_enb(mme_ue_s1ap_id);
+    } else {
+      push_nas_task(shard, [this, mme_ue_s1ap_id]() { release_ue_ecm_ctx_in_enb(mme_ue_s1ap_id); });
     }
   }
 }
 
-bool s1ap::release_ue_ecm_ctx(uint32_t mme_ue_s1ap_id)
+void s1ap::release_ue_ecm_ctx_in_enb(uint32_t mme_ue_s1ap_id)
 {
   nas* nas_ctx = find_nas_ctx_from_mme_ue_s1ap_id(mme_ue_s1ap_id);
   if (nas_ctx == NULL) {
     m_logger.error("Cannot release UE ECM context, UE not found. MME-UE S1AP Id: %d", mme_ue_s1ap_id);
-    return false;
+    return;
   }
+  emm_ctx_t* emm_ctx = &nas_ctx->m_emm_ctx;
   ecm_ctx_t* ecm_ctx = &nas_ctx->m_ecm_ctx;
 
-  // Delete UE within eNB UE set
-  std::map<int32_t, uint16_t>::iterator it = m_sctp_to_enb_id.find(ecm_ctx->enb_sri.sinfo_assoc_id);
-  if (it == m_sctp_to_enb_id.end()) {
-    m_logger.error("Could not find eNB for UE release request.");
-    return false;
+  m_logger.info(
+      "Releasing UE context. IMSI: %015" PRIu64 ", UE-MME S1AP Id: %d", emm_ctx->imsi, ecm_ctx->mme_ue_s1ap_id);
+  if (emm_ctx->state == EMM_STATE_REGISTERED) {
+    m_mme_gtpc->send_delete_session_request(emm_ctx->imsi);
+    emm_ctx->state = EMM_STATE_DEREGISTERED;
   }
-  uint16_t                                         enb_id = it->second;
-  std::map<int32_t, std::set<uint32_t> >::iterator ue_set = m_enb_assoc_to_ue_ids.find(ecm_ctx->enb_sri.sinfo_assoc_id);
-  if (ue_set == m_enb_assoc_to_ue_ids.end()) {
-    m_logger.error("Could not find the eNB's UEs.");
+  srsran::console("Releasing UE ECM context. UE-MME S1AP Id: %d\n", ecm_ctx->mme_ue_s1ap_id);
+  ecm_ctx->state          = ECM_STATE_IDLE;
+  ecm_ctx->mme_ue_s1ap_id = 0;
+  ecm_ctx->enb_ue_s1ap_id = 0;
+}
+
+bool s1ap::release_ue_ecm_ctx(uint32_t mme_ue_s1ap_id)
+{
+  nas* nas_ctx = find_nas_ctx_from_mme_ue_s1ap_id(mme_ue_s1ap_id);
+  if (nas_ctx == NULL) {
+    m_logger.error("Cannot release UE ECM context, UE not found. MME-UE S1AP Id: %d", mme_ue_s1ap_id);
     return false;
   }
-  ue_set->second.erase(mme_ue_s1ap_id);
+  ecm_ctx_t* ecm_ctx = &nas_ctx->m_ecm_ctx;
+
+  {
+    std::lock_guard<std::mutex> lock(m_ctx_mutex);
+
+    // Delete UE within eNB UE set
+    std::unordered_map<int32_t, uint16_t>::iterator it = m_sctp_to_enb_id.find(ecm_ctx->enb_sri.sinfo_assoc_id);
+    if (it == m_sctp_to_enb_id.end()) {
+      m_logger.error("Could not find eNB for UE release request.");
+      return false;
+    }
+    std::unordered_map<int32_t, std::unordered_set<uint32_t> >::iterator ue_set =
+        m_enb_assoc_to_ue_ids.find(ecm_ctx->enb_sri.sinfo_assoc_id);
+    if (ue_set == m_enb_assoc_to_ue_ids.end()) {
+      m_logger.error("Could not find the eNB's UEs.");
+      return false;
+    }
+    ue_set->second.erase(mme_ue_s1ap_id);
 
-  // Release UE ECM context
-  m_mme_ue_s1ap_id_to_nas_ctx.erase(mme_ue_s1ap_id);
+    // Release UE ECM context
+    m_mme_ue_s1ap_id_to_nas_ctx.erase(mme_ue_s1ap_id);
+  }
   ecm_ctx->state          = ECM_STATE_IDLE;
   ecm_ctx->mme_ue_s1ap_id = 0;
   ecm_ctx->enb_ue_s1ap_id = 0;
@@ -504,37 +639,76 @@ bool s1ap::delete_ue_ctx(uint64_t imsi)
     m_logger.info("Cannot delete UE context, UE not found. IMSI: %" PRIu64 "", imsi);
     return false;
   }
+  {
+    std::lock_guard<std::mutex> lock(m_ctx_mutex);
+    m_imsi_to_nas_ctx.erase(imsi);
+  }
+
+  if (is_current_shard(nas_ctx->m_shard)) {
+    delete_nas_ctx(nas_ctx);
+  } else {
+    // The context may still be in use by the worker of its shard, which deletes it after the messages already queued
+    push_nas_task(nas_ctx->m_shard, [this, nas_ctx]() { delete_nas_ctx(nas_ctx); });
+  }
+  return true;
+}
 
+void s1ap::delete_nas_ctx(nas* nas_ctx)
+{
   // Make sure to release ECM ctx
   if (nas_ctx->m_ecm_ctx.mme_ue_s1ap_id != 0) {
     release_ue_ecm_ctx(nas_ctx->m_ecm_ctx.mme_ue_s1ap_id);
   }
 
   // Delete UE context
-  m_imsi_to_nas_ctx.erase(imsi);
   delete nas_ctx;
   m_logger.info("Deleted UE Context.");
-  return true;
+}
+
+// NAS workers
+uint32_t s1ap::get_imsi_shard(uint64_t imsi)
+{
+  // UEs stay in the shard of their context, which may not be the IMSI one if it was created before the IMSI was known
+  std::lock_guard<std::mutex>                  lock(m_ctx_mutex);
+  std::unordered_map<uint64_t, nas*>::iterator it = m_imsi_to_nas_ctx.find(imsi);
+  if (it != m_imsi_to_nas_ctx.end()) {
+    return it->second->m_shard;
+  }
+  return imsi % m_nas_workers.nof_shards();
+}
+
+uint32_t s1ap::get_mme_ue_s1ap_id_shard(uint32_t mme_ue_s1ap_id)
+{
+  return (mme_ue_s1ap_id - 1) % m_nas_workers.nof_shards();
+}
+
+bool s1ap::is_current_shard(uint32_t shard)
+{
+  return m_nas_workers.nof_workers() == 0 or nas_worker_pool::get_current_shard() == (int32_t)shard;
+}
+
+void s1ap::push_nas_task(uint32_t shard, nas_worker_pool::task_t&& task)
+{
+  m_nas_workers.push_task(shard, std::move(task));
 }
 
 // UE Bearer Managment
 void s1ap::activate_eps_bearer(uint64_t imsi, uint8_t ebi)
 {
-  std::map<uint64_t, nas*>::iterator ue_ctx_it = m_imsi_to_nas_ctx.find(imsi);
-  if (ue_ctx_it == m_imsi_to_nas_ctx.end()) {
+  nas* nas_ctx = find_nas_ctx_from_imsi(imsi);
+  if (nas_ctx == NULL) {
     m_logger.error("Could not activate EPS bearer: Could not find UE context");
     return;
   }
   // Make sure NAS is active
-  uint32_t                           mme_ue_s1ap_id = ue_ctx_it->second->m_ecm_ctx.mme_ue_s1ap_id;
-  std::map<uint32_t, nas*>::iterator it             = m_mme_ue_s1ap_id_to_nas_ctx.find(mme_ue_s1ap_id);
-  if (it == m_mme_ue_s1ap_id_to_nas_ctx.end()) {
+  uint32_t mme_ue_s1ap_id = nas_ctx->m_ecm_ctx.mme_ue_s1ap_id;
+  if (find_nas_ctx_from_mme_ue_s1ap_id(mme_ue_s1ap_id) == NULL) {
     m_logger.error("Could not activate EPS bearer: ECM context seems to be missing");
     return;
   }
 
-  ecm_ctx_t* ecm_ctx = &ue_ctx_it->second->m_ecm_ctx;
-  esm_ctx_t* esm_ctx = &ue_ctx_it->second->m_esm_ctx[ebi];
+  ecm_ctx_t* ecm_ctx = &nas_ctx->m_ecm_ctx;
+  esm_ctx_t* esm_ctx = &nas_ctx->m_esm_ctx[ebi];
   if (esm_ctx->state != ERAB_CTX_SETUP) {
     m_logger.error(
         "Could not be activate EPS Bearer, bearer in wrong state: MME S1AP Id %d, EPS Bearer id %d, state %d",
@@ -557,7 +731,8 @@ void s1ap::activate_eps_bearer(uint64_t imsi, uint8_t ebi)
 
 uint32_t s1ap::allocate_m_tmsi(uint64_t imsi)
 {
-  uint32_t m_tmsi = m_next_m_tmsi;
+  std::lock_guard<std::mutex> lock(m_ctx_mutex);
+  uint32_t                    m_tmsi = m_next_m_tmsi;
   m_next_m_tmsi   = (m_next_m_tmsi + 1) % UINT32_MAX;
 
   m_tmsi_to_imsi.insert(std::pair<uint32_t, uint64_t>(m_tmsi, imsi));
@@ -567,7 +742,8 @@ uint32_t s1ap::allocate_m_tmsi(uint64_t imsi)
 
 uint64_t s1ap::find_imsi_from_m_tmsi(uint32_t m_tmsi)
 {
-  std::map<uint32_t, uint64_t>::iterator it = m_tmsi_to_imsi.find(m_tmsi);
+  std::lock_guard<std::mutex>                      lock(m_ctx_mutex);
+  std::unordered_map<uint32_t, uint64_t>::iterator it = m_tmsi_to_imsi.find(m_tmsi);
   if (it != m_tmsi_to_imsi.end()) {
     m_logger.debug("Found IMSI %015" PRIu64 " from M-TMSI 0x%x", it->second, m_tmsi);
     return it->second;
@@ -666,6 +842,13 @@ bool s1ap::send_downlink_nas_transport(uint32_t               enb_ue_s1ap_id,
 
 bool s1ap::expire_nas_timer(enum nas_timer_type type, uint64_t imsi)
 {
+  // Timers expire in the MME thread, the UE handles them in its worker
+  uint32_t shard = get_imsi_shard(imsi);
+  if (not is_current_shard(shard)) {
+    push_nas_task(shard, [this, type, imsi]() { expire_nas_timer(type, imsi); });
+    return true;
+  }
+
   nas* nas_ctx = find_nas_ctx_from_imsi(imsi);
   if (nas_ctx == NULL) {
     m_logger.error("Error finding NAS context to handle timer");
@@ -140,6 +140,43 @@ bool s1ap_nas_transport::handle_initial_ue_message(const asn1::s1ap::init_ue_msg
   return err;
 }
 
+uint64_t s1ap_nas_transport::find_initial_ue_message_imsi(const asn1::s1ap::init_ue_msg_s& init_ue)
+{
+  const uint8_t* msg = init_ue.protocol_ies.nas_pdu.value.data();
+  uint32_t       len = init_ue.protocol_ies.nas_pdu.value.size();
+  if (len == 0) {
+    return 0;
+  }
+
+  // Attach requests carry the EPS mobile identity after the message type and the attach type
+  uint8_t  sec_hdr_type = (msg[0] & 0xF0) >> 4;
+  uint32_t msg_type_idx = sec_hdr_type == LIBLTE_MME_SECURITY_HDR_TYPE_PLAIN_NAS ? 1 : 7;
+  if (sec_hdr_type != LIBLTE_MME_SECURITY_HDR_TYPE_SERVICE_REQUEST && len > msg_type_idx + 13 &&
+      msg[msg_type_idx] == LIBLTE_MME_MSG_TYPE_ATTACH_REQUEST) {
+    LIBLTE_MME_EPS_MOBILE_ID_STRUCT eps_mobile_id = {};
+    uint8*                          ie_ptr        = const_cast<uint8*>(&msg[msg_type_idx + 2]);
+    liblte_mme_unpack_eps_mobile_id_ie(&ie_ptr, &eps_mobile_id);
+    if (eps_mobile_id.type_of_id == LIBLTE_MME_EPS_MOBILE_ID_TYPE_IMSI) {
+      uint64_t imsi = 0;
+      for (int i = 0; i <= 14; i++) {
+        imsi = imsi * 10 + eps_mobile_id.imsi[i];
+      }
+      return imsi;
+    }
+    if (eps_mobile_id.type_of_id == LIBLTE_MME_EPS_MOBILE_ID_TYPE_GUTI) {
+      return m_s1ap->find_imsi_from_m_tmsi(eps_mobile_id.guti.m_tmsi);
+    }
+    return 0;
+  }
+
+  if (init_ue.protocol_ies.s_tmsi_present) {
+    uint32_t m_tmsi = 0;
+    srsran::uint8_to_uint32(init_ue.protocol_ies.s_tmsi.value.m_tmsi.data(), &m_tmsi);
+    return m_s1ap->find_imsi_from_m_tmsi(m_tmsi);
+  }
+  return 0;
+}
+
 bool s1ap_nas_transport::handle_uplink_nas_transport(const asn1::s1ap::ul_nas_transport_s& ul_xport,
                                                      struct sctp_sndrcvinfo*               enb_sri)
 {
@@ -41,7 +41,7 @@ namespace srsepc {
  * comminication with the MME
  *
  **********************************************/
-spgw::gtpc::gtpc() : m_h_next_ue_ip(0), m_next_ctrl_teid(1), m_next_user_teid(1), m_max_paging_queue(0)
+spgw::gtpc::gtpc() : m_s11(-1), m_h_next_ue_ip(0), m_next_ctrl_teid(1), m_next_user_teid(1), m_max_paging_queue(0)
 {
   return;
 }
@@ -93,6 +93,10 @@ void spgw::gtpc::stop()
     delete it->second;
     m_teid_to_tunnel_ctx.erase(it++);
   }
+  if (m_s11 != -1) {
+    close(m_s11);
+    m_s11 = -1;
+  }
   return;
 }
 
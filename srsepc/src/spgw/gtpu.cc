@@ -26,17 +26,149 @@
 #include "srsran/upper/gtpu.h"
 #include <algorithm>
 #include <arpa/inet.h>
+#include <atomic>
 #include <fcntl.h>
 #include <inttypes.h> // for printing uint64_t
+#include <linux/filter.h>
 #include <linux/if.h>
 #include <linux/if_tun.h>
 #include <linux/ip.h>
 #include <netinet/in.h>
+#include <poll.h>
 #include <sys/ioctl.h>
 #include <sys/socket.h>
 
 namespace srsepc {
 
+/**************************************
+ *
+ * User plane worker. Serves one queue of
+ * the SGi TUN device and one of the S1-U
+ * sockets sharing the GTP-U port
+ *
+ **************************************/
+
+class spgw::gtpu::worker : public srsran::thread
+{
+public:
+  worker(gtpu* parent_, uint32_t id_, int sgi_, int s1u_, uint32_t io_batch_size) :
+    thread("SPGW_GTPU_" + std::to_string(id_)),
+    parent(parent_),
+    id(id_),
+    sgi(sgi_),
+    s1u(s1u_),
+    batch_size(std::max(io_batch_size, 1u)),
+    logger(parent_->m_logger),
+    rx_batch(parent_->m_logger),
+    tx_batch(parent_->m_logger)
+  {
+    rx_batch.init(batch_size);
+    tx_batch.init(s1u, batch_size);
+  }
+  ~worker()
+  {
+    stop();
+    // The SGi and S1-U descriptors of the first worker are owned by the GTP-U class
+    if (id > 0) {
+      close(sgi);
+      close(s1u);
+    }
+  }
+
+  void stop()
+  {
+    if (running) {
+      running = false;
+      wait_thread_finish();
+    }
+  }
+
+  void start_worker()
+  {
+    running = true;
+    start();
+  }
+
+private:
+  void run_thread() override
+  {
+    struct pollfd fds[2] = {};
+    fds[0].fd            = sgi;
+    fds[0].events        = POLLIN;
+    fds[1].fd            = s1u;
+    fds[1].events        = POLLIN;
+    while (running) {
+      int n = poll(fds, 2, 100);
+      if (n < 0) {
+        if (errno != EINTR) {
+          logger.error("Error from poll: %s", strerror(errno));
+        }
+        continue;
+      }
+      if (fds[0].revents & POLLIN) {
+        handle_sgi();
+      }
+      if (fds[1].revents & POLLIN) {
+        handle_s1u();
+      }
+    }
+  }
+
+  void handle_sgi()
+  {
+    size_t                                 buf_len = SRSRAN_MAX_BUFFER_SIZE_BYTES - SRSRAN_BUFFER_HEADER_OFFSET;
+    std::shared_ptr<const tunnel_tables_t> tables  = parent->get_tunnel_snapshot();
+    for (uint32_t i = 0; i < batch_size; ++i) {
+      srsran::unique_byte_buffer_t msg = srsran::make_byte_buffer("spgw::gtpu::worker::sgi_msg");
+      if (msg == nullptr) {
+        logger.error("Could not allocate byte buffer for SGi PDU");
+        break;
+      }
+      int n = read(sgi, msg->msg, buf_len);
+      if (n <= 0) {
+        // No more PDUs queued in the TUN device
+        break;
+      }
+      msg->N_bytes = n;
+
+      srsran::gtp_fteid_t enb_fteid;
+      uint32_t            spgw_teid;
+      sockaddr_in         enb_addr;
+      switch (parent->route_sgi_pdu(*tables, msg.get(), &enb_fteid, &spgw_teid)) {
+        case sgi_route_t::s1u:
+          if (parent->write_s1u_header(enb_fteid, msg.get(), &enb_addr)) {
+            tx_batch.push(std::move(msg), enb_addr);
+          }
+          break;
+        case sgi_route_t::paging:
+          parent->defer_sgi_pdu(std::move(msg));
+          break;
+        default:
+          break;
+      }
+    }
+    tx_batch.flush();
+  }
+
+  void handle_s1u()
+  {
+    int n = rx_batch.recv(s1u);
+    for (int i = 0; i < n; ++i) {
+      parent->handle_s1u_pdu(rx_batch.pdu(i).get(), sgi);
+    }
+  }
+
+  gtpu*                           parent;
+  uint32_t                        id;
+  int                             sgi;
+  int                             s1u;
+  uint32_t                        batch_size;
+  std::atomic<bool>               running{false};
+  srslog::basic_logger&           logger;
+  srsran::net_utils::udp_rx_batch rx_batch;
+  srsran::net_utils::udp_tx_batch tx_batch;
+};
+
 /**************************************
  *
  * GTP-U class that handles the packet
@@ -44,13 +176,14 @@ namespace srsepc {
  *
  **************************************/
 
-spgw::gtpu::gtpu() : m_sgi_up(false), m_s1u_up(false)
+spgw::gtpu::gtpu() : m_sgi_up(false), m_s1u_up(false), m_tunnel_snapshot(new tunnel_tables_t())
 {
   return;
 }
 
 spgw::gtpu::~gtpu()
 {
+  m_workers.clear();
   return;
 }
 
@@ -76,6 +209,15 @@ int spgw::gtpu::init(spgw_args_t* args, spgw* spgw, gtpc_interface_gtpu* gtpc)
     return err;
   }
 
+  // Init user plane workers
+  if (args->gtpu_nof_workers > 0) {
+    err = init_workers(args);
+    if (err != SRSRAN_SUCCESS) {
+      srsran::console("Could not initialize the GTP-U workers.\n");
+      return err;
+    }
+  }
+
   m_logger.info("SPGW GTP-U Initialized.");
   srsran::console("SPGW GTP-U Initialized.\n");
   return SRSRAN_SUCCESS;
@@ -83,6 +225,18 @@ int spgw::gtpu::init(spgw_args_t* args, spgw* spgw, gtpc_interface_gtpu* gtpc)
 
 void spgw::gtpu::stop()
 {
+  // Stop user plane workers
+  for (std::unique_ptr<worker>& w : m_workers) {
+    w->stop();
+  }
+  m_workers.clear();
+  for (int& fd : m_deferred_pipe) {
+    if (fd >= 0) {
+      close(fd);
+      fd = -1;
+    }
+  }
+
   // Clean up SGi interface
   if (m_sgi_up) {
     close(m_sgi);
@@ -112,6 +266,10 @@ int spgw::gtpu::init_sgi(spgw_args_t* args)
 
   memset(&ifr, 0, sizeof(ifr));
   ifr.ifr_flags = IFF_TUN | IFF_NO_PI;
+  if (args->gtpu_nof_workers > 0) {
+    // Every worker reads from its own queue of the TUN device
+    ifr.ifr_flags |= IFF_MULTI_QUEUE;
+  }
   strncpy(
       ifr.ifr_ifrn.ifrn_name, args->sgi_if_name.c_str(), std::min(args->sgi_if_name.length(), (size_t)(IFNAMSIZ - 1)));
   ifr.ifr_ifrn.ifrn_name[IFNAMSIZ - 1] = '\0';
@@ -183,6 +341,13 @@ int spgw::gtpu::init_s1u(spgw_args_t* args)
   }
   m_s1u_up = true;
 
+  // Every worker owns a socket bound to the GTP-U port
+  int enable = 1;
+  if (args->gtpu_nof_workers > 0 and setsockopt(m_s1u, SOL_SOCKET, SO_REUSEPORT, &enable, sizeof(int)) < 0) {
+    m_logger.error("Failed to set SO_REUSEPORT: %s", strerror(errno));
+    return SRSRAN_ERROR_CANT_START;
+  }
+
   // Bind the socket
   m_s1u_addr.sin_family      = AF_INET;
   if (inet_pton(m_s1u_addr.sin_family, args->gtpu_bind_addr.c_str(), &m_s1u_addr.sin_addr.s_addr) != 1) {
@@ -203,25 +368,136 @@ int spgw::gtpu::init_s1u(spgw_args_t* args)
   return SRSRAN_SUCCESS;
 }
 
-void spgw::gtpu::handle_sgi_pdu(srsran::unique_byte_buffer_t msg)
+int spgw::gtpu::init_workers(spgw_args_t* args)
+{
+  uint32_t nof_workers = args->gtpu_nof_workers;
+
+  // Channel used by the workers to hand over the SGi PDUs of UEs to be paged
+  if (pipe2(m_deferred_pipe, O_NONBLOCK | O_CLOEXEC) < 0) {
+    m_logger.error("Failed to create pipe: %s", strerror(errno));
+    return SRSRAN_ERROR_CANT_START;
+  }
+  if (fcntl(m_sgi, F_SETFL, fcntl(m_sgi, F_GETFL) | O_NONBLOCK) < 0) {
+    m_logger.error("Failed to set TUN device as non-blocking: %s", strerror(errno));
+    return SRSRAN_ERROR_CANT_START;
+  }
+
+  // The first worker uses the TUN queue and socket created at init_sgi/init_s1u
+  std::vector<std::pair<int, int> > fds = {{m_sgi, m_s1u}};
+  for (uint32_t i = 1; i < nof_workers; ++i) {
+    struct ifreq ifr = {};
+    ifr.ifr_flags    = IFF_TUN | IFF_NO_PI | IFF_MULTI_QUEUE;
+    strncpy(ifr.ifr_ifrn.ifrn_name,
+            args->sgi_if_name.c_str(),
+            std::min(args->sgi_if_name.length(), (size_t)(IFNAMSIZ - 1)));
+    int sgi = open("/dev/net/tun", O_RDWR | O_NONBLOCK);
+    if (sgi < 0 or ioctl(sgi, TUNSETIFF, &ifr) < 0) {
+      m_logger.error("Failed to attach queue %d to TUN device: %s", i, strerror(errno));
+      if (sgi >= 0) {
+        close(sgi);
+      }
+      break;
+    }
+
+    int s1u    = socket(AF_INET, SOCK_DGRAM, 0);
+    int enable = 1;
+    if (s1u < 0 or setsockopt(s1u, SOL_SOCKET, SO_REUSEPORT, &enable, sizeof(int)) < 0 or
+        bind(s1u, (struct sockaddr*)&m_s1u_addr, sizeof(struct sockaddr_in)) < 0) {
+      m_logger.error("Failed to open S1-U socket %d: %s", i, strerror(errno));
+      close(sgi);
+      if (s1u >= 0) {
+        close(s1u);
+      }
+      break;
+    }
+    fds.emplace_back(sgi, s1u);
+  }
+  if (fds.size() < nof_workers) {
+    for (uint32_t i = 1; i < fds.size(); ++i) {
+      close(fds[i].first);
+      close(fds[i].second);
+    }
+    return SRSRAN_ERROR_CANT_START;
+  }
+
+#ifdef SO_ATTACH_REUSEPORT_CBPF
+  // Shard the S1-U traffic by TEID, so that every UE is always served by the same worker. The kernel hands the UDP
+  // payload to the filter, and picks the socket with the returned index, following the bind order.
+  struct sock_filter code[] = {
+      {BPF_LD | BPF_W | BPF_ABS, 0, 0, 4},           // A = TEID
+      {BPF_ALU | BPF_MOD | BPF_K, 0, 0, nof_workers}, // A = A % nof_workers
+      {BPF_RET | BPF_A, 0, 0, 0},                     // return A
+  };
+  struct sock_fprog prog = {};
+  prog.len               = sizeof(code) / sizeof(code[0]);
+  prog.filter            = code;
+  if (setsockopt(m_s1u, SOL_SOCKET, SO_ATTACH_REUSEPORT_CBPF, &prog, sizeof(prog)) < 0) {
+    m_logger.warning("Failed to attach TEID sharding filter, S1-U traffic is spread by flow: %s", strerror(errno));
+  }
+#endif
+
+  for (uint32_t i = 0; i < nof_workers; ++i) {
+    m_workers.emplace_back(new worker(this, i, fds[i].first, fds[i].second, args->gtpu_io_batch_size));
+  }
+  publish_tunnel_tables();
+  for (std::unique_ptr<worker>& w : m_workers) {
+    w->start_worker();
+  }
+
+  m_logger.info("Initialized %d GTP-U workers", nof_workers);
+  srsran::console("SPGW GTP-U running %d workers.\n", nof_workers);
+  return SRSRAN_SUCCESS;
+}
+
+void spgw::gtpu::defer_sgi_pdu(srsran::unique_byte_buffer_t msg)
+{
+  {
+    std::lock_guard<std::mutex> lock(m_deferred_mutex);
+    m_deferred_sgi_pdus.push_back(std::move(msg));
+  }
+  // Wake up the SP-GW thread. A full pipe means it is already due to wake up
+  char c = 0;
+  if (write(m_deferred_pipe[1], &c, 1) < 0 and errno != EAGAIN) {
+    m_logger.error("Could not notify deferred SGi PDU: %s", strerror(errno));
+  }
+}
+
+void spgw::gtpu::handle_deferred_sgi_pdus()
+{
+  char buf[64];
+  while (read(m_deferred_pipe[0], buf, sizeof(buf)) > 0) {
+  }
+
+  std::vector<srsran::unique_byte_buffer_t> pdus;
+  {
+    std::lock_guard<std::mutex> lock(m_deferred_mutex);
+    pdus.swap(m_deferred_sgi_pdus);
+  }
+  for (srsran::unique_byte_buffer_t& msg : pdus) {
+    handle_sgi_pdu(std::move(msg));
+  }
+}
+
+spgw::gtpu::sgi_route_t spgw::gtpu::route_sgi_pdu(const tunnel_tables_t& tables,
+                                                  srsran::byte_buffer_t* msg,
+                                                  srsran::gtp_fteid_t*   enb_fteid,
+                                                  uint32_t*              spgw_teid)
 {
   bool usr_found = false;
   bool ctr_found = false;
 
-  std::map<uint32_t, srsran::gtpc_f_teid_ie>::iterator gtpu_fteid_it;
-  std::map<in_addr_t, uint32_t>::iterator              gtpc_teid_it;
-  srsran::gtpc_f_teid_ie                               enb_fteid;
-  uint32_t                                             spgw_teid;
-  struct iphdr*                                        iph = (struct iphdr*)msg->msg;
+  std::map<uint32_t, srsran::gtpc_f_teid_ie>::const_iterator gtpu_fteid_it;
+  std::map<in_addr_t, uint32_t>::const_iterator              gtpc_teid_it;
+  struct iphdr*                                              iph = (struct iphdr*)msg->msg;
   m_logger.debug("Received SGi PDU. Bytes %d", msg->N_bytes);
 
   if (iph->version != 4) {
     m_logger.info("IPv6 not supported yet.");
-    return;
+    return sgi_route_t::drop;
   }
   if (ntohs(iph->tot_len) < 20) {
     m_logger.warning("Invalid IP header length. IP length %d.", ntohs(iph->tot_len));
-    return;
+    return sgi_route_t::drop;
   }
 
   // Logging PDU info
@@ -234,41 +510,64 @@ void spgw::gtpu::handle_sgi_pdu(srsran::unique_byte_buffer_t msg)
   m_logger.debug("SGi PDU -- IP dst addr %s", srsran::to_c_str(buffer));
 
   // Find user and control tunnel
-  gtpu_fteid_it = m_ip_to_usr_teid.find(iph->daddr);
-  if (gtpu_fteid_it != m_ip_to_usr_teid.end()) {
-    usr_found = true;
-    enb_fteid = gtpu_fteid_it->second;
+  gtpu_fteid_it = tables.ip_to_usr_teid.find(iph->daddr);
+  if (gtpu_fteid_it != tables.ip_to_usr_teid.end()) {
+    usr_found  = true;
+    *enb_fteid = gtpu_fteid_it->second;
   }
-  gtpc_teid_it = m_ip_to_ctr_teid.find(iph->daddr);
-  if (gtpc_teid_it != m_ip_to_ctr_teid.end()) {
-    ctr_found = true;
-    spgw_teid = gtpc_teid_it->second;
+  gtpc_teid_it = tables.ip_to_ctr_teid.find(iph->daddr);
+  if (gtpc_teid_it != tables.ip_to_ctr_teid.end()) {
+    ctr_found  = true;
+    *spgw_teid = gtpc_teid_it->second;
   }
 
-  // Handle SGi packet
+  // Route SGi packet
   if (usr_found == false && ctr_found == false) {
     m_logger.debug("Packet for unknown UE.");
   } else if (usr_found == false && ctr_found == true) {
     m_logger.debug("Packet for attached UE that is not ECM connected.");
-    m_logger.debug("Triggering Donwlink Notification Requset.");
-    m_gtpc->send_downlink_data_notification(spgw_teid);
-    m_gtpc->queue_downlink_packet(spgw_teid, std::move(msg));
-    return;
+    return sgi_route_t::paging;
   } else if (usr_found == true && ctr_found == false) {
     m_logger.error("User plane tunnel found without a control plane tunnel present.");
   } else {
-    send_s1u_pdu(enb_fteid, msg.get());
+    return sgi_route_t::s1u;
+  }
+  return sgi_route_t::drop;
+}
+
+void spgw::gtpu::handle_sgi_pdu(srsran::unique_byte_buffer_t msg)
+{
+  srsran::gtpc_f_teid_ie enb_fteid;
+  uint32_t               spgw_teid;
+
+  // Only the SP-GW thread modifies the tunnel tables, so it reads them without locking
+  switch (route_sgi_pdu(m_tunnel_tables, msg.get(), &enb_fteid, &spgw_teid)) {
+    case sgi_route_t::paging:
+      m_logger.debug("Triggering Donwlink Notification Requset.");
+      m_gtpc->send_downlink_data_notification(spgw_teid);
+      m_gtpc->queue_downlink_packet(spgw_teid, std::move(msg));
+      break;
+    case sgi_route_t::s1u:
+      send_s1u_pdu(enb_fteid, msg.get());
+      break;
+    default:
+      break;
   }
 }
 
 void spgw::gtpu::handle_s1u_pdu(srsran::byte_buffer_t* msg)
+{
+  handle_s1u_pdu(msg, m_sgi);
+}
+
+void spgw::gtpu::handle_s1u_pdu(srsran::byte_buffer_t* msg, int sgi)
 {
   srsran::gtpu_header_t header;
   srsran::gtpu_read_header(msg, &header, m_logger);
 
   m_logger.debug("Received PDU from S1-U. Bytes=%d", msg->N_bytes);
   m_logger.debug("TEID 0x%x. Bytes=%d", header.teid, msg->N_bytes);
-  int n = write(m_sgi, msg->msg, msg->N_bytes);
+  int n = write(sgi, msg->msg, msg->N_bytes);
   if (n < 0) {
     m_logger.error("Could not write to TUN interface.");
   } else {
@@ -277,13 +576,14 @@ void spgw::gtpu::handle_s1u_pdu(srsran::byte_buffer_t* msg)
   return;
 }
 
-void spgw::gtpu::send_s1u_pdu(srsran::gtp_fteid_t enb_fteid, srsran::byte_buffer_t* msg)
+bool spgw::gtpu::write_s1u_header(const srsran::gtp_fteid_t& enb_fteid,
+                                  srsran::byte_buffer_t*     msg,
+                                  struct sockaddr_in*        enb_addr)
 {
   // Set eNB destination address
-  struct sockaddr_in enb_addr;
-  enb_addr.sin_family      = AF_INET;
-  enb_addr.sin_port        = htons(GTPU_RX_PORT);
-  enb_addr.sin_addr.s_addr = enb_fteid.ipv4;
+  enb_addr->sin_family      = AF_INET;
+  enb_addr->sin_port        = htons(GTPU_RX_PORT);
+  enb_addr->sin_addr.s_addr = enb_fteid.ipv4;
 
   // Setup GTP-U header
   srsran::gtpu_header_t header;
@@ -292,13 +592,26 @@ void spgw::gtpu::send_s1u_pdu(srsran::gtp_fteid_t enb_fteid, srsran::byte_buffer
   header.length       = msg->N_bytes;
   header.teid         = enb_fteid.teid;
 
-  m_logger.debug("User plane tunnel found SGi PDU. Forwarding packet to S1-U.");
-  m_logger.debug("eNB F-TEID -- eNB IP %s, eNB TEID 0x%x.", inet_ntoa(enb_addr.sin_addr), enb_fteid.teid);
+  if (m_logger.debug.enabled()) {
+    fmt::memory_buffer buffer;
+    srsran::gtpu_ntoa(buffer, enb_fteid.ipv4);
+    m_logger.debug("User plane tunnel found SGi PDU. Forwarding packet to S1-U.");
+    m_logger.debug("eNB F-TEID -- eNB IP %s, eNB TEID 0x%x.", srsran::to_c_str(buffer), enb_fteid.teid);
+  }
 
-  // Write header into packet
-  int n;
+  // Write header into packet, in the headroom of the byte buffer
   if (!srsran::gtpu_write_header(&header, msg, m_logger)) {
     m_logger.error("Error writing GTP-U header on PDU");
+    return false;
+  }
+  return true;
+}
+
+void spgw::gtpu::send_s1u_pdu(srsran::gtp_fteid_t enb_fteid, srsran::byte_buffer_t* msg)
+{
+  struct sockaddr_in enb_addr;
+  int                n;
+  if (not write_s1u_header(enb_fteid, msg, &enb_addr)) {
     goto out;
   }
 
@@ -340,33 +653,47 @@ bool spgw::gtpu::modify_gtpu_tunnel(in_addr_t ue_ipv4, srsran::gtpc_f_teid_ie dw
   srsran::gtpu_ntoa(buffer, dw_user_fteid.ipv4);
   m_logger.info("Downlink eNB addr %s, U-TEID 0x%x", srsran::to_c_str(buffer), dw_user_fteid.teid);
   m_logger.info("Uplink C-TEID: 0x%x", up_ctrl_teid);
-  m_ip_to_usr_teid[ue_ipv4] = dw_user_fteid;
-  m_ip_to_ctr_teid[ue_ipv4] = up_ctrl_teid;
+  m_tunnel_tables.ip_to_usr_teid[ue_ipv4] = dw_user_fteid;
+  m_tunnel_tables.ip_to_ctr_teid[ue_ipv4] = up_ctrl_teid;
+  publish_tunnel_tables();
   return true;
 }
 
 bool spgw::gtpu::delete_gtpu_tunnel(in_addr_t ue_ipv4)
 {
   // Remove GTP-U connections, if any.
-  if (m_ip_to_usr_teid.count(ue_ipv4)) {
-    m_ip_to_usr_teid.erase(ue_ipv4);
-  } else {
+  if (m_tunnel_tables.ip_to_usr_teid.erase(ue_ipv4) == 0) {
     m_logger.error("Could not find GTP-U Tunnel to delete.");
     return false;
   }
+  publish_tunnel_tables();
   return true;
 }
 
 bool spgw::gtpu::delete_gtpc_tunnel(in_addr_t ue_ipv4)
 {
   // Remove Ctrl TEID from IP mapping.
-  if (m_ip_to_ctr_teid.count(ue_ipv4)) {
-    m_ip_to_ctr_teid.erase(ue_ipv4);
-  } else {
+  if (m_tunnel_tables.ip_to_ctr_teid.erase(ue_ipv4) == 0) {
     m_logger.error("Could not find GTP-C Tunnel info to delete.");
     return false;
   }
+  publish_tunnel_tables();
   return true;
 }
 
+void spgw::gtpu::publish_tunnel_tables()
+{
+  // Without workers, the SP-GW thread routes the SGi PDUs from its own tables
+  if (m_workers.empty()) {
+    return;
+  }
+  // Workers still routing with the previous snapshot keep it alive until they load the new one
+  std::atomic_store(&m_tunnel_snapshot, std::shared_ptr<const tunnel_tables_t>(new tunnel_tables_t(m_tunnel_tables)));
+}
+
+std::shared_ptr<const spgw::gtpu::tunnel_tables_t> spgw::gtpu::get_tunnel_snapshot() const
+{
+  return std::atomic_load(&m_tunnel_snapshot);
+}
+
 } // namespace srsepc
@@ -111,22 +111,31 @@ void spgw::run_thread()
   struct sockaddr_un src_addr_un;
   struct iphdr*      ip_pkt;
 
-  int sgi = m_gtpu->get_sgi();
-  int s1u = m_gtpu->get_s1u();
-  int s11 = m_gtpc->get_s11();
+  int sgi      = m_gtpu->get_sgi();
+  int s1u      = m_gtpu->get_s1u();
+  int s11      = m_gtpc->get_s11();
+  int deferred = m_gtpu->get_deferred_sgi();
+
+  // With user plane workers, only the SGi PDUs of UEs to be paged are handled here
+  bool user_plane = m_gtpu->get_nof_workers() == 0;
 
   size_t buf_len = SRSRAN_MAX_BUFFER_SIZE_BYTES - SRSRAN_BUFFER_HEADER_OFFSET;
 
   fd_set set;
   int    max_fd = std::max(s1u, sgi);
   max_fd        = std::max(max_fd, s11);
+  max_fd        = std::max(max_fd, deferred);
   while (m_running) {
     s1u_msg->clear();
     s11_msg->clear();
 
     FD_ZERO(&set);
-    FD_SET(s1u, &set);
-    FD_SET(sgi, &set);
+    if (user_plane) {
+      FD_SET(s1u, &set);
+      FD_SET(sgi, &set);
+    } else {
+      FD_SET(deferred, &set);
+    }
     FD_SET(s11, &set);
 
     int n = select(max_fd + 1, &set, NULL, NULL, NULL);
@@ -153,6 +162,9 @@ void spgw::run_thread()
         s1u_msg->N_bytes  = recvfrom(s1u, s1u_msg->msg, buf_len, 0, (struct sockaddr*)&src_addr_in, &addrlen);
         m_gtpu->handle_s1u_pdu(s1u_msg.get());
       }
+      if (not user_plane and FD_ISSET(deferred, &set)) {
+        m_gtpu->handle_deferred_sgi_pdus();
+      }
       if (FD_ISSET(s11, &set)) {
         m_logger.debug("Message received at SPGW: S11 Message");
         socklen_t addrlen = sizeof(src_addr_un);
@@ -0,0 +1,190 @@
+/**
+ * Copyright 2013-2021 Software Radio Systems Limited
+ *
+ * This file is part of srsRAN.
+ *
+ * srsRAN is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsRAN is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+#include "srsepc/hdr/hss/hss.h"
+#include "srsran/common/string_helpers.h"
+#include "srsran/common/test_common.h"
+#include <chrono>
+#include <fstream>
+
+namespace srsepc {
+
+static const char* db_file    = "hss_benchmark_db.csv";
+static const char* store_file = "hss_benchmark_db.store";
+
+static const uint64_t first_imsi = 1010000000000ULL;
+
+struct run_params {
+  uint32_t nof_ues;
+  uint32_t nof_bursts; ///< Every UE authenticates once per burst
+  bool     store;
+};
+
+struct run_data {
+  run_params                   params;
+  float                        vectors_per_sec;
+  std::chrono::duration<float> csv_write_time;
+};
+
+static void write_db(uint32_t nof_ues)
+{
+  std::ofstream file(db_file);
+  for (uint32_t i = 0; i < nof_ues; ++i) {
+    file << "ue" << i << ",mil,00" << first_imsi + i << ",00112233445566778899aabbccddeeff,opc,"
+         << "63bfa50ee6523365ff14c1f45f88737d,8000,000000001234,7,dynamic\n";
+  }
+}
+
+/// Reads the SQN column of the user database, in IMSI order
+static std::vector<std::string> read_db_sqns()
+{
+  std::ifstream            file(db_file);
+  std::vector<std::string> sqns;
+  std::string              line;
+  while (std::getline(file, line)) {
+    if (line.length() > 0 and line[0] != '#') {
+      sqns.push_back(srsran::split_string(line, ',')[7]);
+    }
+  }
+  return sqns;
+}
+
+static hss* init_hss(bool store)
+{
+  hss_args_t args;
+  args.db_file  = db_file;
+  args.db_store = store ? store_file : "";
+  args.mcc      = 0xf001;
+  args.mnc      = 0xff01;
+  hss* h        = hss::get_instance();
+  return h->init(&args) == 0 ? h : nullptr;
+}
+
+static void run_bursts(hss* h, const run_params& params)
+{
+  uint8_t k_asme[32], autn[16], rand[16], xres[16];
+  for (uint32_t b = 0; b < params.nof_bursts; ++b) {
+    for (uint32_t i = 0; i < params.nof_ues; ++i) {
+      h->gen_auth_info_answer(first_imsi + i, k_asme, autn, rand, xres);
+    }
+  }
+}
+
+/**
+ * Runs params.nof_bursts attach bursts of params.nof_ues UEs, each UE generating one authentication vector per burst.
+ * With the store, the EPC is then restarted without writing the user database, which must still end up with the same
+ * SQNs as a clean run
+ */
+int run_hss_scenario(const run_params& params, std::vector<run_data>& run_results)
+{
+  write_db(params.nof_ues);
+  remove(store_file);
+
+  hss* h = init_hss(params.store);
+  TESTASSERT(h != nullptr);
+
+  auto tp_start = std::chrono::steady_clock::now();
+  run_bursts(h, params);
+  std::chrono::duration<float> tot_time = std::chrono::steady_clock::now() - tp_start;
+
+  run_data r;
+  r.params          = params;
+  r.vectors_per_sec = (float)params.nof_ues * params.nof_bursts / tot_time.count();
+
+  if (params.store) {
+    // TEST: a crash loses no SQN update
+    hss::cleanup();
+    h = init_hss(true);
+    TESTASSERT(h != nullptr);
+    run_bursts(h, params);
+  } else {
+    run_bursts(h, params);
+  }
+
+  tp_start = std::chrono::steady_clock::now();
+  h->stop();
+  r.csv_write_time = std::chrono::steady_clock::now() - tp_start;
+  hss::cleanup();
+  run_results.push_back(r);
+
+  // Both runs authenticate every UE 2 * nof_bursts times, so they end with the same SQNs
+  static std::vector<std::string> ref_sqns;
+  std::vector<std::string>        sqns = read_db_sqns();
+  TESTASSERT(sqns.size() == params.nof_ues);
+  if (not params.store) {
+    ref_sqns = sqns;
+  } else {
+    TESTASSERT(sqns == ref_sqns);
+  }
+
+  remove(db_file);
+  remove(store_file);
+  return SRSRAN_SUCCESS;
+}
+
+void print_benchmark_results(const std::vector<run_data>& run_results)
+{
+  fmt::print("run |    UEs | bursts | store | vectors/s | CSV write [ms]\n");
+  fmt::print("---------------------------------------------------------\n");
+  for (uint32_t i = 0; i < run_results.size(); ++i) {
+    const run_data& r = run_results[i];
+    fmt::print("{:>3d}{:>9d}{:>9d}{:>8s}{:>12.0f}{:>17.2f}\n",
+               i,
+               r.params.nof_ues,
+               r.params.nof_bursts,
+               r.params.store ? "yes" : "no",
+               r.vectors_per_sec,
+               r.csv_write_time.count() * 1e3);
+  }
+}
+
+int run_benchmark(const std::vector<uint32_t>& nof_ues_list, uint32_t nof_bursts)
+{
+  std::vector<run_data> run_results;
+  for (uint32_t nof_ues : nof_ues_list) {
+    for (bool store : {false, true}) {
+      run_params params = {nof_ues, nof_bursts, store};
+      TESTASSERT(run_hss_scenario(params, run_results) == SRSRAN_SUCCESS);
+    }
+  }
+
+  print_benchmark_results(run_results);
+
+  return SRSRAN_SUCCESS;
+}
+
+} // namespace srsepc
+
+int main(int argc, char* argv[])
+{
+  srslog::fetch_basic_logger("HSS").set_level(srslog::basic_levels::warning);
+
+  // Start the log backend.
+  srslog::init();
+
+  if (argc == 1 or strcmp(argv[1], "test") == 0) {
+    TESTASSERT(srsepc::run_benchmark({100, 1000}, 2) == SRSRAN_SUCCESS);
+  } else {
+    TESTASSERT(srsepc::run_benchmark({1000, 10000, 50000}, 4) == SRSRAN_SUCCESS);
+  }
+
+  return 0;
+}
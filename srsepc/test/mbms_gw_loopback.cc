@@ -0,0 +1,245 @@
+/**
+ * Copyright 2013-2021 Software Radio Systems Limited
+ *
+ * This file is part of srsRAN.
+ *
+ * srsRAN is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsRAN is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+/******************************************************************************
+ * File:        mbms_gw_loopback.cc
+ * Description: TUN loopback benchmark for the MBMS-GW forwarding path. Runs the
+ *              MBMS-GW in-process, offers UDP packets to its SGi-mb TUN device
+ *              and receives the GTP-U encapsulated packets on M1-U, for
+ *              several I/O batch sizes.
+ *****************************************************************************/
+
+#include "srsepc/hdr/mbms-gw/mbms-gw.h"
+#include "srsran/common/test_common.h"
+#include <arpa/inet.h>
+#include <chrono>
+#include <fcntl.h>
+#include <linux/if.h>
+#include <linux/if_tun.h>
+#include <poll.h>
+#include <sys/ioctl.h>
+
+namespace srsepc {
+
+static const char*    sgi_mb_if_name = "srs_mbms_lb";
+static const char*    sgi_mb_if_addr = "172.16.251.1";
+static const char*    service_addr   = "172.16.251.2"; ///< Destination of the multicast service, routed into SGi-mb
+static const uint16_t service_port   = 5000;
+static const char*    m1u_addr       = "127.0.1.102"; ///< Unicast, as multicast loopback is disabled on M1-U
+static const uint32_t mbms_teid      = 0xAAAA;
+static const int      idle_ms        = 200; ///< Packets not received after this long are lost
+static const uint32_t window         = 256; ///< Packets in flight, below the queue length of the TUN device
+
+struct run_params {
+  uint32_t io_batch_size;
+  uint32_t nof_pkts;
+  uint32_t pkt_size; ///< Size of the UDP payload
+};
+
+struct run_data {
+  run_params        params;
+  float             kpps;
+  float             loss;
+  mbms_gw_metrics_t metrics;
+};
+
+/// Sends the standard output, where the MBMS-GW prints its configuration, to /dev/null. Returns the saved stdout
+static int mute_stdout()
+{
+  fflush(stdout);
+  int saved   = dup(STDOUT_FILENO);
+  int null_fd = open("/dev/null", O_WRONLY);
+  dup2(null_fd, STDOUT_FILENO);
+  close(null_fd);
+  return saved;
+}
+
+static void restore_stdout(int saved)
+{
+  fflush(stdout);
+  dup2(saved, STDOUT_FILENO);
+  close(saved);
+}
+
+/**
+ * Sends params.nof_pkts UDP packets to the MBMS service address, with up to window packets in flight, and receives
+ * them on M1-U, checking the GTP-U header of each one. The rate is measured from the first packet sent to the last
+ * one received
+ */
+int run_loopback_scenario(const run_params& params, std::vector<run_data>& run_results)
+{
+  // eNB side of M1-U
+  struct sockaddr_in enb_addr = {};
+  TESTASSERT(srsran::net_utils::set_sockaddr(&enb_addr, m1u_addr, GTPU_RX_PORT + 1));
+  int enb_fd = socket(AF_INET, SOCK_DGRAM, 0);
+  TESTASSERT(bind(enb_fd, (const struct sockaddr*)&enb_addr, sizeof(enb_addr)) == 0);
+
+  mbms_gw_args_t args = {};
+  args.name           = "srsmbmsgw01";
+  args.sgi_mb_if_name = sgi_mb_if_name;
+  args.sgi_mb_if_addr = sgi_mb_if_addr;
+  args.sgi_mb_if_mask = "255.255.255.0";
+  args.m1u_multi_addr = m1u_addr;
+  args.m1u_multi_if   = "127.0.0.1";
+  args.m1u_multi_ttl  = 1;
+  args.io_batch_size  = params.io_batch_size;
+
+  int      saved_stdout = mute_stdout();
+  mbms_gw* gw           = mbms_gw::get_instance();
+  run_data r            = {};
+  r.params              = params;
+  bool ret              = gw->init(&args) == SRSRAN_SUCCESS;
+  restore_stdout(saved_stdout);
+  if (ret) {
+    gw->start();
+
+    int                  app_fd  = socket(AF_INET, SOCK_DGRAM, 0);
+    struct sockaddr_in   service = {};
+    std::vector<uint8_t> payload(params.pkt_size);
+    TESTASSERT(srsran::net_utils::set_sockaddr(&service, service_addr, service_port));
+
+    uint32_t nof_sent = 0, nof_valid = 0, nof_invalid = 0, nof_lost = 0;
+    uint8_t  buf[2048];
+    auto     t_start = std::chrono::steady_clock::now();
+    auto     t_last  = t_start;
+    while (true) {
+      // Keep at most window packets in flight, so that the sender does not overflow the TUN queue
+      while (nof_sent < params.nof_pkts and nof_sent - nof_valid - nof_invalid - nof_lost < window) {
+        sendto(app_fd, payload.data(), payload.size(), 0, (const struct sockaddr*)&service, sizeof(service));
+        nof_sent++;
+      }
+      struct pollfd pfd = {enb_fd, POLLIN, 0};
+      if (poll(&pfd, 1, idle_ms) <= 0) {
+        // The packets still in flight were lost
+        nof_lost = nof_sent - nof_valid - nof_invalid;
+        if (nof_sent == params.nof_pkts) {
+          break;
+        }
+        continue;
+      }
+      ssize_t n;
+      while ((n = recv(enb_fd, buf, sizeof(buf), MSG_DONTWAIT)) > 0) {
+        // GTP-U header, followed by the IP and UDP headers and the payload
+        uint32_t teid = ntohl(*(const uint32_t*)&buf[4]);
+        if (teid == mbms_teid and n == (ssize_t)(GTPU_BASE_HEADER_LEN + 28 + params.pkt_size)) {
+          nof_valid++;
+        } else {
+          nof_invalid++;
+        }
+      }
+      t_last = std::chrono::steady_clock::now();
+    }
+    close(app_fd);
+
+    gw->get_metrics(r.metrics);
+    gw->stop();
+
+    float elapsed_s = std::chrono::duration<float>(t_last - t_start).count();
+    r.kpps          = nof_valid / std::max(elapsed_s, 1e-6f) / 1000;
+    r.loss          = 100.0f * (params.nof_pkts - nof_valid) / params.nof_pkts;
+
+    // Every packet sent to M1-U is accounted as read and not dropped. The kernel may also route its own IPv6
+    // packets into SGi-mb, which are dropped and not accounted in any flow
+    TESTASSERT(nof_invalid == 0);
+    TESTASSERT(nof_valid > 0);
+    TESTASSERT(r.metrics.teid == mbms_teid);
+    TESTASSERT(r.metrics.nof_packets - r.metrics.nof_dropped >= nof_valid);
+    TESTASSERT(r.metrics.max_batch_size <= params.io_batch_size);
+    TESTASSERT(r.metrics.flows.size() == 1);
+    TESTASSERT(r.metrics.flows[0].dst_port == service_port);
+    TESTASSERT(r.metrics.flows[0].nof_packets <= r.metrics.nof_packets);
+  }
+  mbms_gw::cleanup();
+  close(enb_fd);
+
+  TESTASSERT(ret);
+  run_results.push_back(r);
+  return SRSRAN_SUCCESS;
+}
+
+void print_benchmark_results(const std::vector<run_data>& run_results)
+{
+  fmt::print("run | batch |   pkts | size |  kpps | loss [%] | SGi-mb pkts | dropped | wakeups | full batches\n");
+  fmt::print("-------------------------------------------------------------------------------------------------\n");
+  for (uint32_t i = 0; i < run_results.size(); ++i) {
+    const run_data& r = run_results[i];
+    fmt::print("{:>3d}{:>8d}{:>9d}{:>7d}{:>8.1f}{:>11.1f}{:>14d}{:>10d}{:>10d}{:>15d}\n",
+               i,
+               r.params.io_batch_size,
+               r.params.nof_pkts,
+               r.params.pkt_size,
+               r.kpps,
+               r.loss,
+               r.metrics.nof_packets,
+               r.metrics.nof_dropped,
+               r.metrics.nof_wakeups,
+               r.metrics.nof_full_batches);
+  }
+}
+
+static bool tun_available()
+{
+  int fd = open("/dev/net/tun", O_RDWR);
+  if (fd < 0) {
+    return false;
+  }
+  struct ifreq ifr = {};
+  ifr.ifr_flags    = IFF_TUN | IFF_NO_PI;
+  bool ret         = ioctl(fd, TUNSETIFF, &ifr) == 0;
+  close(fd);
+  return ret;
+}
+
+int run_benchmark(const std::vector<uint32_t>& io_batch_sizes, uint32_t nof_pkts)
+{
+  if (not tun_available()) {
+    fmt::print("TUN devices are not available ({}), skipping the MBMS-GW loopback\n", strerror(errno));
+    return SRSRAN_SUCCESS;
+  }
+
+  std::vector<run_data> run_results;
+  for (uint32_t io_batch_size : io_batch_sizes) {
+    run_params params = {io_batch_size, nof_pkts, 1024};
+    TESTASSERT(run_loopback_scenario(params, run_results) == SRSRAN_SUCCESS);
+  }
+
+  print_benchmark_results(run_results);
+
+  return SRSRAN_SUCCESS;
+}
+
+} // namespace srsepc
+
+int main(int argc, char* argv[])
+{
+  srslog::fetch_basic_logger("MBMS").set_level(srslog::basic_levels::warning);
+
+  // Start the log backend.
+  srslog::init();
+
+  if (argc == 1 or strcmp(argv[1], "test") == 0) {
+    TESTASSERT(srsepc::run_benchmark({1, 32}, 10000) == SRSRAN_SUCCESS);
+  } else {
+    TESTASSERT(srsepc::run_benchmark({1, 8, 32, 64}, 500000) == SRSRAN_SUCCESS);
+  }
+
+  return 0;
+}
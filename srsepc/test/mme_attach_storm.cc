@@ -0,0 +1,778 @@
+/**
+ * Copyright 2013-2021 Software Radio Systems Limited
+ *
+ * This file is part of srsRAN.
+ *
+ * srsRAN is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsRAN is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+/******************************************************************************
+ * File:        mme_attach_storm.cc
+ * Description: Attach storm generator. Runs the MME and the HSS in-process and
+ *              emulates the eNBs over SCTP, the UEs on top of them and the
+ *              SP-GW on S11, to measure the attach rate and latency of the MME
+ *              for several numbers of NAS workers.
+ *****************************************************************************/
+
+#include "srsepc/hdr/hss/hss.h"
+#include "srsepc/hdr/mme/mme.h"
+#include "srsran/asn1/gtpc.h"
+#include "srsran/common/bcd_helpers.h"
+#include "srsran/common/network_utils.h"
+#include "srsran/common/security.h"
+#include "srsran/common/test_common.h"
+#include <algorithm>
+#include <chrono>
+#include <deque>
+#include <fcntl.h>
+#include <fstream>
+#include <inttypes.h>
+#include <poll.h>
+
+namespace srsepc {
+
+static const char* db_file = "mme_attach_storm_db.csv";
+
+static const uint64_t first_imsi   = 1010000000000ULL;
+static const uint16_t mcc          = 0xf001;
+static const uint16_t mnc          = 0xff01;
+static const uint16_t tac          = 7;
+static const uint32_t nof_enbs     = 4;
+static const uint32_t max_inflight = 128; ///< Attaches in progress at any time
+static const uint32_t s1ap_ppid    = 18;
+static const float    timeout_s    = 5; ///< Maximum time without any attach completing
+
+static uint8_t ue_k[16]   = {0x00, 0x11, 0x22, 0x33, 0x44, 0x55, 0x66, 0x77,
+                             0x88, 0x99, 0xaa, 0xbb, 0xcc, 0xdd, 0xee, 0xff};
+static uint8_t ue_opc[16] = {0x63, 0xbf, 0xa5, 0x0e, 0xe6, 0x52, 0x33, 0x65,
+                             0xff, 0x14, 0xc1, 0xf4, 0x5f, 0x88, 0x73, 0x7d};
+
+struct run_params {
+  uint32_t nof_workers;
+  uint32_t nof_ues;
+};
+
+struct run_data {
+  run_params params;
+  float      attaches_per_sec;
+  float      avg_latency_ms;
+  float      p50_latency_ms;
+  float      p99_latency_ms;
+};
+
+static void write_db(uint32_t nof_ues)
+{
+  std::ofstream file(db_file);
+  for (uint32_t i = 0; i < nof_ues; ++i) {
+    file << "ue" << i << ",mil,00" << first_imsi + i << ",00112233445566778899aabbccddeeff,opc,"
+         << "63bfa50ee6523365ff14c1f45f88737d,8000,000000001234,7,dynamic\n";
+  }
+}
+
+/// Sends the standard output, where the EPC prints every message, to /dev/null. Returns the saved standard output
+static int mute_stdout()
+{
+  fflush(stdout);
+  int saved   = dup(STDOUT_FILENO);
+  int null_fd = open("/dev/null", O_WRONLY);
+  dup2(null_fd, STDOUT_FILENO);
+  close(null_fd);
+  return saved;
+}
+
+static void restore_stdout(int saved)
+{
+  fflush(stdout);
+  dup2(saved, STDOUT_FILENO);
+  close(saved);
+}
+
+static bool set_unix_addr(struct sockaddr_un* addr, const char* name)
+{
+  memset(addr, 0, sizeof(struct sockaddr_un));
+  addr->sun_family = AF_UNIX;
+  snprintf(addr->sun_path, sizeof(addr->sun_path), "%s", name);
+  addr->sun_path[0] = '\0';
+  return true;
+}
+
+/**
+ * Emulates nof_enbs eNBs connected to the MME, the UEs attaching through them and the SP-GW. Keeps max_inflight
+ * attaches in progress until all the UEs are attached. The latency of an attach goes from the Initial UE Message
+ * with the Attach Request to the EMM Information that follows the Attach Complete
+ */
+class attach_storm
+{
+public:
+  attach_storm(const run_params& params_, const std::string& mme_addr_) : params(params_), mme_addr_str(mme_addr_)
+  {
+    std::fill(enb_fds, enb_fds + nof_enbs, -1);
+  }
+  ~attach_storm();
+
+  bool init();
+  bool run(run_data& r);
+
+private:
+  struct storm_ue {
+    uint64_t                              imsi;
+    uint32_t                              enb_idx;
+    uint32_t                              mme_ue_s1ap_id;
+    uint8_t                               k_asme[32];
+    uint8_t                               k_nas_int[32];
+    std::chrono::steady_clock::time_point t_start;
+  };
+
+  bool send_s1ap(uint32_t enb_idx, const asn1::s1ap::s1ap_pdu_c& pdu);
+  bool send_s1_setup_request(uint32_t enb_idx);
+  bool send_attach_request(uint32_t ue_idx);
+  bool send_ul_nas(uint32_t ue_idx, srsran::byte_buffer_t* nas);
+  bool send_authentication_response(uint32_t ue_idx, srsran::byte_buffer_t* nas);
+  bool send_security_mode_complete(uint32_t ue_idx);
+  bool send_initial_context_setup_response(uint32_t ue_idx);
+  bool send_attach_complete(uint32_t ue_idx);
+  void mac_generate(uint32_t ue_idx, srsran::byte_buffer_t* nas, uint32_t count);
+
+  bool handle_enb_rx(uint32_t enb_idx);
+  bool handle_dl_nas_transport(const asn1::s1ap::dl_nas_transport_s& msg);
+  void handle_sgw_rx();
+  void flush_sgw_tx();
+
+  void fill_tai_and_cgi(asn1::s1ap::tai_s& tai, asn1::s1ap::eutran_cgi_s& cgi);
+
+  run_params                   params;
+  std::string                  mme_addr_str;
+  struct sockaddr_in           mme_addr = {};
+  int                          enb_fds[nof_enbs];
+  int                          sgw_fd = -1;
+  struct sockaddr_un           mme_s11_addr;
+  std::deque<srsran::gtpc_pdu> sgw_tx_queue; ///< S11 replies waiting for room in the MME socket
+  uint32_t                     nof_enbs_setup = 0;
+  uint32_t                     next_sgw_teid  = 1;
+
+  std::vector<storm_ue> ues;
+  uint32_t              nof_started = 0;
+  std::vector<float>    latencies_ms; ///< Latency of the attaches completed so far
+};
+
+attach_storm::~attach_storm()
+{
+  for (uint32_t i = 0; i < nof_enbs; ++i) {
+    if (enb_fds[i] != -1) {
+      close(enb_fds[i]);
+    }
+  }
+  if (sgw_fd != -1) {
+    close(sgw_fd);
+  }
+}
+
+bool attach_storm::init()
+{
+  // SP-GW side of S11
+  struct sockaddr_un sgw_addr;
+  set_unix_addr(&sgw_addr, "@spgw_s11");
+  set_unix_addr(&mme_s11_addr, "@mme_s11");
+  sgw_fd = socket(AF_UNIX, SOCK_DGRAM, 0);
+  if (sgw_fd < 0 or bind(sgw_fd, (const struct sockaddr*)&sgw_addr, sizeof(sgw_addr)) != 0) {
+    fprintf(stderr, "Error binding the SP-GW S11 socket: %s\n", strerror(errno));
+    return false;
+  }
+
+  // eNBs
+  if (not srsran::net_utils::set_sockaddr(&mme_addr, mme_addr_str.c_str(), S1MME_PORT)) {
+    return false;
+  }
+  for (uint32_t i = 0; i < nof_enbs; ++i) {
+    enb_fds[i] = socket(AF_INET, SOCK_SEQPACKET, IPPROTO_SCTP);
+    if (enb_fds[i] < 0 or connect(enb_fds[i], (const struct sockaddr*)&mme_addr, sizeof(mme_addr)) != 0) {
+      fprintf(stderr, "Error connecting eNB %d to the MME: %s\n", i, strerror(errno));
+      return false;
+    }
+    if (not send_s1_setup_request(i)) {
+      return false;
+    }
+  }
+
+  ues.resize(params.nof_ues);
+  for (uint32_t i = 0; i < params.nof_ues; ++i) {
+    ues[i].imsi           = first_imsi + i;
+    ues[i].enb_idx        = i % nof_enbs;
+    ues[i].mme_ue_s1ap_id = 0;
+  }
+  latencies_ms.reserve(params.nof_ues);
+  return true;
+}
+
+bool attach_storm::run(run_data& r)
+{
+  struct pollfd fds[nof_enbs + 1];
+  for (uint32_t i = 0; i < nof_enbs; ++i) {
+    fds[i].fd     = enb_fds[i];
+    fds[i].events = POLLIN;
+  }
+  fds[nof_enbs].fd     = sgw_fd;
+  fds[nof_enbs].events = POLLIN;
+
+  std::chrono::steady_clock::time_point tp_start    = {};
+  std::chrono::steady_clock::time_point tp_progress = std::chrono::steady_clock::now();
+  uint32_t                              nof_done    = 0;
+  while (nof_done < params.nof_ues) {
+    // Start the storm once all the eNBs are set up, keeping max_inflight attaches in progress
+    if (nof_enbs_setup == nof_enbs) {
+      if (nof_started == 0) {
+        tp_start = std::chrono::steady_clock::now();
+      }
+      while (nof_started < params.nof_ues and nof_started - nof_done < max_inflight) {
+        if (not send_attach_request(nof_started++)) {
+          return false;
+        }
+      }
+    }
+
+    flush_sgw_tx();
+    int n = poll(fds, nof_enbs + 1, sgw_tx_queue.empty() ? 100 : 1);
+    if (n < 0 and errno != EINTR) {
+      fprintf(stderr, "Error polling the storm sockets: %s\n", strerror(errno));
+      return false;
+    }
+    for (uint32_t i = 0; i < nof_enbs and n > 0; ++i) {
+      if (fds[i].revents & POLLIN and not handle_enb_rx(i)) {
+        return false;
+      }
+    }
+    if (n > 0 and fds[nof_enbs].revents & POLLIN) {
+      handle_sgw_rx();
+    }
+
+    if (latencies_ms.size() != nof_done) {
+      nof_done    = latencies_ms.size();
+      tp_progress = std::chrono::steady_clock::now();
+    } else if (std::chrono::duration<float>(std::chrono::steady_clock::now() - tp_progress).count() > timeout_s) {
+      fprintf(stderr, "Attach storm stalled. Attached UEs: %d/%d\n", nof_done, params.nof_ues);
+      return false;
+    }
+  }
+  std::chrono::duration<float> tot_time = std::chrono::steady_clock::now() - tp_start;
+
+  std::sort(latencies_ms.begin(), latencies_ms.end());
+  float sum = 0;
+  for (float l : latencies_ms) {
+    sum += l;
+  }
+  r.params           = params;
+  r.attaches_per_sec = params.nof_ues / tot_time.count();
+  r.avg_latency_ms   = sum / latencies_ms.size();
+  r.p50_latency_ms   = latencies_ms[latencies_ms.size() / 2];
+  r.p99_latency_ms   = latencies_ms[latencies_ms.size() * 99 / 100];
+  return true;
+}
+
+/*
+ * eNB
+ */
+bool attach_storm::send_s1ap(uint32_t enb_idx, const asn1::s1ap::s1ap_pdu_c& pdu)
+{
+  srsran::unique_byte_buffer_t buf = srsran::make_byte_buffer();
+  if (buf == nullptr) {
+    return false;
+  }
+  asn1::bit_ref bref(buf->msg, buf->get_tailroom());
+  if (pdu.pack(bref) != asn1::SRSASN_SUCCESS) {
+    fprintf(stderr, "Error packing S1AP PDU\n");
+    return false;
+  }
+  buf->N_bytes = bref.distance_bytes();
+
+  ssize_t n_sent = sctp_sendmsg(enb_fds[enb_idx],
+                                buf->msg,
+                                buf->N_bytes,
+                                (struct sockaddr*)&mme_addr,
+                                sizeof(mme_addr),
+                                htonl(s1ap_ppid),
+                                0,
+                                0,
+                                0,
+                                0);
+  if (n_sent == -1) {
+    fprintf(stderr, "Error sending S1AP PDU: %s\n", strerror(errno));
+    return false;
+  }
+  return true;
+}
+
+void attach_storm::fill_tai_and_cgi(asn1::s1ap::tai_s& tai, asn1::s1ap::eutran_cgi_s& cgi)
+{
+  uint32_t plmn;
+  srsran::s1ap_mccmnc_to_plmn(mcc, mnc, &plmn);
+  plmn         = htonl(plmn);
+  uint16_t tmp = htons(tac);
+  memcpy(tai.plm_nid.data(), &((uint8_t*)&plmn)[1], 3);
+  memcpy(tai.tac.data(), &tmp, 2);
+  memcpy(cgi.plm_nid.data(), &((uint8_t*)&plmn)[1], 3);
+  cgi.cell_id.from_number(0x19B01);
+}
+
+bool attach_storm::send_s1_setup_request(uint32_t enb_idx)
+{
+  uint32_t plmn;
+  srsran::s1ap_mccmnc_to_plmn(mcc, mnc, &plmn);
+  plmn         = htonl(plmn);
+  uint16_t tmp = htons(tac);
+
+  asn1::s1ap::s1ap_pdu_c pdu;
+  pdu.set_init_msg().load_info_obj(ASN1_S1AP_ID_S1_SETUP);
+  asn1::s1ap::s1_setup_request_ies_container& container = pdu.init_msg().value.s1_setup_request().protocol_ies;
+  memcpy(container.global_enb_id.value.plm_nid.data(), &((uint8_t*)&plmn)[1], 3);
+  container.global_enb_id.value.enb_id.set_macro_enb_id().from_number(0x19B + enb_idx);
+  container.enbname_present = true;
+  container.enbname.value.from_string("storm" + std::to_string(enb_idx));
+  container.supported_tas.value.resize(1);
+  memcpy(container.supported_tas.value[0].tac.data(), &tmp, 2);
+  container.supported_tas.value[0].broadcast_plmns.resize(1);
+  memcpy(container.supported_tas.value[0].broadcast_plmns[0].data(), &((uint8_t*)&plmn)[1], 3);
+  container.default_paging_drx.value.value = asn1::s1ap::paging_drx_opts::v128;
+  return send_s1ap(enb_idx, pdu);
+}
+
+bool attach_storm::send_attach_request(uint32_t ue_idx)
+{
+  storm_ue& ue = ues[ue_idx];
+
+  LIBLTE_MME_PDN_CONNECTIVITY_REQUEST_MSG_STRUCT pdn_con_req = {};
+  pdn_con_req.eps_bearer_id                                  = 0;
+  pdn_con_req.proc_transaction_id                            = 1;
+  pdn_con_req.request_type                                   = LIBLTE_MME_REQUEST_TYPE_INITIAL_REQUEST;
+  pdn_con_req.pdn_type                                       = LIBLTE_MME_PDN_TYPE_IPV4;
+
+  LIBLTE_MME_ATTACH_REQUEST_MSG_STRUCT attach_req = {};
+  attach_req.eps_attach_type                      = LIBLTE_MME_EPS_ATTACH_TYPE_EPS_ATTACH;
+  attach_req.ue_network_cap.eea[0]                = true;
+  attach_req.ue_network_cap.eia[1]                = true;
+  attach_req.ue_network_cap.eia[2]                = true;
+  attach_req.eps_mobile_id.type_of_id             = LIBLTE_MME_EPS_MOBILE_ID_TYPE_IMSI;
+  attach_req.nas_ksi.tsc_flag                     = LIBLTE_MME_TYPE_OF_SECURITY_CONTEXT_FLAG_NATIVE;
+  attach_req.nas_ksi.nas_ksi                      = LIBLTE_MME_NAS_KEY_SET_IDENTIFIER_NO_KEY_AVAILABLE;
+  uint64_t imsi                                   = ue.imsi;
+  for (int i = 14; i >= 0; --i) {
+    attach_req.eps_mobile_id.imsi[i] = imsi % 10;
+    imsi /= 10;
+  }
+  liblte_mme_pack_pdn_connectivity_request_msg(&pdn_con_req, &attach_req.esm_msg);
+
+  srsran::unique_byte_buffer_t nas = srsran::make_byte_buffer();
+  if (nas == nullptr) {
+    return false;
+  }
+  liblte_mme_pack_attach_request_msg(&attach_req, (LIBLTE_BYTE_MSG_STRUCT*)nas.get());
+
+  asn1::s1ap::s1ap_pdu_c pdu;
+  pdu.set_init_msg().load_info_obj(ASN1_S1AP_ID_INIT_UE_MSG);
+  asn1::s1ap::init_ue_msg_ies_container& container = pdu.init_msg().value.init_ue_msg().protocol_ies;
+  container.enb_ue_s1ap_id.value                   = ue_idx;
+  container.nas_pdu.value.resize(nas->N_bytes);
+  memcpy(container.nas_pdu.value.data(), nas->msg, nas->N_bytes);
+  fill_tai_and_cgi(container.tai.value, container.eutran_cgi.value);
+  container.rrc_establishment_cause.value = asn1::s1ap::rrc_establishment_cause_opts::mo_sig;
+
+  ue.t_start = std::chrono::steady_clock::now();
+  return send_s1ap(ue.enb_idx, pdu);
+}
+
+bool attach_storm::send_ul_nas(uint32_t ue_idx, srsran::byte_buffer_t* nas)
+{
+  asn1::s1ap::s1ap_pdu_c pdu;
+  pdu.set_init_msg().load_info_obj(ASN1_S1AP_ID_UL_NAS_TRANSPORT);
+  asn1::s1ap::ul_nas_transport_ies_container& container = pdu.init_msg().value.ul_nas_transport().protocol_ies;
+  container.mme_ue_s1ap_id.value                        = ues[ue_idx].mme_ue_s1ap_id;
+  container.enb_ue_s1ap_id.value                        = ue_idx;
+  container.nas_pdu.value.resize(nas->N_bytes);
+  memcpy(container.nas_pdu.value.data(), nas->msg, nas->N_bytes);
+  fill_tai_and_cgi(container.tai.value, container.eutran_cgi.value);
+  return send_s1ap(ues[ue_idx].enb_idx, pdu);
+}
+
+bool attach_storm::handle_enb_rx(uint32_t enb_idx)
+{
+  uint8_t                buf[4096];
+  struct sctp_sndrcvinfo sri   = {};
+  int                    flags = 0;
+  ssize_t                n     = sctp_recvmsg(enb_fds[enb_idx], buf, sizeof(buf), nullptr, nullptr, &sri, &flags);
+  if (n <= 0) {
+    fprintf(stderr, "Error receiving from the MME: %s\n", strerror(errno));
+    return false;
+  }
+  if (flags & MSG_NOTIFICATION) {
+    return true;
+  }
+
+  asn1::s1ap::s1ap_pdu_c pdu;
+  asn1::cbit_ref         bref(buf, n);
+  if (pdu.unpack(bref) != asn1::SRSASN_SUCCESS) {
+    fprintf(stderr, "Error unpacking S1AP PDU\n");
+    return false;
+  }
+
+  if (pdu.type().value == asn1::s1ap::s1ap_pdu_c::types_opts::successful_outcome and
+      pdu.successful_outcome().value.type().value ==
+          asn1::s1ap::s1ap_elem_procs_o::successful_outcome_c::types_opts::s1_setup_resp) {
+    nof_enbs_setup++;
+    return true;
+  }
+  if (pdu.type().value != asn1::s1ap::s1ap_pdu_c::types_opts::init_msg) {
+    fprintf(stderr, "Unexpected S1AP PDU from the MME\n");
+    return false;
+  }
+
+  const asn1::s1ap::s1ap_elem_procs_o::init_msg_c& msg = pdu.init_msg().value;
+  switch (msg.type().value) {
+    case asn1::s1ap::s1ap_elem_procs_o::init_msg_c::types_opts::dl_nas_transport:
+      return handle_dl_nas_transport(msg.dl_nas_transport());
+    case asn1::s1ap::s1ap_elem_procs_o::init_msg_c::types_opts::init_context_setup_request: {
+      // The request carries the Attach Accept
+      uint32_t ue_idx = msg.init_context_setup_request().protocol_ies.enb_ue_s1ap_id.value.value;
+      return ue_idx < ues.size() and send_initial_context_setup_response(ue_idx) and send_attach_complete(ue_idx);
+    }
+    default:
+      fprintf(stderr, "Unexpected S1AP message from the MME: %s\n", msg.type().to_string());
+      return false;
+  }
+}
+
+bool attach_storm::send_initial_context_setup_response(uint32_t ue_idx)
+{
+  asn1::s1ap::s1ap_pdu_c pdu;
+  pdu.set_successful_outcome().load_info_obj(ASN1_S1AP_ID_INIT_CONTEXT_SETUP);
+  asn1::s1ap::init_context_setup_resp_ies_container& container =
+      pdu.successful_outcome().value.init_context_setup_resp().protocol_ies;
+  container.mme_ue_s1ap_id.value = ues[ue_idx].mme_ue_s1ap_id;
+  container.enb_ue_s1ap_id.value = ue_idx;
+  container.erab_setup_list_ctxt_su_res.value.resize(1);
+  container.erab_setup_list_ctxt_su_res.value[0].load_info_obj(ASN1_S1AP_ID_ERAB_SETUP_ITEM_CTXT_SU_RES);
+  asn1::s1ap::erab_setup_item_ctxt_su_res_s& item =
+      container.erab_setup_list_ctxt_su_res.value[0].value.erab_setup_item_ctxt_su_res();
+  item.erab_id = 5;
+  item.transport_layer_address.resize(32);
+  item.transport_layer_address.from_number(0x7f000001);
+  item.gtp_teid.from_number(ue_idx + 1);
+  return send_s1ap(ues[ue_idx].enb_idx, pdu);
+}
+
+/*
+ * UE
+ */
+bool attach_storm::handle_dl_nas_transport(const asn1::s1ap::dl_nas_transport_s& msg)
+{
+  uint32_t ue_idx = msg.protocol_ies.enb_ue_s1ap_id.value.value;
+  if (ue_idx >= ues.size()) {
+    fprintf(stderr, "Downlink NAS transport for unknown eNB UE S1AP Id %d\n", ue_idx);
+    return false;
+  }
+  ues[ue_idx].mme_ue_s1ap_id = msg.protocol_ies.mme_ue_s1ap_id.value.value;
+
+  srsran::unique_byte_buffer_t nas = srsran::make_byte_buffer();
+  if (nas == nullptr) {
+    return false;
+  }
+  memcpy(nas->msg, msg.protocol_ies.nas_pdu.value.data(), msg.protocol_ies.nas_pdu.value.size());
+  nas->N_bytes = msg.protocol_ies.nas_pdu.value.size();
+
+  uint8_t pd, msg_type;
+  liblte_mme_parse_msg_header((LIBLTE_BYTE_MSG_STRUCT*)nas.get(), &pd, &msg_type);
+  switch (msg_type) {
+    case LIBLTE_MME_MSG_TYPE_AUTHENTICATION_REQUEST:
+      return send_authentication_response(ue_idx, nas.get());
+    case LIBLTE_MME_MSG_TYPE_SECURITY_MODE_COMMAND:
+      return send_security_mode_complete(ue_idx);
+    case LIBLTE_MME_MSG_TYPE_EMM_INFORMATION: {
+      std::chrono::duration<float> latency = std::chrono::steady_clock::now() - ues[ue_idx].t_start;
+      latencies_ms.push_back(latency.count() * 1e3);
+      return true;
+    }
+    default:
+      fprintf(stderr, "Unexpected NAS message 0x%x for IMSI %015" PRIu64 "\n", msg_type, ues[ue_idx].imsi);
+      return false;
+  }
+}
+
+bool attach_storm::send_authentication_response(uint32_t ue_idx, srsran::byte_buffer_t* nas)
+{
+  storm_ue& ue = ues[ue_idx];
+
+  LIBLTE_MME_AUTHENTICATION_REQUEST_MSG_STRUCT auth_req = {};
+  liblte_mme_unpack_authentication_request_msg((LIBLTE_BYTE_MSG_STRUCT*)nas, &auth_req);
+
+  // The AUTN starts with SQN xor AK, which is all the K_ASME derivation needs
+  LIBLTE_MME_AUTHENTICATION_RESPONSE_MSG_STRUCT auth_resp = {};
+  uint8_t                                       ck[16], ik[16], ak[6];
+  srsran::security_milenage_f2345(ue_k, ue_opc, auth_req.rand, auth_resp.res, ck, ik, ak);
+  srsran::security_generate_k_asme(ck, ik, auth_req.autn, mcc, mnc, ue.k_asme);
+  auth_resp.res_len = 8;
+
+  srsran::unique_byte_buffer_t tx = srsran::make_byte_buffer();
+  if (tx == nullptr) {
+    return false;
+  }
+  liblte_mme_pack_authentication_response_msg(
+      &auth_resp, LIBLTE_MME_SECURITY_HDR_TYPE_PLAIN_NAS, 0, (LIBLTE_BYTE_MSG_STRUCT*)tx.get());
+  return send_ul_nas(ue_idx, tx.get());
+}
+
+void attach_storm::mac_generate(uint32_t ue_idx, srsran::byte_buffer_t* nas, uint32_t count)
+{
+  srsran::security_128_eia1(&ues[ue_idx].k_nas_int[16],
+                            count,
+                            0,
+                            srsran::SECURITY_DIRECTION_UPLINK,
+                            &nas->msg[5],
+                            nas->N_bytes - 5,
+                            &nas->msg[1]);
+}
+
+bool attach_storm::send_security_mode_complete(uint32_t ue_idx)
+{
+  uint8_t k_nas_enc[32];
+  srsran::security_generate_k_nas(ues[ue_idx].k_asme,
+                                  srsran::CIPHERING_ALGORITHM_ID_EEA0,
+                                  srsran::INTEGRITY_ALGORITHM_ID_128_EIA1,
+                                  k_nas_enc,
+                                  ues[ue_idx].k_nas_int);
+
+  LIBLTE_MME_SECURITY_MODE_COMPLETE_MSG_STRUCT sm_comp = {};
+  srsran::unique_byte_buffer_t                 tx      = srsran::make_byte_buffer();
+  if (tx == nullptr) {
+    return false;
+  }
+  uint8_t sec_hdr_type = LIBLTE_MME_SECURITY_HDR_TYPE_INTEGRITY_AND_CIPHERED_WITH_NEW_EPS_SECURITY_CONTEXT;
+  liblte_mme_pack_security_mode_complete_msg(&sm_comp, sec_hdr_type, 0, (LIBLTE_BYTE_MSG_STRUCT*)tx.get());
+  mac_generate(ue_idx, tx.get(), 0);
+  return send_ul_nas(ue_idx, tx.get());
+}
+
+bool attach_storm::send_attach_complete(uint32_t ue_idx)
+{
+  LIBLTE_MME_ACTIVATE_DEFAULT_EPS_BEARER_CONTEXT_ACCEPT_MSG_STRUCT act_bearer = {};
+  act_bearer.eps_bearer_id                                                    = 5;
+  act_bearer.proc_transaction_id                                              = 1;
+
+  LIBLTE_MME_ATTACH_COMPLETE_MSG_STRUCT attach_comp = {};
+  liblte_mme_pack_activate_default_eps_bearer_context_accept_msg(&act_bearer, &attach_comp.esm_msg);
+
+  srsran::unique_byte_buffer_t tx = srsran::make_byte_buffer();
+  if (tx == nullptr) {
+    return false;
+  }
+  liblte_mme_pack_attach_complete_msg(
+      &attach_comp, LIBLTE_MME_SECURITY_HDR_TYPE_INTEGRITY_AND_CIPHERED, 1, (LIBLTE_BYTE_MSG_STRUCT*)tx.get());
+  mac_generate(ue_idx, tx.get(), 1);
+  return send_ul_nas(ue_idx, tx.get());
+}
+
+/*
+ * SP-GW
+ */
+void attach_storm::handle_sgw_rx()
+{
+  srsran::gtpc_pdu req = {};
+  if (recv(sgw_fd, &req, sizeof(req), MSG_DONTWAIT) <= 0) {
+    return;
+  }
+
+  // The MME finds the UE from its own control TEID in the header of the replies
+  srsran::gtpc_pdu resp    = {};
+  resp.header.teid_present = true;
+  switch (req.header.type) {
+    case srsran::GTPC_MSG_TYPE_CREATE_SESSION_REQUEST: {
+      uint32_t                              teid    = next_sgw_teid++;
+      srsran::gtpc_create_session_response* cs_resp = &resp.choice.create_session_response;
+      auto&                                 bearer  = cs_resp->eps_bearer_context_created;
+      resp.header.type                              = srsran::GTPC_MSG_TYPE_CREATE_SESSION_RESPONSE;
+      resp.header.teid                              = req.choice.create_session_request.sender_f_teid.teid;
+      cs_resp->cause.cause_value                    = srsran::GTPC_CAUSE_VALUE_REQUEST_ACCEPTED;
+      cs_resp->sender_f_teid.ipv4_present           = true;
+      cs_resp->sender_f_teid.teid                   = teid;
+      bearer.ebi                                    = 5;
+      bearer.cause.cause_value                      = srsran::GTPC_CAUSE_VALUE_REQUEST_ACCEPTED;
+      bearer.s1_u_sgw_f_teid_present                = true;
+      bearer.s1_u_sgw_f_teid.ipv4                   = htonl(0x7f000001);
+      bearer.s1_u_sgw_f_teid.teid                   = teid;
+      cs_resp->paa_present                          = true;
+      cs_resp->paa.pdn_type                         = srsran::GTPC_PDN_TYPE_IPV4;
+      cs_resp->paa.ipv4_present                     = true;
+      cs_resp->paa.ipv4                             = htonl(0xac100002 + teid);
+      break;
+    }
+    case srsran::GTPC_MSG_TYPE_MODIFY_BEARER_REQUEST: {
+      srsran::gtpc_modify_bearer_response* mb_resp = &resp.choice.modify_bearer_response;
+      resp.header.type                             = srsran::GTPC_MSG_TYPE_MODIFY_BEARER_RESPONSE;
+      resp.header.teid                             = req.header.teid;
+      mb_resp->cause.cause_value                   = srsran::GTPC_CAUSE_VALUE_REQUEST_ACCEPTED;
+      mb_resp->eps_bearer_context_modified.ebi     = req.choice.modify_bearer_request.eps_bearer_context_to_modify.ebi;
+      break;
+    }
+    default:
+      return;
+  }
+  sgw_tx_queue.push_back(resp);
+}
+
+void attach_storm::flush_sgw_tx()
+{
+  // Never block on a full MME socket, the MME may be blocked sending to the SP-GW
+  while (not sgw_tx_queue.empty()) {
+    if (sendto(sgw_fd,
+               &sgw_tx_queue.front(),
+               sizeof(srsran::gtpc_pdu),
+               MSG_DONTWAIT,
+               (const struct sockaddr*)&mme_s11_addr,
+               sizeof(mme_s11_addr)) < 0) {
+      return;
+    }
+    sgw_tx_queue.pop_front();
+  }
+}
+
+/*
+ * Benchmark
+ */
+static bool sctp_available()
+{
+  int fd = socket(AF_INET, SOCK_SEQPACKET, IPPROTO_SCTP);
+  if (fd < 0) {
+    return false;
+  }
+  close(fd);
+  return true;
+}
+
+static mme_args_t make_mme_args(const run_params& params, const std::string& mme_addr)
+{
+  mme_args_t args                = {};
+  args.s1ap_args.mme_code        = 0x1a;
+  args.s1ap_args.mme_group       = 0x0001;
+  args.s1ap_args.tac             = tac;
+  args.s1ap_args.mcc             = mcc;
+  args.s1ap_args.mnc             = mnc;
+  args.s1ap_args.paging_timer    = 2;
+  args.s1ap_args.mme_bind_addr   = mme_addr;
+  args.s1ap_args.mme_name        = "srsmme01";
+  args.s1ap_args.dns_addr        = "8.8.8.8";
+  args.s1ap_args.full_net_name   = "Software Radio Systems RAN";
+  args.s1ap_args.short_net_name  = "srsRAN";
+  args.s1ap_args.mme_apn         = "srsapn";
+  args.s1ap_args.pcap_enable     = false;
+  args.s1ap_args.encryption_algo = srsran::CIPHERING_ALGORITHM_ID_EEA0;
+  args.s1ap_args.integrity_algo  = srsran::INTEGRITY_ALGORITHM_ID_128_EIA1;
+  args.s1ap_args.request_imeisv  = false;
+  args.s1ap_args.nas_nof_workers = params.nof_workers;
+  return args;
+}
+
+/**
+ * Runs an attach storm of params.nof_ues UEs against an MME with params.nof_workers NAS workers. Every run binds the
+ * MME to its own loopback address, so that runs do not wait for the SCTP port of the previous one
+ */
+int run_storm_scenario(const run_params& params, std::vector<run_data>& run_results)
+{
+  std::string mme_addr = "127.0.1." + std::to_string(run_results.size() + 1);
+  write_db(params.nof_ues);
+
+  hss_args_t hss_args;
+  hss_args.db_file  = db_file;
+  hss_args.db_store = "";
+  hss_args.mcc      = mcc;
+  hss_args.mnc      = mnc;
+
+  int      saved_stdout = mute_stdout();
+  hss*     h            = hss::get_instance();
+  mme*     m            = mme::get_instance();
+  run_data r            = {};
+  bool     ret          = h->init(&hss_args) == 0;
+  if (ret) {
+    mme_args_t mme_args = make_mme_args(params, mme_addr);
+    m->init(&mme_args);
+    m->start();
+
+    std::unique_ptr<attach_storm> storm(new attach_storm(params, mme_addr));
+    ret = storm->init() and storm->run(r);
+    m->stop();
+    storm.reset();
+  }
+  mme::cleanup();
+  h->stop();
+  hss::cleanup();
+  restore_stdout(saved_stdout);
+  remove(db_file);
+
+  TESTASSERT(ret);
+  run_results.push_back(r);
+  return SRSRAN_SUCCESS;
+}
+
+void print_benchmark_results(const std::vector<run_data>& run_results)
+{
+  fmt::print("run | workers |    UEs | attaches/s | avg [ms] | p50 [ms] | p99 [ms]\n");
+  fmt::print("--------------------------------------------------------------------\n");
+  for (uint32_t i = 0; i < run_results.size(); ++i) {
+    const run_data& r = run_results[i];
+    fmt::print("{:>3d}{:>10d}{:>9d}{:>13.0f}{:>11.2f}{:>11.2f}{:>11.2f}\n",
+               i,
+               r.params.nof_workers,
+               r.params.nof_ues,
+               r.attaches_per_sec,
+               r.avg_latency_ms,
+               r.p50_latency_ms,
+               r.p99_latency_ms);
+  }
+}
+
+int run_benchmark(const std::vector<uint32_t>& nof_workers_list, uint32_t nof_ues)
+{
+  if (not sctp_available()) {
+    fmt::print("SCTP is not available ({}), skipping the attach storm\n", strerror(errno));
+    return SRSRAN_SUCCESS;
+  }
+
+  std::vector<run_data> run_results;
+  for (uint32_t nof_workers : nof_workers_list) {
+    run_params params = {nof_workers, nof_ues};
+    TESTASSERT(run_storm_scenario(params, run_results) == SRSRAN_SUCCESS);
+  }
+
+  print_benchmark_results(run_results);
+
+  return SRSRAN_SUCCESS;
+}
+
+} // namespace srsepc
+
+int main(int argc, char* argv[])
+{
+  for (const char* name : {"S1AP", "NAS", "MME GTPC", "HSS"}) {
+    srslog::fetch_basic_logger(name).set_level(srslog::basic_levels::warning);
+  }
+
+  // Start the log backend.
+  srslog::init();
+
+  if (argc == 1 or strcmp(argv[1], "test") == 0) {
+    TESTASSERT(srsepc::run_benchmark({0, 1, 2, 4}, 200) == SRSRAN_SUCCESS);
+  } else {
+    TESTASSERT(srsepc::run_benchmark({0, 1, 2, 4, 8}, 20000) == SRSRAN_SUCCESS);
+  }
+
+  return 0;
+}
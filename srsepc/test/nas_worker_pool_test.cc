@@ -0,0 +1,130 @@
+/**
+ * Copyright 2013-2021 Software Radio Systems Limited
+ *
+ * This file is part of srsRAN.
+ *
+ * srsRAN is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsRAN is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+/******************************************************************************
+ * File:        nas_worker_pool_test.cc
+ * Description: Checks that the NAS workers of the MME run every task, in
+ *              order, when the workers post to each other faster than the
+ *              queues can hold.
+ *****************************************************************************/
+
+#include "srsepc/hdr/mme/nas_worker_pool.h"
+#include "srsran/common/test_common.h"
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+using namespace srsepc;
+
+static const uint32_t queue_size = 4;
+
+/// Waits for the counter to reach the value, failing after a few seconds
+static bool wait_for(const std::atomic<uint32_t>& counter, uint32_t value)
+{
+  for (uint32_t i = 0; i < 5000 and counter.load() < value; ++i) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  return counter.load() == value;
+}
+
+/// The MME thread pushes into full queues, and waits for room
+int test_mme_push()
+{
+  const uint32_t nof_tasks = 10000;
+
+  nas_worker_pool pool;
+  pool.init(2, queue_size);
+
+  std::atomic<uint32_t> nof_run{0};
+  std::vector<uint32_t> order[2];
+  for (uint32_t i = 0; i < nof_tasks; ++i) {
+    uint32_t shard = i % 2;
+    pool.push_task(shard, [&nof_run, &order, shard, i]() {
+      TESTASSERT(nas_worker_pool::get_current_shard() == (int32_t)shard);
+      order[shard].push_back(i);
+      nof_run++;
+    });
+  }
+  TESTASSERT(wait_for(nof_run, nof_tasks));
+  pool.stop();
+
+  for (uint32_t shard = 0; shard < 2; ++shard) {
+    TESTASSERT(order[shard].size() == nof_tasks / 2);
+    for (uint32_t i = 0; i < order[shard].size(); ++i) {
+      TESTASSERT(order[shard][i] == 2 * i + shard);
+    }
+  }
+  return SRSRAN_SUCCESS;
+}
+
+/// Both workers flood each other with tasks. None is lost, and the tasks of each worker run in the order it posted them
+int test_cross_shard_push()
+{
+  const uint32_t nof_tasks     = 200;
+  const uint32_t nof_fwd_tasks = 50;
+
+  struct test_ctxt {
+    nas_worker_pool       pool;
+    std::atomic<uint32_t> nof_run{0};
+    // Sequence numbers of the tasks each shard received from the other one
+    std::vector<uint32_t> received[2];
+  } ctxt;
+  ctxt.pool.init(2, queue_size);
+  TESTASSERT(nas_worker_pool::get_current_shard() == -1);
+
+  for (uint32_t i = 0; i < nof_tasks; ++i) {
+    uint32_t shard = i % 2;
+    ctxt.pool.push_task(shard, [&ctxt, shard, i, nof_fwd_tasks]() {
+      uint32_t peer = (shard + 1) % 2;
+      for (uint32_t j = 0; j < nof_fwd_tasks; ++j) {
+        uint32_t seq = (i / 2) * nof_fwd_tasks + j;
+        ctxt.pool.push_task(peer, [&ctxt, peer, seq]() {
+          TESTASSERT(nas_worker_pool::get_current_shard() == (int32_t)peer);
+          ctxt.received[peer].push_back(seq);
+          ctxt.nof_run++;
+        });
+      }
+      ctxt.nof_run++;
+    });
+  }
+  TESTASSERT(wait_for(ctxt.nof_run, nof_tasks * (nof_fwd_tasks + 1)));
+  ctxt.pool.stop();
+
+  for (uint32_t shard = 0; shard < 2; ++shard) {
+    TESTASSERT(ctxt.received[shard].size() == nof_tasks / 2 * nof_fwd_tasks);
+    for (uint32_t i = 0; i < ctxt.received[shard].size(); ++i) {
+      TESTASSERT(ctxt.received[shard][i] == i);
+    }
+  }
+  return SRSRAN_SUCCESS;
+}
+
+int main()
+{
+  srslog::init();
+
+  TESTASSERT(test_mme_push() == SRSRAN_SUCCESS);
+  TESTASSERT(test_cross_shard_push() == SRSRAN_SUCCESS);
+
+  printf("Success\n");
+  return SRSRAN_SUCCESS;
+}
@@ -0,0 +1,484 @@
+/**
+ * Copyright 2013-2021 Software Radio Systems Limited
+ *
+ * This file is part of srsRAN.
+ *
+ * srsRAN is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsRAN is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+/******************************************************************************
+ * File:        spgw_gtpu_loopback.cc
+ * Description: TUN loopback harness for the SP-GW user plane. Runs the SP-GW
+ *              in-process, attaches UEs through S11 as the MME would, and
+ *              measures the downlink (SGi to S1-U) and uplink (S1-U to SGi)
+ *              forwarding rate for several numbers of GTP-U workers.
+ *****************************************************************************/
+
+#include "srsepc/hdr/spgw/spgw.h"
+#include "srsran/asn1/gtpc.h"
+#include "srsran/common/network_utils.h"
+#include "srsran/common/test_common.h"
+#include <arpa/inet.h>
+#include <atomic>
+#include <chrono>
+#include <fcntl.h>
+#include <linux/if.h>
+#include <linux/if_tun.h>
+#include <linux/ip.h>
+#include <netinet/udp.h>
+#include <poll.h>
+#include <sys/ioctl.h>
+#include <sys/un.h>
+#include <thread>
+
+namespace srsepc {
+
+static const char*    sgi_if_name    = "srs_spgw_lb";
+static const char*    sgi_if_addr    = "172.16.250.1";
+static const char*    spgw_s1u_addr  = "127.0.1.100";
+static const char*    enb_s1u_addr   = "127.0.1.101";
+static const uint16_t app_port       = 9000;
+static const uint32_t enb_teid_start = 0x100;
+static const int      idle_ms        = 200; ///< A direction is done when no packet arrives for this long
+
+struct run_params {
+  uint32_t nof_workers;
+  uint32_t nof_ues;
+  uint32_t nof_pkts; ///< Packets offered in each direction
+  uint32_t pkt_size; ///< Size of the IP packets
+};
+
+struct run_data {
+  run_params params;
+  float      dl_kpps;
+  float      dl_loss;
+  float      ul_kpps;
+  float      ul_loss;
+};
+
+/// Sends the standard output, where the SP-GW prints every GTP-C message, to /dev/null. Returns the saved stdout
+static int mute_stdout()
+{
+  fflush(stdout);
+  int saved   = dup(STDOUT_FILENO);
+  int null_fd = open("/dev/null", O_WRONLY);
+  dup2(null_fd, STDOUT_FILENO);
+  close(null_fd);
+  return saved;
+}
+
+static void restore_stdout(int saved)
+{
+  fflush(stdout);
+  dup2(saved, STDOUT_FILENO);
+  close(saved);
+}
+
+static void set_unix_addr(struct sockaddr_un* addr, const char* name)
+{
+  memset(addr, 0, sizeof(struct sockaddr_un));
+  addr->sun_family = AF_UNIX;
+  snprintf(addr->sun_path, sizeof(addr->sun_path), "%s", name);
+  addr->sun_path[0] = '\0';
+}
+
+static uint16_t ip_checksum(const uint8_t* buf, uint32_t len)
+{
+  uint32_t sum = 0;
+  for (uint32_t i = 0; i + 1 < len; i += 2) {
+    sum += (buf[i] << 8) | buf[i + 1];
+  }
+  while (sum >> 16) {
+    sum = (sum & 0xffff) + (sum >> 16);
+  }
+  return htons(~sum);
+}
+
+/**
+ * Emulates the MME on S11, the eNB on S1-U and the application on the SGi side of the SP-GW. The downlink offers
+ * UDP packets from the SGi address to the UE addresses through the kernel, which routes them into the TUN device of
+ * the SP-GW. The uplink sends GTP-U PDUs with UDP packets from the UEs to the SGi address. In both directions the
+ * receiver checks that every packet was forwarded on the tunnel of its UE
+ */
+class gtpu_loopback
+{
+public:
+  explicit gtpu_loopback(const run_params& params_) : params(params_) {}
+  ~gtpu_loopback();
+
+  bool init();
+  bool attach_ues();
+  bool run_downlink(run_data& r);
+  bool run_uplink(run_data& r);
+
+private:
+  struct loopback_ue {
+    in_addr_t ue_ipv4;
+    uint32_t  sgw_ctrl_teid;
+    uint32_t  sgw_user_teid;
+  };
+
+  bool recv_s11(srsran::gtpc_pdu* pdu);
+  bool send_s11(const srsran::gtpc_pdu& pdu);
+  int  find_ue(in_addr_t ue_ipv4) const;
+
+  run_params               params;
+  int                      mme_fd = -1;
+  int                      enb_fd = -1;
+  int                      app_fd = -1;
+  struct sockaddr_un       spgw_s11_addr;
+  struct sockaddr_in       spgw_addr = {};
+  std::vector<loopback_ue> ues;
+};
+
+gtpu_loopback::~gtpu_loopback()
+{
+  for (int fd : {mme_fd, enb_fd, app_fd}) {
+    if (fd != -1) {
+      close(fd);
+    }
+  }
+}
+
+bool gtpu_loopback::init()
+{
+  // MME side of S11
+  struct sockaddr_un mme_addr;
+  set_unix_addr(&mme_addr, "@mme_s11");
+  set_unix_addr(&spgw_s11_addr, "@spgw_s11");
+  mme_fd = socket(AF_UNIX, SOCK_DGRAM, 0);
+  if (mme_fd < 0 or bind(mme_fd, (const struct sockaddr*)&mme_addr, sizeof(mme_addr)) != 0) {
+    fprintf(stderr, "Error binding the MME S11 socket: %s\n", strerror(errno));
+    return false;
+  }
+
+  // eNB side of S1-U
+  struct sockaddr_in enb_addr = {};
+  srsran::net_utils::set_sockaddr(&enb_addr, enb_s1u_addr, GTPU_RX_PORT);
+  srsran::net_utils::set_sockaddr(&spgw_addr, spgw_s1u_addr, GTPU_RX_PORT);
+  enb_fd = socket(AF_INET, SOCK_DGRAM, 0);
+  if (enb_fd < 0 or bind(enb_fd, (const struct sockaddr*)&enb_addr, sizeof(enb_addr)) != 0) {
+    fprintf(stderr, "Error binding the eNB S1-U socket: %s\n", strerror(errno));
+    return false;
+  }
+
+  // Application behind SGi, on the address of the TUN device
+  struct sockaddr_in app_addr = {};
+  srsran::net_utils::set_sockaddr(&app_addr, sgi_if_addr, app_port);
+  app_fd = socket(AF_INET, SOCK_DGRAM, 0);
+  if (app_fd < 0 or bind(app_fd, (const struct sockaddr*)&app_addr, sizeof(app_addr)) != 0) {
+    fprintf(stderr, "Error binding the SGi application socket: %s\n", strerror(errno));
+    return false;
+  }
+
+  // Deep socket buffers, so that the receivers measure the SP-GW and not their own drops
+  int buf_size = 8 * 1024 * 1024;
+  for (int fd : {enb_fd, app_fd}) {
+    setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &buf_size, sizeof(buf_size));
+    setsockopt(fd, SOL_SOCKET, SO_SNDBUF, &buf_size, sizeof(buf_size));
+  }
+  return true;
+}
+
+bool gtpu_loopback::send_s11(const srsran::gtpc_pdu& pdu)
+{
+  return sendto(mme_fd, &pdu, sizeof(pdu), 0, (const struct sockaddr*)&spgw_s11_addr, sizeof(spgw_s11_addr)) > 0;
+}
+
+bool gtpu_loopback::recv_s11(srsran::gtpc_pdu* pdu)
+{
+  struct pollfd pfd = {mme_fd, POLLIN, 0};
+  if (poll(&pfd, 1, 1000) <= 0) {
+    fprintf(stderr, "Timeout waiting for the SP-GW on S11\n");
+    return false;
+  }
+  return recv(mme_fd, pdu, sizeof(*pdu), 0) > 0;
+}
+
+bool gtpu_loopback::attach_ues()
+{
+  ues.resize(params.nof_ues);
+  for (uint32_t i = 0; i < params.nof_ues; ++i) {
+    // Create Session
+    srsran::gtpc_pdu req                                 = {};
+    req.header.type                                      = srsran::GTPC_MSG_TYPE_CREATE_SESSION_REQUEST;
+    req.choice.create_session_request.imsi               = 1010000000000ULL + i;
+    req.choice.create_session_request.sender_f_teid.teid = i + 1;
+    TESTASSERT(send_s11(req));
+
+    srsran::gtpc_pdu resp = {};
+    TESTASSERT(recv_s11(&resp));
+    TESTASSERT(resp.header.type == srsran::GTPC_MSG_TYPE_CREATE_SESSION_RESPONSE);
+    const srsran::gtpc_create_session_response& cs_resp = resp.choice.create_session_response;
+    ues[i].ue_ipv4                                      = cs_resp.paa.ipv4;
+    ues[i].sgw_ctrl_teid                                = cs_resp.sender_f_teid.teid;
+    ues[i].sgw_user_teid                                = cs_resp.eps_bearer_context_created.s1_u_sgw_f_teid.teid;
+
+    // Modify Bearer, with the eNB end of the user plane tunnel
+    req                         = {};
+    req.header.type             = srsran::GTPC_MSG_TYPE_MODIFY_BEARER_REQUEST;
+    req.header.teid_present     = true;
+    req.header.teid             = ues[i].sgw_ctrl_teid;
+    auto& bearer                = req.choice.modify_bearer_request.eps_bearer_context_to_modify;
+    bearer.ebi                  = 5;
+    bearer.s1_u_enb_f_teid.teid = enb_teid_start + i;
+    inet_pton(AF_INET, enb_s1u_addr, &bearer.s1_u_enb_f_teid.ipv4);
+    TESTASSERT(send_s11(req));
+    TESTASSERT(recv_s11(&resp));
+    TESTASSERT(resp.header.type == srsran::GTPC_MSG_TYPE_MODIFY_BEARER_RESPONSE);
+  }
+  return true;
+}
+
+int gtpu_loopback::find_ue(in_addr_t ue_ipv4) const
+{
+  for (uint32_t i = 0; i < ues.size(); ++i) {
+    if (ues[i].ue_ipv4 == ue_ipv4) {
+      return i;
+    }
+  }
+  return -1;
+}
+
+/**
+ * Receives on fd until no packet arrives for idle_ms, checking every packet with the given function. Returns the
+ * number of valid packets and the time of the last one
+ */
+template <typename Check>
+static uint32_t
+drain_socket(int fd, Check&& check, std::atomic<uint32_t>& nof_invalid, std::chrono::steady_clock::time_point& t_last)
+{
+  uint32_t nof_valid = 0;
+  uint8_t  buf[2048];
+  while (true) {
+    struct pollfd pfd = {fd, POLLIN, 0};
+    if (poll(&pfd, 1, idle_ms) <= 0) {
+      return nof_valid;
+    }
+    struct sockaddr_in from    = {};
+    socklen_t          addrlen = sizeof(from);
+    ssize_t            n       = recvfrom(fd, buf, sizeof(buf), MSG_DONTWAIT, (struct sockaddr*)&from, &addrlen);
+    if (n <= 0) {
+      continue;
+    }
+    t_last = std::chrono::steady_clock::now();
+    if (check(buf, n, from)) {
+      nof_valid++;
+    } else {
+      nof_invalid++;
+    }
+  }
+}
+
+bool gtpu_loopback::run_downlink(run_data& r)
+{
+  std::vector<uint8_t>                  payload(params.pkt_size - sizeof(struct iphdr) - sizeof(struct udphdr));
+  std::atomic<uint32_t>                 nof_invalid{0};
+  uint32_t                              nof_valid = 0;
+  std::chrono::steady_clock::time_point t_last;
+
+  // The eNB checks that the packet came on the tunnel of the UE it is addressed to
+  std::thread enb([&]() {
+    nof_valid = drain_socket(
+        enb_fd,
+        [this](const uint8_t* buf, ssize_t n, const sockaddr_in&) {
+          if (n < 8 + (ssize_t)sizeof(struct iphdr)) {
+            return false;
+          }
+          uint32_t            teid = ntohl(*(const uint32_t*)&buf[4]);
+          const struct iphdr* iph  = (const struct iphdr*)&buf[8];
+          int                 ue   = find_ue(iph->daddr);
+          return ue >= 0 and teid == enb_teid_start + ue;
+        },
+        nof_invalid,
+        t_last);
+  });
+
+  auto t_start = std::chrono::steady_clock::now();
+  for (uint32_t i = 0; i < params.nof_pkts; ++i) {
+    struct sockaddr_in ue_addr = {};
+    ue_addr.sin_family         = AF_INET;
+    ue_addr.sin_port           = htons(app_port);
+    ue_addr.sin_addr.s_addr    = ues[i % ues.size()].ue_ipv4;
+    sendto(app_fd, payload.data(), payload.size(), 0, (const struct sockaddr*)&ue_addr, sizeof(ue_addr));
+  }
+  enb.join();
+
+  float elapsed_s = std::chrono::duration<float>(t_last - t_start).count();
+  r.dl_kpps       = nof_valid / std::max(elapsed_s, 1e-6f) / 1000;
+  r.dl_loss       = 100.0f * (params.nof_pkts - nof_valid) / params.nof_pkts;
+  TESTASSERT(nof_invalid == 0);
+  TESTASSERT(nof_valid > 0);
+  return true;
+}
+
+bool gtpu_loopback::run_uplink(run_data& r)
+{
+  std::atomic<uint32_t>                 nof_invalid{0};
+  uint32_t                              nof_valid = 0;
+  std::chrono::steady_clock::time_point t_last;
+
+  // One GTP-U PDU per UE, with the IP and UDP headers of a packet from the UE to the application
+  uint32_t                           ip_len = params.pkt_size;
+  std::vector<std::vector<uint8_t> > pdus(ues.size(), std::vector<uint8_t>(8 + ip_len));
+  for (uint32_t i = 0; i < ues.size(); ++i) {
+    uint8_t* pdu        = pdus[i].data();
+    pdu[0]              = 0x30; // Version 1, GTP
+    pdu[1]              = 0xff; // G-PDU
+    *(uint16_t*)&pdu[2] = htons(ip_len);
+    *(uint32_t*)&pdu[4] = htonl(ues[i].sgw_user_teid);
+
+    struct iphdr* iph = (struct iphdr*)&pdu[8];
+    iph->version      = 4;
+    iph->ihl          = 5;
+    iph->tot_len      = htons(ip_len);
+    iph->ttl          = 64;
+    iph->protocol     = IPPROTO_UDP;
+    iph->saddr        = ues[i].ue_ipv4;
+    inet_pton(AF_INET, sgi_if_addr, &iph->daddr);
+    iph->check = ip_checksum((const uint8_t*)iph, sizeof(struct iphdr));
+
+    struct udphdr* udph = (struct udphdr*)&pdu[8 + sizeof(struct iphdr)];
+    udph->source        = htons(app_port);
+    udph->dest          = htons(app_port);
+    udph->len           = htons(ip_len - sizeof(struct iphdr));
+  }
+
+  // The application checks that the packet comes from a UE with a tunnel
+  std::thread app([&]() {
+    nof_valid = drain_socket(
+        app_fd,
+        [this](const uint8_t*, ssize_t, const sockaddr_in& from) { return find_ue(from.sin_addr.s_addr) >= 0; },
+        nof_invalid,
+        t_last);
+  });
+
+  auto t_start = std::chrono::steady_clock::now();
+  for (uint32_t i = 0; i < params.nof_pkts; ++i) {
+    const std::vector<uint8_t>& pdu = pdus[i % pdus.size()];
+    sendto(enb_fd, pdu.data(), pdu.size(), 0, (const struct sockaddr*)&spgw_addr, sizeof(spgw_addr));
+  }
+  app.join();
+
+  float elapsed_s = std::chrono::duration<float>(t_last - t_start).count();
+  r.ul_kpps       = nof_valid / std::max(elapsed_s, 1e-6f) / 1000;
+  r.ul_loss       = 100.0f * (params.nof_pkts - nof_valid) / params.nof_pkts;
+  TESTASSERT(nof_invalid == 0);
+  TESTASSERT(nof_valid > 0);
+  return true;
+}
+
+/*
+ * Benchmark
+ */
+static bool tun_available()
+{
+  int fd = open("/dev/net/tun", O_RDWR);
+  if (fd < 0) {
+    return false;
+  }
+  struct ifreq ifr = {};
+  ifr.ifr_flags    = IFF_TUN | IFF_NO_PI;
+  bool ret         = ioctl(fd, TUNSETIFF, &ifr) == 0;
+  close(fd);
+  return ret;
+}
+
+int run_loopback_scenario(const run_params& params, std::vector<run_data>& run_results)
+{
+  spgw_args_t args        = {};
+  args.gtpu_bind_addr     = spgw_s1u_addr;
+  args.sgi_if_addr        = sgi_if_addr;
+  args.sgi_if_name        = sgi_if_name;
+  args.max_paging_queue   = 100;
+  args.gtpu_nof_workers   = params.nof_workers;
+  args.gtpu_io_batch_size = 32;
+
+  int      saved_stdout = mute_stdout();
+  spgw*    s            = spgw::get_instance();
+  run_data r            = {};
+  r.params              = params;
+  bool ret              = s->init(&args, std::map<std::string, uint64_t>()) == SRSRAN_SUCCESS;
+  if (ret) {
+    s->start();
+    std::unique_ptr<gtpu_loopback> loopback(new gtpu_loopback(params));
+    ret = loopback->init() and loopback->attach_ues() and loopback->run_downlink(r) and loopback->run_uplink(r);
+  }
+  s->stop();
+  spgw::cleanup();
+  restore_stdout(saved_stdout);
+
+  TESTASSERT(ret);
+  run_results.push_back(r);
+  return SRSRAN_SUCCESS;
+}
+
+void print_benchmark_results(const std::vector<run_data>& run_results)
+{
+  fmt::print("run | workers | UEs |  pkts | size | DL [kpps] | DL loss [%] | UL [kpps] | UL loss [%]\n");
+  fmt::print("---------------------------------------------------------------------------------------\n");
+  for (uint32_t i = 0; i < run_results.size(); ++i) {
+    const run_data& r = run_results[i];
+    fmt::print("{:>3d}{:>10d}{:>6d}{:>8d}{:>7d}{:>12.1f}{:>14.1f}{:>12.1f}{:>14.1f}\n",
+               i,
+               r.params.nof_workers,
+               r.params.nof_ues,
+               r.params.nof_pkts,
+               r.params.pkt_size,
+               r.dl_kpps,
+               r.dl_loss,
+               r.ul_kpps,
+               r.ul_loss);
+  }
+}
+
+int run_benchmark(const std::vector<uint32_t>& nof_workers_list, uint32_t nof_pkts)
+{
+  if (not tun_available()) {
+    fmt::print("TUN devices are not available ({}), skipping the SP-GW loopback\n", strerror(errno));
+    return SRSRAN_SUCCESS;
+  }
+
+  std::vector<run_data> run_results;
+  for (uint32_t nof_workers : nof_workers_list) {
+    run_params params = {nof_workers, 64, nof_pkts, 512};
+    TESTASSERT(run_loopback_scenario(params, run_results) == SRSRAN_SUCCESS);
+  }
+
+  print_benchmark_results(run_results);
+
+  return SRSRAN_SUCCESS;
+}
+
+} // namespace srsepc
+
+int main(int argc, char* argv[])
+{
+  for (const char* name : {"SPGW", "SPGW GTPC", "GTPU"}) {
+    srslog::fetch_basic_logger(name).set_level(srslog::basic_levels::warning);
+  }
+
+  // Start the log backend.
+  srslog::init();
+
+  if (argc == 1 or strcmp(argv[1], "test") == 0) {
+    TESTASSERT(srsepc::run_benchmark({0, 2}, 10000) == SRSRAN_SUCCESS);
+  } else {
+    TESTASSERT(srsepc::run_benchmark({0, 1, 2, 4}, 500000) == SRSRAN_SUCCESS);
+  }
+
+  return 0;
+}
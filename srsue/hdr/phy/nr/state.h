@@ -93,6 +93,9 @@ public:
   /// Physical layer user configuration
   phy_args_nr_t args = {};
 
+  /// PDSCH code block decoder threads shared by all workers, NULL if disabled
+  srsran_sch_cb_pool_t* ldpc_pool = nullptr;
+
   /// Semaphore for aligning UL work
   srsran::tti_semaphore<void*> dl_ul_semaphore;
 
@@ -45,11 +45,14 @@ private:
   srsran::phy_cfg_nr_t                     cfg{};
   std::vector<bool>                        pending_cfgs;
   std::mutex                               cfg_mutex;
+  srsran_sch_cb_pool_t                     ldpc_pool          = {};
+  bool                                     ldpc_enabled       = false;
 
 public:
   sf_worker* operator[](std::size_t pos) { return workers.at(pos).get(); }
 
   worker_pool(uint32_t max_workers);
+  ~worker_pool();
   bool init(const phy_args_nr_t& args_, srsran::phy_common_interface& common, stack_interface_phy_nr* stack_, int prio);
   sf_worker* wait_worker(uint32_t tti);
   void       start_worker(sf_worker* w);
@@ -158,7 +158,7 @@ public:
   void set_rar_grant(uint8_t grant_payload[SRSRAN_RAR_GRANT_LEN], uint16_t rnti) final;
 
   /*Set MAC->PHY MCH period  stopping point*/
-  void set_mch_period_stop(uint32_t stop) final;
+  void set_mch_period_stop(uint32_t lcid, uint32_t stop) final;
 
   float get_phr() final;
   float get_pathloss_db() final;
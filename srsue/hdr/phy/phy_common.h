@@ -105,6 +105,12 @@ public:
   void set_dl_pending_grant(uint32_t tti, uint32_t cc_idx, uint32_t grant_cc_idx, const srsran_dci_dl_t* dl_dci);
   bool get_dl_pending_grant(uint32_t tti, uint32_t cc_idx, uint32_t* grant_cc_idx, srsran_dci_dl_t* dl_dci);
 
+  /**
+   * Returns the PDSCH code block decoding pool shared by all carrier workers, or nullptr when parallel code block
+   * decoding is disabled (phy.pdsch_tdec_threads = 0)
+   */
+  srsran_sch_cb_pool_t* get_tdec_pool() { return tdec_enabled ? &tdec_pool : nullptr; }
+
   void set_ul_pending_ack(srsran_ul_sf_cfg_t*  sf,
                           uint32_t             cc_idx,
                           srsran_phich_grant_t phich_grant,
@@ -209,7 +215,7 @@ public:
   void build_mcch_table();
   void set_mcch();
   bool is_mbsfn_sf(srsran_mbsfn_cfg_t* cfg, uint32_t tti);
-  void set_mch_period_stop(uint32_t stop);
+  void set_mch_period_stop(uint32_t pmch_idx, uint32_t stop);
 
   /**
    * Deduces the UL EARFCN from a DL EARFCN. If the UL-EARFCN was defined in the UE PHY arguments it will use the
@@ -304,6 +310,9 @@ private:
 
   rsrp_insync_itf* insync_itf = nullptr;
 
+  srsran_sch_cb_pool_t tdec_pool    = {};
+  bool                 tdec_enabled = false;
+
   bool                    have_mtch_stop = false;
   std::mutex              mtch_mutex;
   std::condition_variable mtch_cvar;
@@ -370,7 +379,7 @@ private:
   // MBSFN
   bool     sib13_configured = false;
   bool     mcch_configured  = false;
-  uint32_t mch_period_stop  = 0;
+  uint32_t mch_period_stop[15] = {}; ///< Last subframe of each PMCH in the period, relative to its first subframe
   uint8_t  mch_table[40]    = {};
   uint8_t  mcch_table[10]   = {};
 
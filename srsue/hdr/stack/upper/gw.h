@@ -47,6 +47,7 @@ struct gw_args_t {
   std::string netns;
   std::string tun_dev_name;
   std::string tun_dev_netmask;
+  uint32_t    tun_read_batch = 1; // Max. number of IP packets read from the TUN device per wakeup
 };
 
 class gw : public gw_interface_stack, public srsran::thread
@@ -73,6 +74,10 @@ public:
   void add_mch_port(uint32_t lcid, uint32_t port);
   bool is_running();
 
+protected:
+  // Test interface: receive UL packets from an already open descriptor instead of the TUN device
+  int setup_if_fd(uint32_t eps_bearer_id, int32_t fd);
+
 private:
   static const int GW_THREAD_PRIO = -1;
 
@@ -102,6 +107,8 @@ private:
   std::chrono::high_resolution_clock::time_point metrics_tp; // stores time when last metrics have been taken
 
   void run_thread();
+  void run_thread_batched();
+  bool write_ul_pdu(srsran::unique_byte_buffer_t& pdu, std::unique_lock<std::mutex>& lock);
   int  init_if(char* err_str);
   int  setup_if_addr4(uint32_t ip_addr, char* err_str);
   int  setup_if_addr6(uint8_t* ipv6_if_id, char* err_str);
@@ -25,7 +25,10 @@
 #include "srsran/asn1/liblte_mme.h"
 #include "srsran/common/buffer_pool.h"
 #include "srsran/srslog/srslog.h"
+#include <array>
+#include <map>
 #include <mutex>
+#include <vector>
 
 namespace srsue {
 
@@ -88,10 +91,10 @@ public:
   uint8_t  ipv6_local_addr_mask[16]  = {};
   uint8_t  ipv6_local_addr_length    = {};
   uint8_t  protocol_id               = {};
-  uint16_t single_local_port         = {};
-  uint16_t local_port_range[2]       = {};
-  uint16_t single_remote_port        = {};
-  uint16_t remote_port_range[2]      = {};
+  uint16_t single_local_port         = {}; // network byte order
+  uint16_t local_port_range[2]       = {}; // host byte order
+  uint16_t single_remote_port        = {}; // network byte order
+  uint16_t remote_port_range[2]      = {}; // host byte order
   uint32_t security_parameter_index  = {};
   uint8_t  type_of_service           = {};
   uint8_t  type_of_service_mask      = {};
@@ -106,6 +109,82 @@ public:
   bool match_port(const srsran::unique_byte_buffer_t& pdu);
 };
 
+typedef std::map<uint16_t, tft_packet_filter_t> tft_filter_map_t;
+
+/**
+ * Decision structure compiled from the packet filters of a TFT, rebuilt whenever the filters change.
+ *
+ * It narrows down, from the destination address (prefix trie per IP version) and destination port (sorted port
+ * segments) of an outgoing packet, the filters that may match it. Only those are then evaluated with
+ * tft_packet_filter_t::match(). Filters are indexed by evaluation precedence, so visiting the candidates in ascending
+ * index order yields the same first match as a linear scan of the TFT.
+ */
+class tft_classifier
+{
+public:
+  static const uint32_t MAX_NOF_FILTERS = 256; ///< eval_precedence is 8 bits wide
+
+  /// Set of packet filters, indexed by evaluation precedence
+  struct filter_set_t {
+    std::array<uint64_t, MAX_NOF_FILTERS / 64> words = {};
+
+    void          set(uint32_t idx) { words[idx / 64] |= (1ULL << (idx % 64)); }
+    filter_set_t& operator|=(const filter_set_t& other);
+    filter_set_t& operator&=(const filter_set_t& other);
+
+    /// Calls f(idx) for each index of the set in ascending order, until f returns true
+    template <typename F>
+    bool find_first(F&& f) const
+    {
+      for (uint32_t w = 0; w < words.size(); ++w) {
+        for (uint64_t bits = words[w]; bits != 0; bits &= bits - 1) {
+          if (f(w * 64 + __builtin_ctzll(bits))) {
+            return true;
+          }
+        }
+      }
+      return false;
+    }
+  };
+
+  void compile(tft_filter_map_t& filter_map);
+
+  /// Filters that may match the given outgoing packet
+  filter_set_t candidates(const srsran::unique_byte_buffer_t& pdu) const;
+
+  tft_packet_filter_t* get_filter(uint32_t idx) const { return filters[idx]; }
+
+private:
+  struct trie_node {
+    int32_t      child[2] = {-1, -1};
+    filter_set_t filters; ///< filters whose address prefix ends at this node
+  };
+
+  /// Binary trie over the remote address prefixes of the filters of one IP version
+  struct addr_trie {
+    std::vector<trie_node> nodes;
+    filter_set_t           any_addr; ///< filters that do not constrain the remote address of this IP version
+
+    void         clear();
+    void         insert(const uint8_t* addr, uint32_t prefix_len, uint32_t idx);
+    filter_set_t lookup(const uint8_t* addr, uint32_t nof_bits) const;
+  };
+
+  /// Remote port segment [start, start of the next segment - 1], with the filters whose remote port covers it
+  struct port_segment {
+    uint32_t     start;
+    filter_set_t filters;
+  };
+
+  std::array<tft_packet_filter_t*, MAX_NOF_FILTERS> filters = {};
+  filter_set_t                                      all_filters;
+  addr_trie                                         ipv4_trie;
+  addr_trie                                         ipv6_trie;
+  std::vector<port_segment>                         remote_port_segments;
+  filter_set_t                                      any_remote_port; ///< filters without remote port component
+  filter_set_t                                      no_port;         ///< filters without any port component
+};
+
 /**
  * TFT PDU matcher class used by GW and TTCN3 DUT testloop handler
  */
@@ -123,10 +202,12 @@ public:
   void    delete_tft_for_eps_bearer(const uint8_t eps_bearer_id);
 
 private:
-  srslog::basic_logger&                           logger;
-  std::mutex                                      tft_mutex;
-  typedef std::map<uint16_t, tft_packet_filter_t> tft_filter_map_t;
-  tft_filter_map_t                                tft_filter_map;
+  int apply_tft_operation(const uint8_t& eps_bearer_id, const LIBLTE_MME_TRAFFIC_FLOW_TEMPLATE_STRUCT* tft);
+
+  srslog::basic_logger& logger;
+  std::mutex            tft_mutex;
+  tft_filter_map_t      tft_filter_map;
+  tft_classifier        classifier;
 };
 
 } // namespace srsue
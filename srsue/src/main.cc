@@ -201,9 +201,11 @@ static int parse_args(all_args_t* args, int argc, char* argv[])
     ("gw.netns", bpo::value<string>(&args->gw.netns)->default_value(""), "Network namespace to for TUN device (empty for default netns)")
     ("gw.ip_devname", bpo::value<string>(&args->gw.tun_dev_name)->default_value("tun_srsue"), "Name of the tun_srsue device")
     ("gw.ip_netmask", bpo::value<string>(&args->gw.tun_dev_netmask)->default_value("255.255.255.0"), "Netmask of the tun_srsue device")
+    ("gw.tun_read_batch", bpo::value<uint32_t>(&args->gw.tun_read_batch)->default_value(1), "Maximum number of IP packets read from the TUN device per wakeup (1 reads one packet at a time)")
 
     /* Downlink Channel emulator section */
     ("channel.dl.enable",            bpo::value<bool>(&args->phy.dl_channel_args.enable)->default_value(false),                 "Enable/Disable internal Downlink channel emulator")
+    ("channel.dl.nof_threads",       bpo::value<uint32_t>(&args->phy.dl_channel_args.nof_threads)->default_value(0),            "Worker threads of the Downlink channel emulator, 0 runs it in the radio thread")
     ("channel.dl.awgn.enable",       bpo::value<bool>(&args->phy.dl_channel_args.awgn_enable)->default_value(false),            "Enable/Disable AWGN simulator")
     ("channel.dl.awgn.snr",          bpo::value<float>(&args->phy.dl_channel_args.awgn_snr_dB)->default_value(30.0f),           "SNR in dB")
     ("channel.dl.awgn.signal_power", bpo::value<float>(&args->phy.dl_channel_args.awgn_signal_power_dBfs)->default_value(0.0f), "Received signal power in decibels full scale (dBfs)")
@@ -224,6 +226,7 @@ static int parse_args(all_args_t* args, int argc, char* argv[])
 
     /* Uplink Channel emulator section */
     ("channel.ul.enable",            bpo::value<bool>(&args->phy.ul_channel_args.enable)->default_value(false),                  "Enable/Disable internal Downlink channel emulator")
+    ("channel.ul.nof_threads",       bpo::value<uint32_t>(&args->phy.ul_channel_args.nof_threads)->default_value(0),             "Worker threads of the Uplink channel emulator, 0 runs it in the radio thread")
     ("channel.ul.awgn.enable",       bpo::value<bool>(&args->phy.ul_channel_args.awgn_enable)->default_value(false),             "Enable/Disable AWGN simulator")
     ("channel.ul.awgn.snr",          bpo::value<float>(&args->phy.ul_channel_args.awgn_snr_dB)->default_value(30.0f),            "Noise level in decibels full scale (dBfs)")
     ("channel.ul.awgn.signal_power", bpo::value<float>(&args->phy.ul_channel_args.awgn_signal_power_dBfs)->default_value(30.0f), "Transmitted signal power in decibels full scale (dBfs)")
@@ -386,6 +389,10 @@ static int parse_args(all_args_t* args, int argc, char* argv[])
        bpo::value<bool>(&args->phy.pdsch_8bit_decoder)->default_value(false),
        "Use 8-bit for LLR representation and turbo decoder trellis computation (Experimental)")
 
+    ("phy.pdsch_tdec_threads",
+       bpo::value<uint32_t>(&args->phy.pdsch_tdec_threads)->default_value(0),
+       "Number of threads used to decode the PDSCH code blocks of a transport block in parallel (0 disables it)")
+
     ("phy.force_ul_amplitude",
        bpo::value<float>(&args->phy.force_ul_amplitude)->default_value(0.0),
        "Forces the peak amplitude in the PUCCH, PUSCH and SRS (set 0.0 to 1.0, set to 0 or negative for disabling)")
@@ -423,6 +430,10 @@ static int parse_args(all_args_t* args, int argc, char* argv[])
       bpo::value<bool>(&args->phy.nr_store_pdsch_ko)->default_value(false),
       "Dumps the PDSCH baseband samples into a file on KO reception.")
 
+    ("phy.nr.pdsch_ldpc_threads",
+      bpo::value<uint32_t>(&args->phy.nr_pdsch_ldpc_threads)->default_value(0),
+      "Number of threads used to decode the NR PDSCH code blocks of a transport block in parallel (0 disables it)")
+
     // UE simulation args
     ("sim.airplane_t_on_ms",
      bpo::value<int>(&args->stack.nas.sim.airplane_t_on_ms)->default_value(-1),
@@ -619,8 +630,8 @@ static int parse_args(all_args_t* args, int argc, char* argv[])
     }
   }
 
-  // Set sync queue capacity to 1 for ZMQ
-  if (args->rf.device_name == "zmq") {
+  // Set sync queue capacity to 1 for ZMQ and shared memory
+  if (args->rf.device_name == "zmq" || args->rf.device_name == "shm") {
     args->stack.sync_queue_size = 1;
   } else {
     // use default size
@@ -101,6 +101,7 @@ cc_worker::cc_worker(uint32_t cc_idx_, uint32_t max_prb, srsue::phy_common* phy_
     ue_dl.pdsch.llr_is_8bit        = true;
     ue_dl.pdsch.dl_sch.llr_is_8bit = true;
   }
+  srsran_sch_set_cb_pool(&ue_dl.pdsch.dl_sch, phy->get_tdec_pool());
 }
 
 cc_worker::~cc_worker()
@@ -349,7 +350,7 @@ bool cc_worker::work_dl_mbsfn(srsran_mbsfn_cfg_t mbsfn_cfg)
     phy->stack->mch_decoded((uint32_t)pmch_cfg.pdsch_cfg.grant.tb[0].tbs / 8, mch_decoded);
   } else if (mbsfn_cfg.is_mcch) {
     // release lock in phy_common
-    phy->set_mch_period_stop(0);
+    phy->set_mch_period_stop(0, 0);
   }
 
   /* Decode PHICH */
@@ -45,6 +45,7 @@ cc_worker::cc_worker(uint32_t cc_idx_, srslog::basic_logger& log, state& phy_sta
     ERROR("Error initiating UE DL NR");
     return;
   }
+  srsran_sch_nr_set_cb_pool(&ue_dl.pdsch.sch, phy.ldpc_pool);
 
   if (srsran_ue_ul_nr_init(&ue_ul, tx_buffer[0], &phy.args.ul) < SRSRAN_SUCCESS) {
     ERROR("Error initiating UE DL NR");
@@ -26,6 +26,15 @@ namespace nr {
 
 worker_pool::worker_pool(uint32_t max_workers) : pool(max_workers), logger(srslog::fetch_basic_logger("PHY-NR")) {}
 
+worker_pool::~worker_pool()
+{
+  // Workers are destroyed before the pool, so no code block decoding is in progress
+  workers.clear();
+  if (ldpc_enabled) {
+    srsran_sch_cb_pool_free(&ldpc_pool);
+  }
+}
+
 bool worker_pool::init(const phy_args_nr_t&          args,
                        srsran::phy_common_interface& common,
                        stack_interface_phy_nr*       stack_,
@@ -57,6 +66,17 @@ bool worker_pool::init(const phy_args_nr_t&          args,
     return true;
   }
 
+  // Create the PDSCH code block decoder threads shared by all workers, using the same decoder configuration
+  if (args.pdsch_ldpc_threads > 0 and not ldpc_enabled) {
+    if (srsran_sch_nr_cb_pool_init(&ldpc_pool, args.pdsch_ldpc_threads, &phy_state.args.dl.pdsch.sch) <
+        SRSRAN_SUCCESS) {
+      logger.error("Error initiating PDSCH code block decoder pool");
+      return false;
+    }
+    ldpc_enabled        = true;
+    phy_state.ldpc_pool = &ldpc_pool;
+  }
+
   // Add workers to workers pool and start threads
   for (uint32_t i = 0; i < args.nof_phy_threads; i++) {
     auto& log = srslog::fetch_basic_logger(fmt::format("{}PHY{}-NR", args.log.id_preamble, i));
@@ -621,13 +621,22 @@ void phy::set_config_mbsfn_mcch(const srsran::mcch_msg_t& mcch)
 {
   common.mbsfn_config.mcch = mcch;
   stack->set_mbsfn_config(common.mbsfn_config.mcch.pmch_info_list[0].nof_mbms_session_info);
-  common.set_mch_period_stop(common.mbsfn_config.mcch.pmch_info_list[0].sf_alloc_end);
+  common.set_mch_period_stop(0, common.mbsfn_config.mcch.pmch_info_list[0].sf_alloc_end);
   common.set_mcch();
 }
 
-void phy::set_mch_period_stop(uint32_t stop)
+void phy::set_mch_period_stop(uint32_t lcid, uint32_t stop)
 {
-  common.set_mch_period_stop(stop);
+  const srsran::mcch_msg_t& mcch = common.mbsfn_config.mcch;
+  for (uint32_t i = 0; i < mcch.nof_pmch_info; i++) {
+    for (uint32_t j = 0; j < mcch.pmch_info_list[i].nof_mbms_session_info; j++) {
+      if (mcch.pmch_info_list[i].mbms_session_info_list[j].lc_ch_id == lcid) {
+        common.set_mch_period_stop(i, stop);
+        return;
+      }
+    }
+  }
+  logger_phy.warning("Received MCH period stop for unknown MTCH LCID=%d", lcid);
 }
 
 int phy::init(const phy_args_nr_t& args_, stack_interface_phy_nr* stack_, srsran::radio_interface_phy* radio_)
@@ -47,7 +47,12 @@ phy_common::phy_common(srslog::basic_logger& logger) : logger(logger), ta(logger
   reset();
 }
 
-phy_common::~phy_common() = default;
+phy_common::~phy_common()
+{
+  if (tdec_enabled) {
+    srsran_sch_cb_pool_free(&tdec_pool);
+  }
+}
 
 void phy_common::init(phy_args_t*                  _args,
                       srsran::radio_interface_phy* _radio,
@@ -65,6 +70,15 @@ void phy_common::init(phy_args_t*                  _args,
     ul_channel = srsran::channel_ptr(
         new srsran::channel(args->ul_channel_args, args->nof_lte_carriers * args->nof_rx_ant, logger));
   }
+
+  // Create PDSCH code block decoding threads
+  if (args->pdsch_tdec_threads > 0 and not tdec_enabled) {
+    if (srsran_sch_cb_pool_init(&tdec_pool, args->pdsch_tdec_threads) < SRSRAN_SUCCESS) {
+      logger.error("Error initiating PDSCH code block decoding pool");
+    } else {
+      tdec_enabled = true;
+    }
+  }
 }
 
 void phy_common::set_ue_dl_cfg(srsran_ue_dl_cfg_t* ue_dl_cfg)
@@ -985,12 +999,24 @@ void phy_common::set_mcch()
   mcch_configured = true;
 }
 
-void phy_common::set_mch_period_stop(uint32_t stop)
+void phy_common::set_mch_period_stop(uint32_t pmch_idx, uint32_t stop)
 {
   std::lock_guard<std::mutex> lock(mtch_mutex);
-  have_mtch_stop  = true;
-  mch_period_stop = stop;
-  mtch_cvar.notify_one();
+  if (pmch_idx >= sizeof(mch_period_stop) / sizeof(mch_period_stop[0])) {
+    return;
+  }
+  mch_period_stop[pmch_idx] = stop;
+  if (pmch_idx == 0) {
+    // The MSI of the first PMCH starts a new period. The other PMCHs are fully decoded until their own MSI is received
+    const srsran::mcch_msg_t& mcch     = mbsfn_config.mcch;
+    uint32_t                  first_sf = mcch.pmch_info_list[0].sf_alloc_end + 1;
+    for (uint32_t i = 1; i < mcch.nof_pmch_info and i < sizeof(mch_period_stop) / sizeof(mch_period_stop[0]); i++) {
+      mch_period_stop[i] = mcch.pmch_info_list[i].sf_alloc_end - first_sf;
+      first_sf           = mcch.pmch_info_list[i].sf_alloc_end + 1;
+    }
+    have_mtch_stop = true;
+    mtch_cvar.notify_one();
+  }
 }
 
 uint32_t phy_common::get_ul_earfcn(uint32_t dl_earfcn)
@@ -1047,26 +1073,29 @@ bool phy_common::is_mch_subframe(srsran_mbsfn_cfg_t* cfg, uint32_t phy_tti)
         cfg->non_mbsfn_region_length = enum_to_number(area_info.non_mbsfn_region_len);
         if (mcch_configured) {
           // Iterate through PMCH configs to see which one applies in the current frame
-          srsran::mcch_msg_t& mcch = mbsfn_config.mcch;
-          uint32_t            mbsfn_per_frame =
-              mcch.pmch_info_list[0].sf_alloc_end / enum_to_number(mcch.pmch_info_list[0].mch_sched_period);
-          uint32_t                     frame_alloc_idx = sfn % enum_to_number(mcch.common_sf_alloc_period);
-          uint32_t                     sf_alloc_idx = frame_alloc_idx * mbsfn_per_frame + ((sf < 4) ? sf - 1 : sf - 3);
+          srsran::mcch_msg_t&  mcch      = mbsfn_config.mcch;
+          srsran::pmch_info_t& last_pmch = mcch.pmch_info_list[mcch.nof_pmch_info > 0 ? mcch.nof_pmch_info - 1 : 0];
+
+          uint32_t mbsfn_per_frame = last_pmch.sf_alloc_end / enum_to_number(last_pmch.mch_sched_period);
+          uint32_t frame_alloc_idx = sfn % enum_to_number(mcch.common_sf_alloc_period);
+          uint32_t sf_alloc_idx    = frame_alloc_idx * mbsfn_per_frame + ((sf < 4) ? sf - 1 : sf - 3);
+
           std::unique_lock<std::mutex> lock(mtch_mutex);
           while (!have_mtch_stop) {
             mtch_cvar.wait(lock);
           }
-          lock.unlock();
 
+          // Each PMCH occupies the subframes that follow the previous one, and its MSI stop is relative to its first
+          uint32_t first_sf = 0;
           for (uint32_t i = 0; i < mcch.nof_pmch_info; i++) {
-            if (sf_alloc_idx <= mch_period_stop) {
-              // trigger conditional variable, has ot be untriggered by mtch stop location
+            if (sf_alloc_idx <= mcch.pmch_info_list[i].sf_alloc_end) {
               cfg->mbsfn_mcs = mcch.pmch_info_list[i].data_mcs;
-              cfg->enable    = true;
-            } else {
-              // have_mtch_stop = false;
+              cfg->enable    = sf_alloc_idx - first_sf <= mch_period_stop[i];
+              break;
             }
+            first_sf = mcch.pmch_info_list[i].sf_alloc_end + 1;
           }
+          lock.unlock();
           Debug("MCH subframe TTI:%d", phy_tti);
         }
         return true;
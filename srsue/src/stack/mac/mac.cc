@@ -340,14 +340,22 @@ void mac::mch_decoded(uint32_t len, bool crc)
     mch_msg.init_rx(len);
     mch_msg.parse_packet(mch_payload_buffer);
     while (mch_msg.next()) {
-      for (uint32_t i = 0; i < phy_mbsfn_cfg.nof_mbsfn_services; i++) {
-        if (srsran::mch_lcid::MCH_SCHED_INFO == mch_msg.get()->mch_ce_type()) {
-          uint16_t stop;
-          uint8_t  lcid;
-          if (mch_msg.get()->get_next_mch_sched_info(&lcid, &stop)) {
-            phy_h->set_mch_period_stop(stop);
-            Info("MCH Sched Info: LCID: %d, Stop: %d, tti is %d ", lcid, stop, phy_h->get_current_tti());
-          }
+      if (srsran::mch_lcid::MCH_SCHED_INFO == mch_msg.get()->mch_ce_type()) {
+        // All the MTCHs of an MSI belong to the same PMCH, whose period stop is the last stop among them. MTCHs that
+        // are not scheduled in the period (MTCH_STOP_EMPTY) are read with a stop of 0
+        uint16_t stop;
+        uint8_t  lcid;
+        uint16_t pmch_stop = 0;
+        uint32_t nof_msi   = 0;
+        uint8_t  msi_lcid  = 0;
+        while (mch_msg.get()->get_next_mch_sched_info(&lcid, &stop)) {
+          Info("MCH Sched Info: LCID: %d, Stop: %d, tti is %d ", lcid, stop, phy_h->get_current_tti());
+          msi_lcid  = (nof_msi == 0) ? lcid : msi_lcid;
+          pmch_stop = std::max(pmch_stop, stop);
+          nof_msi++;
+        }
+        if (nof_msi > 0) {
+          phy_h->set_mch_period_stop(msi_lcid, pmch_stop);
         }
       }
     }
@@ -151,7 +151,7 @@ public:
 
   void sr_send() override{};
   int  sr_last_tx_tti() override { return 0; };
-  void set_mch_period_stop(uint32_t stop) override{};
+  void set_mch_period_stop(uint32_t lcid, uint32_t stop) override{};
 
   // phy_interface_mac_common
   void set_timeadv_rar(uint32_t tti, uint32_t ta_cmd) override { rar_time_adv = ta_cmd; }
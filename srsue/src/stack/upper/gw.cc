@@ -32,6 +32,7 @@
 #include <linux/netlink.h>
 #include <linux/rtnetlink.h>
 #include <netinet/in.h>
+#include <poll.h>
 #include <sys/ioctl.h>
 #include <sys/socket.h>
 #include <unistd.h>
@@ -254,6 +255,27 @@ int gw::apply_traffic_flow_template(const uint8_t& erab_id, const LIBLTE_MME_TRA
   return tft_matcher.apply_traffic_flow_template(erab_id, tft);
 }
 
+int gw::setup_if_fd(uint32_t eps_bearer_id, int32_t fd)
+{
+  if (running) {
+    run_enable = false;
+    thread_cancel();
+    wait_thread_finish();
+  }
+  if (tun_fd > 0) {
+    close(tun_fd);
+  }
+  tun_fd = fd;
+  if_up  = true;
+
+  default_eps_bearer_id = static_cast<int>(eps_bearer_id);
+
+  run_enable = true;
+  start(GW_THREAD_PRIO);
+
+  return SRSRAN_SUCCESS;
+}
+
 void gw::set_test_loop_mode(const test_loop_mode_state_t mode, const uint32_t ip_pdu_delay_ms)
 {
   logger.error("UE test loop mode not supported");
@@ -274,6 +296,11 @@ void gw::add_mch_port(uint32_t lcid, uint32_t port)
 /********************/
 void gw::run_thread()
 {
+  if (args.tun_read_batch > 1) {
+    run_thread_batched();
+    return;
+  }
+
   uint32 idx     = 0;
   int32  N_bytes = 0;
 
@@ -283,9 +310,6 @@ void gw::run_thread()
     return;
   }
 
-  const static uint32_t REGISTER_WAIT_TOUT = 40, SERVICE_WAIT_TOUT = 40; // 4 sec
-  uint32_t              register_wait = 0, service_wait = 0;
-
   logger.info("GW IP packet receiver thread run_enable");
 
   running = true;
@@ -325,63 +349,16 @@ void gw::run_thread()
 
       // Check if entire packet was received
       if (pkt_len == pdu->N_bytes) {
-        logger.info(pdu->msg, pdu->N_bytes, "TX PDU");
-
-        // Make sure UE is attached and has default EPS bearer activated
-        while (run_enable && default_eps_bearer_id == NOT_ASSIGNED && register_wait < REGISTER_WAIT_TOUT) {
-          if (!register_wait) {
-            logger.info("UE is not attached, waiting for NAS attach (%d/%d)", register_wait, REGISTER_WAIT_TOUT);
-          }
-          lock.unlock();
-          std::this_thread::sleep_for(std::chrono::microseconds(100));
-          lock.lock();
-          register_wait++;
-        }
-        register_wait = 0;
-
-        // If we are still not attached by this stage, drop packet
-        if (run_enable && default_eps_bearer_id == NOT_ASSIGNED) {
-          continue;
-        }
-
-        if (!run_enable) {
-          break;
-        }
-
-        // Beyond this point we should have a activated default EPS bearer
-        srsran_assert(default_eps_bearer_id != NOT_ASSIGNED, "Default EPS bearer not activated");
-
-        uint8_t eps_bearer_id = default_eps_bearer_id;
-        tft_matcher.check_tft_filter_match(pdu, eps_bearer_id);
-
-        // Wait for service request if necessary
-        while (run_enable && !stack->has_active_radio_bearer(eps_bearer_id) && service_wait < SERVICE_WAIT_TOUT) {
-          if (!service_wait) {
-            logger.info(
-                "UE does not have service, waiting for NAS service request (%d/%d)", service_wait, SERVICE_WAIT_TOUT);
-            stack->start_service_request();
-          }
-          usleep(100000);
-          service_wait++;
-        }
-        service_wait = 0;
-
-        // Quit before writing packet if necessary
-        if (!run_enable) {
+        if (!write_ul_pdu(pdu, lock)) {
           break;
         }
-
-        // Send PDU directly to PDCP
-        pdu->set_timestamp();
-        ul_tput_bytes += pdu->N_bytes;
-        stack->write_sdu(eps_bearer_id, std::move(pdu));
-        do {
+        while (!pdu) {
           pdu = srsran::make_byte_buffer();
           if (!pdu) {
             logger.error("Fatal Error: Couldn't allocate PDU in run_thread().");
             usleep(100000);
           }
-        } while (!pdu);
+        }
         idx = 0;
       } else {
         idx += N_bytes;
@@ -393,6 +370,164 @@ void gw::run_thread()
   logger.info("GW IP receiver thread exiting.");
 }
 
+/**
+ * Receive loop used when more than one packet can be read per wakeup. The TUN device only returns one packet per
+ * read(), so the descriptor is drained with non-blocking reads once poll() reports it readable. The packets of a batch
+ * are then validated and handed to the stack under a single gw_mutex acquisition, and the buffers are replenished
+ * outside of it.
+ */
+void gw::run_thread_batched()
+{
+  std::vector<srsran::unique_byte_buffer_t> batch(args.tun_read_batch);
+
+  int flags = fcntl(tun_fd, F_GETFL);
+  if (flags < 0 || fcntl(tun_fd, F_SETFL, flags | O_NONBLOCK) < 0) {
+    logger.error("Failed to set non-blocking TUN fd=%d - gw receive thread exiting.", tun_fd);
+    return;
+  }
+
+  logger.info("GW IP packet receiver thread run_enable (batch=%d)", args.tun_read_batch);
+
+  running = true;
+  while (run_enable) {
+    // Replace the buffers that were handed to the stack
+    for (srsran::unique_byte_buffer_t& pdu : batch) {
+      while (!pdu) {
+        pdu = srsran::make_byte_buffer();
+        if (!pdu) {
+          logger.error("Fatal Error: Couldn't allocate PDU in run_thread_batched().");
+          usleep(100000);
+        }
+      }
+    }
+
+    struct pollfd pfd = {tun_fd, POLLIN, 0};
+    if (poll(&pfd, 1, -1) < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      logger.error("Failed to poll TUN interface - gw receive thread exiting.");
+      srsran::console("Failed to poll TUN interface - gw receive thread exiting.\n");
+      break;
+    }
+
+    uint32_t nof_pdus   = 0;
+    bool     read_error = false;
+    while (nof_pdus < batch.size()) {
+      int32_t N_bytes = read(tun_fd, batch[nof_pdus]->msg, SRSRAN_MAX_BUFFER_SIZE_BYTES - SRSRAN_BUFFER_HEADER_OFFSET);
+      if (N_bytes < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+        break;
+      }
+      if (N_bytes <= 0) {
+        read_error = true;
+        break;
+      }
+      batch[nof_pdus++]->N_bytes = N_bytes;
+    }
+    logger.debug("Read %d packets from TUN fd=%d", nof_pdus, tun_fd);
+
+    bool exit_thread = false;
+    {
+      std::unique_lock<std::mutex> lock(gw_mutex);
+      for (uint32_t i = 0; i < nof_pdus && !exit_thread; ++i) {
+        srsran::unique_byte_buffer_t& pdu     = batch[i];
+        struct iphdr*                 ip_pkt  = (struct iphdr*)pdu->msg;
+        struct ipv6hdr*               ip6_pkt = (struct ipv6hdr*)pdu->msg;
+        uint16_t                      pkt_len = 0;
+        if (ip_pkt->version == 4) {
+          pkt_len = ntohs(ip_pkt->tot_len);
+        } else if (ip_pkt->version == 6) {
+          pkt_len = ntohs(ip6_pkt->payload_len) + 40;
+        } else {
+          logger.error(pdu->msg, pdu->N_bytes, "Unsupported IP version. Dropping packet.");
+          continue;
+        }
+
+        // Each read() returns a single packet
+        if (pkt_len != pdu->N_bytes) {
+          logger.warning("Incomplete IPv%d packet read from TUN. Total Length %d, N_Bytes %d. Dropping packet.",
+                         int(ip_pkt->version),
+                         pkt_len,
+                         pdu->N_bytes);
+          continue;
+        }
+        exit_thread = !write_ul_pdu(pdu, lock);
+      }
+    } // end of holding gw_mutex
+
+    if (exit_thread) {
+      break;
+    }
+    if (read_error) {
+      logger.error("Failed to read from TUN interface - gw receive thread exiting.");
+      srsran::console("Failed to read from TUN interface - gw receive thread exiting.\n");
+      break;
+    }
+  }
+  running = false;
+  logger.info("GW IP receiver thread exiting.");
+}
+
+/**
+ * Sends a complete IP packet read from the TUN device to the stack, after waiting for the UE to be attached and for the
+ * radio bearer the packet maps to be active. Must be called with gw_mutex held.
+ * @return false if the receiver thread has to exit. The PDU is left untouched if it was dropped.
+ */
+bool gw::write_ul_pdu(srsran::unique_byte_buffer_t& pdu, std::unique_lock<std::mutex>& lock)
+{
+  const static uint32_t REGISTER_WAIT_TOUT = 40, SERVICE_WAIT_TOUT = 40; // 4 sec
+  uint32_t              register_wait = 0, service_wait = 0;
+
+  logger.info(pdu->msg, pdu->N_bytes, "TX PDU");
+
+  // Make sure UE is attached and has default EPS bearer activated
+  while (run_enable && default_eps_bearer_id == NOT_ASSIGNED && register_wait < REGISTER_WAIT_TOUT) {
+    if (!register_wait) {
+      logger.info("UE is not attached, waiting for NAS attach (%d/%d)", register_wait, REGISTER_WAIT_TOUT);
+    }
+    lock.unlock();
+    std::this_thread::sleep_for(std::chrono::microseconds(100));
+    lock.lock();
+    register_wait++;
+  }
+
+  // If we are still not attached by this stage, drop packet
+  if (run_enable && default_eps_bearer_id == NOT_ASSIGNED) {
+    return true;
+  }
+
+  if (!run_enable) {
+    return false;
+  }
+
+  // Beyond this point we should have a activated default EPS bearer
+  srsran_assert(default_eps_bearer_id != NOT_ASSIGNED, "Default EPS bearer not activated");
+
+  uint8_t eps_bearer_id = default_eps_bearer_id;
+  tft_matcher.check_tft_filter_match(pdu, eps_bearer_id);
+
+  // Wait for service request if necessary
+  while (run_enable && !stack->has_active_radio_bearer(eps_bearer_id) && service_wait < SERVICE_WAIT_TOUT) {
+    if (!service_wait) {
+      logger.info("UE does not have service, waiting for NAS service request (%d/%d)", service_wait, SERVICE_WAIT_TOUT);
+      stack->start_service_request();
+    }
+    usleep(100000);
+    service_wait++;
+  }
+
+  // Quit before writing packet if necessary
+  if (!run_enable) {
+    return false;
+  }
+
+  // Send PDU directly to PDCP
+  pdu->set_timestamp();
+  ul_tput_bytes += pdu->N_bytes;
+  stack->write_sdu(eps_bearer_id, std::move(pdu));
+  return true;
+}
+
 /**************************/
 /* TUN Interface Helpers  */
 /**************************/
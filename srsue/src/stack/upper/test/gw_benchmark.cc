@@ -0,0 +1,302 @@
+/**
+ * Copyright 2013-2021 Software Radio Systems Limited
+ *
+ * This file is part of srsRAN.
+ *
+ * srsRAN is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of
+ * the License, or (at your option) any later version.
+ *
+ * srsRAN is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * A copy of the GNU Affero General Public License can be found in
+ * the LICENSE file in the top-level directory of this distribution
+ * and at http://www.gnu.org/licenses/.
+ *
+ */
+
+#include "srsran/common/int_helpers.h"
+#include "srsran/common/test_common.h"
+#include "srsran/interfaces/ue_pdcp_interfaces.h"
+#include "srsran/srslog/srslog.h"
+#include "srsue/hdr/stack/upper/gw.h"
+
+#include <arpa/inet.h>
+#include <atomic>
+#include <chrono>
+#include <linux/ip.h>
+#include <linux/udp.h>
+#include <sys/socket.h>
+#include <thread>
+#include <unistd.h>
+
+namespace srsue {
+
+const uint32_t DEFAULT_EPS_BEARER_ID = 5;
+const uint32_t TFT_EPS_BEARER_ID     = 6;
+const uint32_t DECOY_EPS_BEARER_ID   = 7;
+
+class stack_dummy : public stack_interface_gw
+{
+public:
+  bool is_registered() { return true; }
+  bool start_service_request() { return true; }
+  void write_sdu(uint32_t eps_bearer_id, srsran::unique_byte_buffer_t sdu)
+  {
+    if (eps_bearer_id == TFT_EPS_BEARER_ID) {
+      nof_tft_sdus++;
+    }
+    nof_bytes += sdu->N_bytes;
+    nof_sdus++;
+  }
+  bool has_active_radio_bearer(uint32_t eps_bearer_id) { return true; }
+
+  std::atomic<uint32_t> nof_sdus{0};
+  std::atomic<uint32_t> nof_tft_sdus{0};
+  std::atomic<uint64_t> nof_bytes{0};
+};
+
+/// GW that exposes its test interface
+class gw_tester : public gw
+{
+public:
+  using gw::gw;
+  using gw::setup_if_fd;
+};
+
+struct run_params {
+  uint32_t tun_read_batch;
+  uint32_t nof_filters; ///< Packet filters installed, only the last one matches the generated packets
+  uint32_t pkt_size;
+  uint32_t nof_pkts;
+};
+
+struct run_data {
+  run_params params;
+  float      ul_tput_mbps;
+  float      kpkts_per_sec;
+  float      tft_classify_ns; ///< Time to classify one packet with the compiled TFT
+  float      tft_linear_ns;   ///< Time to classify one packet by scanning the packet filters in precedence order
+};
+
+/// IPv4/UDP packet towards 10.0.x.y:<5000 + idx % 1000>
+void fill_ul_packet(uint8_t* buf, uint32_t pkt_size, uint32_t idx)
+{
+  memset(buf, 0, pkt_size);
+  struct iphdr* ip_pkt = (struct iphdr*)buf;
+  ip_pkt->version      = 4;
+  ip_pkt->ihl          = 5;
+  ip_pkt->tot_len      = htons(pkt_size);
+  ip_pkt->ttl          = 64;
+  ip_pkt->protocol     = UDP_PROTOCOL;
+  ip_pkt->saddr        = htonl(0xac100302);
+  ip_pkt->daddr        = htonl(0x0a000000 | (idx & 0xffff));
+  struct udphdr* udp   = (struct udphdr*)&buf[sizeof(iphdr)];
+  udp->source          = htons(2152);
+  udp->dest            = htons(5000 + idx % 1000);
+  udp->len             = htons(pkt_size - sizeof(iphdr));
+}
+
+/// Filter k covers 192.168.k.0/24 and remote ports [k * 10, k * 10 + 9], the last one 10.0.0.0/8 and ports 5000-5999
+void fill_packet_filter(LIBLTE_MME_PACKET_FILTER_STRUCT& filter, uint32_t k, bool last)
+{
+  uint32_t addr          = last ? 0x0a000000 : (0xc0a80000 | (k << 8));
+  uint32_t mask          = last ? 0xff000000 : 0xffffff00;
+  filter.dir             = LIBLTE_MME_TFT_PACKET_FILTER_DIRECTION_BIDIRECTIONAL;
+  filter.id              = k + 1;
+  filter.eval_precedence = k;
+  filter.filter[0]       = IPV4_REMOTE_ADDR_TYPE;
+  srsran::uint32_to_uint8(addr, &filter.filter[1]);
+  srsran::uint32_to_uint8(mask, &filter.filter[5]);
+  filter.filter[9] = REMOTE_PORT_RANGE_TYPE;
+  srsran::uint16_to_uint8(last ? 5000 : k * 10, &filter.filter[10]);
+  srsran::uint16_to_uint8(last ? 5999 : k * 10 + 9, &filter.filter[12]);
+  filter.filter_size = 14;
+}
+
+/**
+ * Installs nof_filters packet filters. The non-matching ones are spread over TFTs of DECOY_EPS_BEARER_ID, as a TFT
+ * holds at most LIBLTE_MME_PACKET_FILTER_LIST_MAX_SIZE filters, and the matching one goes to TFT_EPS_BEARER_ID.
+ */
+template <typename F>
+int install_packet_filters(uint32_t nof_filters, F&& apply_tft)
+{
+  LIBLTE_MME_TRAFFIC_FLOW_TEMPLATE_STRUCT tft = {};
+  tft.tft_op_code                             = LIBLTE_MME_TFT_OPERATION_CODE_CREATE_NEW_TFT;
+  for (uint32_t k = 0; k < nof_filters; ++k) {
+    bool last = k == nof_filters - 1;
+    fill_packet_filter(tft.packet_filter_list[tft.packet_filter_list_size++], k, last);
+    if (last or tft.packet_filter_list_size == LIBLTE_MME_PACKET_FILTER_LIST_MAX_SIZE or k + 2 == nof_filters) {
+      TESTASSERT(apply_tft(last ? TFT_EPS_BEARER_ID : DECOY_EPS_BEARER_ID, tft) == SRSRAN_SUCCESS);
+      tft.packet_filter_list_size = 0;
+    }
+  }
+  return SRSRAN_SUCCESS;
+}
+
+/// Compares the compiled TFT against a linear scan of the same packet filters
+int run_tft_classification(run_data& r)
+{
+  srslog::basic_logger&            logger = srslog::fetch_basic_logger("GW");
+  tft_pdu_matcher                  matcher(logger);
+  std::vector<tft_packet_filter_t> filters;
+  auto apply_tft = [&matcher, &filters, &logger](uint8_t                                        eps_bearer_id,
+                                                  const LIBLTE_MME_TRAFFIC_FLOW_TEMPLATE_STRUCT& tft) {
+    for (uint32_t i = 0; i < tft.packet_filter_list_size; ++i) {
+      filters.emplace_back(eps_bearer_id, tft.packet_filter_list[i], logger);
+    }
+    return matcher.apply_traffic_flow_template(eps_bearer_id, &tft);
+  };
+  TESTASSERT(install_packet_filters(r.params.nof_filters, apply_tft) == SRSRAN_SUCCESS);
+
+  std::vector<srsran::unique_byte_buffer_t> pdus(1000);
+  for (uint32_t i = 0; i < pdus.size(); ++i) {
+    pdus[i] = srsran::make_byte_buffer();
+    TESTASSERT(pdus[i] != nullptr);
+    fill_ul_packet(pdus[i]->msg, r.params.pkt_size, i);
+    pdus[i]->N_bytes = r.params.pkt_size;
+  }
+
+  const uint32_t nof_rounds  = 100;
+  uint32_t       nof_matches = 0;
+  auto           tp_start    = std::chrono::steady_clock::now();
+  for (uint32_t n = 0; n < nof_rounds; ++n) {
+    for (const srsran::unique_byte_buffer_t& pdu : pdus) {
+      uint8_t eps_bearer_id = DEFAULT_EPS_BEARER_ID;
+      matcher.check_tft_filter_match(pdu, eps_bearer_id);
+      nof_matches += eps_bearer_id == TFT_EPS_BEARER_ID ? 1 : 0;
+    }
+  }
+  std::chrono::duration<float, std::nano> tot_time = std::chrono::steady_clock::now() - tp_start;
+  r.tft_classify_ns                                = tot_time.count() / (nof_rounds * pdus.size());
+  TESTASSERT(r.params.nof_filters == 0 or nof_matches == nof_rounds * pdus.size());
+
+  nof_matches = 0;
+  tp_start    = std::chrono::steady_clock::now();
+  for (uint32_t n = 0; n < nof_rounds; ++n) {
+    for (const srsran::unique_byte_buffer_t& pdu : pdus) {
+      for (tft_packet_filter_t& filter : filters) {
+        if (filter.match(pdu)) {
+          nof_matches += filter.eps_bearer_id == TFT_EPS_BEARER_ID ? 1 : 0;
+          break;
+        }
+      }
+    }
+  }
+  tot_time        = std::chrono::steady_clock::now() - tp_start;
+  r.tft_linear_ns = tot_time.count() / (nof_rounds * pdus.size());
+  TESTASSERT(r.params.nof_filters == 0 or nof_matches == nof_rounds * pdus.size());
+
+  return SRSRAN_SUCCESS;
+}
+
+/**
+ * Writes params.nof_pkts UL IP packets into one end of a SOCK_SEQPACKET socketpair, which keeps packet boundaries like
+ * a TUN device, while the GW reads them from the other end and forwards them to a dummy stack.
+ */
+int run_gw_scenario(const run_params& params, std::vector<run_data>& run_results)
+{
+  gw_args_t gw_args;
+  gw_args.log.gw_level     = "none";
+  gw_args.log.gw_hex_limit = 0;
+  gw_args.tun_read_batch   = params.tun_read_batch;
+
+  stack_dummy stack;
+  gw_tester   gw(srslog::fetch_basic_logger("GW"));
+  TESTASSERT(gw.init(gw_args, &stack) == SRSRAN_SUCCESS);
+
+  auto apply_tft = [&gw](uint8_t eps_bearer_id, const LIBLTE_MME_TRAFFIC_FLOW_TEMPLATE_STRUCT& tft) {
+    return gw.apply_traffic_flow_template(eps_bearer_id, &tft);
+  };
+  TESTASSERT(install_packet_filters(params.nof_filters, apply_tft) == SRSRAN_SUCCESS);
+
+  int fds[2];
+  TESTASSERT(socketpair(AF_UNIX, SOCK_SEQPACKET, 0, fds) == 0);
+  // The GW owns fds[0] from now on
+  TESTASSERT(gw.setup_if_fd(DEFAULT_EPS_BEARER_ID, fds[0]) == SRSRAN_SUCCESS);
+
+  std::vector<uint8_t> buf(params.pkt_size);
+  auto                 tp_start = std::chrono::steady_clock::now();
+  for (uint32_t i = 0; i < params.nof_pkts; ++i) {
+    fill_ul_packet(buf.data(), params.pkt_size, i);
+    TESTASSERT(write(fds[1], buf.data(), buf.size()) == (ssize_t)buf.size());
+  }
+  while (stack.nof_sdus < params.nof_pkts) {
+    std::this_thread::sleep_for(std::chrono::microseconds(10));
+  }
+  std::chrono::duration<float> tot_time = std::chrono::steady_clock::now() - tp_start;
+
+  gw.stop();
+  close(fds[1]);
+  TESTASSERT(stack.nof_bytes == (uint64_t)params.nof_pkts * params.pkt_size);
+  TESTASSERT(params.nof_filters == 0 or stack.nof_tft_sdus == params.nof_pkts);
+
+  run_data r        = {};
+  r.params          = params;
+  r.ul_tput_mbps    = stack.nof_bytes * 8 / 1e6 / tot_time.count();
+  r.kpkts_per_sec   = params.nof_pkts / 1e3 / tot_time.count();
+  TESTASSERT(run_tft_classification(r) == SRSRAN_SUCCESS);
+  run_results.push_back(r);
+  return SRSRAN_SUCCESS;
+}
+
+void print_benchmark_results(const std::vector<run_data>& run_results)
+{
+  fmt::print("run | batch | Nfilter | pkt size | UL tput [Mbps] | kpkt/s | TFT compiled/linear [nsec/pkt]\n");
+  fmt::print("------------------------------------------------------------------------------------------\n");
+  for (uint32_t i = 0; i < run_results.size(); ++i) {
+    const run_data& r = run_results[i];
+    fmt::print("{:>3d}{:>8d}{:>10d}{:>11d}{:>17.1f}{:>9.1f}{:>21.1f}/{:>7.1f}\n",
+               i,
+               r.params.tun_read_batch,
+               r.params.nof_filters,
+               r.params.pkt_size,
+               r.ul_tput_mbps,
+               r.kpkts_per_sec,
+               r.tft_classify_ns,
+               r.tft_linear_ns);
+  }
+}
+
+int run_benchmark(const std::vector<uint32_t>& batch_list,
+                  const std::vector<uint32_t>& nof_filters_list,
+                  const std::vector<uint32_t>& pkt_size_list,
+                  uint32_t                     nof_pkts)
+{
+  std::vector<run_data> run_results;
+  for (uint32_t nof_filters : nof_filters_list) {
+    for (uint32_t pkt_size : pkt_size_list) {
+      for (uint32_t batch : batch_list) {
+        run_params params = {batch, nof_filters, pkt_size, nof_pkts};
+        TESTASSERT(run_gw_scenario(params, run_results) == SRSRAN_SUCCESS);
+      }
+    }
+  }
+
+  print_benchmark_results(run_results);
+
+  return SRSRAN_SUCCESS;
+}
+
+} // namespace srsue
+
+int main(int argc, char** argv)
+{
+  auto& gw_logger = srslog::fetch_basic_logger("GW", false);
+  gw_logger.set_level(srslog::basic_levels::none);
+
+  // Start the log backend.
+  srslog::init();
+
+  if (argc == 1 or strcmp(argv[1], "test") == 0) {
+    TESTASSERT(srsue::run_benchmark({1, 16}, {0, 16}, {1400}, 2000) == SRSRAN_SUCCESS);
+  } else {
+    TESTASSERT(srsue::run_benchmark({1, 4, 16, 64}, {0, 1, 16, 64}, {64, 1400}, 200000) == SRSRAN_SUCCESS);
+  }
+
+  return SRSRAN_SUCCESS;
+}
@@ -409,6 +409,107 @@ int tft_filter_test_ipv4_tos()
   return 0;
 }
 
+void add_packet_filter(LIBLTE_MME_TRAFFIC_FLOW_TEMPLATE_STRUCT& tft,
+                       uint8_t                                  eval_precedence,
+                       const uint8_t*                           filter_message,
+                       uint8_t                                  filter_size)
+{
+  LIBLTE_MME_PACKET_FILTER_STRUCT& packet_filter = tft.packet_filter_list[tft.packet_filter_list_size++];
+  packet_filter.dir                              = LIBLTE_MME_TFT_PACKET_FILTER_DIRECTION_BIDIRECTIONAL;
+  packet_filter.id                               = tft.packet_filter_list_size;
+  packet_filter.eval_precedence                  = eval_precedence;
+  packet_filter.filter_size                      = filter_size;
+  memcpy(packet_filter.filter, filter_message, filter_size);
+}
+
+int tft_matcher_test_precedence()
+{
+  srslog::basic_logger& logger = srslog::fetch_basic_logger("TFT");
+  tft_pdu_matcher       matcher(logger);
+  uint8_t               eps_bearer_id;
+
+  srsran::unique_byte_buffer_t ip_msg1, ip_msg2, ip_msg3;
+  ip_msg1 = make_byte_buffer();
+  TESTASSERT(ip_msg1 != nullptr);
+  ip_msg2 = make_byte_buffer();
+  TESTASSERT(ip_msg2 != nullptr);
+  ip_msg3 = make_byte_buffer();
+  TESTASSERT(ip_msg3 != nullptr);
+
+  // Destination 127.0.0.2:2001
+  ip_msg1->N_bytes = ip_message_len1;
+  memcpy(ip_msg1->msg, ip_tst_message1, ip_message_len1);
+  // Destination 172.16.3.41:9000
+  ip_msg2->N_bytes = ip_message_len2;
+  memcpy(ip_msg2->msg, ip_tst_message2, ip_message_len2);
+  // Destination 172.16.3.41:8500
+  ip_msg3->N_bytes = ip_message_len2;
+  memcpy(ip_msg3->msg, ip_tst_message2, ip_message_len2);
+  srsran::uint16_to_uint8(8500, &ip_msg3->msg[22]);
+
+  // No TFT configured
+  TESTASSERT(matcher.check_tft_filter_match(ip_msg1, eps_bearer_id) == SRSRAN_ERROR);
+
+  // Bearer 5: remote address 172.16.3.0/24 and remote ports 8000-8999
+  uint8_t filter1[14] = {IPV4_REMOTE_ADDR_TYPE};
+  inet_pton(AF_INET, "172.16.3.0", &filter1[1]);
+  inet_pton(AF_INET, "255.255.255.0", &filter1[5]);
+  filter1[9] = REMOTE_PORT_RANGE_TYPE;
+  srsran::uint16_to_uint8(8000, &filter1[10]);
+  srsran::uint16_to_uint8(8999, &filter1[12]);
+  // Bearer 6: remote ports 8500-9500
+  uint8_t filter2[5] = {REMOTE_PORT_RANGE_TYPE};
+  srsran::uint16_to_uint8(8500, &filter2[1]);
+  srsran::uint16_to_uint8(9500, &filter2[3]);
+  // Bearer 7: remote address 127.0.0.0/8
+  uint8_t filter3[9] = {IPV4_REMOTE_ADDR_TYPE};
+  inet_pton(AF_INET, "127.0.0.0", &filter3[1]);
+  inet_pton(AF_INET, "255.0.0.0", &filter3[5]);
+  // Bearer 8: remote address 172.16.3.41/32
+  uint8_t filter4[9] = {IPV4_REMOTE_ADDR_TYPE};
+  inet_pton(AF_INET, "172.16.3.41", &filter4[1]);
+  inet_pton(AF_INET, "255.255.255.255", &filter4[5]);
+
+  LIBLTE_MME_TRAFFIC_FLOW_TEMPLATE_STRUCT tft = {};
+  tft.tft_op_code                             = LIBLTE_MME_TFT_OPERATION_CODE_CREATE_NEW_TFT;
+  tft.packet_filter_list_size                 = 0;
+  add_packet_filter(tft, 10, filter1, sizeof(filter1));
+  TESTASSERT(matcher.apply_traffic_flow_template(5, &tft) == SRSRAN_SUCCESS);
+  tft.packet_filter_list_size = 0;
+  add_packet_filter(tft, 20, filter2, sizeof(filter2));
+  TESTASSERT(matcher.apply_traffic_flow_template(6, &tft) == SRSRAN_SUCCESS);
+  tft.packet_filter_list_size = 0;
+  add_packet_filter(tft, 30, filter3, sizeof(filter3));
+  TESTASSERT(matcher.apply_traffic_flow_template(7, &tft) == SRSRAN_SUCCESS);
+  tft.packet_filter_list_size = 0;
+  add_packet_filter(tft, 40, filter4, sizeof(filter4));
+  TESTASSERT(matcher.apply_traffic_flow_template(8, &tft) == SRSRAN_SUCCESS);
+
+  // The first matching filter in precedence order wins
+  TESTASSERT(matcher.check_tft_filter_match(ip_msg1, eps_bearer_id) == SRSRAN_SUCCESS);
+  TESTASSERT(eps_bearer_id == 7);
+  TESTASSERT(matcher.check_tft_filter_match(ip_msg2, eps_bearer_id) == SRSRAN_SUCCESS);
+  TESTASSERT(eps_bearer_id == 6);
+  // Matches the filters of bearers 5, 6 and 8
+  TESTASSERT(matcher.check_tft_filter_match(ip_msg3, eps_bearer_id) == SRSRAN_SUCCESS);
+  TESTASSERT(eps_bearer_id == 5);
+
+  // The decision structure is rebuilt when filters are removed
+  matcher.delete_tft_for_eps_bearer(6);
+  TESTASSERT(matcher.check_tft_filter_match(ip_msg2, eps_bearer_id) == SRSRAN_SUCCESS);
+  TESTASSERT(eps_bearer_id == 8);
+  matcher.delete_tft_for_eps_bearer(8);
+  eps_bearer_id = 0;
+  TESTASSERT(matcher.check_tft_filter_match(ip_msg2, eps_bearer_id) == SRSRAN_ERROR);
+  TESTASSERT(eps_bearer_id == 0);
+
+  matcher.reset();
+  TESTASSERT(matcher.check_tft_filter_match(ip_msg1, eps_bearer_id) == SRSRAN_ERROR);
+
+  printf("Test TFT matcher precedence successfull\n");
+  return 0;
+}
+
 int main(int argc, char** argv)
 {
   srslog::basic_logger& logger = srslog::fetch_basic_logger("TFT", false);
@@ -435,4 +536,7 @@ int main(int argc, char** argv)
   if (tft_filter_test_ipv6_combined()) {
     return -1;
   }
+  if (tft_matcher_test_precedence()) {
+    return -1;
+  }
 }
@@ -26,6 +26,8 @@ extern "C" {
 #include "srsran/config.h"
 }
 
+#include <algorithm>
+#include <arpa/inet.h>
 #include <linux/ip.h>
 #include <linux/tcp.h>
 #include <linux/udp.h>
@@ -124,6 +126,8 @@ tft_packet_filter_t::tft_packet_filter_t(uint8_t
         active_filters |= LOCAL_PORT_RANGE_FLAG;
         memcpy(&local_port_range[0], &tft.filter[idx], 2);
         memcpy(&local_port_range[1], &tft.filter[idx + 2], 2);
+        local_port_range[0] = ntohs(local_port_range[0]);
+        local_port_range[1] = ntohs(local_port_range[1]);
         if (local_port_range[0] > local_port_range[1]) { // wrong order
           uint16_t t          = local_port_range[0];
           local_port_range[0] = local_port_range[1];
@@ -136,6 +140,8 @@ tft_packet_filter_t::tft_packet_filter_t(uint8_t
         active_filters |= REMOTE_PORT_RANGE_FLAG;
         memcpy(&remote_port_range[0], &tft.filter[idx], 2);
         memcpy(&remote_port_range[1], &tft.filter[idx + 2], 2);
+        remote_port_range[0] = ntohs(remote_port_range[0]);
+        remote_port_range[1] = ntohs(remote_port_range[1]);
         if (remote_port_range[0] > remote_port_range[1]) { // wrong order
           uint16_t t           = remote_port_range[0];
           remote_port_range[0] = remote_port_range[1];
@@ -248,7 +254,7 @@ bool tft_packet_filter_t::match_ip(const srsran::unique_byte_buffer_t& pdu)
     // Check match on IPv6
     if (filter_contains(IPV6_REMOTE_ADDR_FLAG | IPV6_REMOTE_ADDR_LENGTH_FLAG)) {
       bool match = true;
-      for (int i = 0; i < ipv6_remote_addr_length; i++) {
+      for (int i = 0; i < IPV6_ADDR_SIZE; i++) {
         match &= ((ipv6_remote_addr[i] ^ ip6_pkt->daddr.in6_u.u6_addr8[i]) & ipv6_remote_addr_mask[i]) == 0;
         if (!match) {
           return false;
@@ -320,34 +326,19 @@ bool tft_packet_filter_t::match_port(const srsran::unique_byte_buffer_t& pdu)
   struct ipv6hdr* ip6_pkt = (struct ipv6hdr*)pdu->msg;
   struct udphdr*  udp_pkt;
   struct tcphdr*  tcp_pkt;
+  uint16_t        source_port, dest_port; // network byte order
 
   if (ip_pkt->version == 4) {
     switch (ip_pkt->protocol) {
       case UDP_PROTOCOL:
-        udp_pkt = (struct udphdr*)&pdu->msg[ip_pkt->ihl * 4];
-        if (active_filters & SINGLE_LOCAL_PORT_FLAG) {
-          if (udp_pkt->source != single_local_port) {
-            return false;
-          }
-        }
-        if (active_filters & SINGLE_REMOTE_PORT_FLAG) {
-          if (udp_pkt->dest != single_remote_port) {
-            return false;
-          }
-        }
+        udp_pkt     = (struct udphdr*)&pdu->msg[ip_pkt->ihl * 4];
+        source_port = udp_pkt->source;
+        dest_port   = udp_pkt->dest;
         break;
       case TCP_PROTOCOL:
-        tcp_pkt = (struct tcphdr*)&pdu->msg[ip_pkt->ihl * 4];
-        if (active_filters & SINGLE_LOCAL_PORT_FLAG) {
-          if (tcp_pkt->source != single_local_port) {
-            return false;
-          }
-        }
-        if (active_filters & SINGLE_REMOTE_PORT_FLAG) {
-          if (tcp_pkt->dest != single_remote_port) {
-            return false;
-          }
-        }
+        tcp_pkt     = (struct tcphdr*)&pdu->msg[ip_pkt->ihl * 4];
+        source_port = tcp_pkt->source;
+        dest_port   = tcp_pkt->dest;
         break;
       default:
         return false;
@@ -355,41 +346,243 @@ bool tft_packet_filter_t::match_port(const srsran::unique_byte_buffer_t& pdu)
   } else if (ip_pkt->version == 6) {
     switch (ip6_pkt->nexthdr) {
       case UDP_PROTOCOL:
-        udp_pkt = (struct udphdr*)&pdu->msg[sizeof(ipv6hdr)];
-        if (active_filters & SINGLE_LOCAL_PORT_FLAG) {
-          if (udp_pkt->source != single_local_port) {
-            return false;
-          }
-        }
-        if (active_filters & SINGLE_REMOTE_PORT_FLAG) {
-          if (udp_pkt->dest != single_remote_port) {
-            return false;
-          }
-        }
+        udp_pkt     = (struct udphdr*)&pdu->msg[sizeof(ipv6hdr)];
+        source_port = udp_pkt->source;
+        dest_port   = udp_pkt->dest;
         break;
       case TCP_PROTOCOL:
-        tcp_pkt = (struct tcphdr*)&pdu->msg[sizeof(ipv6hdr)];
-        if (active_filters & SINGLE_LOCAL_PORT_FLAG) {
-          if (tcp_pkt->source != single_local_port) {
-            return false;
-          }
-        }
-        if (active_filters & SINGLE_REMOTE_PORT_FLAG) {
-          if (tcp_pkt->dest != single_remote_port) {
-            return false;
-          }
-        }
+        tcp_pkt     = (struct tcphdr*)&pdu->msg[sizeof(ipv6hdr)];
+        source_port = tcp_pkt->source;
+        dest_port   = tcp_pkt->dest;
         break;
       default:
         return false;
     }
+  } else {
+    return true;
+  }
+
+  if (active_filters & SINGLE_LOCAL_PORT_FLAG) {
+    if (source_port != single_local_port) {
+      return false;
+    }
+  }
+  if (active_filters & LOCAL_PORT_RANGE_FLAG) {
+    if (ntohs(source_port) < local_port_range[0] || ntohs(source_port) > local_port_range[1]) {
+      return false;
+    }
+  }
+  if (active_filters & SINGLE_REMOTE_PORT_FLAG) {
+    if (dest_port != single_remote_port) {
+      return false;
+    }
+  }
+  if (active_filters & REMOTE_PORT_RANGE_FLAG) {
+    if (ntohs(dest_port) < remote_port_range[0] || ntohs(dest_port) > remote_port_range[1]) {
+      return false;
+    }
   }
   return true;
 }
 
+/*******************************************************************************
+  TFT classifier
+*******************************************************************************/
+
+tft_classifier::filter_set_t& tft_classifier::filter_set_t::operator|=(const filter_set_t& other)
+{
+  for (uint32_t w = 0; w < words.size(); ++w) {
+    words[w] |= other.words[w];
+  }
+  return *this;
+}
+
+tft_classifier::filter_set_t& tft_classifier::filter_set_t::operator&=(const filter_set_t& other)
+{
+  for (uint32_t w = 0; w < words.size(); ++w) {
+    words[w] &= other.words[w];
+  }
+  return *this;
+}
+
+void tft_classifier::addr_trie::clear()
+{
+  nodes.assign(1, trie_node{});
+  any_addr = {};
+}
+
+void tft_classifier::addr_trie::insert(const uint8_t* addr, uint32_t prefix_len, uint32_t idx)
+{
+  uint32_t node = 0;
+  for (uint32_t i = 0; i < prefix_len; ++i) {
+    uint32_t bit = (addr[i / 8] >> (7 - i % 8)) & 1;
+    if (nodes[node].child[bit] < 0) {
+      nodes[node].child[bit] = nodes.size();
+      nodes.emplace_back();
+    }
+    node = nodes[node].child[bit];
+  }
+  nodes[node].filters.set(idx);
+}
+
+tft_classifier::filter_set_t tft_classifier::addr_trie::lookup(const uint8_t* addr, uint32_t nof_bits) const
+{
+  filter_set_t ret  = any_addr;
+  int32_t      node = 0;
+  for (uint32_t i = 0; node >= 0; ++i) {
+    ret |= nodes[node].filters;
+    if (i == nof_bits) {
+      break;
+    }
+    node = nodes[node].child[(addr[i / 8] >> (7 - i % 8)) & 1];
+  }
+  return ret;
+}
+
+/// Returns the prefix length of an address mask, or -1 if the mask is not contiguous
+static int get_prefix_len(const uint8_t* mask, uint32_t nof_bytes)
+{
+  uint32_t len = 0;
+  while (len < nof_bytes * 8 && ((mask[len / 8] >> (7 - len % 8)) & 1)) {
+    len++;
+  }
+  for (uint32_t i = len; i < nof_bytes * 8; ++i) {
+    if ((mask[i / 8] >> (7 - i % 8)) & 1) {
+      return -1;
+    }
+  }
+  return len;
+}
+
+void tft_classifier::compile(tft_filter_map_t& filter_map)
+{
+  const uint16_t port_flags =
+      SINGLE_LOCAL_PORT_FLAG | LOCAL_PORT_RANGE_FLAG | SINGLE_REMOTE_PORT_FLAG | REMOTE_PORT_RANGE_FLAG;
+
+  filters.fill(nullptr);
+  all_filters     = {};
+  any_remote_port = {};
+  no_port         = {};
+  ipv4_trie.clear();
+  ipv6_trie.clear();
+
+  struct port_range {
+    uint32_t first, last, idx;
+  };
+  std::vector<port_range> remote_ports;
+  std::vector<uint32_t>   boundaries = {0};
+
+  for (auto& filter_pair : filter_map) {
+    tft_packet_filter_t& filter = filter_pair.second;
+    if (filter.active_filters == 0) {
+      // Filters without components never match
+      continue;
+    }
+    uint32_t idx = filter.eval_precedence;
+    filters[idx] = &filter;
+    all_filters.set(idx);
+
+    // IPv4 remote address
+    int prefix_len = -1;
+    if (filter.filter_contains(IPV4_REMOTE_ADDR_FLAG)) {
+      prefix_len = get_prefix_len((const uint8_t*)&filter.ipv4_remote_addr_mask, IPV4_ADDR_SIZE);
+    }
+    if (prefix_len >= 0) {
+      ipv4_trie.insert((const uint8_t*)&filter.ipv4_remote_addr, prefix_len, idx);
+    } else {
+      // Non-contiguous masks are left to tft_packet_filter_t::match()
+      ipv4_trie.any_addr.set(idx);
+    }
+
+    // IPv6 remote address
+    prefix_len = -1;
+    if (filter.filter_contains(IPV6_REMOTE_ADDR_FLAG | IPV6_REMOTE_ADDR_LENGTH_FLAG)) {
+      prefix_len = get_prefix_len(filter.ipv6_remote_addr_mask, IPV6_ADDR_SIZE);
+    }
+    if (prefix_len >= 0) {
+      ipv6_trie.insert(filter.ipv6_remote_addr, prefix_len, idx);
+    } else {
+      ipv6_trie.any_addr.set(idx);
+    }
+
+    // Remote port
+    if (filter.filter_contains(SINGLE_REMOTE_PORT_FLAG)) {
+      uint16_t port = ntohs(filter.single_remote_port);
+      remote_ports.push_back({port, port, idx});
+    } else if (filter.filter_contains(REMOTE_PORT_RANGE_FLAG)) {
+      remote_ports.push_back({filter.remote_port_range[0], filter.remote_port_range[1], idx});
+    } else {
+      any_remote_port.set(idx);
+    }
+    if (not filter.filter_contains(port_flags)) {
+      no_port.set(idx);
+    }
+  }
+
+  // Split the port space in segments over which the set of matching filters is constant
+  for (const port_range& r : remote_ports) {
+    boundaries.push_back(r.first);
+    boundaries.push_back(r.last + 1);
+  }
+  std::sort(boundaries.begin(), boundaries.end());
+  boundaries.erase(std::unique(boundaries.begin(), boundaries.end()), boundaries.end());
+  remote_port_segments.clear();
+  for (uint32_t start : boundaries) {
+    if (start > UINT16_MAX) {
+      break;
+    }
+    port_segment seg = {start, {}};
+    for (const port_range& r : remote_ports) {
+      if (r.first <= start and start <= r.last) {
+        seg.filters.set(r.idx);
+      }
+    }
+    remote_port_segments.push_back(seg);
+  }
+}
+
+tft_classifier::filter_set_t tft_classifier::candidates(const srsran::unique_byte_buffer_t& pdu) const
+{
+  struct iphdr*   ip_pkt  = (struct iphdr*)pdu->msg;
+  struct ipv6hdr* ip6_pkt = (struct ipv6hdr*)pdu->msg;
+  filter_set_t    ret;
+  uint32_t        l4_offset;
+  uint8_t         protocol;
+
+  if (pdu->N_bytes >= sizeof(iphdr) and ip_pkt->version == 4 and pdu->N_bytes >= ip_pkt->ihl * 4U) {
+    ret       = ipv4_trie.lookup((const uint8_t*)&ip_pkt->daddr, 32);
+    l4_offset = ip_pkt->ihl * 4;
+    protocol  = ip_pkt->protocol;
+  } else if (pdu->N_bytes >= sizeof(ipv6hdr) and ip_pkt->version == 6) {
+    ret       = ipv6_trie.lookup(ip6_pkt->daddr.in6_u.u6_addr8, 128);
+    l4_offset = sizeof(ipv6hdr);
+    protocol  = ip6_pkt->nexthdr;
+  } else {
+    // Let tft_packet_filter_t::match() handle anything unexpected
+    return all_filters;
+  }
+
+  if (protocol != UDP_PROTOCOL and protocol != TCP_PROTOCOL) {
+    ret &= no_port;
+  } else if (pdu->N_bytes >= l4_offset + 4) {
+    // The destination port is at the same offset in UDP and TCP headers
+    uint32_t dest_port = ntohs(((struct udphdr*)&pdu->msg[l4_offset])->dest);
+    auto     seg       = std::upper_bound(remote_port_segments.begin(),
+                                remote_port_segments.end(),
+                                dest_port,
+                                [](uint32_t port, const port_segment& s) { return port < s.start; });
+    filter_set_t port_filters = any_remote_port;
+    port_filters |= (seg - 1)->filters;
+    ret &= port_filters;
+  }
+  return ret;
+}
+
 void tft_pdu_matcher::reset()
 {
+  std::lock_guard<std::mutex> lock(tft_mutex);
   tft_filter_map.clear();
+  classifier.compile(tft_filter_map);
 }
 
 /**
@@ -402,15 +595,19 @@ void tft_pdu_matcher::reset()
 int tft_pdu_matcher::check_tft_filter_match(const srsran::unique_byte_buffer_t& pdu, uint8_t& eps_bearer_id)
 {
   std::lock_guard<std::mutex> lock(tft_mutex);
-  for (std::pair<const uint16_t, tft_packet_filter_t>& filter_pair : tft_filter_map) {
-    bool match = filter_pair.second.match(pdu);
-    if (match) {
-      eps_bearer_id = filter_pair.second.eps_bearer_id;
-      logger.debug("Found filter match -- EPS bearer Id %d", filter_pair.second.eps_bearer_id);
-      return SRSRAN_SUCCESS;
-    }
+  if (tft_filter_map.empty()) {
+    return SRSRAN_ERROR;
   }
-  return SRSRAN_ERROR;
+  bool found = classifier.candidates(pdu).find_first([this, &pdu, &eps_bearer_id](uint32_t idx) {
+    tft_packet_filter_t* filter = classifier.get_filter(idx);
+    if (not filter->match(pdu)) {
+      return false;
+    }
+    eps_bearer_id = filter->eps_bearer_id;
+    logger.debug("Found filter match -- EPS bearer Id %d", filter->eps_bearer_id);
+    return true;
+  });
+  return found ? SRSRAN_SUCCESS : SRSRAN_ERROR;
 }
 
 /**
@@ -428,6 +625,7 @@ void tft_pdu_matcher::delete_tft_for_eps_bearer(const uint8_t eps_bearer_id)
   if (old_filter != tft_filter_map.end()) {
     logger.debug("Deleting TFT for EPS bearer %d", eps_bearer_id);
     tft_filter_map.erase(old_filter);
+    classifier.compile(tft_filter_map);
   }
 }
 
@@ -435,6 +633,16 @@ int tft_pdu_matcher::apply_traffic_flow_template(const uint8_t&
                                                  const LIBLTE_MME_TRAFFIC_FLOW_TEMPLATE_STRUCT* tft)
 {
   std::lock_guard<std::mutex> lock(tft_mutex);
+  int                         ret = apply_tft_operation(eps_bearer_id, tft);
+
+  // Filters may have been added or removed even if the operation failed half-way
+  classifier.compile(tft_filter_map);
+  return ret;
+}
+
+int tft_pdu_matcher::apply_tft_operation(const uint8_t&                                 eps_bearer_id,
+                                         const LIBLTE_MME_TRAFFIC_FLOW_TEMPLATE_STRUCT* tft)
+{
   switch (tft->tft_op_code) {
     case LIBLTE_MME_TFT_OPERATION_CODE_CREATE_NEW_TFT:
       for (int i = 0; i < tft->packet_filter_list_size; i++) {
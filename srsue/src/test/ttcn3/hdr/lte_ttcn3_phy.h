@@ -78,7 +78,7 @@ public:
   void meas_stop() override;
 
   // phy_interface_mac_lte
-  void set_mch_period_stop(uint32_t stop) override{};
+  void set_mch_period_stop(uint32_t lcid, uint32_t stop) override{};
 
   // Cell search and selection procedures
   bool cell_search() override;